@@ -0,0 +1,140 @@
+/*_############################################################################
+  _## 
+  _##  AGENT++ 4.0 - table_memory.cpp
+  _## 
+  _##  Copyright (C) 2000-2013  Frank Fock and Jochen Katz (agentpp.com)
+  _##  
+  _##  Licensed under the Apache License, Version 2.0 (the "License");
+  _##  you may not use this file except in compliance with the License.
+  _##  You may obtain a copy of the License at
+  _##  
+  _##      http://www.apache.org/licenses/LICENSE-2.0
+  _##  
+  _##  Unless required by applicable law or agreed to in writing, software
+  _##  distributed under the License is distributed on an "AS IS" BASIS,
+  _##  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  _##  See the License for the specific language governing permissions and
+  _##  limitations under the License.
+  _##  
+  _##########################################################################*/
+
+/*
+ * Measures the heap memory used per row of MibTable and MibStaticTable
+ * instances: a table with one column like the DynamicTable of this
+ * example, a table with four columns, and a static table with two
+ * columns like the example of static_table. The heap usage is taken
+ * from mallinfo(), so the program reports only with glibc.
+ *
+ * Usage: table_memory [rows]
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include <agent_pp/agent++.h>
+#include <agent_pp/mib.h>
+#include <agent_pp/mib_complex_entry.h>
+
+#ifdef SNMP_PP_NAMESPACE
+using namespace Snmp_pp;
+#endif
+
+#ifdef AGENTPP_NAMESPACE
+using namespace Agentpp;
+#endif
+
+static const index_info indTable[1] = {
+  { sNMP_SYNTAX_INT, FALSE, 1, 1 }
+};
+
+static double heap_used()
+{
+#if defined(__GLIBC__) && \
+    ((__GLIBC__ > 2) || ((__GLIBC__ == 2) && (__GLIBC_MINOR__ >= 33)))
+	struct mallinfo2 info = mallinfo2();
+	return (double)info.uordblks + (double)info.hblkhd;
+#elif defined(__GLIBC__)
+	struct mallinfo info = mallinfo();
+	return (double)(unsigned int)info.uordblks +
+	       (double)(unsigned int)info.hblkhd;
+#else
+	return 0;
+#endif
+}
+
+static void report(const char* name, double before, long rows)
+{
+	double used = heap_used() - before;
+	printf("%-26s %8.1f MB %8.0f B/row\n", name,
+	       used / (1024 * 1024), used / rows);
+}
+
+static void measure_table(const char* name, int columns, long rows)
+{
+	double before = heap_used();
+	MibTable* table = new MibTable("1.3.6.1.4.1.4976.6.3.1", indTable, 1);
+	table->add_col(new MibLeaf("1", READWRITE, new SnmpInt32(0),
+				   VMODE_NONE));
+	if (columns > 1) {
+		table->add_col(new MibLeaf("2", READWRITE,
+					   new OctetStr("interface"),
+					   VMODE_NONE));
+		table->add_col(new MibLeaf("3", READONLY, new Counter32(0),
+					   VMODE_NONE));
+		table->add_col(new MibLeaf("4", READONLY, new TimeTicks(0),
+					   VMODE_NONE));
+	}
+	for (long i = 1; i <= rows; i++) {
+		Oidx index;
+		index += (unsigned long)i;
+		table->add_row(index);
+	}
+	report(name, before, rows);
+	delete table;
+}
+
+static void measure_static_table(const char* name, long rows)
+{
+	double before = heap_used();
+	MibStaticTable* table = new MibStaticTable("1.3.6.1.4.1.4976.6.1.1");
+	for (long i = 1; i <= rows; i++) {
+		Oidx index("2");
+		index += (unsigned long)i;
+		table->add(MibStaticEntry(index, SnmpInt32(i)));
+		index[0] = 3;
+		table->add(MibStaticEntry(index, OctetStr("A table text")));
+	}
+	report(name, before, rows);
+	delete table;
+}
+
+int main(int argc, char* argv[])
+{
+	long rows = 200000;
+	if (argc > 1)
+		rows = atol(argv[1]);
+	if (rows <= 0)
+		rows = 1;
+
+#ifndef __GLIBC__
+	printf("table_memory needs mallinfo() of glibc\n");
+	return 1;
+#endif
+
+#ifndef _NO_LOGGING
+	DefaultLog::log()->set_filter(ERROR_LOG, 0);
+	DefaultLog::log()->set_filter(WARNING_LOG, 0);
+	DefaultLog::log()->set_filter(EVENT_LOG, 0);
+	DefaultLog::log()->set_filter(INFO_LOG, 0);
+	DefaultLog::log()->set_filter(DEBUG_LOG, 0);
+#endif
+
+	printf("%ld rows\n", rows);
+	measure_table("dynamic_table, 1 column", 1, rows);
+	measure_table("dynamic_table, 4 columns", 4, rows);
+	measure_static_table("static_table, 2 columns", rows);
+	return 0;
+}
@@ -228,6 +228,7 @@ typedef enum { READING, WRITING } access_types;
 #define AGENTPP_DECL_TEMPL_ARRAY_MIBCONFIGFORMAT
 #define AGENTPP_DECL_TEMPL_OIDLIST_MIBCONTEXT
 #define AGENTPP_DECL_TEMPL_OIDLIST_PROXYFORWARDER
+#define AGENTPP_DECL_TEMPL_OIDLIST_OIDXPOOLENTRY
 #define AGENTPP_DECL_TEMPL_ARRAY_MIBENTRY
 #define AGENTPP_DECL_TEMPL_ARRAY_THREAD
 #define AGENTPP_DECL_TEMPL_ARRAY_TASKMANAGER
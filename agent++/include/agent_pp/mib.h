@@ -31,6 +31,7 @@
 #include <agent_pp/snmp_pp_ext.h>
 #include <agent_pp/mib_entry.h>
 #include <agent_pp/oidx_ptr.h>
+#include <agent_pp/oidx_pool.h>
 #include <agent_pp/tools.h>
 #include <agent_pp/request.h>
 #include <agent_pp/mib_context.h>
@@ -981,6 +982,8 @@ protected:
 	 * Set the base (i.e. the table's entry object's oid) oid value.
 	 * An oid of an object of an SNMP table consists of the following
 	 * three parts:  base + column + index 
+	 * The base is interned in the OidxPool, so all rows of a table
+	 * share one copy of it.
 	 *
 	 * @param b - The base oid.
 	 */
@@ -998,7 +1001,8 @@ protected:
 	void		set_reference_to_row();	
 
 	Oidx			index;
-	Oidx			base;
+	// shared by all rows of a table (see OidxPool)
+	OidxPrefix		base;
 #ifdef USE_ARRAY_TEMPLATE
 	OrderedArray<MibLeaf>  	row;
 #else
@@ -2330,6 +2334,21 @@ public:
 #else
 	static RequestList*	get_request_list() { return requestList; }
 #endif
+	/**
+	 * Gets the request list that answers the given request. This is
+	 * the RequestList that received the request (which differs from
+	 * get_request_list() if several listeners are used, see 
+	 * MultiListener) or the request list associated with this Mib.
+	 *
+	 * @param req
+	 *    a Request.
+	 * @return 
+	 *    a RequestList instance.
+	 */
+	RequestList*		get_request_list(Request* req)
+	    { return (req->get_request_list()) ? 
+		  req->get_request_list() : requestList; }
+
 	/**
 	  * Process a request. If multi-threading is activated, start a
 	  * thread to actually process the request. 
@@ -0,0 +1,236 @@
+/*_############################################################################
+  _##
+  _##  AGENT++ 4.0 - multi_listener.h
+  _##
+  _##  Copyright (C) 2000-2013  Frank Fock and Jochen Katz (agentpp.com)
+  _##
+  _##  Licensed under the Apache License, Version 2.0 (the "License");
+  _##  you may not use this file except in compliance with the License.
+  _##  You may obtain a copy of the License at
+  _##
+  _##      http://www.apache.org/licenses/LICENSE-2.0
+  _##
+  _##  Unless required by applicable law or agreed to in writing, software
+  _##  distributed under the License is distributed on an "AS IS" BASIS,
+  _##  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  _##  See the License for the specific language governing permissions and
+  _##  limitations under the License.
+  _##
+  _##########################################################################*/
+
+#ifndef multi_listener_h_
+#define multi_listener_h_
+
+#include <agent_pp/agent++.h>
+#include <agent_pp/threads.h>
+#include <agent_pp/request.h>
+#include <agent_pp/snmp_counters.h>
+
+#if defined(AGENTPP_USE_THREAD_POOL) && defined(SNMP_PP_WITH_UDPADDR)
+
+#ifdef AGENTPP_NAMESPACE
+namespace Agentpp {
+#endif
+
+class Mib;
+
+// maximum number of requests taken from the socket at once
+#define AGENTPP_LISTENER_BATCH_SIZE	16
+
+
+/*------------------------ class RequestListener ----------------------*/
+
+/**
+ * A RequestListener is one shard of a MultiListener. It owns a
+ * Snmpx session bound with SO_REUSEPORT, a RequestList, a
+ * QueuedThreadPool and a counter shard. Its own thread receives
+ * requests from the session and passes them to the shared Mib, which
+ * processes them on the listener's thread pool and answers them
+ * through the listener's RequestList.
+ *
+ * @version 4.0.4
+ */
+class AGENTPP_DECL RequestListener: public Runnable {
+public:
+	/**
+	 * Create a listener and bind its session to the given address.
+	 *
+	 * @param mib
+	 *    the Mib that processes the received requests.
+	 * @param address
+	 *    the UDP address to listen on.
+	 * @param poolSize
+	 *    the number of threads processing the requests of this
+	 *    listener.
+	 */
+	RequestListener(Mib*, const NS_SNMP UdpAddress&, int poolSize);
+
+	/**
+	 * Destructor. Stops the listener and its thread pool.
+	 */
+	virtual ~RequestListener();
+
+	/**
+	 * Get the creation status of the listener's session.
+	 *
+	 * @return
+	 *    SNMP_CLASS_SUCCESS if the session could be bound.
+	 */
+	int		get_status() const { return status; }
+
+	Snmpx*		get_snmp() { return snmp; }
+	RequestList*	get_request_list() { return requestList; }
+	ThreadPool*	get_thread_pool() { return threadPool; }
+	MibIIsnmpCounterShard* get_counters() { return &counters; }
+
+	/**
+	 * Start receiving requests.
+	 */
+	void		start();
+
+	/**
+	 * Stop receiving requests. Blocks until the receiving thread
+	 * has terminated (at most about one second).
+	 */
+	void		stop();
+
+	/**
+	 * The receive loop.
+	 */
+	virtual void	run();
+
+protected:
+	Mib*			mib;
+	Snmpx*			snmp;
+	RequestList*		requestList;
+	QueuedThreadPool*	threadPool;
+	MibIIsnmpCounterShard	counters;
+	Thread			thread;
+	int			status;
+	bool			go;
+
+private:
+	RequestListener(const RequestListener&);
+	RequestListener& operator=(const RequestListener&);
+};
+
+
+/*------------------------- class MultiListener -----------------------*/
+
+/**
+ * The MultiListener receives requests on several sockets bound to
+ * the same UDP address with SO_REUSEPORT. The kernel distributes the
+ * incoming datagrams among the sockets, so that request reception
+ * and processing scale with the number of listeners instead of being
+ * limited by a single receive loop. All listeners share one Mib; each
+ * has its own RequestList, thread pool and snmp group counters (the
+ * counters are summed up by MibIIsnmpCounters).
+ *
+ * The following example replaces the usual receive loop:
+ *
+ *   MultiListener listener(mib, UdpAddress("0.0.0.0/161"), 8, 4);
+ *   if (listener.get_status() != SNMP_CLASS_SUCCESS) ...
+ *   listener.set_v3mp(v3mp);
+ *   listener.set_vacm(vacm);
+ *   listener.start();   // registers the first RequestList with the Mib
+ *   ...
+ *   listener.stop();
+ *
+ * Note: Requests that are answered asynchronously by transaction id
+ * through Mib::get_request_list() (proxy MIB, AgentX master agent)
+ * are only supported on the first listener. Such agents should use
+ * a single RequestList.
+ *
+ * @version 4.0.4
+ */
+class AGENTPP_DECL MultiListener {
+public:
+	/**
+	 * Create a MultiListener.
+	 *
+	 * @param mib
+	 *    the Mib that processes the received requests.
+	 * @param address
+	 *    the UDP address to listen on.
+	 * @param listeners
+	 *    the number of sockets (and receiving threads).
+	 * @param poolSize
+	 *    the number of processing threads per listener.
+	 */
+	MultiListener(Mib*, const NS_SNMP UdpAddress&, int listeners,
+		      int poolSize = 4);
+
+	/**
+	 * Destructor. Stops and deletes all listeners.
+	 */
+	virtual ~MultiListener();
+
+	/**
+	 * Get the creation status.
+	 *
+	 * @return
+	 *    SNMP_CLASS_SUCCESS if all sessions could be bound, otherwise
+	 *    the error status of the first session that failed.
+	 */
+	int		get_status() const { return status; }
+
+	/**
+	 * Get the number of listeners.
+	 */
+	int		size() const { return listeners.size(); }
+
+	/**
+	 * Get a listener.
+	 *
+	 * @param i
+	 *    an index (0 <= i < size()).
+	 * @return
+	 *    a RequestListener instance.
+	 */
+	RequestListener* get_listener(int i) { return listeners.getNth(i); }
+
+#ifdef _SNMPv3
+	void		set_v3mp(NS_SNMP v3MP*);
+	void		set_vacm(Vacm*);
+#else
+	void		set_read_community(const NS_SNMP OctetStr&);
+	void		set_write_community(const NS_SNMP OctetStr&);
+#endif
+	void		set_address_validation(bool);
+
+	/**
+	 * Set the receive batch size of all sessions
+	 * (see Snmp::set_receive_batch_size).
+	 *
+	 * @param count
+	 *    the maximum number of datagrams read with one system call.
+	 */
+	void		set_receive_batch_size(int);
+
+	/**
+	 * Start all listeners. If the Mib has no RequestList yet, the
+	 * RequestList of the first listener is registered with it.
+	 */
+	void		start();
+
+	/**
+	 * Stop all listeners.
+	 */
+	void		stop();
+
+protected:
+	Mib*			mib;
+	Array<RequestListener>	listeners;
+	int			status;
+
+private:
+	MultiListener(const MultiListener&);
+	MultiListener& operator=(const MultiListener&);
+};
+
+#ifdef AGENTPP_NAMESPACE
+}
+#endif
+
+#endif // AGENTPP_USE_THREAD_POOL && SNMP_PP_WITH_UDPADDR
+#endif
@@ -58,7 +58,7 @@ namespace Agentpp {
 
 // comparison : less-than -> < 0; equal -> 0; greater-than -> > 0
 #ifndef OidxPtrCMP
-#define OidxPtrCMP(a, b) ( ((*a) <= (*b))? (((*a) == (*b))? 0 : -1) : 1 )
+#define OidxPtrCMP(a, b) ((a)->nCompare(*(b)))
 #endif
 
 // hash function
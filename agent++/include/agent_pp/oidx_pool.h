@@ -0,0 +1,203 @@
+/*_############################################################################
+  _##
+  _##  AGENT++ 4.0 - oidx_pool.h
+  _##
+  _##  Copyright (C) 2000-2013  Frank Fock and Jochen Katz (agentpp.com)
+  _##
+  _##  Licensed under the Apache License, Version 2.0 (the "License");
+  _##  you may not use this file except in compliance with the License.
+  _##  You may obtain a copy of the License at
+  _##
+  _##      http://www.apache.org/licenses/LICENSE-2.0
+  _##
+  _##  Unless required by applicable law or agreed to in writing, software
+  _##  distributed under the License is distributed on an "AS IS" BASIS,
+  _##  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  _##  See the License for the specific language governing permissions and
+  _##  limitations under the License.
+  _##
+  _##########################################################################*/
+
+#ifndef oidx_pool_h_
+#define oidx_pool_h_
+
+#include <agent_pp/agent++.h>
+#include <agent_pp/List.h>
+#include <agent_pp/threads.h>
+#include <agent_pp/snmp_pp_ext.h>
+
+#ifdef AGENTPP_NAMESPACE
+namespace Agentpp {
+#endif
+
+
+/*------------------------ class OidxPoolEntry ------------------------*/
+
+/**
+ * An OidxPoolEntry holds one interned object identifier of an
+ * OidxPool together with the number of OidxPrefix handles that
+ * reference it.
+ *
+ * @version 4.0.4
+ */
+class AGENTPP_DECL OidxPoolEntry {
+	friend class OidxPool;
+public:
+	OidxPoolEntry(const Oidx& o): oid(o), refs(1) { }
+
+	/**
+	 * Return the key of the entry (the interned oid).
+	 */
+	Oidx*		key() { return &oid; }
+
+	/**
+	 * Return the interned oid.
+	 */
+	const Oidx&	get_oid() const { return oid; }
+
+	/**
+	 * Return the number of handles referencing this entry.
+	 */
+	unsigned long	get_refs() const { return refs; }
+
+protected:
+	Oidx		oid;
+	unsigned long	refs;
+};
+
+#if !defined (AGENTPP_DECL_TEMPL_OIDLIST_OIDXPOOLENTRY)
+#define AGENTPP_DECL_TEMPL_OIDLIST_OIDXPOOLENTRY
+	AGENTPP_DECL_TEMPL template class AGENTPP_DECL OidList<OidxPoolEntry>;
+#endif
+
+
+/*--------------------------- class OidxPool --------------------------*/
+
+/**
+ * The OidxPool interns object identifiers that many objects share
+ * as a common prefix, for example the entry oid of a table that every
+ * MibTableRow of the table needs. Each distinct oid is stored once,
+ * reference counted, and removed from the pool when its last
+ * OidxPrefix handle is destroyed.
+ *
+ * The pool is normally not used directly, but through OidxPrefix.
+ * All member functions are thread safe.
+ *
+ * @version 4.0.4
+ */
+class AGENTPP_DECL OidxPool: public ThreadManager {
+public:
+	OidxPool();
+	virtual ~OidxPool();
+
+	/**
+	 * Return the process wide pool used by OidxPrefix. The pool is
+	 * created on first use.
+	 */
+	static OidxPool* get_instance();
+
+	/**
+	 * Get the entry for the given oid and increment its reference
+	 * count. A new entry is created if the oid is not yet in the
+	 * pool.
+	 *
+	 * @param oid
+	 *    an object identifier.
+	 * @return
+	 *    the pool entry of oid, which must be released by release().
+	 */
+	OidxPoolEntry*	acquire(const Oidx&);
+
+	/**
+	 * Increment the reference count of an entry of this pool.
+	 *
+	 * @param entry
+	 *    an entry returned by acquire(const Oidx&).
+	 */
+	void		acquire(OidxPoolEntry*);
+
+	/**
+	 * Decrement the reference count of an entry and remove it from
+	 * the pool if it is no longer referenced.
+	 *
+	 * @param entry
+	 *    an entry returned by acquire.
+	 */
+	void		release(OidxPoolEntry*);
+
+	/**
+	 * Return the number of distinct oids in the pool.
+	 */
+	int		size();
+
+protected:
+	OidList<OidxPoolEntry>	entries;
+
+	static OidxPool*	instance;
+};
+
+
+/*-------------------------- class OidxPrefix -------------------------*/
+
+/**
+ * An OidxPrefix is a handle to an object identifier interned in
+ * the OidxPool. Copying a handle only increments the reference count
+ * of the shared oid, so objects with a common prefix (like the rows of
+ * a table) store a pointer sized handle instead of a complete Oidx.
+ * The oid of a handle cannot be modified, assigning a new oid interns
+ * it and releases the old one.
+ *
+ * @version 4.0.4
+ */
+class AGENTPP_DECL OidxPrefix {
+public:
+	/**
+	 * Create a handle for the empty oid.
+	 */
+	OidxPrefix(): entry(0) { }
+
+	/**
+	 * Create a handle for the given oid.
+	 *
+	 * @param oid
+	 *    an object identifier that is interned in the pool.
+	 */
+	OidxPrefix(const Oidx&);
+
+	/**
+	 * Copy constructor (shares the oid of other).
+	 */
+	OidxPrefix(const OidxPrefix&);
+
+	/**
+	 * Destructor, releases the oid.
+	 */
+	~OidxPrefix();
+
+	OidxPrefix&	operator=(const OidxPrefix&);
+	OidxPrefix&	operator=(const Oidx&);
+
+	/**
+	 * Return the oid of the handle.
+	 */
+	const Oidx&	get_oid() const
+			  { return (entry) ? entry->get_oid() : empty_oid; }
+
+	operator const Oidx&() const { return get_oid(); }
+
+	/**
+	 * Return the length of the oid.
+	 */
+	unsigned long	len() const { return get_oid().len(); }
+
+protected:
+	OidxPoolEntry*	entry;
+
+	static const Oidx empty_oid;
+};
+
+#ifdef AGENTPP_NAMESPACE
+}
+#endif
+
+#endif
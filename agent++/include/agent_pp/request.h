@@ -36,10 +36,24 @@
 #define PHASE_UNDO		3
 #define PHASE_CLEANUP		4
 
+// minimum encoded length of a vb in a response, used to limit the
+// number of vbs reserved for a GETBULK response
+#ifndef REQUEST_MIN_VB_LENGTH
+#define REQUEST_MIN_VB_LENGTH	16
+#endif
+
+// number of rows reserved for a GETBULK response before the first row
+// is found, the room is doubled when more rows are added
+#ifndef REQUEST_BULK_INITIAL_ROWS
+#define REQUEST_BULK_INITIAL_ROWS	8
+#endif
+
 #ifdef AGENTPP_NAMESPACE
 namespace Agentpp {
 #endif
 
+class RequestList;
+class MibIIsnmpCounterShard;
 #ifdef _SNMPv3
 class Vacm;
 #endif
@@ -341,6 +355,16 @@ public:
 	void		set_transaction_id(unsigned long id)
 						{ transaction_id = id; }
 
+	/**
+	 * Return the RequestList that received the receiver request
+	 * and that is used to answer it.
+	 *
+	 * @return
+	 *    a RequestList instance or 0 if the request has not been
+	 *    received by a RequestList (then the Mib's RequestList is used).
+	 */
+	RequestList*	get_request_list() { return requestList; }
+
 	/**
 	 * Return the count of sub-requests in the receiver request.
 	 *
@@ -579,6 +603,9 @@ protected:
 
 	int	  	get_max_response_length();
 
+	int		get_max_bulk_vbs() const;
+	void		reserve_rep_row();
+
 	Pdux*		pdu;
 	Vbx*		originalVbs;
 	int		originalSize;
@@ -595,6 +622,7 @@ protected:
 
 	NS_SNMP snmp_version	version;
 	unsigned long	transaction_id;
+	RequestList*	requestList;
 
 	// Locks hold by a mulit-phase (SET) request
 	Array<MibEntry>	locks;
@@ -708,6 +736,50 @@ public:
 	 */
 	Snmpx*			get_snmp() { return snmp; }
 
+	/**
+	 * Set the counter shard the snmp group counters of this
+	 * RequestList are counted in. By default (0), the global
+	 * MibIIsnmpCounters are used. Listeners receiving requests in
+	 * parallel (see MultiListener) use a shard per RequestList.
+	 *
+	 * @param shard
+	 *    a MibIIsnmpCounterShard instance or 0. The shard is not
+	 *    deleted by the receiver.
+	 */
+	void			set_counters(MibIIsnmpCounterShard* shard)
+	    { counters = shard; }
+
+	/**
+	 * Get the counter shard used by this RequestList.
+	 *
+	 * @return
+	 *    a MibIIsnmpCounterShard instance or 0 if the global
+	 *    counters are used.
+	 */
+	MibIIsnmpCounterShard*	get_counters() { return counters; }
+
+#ifdef AGENTPP_USE_THREAD_POOL
+	/**
+	 * Set the thread pool that processes the requests received by
+	 * this RequestList. If set, Mib::process_request uses this pool
+	 * instead of the Mib's thread pool.
+	 *
+	 * @param threadPool
+	 *    a ThreadPool instance or 0. The pool is not deleted by the
+	 *    receiver.
+	 */
+	void			set_thread_pool(ThreadPool* tp)
+	    { threadPool = tp; }
+
+	/**
+	 * Get the thread pool of this RequestList.
+	 *
+	 * @return
+	 *    a ThreadPool instance or 0 if the Mib's thread pool is used.
+	 */
+	ThreadPool*		get_thread_pool() { return threadPool; }
+#endif
+
 #ifdef _SNMPv3
 	/**
 	 * Set v3MP to be used.
@@ -769,6 +841,25 @@ public:
 	 */
 	virtual Request*		receive(int);
 
+	/**
+	 * Wait a given time for incoming requests and return all
+	 * requests that can be received without waiting again. If
+	 * batched reception is enabled for the Snmpx session (see
+	 * Snmp::set_receive_batch_size), all requests read from the
+	 * socket with one system call are returned at once, so that
+	 * they can be passed to Mib::process_request together.
+	 *
+	 * @param timeout
+	 *    The maximum time in seconds to wait for the first request
+	 *    (see receive(int)).
+	 * @param requests
+	 *    an array that will contain the received requests.
+	 * @param max_requests
+	 *    the size of the requests array.
+	 * @return The number of requests stored in requests.
+	 */
+	virtual int			receive_batch(int, Request**, int);
+
 	/**
 	 * Return the corresponding request id of a request in the
 	 * receiver RequestList that contains the specified variable
@@ -945,6 +1036,11 @@ protected:
 	unsigned long		next_transaction_id;
 
 	bool			sourceAddressValidation;
+
+	MibIIsnmpCounterShard*	counters;
+#ifdef AGENTPP_USE_THREAD_POOL
+	ThreadPool*		threadPool;
+#endif
 };
 
 /*------------------------ class RequestID --------------------------*/
@@ -32,6 +32,36 @@ namespace Agentpp {
 
 
 
+class MibIIsnmpCounters;
+
+/**********************************************************************
+ *  
+ *  class MibIIsnmpCounterShard
+ * 
+ */
+
+/**
+ * A MibIIsnmpCounterShard holds a private set of the snmp group
+ * counters for one RequestList (see RequestList::set_counters).
+ * Listeners that receive requests in parallel count into their own
+ * shard instead of sharing one set of counters. The values reported
+ * by MibIIsnmpCounters are the sum of the global counters and all
+ * existing shards. When a shard is destroyed, its counts are added to
+ * the global counters.
+ *
+ * @version 4.0.4
+ */
+class AGENTPP_DECL MibIIsnmpCounterShard {
+	friend class MibIIsnmpCounters;
+public:
+	MibIIsnmpCounterShard();
+	virtual ~MibIIsnmpCounterShard();
+
+protected:
+	unsigned long counter_snmp[SNMP_COUNTERS];
+	MibIIsnmpCounterShard* next;
+};
+
 /**********************************************************************
  *  
  *  class MibIIsnmpCounter
@@ -43,72 +73,133 @@ class AGENTPP_DECL MibIIsnmpCounters {
 public:
 	MibIIsnmpCounters();
 
-	static NS_SNMP Counter32 inPkts()	       	{ return counter_snmp[0]; }
-	static NS_SNMP Counter32 outPkts()	       	{ return counter_snmp[1]; }
-	static NS_SNMP Counter32 inBadVersions()        { return counter_snmp[2]; }
-	static NS_SNMP Counter32 inBadCommunityNames() 	{ return counter_snmp[3]; }
-	static NS_SNMP Counter32 inBadCommunityUses()  	{ return counter_snmp[4]; }
-	static NS_SNMP Counter32 inASNParseErrs()      	{ return counter_snmp[5]; }
-	static NS_SNMP Counter32 inTooBigs()	       	{ return counter_snmp[6]; }
-	static NS_SNMP Counter32 inNoSuchNames()       	{ return counter_snmp[7]; }
-	static NS_SNMP Counter32 inBadValues()	       	{ return counter_snmp[8]; }
-	static NS_SNMP Counter32 inReadOnlys()	       	{ return counter_snmp[9]; }
-	static NS_SNMP Counter32 inGenErrs()	       	{ return counter_snmp[10]; }
-	static NS_SNMP Counter32 inTotalReqVars()      	{ return counter_snmp[11]; }
-	static NS_SNMP Counter32 inTotalSetVars()      	{ return counter_snmp[12]; }
-	static NS_SNMP Counter32 inGetRequests()       	{ return counter_snmp[13]; }
-	static NS_SNMP Counter32 inGetNexts()	       	{ return counter_snmp[14]; }
-	static NS_SNMP Counter32 inSetRequests()       	{ return counter_snmp[15]; }
-	static NS_SNMP Counter32 inGetResponses()      	{ return counter_snmp[16]; }
-	static NS_SNMP Counter32 inTraps()	       	{ return counter_snmp[17]; }
-	static NS_SNMP Counter32 outTooBigs()	       	{ return counter_snmp[18]; }
-	static NS_SNMP Counter32 outNoSuchNames()      	{ return counter_snmp[19]; }
-	static NS_SNMP Counter32 outBadValues()		{ return counter_snmp[20]; }
-	static NS_SNMP Counter32 outGenErrs()	       	{ return counter_snmp[21]; }
-	static NS_SNMP Counter32 outGetRequests()      	{ return counter_snmp[22]; }
-	static NS_SNMP Counter32 outGetNexts()	       	{ return counter_snmp[23]; }
-	static NS_SNMP Counter32 outSetRequests()      	{ return counter_snmp[24]; }
-	static NS_SNMP Counter32 outGetResponses()     	{ return counter_snmp[25]; }
-	static NS_SNMP Counter32 outTraps()	       	{ return counter_snmp[26]; }
-	static NS_SNMP Counter32 silentDrops()      	{ return counter_snmp[27]; }
-	static NS_SNMP Counter32 proxyDrops()     	{ return counter_snmp[28]; }
-
-
-	static void      incInPkts()	       	{ counter_snmp[0]++; }
-	static void      incOutPkts()	       	{ counter_snmp[1]++; }
-	static void      incInBadVersions()     { counter_snmp[2]++; }
-	static void      incInBadCommunityNames()     	{ counter_snmp[3]++; }
-	static void      incInBadCommunityUses(){ counter_snmp[4]++; }
-	static void      incInASNParseErrs()   	{ counter_snmp[5]++; }
-	static void      incInTooBigs()	       	{ counter_snmp[6]++; }
-	static void      incInNoSuchNames()    	{ counter_snmp[7]++; }
-	static void      incInBadValues()       { counter_snmp[8]++; }
-	static void      incInReadOnlys()	{ counter_snmp[9]++; }
-	static void      incInGenErrs()	       	{ counter_snmp[10]++; }
-	static void      incInTotalReqVars()   	{ counter_snmp[11]++; }
-	static void      incInTotalSetVars()   	{ counter_snmp[12]++; }
-	static void      incInGetRequests()    	{ counter_snmp[13]++; }
-	static void      incInGetNexts()        { counter_snmp[14]++; }
-	static void      incInSetRequests()    	{ counter_snmp[15]++; }
-	static void      incInGetResponses()   	{ counter_snmp[16]++; }
-	static void      incInTraps()	       	{ counter_snmp[17]++; }
-	static void      incOutTooBigs()       	{ counter_snmp[18]++; }
-	static void      incOutNoSuchNames()   	{ counter_snmp[19]++; }
-	static void      incOutBadValues()      { counter_snmp[20]++; }
-	static void      incOutGenErrs()        { counter_snmp[21]++; }
-	static void      incOutGetRequests()   	{ counter_snmp[22]++; }
-	static void      incOutGetNexts()       { counter_snmp[23]++; }
-	static void      incOutSetRequests()   	{ counter_snmp[24]++; }
-	static void      incOutGetResponses()  	{ counter_snmp[25]++; }
-	static void      incOutTraps()	       	{ counter_snmp[26]++; }
-	static void      incSilentDrops()  	{ counter_snmp[27]++; }
-	static void      incProxyDrops()       	{ counter_snmp[28]++; }
+	static NS_SNMP Counter32 inPkts()	       	{ return get(0); }
+	static NS_SNMP Counter32 outPkts()	       	{ return get(1); }
+	static NS_SNMP Counter32 inBadVersions()        { return get(2); }
+	static NS_SNMP Counter32 inBadCommunityNames() 	{ return get(3); }
+	static NS_SNMP Counter32 inBadCommunityUses()  	{ return get(4); }
+	static NS_SNMP Counter32 inASNParseErrs()      	{ return get(5); }
+	static NS_SNMP Counter32 inTooBigs()	       	{ return get(6); }
+	static NS_SNMP Counter32 inNoSuchNames()       	{ return get(7); }
+	static NS_SNMP Counter32 inBadValues()	       	{ return get(8); }
+	static NS_SNMP Counter32 inReadOnlys()	       	{ return get(9); }
+	static NS_SNMP Counter32 inGenErrs()	       	{ return get(10); }
+	static NS_SNMP Counter32 inTotalReqVars()      	{ return get(11); }
+	static NS_SNMP Counter32 inTotalSetVars()      	{ return get(12); }
+	static NS_SNMP Counter32 inGetRequests()       	{ return get(13); }
+	static NS_SNMP Counter32 inGetNexts()	       	{ return get(14); }
+	static NS_SNMP Counter32 inSetRequests()       	{ return get(15); }
+	static NS_SNMP Counter32 inGetResponses()      	{ return get(16); }
+	static NS_SNMP Counter32 inTraps()	       	{ return get(17); }
+	static NS_SNMP Counter32 outTooBigs()	       	{ return get(18); }
+	static NS_SNMP Counter32 outNoSuchNames()      	{ return get(19); }
+	static NS_SNMP Counter32 outBadValues()		{ return get(20); }
+	static NS_SNMP Counter32 outGenErrs()	       	{ return get(21); }
+	static NS_SNMP Counter32 outGetRequests()      	{ return get(22); }
+	static NS_SNMP Counter32 outGetNexts()	       	{ return get(23); }
+	static NS_SNMP Counter32 outSetRequests()      	{ return get(24); }
+	static NS_SNMP Counter32 outGetResponses()     	{ return get(25); }
+	static NS_SNMP Counter32 outTraps()	       	{ return get(26); }
+	static NS_SNMP Counter32 silentDrops()      	{ return get(27); }
+	static NS_SNMP Counter32 proxyDrops()     	{ return get(28); }
+
+
+	static void      incInPkts(MibIIsnmpCounterShard* s = 0)
+				{ counters(s)[0]++; }
+	static void      incOutPkts(MibIIsnmpCounterShard* s = 0)
+				{ counters(s)[1]++; }
+	static void      incInBadVersions(MibIIsnmpCounterShard* s = 0)
+				{ counters(s)[2]++; }
+	static void      incInBadCommunityNames(MibIIsnmpCounterShard* s = 0)
+				{ counters(s)[3]++; }
+	static void      incInBadCommunityUses(MibIIsnmpCounterShard* s = 0)
+				{ counters(s)[4]++; }
+	static void      incInASNParseErrs(MibIIsnmpCounterShard* s = 0)
+				{ counters(s)[5]++; }
+	static void      incInTooBigs(MibIIsnmpCounterShard* s = 0)
+				{ counters(s)[6]++; }
+	static void      incInNoSuchNames(MibIIsnmpCounterShard* s = 0)
+				{ counters(s)[7]++; }
+	static void      incInBadValues(MibIIsnmpCounterShard* s = 0)
+				{ counters(s)[8]++; }
+	static void      incInReadOnlys(MibIIsnmpCounterShard* s = 0)
+				{ counters(s)[9]++; }
+	static void      incInGenErrs(MibIIsnmpCounterShard* s = 0)
+				{ counters(s)[10]++; }
+	static void      incInTotalReqVars(MibIIsnmpCounterShard* s = 0)
+				{ counters(s)[11]++; }
+	static void      incInTotalSetVars(MibIIsnmpCounterShard* s = 0)
+				{ counters(s)[12]++; }
+	static void      incInGetRequests(MibIIsnmpCounterShard* s = 0)
+				{ counters(s)[13]++; }
+	static void      incInGetNexts(MibIIsnmpCounterShard* s = 0)
+				{ counters(s)[14]++; }
+	static void      incInSetRequests(MibIIsnmpCounterShard* s = 0)
+				{ counters(s)[15]++; }
+	static void      incInGetResponses(MibIIsnmpCounterShard* s = 0)
+				{ counters(s)[16]++; }
+	static void      incInTraps(MibIIsnmpCounterShard* s = 0)
+				{ counters(s)[17]++; }
+	static void      incOutTooBigs(MibIIsnmpCounterShard* s = 0)
+				{ counters(s)[18]++; }
+	static void      incOutNoSuchNames(MibIIsnmpCounterShard* s = 0)
+				{ counters(s)[19]++; }
+	static void      incOutBadValues(MibIIsnmpCounterShard* s = 0)
+				{ counters(s)[20]++; }
+	static void      incOutGenErrs(MibIIsnmpCounterShard* s = 0)
+				{ counters(s)[21]++; }
+	static void      incOutGetRequests(MibIIsnmpCounterShard* s = 0)
+				{ counters(s)[22]++; }
+	static void      incOutGetNexts(MibIIsnmpCounterShard* s = 0)
+				{ counters(s)[23]++; }
+	static void      incOutSetRequests(MibIIsnmpCounterShard* s = 0)
+				{ counters(s)[24]++; }
+	static void      incOutGetResponses(MibIIsnmpCounterShard* s = 0)
+				{ counters(s)[25]++; }
+	static void      incOutTraps(MibIIsnmpCounterShard* s = 0)
+				{ counters(s)[26]++; }
+	static void      incSilentDrops(MibIIsnmpCounterShard* s = 0)
+				{ counters(s)[27]++; }
+	static void      incProxyDrops(MibIIsnmpCounterShard* s = 0)
+				{ counters(s)[28]++; }
 	
-	// set all counters to zero
+	// set all counters (including all shards) to zero
 	static void	 reset();
 
+	/**
+	 * Get the sum of the given counter over the global counters
+	 * and all shards.
+	 *
+	 * @param index
+	 *    a counter index (0 <= index < SNMP_COUNTERS).
+	 * @return
+	 *    the counter value.
+	 */
+	static unsigned long get(int index);
+
+	/**
+	 * Add a shard to the counters summed up by get().
+	 *
+	 * @param shard
+	 *    a MibIIsnmpCounterShard instance.
+	 */
+	static void	 add_shard(MibIIsnmpCounterShard*);
+
+	/**
+	 * Remove a shard and add its counts to the global counters.
+	 *
+	 * @param shard
+	 *    a MibIIsnmpCounterShard instance.
+	 */
+	static void	 remove_shard(MibIIsnmpCounterShard*);
+
 protected:
+	static unsigned long* counters(MibIIsnmpCounterShard* s)
+	    { return (s) ? s->counter_snmp : counter_snmp; }
+
 	static unsigned long counter_snmp[];
+	static MibIIsnmpCounterShard* shards;
+	static NS_SNMP SnmpSynchronized shardLock;
 };
 
 #ifdef AGENTPP_NAMESPACE
@@ -47,6 +47,9 @@
 namespace Agentpp {
 #endif
 
+#ifdef _THREADS
+class Synchronized;
+#endif
 
 /*--------------------------- class Oidx -----------------------------*/
 
@@ -81,6 +84,15 @@ public:
 	 */
 	Oidx(const unsigned long *data, int length) : Oid(data, length) { }
 
+	/**
+	 * Construct an Object Identifier from an oid literal without
+	 * parsing a string (see snmp_pp/oid_literal.h).
+	 *
+	 * @param literal - An oid literal.
+	 */
+	template <unsigned long N>
+	Oidx(const NS_SNMP OidLiteral<N>& literal) : Oid(literal) { }
+
 	/**
 	 * Copy constructor.
 	 *
@@ -88,6 +100,35 @@ public:
 	 */
 	Oidx(const Oid& oid) : Oid(oid) { }
 
+#ifdef SNMP_PP_RVALUE_REFS
+	/**
+	 * Copy constructor.
+	 *
+	 * @param oid - Another object identifier.
+	 */
+	Oidx(const Oidx& oid) : Oid(oid) { }
+
+	/**
+	 * Move constructor. The source is left invalid.
+	 *
+	 * @param oid - Another object identifier.
+	 */
+	Oidx(Oid&& oid) : Oid(std::move(oid)) { }
+	Oidx(Oidx&& oid) : Oid(std::move(oid)) { }
+
+	Oidx&		operator=(const Oidx& oid)
+	{
+		Oid::operator=(oid);
+		return *this;
+	}
+
+	Oidx&		operator=(Oidx&& oid)
+	{
+		Oid::operator=(std::move(oid));
+		return *this;
+	}
+#endif
+
 	/**
 	 * Destructor
 	 */
@@ -211,14 +252,7 @@ public:
 	using NS_SNMP Oid::operator = ;
 	virtual Oidx&  	operator = (unsigned long l)
 	{
-		// delete the old value
-		if ( smival.value.oid.ptr ) {
-			delete [] smival.value.oid.ptr;
-			smival.value.oid.ptr = NULL;
-		}
-		smival.value.oid.len = 1;
-		smival.value.oid.ptr = (SmiLPUINT32)new unsigned long[1];
-		smival.value.oid.ptr[0] = l;
+		set_data(&l, 1);
 		return *this;
 	}
 
@@ -245,9 +279,8 @@ public:
 	bool		in_subtree_of(const Oidx& o) const
 	{
 		if (len() <= o.len()) return FALSE;
-		for (unsigned int i=0; i<o.len(); i++)
-			if ((*this)[i] != o[i]) return FALSE;
-		return TRUE;
+		return NS_SNMP oid_prefix_match(o.smival.value.oid.ptr, o.len(),
+						smival.value.oid.ptr, len());
 	}
 
 	/**
@@ -260,9 +293,8 @@ public:
 	bool		is_root_of(const Oidx& o) const
 	{
 		if (len() >= o.len()) return false;
-		for (unsigned int i=0; i<len(); i++)
-			if ((*this)[i] != o[i]) return false;
-		return true;
+		return NS_SNMP oid_prefix_match(smival.value.oid.ptr, len(),
+						o.smival.value.oid.ptr, o.len());
 	}
 
 	/**
@@ -423,6 +455,10 @@ public:
 	Vbx(): Vb() { }
 	Vbx(const NS_SNMP Vb& vb): Vb(vb) { }
 	Vbx(const NS_SNMP Oid& oid): Vb(oid) { }
+#ifdef SNMP_PP_RVALUE_REFS
+	Vbx(NS_SNMP Vb&& vb): Vb(std::move(vb)) { }
+	Vbx(NS_SNMP Oid&& oid): Vb(std::move(oid)) { }
+#endif
 
 	/**
 	 * Constructor with oid and value.
@@ -684,6 +720,15 @@ public:
 	Pdux(NS_SNMP Vb* pvbs, const int pvb_count): Pdu(pvbs, pvb_count) { }
 	Pdux(const Pdu& pdu): Pdu(pdu) { }
 	Pdux(const Pdux& pdu): Pdu(pdu) { }
+#ifdef SNMP_PP_RVALUE_REFS
+	Pdux(NS_SNMP Pdu&& pdu): Pdu(std::move(pdu)) { }
+	Pdux(Pdux&& pdu): Pdu(std::move(pdu)) { }
+
+	Pdux&	operator=(const Pdux& pdu)
+		{ Pdu::operator=(pdu); return *this; }
+	Pdux&	operator=(Pdux&& pdu)
+		{ Pdu::operator=(std::move(pdu)); return *this; }
+#endif
 
 	virtual ~Pdux() { }
 
@@ -694,6 +739,9 @@ public:
 
 	// const redefinitions of originals: 
 	Pdux&   operator+=(const NS_SNMP Vb&);
+#ifdef SNMP_PP_RVALUE_REFS
+	Pdux&   operator+=(NS_SNMP Vb&&);
+#endif
 
 	/**
 	 * Clone the receiver.
@@ -728,7 +776,9 @@ public:
 	 * @param port
 	 *    an UDP port to be used for the session
 	 */
-	Snmpx (int &status , u_short port): Snmp(status, port) {};
+	Snmpx (int &status , u_short port): Snmp(status, port),
+	    sendQueue(0), sendBatch(0), sendQueueResults(0),
+	    sendBatchResults(0), sending(false), sendLock(0), receiveIndex(0) {};
 
 #ifdef SNMP_PP_WITH_UDPADDR
 	/**
@@ -740,14 +790,29 @@ public:
 	 *    hold the creation status.
 	 * @param address
 	 *    an UDP address to be used for the session
-	 */
-	Snmpx(int& status, const NS_SNMP UdpAddress& addr): Snmp(status, addr) { }
+	 * @param reuse_port
+	 *    if true, the socket is bound with SO_REUSEPORT, so that
+	 *    several sessions can receive requests on the same address
+	 *    (see MultiListener).
+	 */
+	Snmpx(int& status, const NS_SNMP UdpAddress& addr,
+	      bool reuse_port = false): Snmp(status, addr, reuse_port),
+	    sendQueue(0), sendBatch(0), sendQueueResults(0),
+	    sendBatchResults(0), sending(false), sendLock(0), receiveIndex(0) { }
 #endif
 
+	virtual ~Snmpx();
+
 #ifdef _SNMPv3
 	/**
 	 * Receive a SNMP PDU
 	 *
+	 * If batched reception has been enabled by
+	 * set_receive_batch_size(), all pending messages are read
+	 * from the socket at once and returned by the following calls
+	 * without reading from the socket again (see
+	 * get_pending_count()).
+	 *
 	 * @param timeout
 	 *    wait for an incoming PDU until timeout is exceeded
 	 * @param pdu
@@ -767,6 +832,12 @@ public:
 	/**
 	 * Receive a SNMP PDU
 	 *
+	 * If batched reception has been enabled by
+	 * set_receive_batch_size(), all pending messages are read
+	 * from the socket at once and returned by the following calls
+	 * without reading from the socket again (see
+	 * get_pending_count()).
+	 *
 	 * @param timeout
 	 *    wait for an incoming PDU until timeout is exceeded
 	 * @param pdu
@@ -841,10 +912,64 @@ public:
 	 */
 	SnmpSocket	get_session_fds() { return iv_snmp_session; }
 
+	/**
+	 * Return the number of received messages that are buffered
+	 * and will be returned by the next calls of receive() without
+	 * reading from the socket. Messages are only buffered if
+	 * batched reception has been enabled by
+	 * set_receive_batch_size().
+	 *
+	 * @return
+	 *    the number of buffered messages.
+	 */
+	int		get_pending_count() const;
+
+	/**
+	 * Enable batched sending of responses. While one thread is
+	 * sending, the messages of other threads are queued and then
+	 * sent by that thread with a single system call. Only
+	 * messages to IPv4 addresses are batched. A thread whose
+	 * message is queued waits until it has been sent and gets
+	 * the result of sending it.
+	 *
+	 * @note Call this method before requests are processed.
+	 *
+	 * @param count
+	 *    the maximum number of queued messages. A value of 1
+	 *    (the default) disables batched sending.
+	 */
+	void		set_send_batch_size(int);
 
 protected:
 	unsigned long ProcessizedReqId(unsigned short);
 	unsigned long MyMakeReqId();
+
+	int		send_datagram(unsigned char*, size_t,
+				      const NS_SNMP UdpAddress&);
+#ifdef _SNMPv3
+	int		receive_buffered(Pdux&, NS_SNMP UTarget&);
+	int		unload_message(unsigned char*, long,
+				       NS_SNMP UdpAddress&,
+				       Pdux&, NS_SNMP UTarget&);
+#else
+	int		receive_buffered(Pdux&, NS_SNMP UdpAddress&,
+					 NS_SNMP snmp_version&,
+					 NS_SNMP OctetStr&);
+#endif
+
+	NS_SNMP SnmpDatagramBatch*	sendQueue;
+	NS_SNMP SnmpDatagramBatch*	sendBatch;
+	// where to store the send result of each queued datagram
+	int**				sendQueueResults;
+	int**				sendBatchResults;
+	bool				sending;
+	// created by set_send_batch_size()
+#ifdef _THREADS
+	Synchronized*			sendLock;
+#else
+	NS_SNMP SnmpSynchronized*	sendLock;
+#endif
+	int				receiveIndex;
 };
 
 #ifdef AGENTPP_NAMESPACE
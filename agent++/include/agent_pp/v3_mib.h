@@ -77,6 +77,7 @@ class AGENTPP_DECL V3SnmpEngineMaxMessageSize: public MibLeaf {
 
 public:
        V3SnmpEngineMaxMessageSize();
+       void get_request(Request*, int);
 };
 
 
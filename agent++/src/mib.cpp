@@ -43,6 +43,11 @@ namespace Agentpp {
 
 static const char *loggerModuleName = "agent++.mib";
 
+// oid literals of the objects used in this module
+static SNMP_PP_OID_LITERAL(litSnmpProxyDrops, oidSnmpProxyDrops);
+static SNMP_PP_OID_LITERAL(litSysOREntry, oidSysOREntry);
+static SNMP_PP_OID_LITERAL(litZeroDotZero, "0.0");
+
 /*--------------------------------------------------------------------
  *
  * MibLeaf
@@ -697,7 +702,6 @@ long snmpRowStatus::get()
 
 MibTableRow::MibTableRow()
 {
-	base  = "";
 	index = "";
 	row_status = 0;
 }
@@ -2969,7 +2973,7 @@ bool Mib::add_agent_caps(const OctetStr& context,
 {
 	MibContext* c = get_context(context);
 	if (!c) return FALSE;
-	sysOREntry* e = (sysOREntry*)c->get(oidSysOREntry);
+	sysOREntry* e = (sysOREntry*)c->get(litSysOREntry);
 	if ((!e) || (e->type() != AGENTPP_TABLE)) return FALSE;
 	MibTableRow* r = e->find(sysORID);
 	if (!r)
@@ -2983,7 +2987,7 @@ void Mib::remove_agent_caps(const OctetStr& context,
 {
 	MibContext* c = get_context(context);
 	if (!c) return;
-	sysOREntry* e = (sysOREntry*)c->get(oidSysOREntry);
+	sysOREntry* e = (sysOREntry*)c->get(litSysOREntry);
 	if (!e) return;
 	MibTableRow* r = e->find(sysORID);
 	if (r)
@@ -3330,7 +3334,12 @@ void Mib::process_request(Request* req)
 					  &Mib::do_process_request, req);
 #ifdef AGENTPP_USE_THREAD_POOL
 	MibTask* mt = new MibTask(call);
-	threadPool->execute(mt);
+	// requests of a listener shard are processed by its own pool
+	ThreadPool* pool = threadPool;
+	if ((req->get_request_list()) && 
+	    (req->get_request_list()->get_thread_pool()))
+		pool = req->get_request_list()->get_thread_pool();
+	pool->execute(mt);
 #else
 #ifdef _WIN32THREADS
 	_beginthread(mib_method_routine_caller, 0, call);
@@ -3413,20 +3422,20 @@ void Mib::proxy_request(Request* req)
 		key += t;
 		proxy = proxies.find(&key);
 		if (!proxy) { // fall back
-			key = "0.0";
+			key = litZeroDotZero;
 			proxy = proxies.find(&key);
 		}
 
 	}
 	if ((!proxy) || ((proxy) && (!proxy->process_request(req)))) {
 		MibIIsnmpCounters::incProxyDrops();
-		Vbx vb(oidSnmpProxyDrops);
+		Vbx vb(litSnmpProxyDrops);
 		vb.set_value(MibIIsnmpCounters::proxyDrops());
 		req->get_pdu()->set_vblist(&vb, 1);
-		requestList->report(req);
+		get_request_list(req)->report(req);
 	}
 	else {
-		requestList->answer(req);
+		get_request_list(req)->answer(req);
 	}
     delete_request(req);
 }
@@ -4018,8 +4027,8 @@ void Mib::finalize(Request* req)
 	// If responding to a BULK request, trim response to N+M*R variables
 	// and make sure we are using right OIDs for ENDOFMIBVIEW vbs.
 	req->trim_bulk_response();
-    if (requestList) {
-        requestList->answer(req);
+    if (get_request_list(req)) {
+        get_request_list(req)->answer(req);
         delete_request(req);
     }
     else {
@@ -0,0 +1,204 @@
+/*_############################################################################
+  _##
+  _##  AGENT++ 4.0 - multi_listener.cpp
+  _##
+  _##  Copyright (C) 2000-2013  Frank Fock and Jochen Katz (agentpp.com)
+  _##
+  _##  Licensed under the Apache License, Version 2.0 (the "License");
+  _##  you may not use this file except in compliance with the License.
+  _##  You may obtain a copy of the License at
+  _##
+  _##      http://www.apache.org/licenses/LICENSE-2.0
+  _##
+  _##  Unless required by applicable law or agreed to in writing, software
+  _##  distributed under the License is distributed on an "AS IS" BASIS,
+  _##  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  _##  See the License for the specific language governing permissions and
+  _##  limitations under the License.
+  _##
+  _##########################################################################*/
+
+#include <libagent.h>
+
+#include <agent_pp/multi_listener.h>
+#include <agent_pp/mib.h>
+#include <snmp_pp/log.h>
+
+#if defined(AGENTPP_USE_THREAD_POOL) && defined(SNMP_PP_WITH_UDPADDR)
+
+#ifdef SNMP_PP_NAMESPACE
+using namespace Snmp_pp;
+#endif
+
+#ifdef AGENTPP_NAMESPACE
+namespace Agentpp {
+#endif
+
+static const char *loggerModuleName = "agent++.multi_listener";
+
+/*------------------------ class RequestListener ----------------------*/
+
+RequestListener::RequestListener(Mib* m, const UdpAddress& address,
+				 int poolSize)
+    : mib(m)
+    , snmp(0)
+    , requestList(0)
+    , threadPool(0)
+    , counters()
+    , thread(*this)
+    , status(SNMP_CLASS_ERROR)
+    , go(false)
+{
+	snmp = new Snmpx(status, address, true);
+	requestList = new RequestList();
+	requestList->set_snmp(snmp);
+	requestList->set_counters(&counters);
+	threadPool = new QueuedThreadPool(poolSize);
+	threadPool->start();
+	requestList->set_thread_pool(threadPool);
+}
+
+RequestListener::~RequestListener()
+{
+	stop();
+	// wait for the requests in progress before their list is deleted
+	delete threadPool;
+	delete requestList;
+	delete snmp;
+}
+
+void RequestListener::start()
+{
+	if (go)
+		return;
+	go = true;
+	thread.start();
+}
+
+void RequestListener::stop()
+{
+	if (!go)
+		return;
+	go = false;
+	thread.join();
+}
+
+void RequestListener::run()
+{
+	Request* requests[AGENTPP_LISTENER_BATCH_SIZE];
+
+	LOG_BEGIN(loggerModuleName, INFO_LOG | 3);
+	LOG("RequestListener: started (listener)");
+	LOG((long)this);
+	LOG_END;
+
+	while (go) {
+		int n = requestList->receive_batch(1, requests,
+						   AGENTPP_LISTENER_BATCH_SIZE);
+		for (int i=0; i<n; i++) {
+			mib->process_request(requests[i]);
+		}
+	}
+
+	LOG_BEGIN(loggerModuleName, INFO_LOG | 3);
+	LOG("RequestListener: stopped (listener)");
+	LOG((long)this);
+	LOG_END;
+}
+
+
+/*------------------------- class MultiListener -----------------------*/
+
+MultiListener::MultiListener(Mib* m, const UdpAddress& address,
+			     int n, int poolSize)
+    : mib(m)
+    , listeners()
+    , status(SNMP_CLASS_SUCCESS)
+{
+	for (int i=0; i<n; i++) {
+		RequestListener* l = new RequestListener(mib, address, poolSize);
+		listeners.add(l);
+		if (l->get_status() != SNMP_CLASS_SUCCESS) {
+			status = l->get_status();
+
+			LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
+			LOG("MultiListener: could not bind listener (addr)(index)(status)");
+			LOG(address.get_printable());
+			LOG(i);
+			LOG(status);
+			LOG_END;
+			break;
+		}
+	}
+}
+
+MultiListener::~MultiListener()
+{
+	stop();
+	if ((listeners.size() > 0) &&
+	    (mib->get_request_list() ==
+	     listeners.getNth(0)->get_request_list()))
+		mib->set_request_list(0);
+	listeners.clearAll();
+}
+
+#ifdef _SNMPv3
+void MultiListener::set_v3mp(v3MP* mp)
+{
+	for (int i=0; i<listeners.size(); i++)
+		listeners.getNth(i)->get_request_list()->set_v3mp(mp);
+}
+
+void MultiListener::set_vacm(Vacm* vacm)
+{
+	for (int i=0; i<listeners.size(); i++)
+		listeners.getNth(i)->get_request_list()->set_vacm(vacm);
+}
+#else
+void MultiListener::set_read_community(const OctetStr& community)
+{
+	for (int i=0; i<listeners.size(); i++)
+		listeners.getNth(i)->get_request_list()->
+		    set_read_community(community);
+}
+
+void MultiListener::set_write_community(const OctetStr& community)
+{
+	for (int i=0; i<listeners.size(); i++)
+		listeners.getNth(i)->get_request_list()->
+		    set_write_community(community);
+}
+#endif
+
+void MultiListener::set_address_validation(bool validation)
+{
+	for (int i=0; i<listeners.size(); i++)
+		listeners.getNth(i)->get_request_list()->
+		    set_address_validation(validation);
+}
+
+void MultiListener::set_receive_batch_size(int count)
+{
+	for (int i=0; i<listeners.size(); i++)
+		listeners.getNth(i)->get_snmp()->set_receive_batch_size(count);
+}
+
+void MultiListener::start()
+{
+	if ((listeners.size() > 0) && (!mib->get_request_list()))
+		mib->set_request_list(listeners.getNth(0)->get_request_list());
+	for (int i=0; i<listeners.size(); i++)
+		listeners.getNth(i)->start();
+}
+
+void MultiListener::stop()
+{
+	for (int i=0; i<listeners.size(); i++)
+		listeners.getNth(i)->stop();
+}
+
+#ifdef AGENTPP_NAMESPACE
+}
+#endif
+
+#endif // AGENTPP_USE_THREAD_POOL && SNMP_PP_WITH_UDPADDR
@@ -50,6 +50,17 @@ namespace Agentpp {
 
 static const char *loggerModuleName = "agent++.notification_log_mib";
 
+// oid literals of the objects used in this module
+static SNMP_PP_OID_LITERAL(litNlmConfigGlobalAgeOut, oidNlmConfigGlobalAgeOut);
+static SNMP_PP_OID_LITERAL(litNlmConfigGlobalEntryLimit, oidNlmConfigGlobalEntryLimit);
+static SNMP_PP_OID_LITERAL(litNlmConfigLogEntry, oidNlmConfigLogEntry);
+static SNMP_PP_OID_LITERAL(litNlmLogEntry, oidNlmLogEntry);
+static SNMP_PP_OID_LITERAL(litNlmLogVariableEntry, oidNlmLogVariableEntry);
+static SNMP_PP_OID_LITERAL(litNlmStatsGlobalNotificationsBumped, oidNlmStatsGlobalNotificationsBumped);
+static SNMP_PP_OID_LITERAL(litNlmStatsGlobalNotificationsLogged, oidNlmStatsGlobalNotificationsLogged);
+static SNMP_PP_OID_LITERAL(litNlmStatsLogEntry, oidNlmStatsLogEntry);
+static SNMP_PP_OID_LITERAL(litNotificationLogMIB, "1.3.6.1.2.1.92");
+
 nlmConfigLogOperStatus::nlmConfigLogOperStatus(const Oidx& id):
   MibLeaf(id, READONLY, new SnmpInt32(1), VMODE_DEFAULT)
 {
@@ -98,7 +109,7 @@ MibEntryPtr nlmConfigLogOperStatus::clone()
 nlmConfigGlobalEntryLimit* nlmConfigGlobalEntryLimit::instance = 0;
 
 nlmConfigGlobalEntryLimit::nlmConfigGlobalEntryLimit():
-   MibLeaf(oidNlmConfigGlobalEntryLimit, READWRITE, new Gauge32(0), VMODE_DEFAULT)
+   MibLeaf(litNlmConfigGlobalEntryLimit, READWRITE, new Gauge32(0), VMODE_DEFAULT)
 {
 	// This leaf object is a singleton. In order to access it use
 	// the static pointer nlmConfigGlobalEntryLimit::instance.
@@ -179,7 +190,7 @@ int nlmConfigGlobalEntryLimit::prepare_set_request(Request* req, int& ind)
 nlmConfigGlobalAgeOut* nlmConfigGlobalAgeOut::instance = 0;
 
 nlmConfigGlobalAgeOut::nlmConfigGlobalAgeOut():
-   MibLeaf(oidNlmConfigGlobalAgeOut, READWRITE, new Gauge32(1440), VMODE_DEFAULT)
+   MibLeaf(litNlmConfigGlobalAgeOut, READWRITE, new Gauge32(1440), VMODE_DEFAULT)
 {
 	// This leaf object is a singleton. In order to access it use
 	// the static pointer nlmConfigGlobalAgeOut::instance.
@@ -748,7 +759,7 @@ int nlmConfigLogEntryStatus::commit_set_request(Request* req, int ind)
 nlmStatsGlobalNotificationsLogged* nlmStatsGlobalNotificationsLogged::instance = 0;
 
 nlmStatsGlobalNotificationsLogged::nlmStatsGlobalNotificationsLogged():
-   MibLeaf(oidNlmStatsGlobalNotificationsLogged, READONLY, new Counter32())
+   MibLeaf(litNlmStatsGlobalNotificationsLogged, READONLY, new Counter32())
 {
 	// This leaf object is a singleton. In order to access it use
 	// the static pointer nlmStatsGlobalNotificationsLogged::instance.
@@ -812,7 +823,7 @@ unsigned long nlmStatsGlobalNotificationsLogged::inc()
 nlmStatsGlobalNotificationsBumped* nlmStatsGlobalNotificationsBumped::instance = 0;
 
 nlmStatsGlobalNotificationsBumped::nlmStatsGlobalNotificationsBumped():
-   MibLeaf(oidNlmStatsGlobalNotificationsBumped, READONLY, new Counter32())
+   MibLeaf(litNlmStatsGlobalNotificationsBumped, READONLY, new Counter32())
 {
 	// This leaf object is a singleton. In order to access it use
 	// the static pointer nlmStatsGlobalNotificationsBumped::instance.
@@ -879,7 +890,7 @@ const index_info indNlmConfigLogEntry[1] = {
 	{ sNMP_SYNTAX_OCTETS, FALSE, 0, 255 } };
 
 nlmConfigLogEntry::nlmConfigLogEntry():
-   StorageTable(oidNlmConfigLogEntry, indNlmConfigLogEntry, 1)
+   StorageTable(litNlmConfigLogEntry, indNlmConfigLogEntry, 1)
 {
 	// This table object is a singleton. In order to access it use
 	// the static pointer nlmConfigLogEntry::instance.
@@ -959,7 +970,7 @@ const index_info indNlmStatsLogEntry[1] = {
 	{ sNMP_SYNTAX_OCTETS, FALSE, 0, 255 } };
 
 nlmStatsLogEntry::nlmStatsLogEntry():
-   MibTable(oidNlmStatsLogEntry, indNlmStatsLogEntry, 1)
+   MibTable(litNlmStatsLogEntry, indNlmStatsLogEntry, 1)
 {
 	// This table object is a singleton. In order to access it use
 	// the static pointer nlmStatsLogEntry::instance.
@@ -1037,7 +1048,7 @@ const index_info indNlmLogEntry[2] = {
 	 { sNMP_SYNTAX_INT, FALSE, 1, 1 } };
 
 nlmLogEntry::nlmLogEntry():
-   MibTable(oidNlmLogEntry, indNlmLogEntry, 2)
+   MibTable(litNlmLogEntry, indNlmLogEntry, 2)
 {
 	// This table object is a singleton. In order to access it use
 	// the static pointer nlmLogEntry::instance.
@@ -1399,7 +1410,7 @@ const index_info indNlmLogVariableEntry[3] = {
 	 { sNMP_SYNTAX_INT, FALSE, 1, 1 } };
 
 nlmLogVariableEntry::nlmLogVariableEntry():
-   MibTable(oidNlmLogVariableEntry, indNlmLogVariableEntry, 3)
+   MibTable(litNlmLogVariableEntry, indNlmLogVariableEntry, 3)
 {
 	// This table object is a singleton. In order to access it use
 	// the static pointer nlmLogVariableEntry::instance.
@@ -1584,7 +1595,7 @@ void nlmLogVariableEntry::add_variable(const Oidx& index,
 
 
 notification_log_mib::notification_log_mib():
-   MibGroup("1.3.6.1.2.1.92", "notificationLogMIB")
+   MibGroup(litNotificationLogMIB, "notificationLogMIB")
 {
 
 	//--AgentGen BEGIN=notification_log_mib::notification_log_mib
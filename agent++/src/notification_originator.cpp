@@ -41,6 +41,9 @@ namespace Agentpp {
 
 static const char *loggerModuleName = "agent++.notification_originator";
 
+// oid literals of the objects used in this module
+static SNMP_PP_OID_LITERAL(litSnmpUDPDomain, "1.3.6.1.6.1.1");
+
 /*------------------ class NotificationOriginator -----------------------*/
 
 NotificationOriginator::NotificationOriginator()
@@ -449,7 +452,7 @@ bool NotificationOriginator::add_v1_trap_destination(const UdpAddress& addr,
 	}
 	if (snmpTargetAddrEntry::instance->
 		add_entry(UdpAddress(addr).get_printable(),  // row index
-			  Oidx("1.3.6.1.6.1.1"),    // UDP domain
+			  Oidx(litSnmpUDPDomain),   // UDP domain
 			  address,                  // target address
 			  tag,                      // tag
 			  name))                   // params entry
@@ -484,7 +487,7 @@ bool NotificationOriginator::add_v2_trap_destination(const UdpAddress& addr,
 	}
 	if (snmpTargetAddrEntry::instance->
 		add_entry(UdpAddress(addr).get_printable(),  // row index
-			  Oidx("1.3.6.1.6.1.1"),    // UDP domain
+			  Oidx(litSnmpUDPDomain),   // UDP domain
 			  address,                  // target address
 			  tag,                      // tag
 			  name))                   // params entry
@@ -521,7 +524,7 @@ bool NotificationOriginator::add_v3_trap_destination(const UdpAddress& addr,
 	}
 	if (snmpTargetAddrEntry::instance->
 		add_entry(UdpAddress(addr).get_printable(),  // row index
-			  Oidx("1.3.6.1.6.1.1"),    // UDP domain
+			  Oidx(litSnmpUDPDomain),   // UDP domain
 			  address,                  // target address
 			  tag,                      // tag
 			  name))                   // params entry
@@ -0,0 +1,159 @@
+/*_############################################################################
+  _##
+  _##  AGENT++ 4.0 - oidx_pool.cpp
+  _##
+  _##  Copyright (C) 2000-2013  Frank Fock and Jochen Katz (agentpp.com)
+  _##
+  _##  Licensed under the Apache License, Version 2.0 (the "License");
+  _##  you may not use this file except in compliance with the License.
+  _##  You may obtain a copy of the License at
+  _##
+  _##      http://www.apache.org/licenses/LICENSE-2.0
+  _##
+  _##  Unless required by applicable law or agreed to in writing, software
+  _##  distributed under the License is distributed on an "AS IS" BASIS,
+  _##  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  _##  See the License for the specific language governing permissions and
+  _##  limitations under the License.
+  _##
+  _##########################################################################*/
+
+#include <libagent.h>
+
+#include <agent_pp/oidx_pool.h>
+
+#ifdef SNMP_PP_NAMESPACE
+using namespace Snmp_pp;
+#endif
+
+#ifdef AGENTPP_NAMESPACE
+namespace Agentpp {
+#endif
+
+/*--------------------------- class OidxPool --------------------------*/
+
+OidxPool* OidxPool::instance = 0;
+
+OidxPool::OidxPool()
+{
+}
+
+OidxPool::~OidxPool()
+{
+	entries.clearAll();
+}
+
+OidxPool* OidxPool::get_instance()
+{
+#if defined(_THREADS) && defined(__GNUC__) && defined(__ATOMIC_ACQUIRE)
+	// the acquire load pairs with the release store below, so a
+	// thread that sees the pointer also sees the constructed pool
+	OidxPool* pool = __atomic_load_n(&instance, __ATOMIC_ACQUIRE);
+	if (pool)
+		return pool;
+	start_global_synch();
+	pool = instance;
+	if (!pool) {
+		// never deleted, handles may be released at exit
+		pool = new OidxPool();
+		__atomic_store_n(&instance, pool, __ATOMIC_RELEASE);
+	}
+	end_global_synch();
+	return pool;
+#else
+	start_global_synch();
+	if (!instance) {
+		// never deleted, handles may be released at exit
+		instance = new OidxPool();
+	}
+	OidxPool* pool = instance;
+	end_global_synch();
+	return pool;
+#endif
+}
+
+OidxPoolEntry* OidxPool::acquire(const Oidx& oid)
+{
+	start_synch();
+	OidxPoolEntry* entry = entries.find((Oidx*)&oid);
+	if (entry) {
+		entry->refs++;
+	}
+	else {
+		entry = entries.add(new OidxPoolEntry(oid));
+	}
+	end_synch();
+	return entry;
+}
+
+void OidxPool::acquire(OidxPoolEntry* entry)
+{
+	start_synch();
+	entry->refs++;
+	end_synch();
+}
+
+void OidxPool::release(OidxPoolEntry* entry)
+{
+	start_synch();
+	if (--entry->refs == 0) {
+		entries.remove(entry);
+		delete entry;
+	}
+	end_synch();
+}
+
+int OidxPool::size()
+{
+	start_synch();
+	int n = entries.size();
+	end_synch();
+	return n;
+}
+
+/*-------------------------- class OidxPrefix -------------------------*/
+
+const Oidx OidxPrefix::empty_oid;
+
+OidxPrefix::OidxPrefix(const Oidx& oid)
+{
+	entry = (oid.len() > 0) ? OidxPool::get_instance()->acquire(oid) : 0;
+}
+
+OidxPrefix::OidxPrefix(const OidxPrefix& other)
+{
+	entry = other.entry;
+	if (entry)
+		OidxPool::get_instance()->acquire(entry);
+}
+
+OidxPrefix::~OidxPrefix()
+{
+	if (entry)
+		OidxPool::get_instance()->release(entry);
+}
+
+OidxPrefix& OidxPrefix::operator=(const OidxPrefix& other)
+{
+	if (entry == other.entry)
+		return *this;
+	if (other.entry)
+		OidxPool::get_instance()->acquire(other.entry);
+	if (entry)
+		OidxPool::get_instance()->release(entry);
+	entry = other.entry;
+	return *this;
+}
+
+OidxPrefix& OidxPrefix::operator=(const Oidx& oid)
+{
+	OidxPoolEntry* old = entry;
+	entry = (oid.len() > 0) ? OidxPool::get_instance()->acquire(oid) : 0;
+	if (old)
+		OidxPool::get_instance()->release(old);
+	return *this;
+}
+
+#ifdef AGENTPP_NAMESPACE
+}
+#endif
@@ -41,6 +41,11 @@ namespace Agentpp {
 
 static const char *loggerModuleName = "agent++.request";
 
+#ifdef _SNMPv3
+// oid literals of the objects used in this module
+static SNMP_PP_OID_LITERAL(litSnmpUnknownContexts, oidSnmpUnknownContexts);
+#endif
+
 /*--------------------------- class Request --------------------------*/
 
 #ifdef NO_FAST_MUTEXES
@@ -65,6 +70,7 @@ Request::Request()
     , repeater(0)
     , version()
     , transaction_id(0)
+    , requestList(0)
     , locks()
 #ifdef _SNMPv3
     , viewName()
@@ -95,6 +101,7 @@ Request::Request(const Pdux& p, const TargetType &t)
     , repeater(0)
     , version()
     , transaction_id(0)
+    , requestList(0)
     , locks()
 #ifdef _SNMPv3 
     , viewName()
@@ -138,6 +145,13 @@ void Request::init_from_pdu()
 			trim_request(non_rep);
 		}
 		repeater = size-non_rep;
+		// Allocate the vbs of the first rows of the response in one
+		// block, add_rep_row() makes room for more rows.
+		int vbs = get_max_bulk_vbs();
+		if (vbs > non_rep + repeater*REQUEST_BULK_INITIAL_ROWS)
+			vbs = non_rep + repeater*REQUEST_BULK_INITIAL_ROWS;
+		if (vbs > size)
+			pdu->reserve(vbs);
 	}
 	else {
 		repeater = 0;
@@ -179,6 +193,7 @@ Request::Request(const Request& other)
 	repeater = other.repeater;
 	version = other.version;
 	transaction_id = other.transaction_id;
+	requestList = other.requestList;
 #ifdef _SNMPv3
 	viewName = other.viewName;
 	vacm = other.vacm;
@@ -539,6 +554,8 @@ bool Request::add_rep_row()
 	if (pdu->get_asn1_length() >= get_max_response_length())
 		return FALSE;
 
+	reserve_rep_row();
+
 	Vbx vb;
 	for (int i=(rows-1)*repeater+non_rep; i<(rows*repeater)+non_rep; i++) {
 
@@ -575,6 +592,37 @@ bool Request::add_rep_row()
 	return TRUE;
 }
 
+/**
+ * Get the maximum number of vbs of a GETBULK response. A vb needs at
+ * least REQUEST_MIN_VB_LENGTH bytes in the response, so more vbs than
+ * fit into a message can not be returned anyway.
+ */
+int Request::get_max_bulk_vbs() const
+{
+	int max_vbs = MessageBuffer::get_max_message_size() /
+	  REQUEST_MIN_VB_LENGTH;
+	if ((repeater > 0) && (max_rep > (max_vbs - non_rep)/repeater))
+		return max_vbs;
+	return non_rep + repeater*max_rep;
+}
+
+/**
+ * Make room for another repetition in the response PDU. The room is
+ * doubled when it is used up, up to get_max_bulk_vbs().
+ */
+void Request::reserve_rep_row()
+{
+	int vbs = pdu->get_vb_count() + repeater;
+	if (vbs <= pdu->get_reserved())
+		return;
+	int max_vbs = get_max_bulk_vbs();
+	if (2*vbs <= max_vbs)
+		vbs *= 2;
+	else if (vbs < max_vbs)
+		vbs = max_vbs;
+	pdu->reserve(vbs);
+}
+
 bool Request::init_rep_row(int row)
 {
 	int start = non_rep + row * repeater;
@@ -753,13 +801,15 @@ void Request::trim_bulk_response()
 
 int Request::get_max_response_length() 
 { 
+	unsigned long max_size = MessageBuffer::get_max_message_size();
 #ifdef _SNMPv3
+	// v1/v2c have no msgMaxSize, the local maximum is used
 	if (version < version3) 
-		return MAX_SNMP_PACKET;
-	return (pdu->get_maxsize_scopedpdu()>=MAX_SNMP_PACKET)
-		  ? MAX_SNMP_PACKET : pdu->get_maxsize_scopedpdu(); 
+		return (int)max_size;
+	return (pdu->get_maxsize_scopedpdu()>=max_size)
+		  ? (int)max_size : (int)pdu->get_maxsize_scopedpdu(); 
 #else
-	return MAX_SNMP_PACKET;
+	return (int)max_size;
 #endif
 }
 
@@ -778,6 +828,10 @@ RequestList::RequestList()
     , read_community(new OctetStr(DEFAULT_READ_COMMUNITY))
     , next_transaction_id(0)
     , sourceAddressValidation(false)
+    , counters(0)
+#ifdef AGENTPP_USE_THREAD_POOL
+    , threadPool(0)
+#endif
 {
 }
 
@@ -882,7 +936,7 @@ bool RequestList::community_ok(int pdutype, const OctetStr& community)
 			return TRUE;
 		else {
 			if (*read_community == community) { 
-				MibIIsnmpCounters::incInBadCommunityUses();
+				MibIIsnmpCounters::incInBadCommunityUses(counters);
 			}
 			return FALSE;
 		}
@@ -921,7 +975,7 @@ void RequestList::report(Request* req)
 
 	Pdux* pdu = req->get_pdu();
 
-	MibIIsnmpCounters::incOutPkts();
+	MibIIsnmpCounters::incOutPkts(counters);
 
 	pdu->set_error_status(0);
 	pdu->set_error_index(0);
@@ -1005,13 +1059,13 @@ void RequestList::answer(Request* req)
 		case sNMP_SYNTAX_NOSUCHOBJECT: {
 
 			if (req->version >= version2c)
-				MibIIsnmpCounters::incOutNoSuchNames();
+				MibIIsnmpCounters::incOutNoSuchNames(counters);
 			break;
 		}
 		case sNMP_SYNTAX_NOSUCHINSTANCE: {
 
 			if (req->version >= version2c)
-				MibIIsnmpCounters::incOutBadValues();
+				MibIIsnmpCounters::incOutBadValues(counters);
 			break;
 		}
 		case sNMP_SYNTAX_ENDOFMIBVIEW: {
@@ -1019,9 +1073,9 @@ void RequestList::answer(Request* req)
 		}
 		default:
 			if (pdu->get_type() == sNMP_PDU_SET) 
-				MibIIsnmpCounters::incInTotalSetVars();
+				MibIIsnmpCounters::incInTotalSetVars(counters);
 			else 
-				MibIIsnmpCounters::incInTotalReqVars();
+				MibIIsnmpCounters::incInTotalReqVars(counters);
 		}
 	}
 
@@ -1030,25 +1084,25 @@ void RequestList::answer(Request* req)
 	    null_vbs(req);
 	}
 
-	MibIIsnmpCounters::incOutPkts();
+	MibIIsnmpCounters::incOutPkts(counters);
 
 	switch (pdu->get_type()) {
 	case sNMP_PDU_GET: {
-		MibIIsnmpCounters::incInGetRequests();
+		MibIIsnmpCounters::incInGetRequests(counters);
 		break;
 	}
 	case sNMP_PDU_GETBULK:
 	case sNMP_PDU_GETNEXT: {
-		MibIIsnmpCounters::incInGetNexts();
+		MibIIsnmpCounters::incInGetNexts(counters);
 		break;
 	}
 	case sNMP_PDU_SET: {
-		MibIIsnmpCounters::incInSetRequests();
+		MibIIsnmpCounters::incInSetRequests(counters);
 		break;
 	}
 	case sNMP_PDU_V1TRAP:
 	case sNMP_PDU_TRAP: {
-		MibIIsnmpCounters::incInTraps();
+		MibIIsnmpCounters::incInTraps(counters);
 		requests->remove(req);
 		return; // do not answer traps
 	}
@@ -1082,20 +1136,20 @@ void RequestList::answer(Request* req)
 
 	switch (pdu->get_error_status()) {
 	case SNMP_ERROR_TOO_BIG: {
-		MibIIsnmpCounters::incOutTooBigs();
+		MibIIsnmpCounters::incOutTooBigs(counters);
 		break;
 	}
 	case SNMP_ERROR_NO_SUCH_NAME: {
-		MibIIsnmpCounters::incOutNoSuchNames();
+		MibIIsnmpCounters::incOutNoSuchNames(counters);
 		break;
 	}
 	case SNMP_ERROR_BAD_VALUE: {
-		MibIIsnmpCounters::incOutBadValues();
+		MibIIsnmpCounters::incOutBadValues(counters);
 		break;
 	}
 	default: {
 		if (pdu->get_error_status() != SNMP_ERROR_SUCCESS) 
-			MibIIsnmpCounters::incOutGenErrs();
+			MibIIsnmpCounters::incOutGenErrs(counters);
 		break;
 	}
 	}
@@ -1146,10 +1200,10 @@ void RequestList::answer(Request* req)
 					     req->target.get_version(), 
 					     req->target.get_readcommunity());
 #endif
-			MibIIsnmpCounters::incOutTooBigs();
+			MibIIsnmpCounters::incOutTooBigs(counters);
 		}
 	}
-	MibIIsnmpCounters::incOutGetResponses();
+	MibIIsnmpCounters::incOutGetResponses(counters);
 
 	LOG_BEGIN(loggerModuleName, EVENT_LOG | 2);
 	LOG("RequestList: request answered (rid)(tid)(to)(err)(send)(sz)");
@@ -1206,7 +1260,7 @@ Request* RequestList::receive(int sec)
 
 	if (status != SNMP_CLASS_TL_FAILED)
 	        // do not increment incoming packets for timeouts on select
-		MibIIsnmpCounters::incInPkts();
+		MibIIsnmpCounters::incInPkts(counters);
 
 	if ((status == SNMP_CLASS_SUCCESS) ||
 	    (status == SNMP_ERROR_TOO_BIG)) {
@@ -1298,7 +1352,7 @@ Request* RequestList::receive(int sec)
 					      target.get_address(),
 					      0);
 
-			MibIIsnmpCounters::incInBadCommunityNames();
+			MibIIsnmpCounters::incInBadCommunityNames(counters);
 			
 			return 0;
 		    }
@@ -1339,7 +1393,7 @@ Request* RequestList::receive(int sec)
 
 			v3mp->inc_stats_invalid_msgs();
 
-			MibIIsnmpCounters::incInTooBigs();
+			MibIIsnmpCounters::incInTooBigs(counters);
 			
 			LOG_BEGIN(loggerModuleName, WARNING_LOG | 1);
 			LOG("RequestList: too big SNMP PDU received (rid): ");
@@ -1352,7 +1406,7 @@ Request* RequestList::receive(int sec)
 			
 			pdu.set_type(sNMP_PDU_RESPONSE);
 				
-			MibIIsnmpCounters::incOutPkts();
+			MibIIsnmpCounters::incOutPkts(counters);
 				
 			snmp->send (pdu, &target);
 			return 0;
@@ -1393,7 +1447,7 @@ Request* RequestList::receive(int sec)
 			LOG_END;
 			v3mp->inc_stats_invalid_msgs();
 			v3mp->inc_stats_unknown_pdu_handlers();
-			MibIIsnmpCounters::incInASNParseErrs();
+			MibIIsnmpCounters::incInASNParseErrs(counters);
 			return 0;
 		}
 		}
@@ -1427,12 +1481,12 @@ Request* RequestList::receive(int sec)
 				LOG(vacm->getErrorMsg(vacmErrorCode));
 				LOG_END;
 			
-				MibIIsnmpCounters::incOutPkts();
+				MibIIsnmpCounters::incOutPkts(counters);
 				
 				snmp->send (pdu, &target);
 			}
 			else {
-				MibIIsnmpCounters::incInBadCommunityNames();
+				MibIIsnmpCounters::incInBadCommunityNames(counters);
 			}
 
 			authenticationFailure(context_name,
@@ -1453,7 +1507,7 @@ Request* RequestList::receive(int sec)
                         LOG(vacmErrorCode);
 			LOG_END;
 
-			MibIIsnmpCounters::incOutPkts();
+			MibIIsnmpCounters::incOutPkts(counters);
 
 			snmp->send(pdu, &target);
                         return 0;
@@ -1464,7 +1518,7 @@ Request* RequestList::receive(int sec)
                         vacm->incUnknownContexts();
                         for (int j = 0; j<pdu.get_vb_count(); j++) 
                           pdu.delete_vb(0);
-                        Vbx newvb = Vbx(oidSnmpUnknownContexts);
+                        Vbx newvb = Vbx(litSnmpUnknownContexts);
 			newvb.set_value(vacm->getUnknownContexts());
                         pdu +=newvb;
                         pdu.set_type(sNMP_PDU_RESPONSE);
@@ -1499,7 +1553,7 @@ Request* RequestList::receive(int sec)
 					      target.get_address(),
 					      0);
 
-			MibIIsnmpCounters::incInBadCommunityNames();
+			MibIIsnmpCounters::incInBadCommunityNames(counters);
 			return 0;
 		}
 		else
@@ -1525,11 +1579,11 @@ Request* RequestList::receive(int sec)
 		case SNMPv3_MP_PARSE_ERROR:
 		case SNMP_CLASS_ERROR: 
 		case SNMP_CLASS_ASN1ERROR: {
-			MibIIsnmpCounters::incInASNParseErrs();
+			MibIIsnmpCounters::incInASNParseErrs(counters);
 			break;
 		}
 		case SNMP_CLASS_BADVERSION: {
-			MibIIsnmpCounters::incInBadVersions();
+			MibIIsnmpCounters::incInBadVersions(counters);
 			break;
 		}
                 case SNMPv3_MP_UNKNOWN_PDU_HANDLERS: {
@@ -1571,13 +1625,31 @@ Request* RequestList::receive(int sec)
 		}
 */
 		default:
-			MibIIsnmpCounters::incInASNParseErrs();
+			MibIIsnmpCounters::incInASNParseErrs(counters);
 			break;		  
 		}
 	}	
 	return 0;
 }
 
+int RequestList::receive_batch(int sec, Request** requests, int max_requests)
+{
+	int n = 0;
+	if (max_requests <= 0) return 0;
+
+	Request* req = receive(sec);
+	if (req) requests[n++] = req;
+
+	// collect the requests that have been read with the same system
+	// call without waiting again
+	while ((snmp) && (n < max_requests) && 
+	       (snmp->get_pending_count() > 0)) {
+		req = receive(0);
+		if (req) requests[n++] = req;
+	}
+	return n;
+}
+
 Request* RequestList::add_request(Request* req)
 TS_SYNCHRONIZED(
 {
@@ -1590,6 +1662,7 @@ TS_SYNCHRONIZED(
 		    req->from.get_printable()) != 0)) {
 		
 		req->set_transaction_id(next_transaction_id++);
+		req->requestList = this;
 		requests->add(req);
 		return req;
 	}
@@ -32,6 +32,11 @@ namespace Agentpp {
 
 static const char *loggerModuleName = "agent++.snmp_community_mib";
 
+// oid literals of the objects used in this module
+static SNMP_PP_OID_LITERAL(litSnmpCommunityEntry, oidSnmpCommunityEntry);
+static SNMP_PP_OID_LITERAL(litSnmpCommunityMIBObjects, "1.3.6.1.6.3.18.1");
+static SNMP_PP_OID_LITERAL(litSnmpTargetAddrExtEntry, oidSnmpTargetAddrExtEntry);
+
 /**
  *  snmpTargetAddrTMask
  *
@@ -124,7 +129,7 @@ const index_info iSnmpCommunityEntry[1] =
 { { sNMP_SYNTAX_OCTETS, TRUE, 1, 32 } };
 
 snmpCommunityEntry::snmpCommunityEntry():
-   StorageTable(oidSnmpCommunityEntry, iSnmpCommunityEntry, 1)
+   StorageTable(litSnmpCommunityEntry, iSnmpCommunityEntry, 1)
 {
 	// This table object is a singleton. In order to access it use
 	// the static pointer snmpCommunityEntry::instance.
@@ -249,7 +254,7 @@ bool snmpCommunityEntry::get_community(OctetStr& security_name,
 snmpTargetAddrExtEntry* snmpTargetAddrExtEntry::instance = 0;
 
 snmpTargetAddrExtEntry::snmpTargetAddrExtEntry():
-   MibTable(oidSnmpTargetAddrExtEntry, iSnmpAdminString, 1)
+   MibTable(litSnmpTargetAddrExtEntry, iSnmpAdminString, 1)
 {
 	// This table object is a singleton. In order to access it use
 	// the static pointer snmpTargetAddrExtEntry::instance.
@@ -429,7 +434,7 @@ bool snmpTargetAddrExtEntry::passes_filter(const OctetStr& taddress,
 }
 
 
-snmp_community_mib::snmp_community_mib(): MibGroup("1.3.6.1.6.3.18.1",
+snmp_community_mib::snmp_community_mib(): MibGroup(litSnmpCommunityMIBObjects,
 						   "snmpCommunityMIB")
 {
 	add(new snmpCommunityEntry());
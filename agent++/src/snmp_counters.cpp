@@ -22,11 +22,31 @@
 
 #include <agent_pp/snmp_counters.h>
 
+#ifdef SNMP_PP_NAMESPACE
+using namespace Snmp_pp;
+#endif
+
 #ifdef AGENTPP_NAMESPACE
 using namespace Agentpp;
 #endif
 
 unsigned long MibIIsnmpCounters::counter_snmp[SNMP_COUNTERS];
+MibIIsnmpCounterShard* MibIIsnmpCounters::shards = 0;
+SnmpSynchronized MibIIsnmpCounters::shardLock;
+
+MibIIsnmpCounterShard::MibIIsnmpCounterShard()
+{
+	for (int i=0; i<SNMP_COUNTERS; i++) 
+		counter_snmp[i] = 0;
+	next = 0;
+	MibIIsnmpCounters::add_shard(this);
+}
+
+MibIIsnmpCounterShard::~MibIIsnmpCounterShard()
+{
+	MibIIsnmpCounters::remove_shard(this);
+}
+
 
 MibIIsnmpCounters::MibIIsnmpCounters() 
 {
@@ -36,8 +56,54 @@ MibIIsnmpCounters::MibIIsnmpCounters()
 
 void MibIIsnmpCounters::reset()
 {
+	SnmpSynchronize s(shardLock);
 	for (int i=0; i<SNMP_COUNTERS; i++) 
 		counter_snmp[i] = 0;
+	for (MibIIsnmpCounterShard* shard = shards; shard; 
+	     shard = shard->next) {
+		for (int j=0; j<SNMP_COUNTERS; j++) 
+			shard->counter_snmp[j] = 0;
+	}
+}
+
+unsigned long MibIIsnmpCounters::get(int index)
+{
+	unsigned long sum = counter_snmp[index];
+	if (!shards)
+		return sum;
+	SnmpSynchronize s(shardLock);
+	for (MibIIsnmpCounterShard* shard = shards; shard; 
+	     shard = shard->next) {
+		sum += shard->counter_snmp[index];
+	}
+	return sum;
+}
+
+void MibIIsnmpCounters::add_shard(MibIIsnmpCounterShard* shard)
+{
+	SnmpSynchronize s(shardLock);
+	shard->next = shards;
+	shards = shard;
+}
+
+void MibIIsnmpCounters::remove_shard(MibIIsnmpCounterShard* shard)
+{
+	SnmpSynchronize s(shardLock);
+	MibIIsnmpCounterShard* prev = 0;
+	for (MibIIsnmpCounterShard* cur = shards; cur; cur = cur->next) {
+		if (cur == shard) {
+			if (prev)
+				prev->next = cur->next;
+			else
+				shards = cur->next;
+			// keep the counters monotonic
+			for (int i=0; i<SNMP_COUNTERS; i++) 
+				counter_snmp[i] += cur->counter_snmp[i];
+			cur->next = 0;
+			return;
+		}
+		prev = cur;
+	}
 }
 
 
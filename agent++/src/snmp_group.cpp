@@ -27,6 +27,10 @@
 using namespace Agentpp;
 #endif
 
+// oid literals of the objects used in this module
+static SNMP_PP_OID_LITERAL(litSnmpEnableAuthenTraps, oidSnmpEnableAuthenTraps);
+static SNMP_PP_OID_LITERAL(litSnmpGroup, oidSnmpGroup);
+
 
 void snmpInPkts::get_request(Request* req, int index)
 {
@@ -211,7 +215,7 @@ void snmpProxyDrops::get_request(Request* req, int index)
 snmpEnableAuthenTraps* snmpEnableAuthenTraps::instance = 0;
 
 snmpEnableAuthenTraps::snmpEnableAuthenTraps():
-   MibLeaf(oidSnmpEnableAuthenTraps, READWRITE, new SnmpInt32(2))
+   MibLeaf(litSnmpEnableAuthenTraps, READWRITE, new SnmpInt32(2))
 {
 	instance = this;
 }
@@ -243,7 +247,7 @@ bool snmpEnableAuthenTraps::value_ok(const Vbx& vb)
  **********************************************************************/
 
 
-snmpGroup::snmpGroup(): MibGroup(oidSnmpGroup, "snmpGroup")
+snmpGroup::snmpGroup(): MibGroup(litSnmpGroup, "snmpGroup")
 {
 	MibIIsnmpCounters::reset();
 
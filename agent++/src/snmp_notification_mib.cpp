@@ -31,6 +31,12 @@ namespace Agentpp {
 
 static const char *loggerModuleName = "agent++.snmp_notification_mib";
 
+// oid literals of the objects used in this module
+static SNMP_PP_OID_LITERAL(litSnmpNotifyEntry, "1.3.6.1.6.3.13.1.1.1");
+static SNMP_PP_OID_LITERAL(litSnmpNotifyFilterEntry, "1.3.6.1.6.3.13.1.3.1");
+static SNMP_PP_OID_LITERAL(litSnmpNotifyFilterProfileEntry, "1.3.6.1.6.3.13.1.2.1");
+static SNMP_PP_OID_LITERAL(litSnmpNotifyObjects, "1.3.6.1.6.3.13.1");
+
 
 /**
  *  snmpNotifyType
@@ -84,7 +90,7 @@ static const char *loggerModuleName = "agent++.snmp_notification_mib";
 snmpNotifyEntry* snmpNotifyEntry::instance = 0;
 
 snmpNotifyEntry::snmpNotifyEntry():
-   StorageTable("1.3.6.1.6.3.13.1.1.1", iSnmpAdminString, 1)
+   StorageTable(litSnmpNotifyEntry, iSnmpAdminString, 1)
 {
 	// This table object is a singleton. In order to access it use
 	// the static pointer snmpNotifyEntry::instance.
@@ -133,7 +139,7 @@ const index_info indSnmpNotifyFilterProfileEntry[1] = {
   { sNMP_SYNTAX_OCTETS, TRUE, 1, 32 } };
 
 snmpNotifyFilterProfileEntry::snmpNotifyFilterProfileEntry():
-   StorageTable("1.3.6.1.6.3.13.1.2.1", indSnmpNotifyFilterProfileEntry, 1)
+   StorageTable(litSnmpNotifyFilterProfileEntry, indSnmpNotifyFilterProfileEntry, 1)
 {
 	// This table object is a singleton. In order to access it use
 	// the static pointer snmpNotifyFilterProfileEntry::instance.
@@ -162,7 +168,7 @@ const index_info	iSnmpNotifyFilterEntry[2] =
 { { sNMP_SYNTAX_OCTETS, FALSE, 0, 32 }, { sNMP_SYNTAX_OID, TRUE, 1, 95 } };
 
 snmpNotifyFilterEntry::snmpNotifyFilterEntry():
-   StorageTable("1.3.6.1.6.3.13.1.3.1", iSnmpNotifyFilterEntry, 2)
+   StorageTable(litSnmpNotifyFilterEntry, iSnmpNotifyFilterEntry, 2)
 {
 	// This table object is a singleton. In order to access it use
 	// the static pointer snmpNotifyFilterEntry::instance.
@@ -296,7 +302,7 @@ bool snmpNotifyFilterEntry::passes_filter(const Oidx& target,
 	return (pass == 1);
 }	
 
-snmp_notification_mib::snmp_notification_mib(): MibGroup("1.3.6.1.6.3.13.1",
+snmp_notification_mib::snmp_notification_mib(): MibGroup(litSnmpNotifyObjects,
 							 "snmpNotificationMIB")
 {
 	add(new snmpNotifyEntry());
@@ -32,6 +32,7 @@
 #include <snmp_pp/smival.h>
 #include <snmp_pp/snmp_pp.h>
 #include <snmp_pp/snmpmsg.h>
+#include <snmp_pp/pduview.h>
 #include <snmp_pp/mp_v3.h>
 #include <agent_pp/v3_mib.h>
 #include <snmp_pp/v3.h>
@@ -68,9 +69,7 @@ void Pdux::clear()
 	validity = FALSE;
 
 	// init all instance vars to null and invalid
-	for (int z=0; z < vb_count; z++) delete vbs[z];
-
-	vb_count = 0;
+	free_vbs();
 #ifdef _SNMPv3
         security_level = 0;
         context_name = "";
@@ -85,6 +84,15 @@ Pdux& Pdux::operator+=(const Vb &vb)
 	return *this;
 }
 
+#ifdef SNMP_PP_RVALUE_REFS
+// append vb, taking over its oid and value
+Pdux& Pdux::operator+=(Vb &&vb)
+{
+	*((Pdu*)this)+=std::move(vb);
+	return *this;
+}
+#endif
+
 
 /**
   * class Vbx
@@ -117,57 +125,32 @@ int operator==(const Vbx& a, const Vbx& b)
 
 int Vbx::to_asn1(Vbx* vbs, int sz, unsigned char*& buf, int& length)
 {
-	unsigned char packet[MAX_SNMP_PACKET];
-	unsigned char* cp = packet;
-	snmp_pdu* pdu = snmp_pdu_create(0);
-	struct variable_list *vp;
-	int len = MAX_SNMP_PACKET;
+	int i;
 
-	for (int i=0; i<sz; i++) {
-		SmiVALUE smival;
-		int status = convertVbToSmival(vbs[i], &smival);
-		if (status != SNMP_CLASS_SUCCESS) {
-			freeSmivalDescriptor(&smival);
-			snmp_free_pdu(pdu);
-			return status;
-		}
-		snmp_add_var(pdu,
-			     vbs[i].get_oid().oidval()->ptr,
-			     vbs[i].get_oid().oidval()->len,
-			     &smival);
-		freeSmivalDescriptor(&smival);
-	}
-	// asn1 encode
-	// cp = packet;
-	for(vp = pdu->variables; vp; vp = vp->next_variable) {
-		cp = snmp_build_var_op(cp,
-				       vp->name,
-				       &vp->name_length,
-				       vp->type,
-				       vp->val_len,
-				       (unsigned char *)vp->val.string,
-				       &len);
-		if (cp == NULL) {
-			snmp_free_pdu(pdu);
+	// the vbs are encoded directly into buf, so get the length first
+	length = 0;
+	for (i=0; i<sz; i++) {
+		int vb_length = asn1_vb_length(vbs[i], false);
+		if (vb_length < 0)
 			return SNMP_CLASS_ERROR;
-		}
+		length += vb_length;
 	}
-	snmp_free_pdu(pdu);
-	length = cp - packet;
 	// encode the total len
 	buf = new unsigned char[length+4];
-	len = length+4;
-	cp = asn_build_long_len_sequence(buf,
-					 &len,
-					 (unsigned char)
-					 (ASN_SEQUENCE | ASN_CONSTRUCTOR),
-					 length,
-					 3);
+	int len = length+4;
+	unsigned char* cp =
+	    asn_build_long_len_sequence(buf,
+					&len,
+					(unsigned char)
+					(ASN_SEQUENCE | ASN_CONSTRUCTOR),
+					length,
+					3);
+	for (i=0; (i<sz) && (cp); i++)
+		cp = asn1_build_vb(cp, &len, vbs[i], false);
 	if (cp == NULL) {
 	        delete[] buf;
 		return SNMP_CLASS_ERROR;
 	}
-	memcpy(cp, packet, length);
 	length += 4;
 	return SNMP_CLASS_SUCCESS;
 }
@@ -265,233 +248,40 @@ unsigned char* Vbx::asn_build_long_length( unsigned char *data,
 
 int Vbx::from_asn1(Vbx*& vbs, int& sz, unsigned char*& data, int& length)
 {
-	oid objid[ASN_MAX_NAME_LEN], *op;
-	unsigned char *var_val;
 	// get the vb list
 	unsigned char type;
-	struct variable_list *vp = 0;
 	int seqLength = length;
 	data = asn_parse_header(data, &seqLength, &type);
 	if ((data == NULL) || (seqLength > length))
 	    return SNMP_CLASS_ERROR;
 	if (type != (unsigned char)(ASN_SEQUENCE | ASN_CONSTRUCTOR))
 	    return SNMP_CLASS_ERROR;
-	snmp_pdu* pdu = snmp_pdu_create(0);
-	sz = 0;
 	length -= seqLength + 4;
-	while(seqLength > 0) {
-		sz++;
-		if (pdu->variables == NULL) {
-			pdu->variables = vp =
-			  (struct variable_list *)
-			  malloc(sizeof(struct variable_list));
-		}
-		else {
-			vp->next_variable =
-			  (struct variable_list *)
-			  malloc(sizeof(struct variable_list));
-			vp = vp->next_variable;
-		}
-		vp->next_variable = NULL;
-		vp->val.string = NULL;
-		vp->name = NULL;
-		vp->name_length = ASN_MAX_NAME_LEN;
-		data = snmp_parse_var_op(data,
-					 objid,
-					 &vp->name_length,
-					 &vp->type,
-					 &vp->val_len,
-					 &var_val,
-					 (int *)&seqLength);
-		if (data == NULL)
+
+	// check the vbs and count them, before anything is decoded
+	VbView vb;
+	const unsigned char *cp = data;
+	int rest = seqLength;
+	sz = 0;
+	while (rest > 0) {
+		cp = vb.parse(cp, &rest);
+		if (cp == NULL)
 		{
-		    snmp_free_pdu(pdu);
 #ifdef _SNMPv3
 		    return SNMP_CLASS_ASN1ERROR;
 #else
 		    return SNMP_CLASS_ERROR;
 #endif
 		}
-		op = (oid *)malloc((unsigned)vp->name_length * sizeof(oid));
-		// fixed
-		memcpy((char *)op, (char *)objid,
-		       vp->name_length * sizeof(oid));
-		vp->name = op;
-
-		int len = MAX_SNMP_PACKET;
-		switch((short)vp->type){
-		case ASN_INTEGER:
-		  vp->val.integer = (long *)malloc(sizeof(long));
-		  vp->val_len = sizeof(long);
-		  asn_parse_int(var_val, &len, &vp->type, vp->val.integer);
-		  break;
-
-		case SMI_COUNTER:
-		case SMI_GAUGE:
-		case SMI_TIMETICKS:
-		case SMI_UINTEGER:
-		  vp->val.integer = (long *)malloc(sizeof(long));
-		  vp->val_len = sizeof(long);
-		  asn_parse_unsigned_int(var_val, &len, &vp->type, vp->val.integer);
-		  break;
-
-		case SMI_COUNTER64:
-		  vp->val.counter64 = (struct counter64 *)malloc( sizeof(struct counter64) );
-		  vp->val_len = sizeof(struct counter64);
-		  asn_parse_unsigned_int64(var_val, &len, &vp->type,
-					   vp->val.counter64);
-		  break;
-
-		case ASN_OCTET_STR:
-		case SMI_IPADDRESS:
-		case SMI_OPAQUE:
-		case SMI_NSAP:
-		  vp->val.string = (unsigned char *)malloc((unsigned)vp->val_len);
-		  asn_parse_string(var_val, &len, &vp->type, vp->val.string, &vp->val_len);
-		  break;
-
-		case ASN_OBJECT_ID:
-		  vp->val_len = ASN_MAX_NAME_LEN;
-		  asn_parse_objid(var_val, &len, &vp->type, objid, &vp->val_len);
-		  //vp->val_len *= sizeof(oid);
-		  vp->val.objid = (oid *)malloc((unsigned)vp->val_len * sizeof(oid));
-		  // fixed
-		  memcpy((char *)vp->val.objid,
-			 (char *)objid,
-			 vp->val_len * sizeof(oid));
-		  break;
-
-		case SNMP_NOSUCHOBJECT:
-		case SNMP_NOSUCHINSTANCE:
-		case SNMP_ENDOFMIBVIEW:
-		case ASN_NULL:
-		  break;
-
-		default:
-		  ASNERROR("bad type returned ");
-		  snmp_free_pdu(pdu);
-#ifdef _SNMPv3
-		  return SNMP_CLASS_ASN1ERROR;
-#else
-		  return SNMP_CLASS_ERROR;
-#endif
-		  break;
-		}
+		sz++;
 	}
 	// build vbs
 	vbs = new Vbx[sz];
-	Oidx tempoid;
-	int i=0;
-	for(vp = pdu->variables; vp; vp = vp->next_variable, i++) {
-
-	  // extract the oid portion
-	  tempoid.set_data((unsigned long *)vp->name,
-			   (unsigned int) vp->name_length);
-	  vbs[i].set_oid(tempoid);
-	  // extract the value portion
-	  switch(vp->type){
-
-	    // octet string
-	  case sNMP_SYNTAX_OPAQUE:
-	    {
-	      OpaqueStr octets( (unsigned char *) vp->val.string,
-				(unsigned long) vp->val_len);
-	      vbs[i].set_value(octets);
-	    }
-	    break;
-	  case sNMP_SYNTAX_OCTETS:
-	    {
-	      OctetStr octets( (unsigned char *) vp->val.string,
-			       (unsigned long) vp->val_len);
-	      vbs[i].set_value(octets);
-	    }
-	    break;
-
-	    // object id
-	  case sNMP_SYNTAX_OID:
-	    {
-	      Oid oid( (unsigned long*) vp->val.objid,
-		       (int) vp->val_len);
-	      vbs[i].set_value( oid);
-	    }
-	    break;
-
-	    // timeticks
-	  case sNMP_SYNTAX_TIMETICKS:
-	    {
-	      TimeTicks timeticks( (unsigned long) *(vp->val.integer));
-	      vbs[i].set_value( timeticks);
-	    }
-	    break;
-
-	    // 32 bit counter
-	  case sNMP_SYNTAX_CNTR32:
-	    {
-	      Counter32 counter32( (unsigned long) *(vp->val.integer));
-	      vbs[i].set_value( counter32);
-	    }
-	    break;
-
-	    // 32 bit gauge
-	  case sNMP_SYNTAX_GAUGE32:
-	    {
-	      Gauge32 gauge32( (unsigned long) *(vp->val.integer));
-	      vbs[i].set_value( gauge32);
-	    }
-	    break;
-
-	    // ip address
-	  case sNMP_SYNTAX_IPADDR:
-	    {
-	      char buffer[20];
-	      sprintf( buffer,"%d.%d.%d.%d",
-		       vp->val.string[0],
-		       vp->val.string[1],
-		       vp->val.string[2],
-		       vp->val.string[3]);
-	      IpAddress ipaddress( buffer);
-	      vbs[i].set_value( ipaddress);
-	    }
-	    break;
-
-	    // 32 bit integer
-	  case sNMP_SYNTAX_INT:
-	    {
-	      SnmpInt32 int32( (long) *(vp->val.integer));
-	      vbs[i].set_value( int32);
-	    }
-	    break;
-
-	    // v2 counter 64's
-	  case sNMP_SYNTAX_CNTR64:
-	    { // Frank Fock (was empty before)
-	      Counter64 c64(((counter64*)vp->val.counter64)->high,
-			    ((counter64*)vp->val.counter64)->low);
-	      vbs[i].set_value( c64);
-	      break;
-	    }
-	  case sNMP_SYNTAX_NULL:
-	    vbs[i].set_null();
-	    break;
-
-	    // v2 vb exceptions
-	  case sNMP_SYNTAX_NOSUCHOBJECT:
-	  case sNMP_SYNTAX_NOSUCHINSTANCE:
-	  case sNMP_SYNTAX_ENDOFMIBVIEW:
-#ifdef SNMP_PP_V3
-	    vbs[i].set_exception_status( vp->type);
-#else
-	    set_exception_status( &vbs[i], vp->type);
-#endif
-	    break;
-
-	  default:
-	    vbs[i].set_null();
-
-	  } // end switch
+	rest = seqLength;
+	for (int i=0; i<sz; i++) {
+		data = (unsigned char *)vb.parse(data, &rest);
+		vb.get_vb(vbs[i]);
 	}
-
-	snmp_free_pdu(pdu);
 	return SNMP_CLASS_SUCCESS;
 }
 
@@ -602,40 +392,44 @@ Oidx& Oidx::mask(const OctetStr& mask)
 
 int Oidx::compare(const Oidx& other, const OctetStr& mask) const
 {
-	Oidx maskedOid(*this);
-	Oidx maskedOther(other);
-	maskedOid.mask(mask);
-	maskedOther.mask(mask);
 	LOG_BEGIN(loggerModuleName, DEBUG_LOG | 10);
 	LOG("Oidx: compare: (masked oid)(masked other)");
-	LOG(maskedOid.get_printable());
-	LOG(maskedOther.get_printable());
+	LOG(Oidx(*this).mask(mask).get_printable());
+	LOG(Oidx(other).mask(mask).get_printable());
 	LOG_END;
-	if (maskedOid == maskedOther)
-		return 0;
-	else if (maskedOther.in_subtree_of(maskedOid))
-		return 1;
-	return -1;
+	// other can only be equal or in the subtree of the receiver
+	// if the masked subidentifiers of the receiver match
+	if (other.len() < len())
+		return -1;
+	if (!oid_masked_match(smival.value.oid.ptr,
+			      other.smival.value.oid.ptr, len(),
+			      mask.data(), mask.len()))
+		return -1;
+	return (other.len() == len()) ? 0 : 1;
 }
 
 int Oidx::compare(const Oidx& other, u_int wildcard) const
 {
-	Oidx maskedOid(*this);
-	Oidx maskedOther(other);
-	if ((this->len() > wildcard) && (other.len() > wildcard)) {
-		maskedOid[wildcard] = 0;
-		maskedOther[wildcard] = 0;
-	}
 	LOG_BEGIN(loggerModuleName, DEBUG_LOG | 10);
-	LOG("Oidx: compare: (masked oid)(masked other)");
-	LOG(maskedOid.get_printable());
-	LOG(maskedOther.get_printable());
+	LOG("Oidx: compare: (oid)(other)(wildcard)");
+	LOG(get_printable());
+	LOG(other.get_printable());
+	LOG((long)wildcard);
 	LOG_END;
-	if (maskedOid == maskedOther)
-		return 0;
-	else if (maskedOther.in_subtree_of(maskedOid))
-		return 1;
-	return -1;
+	if (other.len() < len())
+		return -1;
+	const SmiUINT32* a = smival.value.oid.ptr;
+	const SmiUINT32* b = other.smival.value.oid.ptr;
+	unsigned long n = len();
+	unsigned long i = oid_common_prefix(a, b, n);
+	if ((i == wildcard) && (i < n)) {
+		// the wildcard subidentifier is not compared
+		++i;
+		i += oid_common_prefix(a+i, b+i, n-i);
+	}
+	if (i < n)
+		return -1;
+	return (other.len() == len()) ? 0 : 1;
 }
 
 #if 0
@@ -806,7 +600,8 @@ int Snmpx::receive(struct timeval *tvptr, Pdux& pdu, UTarget& target)
   snmp_version version;
   OctetStr community;
 
-  unsigned char receive_buffer[MAX_SNMP_PACKET];
+  MessageBuffer buffer;  // has room for size() + 1 bytes
+  unsigned char *receive_buffer = buffer.get_ptr();
   long receive_buffer_len; // len of received data
 
   SnmpMessage snmpmsg;
@@ -817,6 +612,9 @@ int Snmpx::receive(struct timeval *tvptr, Pdux& pdu, UTarget& target)
   bool can_receive_ipv6 = false;
 #endif
 
+  if (get_pending_count() > 0)
+    return receive_buffered(pdu, target);
+
 #ifdef HAVE_POLL_SYSCALL
   int nfds = 0;
   struct pollfd readfds[2];
@@ -909,12 +707,20 @@ int Snmpx::receive(struct timeval *tvptr, Pdux& pdu, UTarget& target)
 
     if (can_receive_ipv4)
     {
+	if (m_receiveBatch)
+	{
+	  if (m_receiveBatch->receive(iv_snmp_session) <= 0)
+	    return SNMP_CLASS_TL_FAILED;
+	  receiveIndex = 0;
+	  return receive_buffered(pdu, target);
+	}
+
 	fromlen = sizeof(from_addr);
 	do
 	{
 	  receive_buffer_len = (long)recvfrom(iv_snmp_session,
 					      (char *) receive_buffer,
-					      MAX_SNMP_PACKET, 0,
+					      buffer.size() + 1, 0,
 					      (struct sockaddr*)&from_addr,
 					      &fromlen);
 	} while (receive_buffer_len < 0 && EINTR == errno);
@@ -922,7 +728,7 @@ int Snmpx::receive(struct timeval *tvptr, Pdux& pdu, UTarget& target)
 	if (receive_buffer_len <= 0 )		// error or no data pending
 	  return SNMP_CLASS_TL_FAILED;
 
-	if (receive_buffer_len >= MAX_SNMP_PACKET)
+	if (receive_buffer_len > (long)buffer.size())
 	  return SNMP_ERROR_TOO_BIG;
 
 	debugprintf(1, "++ AGENT++: data received from %s port %d.",
@@ -930,73 +736,31 @@ int Snmpx::receive(struct timeval *tvptr, Pdux& pdu, UTarget& target)
 		    ntohs(((sockaddr_in&)from_addr).sin_port));
 	debughexprintf(5, receive_buffer, receive_buffer_len);
 
-	OctetStr engine_id;
-	OctetStr security_name;
-	long int security_model;
-
 	// copy fromaddress and remote port
 	char* addr = inet_ntoa (((sockaddr_in&)from_addr).sin_addr);
 	fromaddr = addr;
 	fromaddr.set_port(ntohs(((sockaddr_in&)from_addr).sin_port));
 
-	snmpmsg.load(receive_buffer, receive_buffer_len);
-
-	target.set_address(fromaddr);
-
-	int status = SNMP_CLASS_SUCCESS;
-	if (snmpmsg.is_v3_message() == TRUE)
-	{
-	  status = snmpmsg.unloadv3(pdu, version, engine_id,
-				    security_name, security_model,
-				    fromaddr, *this);
-	  if ((status != SNMP_CLASS_SUCCESS) &&
-	      (status != SNMP_ERROR_TOO_BIG))
-	    return status;
-
-	  target.set_security_name(security_name);
-	  target.set_engine_id(engine_id);
-	}
-	else
-	{
-	  status = snmpmsg.unload( pdu, community, version);
-	  if ((status != SNMP_CLASS_SUCCESS) &&
-	      (status != SNMP_ERROR_TOO_BIG))
-	    return status;
-	  target.set_security_name(community);
-	  if (version == version1)
-	    security_model = SNMP_SECURITY_MODEL_V1;
-	  else
-	    security_model = SNMP_SECURITY_MODEL_V2;
-	  pdu.set_security_level(SNMP_SECURITY_LEVEL_NOAUTH_NOPRIV);
-	  pdu.set_context_engine_id("");
-	  pdu.set_context_name("");
-	}
-	target.set_security_model(security_model);
-	target.set_version(version);
-
-	// v3 support
-	if (version == version3)
-	{
-	  debugprintf(1,"Snmpx::receive:");
-	  debugprintf(2," engine_id: (%s), security_name: (%s),\n"
-		      " security_model: (%li) security_level (%i)",
-		      engine_id.get_printable(),
-		      security_name.get_printable(),
-		      security_model, pdu.get_security_level());
-	  debugprintf(2, " Addr = %s, port = %i\n",
-		      inet_ntoa (((sockaddr_in&)from_addr).sin_addr),fromaddr.get_port());
-	}
-	return status;   // Success! return
+	return unload_message(receive_buffer, receive_buffer_len,
+			      fromaddr, pdu, target);
     }
 #ifdef SNMP_PP_IPv6
     if (can_receive_ipv6)
     {
+	if (m_receiveBatch)
+	{
+	  if (m_receiveBatch->receive(iv_snmp_session_ipv6) <= 0)
+	    return SNMP_CLASS_TL_FAILED;
+	  receiveIndex = 0;
+	  return receive_buffered(pdu, target);
+	}
+
 	fromlen = sizeof((from_addr));
 	do
 	{
 	  receive_buffer_len = (long)recvfrom(iv_snmp_session_ipv6,
 					      (char *) receive_buffer,
-					      MAX_SNMP_PACKET, 0,
+					      buffer.size() + 1, 0,
 					      (struct sockaddr*)&from_addr,
 					      &fromlen);
 	} while (receive_buffer_len < 0 && EINTR == errno);
@@ -1004,7 +768,7 @@ int Snmpx::receive(struct timeval *tvptr, Pdux& pdu, UTarget& target)
 	if (receive_buffer_len <= 0 )		// error or no data pending
 	  return SNMP_CLASS_TL_FAILED;
 
-	if (receive_buffer_len >= MAX_SNMP_PACKET)
+	if (receive_buffer_len > (long)buffer.size())
 	  return SNMP_ERROR_TOO_BIG;
 
 	OctetStr engine_id;
@@ -1073,16 +837,96 @@ int Snmpx::receive(struct timeval *tvptr, Pdux& pdu, UTarget& target)
   } while(1);
 }
 
+
+int Snmpx::receive_buffered(Pdux& pdu, UTarget& target)
+{
+  int index = receiveIndex++;
+  long receive_buffer_len = m_receiveBatch->get_length(index);
+  UdpAddress fromaddr;
+
+  if (receive_buffer_len > m_receiveBatch->get_max_length())
+    return SNMP_ERROR_TOO_BIG;
+
+  if (!m_receiveBatch->get_address(index, fromaddr))
+    return SNMP_CLASS_TL_FAILED;
+
+  debugprintf(1, "++ AGENT++: data received from %s.",
+	      fromaddr.get_printable());
+  debughexprintf(5, m_receiveBatch->get_data(index), receive_buffer_len);
+
+  return unload_message(m_receiveBatch->get_data(index), receive_buffer_len,
+			fromaddr, pdu, target);
+}
+
+int Snmpx::unload_message(unsigned char* receive_buffer,
+			  long receive_buffer_len,
+			  UdpAddress& fromaddr,
+			  Pdux& pdu, UTarget& target)
+{
+  snmp_version version;
+  OctetStr community;
+  OctetStr engine_id;
+  OctetStr security_name;
+  long int security_model;
+  SnmpMessage snmpmsg;
+
+  snmpmsg.load(receive_buffer, receive_buffer_len);
+
+
+  target.set_address(fromaddr);
+
+  int status = SNMP_CLASS_SUCCESS;
+  if (snmpmsg.is_v3_message() == TRUE)
+  {
+    status = snmpmsg.unloadv3(pdu, version, engine_id,
+  			    security_name, security_model,
+  			    fromaddr, *this);
+    if ((status != SNMP_CLASS_SUCCESS) &&
+        (status != SNMP_ERROR_TOO_BIG))
+      return status;
+
+    target.set_security_name(security_name);
+    target.set_engine_id(engine_id);
+  }
+  else
+  {
+    status = snmpmsg.unload( pdu, community, version);
+    if ((status != SNMP_CLASS_SUCCESS) &&
+        (status != SNMP_ERROR_TOO_BIG))
+      return status;
+    target.set_security_name(community);
+    if (version == version1)
+      security_model = SNMP_SECURITY_MODEL_V1;
+    else
+      security_model = SNMP_SECURITY_MODEL_V2;
+    pdu.set_security_level(SNMP_SECURITY_LEVEL_NOAUTH_NOPRIV);
+    pdu.set_context_engine_id("");
+    pdu.set_context_name("");
+  }
+  target.set_security_model(security_model);
+  target.set_version(version);
+
+  // v3 support
+  if (version == version3)
+  {
+    debugprintf(1,"Snmpx::receive:");
+    debugprintf(2," engine_id: (%s), security_name: (%s),\n"
+  	      " security_model: (%li) security_level (%i)",
+  	      engine_id.get_printable(),
+  	      security_name.get_printable(),
+  	      security_model, pdu.get_security_level());
+    debugprintf(2, " Addr = %s\n", fromaddr.get_printable());
+  }
+  return status;   // Success! return
+}
+
 #else // _SNMPv3 is not defined
 
 int Snmpx::receive(struct timeval *tvptr, Pdux& pdu, UdpAddress& fromaddr,
 		   snmp_version& version, OctetStr& community)
 {
-#ifndef MAX_SNMP_PACKET
-#define MAX_SNMP_PACKET 2048
-#endif
-  unsigned char receive_buffer[MAX_SNMP_PACKET];
-  //should be same as MAX_SNMP_PACKET found in uxsnmp.C
+  MessageBuffer buffer;  // has room for size() + 1 bytes
+  unsigned char *receive_buffer = buffer.get_ptr();
 
   long receive_buffer_len; // len of received data
 
@@ -1096,6 +940,9 @@ int Snmpx::receive(struct timeval *tvptr, Pdux& pdu, UdpAddress& fromaddr,
   bool can_receive_ipv6 = false;
 #endif
 
+  if (get_pending_count() > 0)
+    return receive_buffered(pdu, fromaddr, version, community);
+
 #ifdef HAVE_POLL_SYSCALL
   int nfds = 0;
   struct pollfd readfds[2];
@@ -1188,12 +1035,20 @@ int Snmpx::receive(struct timeval *tvptr, Pdux& pdu, UdpAddress& fromaddr,
 
     if (can_receive_ipv4)
     {
+	if (m_receiveBatch)
+	{
+	  if (m_receiveBatch->receive(iv_snmp_session) <= 0)
+	    return SNMP_CLASS_TL_FAILED;
+	  receiveIndex = 0;
+	  return receive_buffered(pdu, fromaddr, version, community);
+	}
+
 	fromlen = sizeof(from_addr);
 	do
 	{
 	  receive_buffer_len = (long)recvfrom(iv_snmp_session,
 					      (char *) receive_buffer,
-					      MAX_SNMP_PACKET, 0,
+					      buffer.size() + 1, 0,
 					      (struct sockaddr*)&from_addr,
 					      &fromlen);
 	} while (receive_buffer_len < 0 && EINTR == errno);
@@ -1201,7 +1056,7 @@ int Snmpx::receive(struct timeval *tvptr, Pdux& pdu, UdpAddress& fromaddr,
 	if (receive_buffer_len <= 0 )		// error or no data pending
 	  return SNMP_CLASS_TL_FAILED;
 
-	if (receive_buffer_len >= MAX_SNMP_PACKET)
+	if (receive_buffer_len > (long)buffer.size())
 	  return SNMP_ERROR_TOO_BIG;
 
 	// copy fromaddress and remote port
@@ -1221,12 +1076,20 @@ int Snmpx::receive(struct timeval *tvptr, Pdux& pdu, UdpAddress& fromaddr,
 #ifdef SNMP_PP_IPv6
     if (can_receive_ipv6)
     {
+	if (m_receiveBatch)
+	{
+	  if (m_receiveBatch->receive(iv_snmp_session_ipv6) <= 0)
+	    return SNMP_CLASS_TL_FAILED;
+	  receiveIndex = 0;
+	  return receive_buffered(pdu, fromaddr, version, community);
+	}
+
 	fromlen = sizeof(from_addr);
 	do
 	{
 	  receive_buffer_len = (long) recvfrom(iv_snmp_session_ipv6,
 					       (char *) receive_buffer,
-					       MAX_SNMP_PACKET, 0,
+					       buffer.size() + 1, 0,
 					       (struct sockaddr*)&from_addr,
 					       &fromlen);
 	} while (receive_buffer_len < 0 && EINTR == errno);
@@ -1234,7 +1097,7 @@ int Snmpx::receive(struct timeval *tvptr, Pdux& pdu, UdpAddress& fromaddr,
 	if (receive_buffer_len <= 0 )		// error or no data pending
 	  return SNMP_CLASS_TL_FAILED;
 
-	if (receive_buffer_len >= MAX_SNMP_PACKET)
+	if (receive_buffer_len > (long)buffer.size())
 	  return SNMP_ERROR_TOO_BIG;
 
 	char addr[INET6_ADDRSTRLEN+1];
@@ -1257,6 +1120,29 @@ int Snmpx::receive(struct timeval *tvptr, Pdux& pdu, UdpAddress& fromaddr,
   } while(1);
 }
 
+int Snmpx::receive_buffered(Pdux& pdu, UdpAddress& fromaddr,
+			    snmp_version& version, OctetStr& community)
+{
+  int index = receiveIndex++;
+  long receive_buffer_len = m_receiveBatch->get_length(index);
+  SnmpMessage snmpmsg;
+
+  if (receive_buffer_len > m_receiveBatch->get_max_length())
+    return SNMP_ERROR_TOO_BIG;
+
+  if (!m_receiveBatch->get_address(index, fromaddr))
+    return SNMP_CLASS_TL_FAILED;
+
+  debugprintf(1, "++ AGENT++: data received from %s.",
+	      fromaddr.get_printable());
+  debughexprintf(5, m_receiveBatch->get_data(index), receive_buffer_len);
+
+  snmpmsg.load(m_receiveBatch->get_data(index), receive_buffer_len);
+
+  // return the status of unload method
+  return snmpmsg.unload(pdu, community, version);
+}
+
 #endif
 
 
@@ -1264,9 +1150,6 @@ int Snmpx::receive(struct timeval *tvptr, Pdux& pdu, UdpAddress& fromaddr,
 
 int Snmpx::send (Pdux const &pdu, SnmpTarget* target)
 {
-#ifdef _THREADS
-  static ThreadManager smutex;
-#endif
   SnmpMessage snmpmsg;
   int status;
 
@@ -1351,23 +1234,7 @@ int Snmpx::send (Pdux const &pdu, SnmpTarget* target)
   if (status != SNMP_CLASS_SUCCESS)
     return status;
 
-#ifdef _THREADS
-  smutex.start_synch();
-#endif
-
-#ifdef SNMP_PP_IPv6
-  if (udp_address.get_ip_version() == Address::version_ipv6)
-    status = send_snmp_request(iv_snmp_session_ipv6,
-			       snmpmsg.data(), (size_t)snmpmsg.len(),
-			       udp_address);
-  else
-#endif
-    status = send_snmp_request(iv_snmp_session,
-			       snmpmsg.data(), (size_t)snmpmsg.len(),
-			       udp_address);
-#ifdef _THREADS
-  smutex.end_synch();
-#endif
+  status = send_datagram(snmpmsg.data(), (size_t)snmpmsg.len(), udp_address);
 
   if (status != 0)
     return SNMP_CLASS_TL_FAILED;
@@ -1383,41 +1250,144 @@ int Snmpx::send (Pdux  const &pdu,
 		 OctetStr  const &community)
 
 {
-#ifdef _THREADS
-  static ThreadManager smutex;
-#endif
   SnmpMessage snmpmsg;
   int status;
   status = snmpmsg.load( pdu, community, version);
   if ( status != SNMP_CLASS_SUCCESS)
     return status;
 
+  status = send_datagram(snmpmsg.data(), (size_t)snmpmsg.len(), udp_address);
+
+  if (status != 0)
+    return SNMP_CLASS_TL_FAILED;
+
+  return SNMP_CLASS_SUCCESS;
+}
+
+#endif
+
+Snmpx::~Snmpx()
+{
+  delete sendQueue;
+  delete sendBatch;
+  delete [] sendQueueResults;
+  delete [] sendBatchResults;
+  delete sendLock;
+}
+
+int Snmpx::get_pending_count() const
+{
+  if ((!m_receiveBatch) || (receiveIndex >= m_receiveBatch->get_count()))
+    return 0;
+  return m_receiveBatch->get_count() - receiveIndex;
+}
+
+void Snmpx::set_send_batch_size(int count)
+{
+  delete sendQueue;
+  delete sendBatch;
+  delete [] sendQueueResults;
+  delete [] sendBatchResults;
+  sendQueue = 0;
+  sendBatch = 0;
+  delete sendLock;
+  sendQueueResults = 0;
+  sendBatchResults = 0;
+  sendLock = 0;
+
+  if (count > 1)
+  {
+    sendQueue = new SnmpDatagramBatch(count);
+    sendBatch = new SnmpDatagramBatch(count);
+    sendQueueResults = new int*[count];
+    sendBatchResults = new int*[count];
+#ifdef _THREADS
+    sendLock = new Synchronized();
+#else
+    sendLock = new SnmpSynchronized();
+#endif
+  }
+}
+
+// result of a queued datagram that has not been sent yet
+#define SEND_PENDING 1
+
+int Snmpx::send_datagram(unsigned char* data, size_t len,
+			 const UdpAddress& udp_address)
+{
+#ifdef _THREADS
+  static ThreadManager smutex;
+#endif
+  int status;
+
+  if ((sendQueue) &&
+      (udp_address.get_ip_version() == Address::version_ipv4))
+  {
+    sendLock->lock();
+    int index = sendQueue->get_count();
+    if (sendQueue->add(data, len, udp_address))
+    {
+      status = SEND_PENDING;
+      sendQueueResults[index] = &status;
+      if (sending)
+      {
+	// the sending thread also sends this message and sets status
+#ifdef _THREADS
+	while (status == SEND_PENDING)
+	  sendLock->wait();
+#endif
+	sendLock->unlock();
+	return status;
+      }
+      sending = true;
+      while (sendQueue->get_count() > 0)
+      {
+	SnmpDatagramBatch* batch = sendQueue;
+	sendQueue = sendBatch;
+	sendBatch = batch;
+	int** results = sendQueueResults;
+	sendQueueResults = sendBatchResults;
+	sendBatchResults = results;
+	int count = sendBatch->get_count();
+	sendLock->unlock();
+#ifdef _THREADS
+	smutex.start_synch();
+#endif
+	sendBatch->send(iv_snmp_session);
+#ifdef _THREADS
+	smutex.end_synch();
+#endif
+	sendLock->lock();
+	for (int i = 0; i < count; i++)
+	  *sendBatchResults[i] = sendBatch->get_result(i);
+#ifdef _THREADS
+	sendLock->notify_all();
+#endif
+      }
+      sending = false;
+      sendLock->unlock();
+      return status;
+    }
+    // queue is full, send the message directly
+    sendLock->unlock();
+  }
+
 #ifdef _THREADS
   smutex.start_synch();
 #endif
 
 #ifdef SNMP_PP_IPv6
   if (udp_address.get_ip_version() == Address::version_ipv6)
-    status = send_snmp_request(iv_snmp_session_ipv6,
-			       snmpmsg.data(), (size_t)snmpmsg.len(),
-			       udp_address);
+    status = send_snmp_request(iv_snmp_session_ipv6, data, len, udp_address);
   else
 #endif
-    status = send_snmp_request(iv_snmp_session,
-			       snmpmsg.data(), (size_t)snmpmsg.len(),
-			       udp_address);
+    status = send_snmp_request(iv_snmp_session, data, len, udp_address);
 #ifdef _THREADS
   smutex.end_synch();
 #endif
-
-  if (status != 0)
-    return SNMP_CLASS_TL_FAILED;
-
-  return SNMP_CLASS_SUCCESS;
+  return status;
 }
 
-#endif
-
 #ifdef AGENTPP_NAMESPACE
 }
 #endif
@@ -31,6 +31,12 @@ using namespace Agentpp;
 
 static const char *loggerModuleName = "agent++.snmp_target_mib";
 
+// oid literals of the objects used in this module
+static SNMP_PP_OID_LITERAL(litSnmpTargetAddrEntry, "1.3.6.1.6.3.12.1.2.1");
+static SNMP_PP_OID_LITERAL(litSnmpTargetMIB, "1.3.6.1.6.3.12");
+static SNMP_PP_OID_LITERAL(litSnmpTargetParamsEntry, "1.3.6.1.6.3.12.1.3.1");
+static SNMP_PP_OID_LITERAL(litSnmpTargetSpinLock, "1.3.6.1.6.3.12.1.1.0");
+
 /**
  *  snmpTargetAddrTDomain
  *
@@ -311,7 +317,7 @@ bool snmpTargetAddrParams::value_ok(const Vbx& vb)
 snmpTargetAddrEntry* snmpTargetAddrEntry::instance = 0;
 
 snmpTargetAddrEntry::snmpTargetAddrEntry():
-   StorageTable("1.3.6.1.6.3.12.1.2.1", iSnmpAdminString, 1)
+   StorageTable(litSnmpTargetAddrEntry, iSnmpAdminString, 1)
 {
 	// This table object is a singleton. In order to access it use
 	// the static pointer snmpTargetAddrEntry::instance.
@@ -505,7 +511,7 @@ bool	snmpTargetAddrEntry::ready_for_service(Vbx* pvbs, int sz)
 snmpTargetParamsEntry* snmpTargetParamsEntry::instance = 0;
 
 snmpTargetParamsEntry::snmpTargetParamsEntry():
-   StorageTable("1.3.6.1.6.3.12.1.3.1", iSnmpAdminString, 1)
+   StorageTable(litSnmpTargetParamsEntry, iSnmpAdminString, 1)
 {
 	// This table object is a singleton. In order to access it use
 	// the static pointer snmpTargetParamsEntry::instance.
@@ -636,9 +642,9 @@ bool snmpTargetParamsEntry::get_target_params(const OctetStr& param,
 }
 #endif
 
-snmp_target_mib::snmp_target_mib(): MibGroup("1.3.6.1.6.3.12", "snmpTargetMIB")
+snmp_target_mib::snmp_target_mib(): MibGroup(litSnmpTargetMIB, "snmpTargetMIB")
 {
-	add(new TestAndIncr("1.3.6.1.6.3.12.1.1.0"));
+	add(new TestAndIncr(litSnmpTargetSpinLock));
 	add(new snmpTargetAddrEntry());
 	add(new snmpTargetParamsEntry());
 }
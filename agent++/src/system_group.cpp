@@ -32,6 +32,18 @@
 using namespace Agentpp;
 #endif
 
+// oid literals of the objects used in this module
+static SNMP_PP_OID_LITERAL(litSysContact, oidSysContact);
+static SNMP_PP_OID_LITERAL(litSysDescr, oidSysDescr);
+static SNMP_PP_OID_LITERAL(litSysGroup, oidSysGroup);
+static SNMP_PP_OID_LITERAL(litSysLocation, oidSysLocation);
+static SNMP_PP_OID_LITERAL(litSysName, oidSysName);
+static SNMP_PP_OID_LITERAL(litSysOREntry, oidSysOREntry);
+static SNMP_PP_OID_LITERAL(litSysORLastChange, oidSysORLastChange);
+static SNMP_PP_OID_LITERAL(litSysObjectID, oidSysObjectID);
+static SNMP_PP_OID_LITERAL(litSysServices, oidSysServices);
+static SNMP_PP_OID_LITERAL(litSysUpTime, oidSysUpTime);
+
 
 /**********************************************************************
  *
@@ -46,7 +58,7 @@ u_int sysUpTime::start = 0;
 #endif
 
 
-sysUpTime::sysUpTime(): MibLeaf(oidSysUpTime, READONLY, new TimeTicks(0))
+sysUpTime::sysUpTime(): MibLeaf(litSysUpTime, READONLY, new TimeTicks(0))
 {
 #if defined(HAVE_CLOCK_GETTIME)
         clock_gettime(CLOCK_MONOTONIC, &start);
@@ -95,7 +107,7 @@ void sysUpTime::get_request(Request* req, int ind)
  *
  **********************************************************************/
 
-sysDescr::sysDescr(const char* str): SnmpDisplayString(oidSysDescr, READONLY,
+sysDescr::sysDescr(const char* str): SnmpDisplayString(litSysDescr, READONLY,
 						       new OctetStr(str)) { }
 
 /**********************************************************************
@@ -104,7 +116,7 @@ sysDescr::sysDescr(const char* str): SnmpDisplayString(oidSysDescr, READONLY,
  *
  **********************************************************************/
 
-sysObjectID::sysObjectID(const Oidx& o): MibLeaf(oidSysObjectID, READONLY,
+sysObjectID::sysObjectID(const Oidx& o): MibLeaf(litSysObjectID, READONLY,
 						 new Oid(o)) { }
 
 /**********************************************************************
@@ -113,7 +125,7 @@ sysObjectID::sysObjectID(const Oidx& o): MibLeaf(oidSysObjectID, READONLY,
  *
  **********************************************************************/
 
-sysServices::sysServices(const int s): MibLeaf(oidSysServices, READONLY,
+sysServices::sysServices(const int s): MibLeaf(litSysServices, READONLY,
 					       new SnmpInt32(s)) { }
 
 
@@ -128,7 +140,7 @@ const index_info indSysOREntry[1] = {
 	{ sNMP_SYNTAX_INT, FALSE, 1, 1 } };
 
 sysOREntry::sysOREntry(TimeStamp* lc):
-   TimeStampTable(oidSysOREntry, indSysOREntry, 1, lc)
+   TimeStampTable(litSysOREntry, indSysOREntry, 1, lc)
 {
 	// This table object is a singleton. In order to access it use
 	// the static pointer sysOREntry::instance.
@@ -173,19 +185,19 @@ void sysOREntry::set_row(MibTableRow* r, const Oidx& id,
 sysGroup::sysGroup(const char *descr, const Oidx &o, const int services,
                    const char *contact, const char *name,
                    const char *location):
-  MibGroup(oidSysGroup, "systemGroup")
+  MibGroup(litSysGroup, "systemGroup")
 {
 	add(new sysDescr(descr));
 	add(new sysObjectID(o));
 	add(new sysUpTime());
-	add(new SnmpDisplayString(oidSysContact, READWRITE,
+	add(new SnmpDisplayString(litSysContact, READWRITE,
 	                          new OctetStr(contact ? contact : "")));
-	add(new SnmpDisplayString(oidSysName, READWRITE,
+	add(new SnmpDisplayString(litSysName, READWRITE,
 	                          new OctetStr(name ? name : "")));
-	add(new SnmpDisplayString(oidSysLocation, READWRITE,
+	add(new SnmpDisplayString(litSysLocation, READWRITE,
 	                          new OctetStr(location ? location : "")));
 	add(new sysServices(services));
-	TimeStamp* ptr = new TimeStamp(oidSysORLastChange, READONLY,
+	TimeStamp* ptr = new TimeStamp(litSysORLastChange, READONLY,
 				       VMODE_NONE);
 	add(ptr);
 	add(new sysOREntry(ptr));
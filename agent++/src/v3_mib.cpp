@@ -37,6 +37,32 @@ namespace Agentpp {
 
 static const char *loggerModuleName = "agent++.v3_mib";
 
+// oid literals of the objects used in this module
+static SNMP_PP_OID_LITERAL(litMPDGroup, oidMPDGroup);
+static SNMP_PP_OID_LITERAL(litSnmpInvalidMsgs, oidSnmpInvalidMsgs);
+static SNMP_PP_OID_LITERAL(litSnmpUnknownPDUHandlers, oidSnmpUnknownPDUHandlers);
+static SNMP_PP_OID_LITERAL(litSnmpUnknownSecurityModels, oidSnmpUnknownSecurityModels);
+static SNMP_PP_OID_LITERAL(litUsmAuthProtocolBase, oidUsmAuthProtocolBase);
+static SNMP_PP_OID_LITERAL(litUsmMIB, "1.3.6.1.6.3.15");
+static SNMP_PP_OID_LITERAL(litUsmNoAuthProtocol, oidUsmNoAuthProtocol);
+static SNMP_PP_OID_LITERAL(litUsmNoPrivProtocol, oidUsmNoPrivProtocol);
+static SNMP_PP_OID_LITERAL(litUsmPrivProtocolBase, oidUsmPrivProtocolBase);
+static SNMP_PP_OID_LITERAL(litUsmStats, oidUsmStats);
+static SNMP_PP_OID_LITERAL(litUsmStatsDecryptionErrors, oidUsmStatsDecryptionErrors);
+static SNMP_PP_OID_LITERAL(litUsmStatsNotInTimeWindows, oidUsmStatsNotInTimeWindows);
+static SNMP_PP_OID_LITERAL(litUsmStatsUnknownEngineIDs, oidUsmStatsUnknownEngineIDs);
+static SNMP_PP_OID_LITERAL(litUsmStatsUnknownUserNames, oidUsmStatsUnknownUserNames);
+static SNMP_PP_OID_LITERAL(litUsmStatsUnsupportedSecLevels, oidUsmStatsUnsupportedSecLevels);
+static SNMP_PP_OID_LITERAL(litUsmStatsWrongDigests, oidUsmStatsWrongDigests);
+static SNMP_PP_OID_LITERAL(litUsmUserEntry, oidUsmUserEntry);
+static SNMP_PP_OID_LITERAL(litUsmUserSpinLock, "1.3.6.1.6.3.15.1.2.1.0");
+static SNMP_PP_OID_LITERAL(litV3SnmpEngine, oidV3SnmpEngine);
+static SNMP_PP_OID_LITERAL(litV3SnmpEngineBoots, oidV3SnmpEngineBoots);
+static SNMP_PP_OID_LITERAL(litV3SnmpEngineID, oidV3SnmpEngineID);
+static SNMP_PP_OID_LITERAL(litV3SnmpEngineMaxMessageSize, oidV3SnmpEngineMaxMessageSize);
+static SNMP_PP_OID_LITERAL(litV3SnmpEngineTime, oidV3SnmpEngineTime);
+static SNMP_PP_OID_LITERAL(litZeroDotZero, "0.0");
+
 const index_info       	iUsmUserTable[2] = 
 {{ sNMP_SYNTAX_OCTETS, FALSE, 5, 32  },
  { sNMP_SYNTAX_OCTETS, FALSE, 1, 32 }};
@@ -48,7 +74,7 @@ const unsigned int	lUsmUserTable = 2;
  * 
  **********************************************************************/
 V3SnmpEngineID::V3SnmpEngineID(const v3MP *mp)
-  : MibLeaf( oidV3SnmpEngineID, READONLY, new OctetStr("")), v3mp(mp) {}
+  : MibLeaf( litV3SnmpEngineID, READONLY, new OctetStr("")), v3mp(mp) {}
 
 void V3SnmpEngineID::get_request(Request* req, int index)
 {
@@ -63,7 +89,7 @@ void V3SnmpEngineID::get_request(Request* req, int index)
  **********************************************************************/
 
 V3SnmpEngineBoots::V3SnmpEngineBoots(const USM *u)
-  : MibLeaf( oidV3SnmpEngineBoots, READONLY, new SnmpInt32(0)), usm(u) {}
+  : MibLeaf( litV3SnmpEngineBoots, READONLY, new SnmpInt32(0)), usm(u) {}
 
 void V3SnmpEngineBoots::get_request(Request* req, int index)
 {
@@ -79,7 +105,7 @@ void V3SnmpEngineBoots::get_request(Request* req, int index)
  * 
  **********************************************************************/
 V3SnmpEngineTime::V3SnmpEngineTime(const USM *u)
-  : MibLeaf( oidV3SnmpEngineTime, READONLY, new SnmpInt32(0)), usm(u) {}
+  : MibLeaf( litV3SnmpEngineTime, READONLY, new SnmpInt32(0)), usm(u) {}
 
 void V3SnmpEngineTime::get_request(Request* req, int index)
 {
@@ -95,17 +121,25 @@ void V3SnmpEngineTime::get_request(Request* req, int index)
  * 
  **********************************************************************/
 V3SnmpEngineMaxMessageSize::V3SnmpEngineMaxMessageSize():
-  MibLeaf( oidV3SnmpEngineMaxMessageSize, READONLY, new SnmpInt32(MAX_SNMP_PACKET))
+  MibLeaf( litV3SnmpEngineMaxMessageSize, READONLY,
+	   new SnmpInt32(MessageBuffer::get_max_message_size()))
 {
 }
 
+void V3SnmpEngineMaxMessageSize::get_request(Request* req, int index)
+{
+  // the maximum message size can be changed at runtime
+  *((SnmpInt32*)value) = MessageBuffer::get_max_message_size();
+  MibLeaf::get_request(req, index);
+}
+
 /**********************************************************************
  *  
  *  class V3SnmpEngine
  * 
  **********************************************************************/
 
-V3SnmpEngine::V3SnmpEngine(void): MibGroup(oidV3SnmpEngine) 
+V3SnmpEngine::V3SnmpEngine(void): MibGroup(litV3SnmpEngine) 
 {
         v3MP *v3mp = v3MP::I;
 	USM *usm = 0;
@@ -307,10 +341,10 @@ void usm_callback(const OctetStr &engine_id,
                                   FALSE);
 }
 
-const Oidx UsmUserTable::auth_base = oidUsmAuthProtocolBase;
-const Oidx UsmUserTable::priv_base = oidUsmPrivProtocolBase;
+const Oidx UsmUserTable::auth_base = litUsmAuthProtocolBase;
+const Oidx UsmUserTable::priv_base = litUsmPrivProtocolBase;
 
-UsmUserTable::UsmUserTable(): StorageTable(oidUsmUserEntry, iUsmUserTable, 
+UsmUserTable::UsmUserTable(): StorageTable(litUsmUserEntry, iUsmUserTable, 
 					   lUsmUserTable)
 {
   v3MP *v3mp = v3MP::I;
@@ -323,7 +357,7 @@ UsmUserTable::UsmUserTable(): StorageTable(oidUsmUserEntry, iUsmUserTable,
 
   usm = v3mp->get_usm();
 
-  Oidx tmpoid = Oidx(oidUsmUserEntry);
+  Oidx tmpoid = Oidx(litUsmUserEntry);
 
   // usmUserEngineID
   add_col(new SnmpAdminString("1", NOACCESS, new OctetStr(""), 
@@ -386,7 +420,7 @@ UsmUserTable::UsmUserTable(): StorageTable(oidUsmUserEntry, iUsmUserTable,
 
     if (user->usmUserAuthProtocol == SNMP_AUTHPROTOCOL_NONE)
     {
-      newRow->get_nth(4)->replace_value(new Oid(oidUsmNoAuthProtocol));
+      newRow->get_nth(4)->replace_value(new Oid(litUsmNoAuthProtocol));
       ukc5->initialize(0, 0, AUTHKEY, ukc6);
       ukc6->initialize(0, 0, AUTHKEY, ukc5);
       ukc8->initialize(0, 0, PRIVKEY, ukc9);
@@ -421,7 +455,7 @@ UsmUserTable::UsmUserTable(): StorageTable(oidUsmUserEntry, iUsmUserTable,
 
     if (user->usmUserPrivProtocol == SNMP_PRIVPROTOCOL_NONE)
     {
-      newRow->get_nth(7)->replace_value(new Oid(oidUsmNoPrivProtocol));
+      newRow->get_nth(7)->replace_value(new Oid(litUsmNoPrivProtocol));
     }
     else
     {
@@ -476,7 +510,7 @@ bool UsmUserTable::ready_for_service(Vbx* pvbs, int sz)
   // check if cloneFrom ("4") was set:
   Oidx o;
   pvbs[3].get_value(o);
-  if (o == "0.0")
+  if (o == litZeroDotZero)
     return FALSE;
 
   return TRUE;
@@ -492,7 +526,7 @@ void UsmUserTable::initialize_key_change(MibTableRow* row)
   UsmKeyChange *ukc8 = (UsmKeyChange*)row->get_nth(8);
   UsmKeyChange *ukc9 = (UsmKeyChange*)row->get_nth(9);
   
-  if ((o == oidUsmNoAuthProtocol) ||
+  if ((o == litUsmNoAuthProtocol) ||
       (auth_base.len() + 1 != o.len()) ||
       (!auth_base.is_root_of(o)))
   {
@@ -522,7 +556,7 @@ void UsmUserTable::initialize_key_change(MibTableRow* row)
 
     Oidx op;
     row->get_nth(7)->get_value(op); // oid priv protocol
-    if ((op == oidUsmNoPrivProtocol) ||
+    if ((op == litUsmNoPrivProtocol) ||
 	(priv_base.len() + 1 != op.len()) ||
 	(!priv_base.is_root_of(op)))
     {
@@ -746,7 +780,7 @@ MibTableRow *UsmUserTable::addNewRow(const OctetStr& engineID,
   
   if (authProtocol == SNMP_AUTHPROTOCOL_NONE)
   {
-    newRow->get_nth(4)->replace_value(new Oid(oidUsmNoAuthProtocol));
+    newRow->get_nth(4)->replace_value(new Oid(litUsmNoAuthProtocol));
     ukc5->initialize(0, 0, AUTHKEY, ukc6);
     ukc6->initialize(0, 0, AUTHKEY, ukc5);
     ukc8->initialize(0, 0, PRIVKEY, ukc9);
@@ -779,7 +813,7 @@ MibTableRow *UsmUserTable::addNewRow(const OctetStr& engineID,
 
   if (privProtocol == SNMP_PRIVPROTOCOL_NONE)
   {
-    newRow->get_nth(7)->replace_value(new Oid(oidUsmNoPrivProtocol));
+    newRow->get_nth(7)->replace_value(new Oid(litUsmNoPrivProtocol));
   }
   else
   {
@@ -861,7 +895,7 @@ void UsmUserTable::deleteRows(const OctetStr& userName)
 
  
 UsmCloneFrom::UsmCloneFrom(Oidx o)
-  : MibLeaf(o, READCREATE, new Oidx("0.0"), VMODE_DEFAULT)
+  : MibLeaf(o, READCREATE, new Oidx(litZeroDotZero), VMODE_DEFAULT)
 {
   v3MP *v3mp = v3MP::I;
   if (!v3mp)
@@ -881,7 +915,7 @@ void UsmCloneFrom::get_request(Request* req, int ind)
 {
   // getRequest to this object returns 0.0
   Vbx vb(req->get_oid(ind));
-  Oid o("0.0");
+  Oid o(litZeroDotZero);
   vb.set_value(o);
 
   if (get_access() >= READONLY)
@@ -896,7 +930,7 @@ int UsmCloneFrom::prepare_set_request(Request* req, int& ind)
   if (get_access() >= READWRITE) {
     if (value->get_syntax() == req->get_value(ind).get_syntax()) {
       if (value_ok(req->get_value(ind))) {
-	Oidx o, base = oidUsmUserEntry;
+	Oidx o, base = litUsmUserEntry;
 	req->get_value(ind).get_value(o);
 	o = o.cut_left(base.len() + 1);
 
@@ -951,7 +985,7 @@ int UsmCloneFrom::set(const Vbx& vb)
 	return SNMP_ERROR_SUCCESS;       // and return success!
       }	  
 
-      Oidx o, base = oidUsmUserEntry;
+      Oidx o, base = litUsmUserEntry;
       vb.get_value(o);
       o = o.cut_left(base.len()+1);
 
@@ -981,7 +1015,7 @@ int UsmCloneFrom::set(const Vbx& vb)
       UsmKeyChange *ukc8 = (UsmKeyChange*)my_row->get_nth(8);
       UsmKeyChange *ukc9 = (UsmKeyChange*)my_row->get_nth(9);
 
-      if ((auth_oid == oidUsmNoAuthProtocol) ||
+      if ((auth_oid == litUsmNoAuthProtocol) ||
 	  (UsmUserTable::auth_base.len() + 1 != auth_oid.len()) ||
 	  (!UsmUserTable::auth_base.is_root_of(auth_oid))) {
 	ukc5->initialize(0, 0, AUTHKEY, ukc6);
@@ -1010,7 +1044,7 @@ int UsmCloneFrom::set(const Vbx& vb)
 	Oidx priv_oid;
 	my_row->get_nth(7)->get_value(priv_oid);
 
-	if ((priv_oid == oidUsmNoPrivProtocol) ||
+	if ((priv_oid == litUsmNoPrivProtocol) ||
 	    (UsmUserTable::priv_base.len() + 1 != priv_oid.len()) ||
 	    (!UsmUserTable::priv_base.is_root_of(priv_oid)))
 	{
@@ -1055,12 +1089,12 @@ bool UsmCloneFrom::value_ok(const Vbx& vb)
 {
   // check if row exists
   Oidx o;
-  Oidx base = oidUsmUserEntry;
+  Oidx base = litUsmUserEntry;
 
   if (vb.get_value(o) != SNMP_CLASS_SUCCESS)
     return FALSE;
 
-  Oidx n("0.0");
+  Oidx n(litZeroDotZero);
   if (o == n) return TRUE;
 
   if ((o.len() < base.len()+ 3 ) ||
@@ -1098,7 +1132,7 @@ MibEntryPtr UsmCloneFrom::clone()
 {
   MibEntryPtr other = new UsmCloneFrom(oid);
   // don't clone value, instead set default value
-  ((UsmCloneFrom*)other)->replace_value(new Oid("0.0"));
+  ((UsmCloneFrom*)other)->replace_value(new Oid(litZeroDotZero));
   ((UsmCloneFrom*)other)->set_reference_to_table(my_table);
   return other;
 }
@@ -1159,7 +1193,7 @@ int UsmKeyChange::prepare_set_request(Request* req, int& ind)
     if (value->get_syntax() == req->get_value(ind).get_syntax()) {
 
       if (key_len < 0) {
-	  Oidx cloneFromOID(oidUsmUserEntry);
+	  Oidx cloneFromOID(litUsmUserEntry);
 	  cloneFromOID += 4; // cloneFrom
 	  cloneFromOID += my_row->get_index();
 	  Vbx* vb = req->search_value(cloneFromOID); 
@@ -1453,7 +1487,7 @@ int UsmOwnKeyChange::prepare_set_request(Request* req, int& ind)
  **********************************************************************/
 
 UsmStatsUnsupportedSecLevels::UsmStatsUnsupportedSecLevels(const USM *u)
-  : MibLeaf( oidUsmStatsUnsupportedSecLevels, READONLY, new Counter32(0)),
+  : MibLeaf( litUsmStatsUnsupportedSecLevels, READONLY, new Counter32(0)),
     usm(u)
 {
 }
@@ -1472,7 +1506,7 @@ void UsmStatsUnsupportedSecLevels::get_request(Request* req, int index)
  **********************************************************************/
 
 UsmStatsNotInTimeWindows::UsmStatsNotInTimeWindows(const USM *u)
-  : MibLeaf( oidUsmStatsNotInTimeWindows, READONLY, new Counter32(0)),
+  : MibLeaf( litUsmStatsNotInTimeWindows, READONLY, new Counter32(0)),
     usm(u)
 {
 }
@@ -1491,7 +1525,7 @@ void UsmStatsNotInTimeWindows::get_request(Request* req, int index)
  **********************************************************************/
 
 UsmStatsUnknownUserNames::UsmStatsUnknownUserNames(const USM *u)
-  : MibLeaf( oidUsmStatsUnknownUserNames, READONLY, new Counter32(0)),
+  : MibLeaf( litUsmStatsUnknownUserNames, READONLY, new Counter32(0)),
     usm(u)
 {
 }
@@ -1509,7 +1543,7 @@ void UsmStatsUnknownUserNames::get_request(Request* req, int index)
  **********************************************************************/
 
 UsmStatsUnknownEngineIDs::UsmStatsUnknownEngineIDs(const USM *u)
-  : MibLeaf( oidUsmStatsUnknownEngineIDs, READONLY, new Counter32(0)),
+  : MibLeaf( litUsmStatsUnknownEngineIDs, READONLY, new Counter32(0)),
     usm(u)
 {
 }
@@ -1527,7 +1561,7 @@ void UsmStatsUnknownEngineIDs::get_request(Request* req, int index)
  **********************************************************************/
 
 UsmStatsWrongDigests::UsmStatsWrongDigests(const USM *u)
-  : MibLeaf( oidUsmStatsWrongDigests, READONLY, new Counter32(0)),
+  : MibLeaf( litUsmStatsWrongDigests, READONLY, new Counter32(0)),
     usm(u)
 {
 }
@@ -1544,7 +1578,7 @@ void UsmStatsWrongDigests::get_request(Request* req, int index)
  * 
  **********************************************************************/
 UsmStatsDecryptionErrors::UsmStatsDecryptionErrors(const USM *u)
-  : MibLeaf( oidUsmStatsDecryptionErrors, READONLY, new Counter32(0)),
+  : MibLeaf( litUsmStatsDecryptionErrors, READONLY, new Counter32(0)),
     usm(u)
 {
 }
@@ -1560,7 +1594,7 @@ void UsmStatsDecryptionErrors::get_request(Request* req, int index)
  * 
  **********************************************************************/
 
-UsmStats::UsmStats(void): MibGroup(oidUsmStats) 
+UsmStats::UsmStats(void): MibGroup(litUsmStats) 
 {
   v3MP *v3mp = v3MP::I;
   if (!v3mp)
@@ -1582,14 +1616,14 @@ UsmStats::UsmStats(void): MibGroup(oidUsmStats)
   add(new UsmStatsDecryptionErrors(usm));
 }
 
-usm_mib::usm_mib(UsmUserTable* t): MibGroup("1.3.6.1.6.3.15", "usmMIB")
+usm_mib::usm_mib(UsmUserTable* t): MibGroup(litUsmMIB, "usmMIB")
 {
-	add(new TestAndIncr("1.3.6.1.6.3.15.1.2.1.0"));
+	add(new TestAndIncr(litUsmUserSpinLock));
 	add(t);
 }
 
 MPDGroupSnmpUnknownSecurityModels::MPDGroupSnmpUnknownSecurityModels(const v3MP *mp)
-  : MibLeaf( oidSnmpUnknownSecurityModels, READONLY, new Counter32(0)),
+  : MibLeaf( litSnmpUnknownSecurityModels, READONLY, new Counter32(0)),
     v3mp(mp) {}
 void MPDGroupSnmpUnknownSecurityModels::get_request(Request* req, int index)
 {
@@ -1598,7 +1632,7 @@ void MPDGroupSnmpUnknownSecurityModels::get_request(Request* req, int index)
 }
  
 MPDGroupSnmpInvalidMsgs::MPDGroupSnmpInvalidMsgs(const v3MP *mp)
-  : MibLeaf( oidSnmpInvalidMsgs, READONLY, new Counter32(0)),
+  : MibLeaf( litSnmpInvalidMsgs, READONLY, new Counter32(0)),
     v3mp(mp) {}
 void MPDGroupSnmpInvalidMsgs::get_request(Request* req, int index)
 {
@@ -1607,7 +1641,7 @@ void MPDGroupSnmpInvalidMsgs::get_request(Request* req, int index)
 }
 
 MPDGroupSnmpUnknownPDUHandlers::MPDGroupSnmpUnknownPDUHandlers(const v3MP *mp)
-  : MibLeaf( oidSnmpUnknownPDUHandlers, READONLY, new Counter32(0)),
+  : MibLeaf( litSnmpUnknownPDUHandlers, READONLY, new Counter32(0)),
     v3mp(mp) {}
 void MPDGroupSnmpUnknownPDUHandlers::get_request(Request* req, int index)
 {
@@ -1616,7 +1650,7 @@ void MPDGroupSnmpUnknownPDUHandlers::get_request(Request* req, int index)
 }
 
 
-MPDGroup::MPDGroup(void): MibGroup(oidMPDGroup)
+MPDGroup::MPDGroup(void): MibGroup(litMPDGroup)
 {
   v3MP *v3mp = v3MP::I;
   if (!v3mp)
@@ -1632,7 +1666,7 @@ MPDGroup::MPDGroup(void): MibGroup(oidMPDGroup)
 }
 
 usmUserAuthProtocol::usmUserAuthProtocol(const Oidx& o, USM *u):
-  MibLeaf(o, READCREATE, new Oidx(oidUsmNoAuthProtocol), VMODE_DEFAULT),
+  MibLeaf(o, READCREATE, new Oidx(litUsmNoAuthProtocol), VMODE_DEFAULT),
   usm(u)
 {
 }
@@ -1642,7 +1676,7 @@ bool usmUserAuthProtocol::value_ok(const Vbx& vb)
 	Oidx o;
 	if (vb.get_value(o) != SNMP_CLASS_SUCCESS)
 	    return FALSE;
-	if (o == oidUsmNoAuthProtocol)
+	if (o == litUsmNoAuthProtocol)
 	  return TRUE;
 	if ((o == *(Oidx *)value) && (o.len() > 2))
 	  return TRUE;
@@ -1669,7 +1703,7 @@ MibEntryPtr usmUserAuthProtocol::clone()
 }
 
 usmUserPrivProtocol::usmUserPrivProtocol(const Oidx& o, USM *u):
-  MibLeaf(o, READCREATE, new Oidx(oidUsmNoPrivProtocol), VMODE_DEFAULT),
+  MibLeaf(o, READCREATE, new Oidx(litUsmNoPrivProtocol), VMODE_DEFAULT),
   usm(u)
 {
 }
@@ -1681,7 +1715,7 @@ int usmUserPrivProtocol::prepare_set_request(Request* req, int& ind)
 	if (vb.get_value(o) != SNMP_CLASS_SUCCESS)
 	    return SNMP_ERROR_WRONG_TYPE;
 
-	if (o != oidUsmNoPrivProtocol) {
+	if (o != litUsmNoPrivProtocol) {
 	    if ((UsmUserTable::priv_base.len() + 1 != o.len()) ||
 		(!UsmUserTable::priv_base.is_root_of(o)) ||
 		(!usm->get_auth_priv()->get_priv(o.last())))
@@ -1691,7 +1725,7 @@ int usmUserPrivProtocol::prepare_set_request(Request* req, int& ind)
 	    {
 		Oidx auth;
 		my_row->get_nth(4)->get_value(auth);
-		if (auth == oidUsmNoAuthProtocol)
+		if (auth == litUsmNoAuthProtocol)
 		    return SNMP_ERROR_INCONSIST_VAL;
 	    }
 	}
@@ -1703,7 +1737,7 @@ bool usmUserPrivProtocol::value_ok(const Vbx& vb)
 	Oidx o;
 	if (vb.get_value(o) != SNMP_CLASS_SUCCESS)
 	    return FALSE;
-	if (o == oidUsmNoPrivProtocol)
+	if (o == litUsmNoPrivProtocol)
 	  return TRUE;
 	if ((o == *(Oidx *)value) && (o.len() > 2))
 	  return TRUE;
@@ -31,6 +31,17 @@ namespace Agentpp {
 
 static const char *loggerModuleName = "agent++.vacm";
 
+// oid literals of the objects used in this module
+static SNMP_PP_OID_LITERAL(litSnmpUnavailableContexts, oidSnmpUnavailableContexts);
+static SNMP_PP_OID_LITERAL(litSnmpUnknownContexts, oidSnmpUnknownContexts);
+static SNMP_PP_OID_LITERAL(litVacmAccessEntry, oidVacmAccessEntry);
+static SNMP_PP_OID_LITERAL(litVacmContextEntry, oidVacmContextEntry);
+static SNMP_PP_OID_LITERAL(litVacmMIBObjects, oidVacmMIBObjects);
+static SNMP_PP_OID_LITERAL(litVacmSecurityToGroupEntry, oidVacmSecurityToGroupEntry);
+static SNMP_PP_OID_LITERAL(litVacmViewSpinLock, "1.3.6.1.6.3.16.1.5.1.0");
+static SNMP_PP_OID_LITERAL(litVacmViewTreeFamilyEntry, oidVacmViewTreeFamilyEntry);
+static SNMP_PP_OID_LITERAL(litZeroDotZero, "0.0");
+
 const index_info       	iVacmSecurityToGroupTable[2]	=
 { { sNMP_SYNTAX_INT, FALSE, 1, 1 }, { sNMP_SYNTAX_OCTETS, FALSE, 1, 32 } };
 const unsigned int	lVacmSecurityToGroupTable	= 2;
@@ -50,7 +61,7 @@ const unsigned int	lVacmViewTreeFamilyTable	= 2;
 
 
 SnmpUnavailableContexts::SnmpUnavailableContexts():
-  MibLeaf(oidSnmpUnavailableContexts, READONLY, new Counter32(0))
+  MibLeaf(litSnmpUnavailableContexts, READONLY, new Counter32(0))
 {}
 
 void SnmpUnavailableContexts::incValue()
@@ -64,7 +75,7 @@ SnmpInt32 SnmpUnavailableContexts::getValue()
 }
 
 SnmpUnknownContexts::SnmpUnknownContexts():
-  MibLeaf(oidSnmpUnknownContexts, READONLY, new Counter32(0))
+  MibLeaf(litSnmpUnknownContexts, READONLY, new Counter32(0))
 {}
 
 void SnmpUnknownContexts::incValue()
@@ -85,7 +96,7 @@ SnmpInt32 SnmpUnknownContexts::getValue()
                VacmContextTable
 
  ********************************************************************/
-VacmContextTable::VacmContextTable(): MibTable(oidVacmContextEntry,
+VacmContextTable::VacmContextTable(): MibTable(litVacmContextEntry,
 					       iVacmContextTable,
 					       lVacmContextTable)
 {
@@ -140,10 +151,10 @@ bool VacmContextTable::isContextSupported(const OctetStr& context)
  ********************************************************************/
 
 VacmSecurityToGroupTable::VacmSecurityToGroupTable():
-  StorageTable(oidVacmSecurityToGroupEntry, iVacmSecurityToGroupTable,
+  StorageTable(litVacmSecurityToGroupEntry, iVacmSecurityToGroupTable,
 	       lVacmSecurityToGroupTable)
 {
-  Oidx tmpoid = Oidx(oidVacmSecurityToGroupEntry);
+  Oidx tmpoid = Oidx(litVacmSecurityToGroupEntry);
 
   // vacmSecurityModel
   add_col(new SnmpInt32MinMax("1", NOACCESS, 0, VMODE_NONE, 1, 3));
@@ -306,11 +317,11 @@ MibEntryPtr VacmAccessTableStatus::clone()
 }
 
 VacmAccessTable::VacmAccessTable(VacmSecurityToGroupTable* stogt):
-  StorageTable(oidVacmAccessEntry, iVacmAccessTable, lVacmAccessTable)
+  StorageTable(litVacmAccessEntry, iVacmAccessTable, lVacmAccessTable)
 {
   securityToGroupTable = stogt;
 
-  Oidx tmpoid = Oidx(oidVacmSecurityToGroupEntry);
+  Oidx tmpoid = Oidx(litVacmSecurityToGroupEntry);
 
   // vacmAccessContextPrefix
   add_col(new SnmpAdminString("1", NOACCESS, new OctetStr(""),
@@ -647,16 +658,16 @@ MibEntryPtr VacmViewTreeFamilyTableStatus::clone()
 
 
 VacmViewTreeFamilyTable::VacmViewTreeFamilyTable()
-  : StorageTable(oidVacmViewTreeFamilyEntry, iVacmViewTreeFamilyTable,
+  : StorageTable(litVacmViewTreeFamilyEntry, iVacmViewTreeFamilyTable,
 		 lVacmViewTreeFamilyTable)
 {
-  Oidx tmpoid = Oidx(oidVacmViewTreeFamilyEntry);
+  Oidx tmpoid = Oidx(litVacmViewTreeFamilyEntry);
 
   // VacmViewTreeFamilyViewName
   add_col(new SnmpAdminString("1", NOACCESS, new OctetStr(""),
 			      VMODE_DEFAULT, 1, 32));
   // VacmViewTreeFamilySubtree
-  add_col(new MibLeaf("2", NOACCESS, new Oid("0.0"),VMODE_DEFAULT));
+  add_col(new MibLeaf("2", NOACCESS, new Oid(litZeroDotZero),VMODE_DEFAULT));
   // VacmViewTreeFamilyMask
   add_col(new SnmpAdminString("3", READCREATE, new OctetStr(""),
 			      VMODE_DEFAULT, 0, 16));
@@ -772,13 +783,10 @@ int VacmViewTreeFamilyTable::isInMibView(const OctetStr& viewName, const Oidx& s
     ind = ind.cut_left(1);
     OctetStr mask;
     cur.get()->get_nth(2)->get_value(mask);
-    bool ok = TRUE;
-    for (unsigned int i=0; i<ind.len(); i++) {
-      if ((ind[i] != subtree[i]) && (bit(i, mask))) {
-	ok = FALSE;
-	break;
-      }
-    }
+    bool ok = ((ind.len() <= subtree.len()) &&
+	       oid_masked_match(ind.get_smival().value.oid.ptr,
+				subtree.get_smival().value.oid.ptr,
+				ind.len(), mask.data(), mask.len()));
     if (ok) {
       if (found) { // already found one
 	if (foundSubtreeLen <= ind.len()) {
@@ -910,14 +918,14 @@ ViewNameIndex* VacmViewTreeFamilyTable::viewsOf(const OctetStr& viewName)
                VacmMIB
 
  ********************************************************************/
-VacmMIB::VacmMIB(Vacm::ClassPointers vcp): MibGroup(oidVacmMIBObjects,
+VacmMIB::VacmMIB(Vacm::ClassPointers vcp): MibGroup(litVacmMIBObjects,
 						  "snmpVacmMIB")
 {
   add(vcp.contextTable);
   add(vcp.securityToGroupTable);
   add(vcp.accessTable);
   add(vcp.viewTreeFamilyTable);
-  add(new TestAndIncr("1.3.6.1.6.3.16.1.5.1.0"));
+  add(new TestAndIncr(litVacmViewSpinLock));
 }
 
 Vacm::Vacm()
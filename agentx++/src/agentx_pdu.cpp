@@ -663,7 +663,7 @@ AgentXPdu& AgentXPdu::operator+=(const Vbx& vb)
 	if (vb_count + 1 > PDU_MAX_VBS) return *this; // do we have room?
 #endif
 
-	vbs[vb_count] = new Vbx(vb);  // add the new one
+	vbs[vb_count] = alloc_vb(vb);  // add the new one
 
 	if (vbs[vb_count])   // up the vb count on success
 	{
@@ -706,6 +706,7 @@ void AgentXPdu::copy_from(const AgentXPdu& other)
 	// copy vbs
 	clear();
 	int count = other.get_vb_count();
+	reserve(count);
 	Vbx* _vbs = new Vbx[count];
 	other.get_vblist(_vbs, count);
 	for (int i=0; i<count; i++) {
@@ -100,6 +100,8 @@ bool AgentXRequest::add_rep_row()
 	int rows = (pdu->get_vb_count() - non_rep) / repeater;
 	if (rows == 0) return FALSE;
 
+	reserve_rep_row();
+
 	Vbx vb;
 	for (int i=(rows-1)*repeater+non_rep; i<(rows*repeater)+non_rep; i++) {
 
@@ -0,0 +1,188 @@
+/*_############################################################################
+  _##
+  _##  batchBench.cpp
+  _##
+  _##  SNMP++ v3.3
+  _##  -----------------------------------------------
+  _##  Copyright (c) 2001-2013 Jochen Katz, Frank Fock
+  _##
+  _##  This software is based on SNMP++2.6 from Hewlett Packard:
+  _##
+  _##    Copyright (c) 1996
+  _##    Hewlett-Packard Company
+  _##
+  _##  ATTENTION: USE OF THIS SOFTWARE IS SUBJECT TO THE FOLLOWING TERMS.
+  _##  Permission to use, copy, modify, distribute and/or sell this software
+  _##  and/or its documentation is hereby granted without fee. User agrees
+  _##  to display the above copyright notice and this license notice in all
+  _##  copies of the software and any documentation of the software. User
+  _##  agrees to assume all liability for the use of the software;
+  _##  Hewlett-Packard and Jochen Katz make no representations about the
+  _##  suitability of this software for any purpose. It is provided
+  _##  "AS-IS" without warranty of any kind, either express or implied. User
+  _##  hereby grants a royalty-free license to any and all derivatives based
+  _##  upon this software code base.
+  _##
+  _##########################################################################*/
+
+
+/*
+  Benchmark for batched sending and receiving of datagrams.
+
+  Sends bursts of SNMP sized datagrams over the loopback interface
+  and reads them from a second socket, once with one sendto() and
+  recvfrom() call per datagram and once through SnmpDatagramBatch,
+  which uses sendmmsg() and recvmmsg() if available. The result is
+  given in packets per second of process time.
+
+  Usage: batchBench [packets [burst]]
+*/
+
+#include <libsnmp.h>
+#include <time.h>
+
+#include "snmp_pp/snmp_pp.h"
+
+#ifdef SNMP_PP_NAMESPACE
+using namespace Snmp_pp;
+#endif
+
+#ifdef WIN32
+
+int main(int, char **)
+{
+  cout << "batchBench needs BSD sockets" << endl;
+  return 1;
+}
+
+#else
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <poll.h>
+
+#define DATAGRAM_LENGTH 120
+
+static void report(const char *name, clock_t start, long packets)
+{
+  double secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+  cout << name << ": " << (long)(packets / secs) << " packets/s" << endl;
+}
+
+static int open_socket(struct sockaddr_in &addr)
+{
+  int sock = socket(AF_INET, SOCK_DGRAM, 0);
+  if (sock < 0)
+    return -1;
+
+  int size = 4 * 1024 * 1024;
+  setsockopt(sock, SOL_SOCKET, SO_RCVBUF, (char *)&size, sizeof(size));
+
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t len = sizeof(addr);
+  if ((bind(sock, (struct sockaddr *)&addr, sizeof(addr)) < 0) ||
+      (getsockname(sock, (struct sockaddr *)&addr, &len) < 0))
+  {
+    close(sock);
+    return -1;
+  }
+  return sock;
+}
+
+static bool wait_readable(int sock)
+{
+  struct pollfd fd;
+  fd.fd = sock;
+  fd.events = POLLIN;
+  return (poll(&fd, 1, 1000) > 0);
+}
+
+int main(int argc, char **argv)
+{
+  long packets = (argc > 1) ? atol(argv[1]) : 1000000;
+  int burst = (argc > 2) ? atoi(argv[2]) : 32;
+  if ((packets <= 0) || (burst <= 0))
+  {
+    cout << "Usage: " << argv[0] << " [packets [burst]]" << endl;
+    return 1;
+  }
+
+  struct sockaddr_in send_addr, recv_addr;
+  int send_sock = open_socket(send_addr);
+  int recv_sock = open_socket(recv_addr);
+  if ((send_sock < 0) || (recv_sock < 0))
+  {
+    cout << "Could not open sockets on the loopback interface" << endl;
+    return 1;
+  }
+
+  char buf[32];
+  sprintf(buf, "127.0.0.1/%d", ntohs(recv_addr.sin_port));
+  UdpAddress receiver(buf);
+
+  unsigned char data[DATAGRAM_LENGTH];
+  memset(data, 0x30, sizeof(data));
+  unsigned char in[MAX_SNMP_PACKET + 1];
+  long received = 0;
+  long failed = 0;
+
+  clock_t start = clock();
+  for (long done = 0; done < packets; done += burst)
+  {
+    for (int i = 0; i < burst; i++)
+      if (sendto(send_sock, (char *)data, sizeof(data), 0,
+                 (struct sockaddr *)&recv_addr, sizeof(recv_addr)) < 0)
+        failed++;
+    for (int i = 0; i < burst; i++)
+    {
+      if (recvfrom(recv_sock, (char *)in, sizeof(in), 0, 0, 0) < 0)
+        break;
+      received++;
+    }
+  }
+  report("sendto/recvfrom  ", start, packets);
+  if (failed || (received < packets))
+    cout << "  sent " << packets - failed << ", received " << received
+         << endl;
+
+  SnmpDatagramBatch send_batch(burst);
+  SnmpDatagramBatch recv_batch(burst);
+  received = 0;
+  failed = 0;
+
+  start = clock();
+  for (long done = 0; done < packets; done += burst)
+  {
+    for (int i = 0; i < burst; i++)
+      send_batch.add(data, sizeof(data), receiver);
+    failed += burst - send_batch.send(send_sock);
+    for (int pending = burst; pending > 0;)
+    {
+      // loopback datagrams are usually pending when send() returns
+      int count = recv_batch.receive(recv_sock);
+      if (count <= 0)
+      {
+        if (!wait_readable(recv_sock))
+          break;
+        continue;
+      }
+      pending -= count;
+      received += count;
+    }
+  }
+  report("SnmpDatagramBatch", start, packets);
+  if (failed || (received < packets))
+    cout << "  sent " << packets - failed << ", received " << received
+         << endl;
+
+  close(send_sock);
+  close(recv_sock);
+  return 0;
+}
+
+#endif
@@ -0,0 +1,168 @@
+/*_############################################################################
+  _##
+  _##  encodeBench.cpp
+  _##
+  _##  SNMP++ v3.3
+  _##  -----------------------------------------------
+  _##  Copyright (c) 2001-2013 Jochen Katz, Frank Fock
+  _##
+  _##  This software is based on SNMP++2.6 from Hewlett Packard:
+  _##
+  _##    Copyright (c) 1996
+  _##    Hewlett-Packard Company
+  _##
+  _##  ATTENTION: USE OF THIS SOFTWARE IS SUBJECT TO THE FOLLOWING TERMS.
+  _##  Permission to use, copy, modify, distribute and/or sell this software
+  _##  and/or its documentation is hereby granted without fee. User agrees
+  _##  to display the above copyright notice and this license notice in all
+  _##  copies of the software and any documentation of the software. User
+  _##  agrees to assume all liability for the use of the software;
+  _##  Hewlett-Packard and Jochen Katz make no representations about the
+  _##  suitability of this software for any purpose. It is provided
+  _##  "AS-IS" without warranty of any kind, either express or implied. User
+  _##  hereby grants a royalty-free license to any and all derivatives based
+  _##  upon this software code base.
+  _##
+  _##########################################################################*/
+
+
+/*
+  Microbenchmark for the encoding of SNMPv2c messages.
+
+  Encodes a response with 50 ifTable varbinds of mixed syntaxes,
+  once through struct snmp_pdu as SnmpMessage::load() did before
+  (converting every Vb to a SmiVALUE and copying it into the raw pdu)
+  and once directly from the Pdu into the message buffer. Both
+  encodings are checked to be equal.
+
+  Usage: encodeBench [iterations]
+*/
+
+#include <libsnmp.h>
+#include <time.h>
+
+#include "snmp_pp/snmp_pp.h"
+#include "snmp_pp/snmpmsg.h"
+#include "snmp_pp/asn1.h"
+
+#ifdef SNMP_PP_NAMESPACE
+using namespace Snmp_pp;
+#endif
+
+#define NUM_VBS 50
+
+static void report(const char *name, clock_t start, long ops)
+{
+  double ns = (double)(clock() - start) * 1e9 / CLOCKS_PER_SEC / ops;
+  cout << name << ": " << ns << " ns/msg" << endl;
+}
+
+// encode the pdu through struct snmp_pdu
+static int build_raw(const Pdu &pdu, unsigned char *buf, int *len,
+                     const OctetStr &community)
+{
+  snmp_pdu *raw_pdu = snmp_pdu_create((int)pdu.get_type());
+  raw_pdu->reqid = pdu.get_request_id();
+  raw_pdu->errstat = (unsigned long)pdu.get_error_status();
+  raw_pdu->errindex = (unsigned long)pdu.get_error_index();
+
+  Vb vb;
+  Oid oid;
+  SmiVALUE smival;
+  for (int i = 0; i < pdu.get_vb_count(); i++)
+  {
+    pdu.get_vb(vb, i);
+    vb.get_oid(oid);
+    if (convertVbToSmival(vb, &smival) != SNMP_CLASS_SUCCESS)
+    {
+      snmp_free_pdu(raw_pdu);
+      return -1;
+    }
+    snmp_add_var(raw_pdu, oid.oidval()->ptr, (int)oid.len(), &smival);
+    freeSmivalDescriptor(&smival);
+  }
+  int status = snmp_build(raw_pdu, buf, len, version2c,
+                          community.data(), (int)community.len());
+  snmp_free_pdu(raw_pdu);
+  return status;
+}
+
+int main(int argc, char **argv)
+{
+  long iterations = 100000;
+  if (argc > 1) iterations = atol(argv[1]);
+  if (iterations <= 0) iterations = 1;
+
+#ifndef _NO_LOGGING
+  DefaultLog::log()->set_filter(ERROR_LOG, 0);
+  DefaultLog::log()->set_filter(WARNING_LOG, 0);
+  DefaultLog::log()->set_filter(EVENT_LOG, 0);
+  DefaultLog::log()->set_filter(INFO_LOG, 0);
+  DefaultLog::log()->set_filter(DEBUG_LOG, 0);
+#endif
+
+  // a response to a GETBULK on the ifTable
+  Pdu pdu;
+  pdu.set_type(sNMP_PDU_RESPONSE);
+  pdu.set_request_id(4711);
+  for (int i = 0; i < NUM_VBS; i++)
+  {
+    Oid oid("1.3.6.1.2.1.2.2.1");
+    oid += (unsigned long)(1 + i % 22);    // column
+    oid += (unsigned long)(1 + i / 22);    // ifIndex
+    Vb vb(oid);
+    switch (i % 5)
+    {
+      case 0: vb.set_value(OctetStr("GigabitEthernet0/1")); break;
+      case 1: vb.set_value(Counter32(123456789UL + i)); break;
+      case 2: vb.set_value(Counter64(1, 987654321UL + i)); break;
+      case 3: vb.set_value(Oid("1.3.6.1.4.1.4976.1.2")); break;
+      default: vb.set_value(SnmpInt32(i)); break;
+    }
+    pdu += vb;
+  }
+  OctetStr community("public");
+
+  unsigned char raw_buf[MAX_SNMP_PACKET];
+  unsigned char direct_buf[MAX_SNMP_PACKET];
+  int raw_len = MAX_SNMP_PACKET;
+  int direct_len = MAX_SNMP_PACKET;
+  if ((build_raw(pdu, raw_buf, &raw_len, community) != 0) ||
+      (snmp_build(pdu, direct_buf, &direct_len, version2c,
+                  community.data(), (int)community.len()) != 0))
+  {
+    cout << "Encoding failed" << endl;
+    return 1;
+  }
+  if ((raw_len != direct_len) || memcmp(raw_buf, direct_buf, raw_len))
+  {
+    cout << "Encodings differ" << endl;
+    return 1;
+  }
+  cout << NUM_VBS << " varbinds, " << direct_len << " bytes" << endl;
+
+  clock_t start = clock();
+  for (long n = 0; n < iterations; ++n)
+  {
+    raw_len = MAX_SNMP_PACKET;
+    build_raw(pdu, raw_buf, &raw_len, community);
+  }
+  report("snmp_pdu          ", start, iterations);
+
+  start = clock();
+  for (long n = 0; n < iterations; ++n)
+  {
+    direct_len = MAX_SNMP_PACKET;
+    snmp_build(pdu, direct_buf, &direct_len, version2c,
+               community.data(), (int)community.len());
+  }
+  report("Pdu (direct)      ", start, iterations);
+
+  SnmpMessage msg;
+  start = clock();
+  for (long n = 0; n < iterations; ++n)
+    msg.load(pdu, community, version2c);
+  report("SnmpMessage::load ", start, iterations);
+
+  return 0;
+}
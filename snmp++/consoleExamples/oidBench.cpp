@@ -0,0 +1,157 @@
+/*_############################################################################
+  _##
+  _##  oidBench.cpp
+  _##
+  _##  SNMP++ v3.3
+  _##  -----------------------------------------------
+  _##  Copyright (c) 2001-2013 Jochen Katz, Frank Fock
+  _##
+  _##  This software is based on SNMP++2.6 from Hewlett Packard:
+  _##
+  _##    Copyright (c) 1996
+  _##    Hewlett-Packard Company
+  _##
+  _##  ATTENTION: USE OF THIS SOFTWARE IS SUBJECT TO THE FOLLOWING TERMS.
+  _##  Permission to use, copy, modify, distribute and/or sell this software
+  _##  and/or its documentation is hereby granted without fee. User agrees
+  _##  to display the above copyright notice and this license notice in all
+  _##  copies of the software and any documentation of the software. User
+  _##  agrees to assume all liability for the use of the software;
+  _##  Hewlett-Packard and Jochen Katz make no representations about the
+  _##  suitability of this software for any purpose. It is provided
+  _##  "AS-IS" without warranty of any kind, either express or implied. User
+  _##  hereby grants a royalty-free license to any and all derivatives based
+  _##  upon this software code base.
+  _##
+  _##########################################################################*/
+
+/*
+  Microbenchmark for the oid comparison functions (oid_cmp.h).
+
+  Compares ifTable instance oids (1.3.6.1.2.1.2.2.1.<column>.<ifIndex>)
+  with the comparison functions and with a plain loop.
+
+  Usage: oidBench [iterations]
+*/
+
+#include <libsnmp.h>
+#include <time.h>
+
+#include "snmp_pp/snmp_pp.h"
+
+#ifdef SNMP_PP_NAMESPACE
+using namespace Snmp_pp;
+#endif
+
+#define NUM_OIDS 64
+
+// reference implementation: compare subidentifier by subidentifier
+static int loop_compare(const SmiUINT32 *a, unsigned long a_len,
+                        const SmiUINT32 *b, unsigned long b_len)
+{
+  unsigned long n = (a_len < b_len) ? a_len : b_len;
+  for (unsigned long i = 0; i < n; ++i)
+  {
+    if (a[i] < b[i]) return -1;
+    if (a[i] > b[i]) return 1;
+  }
+  if (a_len < b_len) return -1;
+  if (a_len > b_len) return 1;
+  return 0;
+}
+
+static void report(const char *name, clock_t start, long ops, long result)
+{
+  double ns = (double)(clock() - start) * 1e9 / CLOCKS_PER_SEC / ops;
+  cout << name << ": " << ns << " ns/op (" << result << ")" << endl;
+}
+
+int main(int argc, char **argv)
+{
+  long iterations = 200000;
+  if (argc > 1) iterations = atol(argv[1]);
+  if (iterations <= 0) iterations = 1;
+
+#ifdef SNMP_PP_OID_CMP_AVX2
+  cout << "Using AVX2" << endl;
+#elif defined(SNMP_PP_OID_CMP_SSE2)
+  cout << "Using SSE2" << endl;
+#else
+  cout << "Using plain loops" << endl;
+#endif
+
+  // ifTable instances that differ in the last two subidentifiers
+  Oid oids[NUM_OIDS];
+  for (int i = 0; i < NUM_OIDS; ++i)
+  {
+    oids[i] = "1.3.6.1.2.1.2.2.1";
+    oids[i] += (unsigned long)(1 + i % 22);    // column
+    oids[i] += (unsigned long)(1 + i / 22);    // ifIndex
+  }
+  Oid ifEntry("1.3.6.1.2.1.2.2.1");
+  const long ops = iterations * NUM_OIDS;
+  long result;
+  clock_t start;
+
+  result = 0;
+  start = clock();
+  for (long n = 0; n < iterations; ++n)
+    for (int i = 0; i < NUM_OIDS; ++i)
+    {
+      const SmiOID &a = oids[i].get_smival().value.oid;
+      const SmiOID &b = oids[(i + 1) % NUM_OIDS].get_smival().value.oid;
+      result += loop_compare(a.ptr, a.len, b.ptr, b.len);
+    }
+  report("compare (loop)      ", start, ops, result);
+
+  result = 0;
+  start = clock();
+  for (long n = 0; n < iterations; ++n)
+    for (int i = 0; i < NUM_OIDS; ++i)
+      result += oids[i].nCompare(oids[(i + 1) % NUM_OIDS]);
+  report("compare (Oid)       ", start, ops, result);
+
+  result = 0;
+  start = clock();
+  for (long n = 0; n < iterations; ++n)
+    for (int i = 0; i < NUM_OIDS; ++i)
+      result += (oids[i] == oids[(i + 1) % NUM_OIDS]) ? 1 : 0;
+  report("equal (Oid)         ", start, ops, result);
+
+  result = 0;
+  start = clock();
+  for (long n = 0; n < iterations; ++n)
+    for (int i = 0; i < NUM_OIDS; ++i)
+    {
+      const SmiOID &a = oids[i].get_smival().value.oid;
+      const SmiOID &b = oids[(i + 1) % NUM_OIDS].get_smival().value.oid;
+      result += oid_common_prefix(a.ptr, b.ptr, a.len);
+    }
+  report("common prefix       ", start, ops, result);
+
+  result = 0;
+  start = clock();
+  for (long n = 0; n < iterations; ++n)
+    for (int i = 0; i < NUM_OIDS; ++i)
+    {
+      const SmiOID &a = oids[i].get_smival().value.oid;
+      result += oid_prefix_match(ifEntry.get_smival().value.oid.ptr,
+                                 ifEntry.len(), a.ptr, a.len) ? 1 : 0;
+    }
+  report("prefix match        ", start, ops, result);
+
+  // view tree family mask that excludes the column (subidentifier 9)
+  unsigned char mask[2] = { 0xFF, 0xBF };
+  result = 0;
+  start = clock();
+  for (long n = 0; n < iterations; ++n)
+    for (int i = 0; i < NUM_OIDS; ++i)
+    {
+      const SmiOID &a = oids[i].get_smival().value.oid;
+      const SmiOID &b = oids[(i + 1) % NUM_OIDS].get_smival().value.oid;
+      result += oid_masked_match(a.ptr, b.ptr, a.len, mask, 2) ? 1 : 0;
+    }
+  report("masked prefix match ", start, ops, result);
+
+  return 0;
+}
@@ -0,0 +1,138 @@
+/*_############################################################################
+  _##
+  _##  pduViewCheck.cpp
+  _##
+  _##  SNMP++ v3.3
+  _##  -----------------------------------------------
+  _##  Copyright (c) 2001-2013 Jochen Katz, Frank Fock
+  _##
+  _##  This software is based on SNMP++2.6 from Hewlett Packard:
+  _##
+  _##    Copyright (c) 1996
+  _##    Hewlett-Packard Company
+  _##
+  _##  ATTENTION: USE OF THIS SOFTWARE IS SUBJECT TO THE FOLLOWING TERMS.
+  _##  Permission to use, copy, modify, distribute and/or sell this software
+  _##  and/or its documentation is hereby granted without fee. User agrees
+  _##  to display the above copyright notice and this license notice in all
+  _##  copies of the software and any documentation of the software. User
+  _##  agrees to assume all liability for the use of the software;
+  _##  Hewlett-Packard and Jochen Katz make no representations about the
+  _##  suitability of this software for any purpose. It is provided
+  _##  "AS-IS" without warranty of any kind, either express or implied. User
+  _##  hereby grants a royalty-free license to any and all derivatives based
+  _##  upon this software code base.
+  _##
+  _##########################################################################*/
+
+
+
+/*
+  Checks of the message validation of PduView::parse().
+
+  Builds SNMPv2c responses with an object identifier value of
+  ASN_MAX_NAME_LEN and of ASN_MAX_NAME_LEN + 1 subidentifiers. The
+  first one must be accepted and decoded completely, the second one
+  must be rejected as an ASN.1 error, like asn_parse_objid() does.
+
+  Usage: pduViewCheck
+*/
+
+#include <libsnmp.h>
+#include <string>
+
+#include "snmp_pp/snmp_pp.h"
+#include "snmp_pp/pduview.h"
+
+#ifdef SNMP_PP_NAMESPACE
+using namespace Snmp_pp;
+#endif
+
+// Encode type, length and contents (lengths up to 65535)
+static std::string tlv(const unsigned char type, const std::string &data)
+{
+  std::string res(1, (char)type);
+  if (data.size() < 0x80)
+    res += (char)data.size();
+  else if (data.size() < 0x100)
+  {
+    res += (char)0x81;
+    res += (char)data.size();
+  }
+  else
+  {
+    res += (char)0x82;
+    res += (char)(data.size() >> 8);
+    res += (char)(data.size() & 0xff);
+  }
+  return res + data;
+}
+
+// A GET response with one vb: sysObjectID.0 = 1.3.1.1...1 (arcs)
+static std::string response(const int arcs)
+{
+  static const char name[] = { 0x2b, 6, 1, 2, 1, 1, 2, 0 };
+  std::string value(1, (char)0x2b);   // 1.3
+  value.append(arcs - 2, (char)1);
+
+  std::string vb = tlv(ASN_OBJECT_ID, std::string(name, sizeof(name))) +
+                   tlv(ASN_OBJECT_ID, value);
+  std::string pdu = tlv(ASN_INTEGER, std::string(1, (char)42)) +
+                    tlv(ASN_INTEGER, std::string(1, (char)0)) +
+                    tlv(ASN_INTEGER, std::string(1, (char)0)) +
+                    tlv(ASN_SEQ_CON, tlv(ASN_SEQ_CON, vb));
+  std::string msg = tlv(ASN_INTEGER, std::string(1, (char)1)) +
+                    tlv(ASN_OCTET_STR, "public") +
+                    tlv(sNMP_PDU_RESPONSE, pdu);
+  return tlv(ASN_SEQ_CON, msg);
+}
+
+static int check(const int arcs, const int expected_status)
+{
+  std::string msg = response(arcs);
+  PduView view;
+  int status = view.parse((const unsigned char *)msg.data(),
+                          (int)msg.size());
+  int errors = 0;
+
+  if (status != expected_status)
+  {
+    cout << "FAILED: oid value with " << arcs << " arcs: parse() returned "
+         << status << ", expected " << expected_status << endl;
+    errors++;
+  }
+  else if (status == SNMP_CLASS_SUCCESS)
+  {
+    Pdu pdu;
+    Oid value;
+    if ((view.get_pdu(pdu) != SNMP_CLASS_SUCCESS) ||
+        (pdu.get_vb_count() != 1) ||
+        (pdu.get_vb(0).get_value(value) != SNMP_CLASS_SUCCESS) ||
+        ((int)value.len() != arcs))
+    {
+      cout << "FAILED: oid value with " << arcs
+           << " arcs: not decoded completely" << endl;
+      errors++;
+    }
+  }
+  if (!errors)
+    cout << "ok: oid value with " << arcs << " arcs" << endl;
+  return errors;
+}
+
+int main(int, char **)
+{
+#ifndef _NO_LOGGING
+  DefaultLog::log()->set_filter(ERROR_LOG, 0);
+  DefaultLog::log()->set_filter(WARNING_LOG, 0);
+  DefaultLog::log()->set_filter(EVENT_LOG, 0);
+  DefaultLog::log()->set_filter(INFO_LOG, 0);
+  DefaultLog::log()->set_filter(DEBUG_LOG, 0);
+#endif
+
+  int errors = 0;
+  errors += check(ASN_MAX_NAME_LEN, SNMP_CLASS_SUCCESS);
+  errors += check(ASN_MAX_NAME_LEN + 1, SNMP_CLASS_ASN1ERROR);
+
+  return errors ? 1 : 0;
+}
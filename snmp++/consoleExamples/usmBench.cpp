@@ -0,0 +1,333 @@
+/*_############################################################################
+  _##
+  _##  usmBench.cpp
+  _##
+  _##  SNMP++ v3.3
+  _##  -----------------------------------------------
+  _##  Copyright (c) 2001-2013 Jochen Katz, Frank Fock
+  _##
+  _##  This software is based on SNMP++2.6 from Hewlett Packard:
+  _##
+  _##    Copyright (c) 1996
+  _##    Hewlett-Packard Company
+  _##
+  _##  ATTENTION: USE OF THIS SOFTWARE IS SUBJECT TO THE FOLLOWING TERMS.
+  _##  Permission to use, copy, modify, distribute and/or sell this software
+  _##  and/or its documentation is hereby granted without fee. User agrees
+  _##  to display the above copyright notice and this license notice in all
+  _##  copies of the software and any documentation of the software. User
+  _##  agrees to assume all liability for the use of the software;
+  _##  Hewlett-Packard and Jochen Katz make no representations about the
+  _##  suitability of this software for any purpose. It is provided
+  _##  "AS-IS" without warranty of any kind, either express or implied. User
+  _##  hereby grants a royalty-free license to any and all derivatives based
+  _##  upon this software code base.
+  _##
+  _##########################################################################*/
+
+/*
+  Microbenchmark for the per message cost of the USM.
+
+  Processes a GET request for sysUpTime.0 and builds the response,
+  like an agent does for each request: authNoPriv with HMAC-MD5 and
+  with HMAC-SHA, and authPriv with HMAC-SHA and AES-128. The
+  authentication and the encryption of the message alone are measured
+  with the localized key and with the prepared key.
+
+  Then the password to key algorithm is measured: for one password,
+  for a password that is in the key cache and for a batch of users
+  with distinct passwords added by USM::add_usm_users().
+
+  Usage: usmBench [iterations]
+*/
+
+#include <libsnmp.h>
+#include <time.h>
+
+#include "snmp_pp/snmp_pp.h"
+#include "snmp_pp/snmpmsg.h"
+#include "snmp_pp/auth_priv.h"
+
+#ifdef SNMP_PP_NAMESPACE
+using namespace Snmp_pp;
+#endif
+
+#ifndef _SNMPv3
+
+int main(int, char **)
+{
+  cout << "usmBench needs SNMPv3 support" << endl;
+  return 1;
+}
+
+#else
+
+static void report(const char *name, clock_t start, long ops)
+{
+  double ns = (double)(clock() - start) * 1e9 / CLOCKS_PER_SEC / ops;
+  cout << name << ": " << ns << " ns/msg" << endl;
+}
+
+static void bench_priv(AuthPriv *auth_priv, const OctetStr &engine_id,
+                       const long auth_prot, const long priv_prot,
+                       const unsigned char *msg, const int msg_len,
+                       const long iterations)
+{
+  unsigned char key[SNMPv3_USM_MAX_KEY_LEN];
+  unsigned int key_len = SNMPv3_USM_MAX_KEY_LEN;
+  auth_priv->password_to_key_priv(auth_prot, priv_prot,
+                                  (const unsigned char *)"privPassword", 12,
+                                  engine_id.data(), engine_id.len(),
+                                  key, &key_len);
+
+  unsigned char out[MAX_SNMP_PACKET + 16];
+  unsigned int out_len;
+  unsigned char priv_par[8];
+  unsigned int priv_par_len;
+  clock_t start = clock();
+  for (long n = 0; n < iterations; ++n)
+  {
+    out_len = sizeof(out);
+    priv_par_len = sizeof(priv_par);
+    auth_priv->encrypt_msg(priv_prot, key, key_len, msg, msg_len,
+                           out, &out_len, priv_par, &priv_par_len, 1, 42);
+  }
+  report("  message encryption (key)         ", start, iterations);
+
+  unsigned char prepared_key[8192];
+  if ((auth_priv->get_prepared_priv_key_len(priv_prot) > 0) &&
+      (auth_priv->get_prepared_priv_key_len(priv_prot) <=
+       (int)sizeof(prepared_key)) &&
+      (auth_priv->prepare_priv_key(priv_prot, key, key_len, prepared_key) ==
+       SNMPv3_USM_OK))
+  {
+    start = clock();
+    for (long n = 0; n < iterations; ++n)
+    {
+      out_len = sizeof(out);
+      priv_par_len = sizeof(priv_par);
+      auth_priv->encrypt_msg(priv_prot, key, key_len, msg, msg_len,
+                             out, &out_len, priv_par, &priv_par_len, 1, 42,
+                             prepared_key);
+    }
+    report("  message encryption (prepared)    ", start, iterations);
+    auth_priv->clear_prepared_priv_key(priv_prot, prepared_key);
+  }
+}
+
+static void report_keys(const char *name, clock_t start, long keys)
+{
+  double ms = (double)(clock() - start) * 1e3 / CLOCKS_PER_SEC / keys;
+  cout << name << ": " << ms << " ms/key" << endl;
+}
+
+static void bench_keys(USM *usm, const OctetStr &engine_id,
+                       const long auth_prot)
+{
+  AuthPriv *auth_priv = usm->get_auth_priv();
+  Auth *auth = auth_priv->get_auth(auth_prot);
+  unsigned char key[SNMPv3_USM_MAX_KEY_LEN];
+  unsigned int key_len;
+  const int keys = 8;
+
+  clock_t start = clock();
+  for (int n = 0; n < keys; ++n)
+  {
+    key_len = SNMPv3_USM_MAX_KEY_LEN;
+    auth->password_to_key((const unsigned char *)"keyPassword", 11,
+                          engine_id.data(), engine_id.len(),
+                          key, &key_len);
+  }
+  report_keys((auth_prot == SNMP_AUTHPROTOCOL_HMACSHA) ?
+              "password to key (SHA)             " :
+              "password to key (MD5)             ",
+              start, keys);
+
+  start = clock();
+  for (int n = 0; n < 1000; ++n)
+  {
+    key_len = SNMPv3_USM_MAX_KEY_LEN;
+    auth_priv->password_to_key_auth(auth_prot,
+                                    (const unsigned char *)"keyPassword", 11,
+                                    engine_id.data(), engine_id.len(),
+                                    key, &key_len);
+  }
+  report_keys("  cached password                  ", start, 1000);
+
+  const int users = 64;
+  UsmUserBatchEntry *batch = new UsmUserBatchEntry[users];
+  for (int n = 0; n < users; ++n)
+  {
+    char name[32];
+    sprintf(name, "batchUser%d", n);
+    batch[n].engineID = engine_id;
+    batch[n].usmUserName = name;
+    batch[n].securityName = name;
+    batch[n].authProtocol = auth_prot;
+    batch[n].privProtocol = SNMP_PRIVPROTOCOL_NONE;
+    batch[n].authPassword = name;
+  }
+  start = clock();
+  usm->add_usm_users(batch, users);
+  report_keys("  add_usm_users, distinct passwords", start, users);
+  for (int n = 0; n < users; ++n)
+    usm->delete_localized_user(batch[n].usmUserName);
+  delete [] batch;
+}
+
+static void bench(Snmp &snmp, const OctetStr &engine_id,
+                  const OctetStr &user, const long auth_prot,
+                  const long priv_prot, const long iterations)
+{
+  USM *usm = v3MP::I->get_usm();
+  int status;
+
+  // the request as sent by a manager
+  Pdu request;
+  request += Vb(Oid("1.3.6.1.2.1.1.3.0"));
+  request.set_type(sNMP_PDU_GET);
+  request.set_request_id(4711);
+  request.set_security_level((priv_prot == SNMP_PRIVPROTOCOL_NONE) ?
+                             SNMP_SECURITY_LEVEL_AUTH_NOPRIV :
+                             SNMP_SECURITY_LEVEL_AUTH_PRIV);
+  request.set_context_engine_id(engine_id);
+
+  SnmpMessage request_msg;
+  status = request_msg.loadv3(request, engine_id, user,
+                              SNMP_SECURITY_MODEL_USM, version3);
+  if (status != SNMP_CLASS_SUCCESS)
+  {
+    cout << "Could not build request: " << status << endl;
+    return;
+  }
+
+  UdpAddress from("127.0.0.1/161");
+  clock_t start = clock();
+
+  for (long n = 0; n < iterations; ++n)
+  {
+    // process the request...
+    SnmpMessage msg;
+    msg.load(request_msg.data(), request_msg.len());
+
+    Pdu pdu;
+    snmp_version version;
+    OctetStr security_engine_id, security_name;
+    long int security_model;
+    status = msg.unloadv3(pdu, version, security_engine_id, security_name,
+                          security_model, from, snmp);
+    if (status != SNMP_CLASS_SUCCESS)
+    {
+      cout << "Could not process request: " << status << endl;
+      return;
+    }
+
+    // ...and build the response
+    pdu[0].set_value(TimeTicks(4242));
+    pdu.set_type(sNMP_PDU_RESPONSE);
+
+    SnmpMessage response_msg;
+    status = response_msg.loadv3(pdu, security_engine_id, security_name,
+                                 (int)security_model, version);
+    if (status != SNMP_CLASS_SUCCESS)
+    {
+      cout << "Could not build response: " << status << endl;
+      return;
+    }
+  }
+  if (priv_prot != SNMP_PRIVPROTOCOL_NONE)
+    report("GET request + response (SHA, AES) ", start, iterations);
+  else
+    report((auth_prot == SNMP_AUTHPROTOCOL_HMACSHA) ?
+           "GET request + response (SHA)      " :
+           "GET request + response (MD5)      ",
+           start, iterations);
+
+  unsigned char msg[MAX_SNMP_PACKET];
+  int msg_len = (int)request_msg.len();
+  memcpy(msg, request_msg.data(), msg_len);
+
+  // authentication of the request only
+  AuthPriv *auth_priv = usm->get_auth_priv();
+  unsigned char key[SNMPv3_USM_MAX_KEY_LEN];
+  unsigned int key_len = SNMPv3_USM_MAX_KEY_LEN;
+  auth_priv->password_to_key_auth(auth_prot,
+                                  (const unsigned char *)"authPassword", 12,
+                                  engine_id.data(), engine_id.len(),
+                                  key, &key_len);
+
+  unsigned char auth_par[12];
+  start = clock();
+  for (long n = 0; n < iterations; ++n)
+    auth_priv->auth_out_msg(auth_prot, key, msg, msg_len, auth_par);
+  report("  message authentication (key)     ", start, iterations);
+
+  unsigned char prepared_key[512];
+  if ((auth_priv->get_prepared_key_len(auth_prot) <=
+       (int)sizeof(prepared_key)) &&
+      (auth_priv->prepare_key(auth_prot, key, key_len, prepared_key) ==
+       SNMPv3_USM_OK))
+  {
+    start = clock();
+    for (long n = 0; n < iterations; ++n)
+      auth_priv->auth_out_msg(auth_prot, key, msg, msg_len, auth_par,
+                              prepared_key);
+    report("  message authentication (prepared)", start, iterations);
+  }
+
+  if (priv_prot != SNMP_PRIVPROTOCOL_NONE)
+    bench_priv(auth_priv, engine_id, auth_prot, priv_prot,
+               msg, msg_len, iterations);
+  cout << "  (request " << msg_len << " bytes)" << endl;
+}
+
+int main(int argc, char **argv)
+{
+  long iterations = 200000;
+  if (argc > 1) iterations = atol(argv[1]);
+  if (iterations <= 0) iterations = 1;
+
+#ifndef _NO_LOGGING
+  DefaultLog::log()->set_filter(ERROR_LOG, 0);
+  DefaultLog::log()->set_filter(WARNING_LOG, 0);
+  DefaultLog::log()->set_filter(EVENT_LOG, 0);
+  DefaultLog::log()->set_filter(INFO_LOG, 0);
+  DefaultLog::log()->set_filter(DEBUG_LOG, 0);
+#endif
+
+  int status;
+  OctetStr engine_id("usmBench_engine");
+  v3MP mp(engine_id, 1, status);
+  if (status != SNMPv3_MP_OK)
+  {
+    cout << "Could not create v3MP: " << status << endl;
+    return 1;
+  }
+  Snmp snmp(status);  // needed to send reports only
+  if (status != SNMP_CLASS_SUCCESS)
+  {
+    cout << "Could not create session: " << snmp.error_msg(status) << endl;
+    return 1;
+  }
+  USM *usm = mp.get_usm();
+  usm->add_usm_user("MD5", SNMP_AUTHPROTOCOL_HMACMD5, SNMP_PRIVPROTOCOL_NONE,
+                    "authPassword", "");
+  usm->add_usm_user("SHA", SNMP_AUTHPROTOCOL_HMACSHA, SNMP_PRIVPROTOCOL_NONE,
+                    "authPassword", "");
+  usm->add_usm_user("AES", SNMP_AUTHPROTOCOL_HMACSHA,
+                    SNMP_PRIVPROTOCOL_AES128, "authPassword", "privPassword");
+
+  bench(snmp, engine_id, "MD5", SNMP_AUTHPROTOCOL_HMACMD5,
+        SNMP_PRIVPROTOCOL_NONE, iterations);
+  bench(snmp, engine_id, "SHA", SNMP_AUTHPROTOCOL_HMACSHA,
+        SNMP_PRIVPROTOCOL_NONE, iterations);
+  bench(snmp, engine_id, "AES", SNMP_AUTHPROTOCOL_HMACSHA,
+        SNMP_PRIVPROTOCOL_AES128, iterations);
+
+  bench_keys(usm, engine_id, SNMP_AUTHPROTOCOL_HMACMD5);
+  bench_keys(usm, engine_id, SNMP_AUTHPROTOCOL_HMACSHA);
+
+  return 0;
+}
+
+#endif // _SNMPv3
@@ -0,0 +1,133 @@
+/*_############################################################################
+  _##
+  _##  walkBench.cpp
+  _##
+  _##  SNMP++ v3.3
+  _##  -----------------------------------------------
+  _##  Copyright (c) 2001-2013 Jochen Katz, Frank Fock
+  _##
+  _##  This software is based on SNMP++2.6 from Hewlett Packard:
+  _##
+  _##    Copyright (c) 1996
+  _##    Hewlett-Packard Company
+  _##
+  _##  ATTENTION: USE OF THIS SOFTWARE IS SUBJECT TO THE FOLLOWING TERMS.
+  _##  Permission to use, copy, modify, distribute and/or sell this software
+  _##  and/or its documentation is hereby granted without fee. User agrees
+  _##  to display the above copyright notice and this license notice in all
+  _##  copies of the software and any documentation of the software. User
+  _##  agrees to assume all liability for the use of the software;
+  _##  Hewlett-Packard and Jochen Katz make no representations about the
+  _##  suitability of this software for any purpose. It is provided
+  _##  "AS-IS" without warranty of any kind, either express or implied. User
+  _##  hereby grants a royalty-free license to any and all derivatives based
+  _##  upon this software code base.
+  _##
+  _##########################################################################*/
+
+
+/*
+  Benchmark for the allocations of a GETNEXT walk.
+
+  Walks the ifDescr column of a table with the given number of rows. For each step
+  the manager sets the last oid into its request, the agent copies
+  the request into its response and sets the next row into it as a
+  temporary Vb, and the manager reads the vb of the response. Heap
+  allocations are counted through the global operator new.
+
+  Usage: walkBench [rows]
+*/
+
+#include <libsnmp.h>
+#include <time.h>
+#include <new>
+
+#include "snmp_pp/snmp_pp.h"
+
+#ifdef SNMP_PP_NAMESPACE
+using namespace Snmp_pp;
+#endif
+
+static unsigned long allocations = 0;
+
+void *operator new(size_t size)
+{
+  ++allocations;
+  void *p = malloc(size ? size : 1);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+}
+
+void *operator new[](size_t size)
+{
+  ++allocations;
+  void *p = malloc(size ? size : 1);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void *p) throw() { free(p); }
+void operator delete[](void *p) throw() { free(p); }
+#if __cplusplus >= 201402L
+void operator delete(void *p, size_t) throw() { free(p); }
+void operator delete[](void *p, size_t) throw() { free(p); }
+#endif
+
+// the agent: the response for row i of the table
+static Vb next_row(const Oid &column, const OctetStr &descr, unsigned long i)
+{
+  Oid oid(column);
+  oid += i + 1;
+  Vb vb(oid);
+  vb.set_value(descr);
+  return vb;
+}
+
+int main(int argc, char **argv)
+{
+  long count = 100000;
+  if (argc > 1) count = atol(argv[1]);
+  if (count <= 0) count = 1;
+
+#ifdef SNMP_PP_RVALUE_REFS
+  cout << "Using move semantics" << endl;
+#else
+  cout << "Using copies (no rvalue references)" << endl;
+#endif
+
+  OctetStr descr("GigabitEthernet0/1 - uplink to the distribution switch");
+
+  Oid column("1.3.6.1.2.1.2.2.1.2");
+  Oid last(column);
+  Pdu request;
+  Pdu response;
+  Vb vb;
+  request.set_type(sNMP_PDU_GETNEXT);
+  request += Vb(last);
+
+  allocations = 0;
+  clock_t start = clock();
+  for (long i = 0; i < count; ++i)
+  {
+    // manager: request the successor of the last oid
+    request.set_vb(Vb(last), 0);
+
+    // agent: answer with the next row
+    response = request;
+    response.set_type(sNMP_PDU_RESPONSE);
+    response.set_vb(next_row(column, descr, i), 0);
+
+    // manager: take the result
+    response.get_vb(vb, 0);
+    vb.get_oid(last);
+  }
+  double ns = (double)(clock() - start) * 1e9 / CLOCKS_PER_SEC / count;
+
+  cout << "last oid: " << last.get_printable() << endl;
+  cout << "allocations per step: " << (double)allocations / count << endl;
+  cout << "time per step: " << ns << " ns" << endl;
+
+  return 0;
+}
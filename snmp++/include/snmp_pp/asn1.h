@@ -322,6 +322,73 @@ DLLOPT int snmp_parse_vb(struct snmp_pdu *pdu,
 
 DLLOPT void clear_pdu(struct snmp_pdu *pdu, bool clear_all = false);
 
+//-----[ direct encoding of Vb and Pdu objects ]-----------------------
+
+class Vb;
+class Pdu;
+
+/**
+ * Get the length of the encoded variable binding.
+ *
+ * @param vb         - The variable binding
+ * @param null_value - Encode a NULL value instead of the value of the vb
+ *
+ * @return - The length or -1 if the value cannot be encoded
+ */
+DLLOPT int asn1_vb_length(const Vb &vb, const bool null_value);
+
+/**
+ * Encode a variable binding directly into the buffer.
+ *
+ * @param data       - The buffer
+ * @param datalength - IN: length of the buffer,
+ *                     OUT: free bytes left in the buffer
+ * @param vb         - The variable binding
+ * @param null_value - Encode a NULL value instead of the value of the vb
+ *
+ * @return - Pointer to the first free byte in the buffer or
+ *           NULL if an error occured
+ */
+DLLOPT unsigned char *asn1_build_vb(unsigned char *data, int *datalength,
+                                    const Vb &vb, const bool null_value);
+
+/**
+ * Get the length of the encoded data pdu (see asn1_build_data_pdu()).
+ *
+ * @return - The length or -1 if the pdu cannot be encoded
+ */
+DLLOPT int asn1_data_pdu_length(const Pdu &pdu);
+
+/**
+ * Encode the pdu (header and variable bindings) directly into the
+ * buffer, without building a struct snmp_pdu first. The variable
+ * bindings of GET, GETNEXT and GETBULK requests are encoded with NULL
+ * values. SNMPv1 traps are not supported.
+ *
+ * @param data       - The buffer
+ * @param datalength - IN: length of the buffer,
+ *                     OUT: free bytes left in the buffer
+ * @param pdu        - The pdu
+ *
+ * @return - Pointer to the first free byte in the buffer or
+ *           NULL if an error occured
+ */
+DLLOPT unsigned char *asn1_build_data_pdu(unsigned char *data,
+                                          int *datalength, const Pdu &pdu);
+
+/**
+ * Encode a SNMPv1 or SNMPv2c message directly from the pdu
+ * (see asn1_build_data_pdu()).
+ *
+ * @return - 0 on success, -1 if the buffer is too small or the pdu
+ *           cannot be encoded
+ */
+DLLOPT int snmp_build(const Pdu &pdu,
+                      unsigned char *packet,
+                      int *out_length,
+                      const long version,
+                      const unsigned char* community, const int community_len);
+
 /**
  * Encode the given values for the HeaderData into the buffer.
  *                                                                  <pre>
@@ -436,6 +503,24 @@ DLLOPT unsigned char *asn1_build_scoped_pdu(
                unsigned char *contextName, long contextNameLength,
                unsigned char *data, long dataLength);
 
+/**
+ * Encode the scopedPDU directly from the pdu (see asn1_build_data_pdu()).
+ *
+ * param outBuf            - The buffer
+ * param max_len           - IN: length of the buffer
+ *                           OUT: free bytes left in the buffer
+ * param contextEngineID   - The contextEngineID
+ * param contextName       - The contextName
+ * param pdu               - The pdu
+ *
+ * @return - Pointer to the first free byte in the buffer or
+ *           NULL if an error occured
+ */
+DLLOPT unsigned char *asn1_build_scoped_pdu(
+               unsigned char *outBuf, int *max_len,
+               const OctetStr &contextEngineID, const OctetStr &contextName,
+               const Pdu &pdu);
+
 
 #ifdef SNMP_PP_NAMESPACE
 } // end of namespace Snmp_pp
@@ -34,6 +34,11 @@
 #ifdef _SNMPv3
 
 #include "snmp_pp/usm_v3.h"
+#include "snmp_pp/reentrant.h"
+
+#ifdef _USE_OPENSSL
+struct evp_cipher_st;  // EVP_CIPHER of OpenSSL
+#endif
 
 #ifdef SNMP_PP_NAMESPACE
 namespace Snmp_pp {
@@ -41,6 +46,9 @@ namespace Snmp_pp {
 
 #define SNMPv3_USM_MAX_KEY_LEN        32
 
+/* Default number of keys Ku cached by AuthPriv */
+#define SNMPv3_AP_KU_CACHE_SIZE       16
+
 /* Accept Messages with auth/priv param fields up to this length */
 #define SNMPv3_AP_MAXLENGTH_AUTHPARAM      128
 #define SNMPv3_AP_MAXLENGTH_PRIVPARAM      128
@@ -85,6 +93,67 @@ public:
                               unsigned char       *key,
                               unsigned int        *key_len) = 0;
 
+  /**
+   * Generate the key Ku for the given password.
+   *
+   * Ku is the key of the password to key algorithm before it is
+   * localized with the engine id (see RFC 3414, section 2.6).
+   *
+   * @param password      - the password
+   * @param password_len  - the length of the password
+   * @param ku            - buffer of get_hash_len() bytes for the key
+   * @param ku_len        - OUT: length of the key
+   *
+   * @return SNMPv3_USM_OK on success and
+   *         SNMPv3_USM_ERROR if not supported.
+   */
+  virtual int password_to_ku(const unsigned char * /*password*/,
+                             const unsigned int    /*password_len*/,
+                             unsigned char       * /*ku*/,
+                             unsigned int        * /*ku_len*/)
+    { return SNMPv3_USM_ERROR; };
+
+  /**
+   * Generate the keys Ku for many passwords.
+   *
+   * The default implementation calls password_to_ku() for each
+   * password. Protocols may override it to compute several keys at
+   * once.
+   *
+   * @param count         - number of passwords
+   * @param passwords     - the passwords
+   * @param password_lens - the lengths of the passwords
+   * @param kus           - buffer of count * get_hash_len() bytes
+   *
+   * @return SNMPv3_USM_OK on success
+   */
+  virtual int passwords_to_ku(const int                   count,
+                              const unsigned char * const *passwords,
+                              const unsigned int         *password_lens,
+                              unsigned char              *kus);
+
+  /**
+   * Localize the key Ku with the engine id.
+   *
+   * @param ku            - the key generated by password_to_ku()
+   * @param ku_len        - the length of the key
+   * @param engine_id     - pointer to snmpEngineID
+   * @param engine_id_len - length of snmpEngineID
+   * @param key           - buffer for the localized key
+   * @param key_len       - IN: length of the buffer
+   *                        OUT: length of the key
+   *
+   * @return SNMPv3_USM_OK on success and
+   *         SNMPv3_USM_ERROR if not supported.
+   */
+  virtual int localize_key(const unsigned char * /*ku*/,
+                           const unsigned int    /*ku_len*/,
+                           const unsigned char * /*engine_id*/,
+                           const unsigned int    /*engine_id_len*/,
+                           unsigned char       * /*key*/,
+                           unsigned int        * /*key_len*/)
+    { return SNMPv3_USM_ERROR; };
+
   /**
    * Generate a hash value for the given data.
    *
@@ -149,6 +218,55 @@ public:
                            unsigned char       *auth_par_ptr,
                            const int            auth_par_len) = 0;
 
+  /**
+   * Get the size of the buffer needed for a prepared key.
+   *
+   * @return 0 if the protocol does not support prepared keys
+   */
+  virtual int get_prepared_key_len() const { return 0; };
+
+  /**
+   * Prepare a localized key for authentication.
+   *
+   * For HMAC based protocols the prepared key holds the hash states
+   * after the inner and outer pad blocks, so these blocks need not be
+   * hashed again for each message.
+   *
+   * @param key          - pointer to the (fixed length) key
+   * @param key_len      - length of the key
+   * @param prepared_key - buffer of get_prepared_key_len() bytes
+   *
+   * @return SNMPv3_USM_OK on success and
+   *         SNMPv3_USM_ERROR if not supported or the key is too short.
+   */
+  virtual int prepare_key(const unsigned char * /*key*/,
+                          const unsigned int    /*key_len*/,
+                          unsigned char       * /*prepared_key*/) const
+    { return SNMPv3_USM_ERROR; };
+
+  /**
+   * Authenticate an outgoing message with a prepared key.
+   *
+   * @see auth_out_msg(), prepare_key()
+   */
+  virtual int auth_out_msg_prepared(const unsigned char * /*prepared_key*/,
+                                    unsigned char       * /*msg*/,
+                                    const int             /*msg_len*/,
+                                    unsigned char       * /*auth_par_ptr*/)
+    { return SNMPv3_USM_ERROR; };
+
+  /**
+   * Authenticate an incoming message with a prepared key.
+   *
+   * @see auth_inc_msg(), prepare_key()
+   */
+  virtual int auth_inc_msg_prepared(const unsigned char * /*prepared_key*/,
+                                    unsigned char       * /*msg*/,
+                                    const int             /*msg_len*/,
+                                    unsigned char       * /*auth_par_ptr*/,
+                                    const int             /*auth_par_len*/)
+    { return SNMPv3_USM_ERROR; };
+
   /**
    * Get the unique id of the authentication protocol.
    */
@@ -258,6 +376,78 @@ public:
 		      const unsigned long  engine_boots,
 		      const unsigned long  engine_time) = 0;
 
+  /**
+   * Get the size of the buffer needed for a prepared key.
+   *
+   * @return 0 if the protocol does not support prepared keys
+   */
+  virtual int get_prepared_key_len() const { return 0; };
+
+  /**
+   * Prepare a localized key for encryption and decryption.
+   *
+   * The prepared key holds the expanded key schedule of the cipher,
+   * so the key setup need not be done again for each message.
+   *
+   * @param key          - pointer to the (fixed length) key
+   * @param key_len      - length of the key
+   * @param prepared_key - buffer of get_prepared_key_len() bytes
+   *
+   * @return SNMPv3_USM_OK on success and
+   *         SNMPv3_USM_ERROR if not supported or the key is too short.
+   */
+  virtual int prepare_key(const unsigned char * /*key*/,
+                          const unsigned int    /*key_len*/,
+                          unsigned char       * /*prepared_key*/) const
+    { return SNMPv3_USM_ERROR; };
+
+  /**
+   * Copy a prepared key into a buffer of get_prepared_key_len() bytes.
+   *
+   * The copy must be released through clear_prepared_key().
+   *
+   * @return SNMPv3_USM_OK on success, SNMPv3_USM_ERROR otherwise.
+   */
+  virtual int copy_prepared_key(const unsigned char *src,
+                                unsigned char       *dst) const;
+
+  /**
+   * Release the resources held by a prepared key and clear it.
+   */
+  virtual void clear_prepared_key(unsigned char *prepared_key) const;
+
+  /**
+   * Encrypt the buffer with a prepared key.
+   *
+   * @see encrypt(), prepare_key()
+   */
+  virtual int encrypt_prepared(const unsigned char * /*prepared_key*/,
+                               const unsigned char * /*buffer*/,
+                               const unsigned int    /*buffer_len*/,
+                               unsigned char       * /*out_buffer*/,
+                               unsigned int        * /*out_buffer_len*/,
+                               unsigned char       * /*privacy_params*/,
+                               unsigned int        * /*privacy_params_len*/,
+                               const unsigned long   /*engine_boots*/,
+                               const unsigned long   /*engine_time*/)
+    { return SNMPv3_USM_ERROR; };
+
+  /**
+   * Decrypt the buffer with a prepared key.
+   *
+   * @see decrypt(), prepare_key()
+   */
+  virtual int decrypt_prepared(const unsigned char * /*prepared_key*/,
+                               const unsigned char * /*buffer*/,
+                               const unsigned int    /*buffer_len*/,
+                               unsigned char       * /*out_buffer*/,
+                               unsigned int        * /*out_buffer_len*/,
+                               const unsigned char * /*privacy_params*/,
+                               const unsigned int    /*privacy_params_len*/,
+                               const unsigned long   /*engine_boots*/,
+                               const unsigned long   /*engine_time*/)
+    { return SNMPv3_USM_ERROR; };
+
   /**
    * Extend a localized key that is too short.
    *
@@ -428,6 +618,84 @@ public:
                            unsigned char *key,
                            unsigned int  *key_len);
 
+  /**
+   * Generate the key Ku of a password, see Auth::password_to_ku().
+   *
+   * The keys of the last used passwords are cached, so a password
+   * that is localized for many engine ids is expanded only once.
+   */
+  int password_to_ku(const int            auth_prot,
+                     const unsigned char *password,
+                     const unsigned int   password_len,
+                     unsigned char       *ku,
+                     unsigned int        *ku_len);
+
+  /**
+   * Generate the keys Ku of many passwords, see Auth::passwords_to_ku().
+   *
+   * The passwords are split among worker threads. The keys are not
+   * added to the cache of password_to_ku().
+   *
+   * @param kus     - buffer of count * SNMPv3_USM_MAX_KEY_LEN bytes,
+   *                  the key of password i starts at offset
+   *                  i * SNMPv3_USM_MAX_KEY_LEN
+   * @param ku_len  - OUT: length of each key
+   * @param threads - Number of threads to use, 0 or 1 to compute all
+   *                  keys in the calling thread
+   */
+  int passwords_to_ku(const int                   auth_prot,
+                      const int                   count,
+                      const unsigned char * const *passwords,
+                      const unsigned int         *password_lens,
+                      unsigned char              *kus,
+                      unsigned int               *ku_len,
+                      const int                   threads = 1);
+
+  /**
+   * Localize the key Ku for authentication, see Auth::localize_key().
+   */
+  int localize_key_auth(const int            auth_prot,
+                        const unsigned char *ku,
+                        const unsigned int   ku_len,
+                        const unsigned char *engine_id,
+                        const unsigned int   engine_id_len,
+                        unsigned char       *key,
+                        unsigned int        *key_len);
+
+  /**
+   * Localize the key Ku for privacy and extend it to the length
+   * needed by the privacy protocol like password_to_key_priv().
+   *
+   * @param ku       - The key Ku of the privacy password, generated
+   *                   by the auth protocol
+   * @param password - The privacy password, passed to
+   *                   Priv::extend_short_key()
+   */
+  int localize_key_priv(const int            auth_prot,
+                        const int            priv_prot,
+                        const unsigned char *ku,
+                        const unsigned int   ku_len,
+                        const unsigned char *password,
+                        const unsigned int   password_len,
+                        const unsigned char *engine_id,
+                        const unsigned int   engine_id_len,
+                        unsigned char       *key,
+                        unsigned int        *key_len);
+
+  /**
+   * Set the number of keys Ku cached by password_to_ku().
+   *
+   * @param size - The new size, 0 disables the cache
+   *
+   * @return SNMPv3_USM_OK or SNMPv3_USM_ERROR (out of memory)
+   */
+  int set_ku_cache_size(const int size);
+
+  /**
+   * Remove all keys from the cache of password_to_ku().
+   */
+  void clear_ku_cache();
+
   /**
    * Get the keyChange value for the specified keys using the given
    * authentication protocol.
@@ -467,6 +735,9 @@ public:
 
   /**
    * Encrypt a message.
+   *
+   * @param prepared_key - The result of prepare_priv_key() for the key
+   *                       or NULL to use the key
    */
   int encrypt_msg(const int            priv_prot,
                   const unsigned char *key,
@@ -478,10 +749,14 @@ public:
                   unsigned char       *privacy_params,
                   unsigned int        *privacy_params_len,
                   const unsigned long  engine_boots,
-                  const unsigned long  engine_time);
+                  const unsigned long  engine_time,
+                  const unsigned char *prepared_key = 0);
 
   /**
    * Decrypt a message.
+   *
+   * @param prepared_key - The result of prepare_priv_key() for the key
+   *                       or NULL to use the key
    */
   int decrypt_msg(const int            priv_prot,
                   const unsigned char *key,
@@ -493,7 +768,8 @@ public:
                   const unsigned char *privacy_params,
                   const unsigned int   privacy_params_len,
 		  const unsigned long  engine_boots,
-		  const unsigned long  engine_time);
+		  const unsigned long  engine_time,
+                  const unsigned char *prepared_key = 0);
 
   /**
    * Get the length of the authentication parameters field of the given
@@ -507,32 +783,117 @@ public:
    */
   int get_priv_params_len(const int priv_prot);
 
+  /**
+   * Get the size of a prepared key of the given authentication
+   * protocol or 0 if the protocol does not support prepared keys.
+   */
+  int get_prepared_key_len(const int auth_prot);
+
+  /**
+   * Prepare a localized key for authentication.
+   *
+   * @see Auth::prepare_key()
+   */
+  int prepare_key(const int            auth_prot,
+                  const unsigned char *key,
+                  const unsigned int   key_len,
+                  unsigned char       *prepared_key);
+
+  /**
+   * Get the size of a prepared key of the given privacy protocol
+   * or 0 if the protocol does not support prepared keys.
+   */
+  int get_prepared_priv_key_len(const int priv_prot);
+
+  /**
+   * Prepare a localized key for encryption and decryption.
+   *
+   * @see Priv::prepare_key()
+   */
+  int prepare_priv_key(const int            priv_prot,
+                       const unsigned char *key,
+                       const unsigned int   key_len,
+                       unsigned char       *prepared_key);
+
+  /**
+   * Copy a prepared key of the given privacy protocol.
+   *
+   * @see Priv::copy_prepared_key()
+   */
+  int copy_prepared_priv_key(const int            priv_prot,
+                             const unsigned char *src,
+                             unsigned char       *dst);
+
+  /**
+   * Release a prepared key of the given privacy protocol.
+   *
+   * @see Priv::clear_prepared_key()
+   */
+  void clear_prepared_priv_key(const int      priv_prot,
+                               unsigned char *prepared_key);
+
   /**
    * Fill in the authentication field of an outgoing message
+   *
+   * @param prepared_key - The result of prepare_key() for the key or
+   *                       NULL to use the key
    */
   int auth_out_msg(const int            auth_prot,
                    const unsigned char *key,
                    unsigned char       *msg,
                    const int            msg_len,
-                   unsigned char       *auth_par_ptr);
+                   unsigned char       *auth_par_ptr,
+                   const unsigned char *prepared_key = 0);
 
   /**
    * Check the authentication field of an incoming message
+   *
+   * @param prepared_key - The result of prepare_key() for the key or
+   *                       NULL to use the key
    */
   int auth_inc_msg(const int            auth_prot,
                    const unsigned char *key,
                    unsigned char       *msg,
                    const int            msg_len,
                    unsigned char       *auth_par_ptr,
-                   const int            auth_par_len);
+                   const int            auth_par_len,
+                   const unsigned char *prepared_key = 0);
 
 private:
 
+  /**
+   * Extend a short localized privacy key and fix its length.
+   */
+  int extend_priv_key(Priv                *p,
+                      Auth                *a,
+                      const unsigned char *password,
+                      const unsigned int   password_len,
+                      const unsigned char *engine_id,
+                      const unsigned int   engine_id_len,
+                      unsigned char       *key,
+                      unsigned int        *key_len,
+                      const unsigned int   max_key_len);
+
   AuthPtr *auth;   ///< Array of pointers to Auth-objects
   PrivPtr *priv;   ///< Array of pointers to Priv-objects
   int   auth_size; ///< current size of the auth array
   int   priv_size; ///< current size of the priv array
   pp_uint64 salt;  ///< current salt value (64 bits)
+
+  struct KuCacheEntry
+  {
+    int           auth_prot;
+    unsigned int  password_len;
+    unsigned char password_hash[SNMPv3_USM_MAX_KEY_LEN];
+    unsigned char ku[SNMPv3_USM_MAX_KEY_LEN];
+    unsigned int  ku_len;
+  };
+
+  KuCacheEntry     *ku_cache;       ///< cache of password_to_ku()
+  int               ku_cache_size;  ///< number of entries in ku_cache
+  int               ku_cache_used;  ///< number of valid entries
+  int               ku_cache_next;  ///< next entry to replace
+  SnmpSynchronized  ku_cache_lock;
 };
 
 
@@ -551,6 +912,23 @@ public:
 		      unsigned char       *key,
 		      unsigned int        *key_len);
 
+  int password_to_ku(const unsigned char *password,
+                     const unsigned int   password_len,
+                     unsigned char       *ku,
+                     unsigned int        *ku_len);
+
+  int passwords_to_ku(const int                   count,
+                      const unsigned char * const *passwords,
+                      const unsigned int         *password_lens,
+                      unsigned char              *kus);
+
+  int localize_key(const unsigned char *ku,
+                   const unsigned int   ku_len,
+                   const unsigned char *engine_id,
+                   const unsigned int   engine_id_len,
+                   unsigned char       *key,
+                   unsigned int        *key_len);
+
   int hash(const unsigned char *data,
 	   const unsigned int   data_len,
 	   unsigned char       *digest) const;
@@ -566,6 +944,23 @@ public:
 		   unsigned char       *auth_par_ptr,
                    const int            auth_par_len);
 
+  int get_prepared_key_len() const;
+
+  int prepare_key(const unsigned char *key,
+                  const unsigned int   key_len,
+                  unsigned char       *prepared_key) const;
+
+  int auth_out_msg_prepared(const unsigned char *prepared_key,
+                            unsigned char       *msg,
+                            const int            msg_len,
+                            unsigned char       *auth_par_ptr);
+
+  int auth_inc_msg_prepared(const unsigned char *prepared_key,
+                            unsigned char       *msg,
+                            const int            msg_len,
+                            unsigned char       *auth_par_ptr,
+                            const int            auth_par_len);
+
   int get_id() const { return SNMP_AUTHPROTOCOL_HMACSHA; };
 
   const char *get_id_string() const { return "HMAC-SHA"; };
@@ -590,6 +985,23 @@ public:
 		      unsigned char       *key,
 		      unsigned int        *key_len);
 
+  int password_to_ku(const unsigned char *password,
+                     const unsigned int   password_len,
+                     unsigned char       *ku,
+                     unsigned int        *ku_len);
+
+  int passwords_to_ku(const int                   count,
+                      const unsigned char * const *passwords,
+                      const unsigned int         *password_lens,
+                      unsigned char              *kus);
+
+  int localize_key(const unsigned char *ku,
+                   const unsigned int   ku_len,
+                   const unsigned char *engine_id,
+                   const unsigned int   engine_id_len,
+                   unsigned char       *key,
+                   unsigned int        *key_len);
+
   int hash(const unsigned char *data,
 	   const unsigned int   data_len,
 	   unsigned char       *digest) const;
@@ -606,6 +1018,23 @@ public:
 		   unsigned char       *auth_par_ptr,
                    const int            auth_par_len);
 
+  int get_prepared_key_len() const;
+
+  int prepare_key(const unsigned char *key,
+                  const unsigned int   key_len,
+                  unsigned char       *prepared_key) const;
+
+  int auth_out_msg_prepared(const unsigned char *prepared_key,
+                            unsigned char       *msg,
+                            const int            msg_len,
+                            unsigned char       *auth_par_ptr);
+
+  int auth_inc_msg_prepared(const unsigned char *prepared_key,
+                            unsigned char       *msg,
+                            const int            msg_len,
+                            unsigned char       *auth_par_ptr,
+                            const int            auth_par_len);
+
   int get_id() const { return SNMP_AUTHPROTOCOL_HMACMD5; };
 
   const char *get_id_string() const { return "HMAC-MD5"; };
@@ -651,6 +1080,32 @@ class DLLOPT PrivDES: public Priv
 	      const unsigned long  engine_boots,
 	      const unsigned long  engine_time);
 
+  int get_prepared_key_len() const;
+
+  int prepare_key(const unsigned char *key,
+                  const unsigned int   key_len,
+                  unsigned char       *prepared_key) const;
+
+  int encrypt_prepared(const unsigned char *prepared_key,
+                       const unsigned char *buffer,
+                       const unsigned int   buffer_len,
+                       unsigned char       *out_buffer,
+                       unsigned int        *out_buffer_len,
+                       unsigned char       *privacy_params,
+                       unsigned int        *privacy_params_len,
+                       const unsigned long  engine_boots,
+                       const unsigned long  engine_time);
+
+  int decrypt_prepared(const unsigned char *prepared_key,
+                       const unsigned char *buffer,
+                       const unsigned int   buffer_len,
+                       unsigned char       *out_buffer,
+                       unsigned int        *out_buffer_len,
+                       const unsigned char *privacy_params,
+                       const unsigned int   privacy_params_len,
+                       const unsigned long  engine_boots,
+                       const unsigned long  engine_time);
+
   int extend_short_key(const unsigned char *password,
                        const unsigned int   password_len,
                        const unsigned char *engine_id,
@@ -744,6 +1199,9 @@ class DLLOPT PrivAES: public Priv
 public:
 
   PrivAES(const int aes_type_);
+#ifdef _USE_OPENSSL
+  ~PrivAES();
+#endif
 
   int encrypt(const unsigned char *key,
               const unsigned int   key_len,
@@ -767,6 +1225,39 @@ public:
 	      const unsigned long  engine_boots,
 	      const unsigned long  engine_time);
 
+  int get_prepared_key_len() const;
+
+  int prepare_key(const unsigned char *key,
+                  const unsigned int   key_len,
+                  unsigned char       *prepared_key) const;
+
+#ifdef _USE_OPENSSL
+  int copy_prepared_key(const unsigned char *src,
+                        unsigned char       *dst) const;
+
+  void clear_prepared_key(unsigned char *prepared_key) const;
+#endif
+
+  int encrypt_prepared(const unsigned char *prepared_key,
+                       const unsigned char *buffer,
+                       const unsigned int   buffer_len,
+                       unsigned char       *out_buffer,
+                       unsigned int        *out_buffer_len,
+                       unsigned char       *privacy_params,
+                       unsigned int        *privacy_params_len,
+                       const unsigned long  engine_boots,
+                       const unsigned long  engine_time);
+
+  int decrypt_prepared(const unsigned char *prepared_key,
+                       const unsigned char *buffer,
+                       const unsigned int   buffer_len,
+                       unsigned char       *out_buffer,
+                       unsigned int        *out_buffer_len,
+                       const unsigned char *privacy_params,
+                       const unsigned int   privacy_params_len,
+                       const unsigned long  engine_boots,
+                       const unsigned long  engine_time);
+
   int extend_short_key(const unsigned char *password,
                        const unsigned int   password_len,
                        const unsigned char *engine_id,
@@ -789,6 +1280,9 @@ public:
   int rounds;
 #if defined(_USE_LIBTOMCRYPT) && !defined(_USE_OPENSSL)
   int cipher;
+#endif
+#ifdef _USE_OPENSSL
+  const evp_cipher_st *evp_cipher; ///< AES-CFB of the EVP interface or NULL
 #endif
   bool need_byteswap;
 };
@@ -0,0 +1,198 @@
+/*_############################################################################
+  _##
+  _##  awaitable.h
+  _##
+  _##  SNMP++ v3.3
+  _##  -----------------------------------------------
+  _##  Copyright (c) 2001-2013 Jochen Katz, Frank Fock
+  _##
+  _##  This software is based on SNMP++2.6 from Hewlett Packard:
+  _##
+  _##    Copyright (c) 1996
+  _##    Hewlett-Packard Company
+  _##
+  _##  ATTENTION: USE OF THIS SOFTWARE IS SUBJECT TO THE FOLLOWING TERMS.
+  _##  Permission to use, copy, modify, distribute and/or sell this software
+  _##  and/or its documentation is hereby granted without fee. User agrees
+  _##  to display the above copyright notice and this license notice in all
+  _##  copies of the software and any documentation of the software. User
+  _##  agrees to assume all liability for the use of the software;
+  _##  Hewlett-Packard and Jochen Katz make no representations about the
+  _##  suitability of this software for any purpose. It is provided
+  _##  "AS-IS" without warranty of any kind, either express or implied. User
+  _##  hereby grants a royalty-free license to any and all derivatives based
+  _##  upon this software code base.
+  _##
+  _##########################################################################*/
+
+#ifndef _AWAITABLE_H_
+#define _AWAITABLE_H_
+
+// This header is optional and not included by snmp_pp.h. It is only
+// usable if the compiler supports C++20 coroutines, SNMP++ itself
+// does not need to be compiled with C++20.
+
+#include "snmp_pp/config_snmp_pp.h"
+
+#if defined(__cpp_impl_coroutine) && \
+    ((__cplusplus >= 202002L) || (defined(_MSVC_LANG) && _MSVC_LANG >= 202002L))
+#define SNMP_PP_WITH_COROUTINES
+
+#include <coroutine>
+
+#include "snmp_pp/snmperrs.h"
+#include "snmp_pp/pdu.h"
+#include "snmp_pp/target.h"
+#include "snmp_pp/uxsnmp.h"
+
+#ifdef SNMP_PP_NAMESPACE
+namespace Snmp_pp {
+#endif
+
+/**
+ * Awaitable SNMP request.
+ *
+ * co_await sends the request through the async interface of the Snmp
+ * class and suspends the coroutine. The coroutine is resumed by the
+ * thread that processes the events of the session (see
+ * Snmp::start_poll_thread() or EventListHolder::SNMPMainLoop()) when
+ * the response has been received or the request has timed out. So one
+ * thread drives any number of concurrent requests.
+ *
+ * The result of co_await is SNMP_CLASS_SUCCESS, the error status of the
+ * response or an error code (e.g. SNMP_CLASS_TIMEOUT). The response is
+ * stored in the Pdu passed to the request, so the Pdu and the target
+ * must live until the coroutine is resumed.
+ *
+ * Example:
+ *
+ *   Task poll(Snmp &snmp, const CTarget &target)
+ *   {
+ *     Pdu pdu;
+ *     pdu += Vb("1.3.6.1.2.1.1.3.0");
+ *     int status = co_await async_get(snmp, pdu, target);
+ *     ...
+ *   }
+ *
+ * Task is any coroutine type of the application.
+ */
+class SnmpAwaitable
+{
+ public:
+  enum Operation { op_get, op_get_next, op_get_bulk, op_set, op_inform };
+
+  SnmpAwaitable(Snmp &session, const Operation operation, Pdu &request,
+                const SnmpTarget &destination,
+                const int non_reps = 0, const int max_reps = 0)
+    : snmp(session), op(operation), pdu(request), target(destination),
+      non_repeaters(non_reps), max_repetitions(max_reps),
+      status(SNMP_CLASS_SUCCESS) {}
+
+  bool await_ready() const noexcept { return false; }
+
+  /**
+   * Send the request. If it cannot be sent, the coroutine continues
+   * at once with the error.
+   */
+  bool await_suspend(std::coroutine_handle<> h)
+  {
+    handle = h;
+
+    int rc;
+    switch (op)
+    {
+      case op_get:
+        rc = snmp.get(pdu, target, callback, this);
+        break;
+      case op_get_next:
+        rc = snmp.get_next(pdu, target, callback, this);
+        break;
+      case op_get_bulk:
+        rc = snmp.get_bulk(pdu, target, non_repeaters, max_repetitions,
+                           callback, this);
+        break;
+      case op_set:
+        rc = snmp.set(pdu, target, callback, this);
+        break;
+      default:
+        rc = snmp.inform(pdu, target, callback, this);
+        break;
+    }
+    if (rc == SNMP_CLASS_SUCCESS)
+      return true;  // the callback may already have resumed us
+
+    status = rc;
+    return false;
+  }
+
+  int await_resume() const noexcept { return status; }
+
+ private:
+  static void callback(int reason, Snmp *, Pdu &response,
+                       SnmpTarget &, void *data)
+  {
+    SnmpAwaitable *a = static_cast<SnmpAwaitable *>(data);
+
+    if (reason == SNMP_CLASS_ASYNC_RESPONSE)
+    {
+      a->pdu = response;
+      a->status = response.get_error_status();
+    }
+    else
+      a->status = reason;
+
+    a->handle.resume();
+  }
+
+  Snmp &snmp;
+  Operation op;
+  Pdu &pdu;
+  const SnmpTarget &target;
+  int non_repeaters;
+  int max_repetitions;
+  int status;
+  std::coroutine_handle<> handle;
+};
+
+/// Awaitable GET request (see SnmpAwaitable).
+inline SnmpAwaitable async_get(Snmp &snmp, Pdu &pdu, const SnmpTarget &target)
+{
+  return SnmpAwaitable(snmp, SnmpAwaitable::op_get, pdu, target);
+}
+
+/// Awaitable GETNEXT request (see SnmpAwaitable).
+inline SnmpAwaitable async_get_next(Snmp &snmp, Pdu &pdu,
+                                    const SnmpTarget &target)
+{
+  return SnmpAwaitable(snmp, SnmpAwaitable::op_get_next, pdu, target);
+}
+
+/// Awaitable GETBULK request (see SnmpAwaitable).
+inline SnmpAwaitable async_get_bulk(Snmp &snmp, Pdu &pdu,
+                                    const SnmpTarget &target,
+                                    const int non_repeaters,
+                                    const int max_reps)
+{
+  return SnmpAwaitable(snmp, SnmpAwaitable::op_get_bulk, pdu, target,
+                       non_repeaters, max_reps);
+}
+
+/// Awaitable SET request (see SnmpAwaitable).
+inline SnmpAwaitable async_set(Snmp &snmp, Pdu &pdu, const SnmpTarget &target)
+{
+  return SnmpAwaitable(snmp, SnmpAwaitable::op_set, pdu, target);
+}
+
+/// Awaitable INFORM request (see SnmpAwaitable).
+inline SnmpAwaitable async_inform(Snmp &snmp, Pdu &pdu,
+                                  const SnmpTarget &target)
+{
+  return SnmpAwaitable(snmp, SnmpAwaitable::op_inform, pdu, target);
+}
+
+#ifdef SNMP_PP_NAMESPACE
+} // end of namespace Snmp_pp
+#endif
+
+#endif // C++20 coroutines
+#endif // _AWAITABLE_H_
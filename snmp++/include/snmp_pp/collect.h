@@ -56,77 +56,74 @@
 #define _COLLECTION_H_
 
 #include "snmp_pp/config_snmp_pp.h"
+#include "snmp_pp/smival.h"
 
 #ifdef SNMP_PP_NAMESPACE
 namespace Snmp_pp {
 #endif
 
-#define MAXT 25     // elements per block
-
+#define MAXT 25     // not used any more, kept for compatibility
+
+/**
+ * Collection of SNMP++ objects.
+ *
+ * The collection stores a clone of each added object and keeps the
+ * pointers to the clones in one contiguous array, so all elements can
+ * be accessed by index in constant time. The array grows by doubling
+ * its capacity, so appending elements takes amortized constant time.
+ *
+ * As the objects are cloned, a collection of a base class (like
+ * SnmpTarget) keeps the type of the added objects (CTarget, UTarget).
+ */
 template <class T> class SnmpCollection
 {
-  class cBlock
-  {
-    public:
-     cBlock(cBlock *p, cBlock *n) : prev(p), next(n) {};
-     T *item[MAXT];
-     cBlock *prev;
-     cBlock *next;
-  };
-
  public:
 
   /**
    * Create an empty collection.
    */
   SnmpCollection()
-    : count(0), data(0,0) {};
+    : count(0), capacity(0), items(0) {};
 
   /**
    * Create a collection using a single template object.
    */
   SnmpCollection(const T &t)
-    : count(1), data(0, 0)
+    : count(0), capacity(0), items(0)
   {
-    data.item[0] = (T*) (t.clone());
+    *this += t;
   };
 
   /**
    * Create a collection with another collection (copy constructor).
    */
   SnmpCollection(const SnmpCollection<T> &c)
-    : count(0), data(0, 0)
+    : count(0), capacity(0), items(0)
   {
-    if (c.count == 0) return;
-
-    // load up the new collection
-    cBlock *current = &data;
-    cBlock *nextBlock;
-    int cn = 0;
+    copy_from(c);
+  };
 
-    while (count < c.count)
-    {
-      if (cn >= MAXT)
-      {
-	nextBlock = new cBlock(current, 0);
-	current->next = nextBlock;
-	current = nextBlock;
-	cn=0;
-      }
-      T *tmp = 0;
-      c.get_element(tmp, count);
-      current->item[cn] = (T*) (tmp->clone());
-      count++;
-      cn++;
-    }
+#ifdef SNMP_PP_RVALUE_REFS
+  /**
+   * Move constructor, takes over the elements of the source collection,
+   * which is left empty.
+   */
+  SnmpCollection(SnmpCollection<T> &&c)
+    : count(c.count), capacity(c.capacity), items(c.items)
+  {
+    c.count = 0;
+    c.capacity = 0;
+    c.items = 0;
   };
+#endif
 
   /**
    * Destroy the collection.
    */
   ~SnmpCollection()
   {
-    clear();  // just delete the data
+    clear();
+    delete [] items;
   };
 
   /**
@@ -137,27 +134,38 @@ template <class T> class SnmpCollection
     return count;
   };
 
+  /**
+   * Reserve space for at least the given number of elements, so
+   * appending up to this number of elements does not reallocate.
+   *
+   * @return 0 on success and -1 on failure.
+   */
+  int reserve(const int n)
+  {
+    if (n <= capacity) return 0;
+
+    T **new_items = new T*[n];
+    if (!new_items) return -1;
+    for (int z = 0; z < count; z++)
+      new_items[z] = items[z];
+    delete [] items;
+    items = new_items;
+    capacity = n;
+    return 0;
+  };
+
   /**
    * Append an item to the collection.
    */
   SnmpCollection& operator +=(const T &i)
   {
-    cBlock *current = &data;
-    int cn = (int) count % MAXT;
-    while (current->next)
-      current = current->next;
-    if ((count > 0) && ((count % MAXT) == 0))
-    {
-      cBlock *add = new cBlock(current, 0);
-      if (!add) return *this;
-      current->next = add;
-      add->item[0] = (T*) (i.clone());
-    }
-    else
-    {
-      current->item[cn] = (T*) (i.clone());
-    }
-    count++;
+    if ((count == capacity) &&
+        reserve(capacity ? capacity * 2 : 8))
+      return *this;
+
+    T *item = (T*) (i.clone());
+    if (item)
+      items[count++] = item;
 
     return *this;
   };
@@ -170,32 +178,31 @@ template <class T> class SnmpCollection
     if (this == &c) return *this;  // check for self assignment
 
     clear(); // delete the data
+    copy_from(c);
 
-    if (c.count == 0) return *this;
+    return *this;
+  };
 
-    // load up the new collection
-    cBlock *current = &data;
-    cBlock *nextBlock;
-    int cn = 0;
-    count = 0;
-    while (count < c.count)
-    {
-      if (cn >= MAXT)
-      {
-	nextBlock = new cBlock(current, 0);
-	current->next = nextBlock;
-	current = nextBlock;
-	cn=0;
-      }
-      T *tmp = 0;
-      c.get_element(tmp, count);
-      current->item[cn] = (T*) (tmp->clone());
-      count++;
-      cn++;
-    }
+#ifdef SNMP_PP_RVALUE_REFS
+  /**
+   * Move one collection to another, the source collection is left empty.
+   */
+  SnmpCollection &operator =(SnmpCollection<T> &&c)
+  {
+    if (this == &c) return *this;  // check for self assignment
+
+    clear();
+    delete [] items;
+    count = c.count;
+    capacity = c.capacity;
+    items = c.items;
+    c.count = 0;
+    c.capacity = 0;
+    c.items = 0;
 
     return *this;
   };
+#endif
 
   /**
    * Access an element in the collection.
@@ -206,12 +213,7 @@ template <class T> class SnmpCollection
   {
     if ((p < count) && (p >= 0))
     {
-      cBlock const *current = &data;
-      int bn = (int) (p / MAXT);
-      int cn = (int) p % MAXT;
-      for (int z=0; z<bn; z++)
-	current = current->next;
-      return *(current->item[cn]);
+      return *(items[p]);
     }
     else
     {
@@ -228,15 +230,12 @@ template <class T> class SnmpCollection
    */
   int set_element( const T& i, const int p)
   {
-    if ((p < 0) || (p > count)) return -1; // not found!
-
-    cBlock *current = &data;
-    int bn = (int) p / MAXT;
-    int cn = (int) p % MAXT;
-    for (int z=0; z<bn; z++)
-      current = current->next;
-    delete current->item[cn];
-    current->item[cn] = (T*) (i.clone());
+    if ((p < 0) || (p >= count)) return -1; // not found!
+
+    T *item = (T*) (i.clone());
+    if (!item) return -1;
+    delete items[p];
+    items[p] = item;
     return 0;
   };
 
@@ -247,14 +246,9 @@ template <class T> class SnmpCollection
    */
   int get_element(T &t, const int p) const
   {
-    if ((p < 0) || (p > count)) return -1; // not found!
-
-    cBlock const *current = &data;
-    int bn = (int) p / MAXT;
-    int cn = (int) p % MAXT;
-    for (int z=0; z<bn; z++)
-      current = current->next;
-    t = *(current->item[cn]);
+    if ((p < 0) || (p >= count)) return -1; // not found!
+
+    t = *(items[p]);
     return 0;
   };
 
@@ -265,14 +259,9 @@ template <class T> class SnmpCollection
    */
   int get_element(T *&t, const int p) const
   {
-    if ((p < 0) || (p > count)) return -1; // not found!
-
-    cBlock const *current = &data;
-    int bn = (int) p / MAXT;
-    int cn = (int) p % MAXT;
-    for (int z=0; z<bn; z++)
-      current = current->next;
-    t = current->item[cn];
+    if ((p < 0) || (p >= count)) return -1; // not found!
+
+    t = items[p];
     return 0;
   };
 
@@ -296,11 +285,9 @@ template <class T> class SnmpCollection
    */
   int find(const T& i, int &pos) const
   {
-    T temp;
     for (int z=0; z<count; z++)
     {
-      this->get_element(temp, z);
-      if ( temp == i) {
+      if (*(items[z]) == i) {
 	pos = z;
 	return true;
       }
@@ -317,65 +304,45 @@ template <class T> class SnmpCollection
     int pos;
     if (find(i, pos))
     {
-      SnmpCollection<T> newCollection;
-
-      for (int z=0; z<count; z++)
-      {
-	if (z != pos)
-	{
-	  T item;
-	  get_element(item, z);
-	  newCollection += item;
-	}
-      }
-
-      // assign new collection to 'this'
-      operator =(newCollection);
-
+      delete items[pos];
+      for (int z = pos + 1; z < count; z++)
+	items[z - 1] = items[z];
+      count--;
       return true;
     }
     return false;   // not found thus not removed
   };
 
   /**
-   * Delete all elements within the collection.
+   * Delete all elements within the collection. The allocated space
+   * is kept for new elements.
    */
   void clear()
   {
-    if (count == 0) return;
-
-    cBlock *current = &data;
-    int z=0;
-    int cn=0;
-    while ( z< count)
-    {
-      if (cn >= MAXT)
-      {
-	cn =0;
-	current = current->next;
-      }
-      delete current->item[cn];
-      cn++;
-      z++;
-    }
+    for (int z = 0; z < count; z++)
+      delete items[z];
+    count = 0;
+  };
 
-    // delete the blocks
-    while (current->next)
-      current = current->next;
-    while (current->prev)
+ private:
+  /**
+   * Append clones of all elements of the given collection.
+   */
+  void copy_from(const SnmpCollection<T> &c)
+  {
+    if (c.count == 0) return;
+    if (reserve(count + c.count)) return;
+    for (int z = 0; z < c.count; z++)
     {
-      current = current->prev;
-      delete current->next;
+      T *item = (T*) (c.items[z]->clone());
+      if (item)
+        items[count++] = item;
     }
-
-    count = 0;
-    data.next=0;
-    data.prev=0;
   };
 
- private:
-  int count;
-  cBlock data;
+  int count;     // number of elements
+  int capacity;  // number of allocated pointers
+  T **items;     // pointers to the elements
 };
 
 #ifdef SNMP_PP_NAMESPACE
@@ -114,6 +114,12 @@ class DLLOPT Counter32: public SnmpUInt32
    */
   SnmpSyntax *clone() const { return (SnmpSyntax *)new Counter32(*this); }
 
+  /**
+   * Copy the object into buf, see SnmpSyntax::clone_into().
+   */
+  SnmpSyntax *clone_into(void *buf, size_t size) const
+    { return (size < sizeof(Counter32)) ? 0 : new (buf) Counter32(*this); }
+
   /**
    * Map other SnmpSyntax objects to Counter32.
    */
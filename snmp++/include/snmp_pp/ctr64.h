@@ -228,6 +228,12 @@ class DLLOPT Counter64: public  SnmpSyntax
    */
   SnmpSyntax *clone() const { return (SnmpSyntax *) new Counter64(*this); }
 
+  /**
+   * Copy the object into buf, see SnmpSyntax::clone_into().
+   */
+  SnmpSyntax *clone_into(void *buf, size_t size) const
+    { return (size < sizeof(Counter64)) ? 0 : new (buf) Counter64(*this); }
+
   /**
    * Overloaded assignement operator.
    *
@@ -79,6 +79,7 @@
 
 #include "snmp_pp/config_snmp_pp.h"
 #include "snmp_pp/reentrant.h"
+#include "snmp_pp/snmperrs.h"
 
 #ifdef SNMP_PP_NAMESPACE
 namespace Snmp_pp {
@@ -113,6 +114,13 @@ class DLLOPT CEvents: public SnmpSynchronized {
 			   const fd_set &writefds,
 			   const fd_set &exceptfds) = 0;
 #endif
+#ifdef HAVE_EPOLL_SYSCALL
+  // process events pending on one ready file descriptor, the
+  // file descriptor must have been registered with CEventList::AddFd()
+  virtual int HandleSocketEvents(const SnmpSocket /*fd*/)
+    { return SNMP_CLASS_SUCCESS; };
+#endif
+
   // return number of outstanding messages
   virtual int GetCount() = 0;
 
@@ -126,7 +134,7 @@ class DLLOPT CEvents: public SnmpSynchronized {
 
 class DLLOPT CEventList: public SnmpSynchronized {
   public:
-    CEventList() : m_head(0, 0, 0), m_msgCount(0), m_done(0) {};
+    CEventList();
     ~CEventList();
 
   // add an event source to the list
@@ -157,6 +165,24 @@ class DLLOPT CEventList: public SnmpSynchronized {
 		   const fd_set &exceptfds);
 #endif
 
+#ifdef HAVE_EPOLL_SYSCALL
+  // true if the epoll instance could be created and is used instead
+  // of select/poll
+  bool UseEpoll() const { return m_epollFd >= 0; };
+
+  // watch a socket of the given event source, calls are reference
+  // counted and must be matched by calls to RemoveFd()
+  int AddFd(const SnmpSocket fd, CEvents *events);
+  int RemoveFd(const SnmpSocket fd);
+
+  // wait for ready sockets, returns the number of ready sockets
+  int WaitForEvents(struct epoll_event *ready, const int max_ready,
+                    const int timeout);
+
+  // process events pending on the ready sockets
+  int HandleEvents(const struct epoll_event *ready, const int count);
+#endif
+
   // return number of outstanding messages
   int GetCount() { return m_msgCount; };
 
@@ -190,6 +216,24 @@ class DLLOPT CEventList: public SnmpSynchronized {
     CEventListElt m_head;
     int m_msgCount;
     int m_done;
+
+#ifdef HAVE_EPOLL_SYSCALL
+   class DLLOPT CEventFd
+   {
+    public:
+     CEventFd(const SnmpSocket fd, CEvents *events, CEventFd *next)
+       : m_fd(fd), m_events(events), m_refCount(1), m_Next(next) {};
+
+     SnmpSocket m_fd;
+     CEvents *m_events;
+     int m_refCount;
+     class CEventFd *m_Next;
+   };
+
+    int m_epollFd;
+    CEventFd *m_fds;          // registered sockets, usually only a few
+    SnmpSynchronized m_fdLock; // never held while calling event sources
+#endif
 };
 
 #ifdef SNMP_PP_NAMESPACE
@@ -64,6 +64,17 @@ class DLLOPT EventListHolder
 		     fd_set & writefds,
 		     fd_set & exceptfds);
 
+#ifdef HAVE_EPOLL_SYSCALL
+  /**
+   * Watch a socket of an event source while it is needed. Calls are
+   * reference counted and must be matched by calls to RemoveFd().
+   */
+  void AddFd(const SnmpSocket fd, CEvents *events)
+    { m_eventList.AddFd(fd, events); };
+  void RemoveFd(const SnmpSocket fd)
+    { m_eventList.RemoveFd(fd); };
+#endif
+
   //---------[ Main Loop ]------------------------------------------
   /**
    * Infinite loop which blocks when there is nothing to do and handles
@@ -100,6 +111,11 @@ class DLLOPT EventListHolder
 
  private:
 
+#ifdef HAVE_EPOLL_SYSCALL
+  int EpollProcessEvents(const int max_block_milliseconds);
+  int EpollProcessPendingEvents();
+#endif
+
   CSNMPMessageQueue *m_snmpMessageQueue;  // contains all outstanding messages
   CNotifyEventQueue *m_notifyEventQueue; // contains all sessions waiting for notifications
   CEventList   m_eventList;  // contains all expected events
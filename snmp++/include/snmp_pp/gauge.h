@@ -122,6 +122,12 @@ class DLLOPT Gauge32: public SnmpUInt32
    */
   SnmpSyntax *clone() const { return (SnmpSyntax *) new Gauge32(*this); }
 
+  /**
+   * Copy the object into buf, see SnmpSyntax::clone_into().
+   */
+  SnmpSyntax *clone_into(void *buf, size_t size) const
+    { return (size < sizeof(Gauge32)) ? 0 : new (buf) Gauge32(*this); }
+
   //-----------[ Overload some operators ]----------------------
 
   using SnmpUInt32::operator = ;
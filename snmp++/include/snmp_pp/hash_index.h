@@ -0,0 +1,186 @@
+/*_############################################################################
+  _##
+  _##  hash_index.h
+  _##
+  _##  SNMP++ v3.3
+  _##  -----------------------------------------------
+  _##  Copyright (c) 2001-2013 Jochen Katz, Frank Fock
+  _##
+  _##  This software is based on SNMP++2.6 from Hewlett Packard:
+  _##
+  _##    Copyright (c) 1996
+  _##    Hewlett-Packard Company
+  _##
+  _##  ATTENTION: USE OF THIS SOFTWARE IS SUBJECT TO THE FOLLOWING TERMS.
+  _##  Permission to use, copy, modify, distribute and/or sell this software
+  _##  and/or its documentation is hereby granted without fee. User agrees
+  _##  to display the above copyright notice and this license notice in all
+  _##  copies of the software and any documentation of the software. User
+  _##  agrees to assume all liability for the use of the software;
+  _##  Hewlett-Packard and Jochen Katz make no representations about the
+  _##  suitability of this software for any purpose. It is provided
+  _##  "AS-IS" without warranty of any kind, either express or implied. User
+  _##  hereby grants a royalty-free license to any and all derivatives based
+  _##  upon this software code base.
+  _##
+  _##########################################################################*/
+
+/*
+  Hash index for the SNMPv3 tables.
+
+  The USM and v3MP tables store their entries in arrays. A SnmpHashIndex
+  maps the hash value of a key to the positions of the matching entries
+  in such an array, so the tables do not have to be scanned. The index
+  does not know the keys, the caller has to check that the entry at a
+  returned position really matches.
+
+  Each distinct key has one slot in the hash table. Further entries with
+  the same key are chained to it, so keys that are shared by many
+  entries (like the userName of a user that is localized for many
+  engines) do not slow down the lookup of other keys.
+*/
+
+#ifndef _HASH_INDEX_H_
+#define _HASH_INDEX_H_
+
+//----[ includes ]-----------------------------------------------------
+#include "snmp_pp/config_snmp_pp.h"
+
+#ifdef SNMP_PP_NAMESPACE
+namespace Snmp_pp {
+#endif
+
+class DLLOPT SnmpHashIndex
+{
+ public:
+  SnmpHashIndex();
+  ~SnmpHashIndex();
+
+  /**
+   * Compute the hash value of a byte string (FNV-1a). Call the
+   * function again with the previous result to hash a key that
+   * consists of more than one string.
+   *
+   * @param data - The bytes to hash
+   * @param len  - Length of data
+   * @param hash - Start value
+   *
+   * @return The hash value
+   */
+  static unsigned int hash(const unsigned char *data, const long len,
+                           unsigned int hash = 2166136261u);
+
+  /**
+   * Make sure the index can hold positions 0 to count - 1, so add()
+   * and add_same() do not need to allocate memory.
+   *
+   * @return true on success, false if out of memory
+   */
+  bool reserve(const int count);
+
+  /**
+   * Add the position of an entry with a key that is not yet in the
+   * index. reserve() must have been called for the position.
+   */
+  void add(const unsigned int hash, const int pos);
+
+  /**
+   * Add the position of an entry with a key that is already in the
+   * index. reserve() must have been called for the position.
+   *
+   * @param same - Position of an entry with the same key
+   * @param pos  - The position to add
+   */
+  void add_same(const int same, const int pos);
+
+  /**
+   * Remove a position from the index.
+   */
+  void remove(const unsigned int hash, const int pos);
+
+  /**
+   * Change a position, used when an entry is moved within the array.
+   */
+  void move(const unsigned int hash, const int old_pos, const int new_pos);
+
+  /**
+   * Remove all positions.
+   */
+  void clear();
+
+  /**
+   * Get the first position stored for a hash value. There is one
+   * position for each distinct key with this hash value.
+   *
+   * @param hash   - The hash value to search for
+   * @param cursor - Set to the search state for next()
+   *
+   * @return A position or -1 if there is none
+   */
+  int first(const unsigned int hash, unsigned long &cursor) const;
+
+  /**
+   * Get the position of the next distinct key for a hash value.
+   *
+   * @return A position or -1 if there are no more positions
+   */
+  int next(const unsigned int hash, unsigned long &cursor) const;
+
+  /**
+   * Get the next position of an entry with the same key.
+   *
+   * @param pos - A position returned by first(), next() or next_same()
+   *
+   * @return A position or -1 if there are no more entries with the key
+   */
+  int next_same(const int pos) const { return chain_next[pos]; }
+
+  /**
+   * Get the number of bytes save() needs for the index.
+   *
+   * @param count - Positions 0 to count - 1 are saved, all positions
+   *                in the index have to be lower than count
+   */
+  unsigned long saved_size(const int count) const;
+
+  /**
+   * Copy the index into a buffer of saved_size() bytes, so it can be
+   * restored by load() without computing the hashes again.
+   */
+  void save(unsigned char *buf, const int count) const;
+
+  /**
+   * Replace the index by one that was copied by save(). The data is
+   * checked to hold positions lower than count only.
+   *
+   * @return true on success, false if the data is not valid or out
+   *         of memory (the index is empty then)
+   */
+  bool load(const unsigned char *buf, const unsigned long len,
+            const int count);
+
+ private:
+  struct Slot
+  {
+    unsigned int hash;
+    int pos;        // first entry with the key, -1 for an empty slot
+  };
+
+  int find(const unsigned int hash, unsigned long &cursor) const;
+  unsigned long slot_of(const unsigned int hash, const int pos) const;
+  bool reserve_slots(const unsigned long keys);
+
+  Slot *slots;            // open addressing with linear probing
+  unsigned long size;     // number of slots, a power of 2
+  unsigned long used;     // number of used slots
+
+  int *chain_next;        // per position: next entry with the same key
+  int *chain_prev;        // per position: previous entry, -1 for the first
+  int chain_size;         // number of positions in the chain arrays
+};
+
+#ifdef SNMP_PP_NAMESPACE
+} // end of namespace Snmp_pp
+#endif
+
+#endif // _HASH_INDEX_H_
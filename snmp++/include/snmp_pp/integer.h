@@ -174,6 +174,12 @@ class DLLOPT SnmpUInt32 : public SnmpSyntax
   virtual SnmpSyntax *clone() const
     { return (SnmpSyntax *)new SnmpUInt32(*this); };
 
+  /**
+   * Copy the object into buf, see SnmpSyntax::clone_into().
+   */
+  virtual SnmpSyntax *clone_into(void *buf, size_t size) const
+    { return (size < sizeof(SnmpUInt32)) ? 0 : new (buf) SnmpUInt32(*this); }
+
   /**
    * Return validity of the object.
    * An SnmpUInt32 will only be invalid after a failed asignment
@@ -307,6 +313,12 @@ class DLLOPT SnmpInt32 : public SnmpSyntax
    */
   SnmpSyntax *clone() const { return (SnmpSyntax *)new SnmpInt32(*this); };
 
+  /**
+   * Copy the object into buf, see SnmpSyntax::clone_into().
+   */
+  SnmpSyntax *clone_into(void *buf, size_t size) const
+    { return (size < sizeof(SnmpInt32)) ? 0 : new (buf) SnmpInt32(*this); }
+
   /**
    * Return validity of the object.
    * An SnmpUInt32 will only be invalid after a failed asignment
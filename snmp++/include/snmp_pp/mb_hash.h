@@ -0,0 +1,101 @@
+/*_############################################################################
+  _##
+  _##  mb_hash.h
+  _##
+  _##  SNMP++ v3.3
+  _##  -----------------------------------------------
+  _##  Copyright (c) 2001-2013 Jochen Katz, Frank Fock
+  _##
+  _##  This software is based on SNMP++2.6 from Hewlett Packard:
+  _##
+  _##    Copyright (c) 1996
+  _##    Hewlett-Packard Company
+  _##
+  _##  ATTENTION: USE OF THIS SOFTWARE IS SUBJECT TO THE FOLLOWING TERMS.
+  _##  Permission to use, copy, modify, distribute and/or sell this software
+  _##  and/or its documentation is hereby granted without fee. User agrees
+  _##  to display the above copyright notice and this license notice in all
+  _##  copies of the software and any documentation of the software. User
+  _##  agrees to assume all liability for the use of the software;
+  _##  Hewlett-Packard and Jochen Katz make no representations about the
+  _##  suitability of this software for any purpose. It is provided
+  _##  "AS-IS" without warranty of any kind, either express or implied. User
+  _##  hereby grants a royalty-free license to any and all derivatives based
+  _##  upon this software code base.
+  _##
+  _##########################################################################*/
+
+
+/*
+  Multi-buffer MD5 and SHA-1 for the password to key algorithm.
+
+  The password to key algorithm of RFC 3414 hashes 1 MByte of the
+  repeated password. All these hashes have the same length, so the
+  hashes of several passwords can be computed at once in the lanes of
+  SSE2 (4 lanes) or AVX2 (8 lanes) registers if the compiler targets
+  them (x86/x64). SNMP_PP_MB_HASH_LANES is not defined if there is no
+  multi-buffer implementation or if SNMP_PP_NO_SIMD is defined.
+*/
+
+#ifndef _MB_HASH_H_
+#define _MB_HASH_H_
+
+//----[ includes ]-----------------------------------------------------
+#include "snmp_pp/config_snmp_pp.h"
+
+#ifndef SNMP_PP_NO_SIMD
+#  if defined(__AVX2__)
+#    define SNMP_PP_MB_HASH_AVX2
+#    define SNMP_PP_MB_HASH_LANES 8
+#  elif defined(__SSE2__) || defined(_M_X64) || \
+        (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#    define SNMP_PP_MB_HASH_SSE2
+#    define SNMP_PP_MB_HASH_LANES 4
+#  endif
+#endif
+
+#ifdef SNMP_PP_NAMESPACE
+namespace Snmp_pp {
+#endif
+
+#ifdef SNMP_PP_MB_HASH_LANES
+
+/**
+ * Compute the non localized key Ku (RFC 3414, A.2.1) for up to
+ * SNMP_PP_MB_HASH_LANES passwords at once.
+ *
+ * @param count         - Number of passwords (1..SNMP_PP_MB_HASH_LANES)
+ * @param passwords     - The passwords
+ * @param password_lens - The lengths of the passwords, must not be 0
+ * @param kus           - Buffer of count * 16 bytes for the keys
+ *
+ * @return true on success, false if out of memory
+ */
+DLLOPT bool mb_md5_password_to_ku(const int count,
+                                  const unsigned char * const *passwords,
+                                  const unsigned int *password_lens,
+                                  unsigned char *kus);
+
+/**
+ * Compute the non localized key Ku (RFC 3414, A.2.2) for up to
+ * SNMP_PP_MB_HASH_LANES passwords at once.
+ *
+ * @param count         - Number of passwords (1..SNMP_PP_MB_HASH_LANES)
+ * @param passwords     - The passwords
+ * @param password_lens - The lengths of the passwords, must not be 0
+ * @param kus           - Buffer of count * 20 bytes for the keys
+ *
+ * @return true on success, false if out of memory
+ */
+DLLOPT bool mb_sha1_password_to_ku(const int count,
+                                   const unsigned char * const *passwords,
+                                   const unsigned int *password_lens,
+                                   unsigned char *kus);
+
+#endif // SNMP_PP_MB_HASH_LANES
+
+#ifdef SNMP_PP_NAMESPACE
+} // end of namespace Snmp_pp
+#endif
+
+#endif // _MB_HASH_H_
@@ -35,6 +35,7 @@
 #ifdef _SNMPv3
 
 #include "snmp_pp/reentrant.h"
+#include "snmp_pp/hash_index.h"
 #include "snmp_pp/target.h"
 
 #ifdef SNMP_PP_NAMESPACE
@@ -358,6 +359,33 @@ class DLLOPT v3MP
 		 const OctetStr &contextEngineID,
 		 const OctetStr &contextName);
 
+  /**
+   * Do the complete process of encoding the given pdu into the buffer
+   * ready to send to the target. The scopedPDU is encoded directly
+   * from the pdu, without building a struct snmp_pdu first.
+   *
+   * @param pdu              - The pdu
+   * @param packet           - The buffer to store the serialized message
+   * @param out_length       - IN: Length of the buffer,
+   *                           OUT: Length of the message
+   * @param securityEngineID - The securityEngineID
+   * @param securityNameIn   - The securityName
+   * @param securityModel    - Use this security model
+   * @param securityLevel    - Use this security level
+   * @param contextEngineID  - The contextEngineID
+   * @param contextName      - The contextName
+   *
+   * @return - SNMPv3_MP_OK or any error listed in snmperr.h
+   */
+  int snmp_build(const Pdu &pdu,
+		 unsigned char *packet,
+		 int *out_length,           // maximum Bytes in packet
+		 const OctetStr &securityEngineID,
+		 const OctetStr &securityNameIn,
+		 int securityModel, int securityLevel,
+		 const OctetStr &contextEngineID,
+		 const OctetStr &contextName);
+
   /**
    * Delete the entry with the given request id from the cache.
    * This function is used in eventlist.cpp when a request
@@ -410,13 +438,52 @@ class DLLOPT v3MP
 		  int sModel, OctetStr &sName,
 		  UdpAddress &destination, Snmp *snmp_session);
 
+  /**
+   * Get the message id for a message to build. For requests a new
+   * message id is generated, for responses the cache entry of the
+   * request is looked up.
+   *
+   * @param command          - The pdu type
+   * @param pduMsgID         - The message id of the pdu (responses)
+   * @param securityEngineID - The securityEngineID
+   * @param securityModel    - IN/OUT: The security model
+   * @param securityLevel    - IN/OUT: The security level
+   * @param msgID            - OUT: The message id
+   * @param securityStateReference - OUT: The cached state (responses)
+   *
+   * @return - SNMPv3_MP_OK or SNMPv3_MP_MATCH_ERROR
+   */
+  int prepare_build(const int command, const unsigned long pduMsgID,
+		    const OctetStr &securityEngineID,
+		    int &securityModel, int &securityLevel, int &msgID,
+		    struct SecurityStateReference *&securityStateReference);
+
+  /**
+   * Build msgGlobalData and let the security model build the
+   * complete message around the encoded scopedPDU.
+   *
+   * @return - SNMPv3_MP_OK or any error listed in snmperr.h
+   */
+  int build_message(const int command, const unsigned long requestID,
+		    const int msgID,
+		    struct SecurityStateReference *securityStateReference,
+		    unsigned char *scopedPDU, const int scopedPDULength,
+		    unsigned char *packet, int *out_length,
+		    const OctetStr &securityEngineID,
+		    const OctetStr &securityName,
+		    int securityModel, int securityLevel,
+		    const OctetStr &contextEngineID,
+		    const OctetStr &contextName);
+
 
 
   // =====================[ member classes ]==============================
 
   /**
    * The engine id table is used to store known engine ids with
-   * corresponding hostadress and port.
+   * corresponding hostadress and port. Each engine id and each
+   * host/port is in the table only once, the entries are found
+   * through hash indexes.
    */
   class DLLOPT EngineIdTable
   {
@@ -426,7 +493,8 @@ class DLLOPT v3MP
     ~EngineIdTable();
 
     /**
-     * Add an entry to the table.
+     * Add an entry to the table. Entries with the same engine id or
+     * the same host and port are replaced.
      *
      * @param engine_id - The engineID
      * @param host      - The numerical IP address
@@ -493,6 +561,21 @@ class DLLOPT v3MP
   private:
     bool initialize_table(const int size);
 
+    /**
+     * Get the position of the entry for the engine id or host/port,
+     * -1 if there is none.
+     */
+    int find_engine_id(const OctetStr &engine_id) const;
+    int find_host(const OctetStr &host, const int port) const;
+
+    /**
+     * Remove the entry at position nr, the last entry is moved there.
+     */
+    void remove_entry(const int nr);
+
+    static unsigned int engine_id_hash(const OctetStr &engine_id);
+    static unsigned int host_hash(const OctetStr &host, const int port);
+
     struct Entry_T
     {
       OctetStr engine_id;
@@ -503,7 +586,10 @@ class DLLOPT v3MP
     struct Entry_T *table;
     int max_entries;      ///< the maximum number of entries
     int entries;          ///< the current amount of entries
-    SNMP_PP_MUTABLE SnmpSynchronized lock;
+    SnmpHashIndex engine_id_index;  ///< positions by engine id
+    SnmpHashIndex host_index;       ///< positions by host and port
+    /// lookups read, changes write
+    SNMP_PP_MUTABLE SnmpReadWriteLock rw_lock;
   };
 
 
@@ -604,6 +690,14 @@ class DLLOPT v3MP
     int get_entry(int searchedID, bool local_request,
                   struct Cache::Entry_T *res);
 
+    /**
+     * Check if the cache holds an entry for a local request with
+     * the given message id.
+     *
+     * @param msg_id - The message id.
+     */
+    bool contains_local_entry(int msg_id);
+
     void delete_content(struct Cache::Entry_T &ce);
 
     void set_usm(USM *usm_to_use) { usm = usm_to_use; };
@@ -628,8 +722,16 @@ class DLLOPT v3MP
   int own_engine_id_len;
   OctetStr own_engine_id_oct;
 
-  unsigned int cur_msg_id;   ///< msgID to use for next message
-  SNMP_PP_MUTABLE SnmpSynchronized cur_msg_id_lock;
+  unsigned int cur_msg_id;   ///< msgID to use for the first message
+  SnmpAtomicCounter msg_id_counter;  ///< counter for the msgIDs
+  SnmpAtomicCounter msg_id_wrapped;  ///< not 0 if msgIDs may be in the cache
+
+  /**
+   * Get the msgID for the next outgoing request. The counter is
+   * incremented without locking, after the msgID space has wrapped
+   * the msgIDs of cached requests are skipped.
+   */
+  int next_msg_id();
 
   USM *usm;  ///< the USM object used
 
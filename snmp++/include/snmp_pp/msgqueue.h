@@ -177,6 +177,8 @@ class DLLOPT CSNMPMessageQueue: public CEvents
 		     const fd_set &writefds,
 		     const fd_set &exceptfds);
 #endif
+  // receive pending messages from the socket and dispatch them
+    int HandleSocketEvents(const SnmpSocket fd);
 
   // return number of outstanding messages
     int GetCount() { return m_msgCount; };
@@ -205,17 +207,71 @@ class DLLOPT CSNMPMessageQueue: public CEvents
       CSNMPMessage *GetMessage() { return m_message; }
       CSNMPMessage *TestId(const unsigned long uniqueId);
 
+      // chain of the hash bucket and position in the timeout heap
+      CSNMPMessageQueueElt *GetHashNext() { return m_hashNext; }
+      void SetHashNext(CSNMPMessageQueueElt *next) { m_hashNext = next; }
+      int GetHeapIndex() const { return m_heapIndex; }
+      void SetHeapIndex(const int index) { m_heapIndex = index; }
+
      private:
 
       CSNMPMessage *m_message;
       class CSNMPMessageQueueElt *m_Next;
       class CSNMPMessageQueueElt *m_previous;
+      class CSNMPMessageQueueElt *m_hashNext;
+      int m_heapIndex;
     };
 
+  // index of the messages by request id (hash table with chaining)
+    CSNMPMessageQueueElt *FindElt(const unsigned long uniqueId);
+    void HashInsert(CSNMPMessageQueueElt *elt);
+    void HashRemove(CSNMPMessageQueueElt *elt);
+    void HashGrow();
+
+  // index of the messages by send time (binary min-heap)
+    void HeapInsert(CSNMPMessageQueueElt *elt);
+    void HeapRemove(CSNMPMessageQueueElt *elt);
+    void HeapUpdate(CSNMPMessageQueueElt *elt);
+    void HeapSiftUp(int index);
+    void HeapSiftDown(int index);
+    bool HeapLess(const int i, const int j) const;
+    void HeapSet(const int index, CSNMPMessageQueueElt *elt);
+
+  // count the messages per socket, so the fds are known without a scan
+    void AddSocketRef(const SnmpSocket socket);
+    void RemoveSocketRef(const SnmpSocket socket);
+
+  // remove the element from all indexes and delete it
+    void RemoveElt(CSNMPMessageQueueElt *elt);
+
+  // (un)register the socket of a message with the event list
+    void WatchSocket(const SnmpSocket socket);
+    void UnwatchSocket(const SnmpSocket socket);
+
+  // pass a received response to the matching outstanding message
+    int HandleResponse(const int recv_status, Pdu &pdu,
+                       const UdpAddress &fromaddress,
+                       const OctetStr &engine_id);
+
     CSNMPMessageQueueElt m_head;
     int m_msgCount;
     EventListHolder *my_holder;
     Snmp *m_snmpSession;
+
+    CSNMPMessageQueueElt **m_hashTable;   // buckets, size is a power of 2
+    unsigned long m_hashSize;
+    CSNMPMessageQueueElt **m_heap;        // m_heap[0] times out first
+    int m_heapSize;
+    int m_heapCapacity;
+
+    struct SocketRef
+    {
+      SnmpSocket socket;
+      int count;
+    };
+    SocketRef *m_sockets;                 // sockets with messages
+    int m_socketCount;
+    int m_socketCapacity;
 };
 
 #ifdef SNMP_PP_NAMESPACE
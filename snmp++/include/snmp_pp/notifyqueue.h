@@ -145,6 +145,9 @@ class DLLOPT CNotifyEventQueue: public CEvents
                      const fd_set &readfds,
                      const fd_set &writefds,
                      const fd_set &exceptfds);
+#endif
+#ifdef HAVE_EPOLL_SYSCALL
+    int HandleSocketEvents(const SnmpSocket fd);
 #endif
     // return number of outstanding messages
     int GetCount() { return m_msgCount; };
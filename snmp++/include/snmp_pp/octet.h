@@ -110,6 +110,16 @@ class DLLOPT OctetStr: public  SnmpSyntax
    */
   OctetStr(const OctetStr &octet);
 
+#ifdef SNMP_PP_RVALUE_REFS
+  /**
+   * Construct a OctetStr by taking over the value of another OctetStr.
+   * The source is left as a valid zero length OctetStr.
+   *
+   * @param octet - Value for the new object
+   */
+  OctetStr(OctetStr &&octet);
+#endif
+
   /**
    * Destructor, frees allocated space.
    */
@@ -127,6 +137,14 @@ class DLLOPT OctetStr: public  SnmpSyntax
    */
   OctetStr& operator=(const OctetStr &octet);
 
+#ifdef SNMP_PP_RVALUE_REFS
+  /**
+   * Move a OctetStr to a OctetStr.
+   * The source is left as a valid zero length OctetStr.
+   */
+  OctetStr& operator=(OctetStr &&octet);
+#endif
+
   /**
    * Equal operator for two OctetStr.
    */
@@ -241,6 +259,12 @@ class DLLOPT OctetStr: public  SnmpSyntax
    */
   SnmpSyntax *clone() const { return (SnmpSyntax *) new OctetStr(*this); };
 
+  /**
+   * Copy the object into buf, see SnmpSyntax::clone_into().
+   */
+  SnmpSyntax *clone_into(void *buf, size_t size) const
+    { return (size < sizeof(OctetStr)) ? 0 : new (buf) OctetStr(*this); }
+
   /**
    * Map other SnmpSyntax objects to OctetStr.
    */
@@ -431,6 +455,28 @@ class OpaqueStr: public OctetStr
   OpaqueStr(const OpaqueStr& opaque) : OctetStr(opaque)
     { smival.syntax = sNMP_SYNTAX_OPAQUE; };
 
+#ifdef SNMP_PP_RVALUE_REFS
+  /**
+   * Construct a OpaqueStr by taking over the value of another OpaqueStr.
+   *
+   * @param opaque - Value for the new object
+   */
+  OpaqueStr(OpaqueStr&& opaque) : OctetStr(std::move(opaque))
+    { smival.syntax = sNMP_SYNTAX_OPAQUE; };
+
+  /**
+   * Assign a OpaqueStr to a OpaqueStr.
+   */
+  OpaqueStr& operator=(const OpaqueStr &opaque)
+    { OctetStr::operator=(opaque); return *this; }
+
+  /**
+   * Move a OpaqueStr to a OpaqueStr.
+   */
+  OpaqueStr& operator=(OpaqueStr &&opaque)
+    { OctetStr::operator=(std::move(opaque)); return *this; }
+#endif
+
   /**
    * Clone this object.
    *
@@ -438,6 +484,12 @@ class OpaqueStr: public OctetStr
    */
   virtual SnmpSyntax *clone() const { return new OpaqueStr(*this); }
 
+  /**
+   * Copy the object into buf, see SnmpSyntax::clone_into().
+   */
+  virtual SnmpSyntax *clone_into(void *buf, size_t size) const
+    { return (size < sizeof(OpaqueStr)) ? 0 : new (buf) OpaqueStr(*this); }
+
   /**
    * Return the syntax.
    *
@@ -63,6 +63,8 @@
 //------------------------------------------------------------------------
 
 #include "snmp_pp/smival.h"                // derived class for all values
+#include "snmp_pp/oid_cmp.h"
+#include "snmp_pp/oid_literal.h"
 #include "snmp_pp/collect.h"
 
 #ifdef SNMP_PP_NAMESPACE
@@ -90,6 +92,10 @@ namespace Snmp_pp {
  *       Oid object is modified. The functions get_printable(len) and
  *       get_printable(start, len) share the same buffer which is
  *       freed and newly allocated for each call.
+ *
+ * @note Oids with up to SNMP_PP_OID_INLINE_LEN subidentifiers are
+ *       stored within the object, longer ones on the heap. The pointer
+ *       returned by oidval() may therefore point into the Oid object.
  */
 class DLLOPT Oid : public SnmpSyntax
 {
@@ -140,16 +146,37 @@ class DLLOPT Oid : public SnmpSyntax
     smival.value.oid.len = 0;
     smival.value.oid.ptr = 0;
 
-    // allocate some memory for the oid
+    // get some memory for the oid
     // in this case the size to allocate is the same size as the source oid
     if (oid.smival.value.oid.len)
     {
-      smival.value.oid.ptr = (SmiLPUINT32) new unsigned long[oid.smival.value.oid.len];
+      smival.value.oid.ptr = get_oid_buffer(oid.smival.value.oid.len);
       if (smival.value.oid.ptr)
         OidCopy((SmiLPOID)&(oid.smival.value.oid), (SmiLPOID)&smival.value.oid);
     }
   }
 
+#ifdef SNMP_PP_RVALUE_REFS
+  /**
+   * Move constructor. A heap buffer of the source is taken over,
+   * oids stored inline are copied. The source is left invalid.
+   *
+   * @param oid - Source Oid
+   */
+  Oid(Oid &&oid)
+    : SnmpSyntax()
+    , iv_str(0)
+    , iv_part_str(0)
+    , m_changed(true)
+  {
+    smival.syntax = sNMP_SYNTAX_OID;
+    smival.value.oid.len = 0;
+    smival.value.oid.ptr = 0;
+
+    take_oid_ptr(oid);
+  }
+#endif
+
   /**
    * Constructor from array.
    *
@@ -167,7 +194,7 @@ class DLLOPT Oid : public SnmpSyntax
 
     if (raw_oid && (oid_len > 0))
     {
-      smival.value.oid.ptr = (SmiLPUINT32) new unsigned long[oid_len];
+      smival.value.oid.ptr = get_oid_buffer(oid_len);
       if (smival.value.oid.ptr)
       {
         smival.value.oid.len = oid_len;
@@ -177,6 +204,25 @@ class DLLOPT Oid : public SnmpSyntax
     }
   }
 
+  /**
+   * Constructor from an oid literal (see oid_literal.h). The
+   * subidentifiers are copied, no string is parsed.
+   *
+   * @param literal - An oid literal
+   */
+  template <unsigned long N>
+  Oid(const OidLiteral<N> &literal)
+    : iv_str(0)
+    , iv_part_str(0)
+    , m_changed(true)
+  {
+    smival.syntax = sNMP_SYNTAX_OID;
+    smival.value.oid.len = 0;
+    smival.value.oid.ptr = 0;
+
+    set_data(literal.data(), (unsigned int)literal.len());
+  }
+
   /**
    * Destructor.
    */
@@ -201,6 +247,16 @@ class DLLOPT Oid : public SnmpSyntax
    */
   virtual Oid& operator=(const char *dotted_oid_string);
 
+  /**
+   * Assignment from an oid literal (see oid_literal.h).
+   */
+  template <unsigned long N>
+  Oid& operator=(const OidLiteral<N> &literal)
+  {
+    set_data(literal.data(), (unsigned int)literal.len());
+    return *this;
+  }
+
   /**
    * Assign one Oid to another.
    */
@@ -208,19 +264,41 @@ class DLLOPT Oid : public SnmpSyntax
   {
     if (this == &oid) return *this;  // protect against assignment from self
 
-    delete_oid_ptr();
-
     // check for zero len on source
     if (oid.smival.value.oid.len == 0)
+    {
+      delete_oid_ptr();
       return *this;
+    }
 
-    // allocate some memory for the oid
-    smival.value.oid.ptr = (SmiLPUINT32) new unsigned long[oid.smival.value.oid.len];
-    if (smival.value.oid.ptr)
-      OidCopy((SmiLPOID)&(oid.smival.value.oid), (SmiLPOID)&smival.value.oid);
+    // reuse the current buffer if possible
+    SmiLPUINT32 new_oid = get_oid_buffer(oid.smival.value.oid.len);
+    if (new_oid == 0)
+    {
+      delete_oid_ptr();
+      return *this;
+    }
+    MEMCPY((SmiLPBYTE) new_oid,
+           (SmiLPBYTE) oid.smival.value.oid.ptr,
+           (size_t) (oid.smival.value.oid.len*sizeof(SmiUINT32)));
+    set_oid_ptr(new_oid, oid.smival.value.oid.len);
     return *this;
   }
 
+#ifdef SNMP_PP_RVALUE_REFS
+  /**
+   * Move one Oid to another. The source is left invalid.
+   */
+  Oid& operator=(Oid &&oid)
+  {
+    if (this == &oid) return *this;  // protect against assignment from self
+
+    delete_oid_ptr();
+    take_oid_ptr(oid);
+    return *this;
+  }
+#endif
+
   /**
    * Return the space needed for serialization.
    */
@@ -231,10 +309,11 @@ class DLLOPT Oid : public SnmpSyntax
    */
   bool operator == (const Oid &rhs) const
   {
-    // ensure same len, then use nCompare
+    // ensure same len, then compare the subidentifiers
     if (len() != rhs.len())
       return 0;
-    return (nCompare(rhs) == 0);
+    return (oid_common_prefix(smival.value.oid.ptr, rhs.smival.value.oid.ptr,
+                              len()) == len());
   }
 
   /**
@@ -244,37 +323,44 @@ class DLLOPT Oid : public SnmpSyntax
       { return (!(*this == rhs)); }  // just invert ==
 
   /**
-   * Overloaded less than < operator.
+   * Compare with an oid literal without creating a temporary Oid.
    */
-  bool operator < (const Oid &rhs) const
+  template <unsigned long N>
+  bool operator == (const OidLiteral<N> &rhs) const
   {
-    int result;
-    // call nCompare with the current
-    // Oidx, Oidy and len of Oidx
-    if((result = nCompare(rhs))<0)  return 1;
-    if (result > 0)    return 0;
-
-    // if here, equivalent substrings, call the shorter one <
-    return (len() < rhs.len());
+    if (len() != rhs.len())
+      return 0;
+    return (oid_common_prefix(smival.value.oid.ptr, rhs.data(),
+                              len()) == len());
   }
 
+  template <unsigned long N>
+  bool operator != (const OidLiteral<N> &rhs) const
+      { return (!(*this == rhs)); }
+
+  /**
+   * Overloaded less than < operator.
+   */
+  bool operator < (const Oid &rhs) const
+      { return (nCompare(rhs) < 0); }  // shorter one is < on equal prefix
+
   /**
    * Overloaded less than <= operator.
    */
   bool operator <= (const Oid &rhs) const
-      { return ((*this < rhs) || (*this == rhs)); }
+      { return (nCompare(rhs) <= 0); }
 
   /**
    * Overloaded greater than > operator.
    */
   bool operator > (const Oid &rhs) const
-      { return (!(*this <= rhs)); }  // just invert existing <=
+      { return (nCompare(rhs) > 0); }
 
   /**
    * Overloaded greater than >= operator.
    */
   bool operator >= (const Oid &rhs) const
-      { return (!(*this < rhs)); }  // just invert existing <
+      { return (nCompare(rhs) >= 0); }
 
 #if 0
   /**
@@ -375,36 +461,31 @@ class DLLOPT Oid : public SnmpSyntax
   Oid& operator+=(const Oid &o)
   {
     SmiLPUINT32 new_oid;
+    unsigned long old_len = smival.value.oid.len;
 
     if (o.smival.value.oid.len == 0)
       return *this;
 
-    new_oid = (SmiLPUINT32) new unsigned long[smival.value.oid.len + o.smival.value.oid.len];
+    // stays in the inline buffer as long as the result fits into it
+    new_oid = get_oid_buffer(old_len + o.smival.value.oid.len);
     if (new_oid == 0)
     {
       delete_oid_ptr();
       return *this;
     }
 
-    if (smival.value.oid.ptr)
-    {
+    if ((new_oid != smival.value.oid.ptr) && old_len)
       MEMCPY((SmiLPBYTE) new_oid,
              (SmiLPBYTE) smival.value.oid.ptr,
-             (size_t) (smival.value.oid.len*sizeof(SmiUINT32)));
-
-      delete [] smival.value.oid.ptr;
-    }
-
-    // out with the old, in with the new...
-    smival.value.oid.ptr = new_oid;
+             (size_t) (old_len*sizeof(SmiUINT32)));
 
-    MEMCPY((SmiLPBYTE) &new_oid[smival.value.oid.len],
+    // copy before the old buffer is freed, o may be this object
+    MEMCPY((SmiLPBYTE) &new_oid[old_len],
            (SmiLPBYTE) o.smival.value.oid.ptr,
            (size_t) (o.smival.value.oid.len*sizeof(SmiUINT32)));
 
-    smival.value.oid.len += o.smival.value.oid.len;
-
-    m_changed = true;
+    // out with the old, in with the new...
+    set_oid_ptr(new_oid, old_len + o.smival.value.oid.len);
     return *this;
   }
 
@@ -489,44 +570,11 @@ class DLLOPT Oid : public SnmpSyntax
    */
   int nCompare(const unsigned long n, const Oid &o) const
   {
-    unsigned long length = n;
-    bool reduced_len = false;
-
-    // If both oids are too short, decrease len
-    if ((smival.value.oid.len < length) && (o.smival.value.oid.len < length))
-      length = smival.value.oid.len < o.smival.value.oid.len ? o.smival.value.oid.len : smival.value.oid.len;
-
-    if (length == 0) return 0; // equal
-      
-    // only compare for the minimal length
-    if (length > smival.value.oid.len)
-    {
-      length = smival.value.oid.len;
-      reduced_len = true;
-    }
-    if (length > o.smival.value.oid.len)
-    {
-      length = o.smival.value.oid.len;
-      reduced_len = true;
-    }
-
-    unsigned long z = 0;
-    while (z < length)
-    {
-      if (smival.value.oid.ptr[z] < o.smival.value.oid.ptr[z])
-        return -1;                              // less than
-      if (smival.value.oid.ptr[z] > o.smival.value.oid.ptr[z])
-        return 1;                               // greater than
-      ++z;
-    }
-
-    // if we truncated the len then these may not be equal
-    if (reduced_len)
-    {
-      if (smival.value.oid.len < o.smival.value.oid.len) return -1;
-      if (smival.value.oid.len > o.smival.value.oid.len) return 1;
-    }
-    return 0;                                 // equal
+    // compare the oids truncated to n subvalues
+    return oid_compare(smival.value.oid.ptr,
+                       (smival.value.oid.len < n) ? smival.value.oid.len : n,
+                       o.smival.value.oid.ptr,
+                       (o.smival.value.oid.len < n) ? o.smival.value.oid.len : n);
   }
 
   /**
@@ -539,42 +587,8 @@ class DLLOPT Oid : public SnmpSyntax
    */
   int nCompare(const Oid &o) const
   {
-    unsigned long length;
-    bool reduced_len = false;
-
-    length = smival.value.oid.len < o.smival.value.oid.len ? o.smival.value.oid.len : smival.value.oid.len;
-
-    if (length == 0) return 0; // equal
-      
-    // only compare for the minimal length
-    if (length > smival.value.oid.len)
-    {
-      length = smival.value.oid.len;
-      reduced_len = true;
-    }
-    if (length > o.smival.value.oid.len)
-    {
-      length = o.smival.value.oid.len;
-      reduced_len = true;
-    }
-
-    unsigned long z = 0;
-    while (z < length)
-    {
-      if (smival.value.oid.ptr[z] < o.smival.value.oid.ptr[z])
-        return -1;                              // less than
-      if (smival.value.oid.ptr[z] > o.smival.value.oid.ptr[z])
-        return 1;                               // greater than
-      ++z;
-    }
-
-    // if we truncated the len then these may not be equal
-    if (reduced_len)
-    {
-      if (smival.value.oid.len < o.smival.value.oid.len) return -1;
-      if (smival.value.oid.len > o.smival.value.oid.len) return 1;
-    }
-    return 0;                                 // equal
+    return oid_compare(smival.value.oid.ptr, smival.value.oid.len,
+                       o.smival.value.oid.ptr, o.smival.value.oid.len);
   }
 
   /**
@@ -692,11 +706,42 @@ class DLLOPT Oid : public SnmpSyntax
    */
   inline void delete_oid_ptr();
 
+  /**
+   * Get a buffer for n subidentifiers. This is the inline buffer if
+   * n is not greater than SNMP_PP_OID_INLINE_LEN, the current heap
+   * buffer if it is large enough or a new buffer from the heap.
+   * The buffer is not assigned to the oid, use set_oid_ptr() for this.
+   *
+   * @param n - Number of subidentifiers
+   * @return The buffer or NULL if no memory could be allocated
+   */
+  inline SmiLPUINT32 get_oid_buffer(const unsigned long n);
+
+  /**
+   * Set the internal oid pointer and length. The old buffer is freed
+   * if it is not the new one.
+   *
+   * @param new_oid - Buffer returned by get_oid_buffer()
+   * @param n       - The new length
+   */
+  inline void set_oid_ptr(SmiLPUINT32 new_oid, const unsigned long n);
+
+  /**
+   * Take over the value of another oid, which is left invalid.
+   * This oid must not have a buffer.
+   *
+   * @param oid - The source oid
+   */
+  inline void take_oid_ptr(Oid &oid);
+
   //----[ instance variables ]
 
   SNMP_PP_MUTABLE char *iv_str;      // used for returning complete oid string
   SNMP_PP_MUTABLE char *iv_part_str; // used for returning part oid string
   SNMP_PP_MUTABLE bool m_changed;
+#if SNMP_PP_OID_INLINE_LEN > 0
+  SmiUINT32 iv_inline[SNMP_PP_OID_INLINE_LEN]; // storage for short oids
+#endif
 };
 
 //-----------[ End Oid Class ]-------------------------------------
@@ -709,13 +754,64 @@ inline void Oid::delete_oid_ptr()
   // delete the old value
   if (smival.value.oid.ptr)
   {
-    delete [] smival.value.oid.ptr;
+#if SNMP_PP_OID_INLINE_LEN > 0
+    if (smival.value.oid.ptr != iv_inline)
+#endif
+      delete [] smival.value.oid.ptr;
     smival.value.oid.ptr = 0;
   }
   smival.value.oid.len = 0;
   m_changed = true;
 }
 
+inline SmiLPUINT32 Oid::get_oid_buffer(const unsigned long n)
+{
+#if SNMP_PP_OID_INLINE_LEN > 0
+  if (n <= SNMP_PP_OID_INLINE_LEN)
+    return iv_inline;
+
+  if (smival.value.oid.ptr && (smival.value.oid.ptr != iv_inline) &&
+      (n <= smival.value.oid.len))
+    return smival.value.oid.ptr;
+#else
+  if (smival.value.oid.ptr && (n <= smival.value.oid.len))
+    return smival.value.oid.ptr;
+#endif
+  return (SmiLPUINT32) new unsigned long[n];
+}
+
+inline void Oid::set_oid_ptr(SmiLPUINT32 new_oid, const unsigned long n)
+{
+  if (smival.value.oid.ptr != new_oid)
+  {
+    delete_oid_ptr();
+    smival.value.oid.ptr = new_oid;
+  }
+  smival.value.oid.len = n;
+  m_changed = true;
+}
+
+inline void Oid::take_oid_ptr(Oid &oid)
+{
+#if SNMP_PP_OID_INLINE_LEN > 0
+  if (oid.smival.value.oid.ptr == oid.iv_inline)
+  {
+    MEMCPY((SmiLPBYTE) iv_inline,
+           (SmiLPBYTE) oid.iv_inline,
+           (size_t) (oid.smival.value.oid.len*sizeof(SmiUINT32)));
+    smival.value.oid.ptr = iv_inline;
+  }
+  else
+#endif
+    smival.value.oid.ptr = oid.smival.value.oid.ptr;
+  smival.value.oid.len = oid.smival.value.oid.len;
+  m_changed = true;
+
+  oid.smival.value.oid.ptr = 0;
+  oid.smival.value.oid.len = 0;
+  oid.m_changed = true;
+}
+
 #ifdef SNMP_PP_NAMESPACE
 } // end of namespace Snmp_pp
 #endif 
@@ -0,0 +1,207 @@
+/*_############################################################################
+  _##
+  _##  oid_cmp.h
+  _##
+  _##  SNMP++ v3.3
+  _##  -----------------------------------------------
+  _##  Copyright (c) 2001-2013 Jochen Katz, Frank Fock
+  _##
+  _##  This software is based on SNMP++2.6 from Hewlett Packard:
+  _##
+  _##    Copyright (c) 1996
+  _##    Hewlett-Packard Company
+  _##
+  _##  ATTENTION: USE OF THIS SOFTWARE IS SUBJECT TO THE FOLLOWING TERMS.
+  _##  Permission to use, copy, modify, distribute and/or sell this software
+  _##  and/or its documentation is hereby granted without fee. User agrees
+  _##  to display the above copyright notice and this license notice in all
+  _##  copies of the software and any documentation of the software. User
+  _##  agrees to assume all liability for the use of the software;
+  _##  Hewlett-Packard and Jochen Katz make no representations about the
+  _##  suitability of this software for any purpose. It is provided
+  _##  "AS-IS" without warranty of any kind, either express or implied. User
+  _##  hereby grants a royalty-free license to any and all derivatives based
+  _##  upon this software code base.
+  _##
+  _##########################################################################*/
+
+/*
+  Comparison functions for arrays of oid subidentifiers.
+
+  The functions search the first differing subidentifier with SSE2 or
+  AVX2 instructions if the compiler targets them (x86/x64) and fall back
+  to a plain loop otherwise. Define SNMP_PP_NO_SIMD to always use the
+  plain loop.
+*/
+
+#ifndef _OID_CMP_H_
+#define _OID_CMP_H_
+
+//----[ includes ]-----------------------------------------------------
+#include "snmp_pp/config_snmp_pp.h"
+#include "snmp_pp/smi.h"
+
+#ifndef SNMP_PP_NO_SIMD
+#  if defined(__AVX2__)
+#    define SNMP_PP_OID_CMP_AVX2
+#    define SNMP_PP_OID_CMP_SSE2
+#    include <immintrin.h>
+#  elif defined(__SSE2__) || defined(_M_X64) || \
+        (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#    define SNMP_PP_OID_CMP_SSE2
+#    include <emmintrin.h>
+#  endif
+#  if defined(SNMP_PP_OID_CMP_SSE2) && defined(_MSC_VER)
+#    include <intrin.h>
+#  endif
+#endif
+
+#ifdef SNMP_PP_NAMESPACE
+namespace Snmp_pp {
+#endif
+
+#ifdef SNMP_PP_OID_CMP_SSE2
+/**
+ * Return the index of the lowest bit set in a non zero mask.
+ */
+inline unsigned int oid_cmp_first_bit(unsigned int mask)
+{
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return (unsigned int)index;
+#else
+  return (unsigned int)__builtin_ctz(mask);
+#endif
+}
+#endif
+
+/**
+ * Get the number of leading subidentifiers that are equal in both arrays.
+ *
+ * @param a - First array of subidentifiers
+ * @param b - Second array of subidentifiers
+ * @param n - Number of subidentifiers to compare (both arrays must
+ *            have at least n elements)
+ *
+ * @return Index of the first differing subidentifier or n if the first
+ *         n subidentifiers are equal
+ */
+inline unsigned long oid_common_prefix(const SmiUINT32 *a,
+                                       const SmiUINT32 *b,
+                                       const unsigned long n)
+{
+  unsigned long i = 0;
+
+#ifdef SNMP_PP_OID_CMP_AVX2
+  // 32 bytes per step, the byte mask of the first difference gives the
+  // index of the subidentifier
+  for (; i + 32 / sizeof(SmiUINT32) <= n; i += 32 / sizeof(SmiUINT32))
+  {
+    __m256i va = _mm256_loadu_si256((const __m256i *)(a + i));
+    __m256i vb = _mm256_loadu_si256((const __m256i *)(b + i));
+    unsigned int diff =
+      ~(unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb));
+    if (diff)
+      return i + oid_cmp_first_bit(diff) / sizeof(SmiUINT32);
+  }
+#endif
+#ifdef SNMP_PP_OID_CMP_SSE2
+  for (; i + 16 / sizeof(SmiUINT32) <= n; i += 16 / sizeof(SmiUINT32))
+  {
+    __m128i va = _mm_loadu_si128((const __m128i *)(a + i));
+    __m128i vb = _mm_loadu_si128((const __m128i *)(b + i));
+    unsigned int diff =
+      ~(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) & 0xFFFF;
+    if (diff)
+      return i + oid_cmp_first_bit(diff) / sizeof(SmiUINT32);
+  }
+#endif
+
+  for (; i < n; ++i)
+    if (a[i] != b[i])
+      break;
+  return i;
+}
+
+/**
+ * Compare two arrays of subidentifiers in lexicographical order.
+ *
+ * @param a     - First array of subidentifiers
+ * @param a_len - Length of the first array
+ * @param b     - Second array of subidentifiers
+ * @param b_len - Length of the second array
+ *
+ * @return 0 if equal / -1 if a is less than b / 1 if a is greater
+ */
+inline int oid_compare(const SmiUINT32 *a, const unsigned long a_len,
+                       const SmiUINT32 *b, const unsigned long b_len)
+{
+  unsigned long n = (a_len < b_len) ? a_len : b_len;
+  unsigned long i = oid_common_prefix(a, b, n);
+
+  if (i < n)
+    return (a[i] < b[i]) ? -1 : 1;
+  if (a_len < b_len) return -1;
+  if (a_len > b_len) return 1;
+  return 0;
+}
+
+/**
+ * Check if the first array is a prefix of the second one.
+ *
+ * @param prefix     - Array of subidentifiers of the prefix
+ * @param prefix_len - Length of the prefix
+ * @param a          - Array of subidentifiers to check
+ * @param a_len      - Length of a
+ *
+ * @return true if a starts with all subidentifiers of prefix
+ */
+inline bool oid_prefix_match(const SmiUINT32 *prefix,
+                             const unsigned long prefix_len,
+                             const SmiUINT32 *a, const unsigned long a_len)
+{
+  if (a_len < prefix_len) return false;
+  return (oid_common_prefix(prefix, a, prefix_len) == prefix_len);
+}
+
+/**
+ * Check if two arrays of subidentifiers are equal, ignoring the
+ * subidentifiers that are excluded by a mask. The mask is used like
+ * the vacmViewTreeFamilyMask and snmpNotifyFilterMask: Bit 7 of the
+ * first octet belongs to the first subidentifier, a zero bit excludes
+ * the subidentifier from the comparison. Subidentifiers beyond the end
+ * of the mask are always compared.
+ *
+ * @param a        - First array of subidentifiers
+ * @param b        - Second array of subidentifiers
+ * @param n        - Number of subidentifiers to compare (both arrays
+ *                   must have at least n elements)
+ * @param mask     - The mask (may be NULL if mask_len is 0)
+ * @param mask_len - Length of the mask in bytes
+ *
+ * @return true if all subidentifiers selected by the mask are equal
+ */
+inline bool oid_masked_match(const SmiUINT32 *a, const SmiUINT32 *b,
+                             const unsigned long n,
+                             const unsigned char *mask,
+                             const unsigned long mask_len)
+{
+  unsigned long i = oid_common_prefix(a, b, n);
+
+  while (i < n)
+  {
+    // a differing subidentifier is only ok if the mask excludes it
+    if ((i >= mask_len * 8) || (mask[i / 8] & (0x80 >> (i % 8))))
+      return false;
+    ++i;
+    i += oid_common_prefix(a + i, b + i, n - i);
+  }
+  return true;
+}
+
+#ifdef SNMP_PP_NAMESPACE
+} // end of namespace Snmp_pp
+#endif
+
+#endif // _OID_CMP_H_
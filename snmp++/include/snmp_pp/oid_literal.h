@@ -0,0 +1,166 @@
+/*_############################################################################
+  _##
+  _##  oid_literal.h
+  _##
+  _##  SNMP++ v3.3
+  _##  -----------------------------------------------
+  _##  Copyright (c) 2001-2013 Jochen Katz, Frank Fock
+  _##
+  _##  This software is based on SNMP++2.6 from Hewlett Packard:
+  _##
+  _##    Copyright (c) 1996
+  _##    Hewlett-Packard Company
+  _##
+  _##  ATTENTION: USE OF THIS SOFTWARE IS SUBJECT TO THE FOLLOWING TERMS.
+  _##  Permission to use, copy, modify, distribute and/or sell this software
+  _##  and/or its documentation is hereby granted without fee. User agrees
+  _##  to display the above copyright notice and this license notice in all
+  _##  copies of the software and any documentation of the software. User
+  _##  agrees to assume all liability for the use of the software;
+  _##  Hewlett-Packard and Jochen Katz make no representations about the
+  _##  suitability of this software for any purpose. It is provided
+  _##  "AS-IS" without warranty of any kind, either express or implied. User
+  _##  hereby grants a royalty-free license to any and all derivatives based
+  _##  upon this software code base.
+  _##
+  _##########################################################################*/
+
+/*
+  Oid literals: dotted oid strings that are parsed into a fixed array
+  of subidentifiers.
+
+  With a C++14 compiler the parsing is done at compile time, so a
+  literal defined with SNMP_PP_OID_LITERAL is a constant and an invalid
+  oid string is a compile error. Older compilers parse the string once
+  when the literal is initialized. Define SNMP_PP_NO_CONSTEXPR to
+  always parse at runtime.
+
+  Example:
+
+    static SNMP_PP_OID_LITERAL(sysUpTimeOid, "1.3.6.1.2.1.1.3.0");
+
+    Oid oid(sysUpTimeOid);              // no string parsing
+    if (vb.get_oid() == sysUpTimeOid)   // no temporary Oid
+*/
+
+#ifndef _OID_LITERAL_H_
+#define _OID_LITERAL_H_
+
+//----[ includes ]-----------------------------------------------------
+#include "snmp_pp/config_snmp_pp.h"
+#include "snmp_pp/smi.h"
+
+// Parse oid literals at compile time if the compiler supports
+// constexpr functions with loops (C++14)
+#if !defined(SNMP_PP_NO_CONSTEXPR) && \
+    ((defined(__cpp_constexpr) && (__cpp_constexpr >= 201304)) || \
+     (defined(_MSC_VER) && (_MSC_VER >= 1910)))
+#define SNMP_PP_CONSTEXPR_OID
+#define SNMP_PP_CONSTEXPR       constexpr
+#define SNMP_PP_CONSTEXPR_CONST constexpr
+#else
+#define SNMP_PP_CONSTEXPR
+#define SNMP_PP_CONSTEXPR_CONST const
+#endif
+
+#ifdef SNMP_PP_NAMESPACE
+namespace Snmp_pp {
+#endif
+
+/**
+ * Called for an invalid oid literal. The function is not constexpr,
+ * so an invalid literal cannot be a compile time constant.
+ */
+inline void oid_literal_invalid() {}
+
+/**
+ * An oid parsed from a dotted oid string into a fixed array.
+ *
+ * N is the size of the string including the terminating zero, which
+ * limits the number of subidentifiers to N/2. Use the macro
+ * SNMP_PP_OID_LITERAL to get N right.
+ *
+ * Only plain dotted strings like "1.3.6.1.2.1.1.1.0" are supported,
+ * other strings result in a literal of length 0 (an invalid Oid).
+ */
+template <unsigned long N>
+class OidLiteral
+{
+ public:
+  /**
+   * Parse the given dotted oid string.
+   *
+   * @param dotted - A string literal of size N, for example "1.3.6.1"
+   */
+  SNMP_PP_CONSTEXPR OidLiteral(const char *dotted)
+    : subids(), length(0)
+  {
+    SmiUINT32 value = 0;
+    bool digits = false;
+
+    for (const char *p = dotted; ; ++p)
+    {
+      if ((*p >= '0') && (*p <= '9'))
+      {
+        // subidentifiers are 32 bit values
+        if ((value > 429496729ul) || ((value == 429496729ul) && (*p > '5')))
+          break;
+        value = value * 10 + (SmiUINT32)(*p - '0');
+        digits = true;
+      }
+      else if ((*p == '.') || (*p == 0))
+      {
+        if (!digits)
+        {
+          if ((*p == 0) && (length == 0))
+            return; // empty string
+          break;
+        }
+        if (length >= N / 2 + 1)
+          break;
+        subids[length++] = value;
+        if (*p == 0)
+          return;
+        value = 0;
+        digits = false;
+      }
+      else
+        break;
+    }
+    oid_literal_invalid();
+    length = 0;
+  }
+
+  /**
+   * Get the subidentifiers.
+   */
+  SNMP_PP_CONSTEXPR const SmiUINT32 *data() const { return subids; }
+
+  /**
+   * Get the number of subidentifiers.
+   */
+  SNMP_PP_CONSTEXPR unsigned long len() const { return length; }
+
+ private:
+  SmiUINT32 subids[N / 2 + 1];
+  unsigned long length;
+};
+
+#ifdef SNMP_PP_NAMESPACE
+} // end of namespace Snmp_pp
+#define SNMP_PP_OID_LITERAL_TYPE(dotted) Snmp_pp::OidLiteral<sizeof(dotted)>
+#else
+#define SNMP_PP_OID_LITERAL_TYPE(dotted) OidLiteral<sizeof(dotted)>
+#endif
+
+/**
+ * Define an oid literal.
+ *
+ * @param name   - Name of the defined constant
+ * @param dotted - A string literal (or a macro defined as one),
+ *                 for example "1.3.6.1.2.1.1.1.0"
+ */
+#define SNMP_PP_OID_LITERAL(name, dotted) \
+  SNMP_PP_CONSTEXPR_CONST SNMP_PP_OID_LITERAL_TYPE(dotted) name(dotted)
+
+#endif // _OID_LITERAL_H_
@@ -71,6 +71,7 @@ class Vb;
 
 #define PDU_MAX_RID 32767         ///< max request id to use
 #define PDU_MIN_RID 1000          ///< min request id to use
+#define PDU_MAX_WIDE_RID 2147483647 ///< max request id in wide id mode
 
 //=======================================================================
 //		     Pdu Class
@@ -106,7 +107,19 @@ class DLLOPT Pdu
    *
    * @param pdu - source pdu object
    */
-  Pdu(const Pdu &pdu) : vbs(0), vbs_size(0), vb_count(0) { *this = pdu; };
+  Pdu(const Pdu &pdu)
+    : vbs(0), vbs_size(0), vb_count(0),
+      vb_arena(0), vb_arena_size(0), vb_arena_used(0) { *this = pdu; };
+
+#ifdef SNMP_PP_RVALUE_REFS
+  /**
+   * Constructor taking over the vbs and values of another Pdu.
+   * The source pdu is left as a valid empty Pdu object.
+   *
+   * @param pdu - source pdu object
+   */
+  Pdu(Pdu &&pdu);
+#endif
 
   /**
    * Destructor
@@ -120,6 +133,16 @@ class DLLOPT Pdu
    */
   Pdu& operator=(const Pdu &pdu);
 
+#ifdef SNMP_PP_RVALUE_REFS
+  /**
+   * Move assignment operator. The vbs of pdu are taken over, the source
+   * pdu is left as a valid empty Pdu object.
+   *
+   * @param pdu - Pdu that should be moved to this object
+   */
+  Pdu& operator=(Pdu &&pdu);
+#endif
+
   /**
    * Append a vb to the pdu.
    *
@@ -127,6 +150,15 @@ class DLLOPT Pdu
    */
   Pdu& operator+=(const Vb &vb);
 
+#ifdef SNMP_PP_RVALUE_REFS
+  /**
+   * Append a vb to the pdu, taking over its oid and value.
+   *
+   * @param vb - The Vb that should be added (as last vb) to the pdu
+   */
+  Pdu& operator+=(Vb &&vb);
+#endif
+
   /**
    * Clone a Pdu object.
    *
@@ -197,6 +229,20 @@ class DLLOPT Pdu
    */
   int set_vb(Vb const &vb, const int index);
 
+#ifdef SNMP_PP_RVALUE_REFS
+  /**
+   * Set a particular vb, taking over the oid and value of vb.
+   *
+   * If this method returns FALSE, the pdu and vb have not been modified.
+   *
+   * @param vb - Source vb
+   * @param index - The vb to set (zero is the first vb)
+   *
+   * @return TRUE on success
+   */
+  int set_vb(Vb &&vb, const int index);
+#endif
+
   /**
    * Get the number of vbs.
    *
@@ -477,6 +523,44 @@ class DLLOPT Pdu
    */
   void clear();
 
+  /**
+   * Make room for at least count Vb objects.
+   *
+   * The Vb objects are allocated as one contiguous block, so adding
+   * up to count vbs to the pdu does not need any further memory
+   * allocation for the Vb objects and their (small) values. The block
+   * is released in one go when the pdu is destroyed. Vbs added beyond
+   * the reserved size are allocated one by one as before.
+   *
+   * @note References and pointers to the vbs of the pdu (returned by
+   *       operator[]() or get_vb()) are invalid after this call.
+   *
+   * @param count - The number of vbs the pdu should be able to hold
+   * @return true on success
+   */
+  bool reserve(const int count);
+
+  /**
+   * Get the number of vbs the pdu can hold before further Vb objects
+   * are allocated one by one (see reserve()).
+   */
+  int get_reserved() const
+    { int n = vb_count + vb_arena_size - vb_arena_used;
+      return (n < vbs_size) ? n : vbs_size; };
+
+  /**
+   * Release the memory that is not needed for the current vbs.
+   *
+   * The current vbs are moved into a block that exactly fits, if the
+   * pdu has no vbs all memory for vbs is released.
+   *
+   * @note References and pointers to the vbs of the pdu (returned by
+   *       operator[]() or get_vb()) are invalid after this call.
+   *
+   * @return true on success
+   */
+  bool shrink();
+
   /**
    * Does the type of response match the type of request.
    */
@@ -492,9 +576,50 @@ class DLLOPT Pdu
    */
   bool extend_vbs();
 
+  /**
+   * Get a new Vb object for this pdu, that is a copy of vb.
+   * The object is taken from the reserved block if there is room
+   * left, otherwise it is allocated with new.
+   *
+   * @note The returned object has to be freed through release_vb().
+   */
+  Vb *alloc_vb(const Vb &vb);
+
+#ifdef SNMP_PP_RVALUE_REFS
+  /**
+   * Get a new Vb object for this pdu that takes over oid and value
+   * of vb.
+   *
+   * @note The returned object has to be freed through release_vb().
+   */
+  Vb *alloc_vb(Vb &&vb);
+#endif
+
+  /**
+   * Free a Vb object that was returned by alloc_vb().
+   */
+  void release_vb(Vb *vb);
+
+  /**
+   * Free all vbs of the pdu. The reserved block is kept for reuse.
+   */
+  void free_vbs();
+
+  /**
+   * Move the vbs into a new block of the given size.
+   *
+   * @param count - New size of the vbs array and the block, must not
+   *                be less than vb_count
+   * @return true on success
+   */
+  bool resize_vb_arena(const int count);
+
   Vb **vbs;                    // pointer to array of Vbs
   int vbs_size;                // Size of array
   int vb_count;                // count of Vbs
+  Vb *vb_arena;                // contiguous block of Vbs (see reserve())
+  int vb_arena_size;           // Size of block
+  int vb_arena_used;           // count of Vbs handed out from the block
   int error_status;            // SMI error status
   int error_index;             // SMI error index
   bool validity;               // valid boolean
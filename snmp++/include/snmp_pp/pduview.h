@@ -0,0 +1,250 @@
+/*_############################################################################
+  _##
+  _##  pduview.h
+  _##
+  _##  SNMP++ v3.3
+  _##  -----------------------------------------------
+  _##  Copyright (c) 2001-2013 Jochen Katz, Frank Fock
+  _##
+  _##  This software is based on SNMP++2.6 from Hewlett Packard:
+  _##
+  _##    Copyright (c) 1996
+  _##    Hewlett-Packard Company
+  _##
+  _##  ATTENTION: USE OF THIS SOFTWARE IS SUBJECT TO THE FOLLOWING TERMS.
+  _##  Permission to use, copy, modify, distribute and/or sell this software
+  _##  and/or its documentation is hereby granted without fee. User agrees
+  _##  to display the above copyright notice and this license notice in all
+  _##  copies of the software and any documentation of the software. User
+  _##  agrees to assume all liability for the use of the software;
+  _##  Hewlett-Packard and Jochen Katz make no representations about the
+  _##  suitability of this software for any purpose. It is provided
+  _##  "AS-IS" without warranty of any kind, either express or implied. User
+  _##  hereby grants a royalty-free license to any and all derivatives based
+  _##  upon this software code base.
+  _##
+  _##########################################################################*/
+
+#ifndef _PDUVIEW_H_
+#define _PDUVIEW_H_
+
+//----[ includes ]-----------------------------------------------------
+#include "snmp_pp/config_snmp_pp.h"
+#include "snmp_pp/snmperrs.h"
+#include "snmp_pp/oid.h"
+#include "snmp_pp/vb.h"
+#include "snmp_pp/pdu.h"
+#include "snmp_pp/target.h"
+
+#ifdef SNMP_PP_NAMESPACE
+namespace Snmp_pp {
+#endif
+
+/**
+ * View of an encoded variable binding.
+ *
+ * The view only stores pointers into the buffer that holds the encoded
+ * variable binding, so the buffer must not be changed or freed as long
+ * as the view is used. The oid and the value are decoded on request,
+ * into objects of the caller or into Snmp++ objects through get_vb().
+ */
+class DLLOPT VbView
+{
+ public:
+  VbView()
+    : oid_tlv(0), oid_tlv_length(0), value_tlv(0), value_tlv_length(0),
+      value_data(0), value_length(0), value_type(0) {};
+
+  /**
+   * Check one encoded variable binding and set the view to it.
+   *
+   * @param data   - Start of the variable binding (the sequence)
+   * @param length - IN: number of bytes available at data,
+   *                 OUT: number of bytes following the variable binding
+   *
+   * @return Pointer to the byte following the variable binding or
+   *         NULL if the variable binding is not valid
+   */
+  const unsigned char *parse(const unsigned char *data, int *length);
+
+  /**
+   * Get the syntax of the value (sNMP_SYNTAX_xxx).
+   */
+  SmiUINT32 get_syntax() const { return value_type; };
+
+  /**
+   * Get the oid.
+   */
+  void get_oid(Oid &oid) const;
+
+  /**
+   * Compare the oid without decoding it into an Oid object.
+   *
+   * @return true if the oid is equal to the given one
+   */
+  bool oid_equals(const Oid &oid) const;
+
+  /**
+   * Check if the oid starts with (or is equal to) the given prefix.
+   */
+  bool oid_starts_with(const Oid &prefix) const;
+
+  /**
+   * Get the contents of the encoded value (e.g. the octets of an
+   * OCTET STRING) without copying them.
+   */
+  const unsigned char *get_value_data() const { return value_data; };
+  int get_value_length() const { return value_length; };
+
+  /**
+   * Get the value of a signed integer syntax (INTEGER).
+   *
+   * @return SNMP_CLASS_SUCCESS or SNMP_CLASS_INVALID if the value has
+   *         another syntax
+   */
+  int get_value(long &value) const;
+
+  /**
+   * Get the value of an unsigned integer syntax (Counter32, Gauge32,
+   * TimeTicks).
+   *
+   * @return SNMP_CLASS_SUCCESS or SNMP_CLASS_INVALID if the value has
+   *         another syntax
+   */
+  int get_value(unsigned long &value) const;
+
+  /**
+   * Decode the oid and the value into the given Vb.
+   */
+  void get_vb(Vb &vb) const;
+
+ private:
+  const unsigned char *oid_tlv;    // oid, including type and length
+  int oid_tlv_length;
+  const unsigned char *value_tlv;  // value, including type and length
+  int value_tlv_length;
+  const unsigned char *value_data; // contents of the value
+  int value_length;
+  SmiUINT32 value_type;
+};
+
+/**
+ * View of an encoded SNMPv1 or SNMPv2c message.
+ *
+ * parse() checks the whole message once, including all variable
+ * bindings, but does not decode the variable bindings. They can then
+ * be accessed through VbView objects, which only decode what is
+ * requested. Accessing the variable bindings in ascending order takes
+ * constant time for each one.
+ *
+ * The view points into the buffer passed to parse(), so the buffer
+ * must not be changed or freed as long as the view is used.
+ *
+ * SNMPv3 messages are not supported, as the scoped PDU has to be
+ * decrypted and its security parameters have to be checked first.
+ * Use SnmpMessage::unloadv3() for them.
+ */
+class DLLOPT PduView
+{
+ public:
+  PduView() { clear(); };
+
+  /**
+   * Check an encoded message and set the view to it.
+   *
+   * @param data   - The message
+   * @param length - The length of the message
+   *
+   * @return SNMP_CLASS_SUCCESS, SNMP_CLASS_ASN1ERROR if the message is
+   *         not valid or SNMP_CLASS_BADVERSION if it is not a SNMPv1 or
+   *         SNMPv2c message
+   */
+  int parse(const unsigned char *data, const int length);
+
+  /**
+   * Reset the view.
+   */
+  void clear();
+
+  /**
+   * Check if the view has been set to a valid message.
+   */
+  bool valid() const { return vbs_data != 0; };
+
+  snmp_version get_version() const { return version; };
+
+  /**
+   * Get the community without copying it.
+   */
+  const unsigned char *get_community_data() const { return community_data; };
+  int get_community_length() const { return community_length; };
+
+  /**
+   * Get the type of the PDU (sNMP_PDU_xxx).
+   */
+  unsigned short get_type() const { return type; };
+
+  /**
+   * Get request id, error status and error index. These are zero for
+   * SNMPv1 traps.
+   */
+  long get_request_id() const { return request_id; };
+  long get_error_status() const { return error_status; };
+  long get_error_index() const { return error_index; };
+
+  /**
+   * Get the number of variable bindings.
+   */
+  int get_vb_count() const { return vb_count; };
+
+  /**
+   * Set the view to the variable binding with the given index.
+   *
+   * @return SNMP_CLASS_SUCCESS or SNMP_CLASS_INVALID if there is no
+   *         variable binding with the index
+   */
+  int get_vb(const int index, VbView &vb);
+
+  /**
+   * Decode the message into the given Pdu. The variable bindings
+   * sysUpTime.0 and snmpTrapOID.0 of SNMPv2 traps and informs are
+   * converted into the notify timestamp and id of the Pdu, the fields
+   * of SNMPv1 traps are converted into timestamp, id, enterprise and
+   * v1 trap address of the Pdu.
+   *
+   * @return SNMP_CLASS_SUCCESS or SNMP_CLASS_INVALID
+   */
+  int get_pdu(Pdu &pdu) const;
+
+ private:
+  snmp_version version;
+  const unsigned char *community_data;
+  int community_length;
+  unsigned short type;
+  long request_id;
+  long error_status;
+  long error_index;
+
+  // SNMPv1 trap
+  const unsigned char *enterprise_tlv;
+  int enterprise_tlv_length;
+  unsigned char agent_addr[4];
+  long generic_trap;
+  long specific_trap;
+  unsigned long timestamp;
+
+  const unsigned char *vbs_data;  // contents of the vb sequence
+  int vbs_length;
+  int vb_count;
+
+  // position of the last accessed vb, for sequential access
+  int cursor_index;
+  const unsigned char *cursor_data;
+  int cursor_length;
+};
+
+#ifdef SNMP_PP_NAMESPACE
+} // end of namespace Snmp_pp
+#endif
+
+#endif // _PDUVIEW_H_
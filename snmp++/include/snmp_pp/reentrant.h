@@ -77,6 +77,85 @@ class DLLOPT SnmpSynchronize {
 
 #define REENTRANT(x) { SnmpSynchronize _synchronize(*this); x }
 
+/**
+ * A lock that can be held by many readers or by one writer. Only
+ * pthreads provide a real reader/writer lock, on other systems the
+ * lock is exclusive for readers, too.
+ */
+class DLLOPT SnmpReadWriteLock {
+
+ public:
+  SnmpReadWriteLock();
+  ~SnmpReadWriteLock();
+
+  void read_lock();
+  void write_lock();
+  void unlock();
+
+ private:
+#if defined(_THREADS) && !defined(WIN32) && !(defined (CPU) && CPU == PPC603)
+  pthread_rwlock_t      _rwlock;
+#else
+  SnmpSynchronized      _lock;
+#endif
+};
+
+class DLLOPT SnmpReadLock {
+
+ public:
+  SnmpReadLock(SnmpReadWriteLock& rw) : l(rw) { l.read_lock(); };
+  ~SnmpReadLock() { l.unlock(); }
+
+ protected:
+  SnmpReadWriteLock& l;
+};
+
+class DLLOPT SnmpWriteLock {
+
+ public:
+  SnmpWriteLock(SnmpReadWriteLock& rw) : l(rw) { l.write_lock(); };
+  ~SnmpWriteLock() { l.unlock(); }
+
+ protected:
+  SnmpReadWriteLock& l;
+};
+
+/**
+ * A counter that can be incremented concurrently. With GCC compatible
+ * compilers and Visual C++ atomic operations are used, otherwise the
+ * counter is protected by a mutex.
+ */
+class DLLOPT SnmpAtomicCounter {
+
+ public:
+  SnmpAtomicCounter(const unsigned long value = 0) : m_value(value) {};
+
+  /**
+   * Increment the counter and return the new value.
+   */
+  unsigned long increment();
+
+  /**
+   * Get the current value of the counter.
+   */
+  unsigned long get();
+
+  /**
+   * Set the value of the counter.
+   */
+  void set(const unsigned long value);
+
+ private:
+#if defined(_THREADS) && defined(_MSC_VER)
+  volatile LONG m_value;
+#else
+  volatile unsigned long m_value;
+#endif
+#if defined(_THREADS) && !defined(__GNUC__) && !defined(_MSC_VER)
+  SnmpSynchronized m_lock;
+#endif
+};
+
 #ifdef SNMP_PP_NAMESPACE
 } // end of namespace Snmp_pp
 #endif 
@@ -60,6 +60,15 @@
 
 //----[ includes ]-----------------------------------------------------
 #include "snmp_pp/smi.h"
+#include <new>
+
+// Define move constructors and move assignment operators if the
+// compiler supports rvalue references (C++11)
+#if !defined(SNMP_PP_NO_RVALUE_REFS) && \
+    ((__cplusplus >= 201103L) || (defined(_MSC_VER) && (_MSC_VER >= 1600)))
+#define SNMP_PP_RVALUE_REFS
+#include <utility>
+#endif
 
 #ifdef SNMP_PP_NAMESPACE
 namespace Snmp_pp {
@@ -141,6 +150,23 @@ public:
    */
   virtual  SnmpSyntax * clone() const = 0;
 
+  /**
+   * Copy this value into the given buffer instead of allocating the
+   * copy through new. Vb uses this to store small values inline.
+   *
+   * @note Classes that overwrite clone() of a class that implements
+   *       this method must overwrite this method as well.
+   *
+   * @param buf  - Buffer for the copy, aligned for any SnmpSyntax type
+   * @param size - Size of the buffer in bytes
+   * @return Pointer to the copy within buf or NULL if the copy does
+   *         not fit into the buffer or is not supported by the class.
+   *         The copy must be destroyed by calling its destructor,
+   *         not through delete.
+   */
+  virtual SnmpSyntax *clone_into(void * /*buf*/, size_t /*size*/) const
+    { return 0; }
+
   /**
    * Virtual destructor to ensure deletion of derived classes...
    */
@@ -171,6 +197,15 @@ public:
    */
   virtual void clear() = 0;
 
+  /**
+   * Get the value in its SMI representation without copying it
+   * (used for serialization).
+   *
+   * @note The returned structure is valid as long as the object is
+   *       not modified.
+   */
+  const SmiVALUE &get_smival() const { return smival; }
+
 protected:
   SnmpSyntax()
     : smival()
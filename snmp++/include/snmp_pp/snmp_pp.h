@@ -62,6 +62,7 @@
 #include "snmp_pp/vb.h"                 // snbmp++ vb class
 #include "snmp_pp/target.h"             // snmp++ target class
 #include "snmp_pp/pdu.h"                // snmp++ pdu class
+#include "snmp_pp/pduview.h"            // views of encoded pdus
 #include "snmp_pp/snmperrs.h"           // error macros and strings
 #include "snmp_pp/address.h"            // snmp++ address class defs
 #include "snmp_pp/v3.h"                 // SNMPv3
@@ -74,5 +75,6 @@
 #include "snmp_pp/eventlist.h"
 #include "snmp_pp/eventlistholder.h"
 #include "snmp_pp/log.h"
+#include "snmp_pp/walker.h"
 
 #endif //_SNMP_PP_H_
@@ -60,8 +60,10 @@
 
 #include "snmp_pp/smival.h"
 #include "snmp_pp/pdu.h"
+#include "snmp_pp/pduview.h"
 #include "snmp_pp/target.h"
 #include "snmp_pp/asn1.h"
+#include "snmp_pp/v3.h"
 #include "snmp_pp/mp_v3.h"
 
 #ifdef SNMP_PP_NAMESPACE
@@ -82,7 +84,8 @@ class DLLOPT SnmpMessage
  public:
 
   // construct a SnmpMessage object
-  SnmpMessage() : bufflen(MAX_SNMP_PACKET), valid_flag(false) {};
+  SnmpMessage()
+    : databuff(buffer.get_ptr()), bufflen(buffer.size()), valid_flag(false) {};
 	// load up using a Pdu, community and SNMP version
 	// performs ASN.1 serialization
 	// result status returned
@@ -93,6 +96,12 @@ class DLLOPT SnmpMessage
                   const OctetStr *engine_id,     // optional v3
                   const OctetStr *security_name, // optional v3
                   const int security_model);     // optional v3
+	int load_v1_trap( const Pdu &pdu,
+                          const OctetStr &community,
+                          const snmp_version version,
+                          const OctetStr *engine_id,
+                          const OctetStr *security_name,
+                          const int security_model);
  public:
 	int load( const Pdu &pdu,              // Pdu to serialize
                   const OctetStr &community,   // community name to use
@@ -121,6 +130,10 @@ class DLLOPT SnmpMessage
                     snmp_version &version)       // version
 	  { return unload(pdu, community, version, 0, 0, 0, 0, 0); };
 
+	// set the view to the SNMPv1/v2c message in the buffer without
+	// decoding the vbs, the view is valid until the message is changed
+	// status is returned
+	int get_view( PduView &view) const;
 
 #ifdef _SNMPv3
 	int loadv3( const Pdu &pdu,               // Pdu to serialize
@@ -156,9 +169,15 @@ class DLLOPT SnmpMessage
 
 protected:
 
-	unsigned char databuff[MAX_SNMP_PACKET];
+	MessageBuffer buffer;     // pooled, see MessageBuffer
+	unsigned char *databuff;
 	unsigned int bufflen;
 	bool valid_flag;
+
+ private:
+	// not copyable: the buffer is owned by the message
+	SnmpMessage(const SnmpMessage &);
+	SnmpMessage &operator=(const SnmpMessage &);
 };
 
 #ifdef SNMP_PP_NAMESPACE
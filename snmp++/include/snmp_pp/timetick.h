@@ -127,6 +127,12 @@ class DLLOPT TimeTicks : public SnmpUInt32
    */
   SnmpSyntax *clone() const { return (SnmpSyntax *) new TimeTicks(*this); }
 
+  /**
+   * Copy the object into buf, see SnmpSyntax::clone_into().
+   */
+  SnmpSyntax *clone_into(void *buf, size_t size) const
+    { return (size < sizeof(TimeTicks)) ? 0 : new (buf) TimeTicks(*this); }
+
   /**
    * Map other SnmpSyntax objects to TimeTicks.
    */
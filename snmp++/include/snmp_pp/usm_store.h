@@ -0,0 +1,247 @@
+/*_############################################################################
+  _##
+  _##  usm_store.h
+  _##
+  _##  SNMP++ v3.3
+  _##  -----------------------------------------------
+  _##  Copyright (c) 2001-2013 Jochen Katz, Frank Fock
+  _##
+  _##  This software is based on SNMP++2.6 from Hewlett Packard:
+  _##
+  _##    Copyright (c) 1996
+  _##    Hewlett-Packard Company
+  _##
+  _##  ATTENTION: USE OF THIS SOFTWARE IS SUBJECT TO THE FOLLOWING TERMS.
+  _##  Permission to use, copy, modify, distribute and/or sell this software
+  _##  and/or its documentation is hereby granted without fee. User agrees
+  _##  to display the above copyright notice and this license notice in all
+  _##  copies of the software and any documentation of the software. User
+  _##  agrees to assume all liability for the use of the software;
+  _##  Hewlett-Packard and Jochen Katz make no representations about the
+  _##  suitability of this software for any purpose. It is provided
+  _##  "AS-IS" without warranty of any kind, either express or implied. User
+  _##  hereby grants a royalty-free license to any and all derivatives based
+  _##  upon this software code base.
+  _##
+  _##########################################################################*/
+
+
+/*
+  File store for the localized users of the USM.
+
+  The file starts with a header and a snapshot of the usmUserTable:
+  one record per user with the engineID, the names, the protocols and
+  the localized keys, followed by the saved hash indexes of the table.
+  The header holds a hash of the records and the indexes; if it does
+  not match, the indexes are not used and computed again.
+  The file is mapped into memory (read into one buffer where mmap() is
+  not available) and the USMUserTable points into the records and
+  copies the indexes, so opening the file does not parse the users or
+  compute hashes.
+
+  Changes of the table are appended to the file as journal records
+  behind the snapshot and are replayed when the file is opened.
+  Journal records carry a hash, so a record that was not completely
+  written is detected and dropped. write() creates a new file with a
+  snapshot of the whole table and an empty journal.
+
+  The records are stored in the byte order of the host, the file
+  cannot be used on a host with another byte order. Prepared keys are
+  not stored, they depend on the crypto library.
+*/
+
+#ifndef _USM_STORE_H_
+#define _USM_STORE_H_
+
+//----[ includes ]-----------------------------------------------------
+#include <stdio.h>
+
+#include "snmp_pp/config_snmp_pp.h"
+#include "snmp_pp/usm_v3.h"
+
+#ifdef _SNMPv3
+
+#ifdef SNMP_PP_NAMESPACE
+namespace Snmp_pp {
+#endif
+
+#define SNMPv3_USM_STORE_VERSION 1
+
+/**
+ * A user record of the store, followed by the engineID, the userName,
+ * the securityName, the auth key and the priv key. Records start at
+ * multiples of 8 bytes.
+ */
+struct UsmStoreRecord
+{
+  unsigned int   size;           ///< bytes including data and padding
+  unsigned int   check;          ///< hash of the record, journal only
+  unsigned short type;           ///< UsmUserStore::ADD_USER or DELETE_USER
+  unsigned short engine_id_len;
+  unsigned short user_name_len;
+  unsigned short sec_name_len;
+  int            auth_protocol;
+  int            priv_protocol;
+  unsigned short auth_key_len;
+  unsigned short priv_key_len;
+  unsigned int   reserved;
+};
+
+class DLLOPT UsmUserStore
+{
+ public:
+  enum RecordType
+  {
+    ADD_USER    = 1, ///< add or replace the user (all fields)
+    DELETE_USER = 2  ///< delete the user (engineID and userName only)
+  };
+
+  UsmUserStore();
+  ~UsmUserStore();
+
+  /**
+   * Map the file, it is created with an empty snapshot if it does
+   * not exist.
+   *
+   * @param name - filename including path
+   *
+   * @return SNMPv3_USM_OK, SNMPv3_USM_FILECREATE_ERROR,
+   *         SNMPv3_USM_FILEOPEN_ERROR or SNMPv3_USM_FILEREAD_ERROR
+   *         (no user store or a damaged snapshot)
+   */
+  int open(const char *name);
+
+  /**
+   * Unmap the file. All pointers into the records get invalid.
+   */
+  void close();
+
+  /**
+   * Close the file handle used by append(), the next append() opens
+   * the file again.
+   */
+  void close_journal();
+
+  /**
+   * Write a new file with a snapshot of the entries and an empty
+   * journal. The file is written to a temporary file first, that is
+   * renamed to name. The object is not changed, open() the new file
+   * to use it.
+   *
+   * @param name       - filename including path
+   * @param entries    - The users
+   * @param count      - Number of users
+   * @param index      - Saved indexes of the entries, stored behind
+   *                     the records (may be 0)
+   * @param index_size - Bytes of index, a multiple of 8
+   *
+   * @return SNMPv3_USM_OK, SNMPv3_USM_FILECREATE_ERROR,
+   *         SNMPv3_USM_FILEWRITE_ERROR or SNMPv3_USM_FILERENAME_ERROR
+   */
+  int write(const char *name,
+            const struct UsmUserTableEntry *entries, const int count,
+            const unsigned char *index, const unsigned long index_size);
+
+  /**
+   * Append a journal record for the entry to the file.
+   *
+   * @param type  - ADD_USER or DELETE_USER
+   * @param entry - The user, only engineID and userName for DELETE_USER
+   *
+   * @return SNMPv3_USM_OK, SNMPv3_USM_FILEOPEN_ERROR or
+   *         SNMPv3_USM_FILEWRITE_ERROR
+   */
+  int append(const RecordType type, const struct UsmUserTableEntry &entry);
+
+  /**
+   * Get the first record (snapshot records first, then the journal).
+   *
+   * @return The record or 0 if there are no records
+   */
+  const UsmStoreRecord *first() const;
+
+  /**
+   * Get the record behind the given one.
+   *
+   * @return The record or 0 if there are no more records
+   */
+  const UsmStoreRecord *next(const UsmStoreRecord *record) const;
+
+  /**
+   * Get the first record of the journal.
+   *
+   * @return The record or 0 if the journal is empty
+   */
+  const UsmStoreRecord *first_journal_record() const;
+
+  /**
+   * Get the indexes that were stored with the snapshot.
+   *
+   * @param len - Set to the number of bytes
+   *
+   * @return Pointer to the data or 0 if there is no index or the
+   *         snapshot does not match its hash
+   */
+  const unsigned char *get_index(unsigned long &len) const
+    { len = (index_valid ? index_len : 0);
+      return len ? data + snapshot_end - index_len : 0; };
+
+  /**
+   * Set the fields of entry to point into the record. The prepared
+   * keys are set to 0.
+   */
+  static void get_entry(const UsmStoreRecord *record,
+                        struct UsmUserTableEntry &entry);
+
+  /**
+   * Check if the memory belongs to the mapped file.
+   */
+  bool contains(const unsigned char *ptr) const
+    { return (ptr >= data) && (ptr < data + data_len); };
+
+  const char *get_name() const { return file_name; };
+
+  /**
+   * Get the number of records in the snapshot.
+   */
+  int get_snapshot_count() const { return snapshot_count; };
+
+  /**
+   * Get the bytes of the snapshot (with the index) and the journal.
+   */
+  unsigned long get_snapshot_size() const
+    { return snapshot_end - header_len; };
+  unsigned long get_journal_size() const
+    { return file_end - snapshot_end; };
+
+ private:
+  static unsigned long record_size(const RecordType type,
+                                   const struct UsmUserTableEntry &entry);
+  static void fill_record(const RecordType type,
+                          const struct UsmUserTableEntry &entry,
+                          unsigned char *buf, const unsigned long size);
+  bool valid(const UsmStoreRecord *record, const unsigned long end) const;
+  int map(const char *name);
+
+  char *file_name;
+
+  const unsigned char *data;      // the mapped file
+  unsigned long data_len;
+  unsigned long header_len;
+  unsigned long snapshot_end;     // offset of the journal
+  unsigned long journal_end;      // end of the mapped journal records
+  unsigned long file_end;         // offset for the next journal record
+  unsigned long index_len;        // bytes of the index before snapshot_end
+  int snapshot_count;
+  bool index_valid;               // the hash of the snapshot matches
+  FILE *journal;                  // opened by the first append()
+  bool mapped;                    // data is mapped, not allocated
+};
+
+#ifdef SNMP_PP_NAMESPACE
+} // end of namespace Snmp_pp
+#endif
+
+#endif // _SNMPv3
+
+#endif // _USM_STORE_H_
@@ -180,6 +180,8 @@ struct UsmUserTableEntry {
   unsigned char *usmUserAuthKey;      long int usmUserAuthKeyLength;
   long int  usmUserPrivProtocol;
   unsigned char *usmUserPrivKey;      long int usmUserPrivKeyLength;
+  unsigned char *usmUserAuthPreparedKey; long int usmUserAuthPreparedKeyLength;
+  unsigned char *usmUserPrivPreparedKey; long int usmUserPrivPreparedKeyLength;
 };
 
 struct UsmUser {
@@ -190,6 +192,8 @@ struct UsmUser {
   unsigned char *authKey;      long int authKeyLength;
   long int  privProtocol;
   unsigned char *privKey;      long int privKeyLength;
+  unsigned char *authPreparedKey; long int authPreparedKeyLength;
+  unsigned char *privPreparedKey; long int privPreparedKeyLength;
 };
 
 struct UsmUserNameTableEntry {
@@ -201,6 +205,19 @@ struct UsmUserNameTableEntry {
   unsigned char *privPassword;        long int privPasswordLength;
 };
 
+/**
+ * A localized user for USM::add_usm_users().
+ */
+struct UsmUserBatchEntry {
+  OctetStr engineID;
+  OctetStr usmUserName;
+  OctetStr securityName;
+  long int authProtocol;
+  long int privProtocol;
+  OctetStr authPassword;
+  OctetStr privPassword;
+};
+
 //-----------[ async methods callback ]-----------------------------------
 typedef void (*usm_add_user_callback)(const OctetStr &engine_id,
                                       const OctetStr &usm_user_name,
@@ -380,6 +397,26 @@ public:
 			  engine_id); };
 
 
+  /**
+   * Add or replace many localized users in the USM table.
+   *
+   * Does the same as add_usm_user() with an engine id for each entry,
+   * but the key Ku of each distinct password is computed only once
+   * and the keys Ku are computed by the given number of threads. Use
+   * this method to provision a user for many engine ids.
+   *
+   * @param users   - Array of the users
+   * @param count   - Number of entries in users
+   * @param threads - Number of threads that compute the keys Ku,
+   *                  0 or 1 to use only the calling thread
+   *
+   * @return - SNMPv3_USM_OK if all users were added, otherwise the
+   *           error of the first entry that could not be added
+   */
+  int add_usm_users(const struct UsmUserBatchEntry *users,
+                    const int count,
+                    const int threads = 1);
+
   /**
    * Delete all occurences of the user with the given security name
    * from the USM.
@@ -429,6 +466,44 @@ public:
    */
   int load_users(const char *file);
 
+  /**
+   * Load the localized users from a user store file and keep the
+   * file attached: all later changes of the localized users are
+   * appended to the journal of the file, so the file is not
+   * rewritten for each change.
+   *
+   * The file is mapped into memory and the users point into it, so
+   * opening a file with many users is fast. Users of the file replace
+   * users in the table with the same engineID and userName, the other
+   * users in the table are added to the file. The file is created if
+   * it does not exist.
+   *
+   * @note The format differs from the one of save_localized_users().
+   *
+   * @param file - filename including path
+   *
+   * @return SNMPv3_USM_ERROR, SNMPv3_USM_FILECREATE_ERROR,
+   *         SNMPv3_USM_FILEOPEN_ERROR, SNMPv3_USM_FILEREAD_ERROR
+   *         or SNMPv3_USM_OK
+   */
+  int open_localized_user_store(const char *file);
+
+  /**
+   * Write a new snapshot of all localized users to the attached user
+   * store and empty its journal. This is also done automatically if
+   * the journal gets larger than the snapshot.
+   *
+   * @return SNMPv3_USM_ERROR (no store attached),
+   *         SNMPv3_USM_FILECREATE_ERROR, SNMPv3_USM_FILEWRITE_ERROR,
+   *         SNMPv3_USM_FILERENAME_ERROR or SNMPv3_USM_OK
+   */
+  int compact_localized_user_store();
+
+  /**
+   * Detach the user store, later changes are not written to the file.
+   */
+  void close_localized_user_store();
+
   /**
    * Add or replace a localized user in the USM table. Use this method
    * only, if you know what you are doing.
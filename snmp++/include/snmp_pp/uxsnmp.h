@@ -34,6 +34,11 @@
 #include "snmp_pp/oid.h"
 #include "snmp_pp/address.h"
 
+#ifdef HAVE_RECVMMSG_SYSCALL
+struct mmsghdr;
+struct iovec;
+#endif
+
 #ifdef SNMP_PP_NAMESPACE
 namespace Snmp_pp {
 #endif
@@ -77,6 +82,129 @@ class v3MP;
 typedef void (*snmp_callback)(int reason, Snmp *session,
                                Pdu &pdu, SnmpTarget &target, void *data);
 
+//-----------[ batch of UDP datagrams ]-----------------------------------
+/**
+ * Buffers for a batch of UDP datagrams that are received from or sent
+ * to one socket. If the system supports recvmmsg() and sendmmsg(), the
+ * whole batch is transferred with one system call, otherwise the
+ * datagrams are transferred one by one.
+ *
+ * @note This class is not thread safe.
+ */
+class DLLOPT SnmpDatagramBatch
+{
+ public:
+  /**
+   * Allocate the buffers for a batch. Each buffer has room for a
+   * message of MessageBuffer::get_max_message_size() bytes at the
+   * time of construction.
+   *
+   * @param max_count - Maximum number of datagrams in the batch (>= 1)
+   */
+  SnmpDatagramBatch(const int max_count);
+
+  ~SnmpDatagramBatch();
+
+  /**
+   * Get the maximum number of datagrams of this batch.
+   */
+  int get_max_count() const { return m_maxCount; };
+
+  /**
+   * Get the number of datagrams currently stored in this batch.
+   */
+  int get_count() const { return m_count; };
+
+  /**
+   * Remove all datagrams from the batch.
+   */
+  void clear() { m_count = 0; };
+
+  /**
+   * Replace the contents of the batch with the datagrams pending on
+   * the socket. The caller must make sure that at least one datagram
+   * can be read (through select/poll), additional datagrams are only
+   * read if this is possible without blocking.
+   *
+   * @param sock - The socket to read from
+   *
+   * @return The number of received datagrams or -1 on failure
+   */
+  int receive(const SnmpSocket sock);
+
+  /**
+   * Append a datagram that is to be sent by send().
+   *
+   * @param data    - Data of the datagram
+   * @param len     - Length of the data (at most get_max_length())
+   * @param address - Receiver of the datagram
+   *
+   * @return false if the batch is full or the address is not usable
+   */
+  bool add(const unsigned char *data, const size_t len,
+           const UdpAddress &address);
+
+  /**
+   * Send all datagrams added through add() and clear the batch. The
+   * result of each datagram can be read through get_result() until
+   * the next datagram is added.
+   *
+   * @param sock - The socket to send on
+   *
+   * @return The number of datagrams sent
+   */
+  int send(const SnmpSocket sock);
+
+  /**
+   * Get the result of sending the datagram with the given index by
+   * the last call of send().
+   *
+   * @return 0 if the datagram was sent, -1 on failure
+   */
+  int get_result(const int index) const { return m_results[index]; };
+
+  /**
+   * Get the data of the datagram with the given index.
+   */
+  unsigned char *get_data(const int index) const
+    { return m_buffers + index * (m_maxLength + 1); };
+
+  /**
+   * Get the maximum length of a datagram of this batch.
+   */
+  long get_max_length() const { return m_maxLength; };
+
+  /**
+   * Get the length of the datagram with the given index. A value
+   * greater than get_max_length() indicates a truncated datagram.
+   */
+  long get_length(const int index) const { return m_lengths[index]; };
+
+  /**
+   * Get the sender or receiver of the datagram with the given index.
+   *
+   * @return false if the address family is not supported
+   */
+  bool get_address(const int index, UdpAddress &address) const;
+
+ private:
+  SnmpDatagramBatch(const SnmpDatagramBatch &);
+  SnmpDatagramBatch &operator=(const SnmpDatagramBatch &);
+
+  unsigned char *m_buffers;
+  long *m_lengths;
+  int *m_results;
+  SocketAddrType *m_addresses;
+  SocketLengthType *m_addressLengths;
+#ifdef HAVE_RECVMMSG_SYSCALL
+  struct mmsghdr *m_msgs;
+  struct iovec *m_iovecs;
+#endif
+  int m_maxCount;
+  int m_count;
+  long m_maxLength;
+};
+
 
 //------------[ SNMP Class Def ]---------------------------------------------
 //
@@ -128,8 +256,13 @@ class DLLOPT Snmp: public SnmpSynchronized
    *    hold the creation status.
    * @param addr
    *    an UDP address to be used for the session
+   * @param reuse_port
+   *    Set this to true to bind the socket with SO_REUSEPORT, so
+   *    that several sessions can listen on the same address. The
+   *    kernel then distributes incoming datagrams among them.
+   *    Ignored if SO_REUSEPORT is not supported by the system.
    */	
-  Snmp(int &status, const UdpAddress &addr);
+  Snmp(int &status, const UdpAddress &addr, const bool reuse_port = false);
 
   /**
    * Construct a new SNMP session using the given UDP addresses.
@@ -515,6 +648,50 @@ class DLLOPT Snmp: public SnmpSynchronized
 
   const IpAddress &get_listen_address() const {return listen_address; };
 
+  /**
+   * Enable or disable wide request ids. By default request ids are
+   * taken from the range PDU_MIN_RID..PDU_MAX_RID, which limits the
+   * number of outstanding requests per session to about 31000. With
+   * wide request ids the range PDU_MIN_RID..PDU_MAX_WIDE_RID is used.
+   *
+   * Request ids are assigned without locking until the id space
+   * wraps. From then on ids of outstanding requests are skipped.
+   *
+   * @param enable - true to use 31 bit request ids
+   */
+  void set_wide_request_ids(const bool enable)
+    { wide_rids = enable; rid_wrapped.set(1); };
+
+  /**
+   * Check if wide request ids are used.
+   */
+  bool get_wide_request_ids() const { return wide_rids; };
+
+  /**
+   * Set the number of responses that may be read from a socket with
+   * one system call while processing events. The default value of 1
+   * disables batched reception.
+   *
+   * @note Call this method before requests are sent or received
+   *       through this session.
+   *
+   * @param count - Maximum number of datagrams per system call
+   */
+  void set_receive_batch_size(const int count);
+
+  /**
+   * Get the number of datagrams that may be read with one system call.
+   */
+  int get_receive_batch_size() const
+    { return m_receiveBatch ? m_receiveBatch->get_max_count() : 1; };
+
+  /**
+   * Get the buffers for batched reception.
+   *
+   * @return The batch or NULL if batched reception is disabled
+   */
+  SnmpDatagramBatch *get_receive_batch() { return m_receiveBatch; };
+
   /**
    * Start one thread listening for responses and notifications.
    * This method is used to start response and notification processing in a
@@ -572,7 +749,8 @@ protected:
   /**
    * Generate a unique (for this Snmp obect) request id.
    *
-   * @return Unique id between PDU_MIN_RID and PDU_MAX_RID
+   * @return Unique id between PDU_MIN_RID and PDU_MAX_RID, or
+   *         PDU_MAX_WIDE_RID if wide request ids are enabled
    */
   long MyMakeReqId();
 
@@ -636,7 +814,10 @@ protected:
 #endif
 
   IpAddress listen_address;
-  long current_rid;                   // current rid to use
+  SnmpAtomicCounter current_rid;      // counter for the request ids
+  unsigned long first_rid;            // initial value of current_rid
+  SnmpAtomicCounter rid_wrapped;      // not 0 if ids may be outstanding
+  bool wide_rids;                     // use 31 bit request ids
 
   // inform receive member variables
   snmp_callback  notifycallback;
@@ -645,10 +826,14 @@ protected:
   // this member var will simulate a global var
   EventListHolder *eventListHolder;
 
+  // buffers for batched reception, NULL if disabled
+  SnmpDatagramBatch *m_receiveBatch;
+
 private:
 
   bool m_bThreadRunning;
   int m_iPollTimeOut;
+  bool reuse_port;        // bind with SO_REUSEPORT
 
   // Keep track of the thread.
 #ifdef _THREADS
@@ -260,6 +260,61 @@ template <class T> class Buffer
     unsigned int len;
 };
 
+/**
+ * Buffer for one SNMP message. The buffers are taken from a cache of
+ * the calling thread and returned to it on destruction, so building
+ * and parsing messages does not allocate memory and threads do not
+ * share a lock for it.
+ *
+ * The buffer size follows the runtime maximum message size, which
+ * starts with MAX_SNMP_PACKET and can be changed up to
+ * MAX_SNMP_PACKET_LIMIT. One additional byte is allocated, so that a
+ * received datagram that exceeds the maximum size can be detected.
+ */
+class DLLOPT MessageBuffer
+{
+ public:
+  /// Constructor: Get a buffer of get_max_message_size() + 1 bytes.
+  MessageBuffer();
+
+  /// Destructor: Return the buffer to the cache of the thread.
+  ~MessageBuffer();
+
+  /// Get the buffer pointer
+  unsigned char *get_ptr() { return ptr; };
+
+  /// Get the usable size of the buffer (the maximum message size).
+  unsigned int size() const { return len; };
+
+  /// Overwrite the buffer space with zero.
+  void clear() { memset(ptr, 0, len + 1); };
+
+  /**
+   * Get the current maximum message size.
+   */
+  static unsigned int get_max_message_size();
+
+  /**
+   * Set the maximum size of messages that are sent or received.
+   * The value is used for new buffers and is advertised as
+   * msgMaxSize (SNMPv3) and snmpEngineMaxMessageSize. It may be
+   * changed while sessions are running, buffers of the old size are
+   * released when they are returned.
+   *
+   * @param size - A value between 484 and MAX_SNMP_PACKET_LIMIT
+   * @return true if the size was changed
+   */
+  static bool set_max_message_size(const unsigned int size);
+
+ private:
+  // not copyable
+  MessageBuffer(const MessageBuffer &);
+  MessageBuffer &operator=(const MessageBuffer &);
+
+  unsigned char *ptr;
+  unsigned int len;
+};
+
 // only for compatibility do not use these values:
 #define SecurityModel_any SNMP_SECURITY_MODEL_ANY
 #define SecurityModel_v1  SNMP_SECURITY_MODEL_V1
@@ -83,7 +83,8 @@ namespace Snmp_pp {
  * objects. Vb objects are passed to and from SNMP objects to provide
  * getting or setting MIB values.  The vb class keeps its own memory
  * for objects and does not utilize pointers to external data
- * structures.
+ * structures. Integer, counter, timeticks and OctetStr values are
+ * stored within the Vb object, other values are allocated through new.
  */
 class DLLOPT Vb
 {
@@ -107,11 +108,31 @@ class DLLOPT Vb
   Vb(const Oid &oid)
     : iv_vb_oid(oid), iv_vb_value(0), exception_status(SNMP_CLASS_SUCCESS) {};
 
+#ifdef SNMP_PP_RVALUE_REFS
+  /**
+   * Constructor to initialize the oid, taking over the given oid.
+   */
+  Vb(Oid &&oid)
+    : iv_vb_oid(std::move(oid)), iv_vb_value(0),
+      exception_status(SNMP_CLASS_SUCCESS) {};
+#endif
+
   /**
    * Copy constructor.
    */
   Vb(const Vb &vb) : iv_vb_value(0) { *this = vb; };
 
+#ifdef SNMP_PP_RVALUE_REFS
+  /**
+   * Move constructor. The oid and the value are taken over from vb,
+   * which is left without oid and value.
+   */
+  Vb(Vb &&vb)
+    : iv_vb_oid(std::move(vb.iv_vb_oid)), iv_vb_value(0),
+      exception_status(vb.exception_status)
+    { take_value(vb); };
+#endif
+
   /**
    * Destructor that frees all allocated memory.
    */
@@ -122,6 +143,23 @@ class DLLOPT Vb
    */
   Vb& operator=(const Vb &vb);
 
+#ifdef SNMP_PP_RVALUE_REFS
+  /**
+   * Move assignment operator. The oid and the value are taken over
+   * from vb, which is left without oid and value.
+   */
+  Vb& operator=(Vb &&vb)
+  {
+    if (this == &vb) return *this;  // check for self assignment
+
+    free_vb();
+    iv_vb_oid = std::move(vb.iv_vb_oid);
+    exception_status = vb.exception_status;
+    take_value(vb);
+    return *this;
+  };
+#endif
+
   /**
    * Clone operator.
    */
@@ -134,6 +172,13 @@ class DLLOPT Vb
    */
   void set_oid(const Oid &oid) { iv_vb_oid = oid; };
 
+#ifdef SNMP_PP_RVALUE_REFS
+  /**
+   * Set the oid, taking over the given oid.
+   */
+  void set_oid(Oid &&oid) { iv_vb_oid = std::move(oid); };
+#endif
+
   /**
    * Get the oid portion.
    *
@@ -156,14 +201,15 @@ class DLLOPT Vb
    * Set the value using any SnmpSyntax object.
    */
   void set_value(const SnmpSyntax &val)
-    { free_vb(); iv_vb_value = val.clone(); };
+    { free_vb(); copy_value(val); };
 
   /**
    * Set the value with an int.
    *
    * The syntax of the Vb will be set to SMI INT32.
    */
-  void set_value(const int i) { free_vb(); iv_vb_value = new SnmpInt32(i); };
+  void set_value(const int i)
+    { free_vb(); iv_vb_value = new (&iv_vb_storage) SnmpInt32(i); };
 
   /**
    * Set the value with an unsigned int.
@@ -171,7 +217,7 @@ class DLLOPT Vb
    * The syntax of the Vb will be set to SMI UINT32.
    */
   void set_value(const unsigned int i)
-    { free_vb(); iv_vb_value = new SnmpUInt32(i); };
+    { free_vb(); iv_vb_value = new (&iv_vb_storage) SnmpUInt32(i); };
 
   /**
    * Set the value with a long int.
@@ -181,7 +227,7 @@ class DLLOPT Vb
    * The syntax of the Vb will be set to SMI INT32.
    */
   void set_value(const long i)
-    { free_vb(); iv_vb_value = new SnmpInt32(i); };
+    { free_vb(); iv_vb_value = new (&iv_vb_storage) SnmpInt32(i); };
 
   /**
    * Set the value with an unsigned long int.
@@ -191,7 +237,7 @@ class DLLOPT Vb
    * The syntax of the Vb will be set to SMI UINT32.
    */
   void set_value(const unsigned long i)
-    { free_vb(); iv_vb_value = new SnmpUInt32(i); };
+    { free_vb(); iv_vb_value = new (&iv_vb_storage) SnmpUInt32(i); };
 
   /**
    * Set value using a null terminated string.
@@ -199,7 +245,7 @@ class DLLOPT Vb
    * The syntax of the Vb will be set to SMI octet.
    */
   void set_value(const char *ptr)
-    { free_vb(); iv_vb_value = new OctetStr(ptr); };
+    { free_vb(); iv_vb_value = new (&iv_vb_storage) OctetStr(ptr); };
 
   /**
    * Set value using a string and length.
@@ -207,7 +253,7 @@ class DLLOPT Vb
    * The syntax of the Vb will be set to SMI octet.
    */
   void set_value(const unsigned char *ptr, const unsigned int len)
-    { free_vb(); iv_vb_value = new OctetStr(ptr, len); };
+    { free_vb(); iv_vb_value = new (&iv_vb_storage) OctetStr(ptr, len); };
 
   /**
    * Set the value portion of the vb to null, if its not already.
@@ -354,6 +400,15 @@ class DLLOPT Vb
   SnmpSyntax* clone_value() const
       { return ((iv_vb_value) ? iv_vb_value->clone() : 0); };
 
+  /**
+   * Get the value portion of the variable binding without copying it.
+   *
+   * @return
+   *    a pointer to the value that is valid as long as the receiver
+   *    is not modified, or NULL if no value is set.
+   */
+  const SnmpSyntax* get_value_ptr() const { return iv_vb_value; };
+
 
   //-----[ misc]--------------------------------------------------------
 
@@ -428,10 +483,50 @@ class DLLOPT Vb
   SnmpSyntax *iv_vb_value;     // and a value...
   SmiUINT32 exception_status;  // are there any vb exceptions??
 
+  // Storage for integer, counter, timeticks and OctetStr values.
+  // Larger values (Oid, addresses) are allocated through new.
+  union
+  {
+    char int32[sizeof(SnmpInt32)];
+    char uint32[sizeof(SnmpUInt32)];
+    char gauge32[sizeof(Gauge32)];
+    char counter32[sizeof(Counter32)];
+    char timeticks[sizeof(TimeTicks)];
+    char counter64[sizeof(Counter64)];
+    char octets[sizeof(OctetStr)];
+    char opaque[sizeof(OpaqueStr)];
+    double align_double;         // alignment for all of the above
+    void *align_ptr;
+  } iv_vb_storage;
+
   /**
    * Free the value portion.
    */
   void free_vb();
+
+  /**
+   * Is the value stored in iv_vb_storage?
+   */
+  bool value_is_inline() const
+  {
+    return (((const char *)iv_vb_value >= (const char *)&iv_vb_storage) &&
+            ((const char *)iv_vb_value <
+             (const char *)&iv_vb_storage + sizeof(iv_vb_storage)));
+  }
+
+  /**
+   * Set the value portion to a copy of val. The value portion must
+   * be free.
+   */
+  void copy_value(const SnmpSyntax &val);
+
+#ifdef SNMP_PP_RVALUE_REFS
+  /**
+   * Take over the value portion of vb, which is left without value.
+   * The value portion of this object must be free.
+   */
+  void take_value(Vb &vb);
+#endif
 };
 
 #ifdef SNMP_PP_NAMESPACE
@@ -0,0 +1,350 @@
+/*_############################################################################
+  _##
+  _##  walker.h
+  _##
+  _##  SNMP++ v3.3
+  _##  -----------------------------------------------
+  _##  Copyright (c) 2001-2013 Jochen Katz, Frank Fock
+  _##
+  _##  This software is based on SNMP++2.6 from Hewlett Packard:
+  _##
+  _##    Copyright (c) 1996
+  _##    Hewlett-Packard Company
+  _##
+  _##  ATTENTION: USE OF THIS SOFTWARE IS SUBJECT TO THE FOLLOWING TERMS.
+  _##  Permission to use, copy, modify, distribute and/or sell this software
+  _##  and/or its documentation is hereby granted without fee. User agrees
+  _##  to display the above copyright notice and this license notice in all
+  _##  copies of the software and any documentation of the software. User
+  _##  agrees to assume all liability for the use of the software;
+  _##  Hewlett-Packard and Jochen Katz make no representations about the
+  _##  suitability of this software for any purpose. It is provided
+  _##  "AS-IS" without warranty of any kind, either express or implied. User
+  _##  hereby grants a royalty-free license to any and all derivatives based
+  _##  upon this software code base.
+  _##
+  _##########################################################################*/
+
+#ifndef _WALKER_H_
+#define _WALKER_H_
+
+//----[ includes ]-----------------------------------------------------
+#include "snmp_pp/config_snmp_pp.h"
+#include "snmp_pp/snmperrs.h"
+#include "snmp_pp/reentrant.h"
+#include "snmp_pp/oid.h"
+#include "snmp_pp/vb.h"
+#include "snmp_pp/target.h"
+#include "snmp_pp/octet.h"
+
+#ifdef SNMP_PP_NAMESPACE
+namespace Snmp_pp {
+#endif
+
+class Snmp;
+class Pdu;
+class TableWalker;
+
+#define WALKER_DEFAULT_MAX_IN_FLIGHT            1000
+#define WALKER_DEFAULT_MAX_IN_FLIGHT_PER_TARGET 4
+#define WALKER_DEFAULT_MAX_REPETITIONS          20
+
+#define BULK_DEFAULT_INITIAL_REPETITIONS        10
+#define BULK_DEFAULT_MAX_REPETITIONS            1000
+
+/**
+ * Callback of a walk.
+ *
+ * The callback is called once for each received variable binding
+ * (reason is SNMP_CLASS_SUCCESS and vb is not null) and once when the
+ * walk has ended (vb is null). For the final call, reason is
+ * SNMP_CLASS_SUCCESS if the walk is complete, otherwise it is the
+ * error (SNMP_CLASS_TIMEOUT, the error status of a response, ...)
+ * that aborted the walk.
+ *
+ * @param reason - SNMP_CLASS_SUCCESS or an error code
+ * @param walker - The walker that runs the walk
+ * @param target - The target of the walk
+ * @param vb     - The received variable binding or null
+ * @param data   - The callback data passed to TableWalker::walk()
+ */
+typedef void (*walk_callback)(int reason, TableWalker *walker,
+                              const SnmpTarget &target, const Vb *vb,
+                              void *data);
+
+/**
+ * Adaptive choice of the max-repetitions value of GETBULK requests.
+ *
+ * The controller keeps one entry per target address. It learns from
+ * the responses of the target:
+ * - the average encoded size of a variable binding, which together
+ *   with the maximum message size of the target limits the number of
+ *   repetitions that fit into one response,
+ * - the maximum message size of the target, from tooBig errors and
+ *   from responses the agent has truncated,
+ * - the latency, so that the value is not increased further if larger
+ *   responses take disproportionately longer.
+ * Starting with the initial value, the recommendation is doubled after
+ * each complete response until one of these limits is reached, and it
+ * is halved on timeouts and tooBig errors.
+ *
+ * The learned values can be saved to and loaded from a file. For
+ * synchronous requests the controller is used like this:
+ *
+ *   int reps = controller.get_max_repetitions(target);
+ *   msec start;
+ *   int status = snmp.get_bulk(pdu, target, 0, reps);
+ *   controller.update(target, status, pdu, reps, 1,
+ *                     msec() - start, end_of_walk);
+ */
+class DLLOPT BulkController: public SnmpSynchronized
+{
+ public:
+  /**
+   * Create a controller.
+   *
+   * @param initial_reps - The value used for unknown targets
+   * @param max_reps     - The upper limit of the value
+   */
+  BulkController(const int initial_reps = BULK_DEFAULT_INITIAL_REPETITIONS,
+                 const int max_reps = BULK_DEFAULT_MAX_REPETITIONS);
+
+  ~BulkController();
+
+  /**
+   * Get the max-repetitions value to use for the next request.
+   *
+   * @param target - The target of the request
+   * @param columns - The number of repeated variable bindings
+   */
+  int get_max_repetitions(const SnmpTarget &target, const int columns = 1);
+
+  /**
+   * Update the entry of the target with the result of a GETBULK request.
+   *
+   * @param target      - The target of the request
+   * @param status      - The return value of the synchronous get_bulk()
+   *                      or the reason passed to the async callback
+   * @param response    - The received response
+   * @param max_reps    - The max-repetitions value of the request
+   * @param columns     - The number of repeated variable bindings
+   * @param latency     - The time between request and response in ms
+   * @param end_of_data - True if the walk has ended within the response,
+   *                      so fewer variable bindings than requested do
+   *                      not indicate a truncated response
+   */
+  void update(const SnmpTarget &target, const int status,
+              const Pdu &response, const int max_reps, const int columns,
+              const unsigned long latency, const bool end_of_data);
+
+  /**
+   * Save the learned values of all targets.
+   *
+   * @return SNMP_CLASS_SUCCESS or SNMP_CLASS_ERROR
+   */
+  int save(const char *filename);
+
+  /**
+   * Load values saved by save(). Existing entries are replaced.
+   *
+   * @return SNMP_CLASS_SUCCESS or SNMP_CLASS_ERROR
+   */
+  int load(const char *filename);
+
+  /**
+   * Get the number of targets known to the controller.
+   */
+  int get_count() const { return count; };
+
+ private:
+  struct Entry;
+
+  BulkController(const BulkController &);
+  BulkController &operator=(const BulkController &);
+
+  Entry *find(const OctetStr &key, const bool create);
+  int get_limit(const Entry *entry, const int columns) const;
+
+  int initial_repetitions;
+  int max_repetitions;
+  Entry **table;
+  int table_size;
+  int count;
+};
+
+/**
+ * The TableWalker runs many walks concurrently over one Snmp session.
+ *
+ * Each walk is divided into ranges that are retrieved independently
+ * with asynchronous GETBULK requests (GETNEXT for SNMPv1 targets):
+ * - If the columns of a table are given, each column is one range.
+ * - If a subtree is given and the walk finds a table entry below it
+ *   (a received oid is at least two subidentifiers longer than the
+ *   subtree), the range is restricted to the first found column and
+ *   a new range is started at the next column. So the columns of a
+ *   table are walked in parallel as soon as they are discovered.
+ *
+ * Whenever a response is received, the next request for that range is
+ * sent, as long as the number of requests in flight for the target
+ * and in total are below the configured limits. Ranges that have to
+ * wait are queued per target, targets with waiting ranges are served
+ * round robin.
+ *
+ * The received variable bindings are passed to the callback of the
+ * walk as they arrive. The callbacks are called from the thread that
+ * processes the events of the Snmp session (see
+ * Snmp::start_poll_thread() or EventListHolder::SNMPMainLoop()).
+ * If that fails to send the first request, the final callback is
+ * already called from walk().
+ *
+ * @note All walks should have ended before the walker or the Snmp
+ *       session is destroyed. The destructor cancels the requests in
+ *       flight, but requests that are resent internally (SNMPv3
+ *       engine id discovery) may still call back.
+ */
+class DLLOPT TableWalker: public SnmpSynchronized
+{
+ public:
+  /**
+   * Create a walker that uses the given Snmp session.
+   */
+  TableWalker(Snmp &snmp_session);
+
+  /**
+   * Destructor. Cancels all walks without calling their callbacks.
+   */
+  ~TableWalker();
+
+  /**
+   * Walk the subtree below the given oid.
+   *
+   * @param target   - The target to walk, a copy is made
+   * @param subtree  - The root of the walk (e.g. ifEntry)
+   * @param callback - The callback for the results
+   * @param data     - Data that is passed to the callback
+   *
+   * @return SNMP_CLASS_SUCCESS or an error code
+   */
+  int walk(const SnmpTarget &target, const Oid &subtree,
+           const walk_callback callback, const void *data);
+
+  /**
+   * Walk the given columns of a table in parallel.
+   *
+   * @param target   - The target to walk, a copy is made
+   * @param columns  - The oids of the columns (e.g. ifDescr, ifInOctets)
+   * @param count    - The number of columns
+   * @param callback - The callback for the results
+   * @param data     - Data that is passed to the callback
+   *
+   * @return SNMP_CLASS_SUCCESS or an error code
+   */
+  int walk(const SnmpTarget &target, const Oid *columns, const int count,
+           const walk_callback callback, const void *data);
+
+  /**
+   * Set the maximum number of requests in flight for all targets.
+   */
+  void set_max_in_flight(const int count);
+
+  /**
+   * Get the maximum number of requests in flight for all targets.
+   */
+  int get_max_in_flight() const { return max_in_flight; };
+
+  /**
+   * Set the maximum number of requests in flight for one target.
+   */
+  void set_max_in_flight_per_target(const int count);
+
+  /**
+   * Get the maximum number of requests in flight for one target.
+   */
+  int get_max_in_flight_per_target() const
+    { return max_in_flight_per_target; };
+
+  /**
+   * Set the max-repetitions value of the GETBULK requests. It is
+   * used if no BulkController has been set.
+   */
+  void set_max_repetitions(const int count)
+    { max_repetitions = (count < 1) ? 1 : count; };
+
+  /**
+   * Get the max-repetitions value of the GETBULK requests.
+   */
+  int get_max_repetitions() const { return max_repetitions; };
+
+  /**
+   * Use an adaptive max-repetitions value instead of the fixed one.
+   *
+   * @param controller - The controller (not owned by the walker)
+   *                     or null to use the fixed value
+   */
+  void set_bulk_controller(BulkController *controller)
+    { bulk_controller = controller; };
+
+  /**
+   * Enable or disable splitting subtree walks into columns
+   * (enabled by default).
+   */
+  void set_column_split(const bool enable) { column_split = enable; };
+
+  /**
+   * Get the number of walks that have not ended yet.
+   */
+  int get_walk_count() const { return walk_count; };
+
+  /**
+   * Get the number of requests in flight.
+   */
+  int get_in_flight() const { return in_flight; };
+
+ private:
+  struct WalkTarget;
+  struct Walk;
+  struct WalkRange;
+
+  TableWalker(const TableWalker &);
+  TableWalker &operator=(const TableWalker &);
+
+  static void response_callback(int reason, Snmp *session, Pdu &pdu,
+                                SnmpTarget &target, void *data);
+
+  int start_walk(const SnmpTarget &target, const Oid *oids, const int count,
+                 const bool split, const walk_callback callback,
+                 const void *data);
+  void process_response(int reason, Pdu &pdu, WalkRange *range);
+  WalkRange *add_range(Walk *walk, const Oid &start, const Oid &bound,
+                       const bool split);
+  void enqueue(WalkRange *range);
+  void dispatch();
+  void end_range(WalkRange *range, const int status);
+  void finish_walks();
+
+  WalkTarget *get_target(const SnmpTarget &target);
+  void release_target(WalkTarget *entry);
+
+  Snmp &snmp;
+  int max_in_flight;
+  int max_in_flight_per_target;
+  int max_repetitions;
+  bool column_split;
+  BulkController *bulk_controller;
+
+  int in_flight;
+  int walk_count;
+  Walk *walks;               // all walks that have not ended
+  Walk *finished;            // walks to be reported by finish_walks()
+  WalkTarget *runnable_head; // targets with waiting ranges and free slots
+  WalkTarget *runnable_tail;
+  WalkTarget **target_hash;
+  int target_hash_size;
+  int target_count;
+};
+
+#ifdef SNMP_PP_NAMESPACE
+} // end of namespace Snmp_pp
+#endif
+
+#endif // _WALKER_H_
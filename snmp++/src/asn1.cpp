@@ -55,6 +55,8 @@ char asn1_cpp_version[]="#(@) SNMP++ $Id: asn1.cpp 2542 2014-01-24 13:17:19Z foc
 #include "snmp_pp/v3.h"
 #include "snmp_pp/snmperrs.h"
 #include "snmp_pp/log.h"
+#include "snmp_pp/pdu.h"
+#include "snmp_pp/vb.h"
 
 #ifdef SNMP_PP_NAMESPACE
 namespace Snmp_pp {
@@ -1225,19 +1227,19 @@ static unsigned char *snmp_auth_build(unsigned char *data,
 }
 
 
-// build a variable binding
-unsigned char * snmp_build_var_op(unsigned char *data,
-				  oid * var_name,
-				  int *var_name_len,
-				  unsigned char var_val_type,
-				  int var_val_len,
-				  unsigned char *var_val,
-				  int *listlength)
+// build a variable binding, the value is encoded in buffer first
+static unsigned char *build_var_op(unsigned char *data,
+				   oid * var_name,
+				   int *var_name_len,
+				   unsigned char var_val_type,
+				   int var_val_len,
+				   unsigned char *var_val,
+				   int *listlength,
+				   MessageBuffer &buffer)
 {
   int valueLen;
-  Buffer<unsigned char> buffer(MAX_SNMP_PACKET);
   unsigned char *buffer_pos = buffer.get_ptr();
-  int bufferLen = MAX_SNMP_PACKET;
+  int bufferLen = buffer.size();
 
   buffer_pos = asn_build_objid(buffer_pos, &bufferLen,
 			       ASN_UNI_PRIM | ASN_OBJECT_ID,
@@ -1338,23 +1340,38 @@ unsigned char * snmp_build_var_op(unsigned char *data,
   return data;
 }
 
+// build a variable binding
+unsigned char * snmp_build_var_op(unsigned char *data,
+				  oid * var_name,
+				  int *var_name_len,
+				  unsigned char var_val_type,
+				  int var_val_len,
+				  unsigned char *var_val,
+				  int *listlength)
+{
+  MessageBuffer buffer;
+  return build_var_op(data, var_name, var_name_len, var_val_type,
+		      var_val_len, var_val, listlength, buffer);
+}
+
 
 unsigned char *build_vb(struct snmp_pdu *pdu,
 			unsigned char *buf, int *buf_len)
 {
-  Buffer<unsigned char> tmp_buf(MAX_SNMP_PACKET);
+  MessageBuffer tmp_buf;
+  MessageBuffer vb_buf;  // shared by all varbinds of the pdu
   unsigned char *cp = tmp_buf.get_ptr();
   struct   variable_list *vp;
   int vb_length;
-  int length = MAX_SNMP_PACKET;
+  int length = tmp_buf.size();
 
   // build varbinds into packet buffer
   for(vp = pdu->variables; vp; vp = vp->next_variable)
   {
-    cp = snmp_build_var_op(cp, vp->name, &vp->name_length,
-			    vp->type, vp->val_len,
-			    (unsigned char *)vp->val.string,
-			    &length);
+    cp = build_var_op(cp, vp->name, &vp->name_length,
+		      vp->type, vp->val_len,
+		      (unsigned char *)vp->val.string,
+		      &length, vb_buf);
     if (cp == NULL) return 0;
   }
   vb_length = SAFE_INT_CAST(cp - tmp_buf.get_ptr());
@@ -1375,10 +1392,10 @@ unsigned char *build_data_pdu(struct snmp_pdu *pdu,
 			      unsigned char *buf, int *buf_len,
 			      unsigned char *vb_buf, int vb_buf_len)
 {
-  Buffer<unsigned char> tmp_buf(MAX_SNMP_PACKET);
+  MessageBuffer tmp_buf;
   unsigned char *cp = tmp_buf.get_ptr();
   int totallength;
-  int length = MAX_SNMP_PACKET;
+  int length = tmp_buf.size();
 
   // build data of pdu into tmp_buf
   if (pdu->command != TRP_REQ_MSG)
@@ -1448,7 +1465,7 @@ int snmp_build(struct snmp_pdu	*pdu,
                const long version,
                const unsigned char* community, const int community_len)
 {
-  Buffer<unsigned char> buf(MAX_SNMP_PACKET);
+  MessageBuffer buf;
   unsigned char  *cp;
   int	     length;
   int	 totallength;
@@ -1461,7 +1478,7 @@ int snmp_build(struct snmp_pdu	*pdu,
   if (totallength >= *out_length) return -1;
 
   // encode datadpu into buf
-  length = MAX_SNMP_PACKET;
+  length = buf.size();
   cp = build_data_pdu(pdu, buf.get_ptr(), &length,
 		      packet, totallength);
   if (cp == 0) return -1;
@@ -1483,6 +1500,348 @@ int snmp_build(struct snmp_pdu	*pdu,
   return 0;
 }
 
+//-----[ direct encoding of Vb and Pdu objects ]-----------------------
+//
+// The following functions serialize Vb and Pdu objects without the
+// intermediate struct snmp_pdu. The length of each element is computed
+// before it is written, so the message is built front to back in one
+// pass directly into the output buffer, without temporary buffers and
+// without heap allocations.
+
+// number of octets of the length field for the given length
+static inline int asn1_length_length(const int length)
+{
+  if (length < 0x80)      return 1;
+  if (length <= 0xFF)     return 2;
+  if (length <= 0xFFFF)   return 3;
+  if (length <= 0xFFFFFF) return 4;
+  return 5;
+}
+
+// length of type, length field and contents
+static inline int asn1_tlv_length(const int length)
+{
+  return 1 + asn1_length_length(length) + length;
+}
+
+// length of the contents written by asn_build_int()
+static int asn1_int_length(long integer)
+{
+  unsigned long mask = 0x1FFul << ((8 * (sizeof(long) - 1)) - 1);
+  int intsize = sizeof(long);
+
+  while((((integer & mask) == 0) || ((integer & mask) == mask))
+	&& intsize > 1) {
+    intsize--;
+    integer <<= 8;
+  }
+  return intsize;
+}
+
+// length of the contents written by asn_build_unsigned_int()
+static int asn1_unsigned_int_length(const unsigned long u_integer)
+{
+  int u_integer_len;
+
+  if (((u_integer >> 24) & 0xFF) != 0)
+    u_integer_len = 4;
+  else if (((u_integer >> 16) & 0xFF) !=0)
+    u_integer_len = 3;
+  else if (((u_integer >> 8) & 0xFF) !=0)
+    u_integer_len = 2;
+  else
+    u_integer_len = 1;
+
+  if (((u_integer >> (8 * (u_integer_len -1))) & 0x080) !=0)
+    u_integer_len++;
+
+  return u_integer_len;
+}
+
+// length of the contents written by asn_build_unsigned_int64()
+static int asn1_unsigned_int64_length(unsigned long high, unsigned long low)
+{
+  unsigned long mask = 0xFF000000ul;
+  unsigned long mask2 = 0xFF800000ul;
+  int intsize = 8;
+
+  if (((high & mask) >> 24) & 0x80)
+    return 9;
+
+  while ((((high & mask2) == 0) || ((high & mask2) == mask2)) &&
+	 (intsize > 1)) {
+    intsize--;
+    high = (high << 8) | ((low & mask) >> 24);
+    low <<= 8;
+  }
+  return intsize;
+}
+
+// length of the contents written by asn_build_objid()
+static int asn1_objid_length(const SmiOID &objid)
+{
+  int objidlength = (int)objid.len;
+  if (objidlength > MAX_OID_LEN)
+    objidlength = MAX_OID_LEN;
+  if (objidlength < 2)
+    return 1;
+
+  int length = 0;
+  for (int i = 1; i < objidlength; ++i)
+  {
+    unsigned long subid = objid.ptr[i];
+    if (i == 1)
+      subid += objid.ptr[0] * 40;
+    do {
+      ++length;
+      subid >>= 7;
+    } while (subid);
+  }
+  return length;
+}
+
+// Get the syntax, the SMI value and the length of the encoded value
+// (without type and length field) of a vb. Returns -1 for values
+// that cannot be encoded.
+static int asn1_vb_value(const Vb &vb, const bool null_value,
+			 SmiUINT32 &syntax, const SmiVALUE *&smival)
+{
+  const SnmpSyntax *value = vb.get_value_ptr();
+
+  syntax = null_value ? sNMP_SYNTAX_NULL : vb.get_syntax();
+  smival = 0;
+
+  switch (syntax)
+  {
+    case sNMP_SYNTAX_NULL:
+    case sNMP_SYNTAX_NOSUCHOBJECT:
+    case sNMP_SYNTAX_NOSUCHINSTANCE:
+    case sNMP_SYNTAX_ENDOFMIBVIEW:
+      return 0;
+  }
+  if (!value)
+    return -1;
+
+  smival = &value->get_smival();
+  switch (syntax)
+  {
+    case sNMP_SYNTAX_INT:
+      return asn1_int_length(smival->value.sNumber);
+
+    case sNMP_SYNTAX_GAUGE32:
+    case sNMP_SYNTAX_CNTR32:
+    case sNMP_SYNTAX_TIMETICKS:
+      return asn1_unsigned_int_length(smival->value.uNumber);
+
+    case sNMP_SYNTAX_CNTR64:
+      return asn1_unsigned_int64_length(smival->value.hNumber.hipart,
+					smival->value.hNumber.lopart);
+
+    case sNMP_SYNTAX_BITS:
+    case sNMP_SYNTAX_OCTETS:
+    case sNMP_SYNTAX_OPAQUE:
+    case sNMP_SYNTAX_IPADDR:
+      // invalid values are encoded as empty strings
+      return value->valid() ? (int)smival->value.string.len : 0;
+
+    case sNMP_SYNTAX_OID:
+      return asn1_objid_length(smival->value.oid);
+  }
+
+  ASNERROR("asn1_vb_value: wrong type");
+  return -1;
+}
+
+int asn1_vb_length(const Vb &vb, const bool null_value)
+{
+  SmiUINT32 syntax;
+  const SmiVALUE *smival;
+  int value_length = asn1_vb_value(vb, null_value, syntax, smival);
+  if (value_length < 0)
+    return -1;
+
+  const SmiOID &name = vb.get_oid().get_smival().value.oid;
+  return asn1_tlv_length(asn1_tlv_length(asn1_objid_length(name)) +
+                         asn1_tlv_length(value_length));
+}
+
+unsigned char *asn1_build_vb(unsigned char *data, int *datalength,
+			     const Vb &vb, const bool null_value)
+{
+  SmiUINT32 syntax;
+  const SmiVALUE *smival;
+  int value_length = asn1_vb_value(vb, null_value, syntax, smival);
+  if (value_length < 0)
+    return NULL;
+
+  const SmiOID &name = vb.get_oid().get_smival().value.oid;
+  int length = asn1_tlv_length(asn1_objid_length(name)) +
+               asn1_tlv_length(value_length);
+
+  data = asn_build_sequence(data, datalength, ASN_SEQ_CON, length);
+  if (data == NULL)
+    return NULL;
+
+  data = asn_build_objid(data, datalength, ASN_UNI_PRIM | ASN_OBJECT_ID,
+			 (oid *)name.ptr, (int)name.len);
+  if (data == NULL)
+    return NULL;
+
+  unsigned char type = (unsigned char)syntax;
+  switch (syntax)
+  {
+    case sNMP_SYNTAX_INT:
+    {
+      long value = smival->value.sNumber;
+      return asn_build_int(data, datalength, type, &value);
+    }
+    case sNMP_SYNTAX_GAUGE32:
+    case sNMP_SYNTAX_CNTR32:
+    case sNMP_SYNTAX_TIMETICKS:
+    {
+      unsigned long value = smival->value.uNumber;
+      return asn_build_unsigned_int(data, datalength, type, &value);
+    }
+    case sNMP_SYNTAX_CNTR64:
+    {
+      struct counter64 value;
+      value.high = smival->value.hNumber.hipart;
+      value.low  = smival->value.hNumber.lopart;
+      return asn_build_unsigned_int64(data, datalength, type, &value);
+    }
+    case sNMP_SYNTAX_BITS:
+      return asn_build_bitstring(data, datalength, type,
+				 smival->value.string.ptr, value_length);
+
+    case sNMP_SYNTAX_OCTETS:
+    case sNMP_SYNTAX_OPAQUE:
+    case sNMP_SYNTAX_IPADDR:
+      return asn_build_string(data, datalength, type,
+			      smival->value.string.ptr, value_length);
+
+    case sNMP_SYNTAX_OID:
+      return asn_build_objid(data, datalength, type,
+			     (oid *)smival->value.oid.ptr,
+			     (int)smival->value.oid.len);
+  }
+  // null and exceptions
+  return asn_build_null(data, datalength, type);
+}
+
+// Only the vbs of requests that retrieve values are encoded with NULL
+// values, regardless of what the application has put into them.
+static inline bool asn1_null_values(const Pdu &pdu)
+{
+  return ((pdu.get_type() == sNMP_PDU_GET) ||
+          (pdu.get_type() == sNMP_PDU_GETNEXT) ||
+          (pdu.get_type() == sNMP_PDU_GETBULK));
+}
+
+// Get the length of the contents of the data pdu and of the contained
+// vb list sequence.
+static int asn1_data_pdu_content_length(const Pdu &pdu, int &vbs_length)
+{
+  const bool null_values = asn1_null_values(pdu);
+  const int vb_count = pdu.get_vb_count();
+
+  vbs_length = 0;
+  for (int i = 0; i < vb_count; ++i)
+  {
+    int length = asn1_vb_length(pdu.get_vb(i), null_values);
+    if (length < 0)
+      return -1;
+    vbs_length += length;
+  }
+
+  return asn1_int_length((long)pdu.get_request_id()) + 2 +
+         asn1_int_length((long)pdu.get_error_status()) + 2 +
+         asn1_int_length((long)pdu.get_error_index()) + 2 +
+         asn1_tlv_length(vbs_length);
+}
+
+int asn1_data_pdu_length(const Pdu &pdu)
+{
+  int vbs_length;
+  int length = asn1_data_pdu_content_length(pdu, vbs_length);
+  if (length < 0)
+    return -1;
+  return asn1_tlv_length(length);
+}
+
+unsigned char *asn1_build_data_pdu(unsigned char *data, int *datalength,
+				   const Pdu &pdu)
+{
+  if (pdu.get_type() == sNMP_PDU_V1TRAP)
+  {
+    ASNERROR("asn1_build_data_pdu: v1 traps need struct snmp_pdu");
+    return NULL;
+  }
+
+  int vbs_length;
+  int length = asn1_data_pdu_content_length(pdu, vbs_length);
+  if (length < 0)
+    return NULL;
+  if (asn1_tlv_length(length) > *datalength)
+    return NULL;
+
+  data = asn_build_header(data, datalength,
+			  (unsigned char)pdu.get_type(), length);
+  if (data == NULL) return NULL;
+
+  long value = (long)pdu.get_request_id();
+  data = asn_build_int(data, datalength, ASN_UNI_PRIM | ASN_INTEGER, &value);
+  if (data == NULL) return NULL;
+
+  value = (long)pdu.get_error_status();
+  data = asn_build_int(data, datalength, ASN_UNI_PRIM | ASN_INTEGER, &value);
+  if (data == NULL) return NULL;
+
+  value = (long)pdu.get_error_index();
+  data = asn_build_int(data, datalength, ASN_UNI_PRIM | ASN_INTEGER, &value);
+  if (data == NULL) return NULL;
+
+  data = asn_build_sequence(data, datalength, ASN_SEQ_CON, vbs_length);
+  if (data == NULL) return NULL;
+
+  const bool null_values = asn1_null_values(pdu);
+  const int vb_count = pdu.get_vb_count();
+  for (int i = 0; (i < vb_count) && data; ++i)
+    data = asn1_build_vb(data, datalength, pdu.get_vb(i), null_values);
+
+  return data;
+}
+
+// serialize the pdu without struct snmp_pdu
+int snmp_build(const Pdu &pdu,
+               unsigned char *packet,          int *out_length,
+               const long version,
+               const unsigned char* community, const int community_len)
+{
+  int pdu_length = asn1_data_pdu_length(pdu);
+  if (pdu_length < 0) return -1;
+
+  int length = asn1_int_length(version) + 2 +
+               asn1_tlv_length(community_len) + pdu_length;
+  if (asn1_tlv_length(length) > *out_length) return -1;
+
+  int left = *out_length;
+  unsigned char *cp = asn_build_sequence(packet, &left, ASN_SEQ_CON, length);
+  if (cp == NULL) return -1;
+
+  cp = asn_build_int(cp, &left, ASN_UNI_PRIM | ASN_INTEGER, &version);
+  if (cp == NULL) return -1;
+
+  cp = asn_build_string(cp, &left, ASN_UNI_PRIM | ASN_OCTET_STR,
+			community, community_len);
+  if (cp == NULL) return -1;
+
+  cp = asn1_build_data_pdu(cp, &left, pdu);
+  if (cp == NULL) return -1;
+
+  *out_length = SAFE_INT_CAST(cp - packet);
+  return 0;
+}
+
 // parse the authentication header
 static unsigned char *snmp_auth_parse(unsigned char *data,
 				      int *length,
@@ -1601,7 +1960,7 @@ int snmp_parse_vb(struct snmp_pdu *pdu, unsigned char *&data, int &data_len)
     memcpy((char *)op, (char *)objid, vp->name_length * sizeof(oid));
     vp->name = op;
 
-    len = MAX_SNMP_PACKET;
+    len = MessageBuffer::get_max_message_size();
     switch((short)vp->type) {
     case ASN_INTEGER:
       vp->val.integer = (long *)malloc(sizeof(long));
@@ -1939,7 +2298,7 @@ unsigned char *asn1_build_scoped_pdu(
                    unsigned char *contextName, long contextNameLength,
                    unsigned char *data, long dataLength)
 {
-  Buffer<unsigned char> buffer(MAX_SNMP_PACKET);
+  MessageBuffer buffer;
   unsigned char *bufPtr = buffer.get_ptr();
   unsigned char *outBufPtr = outBuf;
 
@@ -2005,6 +2364,58 @@ unsigned char *asn1_build_scoped_pdu(
   return outBufPtr;
 }
 
+// Encode the scopedPDU directly from the pdu.
+unsigned char *asn1_build_scoped_pdu(
+                   unsigned char *outBuf, int *max_len,
+                   const OctetStr &contextEngineID, const OctetStr &contextName,
+                   const Pdu &pdu)
+{
+  LOG_BEGIN(loggerModuleName, DEBUG_LOG | 10);
+  LOG("ASN1: coding (context engine id) (context name)");
+  LOG(contextEngineID.get_printable());
+  LOG(contextName.get_printable());
+  LOG_END;
+
+  int pdu_length = asn1_data_pdu_length(pdu);
+  if (pdu_length < 0)
+  {
+    LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
+    LOG("ASN1: Error encoding pdu");
+    LOG_END;
+
+    return 0;
+  }
+
+  int length = asn1_tlv_length(contextEngineID.len()) +
+               asn1_tlv_length(contextName.len()) + pdu_length;
+
+  LOG_BEGIN(loggerModuleName, DEBUG_LOG | 10);
+  LOG("ASN1: Encoding scoped PDU sequence (len)");
+  LOG(length);
+  LOG_END;
+
+  unsigned char *bufPtr = asn_build_sequence(outBuf, max_len,
+                                             ASN_SEQ_CON, length);
+  if (bufPtr)
+    bufPtr = asn_build_string(bufPtr, max_len, ASN_UNI_PRIM | ASN_OCTET_STR,
+                              contextEngineID.data(), contextEngineID.len());
+  if (bufPtr)
+    bufPtr = asn_build_string(bufPtr, max_len, ASN_UNI_PRIM | ASN_OCTET_STR,
+                              contextName.data(), contextName.len());
+  if (bufPtr)
+    bufPtr = asn1_build_data_pdu(bufPtr, max_len, pdu);
+  if (!bufPtr)
+  {
+    LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
+    LOG("ASN1: Error encoding scopedPDU");
+    LOG_END;
+
+    return 0;
+  }
+
+  return bufPtr;
+}
+
 #ifdef SNMP_PP_NAMESPACE
 } // end of namespace Snmp_pp
 #endif 
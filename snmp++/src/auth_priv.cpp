@@ -41,6 +41,7 @@ char auth_priv_version[]="@(#) SNMP++ $Id: auth_priv.cpp 2839 2015-04-25 20:23:2
 #ifdef _USE_OPENSSL
 #include <openssl/des.h>
 #include <openssl/aes.h>
+#include <openssl/evp.h>
 #include <openssl/sha.h>
 #include <openssl/md5.h>
 #endif
@@ -63,6 +64,7 @@ char auth_priv_version[]="@(#) SNMP++ $Id: auth_priv.cpp 2839 2015-04-25 20:23:2
 #endif
 
 #include "snmp_pp/auth_priv.h"
+#include "snmp_pp/mb_hash.h"
 #include "snmp_pp/v3.h"
 #include "snmp_pp/snmperrs.h"
 #include "snmp_pp/address.h"
@@ -110,6 +112,9 @@ typedef des_key_schedule      DESCBCType;
                         des_ncbc_encrypt(ct, pt, l, \
                                          s, (C_Block*)(iv), DES_DECRYPT)
 
+// the IV is passed to each DES_CBC_ENCRYPT/DES_CBC_DECRYPT
+#define DES_CBC_SET_IV(iv, s)
+
 #define DES_EDE3_CBC_ENCRYPT(pt, ct, l, k1, k2, k3, iv) \
                des_ede3_cbc_encrypt(pt, ct, l, \
                                     k1, k2, k3, (C_Block*)(iv), DES_ENCRYPT)
@@ -164,6 +169,12 @@ typedef symmetric_CBC         DESCBCType;
                    debugprintf(0, "Error during DES decryption."); \
                    return SNMPv3_USM_ERROR; \
                  }
+#define DES_CBC_SET_IV(iv, s) \
+                 if (cbc_setiv(iv, 8, &(s)) != CRYPT_OK) \
+                 { \
+                   debugprintf(0, "Setting DES IV failed."); \
+                   return SNMPv3_USM_ERROR; \
+                 }
 #define DES_MEMSET(s, c, l)   memset(&(s), c, l)
 /* -- END: Defines for LibTomCrypt -- */
 
@@ -225,6 +236,7 @@ typedef des_key_schedule      DESCBCType;
 #define DES_CBC_DECRYPT(ct, pt, s, iv, l) \
                         des_ncbc_encrypt((C_Block*)(ct), (C_Block*)(pt), l, \
                                          s, (C_Block*)(iv), DES_DECRYPT)
+#define DES_CBC_SET_IV(iv, s)
 #define DES_MEMSET(s, c, l)   memset(&(s), c, l)
 
 /* -- END: Defines for libdes -- */
@@ -294,8 +306,155 @@ int des3_extend_short_key(const unsigned char * /* password */,
 }
 
 
+/*-----------------[ password to key helpers ]-----------------------*/
+
+// bytes of the expanded password passed to the hash function at once
+#define AP_P2K_CHUNK 1024
+
+// use the multi-buffer hashes for at least this number of passwords
+#define AP_MB_MIN_PASSWORDS 2
+
+// SHA-1 of OpenSSL uses the SHA extensions or AVX2 and is as fast as
+// four SSE2 lanes, so only the AVX2 lanes are used with OpenSSL
+#if defined(SNMP_PP_MB_HASH_LANES) && \
+    (!defined(_USE_OPENSSL) || (SNMP_PP_MB_HASH_LANES >= 8))
+#define AP_MB_SHA1
+#endif
+
+/*
+ * Allocate a buffer with the repeated password, so AP_P2K_CHUNK bytes
+ * of the expanded password can be read from any position within the
+ * password.
+ */
+static unsigned char *p2k_expand_password(const unsigned char *password,
+                                          const unsigned int   password_len)
+{
+  if (!password || (password_len == 0))
+    return 0;
+
+  unsigned char *buf = new unsigned char[password_len + AP_P2K_CHUNK];
+  if (!buf)
+    return 0;
+
+  for (unsigned int i = 0; i < password_len + AP_P2K_CHUNK; ++i)
+    buf[i] = password[i % password_len];
+
+  return buf;
+}
+
+static void p2k_free_password(unsigned char *buf,
+                              const unsigned int password_len)
+{
+  memset(buf, 0, password_len + AP_P2K_CHUNK);
+  delete [] buf;
+}
+
+#ifdef SNMP_PP_MB_HASH_LANES
+static bool p2k_check_passwords(const int                   count,
+                                const unsigned char * const *passwords,
+                                const unsigned int         *password_lens)
+{
+  for (int i = 0; i < count; ++i)
+    if (!passwords[i] || (password_lens[i] == 0))
+      return false;
+  return true;
+}
+#endif
+
+int Auth::passwords_to_ku(const int                   count,
+                          const unsigned char * const *passwords,
+                          const unsigned int         *password_lens,
+                          unsigned char              *kus)
+{
+  for (int i = 0; i < count; ++i)
+  {
+    unsigned int ku_len;
+    int res = password_to_ku(passwords[i], password_lens[i],
+                             kus + i * get_hash_len(), &ku_len);
+    if (res != SNMPv3_USM_OK)
+      return res;
+  }
+  return SNMPv3_USM_OK;
+}
+
+/*-----------------[ parallel password to key ]----------------------*/
+
+// number of passwords a worker takes at once
+#define AP_KU_BATCH_CHUNK 8
+
+#if defined(_THREADS) && !(defined (CPU) && CPU == PPC603)
+#define AP_KU_BATCH_THREADS
+#endif
+
+/*
+ * The state of AuthPriv::passwords_to_ku(), shared by the workers.
+ */
+struct KuBatch
+{
+  Auth                       *auth;
+  int                         count;
+  const unsigned char * const *passwords;
+  const unsigned int         *password_lens;
+  unsigned char              *kus;
+  SnmpAtomicCounter           next_chunk;
+  int                         result;
+  SnmpSynchronized            result_lock;
+};
+
+static void ku_batch_run(KuBatch *batch)
+{
+  const int hash_len = batch->auth->get_hash_len();
+  unsigned char kus[AP_KU_BATCH_CHUNK * SNMPv3_USM_MAX_KEY_LEN];
+
+  for (;;)
+  {
+    int first = (int)(batch->next_chunk.increment() - 1) * AP_KU_BATCH_CHUNK;
+    if (first >= batch->count)
+      break;
+
+    int n = batch->count - first;
+    if (n > AP_KU_BATCH_CHUNK)
+      n = AP_KU_BATCH_CHUNK;
+
+    int res = batch->auth->passwords_to_ku(n, batch->passwords + first,
+                                           batch->password_lens + first,
+                                           kus);
+    if (res != SNMPv3_USM_OK)
+    {
+      SnmpSynchronize s(batch->result_lock);
+      batch->result = res;
+      break;
+    }
+    for (int i = 0; i < n; ++i)
+      memcpy(batch->kus + (first + i) * SNMPv3_USM_MAX_KEY_LEN,
+             kus + i * hash_len, hash_len);
+  }
+  memset(kus, 0, sizeof(kus));
+}
+
+#ifdef AP_KU_BATCH_THREADS
+#ifdef WIN32
+static DWORD WINAPI ku_batch_thread(LPVOID arg)
+{
+  ku_batch_run((KuBatch *)arg);
+  return 0;
+}
+#else
+static void *ku_batch_thread(void *arg)
+{
+  ku_batch_run((KuBatch *)arg);
+  return 0;
+}
+#endif
+#endif // AP_KU_BATCH_THREADS
+
 AuthPriv::AuthPriv(int &construct_state)
 {
+  ku_cache = 0;
+  ku_cache_size = 0;
+  ku_cache_used = 0;
+  ku_cache_next = 0;
+
   auth = new AuthPtr[10];
   priv = new PrivPtr[10];
 
@@ -349,6 +508,13 @@ AuthPriv::AuthPriv(int &construct_state)
 
   construct_state = SNMPv3_USM_OK;
 
+  if (set_ku_cache_size(SNMPv3_AP_KU_CACHE_SIZE) != SNMPv3_USM_OK)
+  {
+    LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
+    LOG("AuthPriv: Error allocating key cache.");
+    LOG_END;
+  }
+
 #if defined(_USE_LIBTOMCRYPT) && !defined(_USE_OPENSSL)
   /* register needed hashes and ciphers in libtomcrypt */
   if (register_cipher(&rijndael_desc) < 0)
@@ -416,6 +582,8 @@ AuthPriv::~AuthPriv()
 
   delete [] auth;
   delete [] priv;
+
+  set_ku_cache_size(0);
 }
 
 int AuthPriv::add_auth(Auth *new_auth)
@@ -725,9 +893,19 @@ int AuthPriv::password_to_key_auth(const int            auth_prot,
   if (!a)
     return SNMPv3_USM_UNSUPPORTED_AUTHPROTOCOL;
 
-  int res = a->password_to_key(password, password_len,
-                               engine_id, engine_id_len,
-                               key, key_len);
+  unsigned char ku[SNMPv3_USM_MAX_KEY_LEN];
+  unsigned int  ku_len;
+
+  /* protocols without password_to_ku() */
+  if (password_to_ku(auth_prot, password, password_len,
+                     ku, &ku_len) != SNMPv3_USM_OK)
+    return a->password_to_key(password, password_len,
+                              engine_id, engine_id_len,
+                              key, key_len);
+
+  int res = a->localize_key(ku, ku_len, engine_id, engine_id_len,
+                            key, key_len);
+  memset(ku, 0, sizeof(ku));
 
   return res;
 }
@@ -765,10 +943,9 @@ int AuthPriv::password_to_key_priv(const int            auth_prot,
   if (!a)  return SNMPv3_USM_UNSUPPORTED_AUTHPROTOCOL;
 
   unsigned int max_key_len = *key_len; /* save length of buffer! */
-  unsigned int min_key_len = p->get_min_key_len();
 
   /* check if buffer for key is long enough */
-  if (min_key_len > max_key_len)
+  if ((unsigned int)p->get_min_key_len() > max_key_len)
     return SNMPv3_USM_ERROR; // TODO: better error code!
 
   int res = password_to_key_auth(auth_prot,
@@ -778,12 +955,27 @@ int AuthPriv::password_to_key_priv(const int            auth_prot,
   if (res != SNMPv3_USM_OK)
     return res;
 
+  return extend_priv_key(p, a, password, password_len,
+                         engine_id, engine_id_len,
+                         key, key_len, max_key_len);
+}
+
+int AuthPriv::extend_priv_key(Priv                *p,
+                              Auth                *a,
+                              const unsigned char *password,
+                              const unsigned int   password_len,
+                              const unsigned char *engine_id,
+                              const unsigned int   engine_id_len,
+                              unsigned char       *key,
+                              unsigned int        *key_len,
+                              const unsigned int   max_key_len)
+{
   /* We have a too short key: Call priv protocoll to extend it */
-  if (*key_len < min_key_len)
+  if (*key_len < (unsigned int)p->get_min_key_len())
   {
-    res = p->extend_short_key(password, password_len,
-                              engine_id, engine_id_len,
-                              key, key_len, max_key_len, a);
+    int res = p->extend_short_key(password, password_len,
+                                  engine_id, engine_id_len,
+                                  key, key_len, max_key_len, a);
     if (res != SNMPv3_USM_OK)
       return res;
   }
@@ -794,7 +986,249 @@ int AuthPriv::password_to_key_priv(const int            auth_prot,
   return SNMPv3_USM_OK;
 }
 
+int AuthPriv::password_to_ku(const int            auth_prot,
+                             const unsigned char *password,
+                             const unsigned int   password_len,
+                             unsigned char       *ku,
+                             unsigned int        *ku_len)
+{
+  if (!password || (password_len == 0))
+    return SNMPv3_USM_ERROR;
+
+  Auth *a = get_auth(auth_prot);
+
+  if (!a)
+    return SNMPv3_USM_UNSUPPORTED_AUTHPROTOCOL;
+
+  if (a->get_hash_len() > SNMPv3_USM_MAX_KEY_LEN)
+    return SNMPv3_USM_ERROR;
+
+  /* the cache is searched by the hash value of the password */
+  unsigned char password_hash[SNMPv3_USM_MAX_KEY_LEN];
+  bool use_cache = (a->hash(password, password_len,
+                            password_hash) == SNMPv3_USM_OK);
+  int hash_len = a->get_hash_len();
+
+  if (use_cache)
+  {
+    SnmpSynchronize s(ku_cache_lock);
+
+    for (int i = 0; i < ku_cache_used; ++i)
+      if ((ku_cache[i].auth_prot == auth_prot) &&
+          (ku_cache[i].password_len == password_len) &&
+          (memcmp(ku_cache[i].password_hash, password_hash, hash_len) == 0))
+      {
+        memcpy(ku, ku_cache[i].ku, ku_cache[i].ku_len);
+        *ku_len = ku_cache[i].ku_len;
+        memset(password_hash, 0, sizeof(password_hash));
+        return SNMPv3_USM_OK;
+      }
+  }
+
+  int res = a->password_to_ku(password, password_len, ku, ku_len);
+
+  if (use_cache && (res == SNMPv3_USM_OK) &&
+      (*ku_len <= SNMPv3_USM_MAX_KEY_LEN))
+  {
+    SnmpSynchronize s(ku_cache_lock);
+
+    if (ku_cache_size > 0)
+    {
+      /* replace the entries in turn */
+      KuCacheEntry &entry = ku_cache[ku_cache_next];
+
+      entry.auth_prot = auth_prot;
+      entry.password_len = password_len;
+      memcpy(entry.password_hash, password_hash, hash_len);
+      memcpy(entry.ku, ku, *ku_len);
+      entry.ku_len = *ku_len;
+
+      ku_cache_next = (ku_cache_next + 1) % ku_cache_size;
+      if (ku_cache_used < ku_cache_size)
+        ++ku_cache_used;
+    }
+  }
+  memset(password_hash, 0, sizeof(password_hash));
+
+  return res;
+}
+
+int AuthPriv::passwords_to_ku(const int                   auth_prot,
+                              const int                   count,
+                              const unsigned char * const *passwords,
+                              const unsigned int         *password_lens,
+                              unsigned char              *kus,
+                              unsigned int               *ku_len,
+                              const int                   threads)
+{
+  Auth *a = get_auth(auth_prot);
+
+  if (!a)
+    return SNMPv3_USM_UNSUPPORTED_AUTHPROTOCOL;
+
+  if (a->get_hash_len() > SNMPv3_USM_MAX_KEY_LEN)
+    return SNMPv3_USM_ERROR;
+
+  *ku_len = a->get_hash_len();
+  if (count <= 0)
+    return SNMPv3_USM_OK;
+
+  KuBatch batch;
+  batch.auth = a;
+  batch.count = count;
+  batch.passwords = passwords;
+  batch.password_lens = password_lens;
+  batch.kus = kus;
+  batch.result = SNMPv3_USM_OK;
+
+#ifdef AP_KU_BATCH_THREADS
+  /* the calling thread is one of the workers */
+  int workers = (count + AP_KU_BATCH_CHUNK - 1) / AP_KU_BATCH_CHUNK;
+  if (workers > threads)
+    workers = threads;
+  int started = 0;
+
+#ifdef WIN32
+  HANDLE *thread_ids = (workers > 1) ? new HANDLE[workers - 1] : 0;
+#else
+  pthread_t *thread_ids = (workers > 1) ? new pthread_t[workers - 1] : 0;
+#endif
+
+  if (thread_ids)
+    for (; started < workers - 1; ++started)
+    {
+#ifdef WIN32
+      DWORD id;
+      thread_ids[started] = CreateThread(NULL, 0, ku_batch_thread,
+                                         &batch, 0, &id);
+      if (thread_ids[started] == NULL)
+        break;
+#else
+      if (pthread_create(&thread_ids[started], NULL, ku_batch_thread,
+                         &batch))
+        break;
+#endif
+    }
+#endif // AP_KU_BATCH_THREADS
+
+  ku_batch_run(&batch);
+
+#ifdef AP_KU_BATCH_THREADS
+  for (int i = 0; i < started; ++i)
+  {
+#ifdef WIN32
+    WaitForSingleObject(thread_ids[i], INFINITE);
+    CloseHandle(thread_ids[i]);
+#else
+    pthread_join(thread_ids[i], NULL);
+#endif
+  }
+  if (thread_ids)
+    delete [] thread_ids;
+#else
+  (void)threads;
+#endif
+
+  return batch.result;
+}
+
+int AuthPriv::localize_key_auth(const int            auth_prot,
+                                const unsigned char *ku,
+                                const unsigned int   ku_len,
+                                const unsigned char *engine_id,
+                                const unsigned int   engine_id_len,
+                                unsigned char       *key,
+                                unsigned int        *key_len)
+{
+  if (auth_prot == SNMP_AUTHPROTOCOL_NONE)
+  {
+    *key_len = 0;
+    return SNMPv3_USM_OK;
+  }
+
+  Auth *a = get_auth(auth_prot);
+
+  if (!a)
+    return SNMPv3_USM_UNSUPPORTED_AUTHPROTOCOL;
+
+  return a->localize_key(ku, ku_len, engine_id, engine_id_len, key, key_len);
+}
+
+int AuthPriv::localize_key_priv(const int            auth_prot,
+                                const int            priv_prot,
+                                const unsigned char *ku,
+                                const unsigned int   ku_len,
+                                const unsigned char *password,
+                                const unsigned int   password_len,
+                                const unsigned char *engine_id,
+                                const unsigned int   engine_id_len,
+                                unsigned char       *key,
+                                unsigned int        *key_len)
+{
+  /* check for priv protocol */
+  if (priv_prot == SNMP_PRIVPROTOCOL_NONE)
+  {
+    *key_len = 0;
+    return SNMPv3_USM_OK;
+  }
+
+  Priv *p = get_priv(priv_prot);
+  Auth *a = get_auth(auth_prot);
+
+  if (!p)  return SNMPv3_USM_UNSUPPORTED_PRIVPROTOCOL;
+  if (!a)  return SNMPv3_USM_UNSUPPORTED_AUTHPROTOCOL;
+
+  unsigned int max_key_len = *key_len; /* save length of buffer! */
+
+  /* check if buffer for key is long enough */
+  if ((unsigned int)p->get_min_key_len() > max_key_len)
+    return SNMPv3_USM_ERROR;
+
+  int res = a->localize_key(ku, ku_len, engine_id, engine_id_len,
+                            key, key_len);
+  if (res != SNMPv3_USM_OK)
+    return res;
+
+  return extend_priv_key(p, a, password, password_len,
+                         engine_id, engine_id_len,
+                         key, key_len, max_key_len);
+}
+
+int AuthPriv::set_ku_cache_size(const int size)
+{
+  KuCacheEntry *new_cache = 0;
+
+  if (size > 0)
+  {
+    new_cache = new KuCacheEntry[size];
+    if (!new_cache)
+      return SNMPv3_USM_ERROR;
+  }
+
+  SnmpSynchronize s(ku_cache_lock);
+
+  if (ku_cache)
+  {
+    memset(ku_cache, 0, ku_cache_size * sizeof(KuCacheEntry));
+    delete [] ku_cache;
+  }
+  ku_cache = new_cache;
+  ku_cache_size = (size > 0) ? size : 0;
+  ku_cache_used = 0;
+  ku_cache_next = 0;
+
+  return SNMPv3_USM_OK;
+}
+
+void AuthPriv::clear_ku_cache()
+{
+  SnmpSynchronize s(ku_cache_lock);
 
+  if (ku_cache)
+    memset(ku_cache, 0, ku_cache_size * sizeof(KuCacheEntry));
+  ku_cache_used = 0;
+  ku_cache_next = 0;
+}
 
 
 int AuthPriv::encrypt_msg(const int            priv_prot,
@@ -807,7 +1241,8 @@ int AuthPriv::encrypt_msg(const int            priv_prot,
                           unsigned char       *privacy_params,
                           unsigned int        *privacy_params_len,
                           const unsigned long  engine_boots,
-                          const unsigned long  engine_time)
+                          const unsigned long  engine_time,
+                          const unsigned char *prepared_key)
 {
   /* check for priv protocol */
   Priv *p = get_priv(priv_prot);
@@ -815,6 +1250,12 @@ int AuthPriv::encrypt_msg(const int            priv_prot,
   if (!p)
     return SNMPv3_USM_UNSUPPORTED_PRIVPROTOCOL;
 
+  if (prepared_key)
+    return p->encrypt_prepared(prepared_key, buffer, buffer_len,
+                               out_buffer, out_buffer_len,
+                               privacy_params, privacy_params_len,
+                               engine_boots, engine_time);
+
   return p->encrypt(key, key_len, buffer, buffer_len,
                     out_buffer, out_buffer_len,
                     privacy_params, privacy_params_len,
@@ -831,7 +1272,8 @@ int AuthPriv::decrypt_msg(const int            priv_prot,
                           const unsigned char *privacy_params,
                           const unsigned int   privacy_params_len,
                           const unsigned long  engine_boots,
-                          const unsigned long  engine_time)
+                          const unsigned long  engine_time,
+                          const unsigned char *prepared_key)
 {
   /* check for priv protocol */
   Priv *p = get_priv(priv_prot);
@@ -839,6 +1281,12 @@ int AuthPriv::decrypt_msg(const int            priv_prot,
   if (!p)
     return SNMPv3_USM_UNSUPPORTED_PRIVPROTOCOL;
 
+  if (prepared_key)
+    return p->decrypt_prepared(prepared_key, buffer, buffer_len,
+                               out_buffer, out_buffer_len,
+                               privacy_params, privacy_params_len,
+                               engine_boots, engine_time);
+
   return p->decrypt(key, key_len, buffer, buffer_len,
                     out_buffer, out_buffer_len,
                     privacy_params, privacy_params_len,
@@ -959,11 +1407,91 @@ int AuthPriv::get_priv_params_len(const int priv_prot)
   return p->get_priv_params_len();
 }
 
+int AuthPriv::get_prepared_key_len(const int auth_prot)
+{
+  Auth *a = get_auth(auth_prot);
+
+  if (!a)
+    return 0;
+
+  return a->get_prepared_key_len();
+}
+
+int AuthPriv::prepare_key(const int            auth_prot,
+                          const unsigned char *key,
+                          const unsigned int   key_len,
+                          unsigned char       *prepared_key)
+{
+  Auth *a = get_auth(auth_prot);
+
+  if (!a)
+    return SNMPv3_USM_UNSUPPORTED_AUTHPROTOCOL;
+
+  return a->prepare_key(key, key_len, prepared_key);
+}
+
+int Priv::copy_prepared_key(const unsigned char *src,
+                            unsigned char       *dst) const
+{
+  memcpy(dst, src, get_prepared_key_len());
+  return SNMPv3_USM_OK;
+}
+
+void Priv::clear_prepared_key(unsigned char *prepared_key) const
+{
+  memset(prepared_key, 0, get_prepared_key_len());
+}
+
+int AuthPriv::get_prepared_priv_key_len(const int priv_prot)
+{
+  Priv *p = get_priv(priv_prot);
+
+  if (!p)
+    return 0;
+
+  return p->get_prepared_key_len();
+}
+
+int AuthPriv::prepare_priv_key(const int            priv_prot,
+                               const unsigned char *key,
+                               const unsigned int   key_len,
+                               unsigned char       *prepared_key)
+{
+  Priv *p = get_priv(priv_prot);
+
+  if (!p)
+    return SNMPv3_USM_UNSUPPORTED_PRIVPROTOCOL;
+
+  return p->prepare_key(key, key_len, prepared_key);
+}
+
+int AuthPriv::copy_prepared_priv_key(const int            priv_prot,
+                                     const unsigned char *src,
+                                     unsigned char       *dst)
+{
+  Priv *p = get_priv(priv_prot);
+
+  if (!p)
+    return SNMPv3_USM_UNSUPPORTED_PRIVPROTOCOL;
+
+  return p->copy_prepared_key(src, dst);
+}
+
+void AuthPriv::clear_prepared_priv_key(const int      priv_prot,
+                                       unsigned char *prepared_key)
+{
+  Priv *p = get_priv(priv_prot);
+
+  if (p)
+    p->clear_prepared_key(prepared_key);
+}
+
 int AuthPriv::auth_out_msg(const int            auth_prot,
                            const unsigned char *key,
                            unsigned char       *msg,
                            const int            msg_len,
-                           unsigned char       *auth_par_ptr)
+                           unsigned char       *auth_par_ptr,
+                           const unsigned char *prepared_key)
 {
   if (auth_prot == SNMP_AUTHPROTOCOL_NONE)
     return SNMPv3_USM_UNSUPPORTED_SECURITY_LEVEL;
@@ -973,6 +1501,9 @@ int AuthPriv::auth_out_msg(const int            auth_prot,
   if (!a)
     return SNMPv3_USM_UNSUPPORTED_AUTHPROTOCOL;
 
+  if (prepared_key)
+    return a->auth_out_msg_prepared(prepared_key, msg, msg_len, auth_par_ptr);
+
   return a->auth_out_msg(key, msg, msg_len, auth_par_ptr);
 }
 
@@ -981,7 +1512,8 @@ int AuthPriv::auth_inc_msg(const int            auth_prot,
                            unsigned char       *msg,
                            const int            msg_len,
                            unsigned char       *auth_par_ptr,
-                           const int            auth_par_len)
+                           const int            auth_par_len,
+                           const unsigned char *prepared_key)
 {
   if (auth_prot == SNMP_AUTHPROTOCOL_NONE)
     return SNMPv3_USM_UNSUPPORTED_SECURITY_LEVEL;
@@ -1007,6 +1539,10 @@ int AuthPriv::auth_inc_msg(const int            auth_prot,
   }
   */
 
+  if (prepared_key)
+    return a->auth_inc_msg_prepared(prepared_key, msg, msg_len,
+                                    auth_par_ptr, auth_par_len);
+
   return a->auth_inc_msg(key, msg, msg_len, auth_par_ptr, auth_par_len);
 }
 
@@ -1021,8 +1557,6 @@ int AuthSHA::password_to_key(const unsigned char *password,
                              unsigned char *key,
                              unsigned int *key_len)
 {
-  *key_len = 20; /* All SHA keys have 20 bytes length */
-
 #ifdef __DEBUG
   debugprintf(5,"password_to_key SHA: password: (%s).",
               OctetStr(password, password_len).get_printable());
@@ -1030,49 +1564,105 @@ int AuthSHA::password_to_key(const unsigned char *password,
               OctetStr(engine_id, engine_id_len).get_printable());
 #endif
 
-  SHAHashStateType sha_hash_state;
-  unsigned char *cp, password_buf[72];
-  unsigned long  password_index = 0;
-  unsigned long  count = 0, i;
+  unsigned char ku[SNMPv3_AP_OUTPUT_LENGTH_SHA];
+  unsigned int  ku_len;
 
-  SHA1_INIT(&sha_hash_state);   /* initialize SHA */
+  int res = password_to_ku(password, password_len, ku, &ku_len);
+  if (res == SNMPv3_USM_OK)
+    res = localize_key(ku, ku_len, engine_id, engine_id_len, key, key_len);
 
-  /**********************************************/
-  /* Use while loop until we've done 1 Megabyte */
-  /**********************************************/
-  while (count < 1048576) {
-    cp = password_buf;
-    for (i = 0; i < 64; i++) {
-      /*************************************************/
-      /* Take the next octet of the password, wrapping */
-      /* to the beginning of the password as necessary.*/
-      /*************************************************/
-      *cp++ = password[password_index++ % password_len];
-    }
+  memset(ku, 0, sizeof(ku));
+  return res;
+}
 
-    SHA1_PROCESS(&sha_hash_state, password_buf, 64);
-    count += 64;
-  }
+int AuthSHA::password_to_ku(const unsigned char *password,
+                            const unsigned int   password_len,
+                            unsigned char       *ku,
+                            unsigned int        *ku_len)
+{
+  unsigned char *password_buf = p2k_expand_password(password, password_len);
+  if (!password_buf)
+    return SNMPv3_USM_ERROR;
+
+  SHAHashStateType sha_hash_state;
+  unsigned long    password_index = 0;
+
+  SHA1_INIT(&sha_hash_state);   /* initialize SHA */
+
+  /*****************************************************/
+  /* Hash 1 Megabyte of the repeated password, the     */
+  /* buffer holds AP_P2K_CHUNK bytes from any position */
+  /* within the password                               */
+  /*****************************************************/
+  for (unsigned long count = 0; count < 1048576; count += AP_P2K_CHUNK)
+  {
+    SHA1_PROCESS(&sha_hash_state, password_buf + password_index,
+                 AP_P2K_CHUNK);
+    password_index = (password_index + AP_P2K_CHUNK) % password_len;
+  }
+
+  SHA1_DONE(&sha_hash_state, ku);          /* tell SHA we're done */
+  *ku_len = SNMPv3_AP_OUTPUT_LENGTH_SHA;
 
-  SHA1_DONE(&sha_hash_state, key);          /* tell SHA we're done */
+  p2k_free_password(password_buf, password_len);
 
 #ifdef __DEBUG
-  debughexcprintf(21, "key", key, *key_len);
+  debughexcprintf(21, "key", ku, *ku_len);
+#endif
+
+  return SNMPv3_USM_OK;
+}
+
+int AuthSHA::passwords_to_ku(const int                   count,
+                             const unsigned char * const *passwords,
+                             const unsigned int         *password_lens,
+                             unsigned char              *kus)
+{
+#ifdef AP_MB_SHA1
+  int i = 0;
+  while (count - i >= AP_MB_MIN_PASSWORDS)
+  {
+    int n = count - i;
+    if (n > SNMP_PP_MB_HASH_LANES)
+      n = SNMP_PP_MB_HASH_LANES;
+
+    if (!p2k_check_passwords(n, passwords + i, password_lens + i) ||
+        !mb_sha1_password_to_ku(n, passwords + i, password_lens + i,
+                                kus + i * SNMPv3_AP_OUTPUT_LENGTH_SHA))
+      return SNMPv3_USM_ERROR;
+    i += n;
+  }
+  if (i < count)
+    return Auth::passwords_to_ku(count - i, passwords + i, password_lens + i,
+                                 kus + i * SNMPv3_AP_OUTPUT_LENGTH_SHA);
+  return SNMPv3_USM_OK;
+#else
+  return Auth::passwords_to_ku(count, passwords, password_lens, kus);
 #endif
+}
+
+int AuthSHA::localize_key(const unsigned char *ku,
+                          const unsigned int   ku_len,
+                          const unsigned char *engine_id,
+                          const unsigned int   engine_id_len,
+                          unsigned char       *key,
+                          unsigned int        *key_len)
+{
+  if (ku_len != SNMPv3_AP_OUTPUT_LENGTH_SHA)
+    return SNMPv3_USM_ERROR;
 
   /*****************************************************/
-  /* Now localize the key with the engine_id and pass  */
+  /* Localize the key with the engine_id and pass      */
   /* through SHA to produce final key                  */
-  /* May want to ensure that engine_id_len <= 32,      */
-  /* otherwise need to use a buffer larger than 72     */
   /*****************************************************/
-  memcpy(password_buf,                            key,       *key_len);
-  memcpy(password_buf + *key_len,                 engine_id, engine_id_len);
-  memcpy(password_buf + *key_len + engine_id_len, key,       *key_len);
+  SHAHashStateType sha_hash_state;
 
   SHA1_INIT(&sha_hash_state);
-  SHA1_PROCESS(&sha_hash_state, password_buf, (2 * *key_len) + engine_id_len);
+  SHA1_PROCESS(&sha_hash_state, ku,        ku_len);
+  SHA1_PROCESS(&sha_hash_state, engine_id, engine_id_len);
+  SHA1_PROCESS(&sha_hash_state, ku,        ku_len);
   SHA1_DONE(&sha_hash_state, key);
+  *key_len = SNMPv3_AP_OUTPUT_LENGTH_SHA; /* All SHA keys have 20 bytes */
 
 #ifdef __DEBUG
   debughexcprintf(21, "localized key", key, *key_len);
@@ -1094,21 +1684,34 @@ int AuthSHA::hash(const unsigned char *data,
   return SNMPv3_USM_OK;
 }
 
-int AuthSHA::auth_out_msg(const unsigned char *key,
-                          unsigned char *msg,
-                          const int msg_len,
-                          unsigned char *auth_par_ptr)
+/*
+ * The prepared key of HMAC-SHA: the hash states after the
+ * inner and the outer pad block of the key.
+ */
+struct SHAPreparedKey
 {
-  SHAHashStateType sha_hash_state;
-  int           key_len = 20; /* We use only 20 Byte Key! */
-  unsigned char digest[20];
-  unsigned char k_ipad[65];   /* inner padding - key XORd with ipad */
-  unsigned char k_opad[65];   /* outer padding - key XORd with opad */
+  SHAHashStateType inner;
+  SHAHashStateType outer;
+};
 
-  memset((char*)(auth_par_ptr), 0, 12);
+int AuthSHA::get_prepared_key_len() const
+{
+  return sizeof(SHAPreparedKey);
+}
+
+int AuthSHA::prepare_key(const unsigned char *key,
+                         const unsigned int   key_len,
+                         unsigned char       *prepared_key) const
+{
+  SHAPreparedKey state;
+  unsigned char k_ipad[64];   /* inner padding - key XORd with ipad */
+  unsigned char k_opad[64];   /* outer padding - key XORd with opad */
+
+  if (key_len < 20) /* We use only 20 Byte Key! */
+    return SNMPv3_USM_ERROR;
 
 #ifdef __DEBUG
-  debughexcprintf(21, "key", key, 16);
+  debughexcprintf(21, "key", key, 20);
 #endif
 
   /*
@@ -1120,6 +1723,9 @@ int AuthSHA::auth_out_msg(const unsigned char *key,
    * ipad is the byte 0x36 repeated 64 times
    * opad is the byte 0x5c repeated 64 times
    * and text is the data being protected
+   *
+   * The hash states after the first block of both passes only
+   * depend on the key, so they are computed once per key.
    */
 
   /* start out by storing ipads and opads in pads */
@@ -1127,21 +1733,46 @@ int AuthSHA::auth_out_msg(const unsigned char *key,
   memset( (char*)k_opad, 0x5c, sizeof k_opad);
 
   /* XOR pads with key */
-  for (int i=0; i < key_len; ++i) {
+  for (int i=0; i < 20; ++i) {
     k_ipad[i] ^= key[i];
     k_opad[i] ^= key[i];
   }
 
+  SHA1_INIT(&state.inner);              /* init state for 1st pass  */
+  SHA1_PROCESS(&state.inner, k_ipad, 64);      /* start with inner pad      */
+  SHA1_INIT(&state.outer);              /* init state for 2nd pass  */
+  SHA1_PROCESS(&state.outer, k_opad, 64);      /* start with outer pad      */
+
+  memcpy(prepared_key, &state, sizeof(state));
+
+  memset(&state, 0, sizeof(state));
+  memset(k_ipad, 0, sizeof k_ipad);
+  memset(k_opad, 0, sizeof k_opad);
+
+  return SNMPv3_USM_OK;
+}
+
+int AuthSHA::auth_out_msg_prepared(const unsigned char *prepared_key,
+                                   unsigned char *msg,
+                                   const int msg_len,
+                                   unsigned char *auth_par_ptr)
+{
+  SHAPreparedKey state;
+  unsigned char digest[20];
+
+  memset((char*)(auth_par_ptr), 0, 12);
+
+  /* continue with the states after the pad blocks */
+  memcpy(&state, prepared_key, sizeof(state));
+
   /* perform inner SHA */
-  SHA1_INIT(&sha_hash_state);           /* init sha_hash_state for 1st pass */
-  SHA1_PROCESS(&sha_hash_state, k_ipad, 64);   /* start with inner pad      */
-  SHA1_PROCESS(&sha_hash_state, msg, msg_len); /* then text of datagram     */
-  SHA1_DONE(&sha_hash_state, digest);          /* finish up 1st pass        */
+  SHA1_PROCESS(&state.inner, msg, msg_len);    /* text of datagram          */
+  SHA1_DONE(&state.inner, digest);             /* finish up 1st pass        */
   /* perform outer SHA */
-  SHA1_INIT(&sha_hash_state);           /* init sha_hash_state for 2nd pass */
-  SHA1_PROCESS(&sha_hash_state, k_opad, 64);   /* start with outer pad      */
-  SHA1_PROCESS(&sha_hash_state, digest, 20);   /* then results of 1st hash  */
-  SHA1_DONE(&sha_hash_state, digest);          /* finish up 2nd pass        */
+  SHA1_PROCESS(&state.outer, digest, 20);      /* results of 1st hash       */
+  SHA1_DONE(&state.outer, digest);             /* finish up 2nd pass        */
+
+  memset(&state, 0, sizeof(state));
 
 #ifdef __DEBUG
   debughexcprintf(21,"digest", digest, 160 / 8);
@@ -1152,12 +1783,45 @@ int AuthSHA::auth_out_msg(const unsigned char *key,
   return SNMPv3_USM_OK;
 }
 
+int AuthSHA::auth_out_msg(const unsigned char *key,
+                          unsigned char *msg,
+                          const int msg_len,
+                          unsigned char *auth_par_ptr)
+{
+  unsigned char prepared_key[sizeof(SHAPreparedKey)];
+
+  prepare_key(key, 20, prepared_key);
+
+  int res = auth_out_msg_prepared(prepared_key, msg, msg_len, auth_par_ptr);
+
+  memset(prepared_key, 0, sizeof(prepared_key));
+
+  return res;
+}
 
 int AuthSHA::auth_inc_msg(const unsigned char *key,
                           unsigned char *msg,
                           const int msg_len,
                           unsigned char *auth_par_ptr,
                           const int      auth_par_len)
+{
+  unsigned char prepared_key[sizeof(SHAPreparedKey)];
+
+  prepare_key(key, 20, prepared_key);
+
+  int res = auth_inc_msg_prepared(prepared_key, msg, msg_len,
+                                  auth_par_ptr, auth_par_len);
+
+  memset(prepared_key, 0, sizeof(prepared_key));
+
+  return res;
+}
+
+int AuthSHA::auth_inc_msg_prepared(const unsigned char *prepared_key,
+                                   unsigned char *msg,
+                                   const int msg_len,
+                                   unsigned char *auth_par_ptr,
+                                   const int      auth_par_len)
 {
   unsigned char receivedDigest[20];
 
@@ -1170,13 +1834,13 @@ int AuthSHA::auth_inc_msg(const unsigned char *key,
 
 #ifdef __DEBUG
   debughexcprintf(21, "digest in Message", auth_par_ptr, 12);
-  debughexcprintf(21, "key", key, 20);
 #endif
 
   /* Save received digest */
   memcpy(receivedDigest, auth_par_ptr, 12);
 
-  if (SNMPv3_USM_OK != auth_out_msg(key, msg, msg_len, auth_par_ptr))
+  if (SNMPv3_USM_OK != auth_out_msg_prepared(prepared_key, msg, msg_len,
+                                             auth_par_ptr))
   {
     /* copy digest back into message and return error */
     memcpy(auth_par_ptr, receivedDigest, 12);
@@ -1209,56 +1873,112 @@ int AuthMD5::password_to_key(const unsigned char *password,
                              unsigned char *key,
                              unsigned int *key_len)
 {
-  *key_len = 16; /* All MD5 keys have 16 bytes length */
-
 #ifdef __DEBUG
-  debugprintf(5,"password: %s.",
+  debugprintf(5,"password_to_key MD5: password: (%s).",
               OctetStr(password, password_len).get_printable());
-  debugprintf(5,"engineID: %s.",
+  debugprintf(5,"password_to_key MD5: engine_id: (%s).",
               OctetStr(engine_id, engine_id_len).get_printable());
 #endif
 
+  unsigned char ku[SNMPv3_AP_OUTPUT_LENGTH_MD5];
+  unsigned int  ku_len;
+
+  int res = password_to_ku(password, password_len, ku, &ku_len);
+  if (res == SNMPv3_USM_OK)
+    res = localize_key(ku, ku_len, engine_id, engine_id_len, key, key_len);
+
+  memset(ku, 0, sizeof(ku));
+  return res;
+}
+
+int AuthMD5::password_to_ku(const unsigned char *password,
+                            const unsigned int   password_len,
+                            unsigned char       *ku,
+                            unsigned int        *ku_len)
+{
+  unsigned char *password_buf = p2k_expand_password(password, password_len);
+  if (!password_buf)
+    return SNMPv3_USM_ERROR;
+
   MD5HashStateType md5_hash_state;
-  unsigned char  *cp, password_buf[65];
-  unsigned long   password_index = 0;
-  unsigned long   count = 0, i;
+  unsigned long    password_index = 0;
 
   MD5_INIT(&md5_hash_state);   /* initialize MD5 */
 
-  /**********************************************/
-  /* Use while loop until we've done 1 Megabyte */
-  /**********************************************/
-  while (count < 1048576) {
-    cp = password_buf;
-    for (i = 0; i < 64; i++) {
-      /*************************************************/
-      /* Take the next octet of the password, wrapping */
-      /* to the beginning of the password as necessary.*/
-      /*************************************************/
-      *cp++ = password[password_index++ % password_len];
-    }
-    MD5_PROCESS(&md5_hash_state, password_buf, 64);
-    count += 64;
+  /*****************************************************/
+  /* Hash 1 Megabyte of the repeated password, the     */
+  /* buffer holds AP_P2K_CHUNK bytes from any position */
+  /* within the password                               */
+  /*****************************************************/
+  for (unsigned long count = 0; count < 1048576; count += AP_P2K_CHUNK)
+  {
+    MD5_PROCESS(&md5_hash_state, password_buf + password_index,
+                 AP_P2K_CHUNK);
+    password_index = (password_index + AP_P2K_CHUNK) % password_len;
   }
-  MD5_DONE(&md5_hash_state, key);      /* tell MD5 we're done */
+
+  MD5_DONE(&md5_hash_state, ku);          /* tell MD5 we're done */
+  *ku_len = SNMPv3_AP_OUTPUT_LENGTH_MD5;
+
+  p2k_free_password(password_buf, password_len);
 
 #ifdef __DEBUG
-  debughexcprintf(21, "key", key, *key_len);
+  debughexcprintf(21, "key", ku, *ku_len);
 #endif
 
+  return SNMPv3_USM_OK;
+}
+
+int AuthMD5::passwords_to_ku(const int                   count,
+                             const unsigned char * const *passwords,
+                             const unsigned int         *password_lens,
+                             unsigned char              *kus)
+{
+#ifdef SNMP_PP_MB_HASH_LANES
+  int i = 0;
+  while (count - i >= AP_MB_MIN_PASSWORDS)
+  {
+    int n = count - i;
+    if (n > SNMP_PP_MB_HASH_LANES)
+      n = SNMP_PP_MB_HASH_LANES;
+
+    if (!p2k_check_passwords(n, passwords + i, password_lens + i) ||
+        !mb_md5_password_to_ku(n, passwords + i, password_lens + i,
+                                kus + i * SNMPv3_AP_OUTPUT_LENGTH_MD5))
+      return SNMPv3_USM_ERROR;
+    i += n;
+  }
+  if (i < count)
+    return Auth::passwords_to_ku(count - i, passwords + i, password_lens + i,
+                                 kus + i * SNMPv3_AP_OUTPUT_LENGTH_MD5);
+  return SNMPv3_USM_OK;
+#else
+  return Auth::passwords_to_ku(count, passwords, password_lens, kus);
+#endif
+}
+
+int AuthMD5::localize_key(const unsigned char *ku,
+                          const unsigned int   ku_len,
+                          const unsigned char *engine_id,
+                          const unsigned int   engine_id_len,
+                          unsigned char       *key,
+                          unsigned int        *key_len)
+{
+  if (ku_len != SNMPv3_AP_OUTPUT_LENGTH_MD5)
+    return SNMPv3_USM_ERROR;
+
   /*****************************************************/
-  /* Now localize the key with the engine_id and pass  */
+  /* Localize the key with the engine_id and pass      */
   /* through MD5 to produce final key                  */
-  /* May want to ensure that engine_id_len <= 32,      */
-  /* otherwise need to use a buffer larger than 64     */
   /*****************************************************/
-  memcpy(password_buf,                            key,       *key_len);
-  memcpy(password_buf + *key_len,                 engine_id, engine_id_len);
-  memcpy(password_buf + *key_len + engine_id_len, key,       *key_len);
+  MD5HashStateType md5_hash_state;
 
   MD5_INIT(&md5_hash_state);
-  MD5_PROCESS(&md5_hash_state, password_buf, (2 * *key_len) + engine_id_len);
+  MD5_PROCESS(&md5_hash_state, ku,        ku_len);
+  MD5_PROCESS(&md5_hash_state, engine_id, engine_id_len);
+  MD5_PROCESS(&md5_hash_state, ku,        ku_len);
   MD5_DONE(&md5_hash_state, key);
+  *key_len = SNMPv3_AP_OUTPUT_LENGTH_MD5; /* All MD5 keys have 16 bytes */
 
 #ifdef __DEBUG
   debughexcprintf(21, "localized key", key, *key_len);
@@ -1280,18 +2000,31 @@ int AuthMD5::hash(const unsigned char *data,
   return SNMPv3_USM_OK;
 }
 
-int AuthMD5::auth_out_msg(const unsigned char *key,
-                          unsigned char *msg,
-                          const int      msg_len,
-                          unsigned char *auth_par_ptr)
+/*
+ * The prepared key of HMAC-MD5: the hash states after the
+ * inner and the outer pad block of the key.
+ */
+struct MD5PreparedKey
 {
-  MD5HashStateType md5_hash_state;
-  int           key_len = 16; /* We use only 16 Byte Key! */
-  unsigned char digest[16];
-  unsigned char k_ipad[65];   /* inner padding - key XORd with ipad */
-  unsigned char k_opad[65];   /* outer padding - key XORd with opad */
+  MD5HashStateType inner;
+  MD5HashStateType outer;
+};
 
-  memset((char*)(auth_par_ptr), 0, 12);
+int AuthMD5::get_prepared_key_len() const
+{
+  return sizeof(MD5PreparedKey);
+}
+
+int AuthMD5::prepare_key(const unsigned char *key,
+                         const unsigned int   key_len,
+                         unsigned char       *prepared_key) const
+{
+  MD5PreparedKey state;
+  unsigned char k_ipad[64];   /* inner padding - key XORd with ipad */
+  unsigned char k_opad[64];   /* outer padding - key XORd with opad */
+
+  if (key_len < 16) /* We use only 16 Byte Key! */
+    return SNMPv3_USM_ERROR;
 
 #ifdef __DEBUG
   debughexcprintf(21, "key", key, 16);
@@ -1306,33 +2039,59 @@ int AuthMD5::auth_out_msg(const unsigned char *key,
    * ipad is the byte 0x36 repeated 64 times
    * opad is the byte 0x5c repeated 64 times
    * and text is the data being protected
+   *
+   * The hash states after the first block of both passes only
+   * depend on the key, so they are computed once per key.
    */
 
-  /* start out by storing key in pads */
-  memset( (char*)k_ipad, 0, sizeof k_ipad);
-  memset( (char*)k_opad, 0, sizeof k_opad);
-  memcpy( (char*)k_ipad, (char*)key, key_len);
-  memcpy( (char*)k_opad, (char*)key, key_len);
+  /* start out by storing ipads and opads in pads */
+  memset( (char*)k_ipad, 0x36, sizeof k_ipad);
+  memset( (char*)k_opad, 0x5c, sizeof k_opad);
 
-  /* XOR key with ipad and opad values */
-  for (int i=0; i<64; i++) {
-    k_ipad[i] ^= 0x36;
-    k_opad[i] ^= 0x5c;
+  /* XOR pads with key */
+  for (int i=0; i < 16; ++i) {
+    k_ipad[i] ^= key[i];
+    k_opad[i] ^= key[i];
   }
 
+  MD5_INIT(&state.inner);               /* init state for 1st pass  */
+  MD5_PROCESS(&state.inner, k_ipad, 64);       /* start with inner pad      */
+  MD5_INIT(&state.outer);               /* init state for 2nd pass  */
+  MD5_PROCESS(&state.outer, k_opad, 64);       /* start with outer pad      */
+
+  memcpy(prepared_key, &state, sizeof(state));
+
+  memset(&state, 0, sizeof(state));
+  memset(k_ipad, 0, sizeof k_ipad);
+  memset(k_opad, 0, sizeof k_opad);
+
+  return SNMPv3_USM_OK;
+}
+
+int AuthMD5::auth_out_msg_prepared(const unsigned char *prepared_key,
+                                   unsigned char *msg,
+                                   const int msg_len,
+                                   unsigned char *auth_par_ptr)
+{
+  MD5PreparedKey state;
+  unsigned char digest[16];
+
+  memset((char*)(auth_par_ptr), 0, 12);
+
+  /* continue with the states after the pad blocks */
+  memcpy(&state, prepared_key, sizeof(state));
+
   /* perform inner MD5 */
-  MD5_INIT(&md5_hash_state);            /* init md5_hash_state for 1st pass */
-  MD5_PROCESS(&md5_hash_state, k_ipad, 64);    /* start with inner pad      */
-  MD5_PROCESS(&md5_hash_state, msg, msg_len);  /* then text of datagram     */
-  MD5_DONE(&md5_hash_state, digest);           /* finish up 1st pass        */
+  MD5_PROCESS(&state.inner, msg, msg_len);     /* text of datagram          */
+  MD5_DONE(&state.inner, digest);              /* finish up 1st pass        */
   /* perform outer MD5 */
-  MD5_INIT(&md5_hash_state);            /* init md5_hash_state for 2nd pass */
-  MD5_PROCESS(&md5_hash_state, k_opad, 64);    /* start with outer pad      */
-  MD5_PROCESS(&md5_hash_state, digest, 16);    /* then results of 1st hash  */
-  MD5_DONE(&md5_hash_state, digest);           /* finish up 2nd pass        */
+  MD5_PROCESS(&state.outer, digest, 16);       /* results of 1st hash       */
+  MD5_DONE(&state.outer, digest);              /* finish up 2nd pass        */
+
+  memset(&state, 0, sizeof(state));
 
 #ifdef __DEBUG
-  debughexcprintf(21, "digest", digest, 128 / 8);
+  debughexcprintf(21,"digest", digest, 128 / 8);
 #endif
 
   memcpy(auth_par_ptr, digest, 12);
@@ -1340,11 +2099,45 @@ int AuthMD5::auth_out_msg(const unsigned char *key,
   return SNMPv3_USM_OK;
 }
 
+int AuthMD5::auth_out_msg(const unsigned char *key,
+                          unsigned char *msg,
+                          const int msg_len,
+                          unsigned char *auth_par_ptr)
+{
+  unsigned char prepared_key[sizeof(MD5PreparedKey)];
+
+  prepare_key(key, 16, prepared_key);
+
+  int res = auth_out_msg_prepared(prepared_key, msg, msg_len, auth_par_ptr);
+
+  memset(prepared_key, 0, sizeof(prepared_key));
+
+  return res;
+}
+
 int AuthMD5::auth_inc_msg(const unsigned char *key,
                           unsigned char *msg,
                           const int msg_len,
                           unsigned char *auth_par_ptr,
                           const int      auth_par_len)
+{
+  unsigned char prepared_key[sizeof(MD5PreparedKey)];
+
+  prepare_key(key, 16, prepared_key);
+
+  int res = auth_inc_msg_prepared(prepared_key, msg, msg_len,
+                                  auth_par_ptr, auth_par_len);
+
+  memset(prepared_key, 0, sizeof(prepared_key));
+
+  return res;
+}
+
+int AuthMD5::auth_inc_msg_prepared(const unsigned char *prepared_key,
+                                   unsigned char *msg,
+                                   const int msg_len,
+                                   unsigned char *auth_par_ptr,
+                                   const int      auth_par_len)
 {
   unsigned char receivedDigest[16];
 
@@ -1357,12 +2150,13 @@ int AuthMD5::auth_inc_msg(const unsigned char *key,
 
 #ifdef __DEBUG
   debughexcprintf(21, "digest in Message", auth_par_ptr, 12);
-  debughexcprintf(21, "key", key, 16);
 #endif
 
+  /* Save received digest */
   memcpy(receivedDigest, auth_par_ptr, 12);
 
-  if (SNMPv3_USM_OK != auth_out_msg(key, msg, msg_len, auth_par_ptr))
+  if (SNMPv3_USM_OK != auth_out_msg_prepared(prepared_key, msg, msg_len,
+                                             auth_par_ptr))
   {
     /* copy digest back into message and return error */
     memcpy(auth_par_ptr, receivedDigest, 12);
@@ -1389,6 +2183,87 @@ int AuthMD5::auth_inc_msg(const unsigned char *key,
 
 /* ----------------------- PrivDES ---------------------------------------*/
 
+#ifndef RSAEURO
+// The prepared key of PrivDES: the key schedule of the first 8 bytes
+// and the last 8 bytes of the key, the base of the initialization vector
+struct DESPreparedKey
+{
+  DESCBCType    symcbc;
+  unsigned char pre_iv[8];
+};
+#endif
+
+// Build the initialization vector from the last 8 bytes of the key and
+// the salt, which is written to the privacy parameters
+static void des_init_vector(const unsigned char *pre_iv,
+                            pp_uint64            my_salt,
+                            const unsigned long  engine_boots,
+                            unsigned char       *privacy_params,
+                            unsigned char       *initVect)
+{
+#ifdef INVALID_ENCRYPTION
+  debugprintf(-10, "\nWARNING: Encrypting with zeroed salt!\n");
+  my_salt = 0;
+#endif
+
+  // last 8 bytes of key are used as base for initialization vector
+  memcpy((char*)initVect, pre_iv, 8);
+
+  // put salt in privacy_params
+  for (int j=0; j<4; j++)
+  {
+    privacy_params[3-j] = (unsigned char) (0xFF & (engine_boots >> (8*j)));
+    privacy_params[7-j] = (unsigned char) (0xFF & (my_salt >> (8*j)));
+  }
+
+  // xor initVect with salt
+  for (int i=0; i<8; i++)
+    initVect[i] ^= privacy_params[i];
+}
+
+// Encrypt the buffer in CBC mode, the last block is padded with zeros
+static int des_cbc_encrypt_buffer(DESCBCType          &symcbc,
+                                  unsigned char       *initVect,
+                                  const unsigned char *buffer,
+                                  const unsigned int   buffer_len,
+                                  unsigned char       *out_buffer,
+                                  unsigned int        *out_buffer_len)
+{
+  for(unsigned int k = 0; k + 8 <= buffer_len; k += 8) {
+    DES_CBC_ENCRYPT(buffer + k, out_buffer + k, symcbc, initVect, 8);
+  }
+
+  /* last part of buffer */
+  if (buffer_len % 8)
+  {
+    unsigned char tmp_buf[8];
+    unsigned char *tmp_buf_ptr = tmp_buf;
+    int start = buffer_len - (buffer_len % 8);
+    memset(tmp_buf, 0, 8);
+    for (unsigned int l = start; l < buffer_len; l++)
+      *tmp_buf_ptr++ = buffer[l];
+    DES_CBC_ENCRYPT(tmp_buf, out_buffer + start, symcbc, initVect, 8);
+    *out_buffer_len = buffer_len + 8 - (buffer_len % 8);
+  }
+  else
+    *out_buffer_len = buffer_len;
+
+  return SNMPv3_USM_OK;
+}
+
+// Decrypt the buffer in CBC mode, buffer_len is a multiple of 8
+static int des_cbc_decrypt_buffer(DESCBCType          &symcbc,
+                                  unsigned char       *initVect,
+                                  const unsigned char *buffer,
+                                  const unsigned int   buffer_len,
+                                  unsigned char       *outBuffer)
+{
+  for(unsigned int j=0; j<buffer_len; j+=8 ) {
+    DES_CBC_DECRYPT(buffer + j, outBuffer + j, symcbc, initVect, 8);
+  }
+  return SNMPv3_USM_OK;
+}
+
 #if defined(_USE_LIBTOMCRYPT) && !defined(_USE_OPENSSL)
 PrivDES::PrivDES()
 {
@@ -1410,11 +2285,6 @@ int PrivDES::encrypt(const unsigned char *key,
   unsigned char initVect[8];
   pp_uint64     my_salt = (*salt)++;
 
-#ifdef INVALID_ENCRYPTION
-  debugprintf(-10, "\nWARNING: Encrypting with zeroed salt!\n");
-  my_salt = 0;
-#endif
-
   /* check space in privacy_params buffer */
   if (*privacy_params_len < 8)
   {
@@ -1425,19 +2295,7 @@ int PrivDES::encrypt(const unsigned char *key,
   /* Length is always 8 */
   *privacy_params_len = 8;
 
-  // last 8 bytes of key are used as base for initialization vector
-  memcpy((char*)initVect, key+8, 8);
-
-  // put salt in privacy_params
-  for (int j=0; j<4; j++)
-  {
-    privacy_params[3-j] = (unsigned char) (0xFF & (engine_boots >> (8*j)));
-    privacy_params[7-j] = (unsigned char) (0xFF & (my_salt >> (8*j)));
-  }
-
-  // xor initVect with salt
-  for (int i=0; i<8; i++)
-    initVect[i] ^= privacy_params[i];
+  des_init_vector(key + 8, my_salt, engine_boots, privacy_params, initVect);
 
 #ifdef __DEBUG
   debughexcprintf(21, "apDESEncryptData: Data to encrypt",
@@ -1451,24 +2309,8 @@ int PrivDES::encrypt(const unsigned char *key,
   DESCBCType symcbc;
   DES_CBC_START_ENCRYPT(cipher, initVect, key, 8, 16, symcbc);
 
-  for(unsigned int k = 0; k <= buffer_len - 8; k += 8) {
-    DES_CBC_ENCRYPT(buffer + k, out_buffer + k, symcbc, initVect, 8);
-  }
-
-  /* last part of buffer */
-  if (buffer_len % 8)
-  {
-    unsigned char tmp_buf[8];
-    unsigned char *tmp_buf_ptr = tmp_buf;
-    int start = buffer_len - (buffer_len % 8);
-    memset(tmp_buf, 0, 8);
-    for (unsigned int l = start; l < buffer_len; l++)
-      *tmp_buf_ptr++ = buffer[l];
-    DES_CBC_ENCRYPT(tmp_buf, out_buffer + start, symcbc, initVect, 8);
-    *out_buffer_len = buffer_len + 8 - (buffer_len % 8);
-  }
-  else
-    *out_buffer_len = buffer_len;
+  int res = des_cbc_encrypt_buffer(symcbc, initVect, buffer, buffer_len,
+                                   out_buffer, out_buffer_len);
 
   /* Clear context buffer (paranoia!)*/
   DES_MEMSET(symcbc, 0, sizeof(symcbc));
@@ -1480,7 +2322,7 @@ int PrivDES::encrypt(const unsigned char *key,
                   out_buffer, *out_buffer_len);
 #endif
 
-  return SNMPv3_USM_OK;
+  return res;
 }
 
 
@@ -1520,9 +2362,8 @@ int PrivDES::decrypt(const unsigned char *key,
 
   DESCBCType symcbc;
   DES_CBC_START_DECRYPT(cipher, initVect, key, 8, 16, symcbc);
-  for(unsigned int j=0; j<buffer_len; j+=8 ) {
-    DES_CBC_DECRYPT(buffer + j, outBuffer + j, symcbc, initVect, 8);
-  }
+  int res = des_cbc_decrypt_buffer(symcbc, initVect, buffer, buffer_len,
+                                   outBuffer);
   /* Clear context (paranoia!) */
   DES_MEMSET(symcbc, 0, sizeof(symcbc));
 
@@ -1533,9 +2374,156 @@ int PrivDES::decrypt(const unsigned char *key,
                   outBuffer, *outBuffer_len);
 #endif
 
+  return res;
+}
+
+#ifdef RSAEURO
+
+// the RSAEURO context holds the IV, so the key schedule is not reusable
+
+int PrivDES::get_prepared_key_len() const
+{
+  return 0;
+}
+
+int PrivDES::prepare_key(const unsigned char * /*key*/,
+                         const unsigned int    /*key_len*/,
+                         unsigned char       * /*prepared_key*/) const
+{
+  return SNMPv3_USM_ERROR;
+}
+
+int PrivDES::encrypt_prepared(const unsigned char * /*prepared_key*/,
+                              const unsigned char * /*buffer*/,
+                              const unsigned int    /*buffer_len*/,
+                              unsigned char       * /*out_buffer*/,
+                              unsigned int        * /*out_buffer_len*/,
+                              unsigned char       * /*privacy_params*/,
+                              unsigned int        * /*privacy_params_len*/,
+                              const unsigned long   /*engine_boots*/,
+                              const unsigned long   /*engine_time*/)
+{
+  return SNMPv3_USM_ERROR;
+}
+
+int PrivDES::decrypt_prepared(const unsigned char * /*prepared_key*/,
+                              const unsigned char * /*buffer*/,
+                              const unsigned int    /*buffer_len*/,
+                              unsigned char       * /*out_buffer*/,
+                              unsigned int        * /*out_buffer_len*/,
+                              const unsigned char * /*privacy_params*/,
+                              const unsigned int    /*privacy_params_len*/,
+                              const unsigned long   /*engine_boots*/,
+                              const unsigned long   /*engine_time*/)
+{
+  return SNMPv3_USM_ERROR;
+}
+
+#else // RSAEURO
+
+int PrivDES::get_prepared_key_len() const
+{
+  return sizeof(DESPreparedKey);
+}
+
+int PrivDES::prepare_key(const unsigned char *key,
+                         const unsigned int   key_len,
+                         unsigned char       *prepared_key) const
+{
+  if (key_len < 16)
+    return SNMPv3_USM_ERROR;
+
+  DESPreparedKey prepared;
+  unsigned char initVect[8];
+
+  // the IV is set for each message
+  memset(initVect, 0, 8);
+  DES_CBC_START_ENCRYPT(cipher, initVect, key, 8, 16, prepared.symcbc);
+  memcpy(prepared.pre_iv, key + 8, 8);
+
+  memcpy(prepared_key, &prepared, sizeof(prepared));
+  DES_MEMSET(prepared, 0, sizeof(prepared));
+
   return SNMPv3_USM_OK;
 }
 
+int PrivDES::encrypt_prepared(const unsigned char *prepared_key,
+                              const unsigned char *buffer,
+                              const unsigned int   buffer_len,
+                              unsigned char       *out_buffer,
+                              unsigned int        *out_buffer_len,
+                              unsigned char       *privacy_params,
+                              unsigned int        *privacy_params_len,
+                              const unsigned long  engine_boots,
+                              const unsigned long  /*engine_time*/)
+{
+  unsigned char initVect[8];
+  pp_uint64     my_salt = (*salt)++;
+
+  /* check space in privacy_params buffer */
+  if (*privacy_params_len < 8)
+  {
+    debugprintf(4, "Buffer too small: should be 8, is (%i).",
+                *privacy_params_len);
+    return SNMPv3_USM_ENCRYPTION_ERROR;
+  }
+  /* Length is always 8 */
+  *privacy_params_len = 8;
+
+  DESPreparedKey prepared;
+  memcpy(&prepared, prepared_key, sizeof(prepared));
+
+  des_init_vector(prepared.pre_iv, my_salt, engine_boots,
+                  privacy_params, initVect);
+  DES_CBC_SET_IV(initVect, prepared.symcbc);
+
+  int res = des_cbc_encrypt_buffer(prepared.symcbc, initVect,
+                                   buffer, buffer_len,
+                                   out_buffer, out_buffer_len);
+
+  /* Clear context buffer (paranoia!)*/
+  DES_MEMSET(prepared, 0, sizeof(prepared));
+
+  return res;
+}
+
+int PrivDES::decrypt_prepared(const unsigned char *prepared_key,
+                              const unsigned char *buffer,
+                              const unsigned int   buffer_len,
+                              unsigned char       *outBuffer,
+                              unsigned int        *outBuffer_len,
+                              const unsigned char *privacy_params,
+                              const unsigned int   privacy_params_len,
+                              const unsigned long  /*engine_boots*/,
+                              const unsigned long  /*engine_time*/)
+{
+  unsigned char initVect[8];
+
+  /* Privacy params length has to be 8  && Length has to be a multiple of 8 */
+  if (( buffer_len % 8 ) || (privacy_params_len != 8))
+    return SNMPv3_USM_DECRYPTION_ERROR;
+
+  DESPreparedKey prepared;
+  memcpy(&prepared, prepared_key, sizeof(prepared));
+
+  for (int i=0; i<8; i++)
+    initVect[i] = privacy_params[i] ^ prepared.pre_iv[i];
+
+  memset((char*)outBuffer, 0, *outBuffer_len);
+
+  DES_CBC_SET_IV(initVect, prepared.symcbc);
+  int res = des_cbc_decrypt_buffer(prepared.symcbc, initVect,
+                                   buffer, buffer_len, outBuffer);
+  /* Clear context (paranoia!) */
+  DES_MEMSET(prepared, 0, sizeof(prepared));
+
+  *outBuffer_len = buffer_len;
+
+  return res;
+}
+
+#endif // RSAEURO
+
 
 /* ----------------------- PrivIDEA --------------------------------------*/
 
@@ -1660,6 +2648,33 @@ int PrivIDEA::decrypt(const unsigned char *key,
 
 #if defined(_USE_LIBTOMCRYPT) || defined(_USE_OPENSSL)
 
+#ifdef _USE_OPENSSL
+// Encrypt or decrypt in CFB128 mode through the EVP interface, which
+// uses the AES instructions of the CPU (AES-NI) if available
+static bool aes_evp_cfb(const EVP_CIPHER    *evp_cipher,
+                        const unsigned char *key,
+                        const unsigned char *initVect,
+                        const unsigned char *in_buffer,
+                        const unsigned int   buffer_len,
+                        unsigned char       *out_buffer,
+                        const int            enc)
+{
+  EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+  if (!ctx)
+    return false;
+
+  int out_len = 0;
+  bool ok = ((EVP_CipherInit_ex(ctx, evp_cipher, NULL, key, initVect, enc)
+              == 1) &&
+             (EVP_CipherUpdate(ctx, out_buffer, &out_len,
+                               in_buffer, (int)buffer_len) == 1) &&
+             (out_len == (int)buffer_len));
+
+  EVP_CIPHER_CTX_free(ctx); // also clears the key schedule
+  return ok;
+}
+#endif
+
 PrivAES::PrivAES(const int aes_type_)
   : aes_type(aes_type_)
 {
@@ -1688,6 +2703,31 @@ PrivAES::PrivAES(const int aes_type_)
       aes_type = -1; // will cause an error in AuthPriv::add_priv()
   }
 
+#ifdef _USE_OPENSSL
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+  // fetch the cipher once, as an implicit fetch for each message is slow
+  switch (key_bytes)
+  {
+    case 16: evp_cipher = EVP_CIPHER_fetch(NULL, "AES-128-CFB", NULL); break;
+    case 24: evp_cipher = EVP_CIPHER_fetch(NULL, "AES-192-CFB", NULL); break;
+    case 32: evp_cipher = EVP_CIPHER_fetch(NULL, "AES-256-CFB", NULL); break;
+    default: evp_cipher = NULL;
+  }
+#else
+  switch (key_bytes)
+  {
+    case 16: evp_cipher = EVP_aes_128_cfb128(); break;
+    case 24: evp_cipher = EVP_aes_192_cfb128(); break;
+    case 32: evp_cipher = EVP_aes_256_cfb128(); break;
+    default: evp_cipher = NULL;
+  }
+#endif
+  if (!evp_cipher)
+  {
+    debugprintf(1, "AES-CFB not available through EVP, using AES_ functions.");
+  }
+#endif
+
   unsigned int testswap = htonl(0x01020304);
   if (testswap == 0x01020304)
     need_byteswap = false;
@@ -1695,6 +2735,16 @@ PrivAES::PrivAES(const int aes_type_)
     need_byteswap = true;
 }
 
+#ifdef _USE_OPENSSL
+PrivAES::~PrivAES()
+{
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+  if (evp_cipher)
+    EVP_CIPHER_free((EVP_CIPHER *)evp_cipher);
+#endif
+}
+#endif
+
 const char *PrivAES::get_id_string() const
 {
   switch (aes_type)
@@ -1706,6 +2756,25 @@ const char *PrivAES::get_id_string() const
   }
 }
 
+// Set IV as engine_boots + engine_time + salt
+static void aes_init_vector(const unsigned long engine_boots,
+                            const unsigned long engine_time,
+                            const pp_uint64     my_salt,
+                            const bool          need_byteswap,
+                            unsigned char      *initVect)
+{
+  unsigned int *tmpi = (unsigned int *)initVect;
+  *tmpi++ = htonl(engine_boots);
+  *tmpi++ = htonl(engine_time);
+  if (need_byteswap)
+  {
+    *tmpi++ = htonl(my_salt & 0xFFFFFFFF);
+    *tmpi   = htonl((my_salt >> 32) & 0xFFFFFFFF);
+  }
+  else
+    memcpy(tmpi, &my_salt, 8);
+}
+
 int PrivAES::encrypt(const unsigned char *key,
                      const unsigned int   key_len,
                      const unsigned char *buffer,
@@ -1735,45 +2804,44 @@ int PrivAES::encrypt(const unsigned char *key,
   /* Length is always 8 */
   *privacy_params_len = 8;
 
-  /* Set IV as engine_boots + engine_time + salt */
-  unsigned int *tmpi = (unsigned int *)initVect;
-  *tmpi++ = htonl(engine_boots);
-  *tmpi++ = htonl(engine_time);
-  if (need_byteswap)
-  {
-    *tmpi++ = htonl(my_salt & 0xFFFFFFFF);
-    *tmpi   = htonl((my_salt >> 32) & 0xFFFFFFFF);
-  }
-  else
-    memcpy(tmpi, &my_salt, 8);
+  aes_init_vector(engine_boots, engine_time, my_salt, need_byteswap,
+                  initVect);
 
   /* put byteswapped salt in privacy_params */
   memcpy(privacy_params, initVect + 8, 8);
   debughexcprintf(21, "aes initVect:", initVect, 16);
 
 #ifdef _USE_OPENSSL
-  AES_KEY symcfb;
-  int dummy = 0;
-
-  if (AES_set_encrypt_key(key, key_len * 8, &symcfb) < 0)
+  if (!evp_cipher ||
+      !aes_evp_cfb(evp_cipher, key, initVect, buffer, buffer_len,
+                   out_buffer, 1))
   {
-    
-    debugprintf(1, "AES_set_encrypt_key(%p, %d, %p) failed.",
-                key, key_len * 8, &symcfb);
-    return SNMPv3_USM_ERROR;
-  }
+    AES_KEY symcfb;
+    int dummy = 0;
+
+    if (AES_set_encrypt_key(key, key_len * 8, &symcfb) < 0)
+    {
 
-  AES_cfb128_encrypt(buffer, out_buffer, buffer_len,
-                     &symcfb, initVect, &dummy, AES_ENCRYPT);
+      debugprintf(1, "AES_set_encrypt_key(%p, %d, %p) failed.",
+                  key, key_len * 8, &symcfb);
+      return SNMPv3_USM_ERROR;
+    }
+
+    AES_cfb128_encrypt(buffer, out_buffer, buffer_len,
+                       &symcfb, initVect, &dummy, AES_ENCRYPT);
+
+    /* Clear context and plaintext buffer (paranoia!)*/
+    memset(&symcfb, 0, sizeof(symcfb));
+  }
 #else
   symmetric_CFB symcfb;
 
   cfb_start(cipher, initVect, key, key_bytes, rounds, &symcfb);
   cfb_encrypt((unsigned char*)buffer, out_buffer, buffer_len, &symcfb);
-#endif
 
   /* Clear context and plaintext buffer (paranoia!)*/
   memset(&symcfb, 0, sizeof(symcfb));
+#endif
 
   *out_buffer_len = buffer_len;
 
@@ -1815,21 +2883,29 @@ int PrivAES::decrypt(const unsigned char *key,
   debughexcprintf(21, "aes initVect:", initVect, 16);
 
 #ifdef _USE_OPENSSL
-  int dummy = 0;
-  AES_KEY symcfb;
+  if (!evp_cipher ||
+      !aes_evp_cfb(evp_cipher, key, initVect, buffer, buffer_len,
+                   out_buffer, 0))
+  {
+    int dummy = 0;
+    AES_KEY symcfb;
+
+    AES_set_encrypt_key(key, key_len * 8, &symcfb);
+    AES_cfb128_encrypt(buffer, out_buffer, buffer_len,
+                       &symcfb, initVect, &dummy, AES_DECRYPT);
 
-  AES_set_encrypt_key(key, key_len * 8, &symcfb);
-  AES_cfb128_encrypt(buffer, out_buffer, buffer_len,
-                     &symcfb, initVect, &dummy, AES_DECRYPT);
+    /* Clear context and plaintext buffer (paranoia!)*/
+    memset(&symcfb, 0, sizeof(symcfb));
+  }
 #else
   symmetric_CFB symcfb;
 
   cfb_start(cipher, initVect, key, key_bytes, rounds, &symcfb);
   cfb_decrypt((unsigned char*)buffer, out_buffer, buffer_len, &symcfb);
-#endif
 
   /* Clear context and plaintext buffer (paranoia!)*/
   memset(&symcfb, 0, sizeof(symcfb));
+#endif
 
   *out_buffer_len = buffer_len;
 
@@ -1845,6 +2921,287 @@ int PrivAES::decrypt(const unsigned char *key,
   return SNMPv3_USM_OK;
 }
 
+#ifdef _USE_OPENSSL
+
+// With OpenSSL the prepared key holds a pointer to an EVP context
+// initialized with the key. The context of the user table entry is
+// copied for each cloned entry and only the IV is set per message.
+
+int PrivAES::get_prepared_key_len() const
+{
+  return evp_cipher ? (int)sizeof(EVP_CIPHER_CTX *) : 0;
+}
+
+int PrivAES::prepare_key(const unsigned char *key,
+                         const unsigned int   key_len,
+                         unsigned char       *prepared_key) const
+{
+  if (!evp_cipher || (key_len < (unsigned)key_bytes))
+    return SNMPv3_USM_ERROR;
+
+  EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+  if (!ctx)
+    return SNMPv3_USM_ERROR;
+
+  if (EVP_CipherInit_ex(ctx, evp_cipher, NULL, key, NULL, 1) != 1)
+  {
+    EVP_CIPHER_CTX_free(ctx);
+    return SNMPv3_USM_ERROR;
+  }
+
+  memcpy(prepared_key, &ctx, sizeof(ctx));
+  return SNMPv3_USM_OK;
+}
+
+int PrivAES::copy_prepared_key(const unsigned char *src,
+                               unsigned char       *dst) const
+{
+  EVP_CIPHER_CTX *src_ctx;
+  memcpy(&src_ctx, src, sizeof(src_ctx));
+
+  EVP_CIPHER_CTX *ctx = EVP_CIPHER_CTX_new();
+  if (!ctx)
+    return SNMPv3_USM_ERROR;
+
+  if (!src_ctx || (EVP_CIPHER_CTX_copy(ctx, src_ctx) != 1))
+  {
+    EVP_CIPHER_CTX_free(ctx);
+    return SNMPv3_USM_ERROR;
+  }
+
+  memcpy(dst, &ctx, sizeof(ctx));
+  return SNMPv3_USM_OK;
+}
+
+void PrivAES::clear_prepared_key(unsigned char *prepared_key) const
+{
+  EVP_CIPHER_CTX *ctx;
+  memcpy(&ctx, prepared_key, sizeof(ctx));
+
+  if (ctx)
+    EVP_CIPHER_CTX_free(ctx); // also clears the key schedule
+
+  memset(prepared_key, 0, sizeof(ctx));
+}
+
+// Set the IV and the direction and run the prepared context over the buffer
+static int aes_evp_cfb_prepared(const unsigned char *prepared_key,
+                                const unsigned char *initVect,
+                                const unsigned char *in_buffer,
+                                const unsigned int   buffer_len,
+                                unsigned char       *out_buffer,
+                                const int            enc)
+{
+  EVP_CIPHER_CTX *ctx;
+  memcpy(&ctx, prepared_key, sizeof(ctx));
+
+  int out_len = 0;
+  if (ctx &&
+      (EVP_CipherInit_ex(ctx, NULL, NULL, NULL, initVect, enc) == 1) &&
+      (EVP_CipherUpdate(ctx, out_buffer, &out_len,
+                        in_buffer, (int)buffer_len) == 1) &&
+      (out_len == (int)buffer_len))
+    return SNMPv3_USM_OK;
+
+  return SNMPv3_USM_ERROR;
+}
+
+int PrivAES::encrypt_prepared(const unsigned char *prepared_key,
+                              const unsigned char *buffer,
+                              const unsigned int   buffer_len,
+                              unsigned char       *out_buffer,
+                              unsigned int        *out_buffer_len,
+                              unsigned char       *privacy_params,
+                              unsigned int        *privacy_params_len,
+                              const unsigned long  engine_boots,
+                              const unsigned long  engine_time)
+{
+  unsigned char initVect[16];
+  pp_uint64 my_salt = (*salt)++;
+
+#ifdef INVALID_ENCRYPTION
+  debugprintf(-10, "\nWARNING: Encrypting with zeroed salt!\n");
+  my_salt = 0;
+#endif
+
+  /* check space in privacy_params buffer */
+  if (*privacy_params_len < 8)
+  {
+    debugprintf(4, "Buffer too small: should be 8, is (%i).",
+                *privacy_params_len);
+    return SNMPv3_USM_ENCRYPTION_ERROR;
+  }
+  /* Length is always 8 */
+  *privacy_params_len = 8;
+
+  aes_init_vector(engine_boots, engine_time, my_salt, need_byteswap,
+                  initVect);
+
+  /* put byteswapped salt in privacy_params */
+  memcpy(privacy_params, initVect + 8, 8);
+
+  int res = aes_evp_cfb_prepared(prepared_key, initVect,
+                                 buffer, buffer_len, out_buffer, 1);
+
+  *out_buffer_len = buffer_len;
+
+  return res;
+}
+
+int PrivAES::decrypt_prepared(const unsigned char *prepared_key,
+                              const unsigned char *buffer,
+                              const unsigned int   buffer_len,
+                              unsigned char       *out_buffer,
+                              unsigned int        *out_buffer_len,
+                              const unsigned char *privacy_params,
+                              const unsigned int   privacy_params_len,
+                              const unsigned long  engine_boots,
+                              const unsigned long  engine_time)
+{
+  unsigned char initVect[16];
+
+  /* Privacy params length has to be 8 */
+  if (privacy_params_len != 8)
+    return SNMPv3_USM_DECRYPTION_ERROR;
+
+  /* build IV */
+  unsigned int *tmp;
+  tmp = (unsigned int *)initVect;
+  *tmp++ = htonl(engine_boots);
+  *tmp = htonl(engine_time);
+  memcpy(initVect + 8, privacy_params, 8);
+
+  int res = aes_evp_cfb_prepared(prepared_key, initVect,
+                                 buffer, buffer_len, out_buffer, 0);
+
+  *out_buffer_len = buffer_len;
+
+  return res;
+}
+
+#else // _USE_OPENSSL
+
+// The prepared key of PrivAES is a CFB context with the expanded key,
+// the IV is set for each message.
+
+int PrivAES::get_prepared_key_len() const
+{
+  return sizeof(symmetric_CFB);
+}
+
+int PrivAES::prepare_key(const unsigned char *key,
+                         const unsigned int   key_len,
+                         unsigned char       *prepared_key) const
+{
+  if (key_len < (unsigned)key_bytes)
+    return SNMPv3_USM_ERROR;
+
+  symmetric_CFB symcfb;
+  unsigned char initVect[16];
+
+  memset(initVect, 0, 16);
+  if (cfb_start(cipher, initVect, key, key_bytes, rounds, &symcfb) != CRYPT_OK)
+    return SNMPv3_USM_ERROR;
+
+  memcpy(prepared_key, &symcfb, sizeof(symcfb));
+  memset(&symcfb, 0, sizeof(symcfb));
+
+  return SNMPv3_USM_OK;
+}
+
+int PrivAES::encrypt_prepared(const unsigned char *prepared_key,
+                              const unsigned char *buffer,
+                              const unsigned int   buffer_len,
+                              unsigned char       *out_buffer,
+                              unsigned int        *out_buffer_len,
+                              unsigned char       *privacy_params,
+                              unsigned int        *privacy_params_len,
+                              const unsigned long  engine_boots,
+                              const unsigned long  engine_time)
+{
+  unsigned char initVect[16];
+  pp_uint64 my_salt = (*salt)++;
+
+#ifdef INVALID_ENCRYPTION
+  debugprintf(-10, "\nWARNING: Encrypting with zeroed salt!\n");
+  my_salt = 0;
+#endif
+
+  /* check space in privacy_params buffer */
+  if (*privacy_params_len < 8)
+  {
+    debugprintf(4, "Buffer too small: should be 8, is (%i).",
+                *privacy_params_len);
+    return SNMPv3_USM_ENCRYPTION_ERROR;
+  }
+  /* Length is always 8 */
+  *privacy_params_len = 8;
+
+  aes_init_vector(engine_boots, engine_time, my_salt, need_byteswap,
+                  initVect);
+
+  /* put byteswapped salt in privacy_params */
+  memcpy(privacy_params, initVect + 8, 8);
+
+  symmetric_CFB symcfb;
+  memcpy(&symcfb, prepared_key, sizeof(symcfb));
+
+  int res = SNMPv3_USM_OK;
+  if ((cfb_setiv(initVect, 16, &symcfb) != CRYPT_OK) ||
+      (cfb_encrypt((unsigned char*)buffer, out_buffer, buffer_len,
+                   &symcfb) != CRYPT_OK))
+    res = SNMPv3_USM_ERROR;
+
+  /* Clear context and plaintext buffer (paranoia!)*/
+  memset(&symcfb, 0, sizeof(symcfb));
+
+  *out_buffer_len = buffer_len;
+
+  return res;
+}
+
+int PrivAES::decrypt_prepared(const unsigned char *prepared_key,
+                              const unsigned char *buffer,
+                              const unsigned int   buffer_len,
+                              unsigned char       *out_buffer,
+                              unsigned int        *out_buffer_len,
+                              const unsigned char *privacy_params,
+                              const unsigned int   privacy_params_len,
+                              const unsigned long  engine_boots,
+                              const unsigned long  engine_time)
+{
+  unsigned char initVect[16];
+
+  /* Privacy params length has to be 8 */
+  if (privacy_params_len != 8)
+    return SNMPv3_USM_DECRYPTION_ERROR;
+
+  /* build IV */
+  unsigned int *tmp;
+  tmp = (unsigned int *)initVect;
+  *tmp++ = htonl(engine_boots);
+  *tmp = htonl(engine_time);
+  memcpy(initVect + 8, privacy_params, 8);
+
+  symmetric_CFB symcfb;
+  memcpy(&symcfb, prepared_key, sizeof(symcfb));
+
+  int res = SNMPv3_USM_OK;
+  if ((cfb_setiv(initVect, 16, &symcfb) != CRYPT_OK) ||
+      (cfb_decrypt((unsigned char*)buffer, out_buffer, buffer_len,
+                   &symcfb) != CRYPT_OK))
+    res = SNMPv3_USM_ERROR;
+
+  /* Clear context and plaintext buffer (paranoia!)*/
+  memset(&symcfb, 0, sizeof(symcfb));
+
+  *out_buffer_len = buffer_len;
+
+  return res;
+}
+
+#endif // _USE_OPENSSL
+
 int PrivAES::extend_short_key(const unsigned char *password,
                               const unsigned int   password_len,
                               const unsigned char *engine_id,
@@ -2021,7 +3378,7 @@ Priv3DES_EDE::encrypt(const unsigned char *key,
   DESCBCType symcbc;
   DES_CBC_START_ENCRYPT(cipher, initVect, key, 24, 16, symcbc);
 
-  for(unsigned int k = 0; k <= buffer_len - 8; k += 8) {
+  for(unsigned int k = 0; k + 8 <= buffer_len; k += 8) {
     DES_CBC_ENCRYPT(buffer + k, out_buffer + k, symcbc, initVect, 8);
   }
 
@@ -68,11 +68,16 @@ char event_list_version[]="@(#) SNMP++ $Id: eventlist.cpp 2361 2013-05-09 22:15:
 #include "snmp_pp/msgqueue.h"		// queue for holding snmp event sources
 #include "snmp_pp/notifyqueue.h"	// queue for holding trap callbacks
 #include "snmp_pp/snmperrs.h"
+#include "snmp_pp/log.h"
 
 #ifdef SNMP_PP_NAMESPACE
 namespace Snmp_pp {
 #endif
 
+#ifdef HAVE_EPOLL_SYSCALL
+static const char *loggerModuleName = "snmp++.eventlist";
+#endif
+
 //----[ CSNMPMessageQueueElt class ]--------------------------------------
 
 CEventList::CEventListElt::CEventListElt(CEvents *events,
@@ -96,6 +101,21 @@ CEventList::CEventListElt::~CEventListElt()
 
 //----[ CEventList class ]--------------------------------------
 
+CEventList::CEventList()
+  : m_head(0, 0, 0), m_msgCount(0), m_done(0)
+{
+#ifdef HAVE_EPOLL_SYSCALL
+  m_fds = 0;
+  m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+  if (m_epollFd < 0)
+  {
+    LOG_BEGIN(loggerModuleName, WARNING_LOG | 1);
+    LOG("EventList: Could not create epoll instance, using select/poll (errno)");
+    LOG(errno);
+    LOG_END;
+  }
+#endif
+}
 
 CEventList::~CEventList()
 {
@@ -106,6 +126,20 @@ CEventList::~CEventList()
   while ((leftOver = m_head.GetNext()))
     delete leftOver;
   unlock();
+
+#ifdef HAVE_EPOLL_SYSCALL
+  m_fdLock.lock();
+  while (m_fds)
+  {
+    CEventFd *tmp = m_fds;
+    m_fds = m_fds->m_Next;
+    delete tmp;
+  }
+  if (m_epollFd >= 0)
+    close(m_epollFd);
+  m_epollFd = -1;
+  m_fdLock.unlock();
+#endif
 }
 
 CEvents * CEventList::AddEntry(CEvents *events) REENTRANT ({
@@ -230,6 +264,111 @@ int CEventList::HandleEvents(const int maxfds,
 
 #endif // HAVE_POLL_SYSCALL
 
+#ifdef HAVE_EPOLL_SYSCALL
+
+int CEventList::AddFd(const SnmpSocket fd, CEvents *events)
+{
+  if (m_epollFd < 0) return SNMP_CLASS_SUCCESS;
+
+  SnmpSynchronize _synchronize(m_fdLock);
+  CEventFd *entry;
+
+  for (entry = m_fds; entry; entry = entry->m_Next)
+  {
+    if (entry->m_fd == fd)
+    {
+      entry->m_refCount++;
+      return SNMP_CLASS_SUCCESS;
+    }
+  }
+
+  struct epoll_event ev;
+  memset(&ev, 0, sizeof(ev));
+  ev.events = EPOLLIN;
+  ev.data.fd = fd;
+  if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &ev) < 0)
+  {
+    LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
+    LOG("EventList: Could not add socket to epoll set (fd) (errno)");
+    LOG(fd);
+    LOG(errno);
+    LOG_END;
+    return SNMP_CLASS_ERROR;
+  }
+  m_fds = new CEventFd(fd, events, m_fds);
+  return SNMP_CLASS_SUCCESS;
+}
+
+int CEventList::RemoveFd(const SnmpSocket fd)
+{
+  if (m_epollFd < 0) return SNMP_CLASS_SUCCESS;
+
+  SnmpSynchronize _synchronize(m_fdLock);
+  CEventFd *prev = 0;
+
+  for (CEventFd *entry = m_fds; entry; prev = entry, entry = entry->m_Next)
+  {
+    if (entry->m_fd != fd)
+      continue;
+
+    if (--entry->m_refCount > 0)
+      return SNMP_CLASS_SUCCESS;
+
+    if (prev)
+      prev->m_Next = entry->m_Next;
+    else
+      m_fds = entry->m_Next;
+    delete entry;
+
+    // the socket may already be closed, which removed it from the set
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    epoll_ctl(m_epollFd, EPOLL_CTL_DEL, fd, &ev);
+    return SNMP_CLASS_SUCCESS;
+  }
+  return SNMP_CLASS_ERROR;
+}
+
+int CEventList::WaitForEvents(struct epoll_event *ready, const int max_ready,
+                              const int timeout)
+{
+  int nfound;
+  do
+  {
+    nfound = epoll_wait(m_epollFd, ready, max_ready, timeout);
+  } while ((nfound < 0) && (errno == EINTR));
+
+  return nfound;
+}
+
+int CEventList::HandleEvents(const struct epoll_event *ready, const int count)
+{
+  int status = SNMP_CLASS_SUCCESS;
+
+  for (int i = 0; i < count; i++)
+  {
+    CEvents *events = 0;
+
+    // the socket may have been removed since epoll_wait() returned
+    m_fdLock.lock();
+    for (CEventFd *entry = m_fds; entry; entry = entry->m_Next)
+    {
+      if (entry->m_fd == ready[i].data.fd)
+      {
+        events = entry->m_events;
+        break;
+      }
+    }
+    m_fdLock.unlock();
+
+    if (events && events->GetCount())
+      status = events->HandleSocketEvents(ready[i].data.fd);
+  }
+  return status;
+}
+
+#endif // HAVE_EPOLL_SYSCALL
+
 int CEventList::DoRetries(const msec &sendtime) REENTRANT ({
 
   CEventListElt *msgEltPtr = m_head.GetNext();
@@ -87,6 +87,11 @@ int EventListHolder::SNMPBlockForResponse(const unsigned long req_id,
 // Pull all available events out of their sockets - do not block
 int EventListHolder::SNMPProcessPendingEvents()
 {
+#ifdef HAVE_EPOLL_SYSCALL
+  if (m_eventList.UseEpoll())
+    return EpollProcessPendingEvents();
+#endif
+
   int fdcount;
   int remaining;
   struct pollfd *pollfds = 0;
@@ -141,6 +146,11 @@ int EventListHolder::SNMPProcessPendingEvents()
 // Block until an event shows up - then handle the event(s)
 int EventListHolder::SNMPProcessEvents(const int max_block_milliseconds)
 {
+#ifdef HAVE_EPOLL_SYSCALL
+  if (m_eventList.UseEpoll())
+    return EpollProcessEvents(max_block_milliseconds);
+#endif
+
   int fdcount;
   int remaining;
   struct pollfd *pollfds = 0;
@@ -190,6 +200,11 @@ int EventListHolder::SNMPProcessEvents(const int max_block_milliseconds)
 
 int EventListHolder::SNMPProcessPendingEvents()
 {
+#ifdef HAVE_EPOLL_SYSCALL
+  if (m_eventList.UseEpoll())
+    return EpollProcessPendingEvents();
+#endif
+
   int maxfds;
   fd_set readfds;
   fd_set writefds;
@@ -240,6 +255,11 @@ int EventListHolder::SNMPProcessPendingEvents()
 // Block until an event shows up - then handle the event(s)
 int EventListHolder::SNMPProcessEvents(const int max_block_milliseconds)
 {
+#ifdef HAVE_EPOLL_SYSCALL
+  if (m_eventList.UseEpoll())
+    return EpollProcessEvents(max_block_milliseconds);
+#endif
+
   int maxfds;
   fd_set readfds;
   fd_set writefds;
@@ -276,6 +296,78 @@ int EventListHolder::SNMPProcessEvents(const int max_block_milliseconds)
 
 #endif
 
+#ifdef HAVE_EPOLL_SYSCALL
+
+#define SNMP_PP_EPOLL_MAX_EVENTS 64
+
+// Pull all available events out of the registered sockets - do not block
+int EventListHolder::EpollProcessPendingEvents()
+{
+  struct epoll_event ready[SNMP_PP_EPOLL_MAX_EVENTS];
+  int nfound = 0;
+  msec now(0, 0);
+  int status;
+
+  pevents_mutex.lock();
+
+  do
+  {
+    nfound = m_eventList.WaitForEvents(ready, SNMP_PP_EPOLL_MAX_EVENTS, 0);
+
+    now.refresh();
+
+    if (nfound > 0)
+    {
+      status = m_eventList.HandleEvents(ready, nfound);
+      // TM should we do anything with bad status?
+    }
+  } while (nfound > 0);
+
+  // go through the message queue and resend any messages
+  // which are past the timeout.
+  status = m_eventList.DoRetries(now);
+
+  pevents_mutex.unlock();
+
+  return status;
+}
+
+// Block until an event shows up - then handle the event(s)
+int EventListHolder::EpollProcessEvents(const int max_block_milliseconds)
+{
+  struct epoll_event ready[SNMP_PP_EPOLL_MAX_EVENTS];
+  struct timeval fd_timeout;
+  int timeout;
+  msec now; // automatically calls msec::refresh()
+  msec sendTime;
+
+  m_eventList.GetNextTimeout(sendTime);
+  now.GetDelta(sendTime, fd_timeout);
+
+  if ((max_block_milliseconds > 0) &&
+      ((fd_timeout.tv_sec > max_block_milliseconds / 1000) ||
+       ((fd_timeout.tv_sec == max_block_milliseconds / 1000) &&
+	(fd_timeout.tv_usec > (max_block_milliseconds % 1000) * 1000))))
+  {
+    fd_timeout.tv_sec = max_block_milliseconds / 1000;
+    fd_timeout.tv_usec = (max_block_milliseconds % 1000) * 1000;
+  }
+
+  /* Prevent endless sleep, timeouts of messages added later by other
+     threads are not known yet */
+  if (fd_timeout.tv_sec > 5)
+    fd_timeout.tv_sec = 5; /* sleep at max 5.99 seconds */
+
+  timeout = fd_timeout.tv_sec * 1000 + fd_timeout.tv_usec / 1000;
+
+  // only wait here, the events are handled with pevents_mutex held
+  m_eventList.WaitForEvents(ready, SNMP_PP_EPOLL_MAX_EVENTS, timeout);
+
+  return EpollProcessPendingEvents();
+}
+
+#endif // HAVE_EPOLL_SYSCALL
+
 //---------[ Main Loop ]------------------------------------------
 // Infinite loop which blocks when there is nothing to do and handles
 // any events as they occur.
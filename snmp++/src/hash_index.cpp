@@ -0,0 +1,376 @@
+/*_############################################################################
+  _##
+  _##  hash_index.cpp
+  _##
+  _##  SNMP++ v3.3
+  _##  -----------------------------------------------
+  _##  Copyright (c) 2001-2013 Jochen Katz, Frank Fock
+  _##
+  _##  This software is based on SNMP++2.6 from Hewlett Packard:
+  _##
+  _##    Copyright (c) 1996
+  _##    Hewlett-Packard Company
+  _##
+  _##  ATTENTION: USE OF THIS SOFTWARE IS SUBJECT TO THE FOLLOWING TERMS.
+  _##  Permission to use, copy, modify, distribute and/or sell this software
+  _##  and/or its documentation is hereby granted without fee. User agrees
+  _##  to display the above copyright notice and this license notice in all
+  _##  copies of the software and any documentation of the software. User
+  _##  agrees to assume all liability for the use of the software;
+  _##  Hewlett-Packard and Jochen Katz make no representations about the
+  _##  suitability of this software for any purpose. It is provided
+  _##  "AS-IS" without warranty of any kind, either express or implied. User
+  _##  hereby grants a royalty-free license to any and all derivatives based
+  _##  upon this software code base.
+  _##
+  _##########################################################################*/
+
+
+char hash_index_cpp_version[]="@(#) SNMP++ $Id$";
+
+#include <libsnmp.h>
+
+#include "snmp_pp/hash_index.h"
+
+#ifdef SNMP_PP_NAMESPACE
+namespace Snmp_pp {
+#endif
+
+#define HASH_INDEX_INITIAL_SIZE 16
+
+SnmpHashIndex::SnmpHashIndex()
+  : slots(0), size(0), used(0), chain_next(0), chain_prev(0), chain_size(0)
+{
+}
+
+SnmpHashIndex::~SnmpHashIndex()
+{
+  delete [] slots;
+  delete [] chain_next;
+  delete [] chain_prev;
+}
+
+unsigned int SnmpHashIndex::hash(const unsigned char *data, const long len,
+                                 unsigned int hash)
+{
+  for (long i = 0; i < len; ++i)
+  {
+    hash ^= data[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+bool SnmpHashIndex::reserve_slots(const unsigned long keys)
+{
+  // keep at least half of the slots empty
+  unsigned long new_size = size ? size : HASH_INDEX_INITIAL_SIZE;
+  while (new_size < 2 * keys)
+    new_size *= 2;
+  if (new_size == size)
+    return true;
+
+  Slot *new_slots = new Slot[new_size];
+  if (!new_slots)
+    return false;
+  for (unsigned long i = 0; i < new_size; ++i)
+    new_slots[i].pos = -1;
+
+  for (unsigned long i = 0; i < size; ++i)
+  {
+    if (slots[i].pos < 0) continue;
+    unsigned long s = slots[i].hash & (new_size - 1);
+    while (new_slots[s].pos >= 0)
+      s = (s + 1) & (new_size - 1);
+    new_slots[s] = slots[i];
+  }
+  delete [] slots;
+  slots = new_slots;
+  size = new_size;
+  return true;
+}
+
+bool SnmpHashIndex::reserve(const int count)
+{
+  if (!reserve_slots((unsigned long)count))
+    return false;
+  if (count <= chain_size)
+    return true;
+
+  int new_size = chain_size ? chain_size : HASH_INDEX_INITIAL_SIZE;
+  while (new_size < count)
+    new_size *= 2;
+
+  int *new_next = new int[new_size];
+  int *new_prev = new int[new_size];
+  if (!new_next || !new_prev)
+  {
+    delete [] new_next;
+    delete [] new_prev;
+    return false;
+  }
+  for (int i = 0; i < chain_size; ++i)
+  {
+    new_next[i] = chain_next[i];
+    new_prev[i] = chain_prev[i];
+  }
+  delete [] chain_next;
+  delete [] chain_prev;
+  chain_next = new_next;
+  chain_prev = new_prev;
+  chain_size = new_size;
+  return true;
+}
+
+void SnmpHashIndex::add(const unsigned int hash, const int pos)
+{
+  if (!reserve(pos + 1) || !reserve_slots(used + 1))
+    return;
+
+  unsigned long s = hash & (size - 1);
+  while (slots[s].pos >= 0)
+    s = (s + 1) & (size - 1);
+  slots[s].hash = hash;
+  slots[s].pos = pos;
+  ++used;
+
+  chain_next[pos] = -1;
+  chain_prev[pos] = -1;
+}
+
+void SnmpHashIndex::add_same(const int same, const int pos)
+{
+  if (!reserve(pos + 1))
+    return;
+
+  // insert behind the given entry, so the slot keeps its position
+  chain_next[pos] = chain_next[same];
+  chain_prev[pos] = same;
+  if (chain_next[same] >= 0)
+    chain_prev[chain_next[same]] = pos;
+  chain_next[same] = pos;
+}
+
+unsigned long SnmpHashIndex::slot_of(const unsigned int hash,
+                                     const int pos) const
+{
+  unsigned long cursor;
+  for (int p = first(hash, cursor); p >= 0; p = next(hash, cursor))
+    if (p == pos)
+      return cursor;
+  return size;
+}
+
+void SnmpHashIndex::remove(const unsigned int hash, const int pos)
+{
+  if ((pos < 0) || (pos >= chain_size))
+    return;
+
+  int prev = chain_prev[pos];
+  int next = chain_next[pos];
+
+  if (prev >= 0)
+  {
+    // not the first entry of the key, just unlink it
+    chain_next[prev] = next;
+    if (next >= 0)
+      chain_prev[next] = prev;
+    return;
+  }
+
+  unsigned long i = slot_of(hash, pos);
+  if (i >= size)
+    return;
+
+  if (next >= 0)
+  {
+    // the next entry with the same key takes over the slot
+    chain_prev[next] = -1;
+    slots[i].pos = next;
+    return;
+  }
+
+  // move following entries of the probe sequence into the gap, so
+  // lookups do not stop at the removed slot
+  unsigned long j = i;
+  for (;;)
+  {
+    j = (j + 1) & (size - 1);
+    if (slots[j].pos < 0)
+      break;
+    unsigned long k = slots[j].hash & (size - 1);
+    if ((j > i) ? ((k <= i) || (k > j)) : ((k <= i) && (k > j)))
+    {
+      slots[i] = slots[j];
+      i = j;
+    }
+  }
+  slots[i].pos = -1;
+  --used;
+}
+
+void SnmpHashIndex::move(const unsigned int hash,
+                         const int old_pos, const int new_pos)
+{
+  if ((old_pos < 0) || (old_pos >= chain_size) ||
+      (new_pos < 0) || (new_pos >= chain_size))
+    return;
+
+  int prev = chain_prev[old_pos];
+  int next = chain_next[old_pos];
+
+  if (prev >= 0)
+    chain_next[prev] = new_pos;
+  else
+  {
+    unsigned long i = slot_of(hash, old_pos);
+    if (i >= size)
+      return;
+    slots[i].pos = new_pos;
+  }
+  if (next >= 0)
+    chain_prev[next] = new_pos;
+
+  chain_next[new_pos] = next;
+  chain_prev[new_pos] = prev;
+}
+
+void SnmpHashIndex::clear()
+{
+  for (unsigned long i = 0; i < size; ++i)
+    slots[i].pos = -1;
+  used = 0;
+}
+
+// Saved index: number of slots and used slots, the slots and the
+// chain arrays of count positions.
+
+unsigned long SnmpHashIndex::saved_size(const int count) const
+{
+  return 2 * sizeof(unsigned int) + size * sizeof(Slot) +
+         2 * count * sizeof(int);
+}
+
+void SnmpHashIndex::save(unsigned char *buf, const int count) const
+{
+  unsigned int header[2];
+  header[0] = (unsigned int)size;
+  header[1] = (unsigned int)used;
+
+  memcpy(buf, header, sizeof(header));
+  buf += sizeof(header);
+  if (size)
+    memcpy(buf, slots, size * sizeof(Slot));
+  buf += size * sizeof(Slot);
+  if (count)
+  {
+    memcpy(buf, chain_next, count * sizeof(int));
+    memcpy(buf + count * sizeof(int), chain_prev, count * sizeof(int));
+  }
+}
+
+bool SnmpHashIndex::load(const unsigned char *buf, const unsigned long len,
+                         const int count)
+{
+  unsigned int header[2];
+  unsigned long i;
+
+  delete [] slots;
+  delete [] chain_next;
+  delete [] chain_prev;
+  slots = 0;
+  chain_next = chain_prev = 0;
+  size = used = 0;
+  chain_size = 0;
+
+  if ((count < 0) || (len < sizeof(header)))
+    return false;
+  memcpy(header, buf, sizeof(header));
+  if ((header[0] & (header[0] - 1)) || (header[1] > header[0] / 2) ||
+      (len != 2 * sizeof(header[0]) + header[0] * sizeof(Slot) +
+              2 * count * sizeof(int)))
+    return false;
+
+  int new_chain_size = HASH_INDEX_INITIAL_SIZE;
+  while (new_chain_size < count)
+    new_chain_size *= 2;
+
+  Slot *new_slots = header[0] ? new Slot[header[0]] : 0;
+  int *new_next = new int[new_chain_size];
+  int *new_prev = new int[new_chain_size];
+  if ((header[0] && !new_slots) || !new_next || !new_prev)
+  {
+    delete [] new_slots;
+    delete [] new_next;
+    delete [] new_prev;
+    return false;
+  }
+  buf += sizeof(header);
+  if (header[0])
+    memcpy(new_slots, buf, header[0] * sizeof(Slot));
+  buf += header[0] * sizeof(Slot);
+  if (count)
+  {
+    memcpy(new_next, buf, count * sizeof(int));
+    memcpy(new_prev, buf + count * sizeof(int), count * sizeof(int));
+  }
+
+  // positions must be in range, the keys are checked by the callers
+  unsigned long in_use = 0;
+  bool ok = true;
+  for (i = 0; i < header[0]; ++i)
+    if (new_slots[i].pos >= 0)
+    {
+      ok = ok && (new_slots[i].pos < count);
+      ++in_use;
+    }
+    else
+      ok = ok && (new_slots[i].pos == -1);
+  for (i = 0; i < (unsigned long)count; ++i)
+    ok = ok && (new_next[i] >= -1) && (new_next[i] < count) &&
+               (new_prev[i] >= -1) && (new_prev[i] < count);
+  if (!ok || (in_use != header[1]))
+  {
+    delete [] new_slots;
+    delete [] new_next;
+    delete [] new_prev;
+    return false;
+  }
+
+  slots = new_slots;
+  size = header[0];
+  used = header[1];
+  chain_next = new_next;
+  chain_prev = new_prev;
+  chain_size = new_chain_size;
+  return true;
+}
+
+int SnmpHashIndex::find(const unsigned int hash, unsigned long &cursor) const
+{
+  while (slots[cursor].pos >= 0)
+  {
+    if (slots[cursor].hash == hash)
+      return slots[cursor].pos;
+    cursor = (cursor + 1) & (size - 1);
+  }
+  return -1;
+}
+
+int SnmpHashIndex::first(const unsigned int hash, unsigned long &cursor) const
+{
+  if (!used)
+    return -1;
+  cursor = hash & (size - 1);
+  return find(hash, cursor);
+}
+
+int SnmpHashIndex::next(const unsigned int hash, unsigned long &cursor) const
+{
+  cursor = (cursor + 1) & (size - 1);
+  return find(hash, cursor);
+}
+
+#ifdef SNMP_PP_NAMESPACE
+} // end of namespace Snmp_pp
+#endif
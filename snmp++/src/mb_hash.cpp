@@ -0,0 +1,468 @@
+/*_############################################################################
+  _##
+  _##  mb_hash.cpp
+  _##
+  _##  SNMP++ v3.3
+  _##  -----------------------------------------------
+  _##  Copyright (c) 2001-2013 Jochen Katz, Frank Fock
+  _##
+  _##  This software is based on SNMP++2.6 from Hewlett Packard:
+  _##
+  _##    Copyright (c) 1996
+  _##    Hewlett-Packard Company
+  _##
+  _##  ATTENTION: USE OF THIS SOFTWARE IS SUBJECT TO THE FOLLOWING TERMS.
+  _##  Permission to use, copy, modify, distribute and/or sell this software
+  _##  and/or its documentation is hereby granted without fee. User agrees
+  _##  to display the above copyright notice and this license notice in all
+  _##  copies of the software and any documentation of the software. User
+  _##  agrees to assume all liability for the use of the software;
+  _##  Hewlett-Packard and Jochen Katz make no representations about the
+  _##  suitability of this software for any purpose. It is provided
+  _##  "AS-IS" without warranty of any kind, either express or implied. User
+  _##  hereby grants a royalty-free license to any and all derivatives based
+  _##  upon this software code base.
+  _##
+  _##########################################################################*/
+
+
+char mb_hash_cpp_version[]="@(#) SNMP++ $Id$";
+
+#include <libsnmp.h>
+
+#include "snmp_pp/mb_hash.h"
+
+#ifdef SNMP_PP_MB_HASH_AVX2
+#include <immintrin.h>
+#elif defined(SNMP_PP_MB_HASH_SSE2)
+#include <emmintrin.h>
+#endif
+
+#ifdef SNMP_PP_NAMESPACE
+namespace Snmp_pp {
+#endif
+
+#ifdef SNMP_PP_MB_HASH_LANES
+
+#define MB_HASH_LANES  SNMP_PP_MB_HASH_LANES
+#define MB_HASH_BLOCKS (1048576 / 64)   // 1 MByte in blocks of 64 bytes
+
+/*-----------------[ operations on all lanes ]-----------------------*/
+
+#ifdef SNMP_PP_MB_HASH_AVX2
+
+typedef __m256i MBVec;
+
+#define MB_ADD(a, b)     _mm256_add_epi32(a, b)
+#define MB_XOR(a, b)     _mm256_xor_si256(a, b)
+#define MB_AND(a, b)     _mm256_and_si256(a, b)
+#define MB_OR(a, b)      _mm256_or_si256(a, b)
+#define MB_SET1(x)       _mm256_set1_epi32((int)(x))
+#define MB_ROTL(x, n)    _mm256_or_si256(_mm256_slli_epi32(x, n), \
+                                         _mm256_srli_epi32(x, 32 - (n)))
+#define MB_LOAD(p)       _mm256_loadu_si256((const __m256i *)(p))
+#define MB_STORE(p, x)   _mm256_storeu_si256((__m256i *)(p), x)
+
+#else // SNMP_PP_MB_HASH_SSE2
+
+typedef __m128i MBVec;
+
+#define MB_ADD(a, b)     _mm_add_epi32(a, b)
+#define MB_XOR(a, b)     _mm_xor_si128(a, b)
+#define MB_AND(a, b)     _mm_and_si128(a, b)
+#define MB_OR(a, b)      _mm_or_si128(a, b)
+#define MB_SET1(x)       _mm_set1_epi32((int)(x))
+#define MB_ROTL(x, n)    _mm_or_si128(_mm_slli_epi32(x, n), \
+                                      _mm_srli_epi32(x, 32 - (n)))
+#define MB_LOAD(p)       _mm_loadu_si128((const __m128i *)(p))
+#define MB_STORE(p, x)   _mm_storeu_si128((__m128i *)(p), x)
+
+#endif
+
+/*-----------------[ expanded passwords ]----------------------------*/
+
+/*
+ * The expanded password of one lane as 32 bit words.
+ *
+ * The ring holds the repeated password. Its length in words is a
+ * multiple of the password length, so each block starts at a word
+ * boundary of the ring and the bytes need not be assembled for each
+ * block. The ring is followed by the first 16 words again, so the
+ * words of a block are always in one piece.
+ */
+struct MBLane
+{
+  unsigned int *ring;
+  unsigned int  size;   // length of the ring in words
+  unsigned int  pos;    // start of the next block
+};
+
+static bool mb_init_lanes(MBLane *lanes, const int count,
+                          const unsigned char * const *passwords,
+                          const unsigned int *password_lens,
+                          const bool big_endian)
+{
+  int l;
+  for (l = 0; l < MB_HASH_LANES; ++l)
+    lanes[l].ring = 0;
+
+  for (l = 0; l < count; ++l)
+  {
+    const unsigned char *password = passwords[l];
+    unsigned int password_len = password_lens[l];
+    unsigned int size = password_len * ((16 + password_len - 1) / password_len);
+
+    lanes[l].ring = new unsigned int[size + 16];
+    if (!lanes[l].ring)
+      return false;
+    lanes[l].size = size;
+    lanes[l].pos = 0;
+
+    unsigned int index = 0;
+    for (unsigned int i = 0; i < size + 16; ++i)
+    {
+      unsigned int b[4];
+      for (int j = 0; j < 4; ++j)
+      {
+        b[j] = password[index];
+        if (++index == password_len)
+          index = 0;
+      }
+      if (big_endian)
+        lanes[l].ring[i] = (b[0] << 24) | (b[1] << 16) | (b[2] << 8) | b[3];
+      else
+        lanes[l].ring[i] = (b[3] << 24) | (b[2] << 16) | (b[1] << 8) | b[0];
+    }
+  }
+
+  // unused lanes hash the password of lane 0 again
+  for (; l < MB_HASH_LANES; ++l)
+    lanes[l] = lanes[0];
+
+  return true;
+}
+
+static void mb_free_lanes(MBLane *lanes, const int count)
+{
+  for (int l = 0; l < count; ++l)
+    if (lanes[l].ring)
+    {
+      memset(lanes[l].ring, 0, (lanes[l].size + 16) * sizeof(unsigned int));
+      delete [] lanes[l].ring;
+      lanes[l].ring = 0;
+    }
+}
+
+/*
+ * Load the next block of all lanes and transpose it, so w[t] holds
+ * word t of the block of each lane.
+ */
+static inline void mb_next_block(MBLane *lanes, MBVec *w)
+{
+  const unsigned int *src[MB_HASH_LANES];
+
+  for (int l = 0; l < MB_HASH_LANES; ++l)
+  {
+    src[l] = lanes[l].ring + lanes[l].pos;
+    lanes[l].pos += 16;
+    if (lanes[l].pos >= lanes[l].size)
+      lanes[l].pos -= lanes[l].size;
+  }
+
+#ifdef SNMP_PP_MB_HASH_AVX2
+  for (int k = 0; k < 16; k += 8)
+  {
+    __m256i r0 = MB_LOAD(src[0] + k), r1 = MB_LOAD(src[1] + k);
+    __m256i r2 = MB_LOAD(src[2] + k), r3 = MB_LOAD(src[3] + k);
+    __m256i r4 = MB_LOAD(src[4] + k), r5 = MB_LOAD(src[5] + k);
+    __m256i r6 = MB_LOAD(src[6] + k), r7 = MB_LOAD(src[7] + k);
+
+    __m256i t0 = _mm256_unpacklo_epi32(r0, r1);
+    __m256i t1 = _mm256_unpackhi_epi32(r0, r1);
+    __m256i t2 = _mm256_unpacklo_epi32(r2, r3);
+    __m256i t3 = _mm256_unpackhi_epi32(r2, r3);
+    __m256i t4 = _mm256_unpacklo_epi32(r4, r5);
+    __m256i t5 = _mm256_unpackhi_epi32(r4, r5);
+    __m256i t6 = _mm256_unpacklo_epi32(r6, r7);
+    __m256i t7 = _mm256_unpackhi_epi32(r6, r7);
+
+    r0 = _mm256_unpacklo_epi64(t0, t2);
+    r1 = _mm256_unpackhi_epi64(t0, t2);
+    r2 = _mm256_unpacklo_epi64(t1, t3);
+    r3 = _mm256_unpackhi_epi64(t1, t3);
+    r4 = _mm256_unpacklo_epi64(t4, t6);
+    r5 = _mm256_unpackhi_epi64(t4, t6);
+    r6 = _mm256_unpacklo_epi64(t5, t7);
+    r7 = _mm256_unpackhi_epi64(t5, t7);
+
+    w[k + 0] = _mm256_permute2x128_si256(r0, r4, 0x20);
+    w[k + 1] = _mm256_permute2x128_si256(r1, r5, 0x20);
+    w[k + 2] = _mm256_permute2x128_si256(r2, r6, 0x20);
+    w[k + 3] = _mm256_permute2x128_si256(r3, r7, 0x20);
+    w[k + 4] = _mm256_permute2x128_si256(r0, r4, 0x31);
+    w[k + 5] = _mm256_permute2x128_si256(r1, r5, 0x31);
+    w[k + 6] = _mm256_permute2x128_si256(r2, r6, 0x31);
+    w[k + 7] = _mm256_permute2x128_si256(r3, r7, 0x31);
+  }
+#else
+  for (int k = 0; k < 16; k += 4)
+  {
+    __m128i r0 = MB_LOAD(src[0] + k), r1 = MB_LOAD(src[1] + k);
+    __m128i r2 = MB_LOAD(src[2] + k), r3 = MB_LOAD(src[3] + k);
+
+    __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+    __m128i t1 = _mm_unpackhi_epi32(r0, r1);
+    __m128i t2 = _mm_unpacklo_epi32(r2, r3);
+    __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+
+    w[k + 0] = _mm_unpacklo_epi64(t0, t2);
+    w[k + 1] = _mm_unpackhi_epi64(t0, t2);
+    w[k + 2] = _mm_unpacklo_epi64(t1, t3);
+    w[k + 3] = _mm_unpackhi_epi64(t1, t3);
+  }
+#endif
+}
+
+/*-----------------[ MD5 ]-------------------------------------------*/
+
+#define MD5_F(b, c, d) MB_XOR(d, MB_AND(b, MB_XOR(c, d)))
+#define MD5_G(b, c, d) MB_XOR(c, MB_AND(d, MB_XOR(b, c)))
+#define MD5_H(b, c, d) MB_XOR(MB_XOR(b, c), d)
+#define MD5_I(b, c, d) MB_XOR(c, MB_OR(b, MB_XOR(d, MB_SET1(0xffffffff))))
+
+#define MD5_STEP(f, a, b, c, d, x, s, k) \
+  a = MB_ADD(b, MB_ROTL(MB_ADD(MB_ADD(a, f(b, c, d)), \
+                               MB_ADD(x, MB_SET1(k))), s))
+
+static void mb_md5_block(MBVec *state, const MBVec *x)
+{
+  MBVec a = state[0], b = state[1], c = state[2], d = state[3];
+
+  MD5_STEP(MD5_F, a, b, c, d, x[ 0],  7, 0xd76aa478);
+  MD5_STEP(MD5_F, d, a, b, c, x[ 1], 12, 0xe8c7b756);
+  MD5_STEP(MD5_F, c, d, a, b, x[ 2], 17, 0x242070db);
+  MD5_STEP(MD5_F, b, c, d, a, x[ 3], 22, 0xc1bdceee);
+  MD5_STEP(MD5_F, a, b, c, d, x[ 4],  7, 0xf57c0faf);
+  MD5_STEP(MD5_F, d, a, b, c, x[ 5], 12, 0x4787c62a);
+  MD5_STEP(MD5_F, c, d, a, b, x[ 6], 17, 0xa8304613);
+  MD5_STEP(MD5_F, b, c, d, a, x[ 7], 22, 0xfd469501);
+  MD5_STEP(MD5_F, a, b, c, d, x[ 8],  7, 0x698098d8);
+  MD5_STEP(MD5_F, d, a, b, c, x[ 9], 12, 0x8b44f7af);
+  MD5_STEP(MD5_F, c, d, a, b, x[10], 17, 0xffff5bb1);
+  MD5_STEP(MD5_F, b, c, d, a, x[11], 22, 0x895cd7be);
+  MD5_STEP(MD5_F, a, b, c, d, x[12],  7, 0x6b901122);
+  MD5_STEP(MD5_F, d, a, b, c, x[13], 12, 0xfd987193);
+  MD5_STEP(MD5_F, c, d, a, b, x[14], 17, 0xa679438e);
+  MD5_STEP(MD5_F, b, c, d, a, x[15], 22, 0x49b40821);
+
+  MD5_STEP(MD5_G, a, b, c, d, x[ 1],  5, 0xf61e2562);
+  MD5_STEP(MD5_G, d, a, b, c, x[ 6],  9, 0xc040b340);
+  MD5_STEP(MD5_G, c, d, a, b, x[11], 14, 0x265e5a51);
+  MD5_STEP(MD5_G, b, c, d, a, x[ 0], 20, 0xe9b6c7aa);
+  MD5_STEP(MD5_G, a, b, c, d, x[ 5],  5, 0xd62f105d);
+  MD5_STEP(MD5_G, d, a, b, c, x[10],  9, 0x02441453);
+  MD5_STEP(MD5_G, c, d, a, b, x[15], 14, 0xd8a1e681);
+  MD5_STEP(MD5_G, b, c, d, a, x[ 4], 20, 0xe7d3fbc8);
+  MD5_STEP(MD5_G, a, b, c, d, x[ 9],  5, 0x21e1cde6);
+  MD5_STEP(MD5_G, d, a, b, c, x[14],  9, 0xc33707d6);
+  MD5_STEP(MD5_G, c, d, a, b, x[ 3], 14, 0xf4d50d87);
+  MD5_STEP(MD5_G, b, c, d, a, x[ 8], 20, 0x455a14ed);
+  MD5_STEP(MD5_G, a, b, c, d, x[13],  5, 0xa9e3e905);
+  MD5_STEP(MD5_G, d, a, b, c, x[ 2],  9, 0xfcefa3f8);
+  MD5_STEP(MD5_G, c, d, a, b, x[ 7], 14, 0x676f02d9);
+  MD5_STEP(MD5_G, b, c, d, a, x[12], 20, 0x8d2a4c8a);
+
+  MD5_STEP(MD5_H, a, b, c, d, x[ 5],  4, 0xfffa3942);
+  MD5_STEP(MD5_H, d, a, b, c, x[ 8], 11, 0x8771f681);
+  MD5_STEP(MD5_H, c, d, a, b, x[11], 16, 0x6d9d6122);
+  MD5_STEP(MD5_H, b, c, d, a, x[14], 23, 0xfde5380c);
+  MD5_STEP(MD5_H, a, b, c, d, x[ 1],  4, 0xa4beea44);
+  MD5_STEP(MD5_H, d, a, b, c, x[ 4], 11, 0x4bdecfa9);
+  MD5_STEP(MD5_H, c, d, a, b, x[ 7], 16, 0xf6bb4b60);
+  MD5_STEP(MD5_H, b, c, d, a, x[10], 23, 0xbebfbc70);
+  MD5_STEP(MD5_H, a, b, c, d, x[13],  4, 0x289b7ec6);
+  MD5_STEP(MD5_H, d, a, b, c, x[ 0], 11, 0xeaa127fa);
+  MD5_STEP(MD5_H, c, d, a, b, x[ 3], 16, 0xd4ef3085);
+  MD5_STEP(MD5_H, b, c, d, a, x[ 6], 23, 0x04881d05);
+  MD5_STEP(MD5_H, a, b, c, d, x[ 9],  4, 0xd9d4d039);
+  MD5_STEP(MD5_H, d, a, b, c, x[12], 11, 0xe6db99e5);
+  MD5_STEP(MD5_H, c, d, a, b, x[15], 16, 0x1fa27cf8);
+  MD5_STEP(MD5_H, b, c, d, a, x[ 2], 23, 0xc4ac5665);
+
+  MD5_STEP(MD5_I, a, b, c, d, x[ 0],  6, 0xf4292244);
+  MD5_STEP(MD5_I, d, a, b, c, x[ 7], 10, 0x432aff97);
+  MD5_STEP(MD5_I, c, d, a, b, x[14], 15, 0xab9423a7);
+  MD5_STEP(MD5_I, b, c, d, a, x[ 5], 21, 0xfc93a039);
+  MD5_STEP(MD5_I, a, b, c, d, x[12],  6, 0x655b59c3);
+  MD5_STEP(MD5_I, d, a, b, c, x[ 3], 10, 0x8f0ccc92);
+  MD5_STEP(MD5_I, c, d, a, b, x[10], 15, 0xffeff47d);
+  MD5_STEP(MD5_I, b, c, d, a, x[ 1], 21, 0x85845dd1);
+  MD5_STEP(MD5_I, a, b, c, d, x[ 8],  6, 0x6fa87e4f);
+  MD5_STEP(MD5_I, d, a, b, c, x[15], 10, 0xfe2ce6e0);
+  MD5_STEP(MD5_I, c, d, a, b, x[ 6], 15, 0xa3014314);
+  MD5_STEP(MD5_I, b, c, d, a, x[13], 21, 0x4e0811a1);
+  MD5_STEP(MD5_I, a, b, c, d, x[ 4],  6, 0xf7537e82);
+  MD5_STEP(MD5_I, d, a, b, c, x[11], 10, 0xbd3af235);
+  MD5_STEP(MD5_I, c, d, a, b, x[ 2], 15, 0x2ad7d2bb);
+  MD5_STEP(MD5_I, b, c, d, a, x[ 9], 21, 0xeb86d391);
+
+  state[0] = MB_ADD(state[0], a);
+  state[1] = MB_ADD(state[1], b);
+  state[2] = MB_ADD(state[2], c);
+  state[3] = MB_ADD(state[3], d);
+}
+
+bool mb_md5_password_to_ku(const int count,
+                           const unsigned char * const *passwords,
+                           const unsigned int *password_lens,
+                           unsigned char *kus)
+{
+  if ((count < 1) || (count > MB_HASH_LANES))
+    return false;
+
+  MBLane lanes[MB_HASH_LANES];
+  if (!mb_init_lanes(lanes, count, passwords, password_lens, false))
+  {
+    mb_free_lanes(lanes, count);
+    return false;
+  }
+
+  MBVec state[4], w[16];
+  state[0] = MB_SET1(0x67452301);
+  state[1] = MB_SET1(0xefcdab89);
+  state[2] = MB_SET1(0x98badcfe);
+  state[3] = MB_SET1(0x10325476);
+
+  for (long n = 0; n < MB_HASH_BLOCKS; ++n)
+  {
+    mb_next_block(lanes, w);
+    mb_md5_block(state, w);
+  }
+
+  // padding block: 0x80 and the length of 2^23 bits (little endian)
+  w[0] = MB_SET1(0x00000080);
+  for (int t = 1; t < 16; ++t)
+    w[t] = MB_SET1(0);
+  w[14] = MB_SET1(0x00800000);
+  mb_md5_block(state, w);
+
+  unsigned int words[4][MB_HASH_LANES];
+  for (int i = 0; i < 4; ++i)
+    MB_STORE(words[i], state[i]);
+
+  for (int l = 0; l < count; ++l)
+    for (int i = 0; i < 4; ++i)
+    {
+      unsigned char *ku = kus + l * 16 + i * 4;
+      ku[0] = (unsigned char)(words[i][l]);
+      ku[1] = (unsigned char)(words[i][l] >> 8);
+      ku[2] = (unsigned char)(words[i][l] >> 16);
+      ku[3] = (unsigned char)(words[i][l] >> 24);
+    }
+
+  mb_free_lanes(lanes, count);
+  return true;
+}
+
+/*-----------------[ SHA-1 ]-----------------------------------------*/
+
+#define SHA1_CH(b, c, d)     MB_XOR(d, MB_AND(b, MB_XOR(c, d)))
+#define SHA1_PARITY(b, c, d) MB_XOR(MB_XOR(b, c), d)
+#define SHA1_MAJ(b, c, d)    MB_OR(MB_AND(b, c), MB_AND(d, MB_OR(b, c)))
+
+// message schedule in a ring of 16 words
+#define SHA1_W(t) \
+  ((t) < 16 ? w[t] : \
+   (w[(t) & 15] = MB_ROTL(MB_XOR(MB_XOR(w[((t) - 3) & 15], w[((t) - 8) & 15]),\
+                                 MB_XOR(w[((t) - 14) & 15], w[(t) & 15])), 1)))
+
+#define SHA1_STEP(f, k, a, b, c, d, e, t) \
+  e = MB_ADD(MB_ADD(e, MB_ROTL(a, 5)), \
+             MB_ADD(MB_ADD(f(b, c, d), MB_SET1(k)), SHA1_W(t))); \
+  b = MB_ROTL(b, 30)
+
+#define SHA1_ROUND(f, k, first) \
+  for (t = first; t < first + 20; t += 5) \
+  { \
+    SHA1_STEP(f, k, a, b, c, d, e, t); \
+    SHA1_STEP(f, k, e, a, b, c, d, t + 1); \
+    SHA1_STEP(f, k, d, e, a, b, c, t + 2); \
+    SHA1_STEP(f, k, c, d, e, a, b, t + 3); \
+    SHA1_STEP(f, k, b, c, d, e, a, t + 4); \
+  }
+
+static void mb_sha1_block(MBVec *state, MBVec *w)
+{
+  MBVec a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+  int t;
+
+  SHA1_ROUND(SHA1_CH,     0x5a827999,  0);
+  SHA1_ROUND(SHA1_PARITY, 0x6ed9eba1, 20);
+  SHA1_ROUND(SHA1_MAJ,    0x8f1bbcdc, 40);
+  SHA1_ROUND(SHA1_PARITY, 0xca62c1d6, 60);
+
+  state[0] = MB_ADD(state[0], a);
+  state[1] = MB_ADD(state[1], b);
+  state[2] = MB_ADD(state[2], c);
+  state[3] = MB_ADD(state[3], d);
+  state[4] = MB_ADD(state[4], e);
+}
+
+bool mb_sha1_password_to_ku(const int count,
+                            const unsigned char * const *passwords,
+                            const unsigned int *password_lens,
+                            unsigned char *kus)
+{
+  if ((count < 1) || (count > MB_HASH_LANES))
+    return false;
+
+  MBLane lanes[MB_HASH_LANES];
+  if (!mb_init_lanes(lanes, count, passwords, password_lens, true))
+  {
+    mb_free_lanes(lanes, count);
+    return false;
+  }
+
+  MBVec state[5], w[16];
+  state[0] = MB_SET1(0x67452301);
+  state[1] = MB_SET1(0xefcdab89);
+  state[2] = MB_SET1(0x98badcfe);
+  state[3] = MB_SET1(0x10325476);
+  state[4] = MB_SET1(0xc3d2e1f0);
+
+  for (long n = 0; n < MB_HASH_BLOCKS; ++n)
+  {
+    mb_next_block(lanes, w);
+    mb_sha1_block(state, w);
+  }
+
+  // padding block: 0x80 and the length of 2^23 bits (big endian)
+  w[0] = MB_SET1(0x80000000);
+  for (int t = 1; t < 16; ++t)
+    w[t] = MB_SET1(0);
+  w[15] = MB_SET1(0x00800000);
+  mb_sha1_block(state, w);
+
+  unsigned int words[5][MB_HASH_LANES];
+  for (int i = 0; i < 5; ++i)
+    MB_STORE(words[i], state[i]);
+
+  for (int l = 0; l < count; ++l)
+    for (int i = 0; i < 5; ++i)
+    {
+      unsigned char *ku = kus + l * 20 + i * 4;
+      ku[0] = (unsigned char)(words[i][l] >> 24);
+      ku[1] = (unsigned char)(words[i][l] >> 16);
+      ku[2] = (unsigned char)(words[i][l] >> 8);
+      ku[3] = (unsigned char)(words[i][l]);
+    }
+
+  mb_free_lanes(lanes, count);
+  return true;
+}
+
+#endif // SNMP_PP_MB_HASH_LANES
+
+#ifdef SNMP_PP_NAMESPACE
+} // end of namespace Snmp_pp
+#endif
@@ -60,9 +60,16 @@ v3MP *v3MP::I = 0;
 #define BEGIN_REENTRANT_CODE_BLOCK SnmpSynchronize auto_lock(lock)
 #define BEGIN_REENTRANT_CODE_BLOCK_CONST  \
           SnmpSynchronize auto_lock(*(PP_CONST_CAST(SnmpSynchronized*, &lock)))
+// The engine id table is read for every message, lookups only take
+// the read lock.
+#define BEGIN_READ_CODE_BLOCK_CONST  \
+          SnmpReadLock auto_read_lock(*(PP_CONST_CAST(SnmpReadWriteLock*, &rw_lock)))
+#define BEGIN_WRITE_CODE_BLOCK SnmpWriteLock auto_write_lock(rw_lock)
 #else
 #define BEGIN_REENTRANT_CODE_BLOCK
 #define BEGIN_REENTRANT_CODE_BLOCK_CONST
+#define BEGIN_READ_CODE_BLOCK_CONST
+#define BEGIN_WRITE_CODE_BLOCK
 #endif
 
 // ========================[ Engine id table ]=============================
@@ -89,6 +96,60 @@ v3MP::EngineIdTable::~EngineIdTable()
   table = 0;
 }
 
+unsigned int v3MP::EngineIdTable::engine_id_hash(const OctetStr &engine_id)
+{
+  return SnmpHashIndex::hash(engine_id.data(), engine_id.len());
+}
+
+unsigned int v3MP::EngineIdTable::host_hash(const OctetStr &host,
+                                            const int port)
+{
+  return SnmpHashIndex::hash((const unsigned char *)&port, sizeof(port),
+                             SnmpHashIndex::hash(host.data(), host.len()));
+}
+
+int v3MP::EngineIdTable::find_engine_id(const OctetStr &engine_id) const
+{
+  /* Table is locked through caller */
+  unsigned int hash = engine_id_hash(engine_id);
+  unsigned long cursor;
+
+  for (int i = engine_id_index.first(hash, cursor); i >= 0;
+       i = engine_id_index.next(hash, cursor))
+    if (table[i].engine_id == engine_id)
+      return i;
+  return -1;
+}
+
+int v3MP::EngineIdTable::find_host(const OctetStr &host, const int port) const
+{
+  /* Table is locked through caller */
+  unsigned int hash = host_hash(host, port);
+  unsigned long cursor;
+
+  for (int i = host_index.first(hash, cursor); i >= 0;
+       i = host_index.next(hash, cursor))
+    if ((table[i].port == port) && (table[i].host == host))
+      return i;
+  return -1;
+}
+
+void v3MP::EngineIdTable::remove_entry(const int nr)
+{
+  /* Table is locked through caller */
+  engine_id_index.remove(engine_id_hash(table[nr].engine_id), nr);
+  host_index.remove(host_hash(table[nr].host, table[nr].port), nr);
+
+  int last = entries - 1;
+  if (nr != last)
+  {
+    engine_id_index.move(engine_id_hash(table[last].engine_id), last, nr);
+    host_index.move(host_hash(table[last].host, table[last].port), last, nr);
+    table[nr] = table[last];
+  }
+  entries--;
+}
+
 // Add an entry to the table.
 int v3MP::EngineIdTable::add_entry(const OctetStr &engine_id,
                                    const OctetStr &host, int port)
@@ -103,46 +164,33 @@ int v3MP::EngineIdTable::add_entry(const OctetStr &engine_id,
   LOG(port);
   LOG_END;
 
-  BEGIN_REENTRANT_CODE_BLOCK;
-
-  for (int i = 0; i < entries; i++)
-    if (((table[i].port == port) &&
-         (table[i].host == host)) ||
-	(table[i].engine_id == engine_id))
-    {
-      LOG_BEGIN(loggerModuleName, INFO_LOG | 2);
-      LOG("v3MP::EngineIdTable: replace entry (old id) (old host) (old port) (id) (host) (port)");
-      LOG(table[i].engine_id.get_printable());
-      LOG(table[i].host.get_printable());
-      LOG(table[i].port);
-      LOG(engine_id.get_printable());
-      LOG(host.get_printable());
-      LOG(port);
-      LOG_END;
+  BEGIN_WRITE_CODE_BLOCK;
 
-      table[i].engine_id = engine_id;
-      table[i].host = host;
-      table[i].port = port;
-
-      return SNMPv3_MP_OK;         // host is in table
-    }
+  int i;
+  while (((i = find_engine_id(engine_id)) >= 0) ||
+         ((i = find_host(host, port)) >= 0))
+  {
+    LOG_BEGIN(loggerModuleName, INFO_LOG | 2);
+    LOG("v3MP::EngineIdTable: replace entry (old id) (old host) (old port) (id) (host) (port)");
+    LOG(table[i].engine_id.get_printable());
+    LOG(table[i].host.get_printable());
+    LOG(table[i].port);
+    LOG(engine_id.get_printable());
+    LOG(host.get_printable());
+    LOG(port);
+    LOG_END;
 
-  table[entries].engine_id = engine_id;
-  table[entries].host = host;
-  table[entries].port = port;
+    remove_entry(i);
+  }
 
-  entries++;
   if (entries == max_entries)
   {
     // resize Table
     struct Entry_T *tmp;
     tmp = new struct Entry_T[2 * max_entries];
     if (!tmp)
-    {
-      entries--;
       return SNMPv3_MP_ERROR;
-    }
-    for (int i = 0; i < entries; i++)
+    for (i = 0; i < entries; i++)
       tmp[i] = table[i];
 
     delete [] table;
@@ -150,6 +198,18 @@ int v3MP::EngineIdTable::add_entry(const OctetStr &engine_id,
     max_entries *= 2;
   }
 
+  if (!engine_id_index.reserve(entries + 1) ||
+      !host_index.reserve(entries + 1))
+    return SNMPv3_MP_ERROR;
+
+  table[entries].engine_id = engine_id;
+  table[entries].host = host;
+  table[entries].port = port;
+  engine_id_index.add(engine_id_hash(engine_id), entries);
+  host_index.add(host_hash(host, port), entries);
+
+  entries++;
+
   return SNMPv3_MP_OK;
 }
 
@@ -196,31 +256,24 @@ int v3MP::EngineIdTable::get_entry(OctetStr &engine_id,
   if (!table)
     return SNMPv3_MP_NOT_INITIALIZED;
 
-  BEGIN_REENTRANT_CODE_BLOCK_CONST;
-
-  int i, found = 0;
+  {
+    BEGIN_READ_CODE_BLOCK_CONST;
 
-  for (i = 0; i < entries; i++)
-    if ((table[i].port == port) &&
-        (table[i].host == host))
+    int i = find_host(host, port);
+    if (i >= 0)
     {
-      found=1;
-      break;
+      engine_id = table[i].engine_id;
+      return SNMPv3_MP_OK;
     }
-  if (!found)
-  {
-    LOG_BEGIN(loggerModuleName, INFO_LOG | 4);
-    LOG("v3MP::EngineIdTable: Dont know engine id for (host) (port)");
-    LOG(host.get_printable());
-    LOG(port);
-    LOG_END;
-
-    return SNMPv3_MP_ERROR;
   }
 
-  engine_id = table[i].engine_id;
+  LOG_BEGIN(loggerModuleName, INFO_LOG | 4);
+  LOG("v3MP::EngineIdTable: Dont know engine id for (host) (port)");
+  LOG(host.get_printable());
+  LOG(port);
+  LOG_END;
 
-  return SNMPv3_MP_OK;
+  return SNMPv3_MP_ERROR;
 }
 
 // Remove all entries from the engine id table.
@@ -233,9 +286,11 @@ int v3MP::EngineIdTable::reset()
   LOG("v3MP::EngineIdTable: Resetting table.");
   LOG_END;
 
-  BEGIN_REENTRANT_CODE_BLOCK;
+  BEGIN_WRITE_CODE_BLOCK;
 
   entries = 0;
+  engine_id_index.clear();
+  host_index.clear();
 
   return SNMPv3_MP_OK;
 }
@@ -246,17 +301,10 @@ int v3MP::EngineIdTable::delete_entry(const OctetStr &engine_id)
   if (!table)
     return SNMPv3_MP_NOT_INITIALIZED;
 
-  int i, found = 0;
-
-  BEGIN_REENTRANT_CODE_BLOCK;
+  BEGIN_WRITE_CODE_BLOCK;
 
-  for (i = 0; i < entries; i++)
-    if (table[i].engine_id == engine_id)
-    {
-      found=1;
-      break;
-    }
-  if (!found)
+  int i = find_engine_id(engine_id);
+  if (i < 0)
   {
     LOG_BEGIN(loggerModuleName, WARNING_LOG | 4);
     LOG("v3MP::EngineIdTable: cannot remove nonexisting entry (engine id)");
@@ -267,10 +315,7 @@ int v3MP::EngineIdTable::delete_entry(const OctetStr &engine_id)
   }
 
   /* i is the entry to remove */
-  if (i != entries - 1)
-    table[i] = table[entries-1];
-
-  entries--;
+  remove_entry(i);
 
   return SNMPv3_MP_OK;
 }
@@ -281,18 +326,10 @@ int v3MP::EngineIdTable::delete_entry(const OctetStr &host, int port)
   if (!table)
     return SNMPv3_MP_NOT_INITIALIZED;
 
-  int i, found = 0;
-
-  BEGIN_REENTRANT_CODE_BLOCK;
+  BEGIN_WRITE_CODE_BLOCK;
 
-  for (i = 0; i < entries; i++)
-    if ((table[i].port == port) &&
-        (table[i].host == host))
-    {
-      found=1;
-      break;
-    }
-  if (!found)
+  int i = find_host(host, port);
+  if (i < 0)
   {
     LOG_BEGIN(loggerModuleName, WARNING_LOG | 4);
     LOG("v3MP::EngineIdTable: cannot remove nonexisting entry (host) (port)");
@@ -304,10 +341,7 @@ int v3MP::EngineIdTable::delete_entry(const OctetStr &host, int port)
   }
 
   /* i is the entry to remove */
-  if (i != entries - 1)
-    table[i] = table[entries-1];
-
-  entries--;
+  remove_entry(i);
 
   return SNMPv3_MP_OK;
 }
@@ -316,6 +350,12 @@ bool v3MP::EngineIdTable::initialize_table(const int size)
 {
   table = new struct Entry_T[size];
   entries = 0;
+  if (table &&
+      (!engine_id_index.reserve(size) || !host_index.reserve(size)))
+  {
+    delete [] table;
+    table = 0;
+  }
   if (!table)
   {
     max_entries = 0;
@@ -624,6 +664,20 @@ int v3MP::Cache::get_entry(int searchedID, bool local_request,
   return SNMPv3_MP_ERROR;
 }
 
+// Check if a local request with the given message id is in the cache.
+bool v3MP::Cache::contains_local_entry(int msg_id)
+{
+  if (!table) return false;
+
+  BEGIN_REENTRANT_CODE_BLOCK;
+
+  for (int i=0; i < entries; i++)
+    if ((table[i].msg_id == msg_id) && (table[i].local_request))
+      return true;
+
+  return false;
+}
+
 void v3MP::Cache::delete_content(struct v3MP::Cache::Entry_T &ce)
 {
   if (ce.sec_state_ref)
@@ -632,6 +686,26 @@ void v3MP::Cache::delete_content(struct v3MP::Cache::Entry_T &ce)
 
 // ==========================[ class v3MP ]===============================
 
+// Get a msgID (1..MAX_MPMSGID-1) that is not used by a cached request.
+int v3MP::next_msg_id()
+{
+  int msgID;
+
+  do {
+    unsigned long count = msg_id_counter.increment();
+    msgID = (int)(((count - 1) % (MAX_MPMSGID - 1)) + 1);
+
+    if (!msg_id_wrapped.get())
+    {
+      if (count < MAX_MPMSGID)
+        return msgID;
+      msg_id_wrapped.set(1);
+    }
+  } while (cache.contains_local_entry(msgID));
+
+  return msgID;
+}
+
 // Initialize the v3MP.
 v3MP::v3MP(const OctetStr& snmpEngineID,
            unsigned int engineBoots, int &construct_status)
@@ -663,6 +737,9 @@ v3MP::v3MP(const OctetStr& snmpEngineID,
 
   if (cur_msg_id >= MAX_MPMSGID)
     cur_msg_id = 1;
+  // next_msg_id() returns the incremented counter value
+  msg_id_counter.set(cur_msg_id - 1);
+  msg_id_wrapped.set(0);
 
   if ((!own_engine_id) || (!usm) || (result != SNMPv3_USM_OK))
   {
@@ -724,7 +801,7 @@ int v3MP::send_report(unsigned char* scopedPDU, int scopedPDULength,
 
   debugprintf(2, "v3MP::send_report: securityLevel %d",sLevel);
 
-  if (scopedPDULength != MAX_SNMP_PACKET)
+  if (scopedPDU && (scopedPDULength > 0))
   {
     // try to get scopedPDU and PDU
     data = asn1_parse_scoped_pdu(scopedPDU, &scopedPDULength,
@@ -751,8 +828,8 @@ int v3MP::send_report(unsigned char* scopedPDU, int scopedPDULength,
         debugprintf(0, "mp: Error while trying to parse PDU!");
       }
     } // end of: if (data == NULL)
-  } // end if (scopedPDULength != MAX_SNMP_PACKET)
-  else { // scopedPDULength == MAX_SNMP_PACKET
+  } // end if (scopedPDU && (scopedPDULength > 0))
+  else { // scopedPDU unknown
     cEngineID[0] = '\0';
     cEngineIDLength = 0;
     cName[0] = '\0';
@@ -847,8 +924,8 @@ int v3MP::send_report(unsigned char* scopedPDU, int scopedPDULength,
                (int) smioid->len, &smival);
   freeSmivalDescriptor(&smival);
 
-  Buffer<unsigned char> sendbuffer(MAX_SNMP_PACKET);
-  int sendbufferlen= MAX_SNMP_PACKET;
+  MessageBuffer sendbuffer;
+  int sendbufferlen = sendbuffer.size();
   status = snmp_build( pdu, sendbuffer.get_ptr(), &sendbufferlen,
 		       own_engine_id_oct, sName, sModel, sLevel,
 		       OctetStr(cEngineID, cEngineIDLength),
@@ -895,7 +972,7 @@ int v3MP::snmp_parse(Snmp *snmp_session,
   debugprintf(3, "mp is parsing incoming message:");
   debughexprintf(25, inBuf, inBufLength);
 
-  if (inBufLength > MAX_SNMP_PACKET)
+  if (inBufLength > (int)MessageBuffer::get_max_message_size())
     return  SNMPv3_MP_ERROR;
 
   unsigned char type;
@@ -904,11 +981,11 @@ int v3MP::snmp_parse(Snmp *snmp_session,
   unsigned char *inBufPtr = inBuf;
   long msgID, msgMaxSize;
   unsigned char msgFlags;
-  Buffer<unsigned char> msgSecurityParameters(MAX_SNMP_PACKET);
-  Buffer<unsigned char> msgData(MAX_SNMP_PACKET);
+  MessageBuffer msgSecurityParameters;
+  MessageBuffer msgData;
   int msgSecurityParametersLength = inBufLength,   msgDataLength = inBufLength;
-  Buffer<unsigned char> scopedPDU(MAX_SNMP_PACKET);
-  int scopedPDULength = MAX_SNMP_PACKET;
+  MessageBuffer scopedPDU;
+  int scopedPDULength = scopedPDU.size();
   long  maxSizeResponseScopedPDU = 0;
   struct SecurityStateReference *securityStateReference = NULL;
   int securityParametersPosition;
@@ -962,7 +1039,8 @@ int v3MP::snmp_parse(Snmp *snmp_session,
   }
 
   // do not allow larger messages than this entity can handle
-  if (msgMaxSize > MAX_SNMP_PACKET) msgMaxSize = MAX_SNMP_PACKET;
+  if (msgMaxSize > (long)MessageBuffer::get_max_message_size())
+    msgMaxSize = MessageBuffer::get_max_message_size();
   pdu->maxsize_scopedpdu = msgMaxSize;
 
   inBuf = asn_parse_string( inBuf, &inBufLength, &type,
@@ -1107,7 +1185,10 @@ int v3MP::snmp_parse(Snmp *snmp_session,
                       securityName, securityLevel, "", "",
                       securityStateReference, errorCode, CACHE_REMOTE_REQ);
 
-      send_report(scopedPDUPtr, scopedPDULength, pdu, errorCode,
+      // scopedPDULength is unchanged if the scopedPDU was not decoded
+      send_report(scopedPDUPtr,
+		  (scopedPDULength < (int)scopedPDU.size()) ? scopedPDULength : 0,
+		  pdu, errorCode,
 		  securityLevel, msgSecurityModel, securityName,
 		  from_address, snmp_session);
       clear_pdu(pdu, true);   // Clear pdu and free all content AND IDs!
@@ -1211,7 +1292,7 @@ int v3MP::snmp_parse(Snmp *snmp_session,
 			    SNMPv3_MP_INVALID_ENGINEID,
 			    CACHE_REMOTE_REQ);
 
-	    send_report(0, MAX_SNMP_PACKET, pdu, SNMPv3_MP_INVALID_ENGINEID,
+	    send_report(0, 0, pdu, SNMPv3_MP_INVALID_ENGINEID,
 			SNMP_SECURITY_LEVEL_NOAUTH_NOPRIV, msgSecurityModel,
 			securityName, from_address, snmp_session);
 	    clear_pdu(pdu, true);  // Clear pdu and free all content AND IDs!
@@ -1297,50 +1378,34 @@ bool v3MP::is_v3_msg(unsigned char *buffer, int length)
 
 
 
-// Do the complete process of encoding the given values into the buffer
-// ready to send to the target.
-int v3MP::snmp_build(struct snmp_pdu *pdu,
-		     unsigned char *packet,
-		     int *out_length,             // maximum Bytes in packet
-		     const OctetStr &securityEngineID,
-		     const OctetStr &securityName,
-		     int securityModel,
-		     int securityLevel,
-		     const OctetStr &contextEngineID,
-		     const OctetStr &contextName)
+// Is the pdu type one that is sent without a previous request?
+static inline bool is_request_message(const int command)
+{
+  return ((command == GET_REQ_MSG) || (command == GETNEXT_REQ_MSG) ||
+          (command == SET_REQ_MSG) || (command == GETBULK_REQ_MSG) ||
+          (command == TRP_REQ_MSG) || (command == INFORM_REQ_MSG)  ||
+          (command == TRP2_REQ_MSG));
+}
+
+// Get the message id for a message to build.
+int v3MP::prepare_build(const int command, const unsigned long pduMsgID,
+			const OctetStr &securityEngineID,
+			int &securityModel, int &securityLevel, int &msgID,
+			struct SecurityStateReference *&securityStateReference)
 {
-  Buffer<unsigned char> scopedPDU(MAX_SNMP_PACKET);
-  unsigned char *scopedPDUPtr = scopedPDU.get_ptr();
-  unsigned char globalData[MAXLENGTH_GLOBALDATA];
-  int globalDataLength = MAXLENGTH_GLOBALDATA;
-  int scopedPDULength, maxLen = *out_length;
-  Buffer<unsigned char> buf(MAX_SNMP_PACKET);
-  unsigned char *bufPtr = buf.get_ptr();
-  long bufLength = 0, rc;
-  int msgID;
   int cachedErrorCode = SNMPv3_MP_OK;
-  struct SecurityStateReference *securityStateReference = NULL;
-  int isRequestMessage = 0;
 
-  if ((pdu->command == GET_REQ_MSG) || (pdu->command == GETNEXT_REQ_MSG) ||
-      (pdu->command == SET_REQ_MSG) || (pdu->command == GETBULK_REQ_MSG) ||
-      (pdu->command == TRP_REQ_MSG) || (pdu->command == INFORM_REQ_MSG)  ||
-      (pdu->command == TRP2_REQ_MSG))
-    isRequestMessage = 1;
+  securityStateReference = NULL;
 
-  if (isRequestMessage) {
+  if (is_request_message(command))
+  {
     if (securityEngineID.len() == 0) {
       // First Contact => use user  noAuthNoPriv and USM
       securityLevel = SNMP_SECURITY_LEVEL_NOAUTH_NOPRIV;
       securityModel = SNMP_SECURITY_MODEL_USM;
     }
 
-    cur_msg_id_lock.lock();
-    msgID = cur_msg_id;
-    cur_msg_id++;
-    if (cur_msg_id >= MAX_MPMSGID)
-      cur_msg_id = 1;
-    cur_msg_id_lock.unlock();
+    msgID = next_msg_id();
 
 #ifdef INVALID_MSGID
     LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
@@ -1349,20 +1414,13 @@ int v3MP::snmp_build(struct snmp_pdu *pdu,
 
     msgID = 0xdead;
 #endif
-
-    if (securityEngineID.len() == 0) {
-      // length==0 => SecurityLevel == noAuthNoPriv
-      //  => we do not send any management information
-      //  => delete VariableBinding
-      clear_pdu(pdu);
-    }
   }
   else {
     // it is a response => search for request
     debugprintf(3, "Looking up cache");
-    msgID = pdu->msgid;
-    rc = cache.get_entry(msgID, CACHE_REMOTE_REQ,
-                         &cachedErrorCode, &securityStateReference);
+    msgID = pduMsgID;
+    int rc = cache.get_entry(msgID, CACHE_REMOTE_REQ,
+                             &cachedErrorCode, &securityStateReference);
 
     if (rc != SNMPv3_MP_OK) {
 
@@ -1371,14 +1429,42 @@ int v3MP::snmp_build(struct snmp_pdu *pdu,
     }
   }
 
-  LOG_BEGIN(loggerModuleName, DEBUG_LOG | 5);
-  LOG("v3MP: Building message with (SecurityEngineID) (securityName) (securityLevel) (contextEngineID) (contextName)");
-  LOG(securityEngineID.get_printable());
-  LOG(securityName.get_printable());
-  LOG(securityLevel);
-  LOG(contextEngineID.get_printable());
-  LOG(contextName.get_printable());
-  LOG_END;
+  return SNMPv3_MP_OK;
+}
+
+// Do the complete process of encoding the given values into the buffer
+// ready to send to the target.
+int v3MP::snmp_build(struct snmp_pdu *pdu,
+		     unsigned char *packet,
+		     int *out_length,             // maximum Bytes in packet
+		     const OctetStr &securityEngineID,
+		     const OctetStr &securityName,
+		     int securityModel,
+		     int securityLevel,
+		     const OctetStr &contextEngineID,
+		     const OctetStr &contextName)
+{
+  MessageBuffer scopedPDU;
+  unsigned char *scopedPDUPtr = scopedPDU.get_ptr();
+  int scopedPDULength, maxLen = *out_length;
+  MessageBuffer buf;
+  unsigned char *bufPtr = buf.get_ptr();
+  long bufLength = 0;
+  int msgID;
+  struct SecurityStateReference *securityStateReference = NULL;
+
+  int rc = prepare_build(pdu->command, pdu->msgid, securityEngineID,
+                         securityModel, securityLevel, msgID,
+                         securityStateReference);
+  if (rc != SNMPv3_MP_OK)
+    return rc;
+
+  if (is_request_message(pdu->command) && (securityEngineID.len() == 0)) {
+    // length==0 => SecurityLevel == noAuthNoPriv
+    //  => we do not send any management information
+    //  => delete VariableBinding
+    clear_pdu(pdu);
+  }
 
   // encode vb in buf
   scopedPDUPtr = build_vb(pdu, scopedPDUPtr, &maxLen);
@@ -1427,6 +1513,93 @@ int v3MP::snmp_build(struct snmp_pdu *pdu,
 
   scopedPDULength = SAFE_INT_CAST(scopedPDUPtr - scopedPDU.get_ptr());
 
+  return build_message(pdu->command, pdu->reqid, msgID,
+                       securityStateReference,
+                       scopedPDU.get_ptr(), scopedPDULength,
+                       packet, out_length, securityEngineID, securityName,
+                       securityModel, securityLevel,
+                       contextEngineID, contextName);
+}
+
+// Encode the pdu directly into the scopedPDU and build the message.
+int v3MP::snmp_build(const Pdu &pdu,
+		     unsigned char *packet,
+		     int *out_length,             // maximum Bytes in packet
+		     const OctetStr &securityEngineID,
+		     const OctetStr &securityName,
+		     int securityModel,
+		     int securityLevel,
+		     const OctetStr &contextEngineID,
+		     const OctetStr &contextName)
+{
+  MessageBuffer scopedPDU;
+  unsigned char *scopedPDUPtr;
+  int maxLen = *out_length;
+  int msgID;
+  struct SecurityStateReference *securityStateReference = NULL;
+
+  int rc = prepare_build(pdu.get_type(), pdu.get_message_id(),
+                         securityEngineID, securityModel, securityLevel,
+                         msgID, securityStateReference);
+  if (rc != SNMPv3_MP_OK)
+    return rc;
+
+  if (is_request_message(pdu.get_type()) && (securityEngineID.len() == 0)) {
+    // length==0 => SecurityLevel == noAuthNoPriv
+    //  => we do not send any management information
+    //  => send the pdu without variable bindings
+    Pdu discovery(pdu);
+    discovery.trim(discovery.get_vb_count());
+
+    scopedPDUPtr = asn1_build_scoped_pdu(scopedPDU.get_ptr(), &maxLen,
+                                         contextEngineID, contextName,
+                                         discovery);
+  }
+  else
+    scopedPDUPtr = asn1_build_scoped_pdu(scopedPDU.get_ptr(), &maxLen,
+                                         contextEngineID, contextName, pdu);
+  if (!scopedPDUPtr)
+  {
+    LOG_BEGIN(loggerModuleName, WARNING_LOG | 1);
+    LOG("v3MP: Error encoding scoped pdu into buffer");
+    LOG_END;
+
+    return SNMPv3_MP_BUILD_ERROR;
+  }
+
+  return build_message(pdu.get_type(), pdu.get_request_id(), msgID,
+                       securityStateReference, scopedPDU.get_ptr(),
+                       SAFE_INT_CAST(scopedPDUPtr - scopedPDU.get_ptr()),
+                       packet, out_length, securityEngineID, securityName,
+                       securityModel, securityLevel,
+                       contextEngineID, contextName);
+}
+
+// Build msgGlobalData and the whole message around the scopedPDU.
+int v3MP::build_message(const int command, const unsigned long requestID,
+			const int msgID,
+			struct SecurityStateReference *securityStateReference,
+			unsigned char *scopedPDU, const int scopedPDULength,
+			unsigned char *packet, int *out_length,
+			const OctetStr &securityEngineID,
+			const OctetStr &securityName,
+			int securityModel, int securityLevel,
+			const OctetStr &contextEngineID,
+			const OctetStr &contextName)
+{
+  unsigned char globalData[MAXLENGTH_GLOBALDATA];
+  int globalDataLength = MAXLENGTH_GLOBALDATA;
+  long rc;
+
+  LOG_BEGIN(loggerModuleName, DEBUG_LOG | 5);
+  LOG("v3MP: Building message with (SecurityEngineID) (securityName) (securityLevel) (contextEngineID) (contextName)");
+  LOG(securityEngineID.get_printable());
+  LOG(securityName.get_printable());
+  LOG(securityLevel);
+  LOG(contextEngineID.get_printable());
+  LOG(contextName.get_printable());
+  LOG_END;
+
   // build msgGlobalData
   unsigned char *globalDataPtr = (unsigned char *)&globalData;
   unsigned char msgFlags;
@@ -1448,9 +1621,9 @@ int v3MP::snmp_build(struct snmp_pdu *pdu,
     }
   }
 
-  if ((pdu->command == GET_REQ_MSG) || (pdu->command == GETNEXT_REQ_MSG) ||
-      (pdu->command == SET_REQ_MSG) || (pdu->command == GETBULK_REQ_MSG) ||
-      (pdu->command == INFORM_REQ_MSG))
+  if ((command == GET_REQ_MSG) || (command == GETNEXT_REQ_MSG) ||
+      (command == SET_REQ_MSG) || (command == GETBULK_REQ_MSG) ||
+      (command == INFORM_REQ_MSG))
     msgFlags = msgFlags | SNMPv3_REPORTABLEFLAG;
 
   globalDataPtr = asn1_build_header_data(globalDataPtr, &globalDataLength,
@@ -1469,8 +1642,8 @@ int v3MP::snmp_build(struct snmp_pdu *pdu,
   switch (securityModel) {
     case SNMP_SECURITY_MODEL_USM: {
       int use_own_engine_id = 0;
-      if ((pdu->command == TRP_REQ_MSG) || (pdu->command == GET_RSP_MSG) ||
-          (pdu->command == REPORT_MSG)  || (pdu->command == TRP2_REQ_MSG)) {
+      if ((command == TRP_REQ_MSG) || (command == GET_RSP_MSG) ||
+          (command == REPORT_MSG)  || (command == TRP2_REQ_MSG)) {
         use_own_engine_id = 1;
       }
 
@@ -1478,14 +1651,14 @@ int v3MP::snmp_build(struct snmp_pdu *pdu,
                              (use_own_engine_id ?
                                         own_engine_id_oct : securityEngineID),
                              securityName, securityLevel,
-                             scopedPDU.get_ptr(), scopedPDULength,
+                             scopedPDU, scopedPDULength,
                              securityStateReference, packet, out_length);
 
       if ( rc == SNMPv3_USM_OK ) {
         // build cache
-        if (!((pdu->command == TRP_REQ_MSG) || (pdu->command == GET_RSP_MSG) ||
-              (pdu->command == REPORT_MSG) || (pdu->command == TRP2_REQ_MSG)))
-          cache.add_entry(msgID, pdu->reqid, securityEngineID,
+        if (!((command == TRP_REQ_MSG) || (command == GET_RSP_MSG) ||
+              (command == REPORT_MSG) || (command == TRP2_REQ_MSG)))
+          cache.add_entry(msgID, requestID, securityEngineID,
                           securityModel, securityName, securityLevel,
                           contextEngineID, contextName, securityStateReference,
                           SNMPv3_MP_OK, CACHE_LOCAL_REQ);
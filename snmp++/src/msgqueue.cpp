@@ -68,12 +68,20 @@ namespace Snmp_pp {
 
 static const char *loggerModuleName = "snmp++.msgqueue";
 
+// sysUpTime.0 and snmpTrapOID.0 of notifications
+static SNMP_PP_OID_LITERAL(sysUpTimeLiteral, SNMP_MSG_OID_SYSUPTIME);
+static SNMP_PP_OID_LITERAL(trapIdLiteral, SNMP_MSG_OID_TRAPID);
+
 //--------[ externs ]---------------------------------------------------
 extern int send_snmp_request(SnmpSocket sock, unsigned char *send_buf,
                              size_t send_len, const Address &address);
 extern int receive_snmp_response(SnmpSocket sock, Snmp &snmp_session,
                                  Pdu &pdu, UdpAddress &fromaddress,
                                  OctetStr &engine_id, bool process_msg = true);
+extern int process_snmp_response(unsigned char *receive_buffer,
+                                 long receive_buffer_len, Snmp &snmp_session,
+                                 Pdu &pdu, UdpAddress &fromaddress,
+                                 OctetStr &engine_id);
 
 //----[ CSNMPMessage class ]-------------------------------------------
 
@@ -181,11 +189,11 @@ int CSNMPMessage::SetPdu(const int reason, const Pdu &pdu,
 
     const Vb &vb1 = m_pdu.get_vb(0);
     if (vb1.get_syntax() != sNMP_SYNTAX_TIMETICKS)   return 0;
-    if (vb1.get_oid()    != SNMP_MSG_OID_SYSUPTIME)  return 0;
+    if (vb1.get_oid()    != sysUpTimeLiteral)        return 0;
 
     const Vb &vb2 = m_pdu.get_vb(1);
     if (vb2.get_syntax() != sNMP_SYNTAX_OID)         return 0;
-    if (vb2.get_oid()    != SNMP_MSG_OID_TRAPID)     return 0;
+    if (vb2.get_oid()    != trapIdLiteral)           return 0;
 
     TimeTicks timeticks;
     Oid oid;
@@ -257,7 +265,8 @@ CSNMPMessageQueue::CSNMPMessageQueueElt::CSNMPMessageQueueElt(
                                            CSNMPMessage *message,
                                            CSNMPMessageQueueElt *next,
                                            CSNMPMessageQueueElt *previous):
-  m_message(message), m_Next(next), m_previous(previous)
+  m_message(message), m_Next(next), m_previous(previous),
+  m_hashNext(0), m_heapIndex(-1)
 {
   /* Finish insertion into doubly linked list */
   if (m_Next)     m_Next->m_previous = this;
@@ -283,9 +292,243 @@ CSNMPMessage *CSNMPMessageQueue::CSNMPMessageQueueElt::TestId(const unsigned lon
 
 //----[ CSNMPMessageQueue class ]--------------------------------------
 
+#define MSGQUEUE_INITIAL_HASH_SIZE 64
+
+void CSNMPMessageQueue::WatchSocket(const SnmpSocket socket)
+{
+#ifdef HAVE_EPOLL_SYSCALL
+  my_holder->AddFd(socket, this);
+#else
+  (void)socket;
+#endif
+}
+
+void CSNMPMessageQueue::UnwatchSocket(const SnmpSocket socket)
+{
+#ifdef HAVE_EPOLL_SYSCALL
+  my_holder->RemoveFd(socket);
+#else
+  (void)socket;
+#endif
+}
+
+// Request ids are assigned sequentially, so the low bits of the
+// id spread the messages evenly over the buckets.
+CSNMPMessageQueue::CSNMPMessageQueueElt *CSNMPMessageQueue::FindElt(
+                                                const unsigned long uniqueId)
+{
+  CSNMPMessageQueueElt *elt = m_hashTable[uniqueId & (m_hashSize - 1)];
+
+  while (elt)
+  {
+    if (elt->TestId(uniqueId))
+      return elt;
+    elt = elt->GetHashNext();
+  }
+  return 0;
+}
+
+void CSNMPMessageQueue::HashInsert(CSNMPMessageQueueElt *elt)
+{
+  unsigned long bucket = elt->GetMessage()->GetId() & (m_hashSize - 1);
+
+  elt->SetHashNext(m_hashTable[bucket]);
+  m_hashTable[bucket] = elt;
+
+  if ((unsigned long)m_msgCount > m_hashSize)
+    HashGrow();
+}
+
+void CSNMPMessageQueue::HashRemove(CSNMPMessageQueueElt *elt)
+{
+  unsigned long bucket = elt->GetMessage()->GetId() & (m_hashSize - 1);
+  CSNMPMessageQueueElt *ptr = m_hashTable[bucket];
+  CSNMPMessageQueueElt *prev = 0;
+
+  while (ptr)
+  {
+    if (ptr == elt)
+    {
+      if (prev)
+        prev->SetHashNext(elt->GetHashNext());
+      else
+        m_hashTable[bucket] = elt->GetHashNext();
+      elt->SetHashNext(0);
+      return;
+    }
+    prev = ptr;
+    ptr = ptr->GetHashNext();
+  }
+}
+
+void CSNMPMessageQueue::HashGrow()
+{
+  unsigned long newSize = m_hashSize * 2;
+  CSNMPMessageQueueElt **newTable = new CSNMPMessageQueueElt*[newSize];
+  memset(newTable, 0, newSize * sizeof(CSNMPMessageQueueElt*));
+
+  // all elements are also in the linked list
+  for (CSNMPMessageQueueElt *elt = m_head.GetNext(); elt; elt = elt->GetNext())
+  {
+    unsigned long bucket = elt->GetMessage()->GetId() & (newSize - 1);
+    elt->SetHashNext(newTable[bucket]);
+    newTable[bucket] = elt;
+  }
+  delete [] m_hashTable;
+  m_hashTable = newTable;
+  m_hashSize = newSize;
+
+  LOG_BEGIN(loggerModuleName, DEBUG_LOG | 10);
+  LOG("MsgQueue: Resized request id index (buckets)");
+  LOG(newSize);
+  LOG_END;
+}
+
+void CSNMPMessageQueue::HeapSet(const int index, CSNMPMessageQueueElt *elt)
+{
+  m_heap[index] = elt;
+  elt->SetHeapIndex(index);
+}
+
+bool CSNMPMessageQueue::HeapLess(const int i, const int j) const
+{
+  msec time_i, time_j;
+
+  m_heap[i]->GetMessage()->GetSendTime(time_i);
+  m_heap[j]->GetMessage()->GetSendTime(time_j);
+  return (time_i < time_j) != 0;
+}
+
+void CSNMPMessageQueue::HeapSiftUp(int index)
+{
+  while (index > 0)
+  {
+    int parent = (index - 1) / 2;
+    if (!HeapLess(index, parent))
+      break;
+    CSNMPMessageQueueElt *tmp = m_heap[parent];
+    HeapSet(parent, m_heap[index]);
+    HeapSet(index, tmp);
+    index = parent;
+  }
+}
+
+void CSNMPMessageQueue::HeapSiftDown(int index)
+{
+  while (true)
+  {
+    int smallest = index;
+    int left = 2 * index + 1;
+    int right = left + 1;
+
+    if ((left < m_heapSize) && HeapLess(left, smallest))
+      smallest = left;
+    if ((right < m_heapSize) && HeapLess(right, smallest))
+      smallest = right;
+    if (smallest == index)
+      break;
+    CSNMPMessageQueueElt *tmp = m_heap[smallest];
+    HeapSet(smallest, m_heap[index]);
+    HeapSet(index, tmp);
+    index = smallest;
+  }
+}
+
+void CSNMPMessageQueue::HeapInsert(CSNMPMessageQueueElt *elt)
+{
+  if (m_heapSize >= m_heapCapacity)
+  {
+    int newCapacity = m_heapCapacity ? 2 * m_heapCapacity
+                                     : MSGQUEUE_INITIAL_HASH_SIZE;
+    CSNMPMessageQueueElt **newHeap = new CSNMPMessageQueueElt*[newCapacity];
+    if (m_heapSize)
+      memcpy(newHeap, m_heap, m_heapSize * sizeof(CSNMPMessageQueueElt*));
+    delete [] m_heap;
+    m_heap = newHeap;
+    m_heapCapacity = newCapacity;
+  }
+  HeapSet(m_heapSize, elt);
+  m_heapSize++;
+  HeapSiftUp(m_heapSize - 1);
+}
+
+void CSNMPMessageQueue::HeapRemove(CSNMPMessageQueueElt *elt)
+{
+  int index = elt->GetHeapIndex();
+  if (index < 0)
+    return;
+
+  m_heapSize--;
+  if (index != m_heapSize)
+  {
+    // move the last element into the gap and restore the heap order
+    HeapSet(index, m_heap[m_heapSize]);
+    HeapSiftDown(index);
+    HeapSiftUp(m_heap[index]->GetHeapIndex());
+  }
+  elt->SetHeapIndex(-1);
+}
+
+void CSNMPMessageQueue::HeapUpdate(CSNMPMessageQueueElt *elt)
+{
+  HeapSiftDown(elt->GetHeapIndex());
+  HeapSiftUp(elt->GetHeapIndex());
+}
+
+void CSNMPMessageQueue::AddSocketRef(const SnmpSocket socket)
+{
+  for (int i = 0; i < m_socketCount; i++)
+    if (m_sockets[i].socket == socket)
+    {
+      m_sockets[i].count++;
+      return;
+    }
+
+  if (m_socketCount >= m_socketCapacity)
+  {
+    int newCapacity = m_socketCapacity ? 2 * m_socketCapacity : 2;
+    SocketRef *newSockets = new SocketRef[newCapacity];
+    for (int j = 0; j < m_socketCount; j++)
+      newSockets[j] = m_sockets[j];
+    delete [] m_sockets;
+    m_sockets = newSockets;
+    m_socketCapacity = newCapacity;
+  }
+  m_sockets[m_socketCount].socket = socket;
+  m_sockets[m_socketCount].count = 1;
+  m_socketCount++;
+}
+
+void CSNMPMessageQueue::RemoveSocketRef(const SnmpSocket socket)
+{
+  for (int i = 0; i < m_socketCount; i++)
+    if (m_sockets[i].socket == socket)
+    {
+      if (--m_sockets[i].count == 0)
+        m_sockets[i] = m_sockets[--m_socketCount];
+      return;
+    }
+}
+
+void CSNMPMessageQueue::RemoveElt(CSNMPMessageQueueElt *elt)
+{
+  SnmpSocket sock = elt->GetMessage()->GetSocket();
+
+  HashRemove(elt);
+  HeapRemove(elt);
+  RemoveSocketRef(sock);
+  delete elt;
+  m_msgCount--;
+  UnwatchSocket(sock);
+}
+
 CSNMPMessageQueue::CSNMPMessageQueue(EventListHolder *holder, Snmp *session)
-  : m_head(0, 0, 0), m_msgCount(0), my_holder(holder), m_snmpSession(session)
+  : m_head(0, 0, 0), m_msgCount(0), my_holder(holder), m_snmpSession(session),
+    m_hashSize(MSGQUEUE_INITIAL_HASH_SIZE), m_heap(0), m_heapSize(0),
+    m_heapCapacity(0), m_sockets(0), m_socketCount(0), m_socketCapacity(0)
 {
+  m_hashTable = new CSNMPMessageQueueElt*[m_hashSize];
+  memset(m_hashTable, 0, m_hashSize * sizeof(CSNMPMessageQueueElt*));
 }
 
 CSNMPMessageQueue::~CSNMPMessageQueue()
@@ -304,9 +547,13 @@ CSNMPMessageQueue::~CSNMPMessageQueue()
       lock();
     }
     else
-      delete leftOver;
+      RemoveElt(leftOver);
   }
   unlock();
+
+  delete [] m_hashTable;
+  delete [] m_heap;
+  delete [] m_sockets;
 }
 
 CSNMPMessage * CSNMPMessageQueue::AddEntry(unsigned long id,
@@ -331,13 +578,20 @@ CSNMPMessage * CSNMPMessageQueue::AddEntry(unsigned long id,
                                           rawPdu, rawPduLen, address,
                                           callBack, callData);
 
+  // watch the socket before the message can be removed by another thread
+  WatchSocket(socket);
+
   lock();
     /*---------------------------------------------------------*/
     /* Insert entry at head of list, done automagically by the */
-    /* constructor function, so don't use the return value.    */
+    /* constructor function.                                   */
     /*---------------------------------------------------------*/
-  (void) new CSNMPMessageQueueElt(newMsg, m_head.GetNext(), &m_head);
+  CSNMPMessageQueueElt *newElt =
+    new CSNMPMessageQueueElt(newMsg, m_head.GetNext(), &m_head);
   ++m_msgCount;
+  HashInsert(newElt);
+  HeapInsert(newElt);
+  AddSocketRef(socket);
   int count = m_msgCount;
   unlock();
   
@@ -353,55 +607,32 @@ CSNMPMessage * CSNMPMessageQueue::AddEntry(unsigned long id,
 
 CSNMPMessage *CSNMPMessageQueue::GetEntry(const unsigned long uniqueId)
 {
-  CSNMPMessageQueueElt *msgEltPtr = m_head.GetNext();
-  CSNMPMessage *returnVal = NULL;
+  CSNMPMessageQueueElt *msgEltPtr = FindElt(uniqueId);
 
-  while (msgEltPtr)
-  {
-    if ((returnVal = msgEltPtr->TestId(uniqueId)))
-      return returnVal;
-    msgEltPtr = msgEltPtr->GetNext();
-  }
-  return 0;
+  return msgEltPtr ? msgEltPtr->GetMessage() : 0;
 }
 
 int CSNMPMessageQueue::DeleteEntry(const unsigned long uniqueId)
 {
-  bool loopAgain;
-  do
-  {
-    loopAgain = false;
-    CSNMPMessageQueueElt *msgEltPtr = m_head.GetNext();
+  CSNMPMessageQueueElt *msgEltPtr;
 
-    while (msgEltPtr)
+  while ((msgEltPtr = FindElt(uniqueId)))
+  {
+    if (msgEltPtr->GetMessage()->IsLocked())
     {
-      if (msgEltPtr->TestId(uniqueId))
-      {
-        if (msgEltPtr->GetMessage())
-        {
-          if (msgEltPtr->GetMessage()->IsLocked())
-          {
-            unlock();
-            // TODO: should we sleep here?
-            lock();
-            loopAgain = true;
-          }
-        }
-
-        if (!loopAgain)
-        {
-          delete msgEltPtr;
-          m_msgCount--;
-          LOG_BEGIN(loggerModuleName, DEBUG_LOG | 10);
-          LOG("MsgQueue: Removed entry (req id)");
-          LOG(uniqueId);
-          LOG_END;
-          return SNMP_CLASS_SUCCESS;
-        }
-      }
-      msgEltPtr = msgEltPtr->GetNext();
+      unlock();
+      // TODO: should we sleep here?
+      lock();
+      continue;
     }
-  } while (loopAgain);
+
+    RemoveElt(msgEltPtr);
+    LOG_BEGIN(loggerModuleName, DEBUG_LOG | 10);
+    LOG("MsgQueue: Removed entry (req id)");
+    LOG(uniqueId);
+    LOG_END;
+    return SNMP_CLASS_SUCCESS;
+  }
   return SNMP_CLASS_INVALID_REQID;
 }
 
@@ -429,7 +660,7 @@ void CSNMPMessageQueue::DeleteSocketEntry(const SnmpSocket socket)
         CSNMPMessageQueueElt *tmp_msgEltPtr = msgEltPtr;
         msgEltPtr = tmp_msgEltPtr->GetNext();
         // delete the entry
-        delete tmp_msgEltPtr;
+        RemoveElt(tmp_msgEltPtr);
       }
     }
     else
@@ -440,28 +671,10 @@ void CSNMPMessageQueue::DeleteSocketEntry(const SnmpSocket socket)
 
 CSNMPMessage * CSNMPMessageQueue::GetNextTimeoutEntry()
 {
-  CSNMPMessageQueueElt *msgEltPtr = m_head.GetNext();
-  msec bestTime;
-  msec sendTime(bestTime);
-  CSNMPMessage *msg;
-  CSNMPMessage *bestmsg = NULL;
-
-  if (msgEltPtr) {
-    bestmsg = msgEltPtr->GetMessage();
-    bestmsg->GetSendTime(bestTime);
-  }
-
-  // This would be much simpler if the queue was an ordered list!
-  while (msgEltPtr){
-    msg = msgEltPtr->GetMessage();
-    msg->GetSendTime(sendTime);
-    if (bestTime  > sendTime) {
-      bestTime = sendTime;
-      bestmsg = msg;
-    }
-    msgEltPtr = msgEltPtr->GetNext();
-  }
-  return bestmsg;
+  // the root of the heap has the earliest send time
+  if (m_heapSize == 0)
+    return 0;
+  return m_heap[0]->GetMessage();
 }
 
 int CSNMPMessageQueue::GetNextTimeout(msec &sendTime)
@@ -480,67 +693,22 @@ int CSNMPMessageQueue::GetFdCount()
 {
   SnmpSynchronize _synchronize(*this); // instead of REENTRANT()
 
-  CSNMPMessageQueueElt *msgEltPtr = m_head.GetNext();
-
-  if (!msgEltPtr) return 0;
-
-#ifndef SNMP_PP_IPv6
-  // we have at least one message in the queue and Snmp class
-  // can only have one socket, so
-  return 1;
-#else
-  // we can have max 2 sockets
-  SnmpSocket firstSocket = msgEltPtr->GetMessage()->GetSocket();
-
-  msgEltPtr = msgEltPtr->GetNext();
-
-  while (msgEltPtr)
-  {
-      if (msgEltPtr->GetMessage()->GetSocket() != firstSocket)
-          return 2;
-      msgEltPtr = msgEltPtr->GetNext();
-  }
-  return 1;
-#endif
+  return m_socketCount;
 }
 
 bool CSNMPMessageQueue::GetFdArray(struct pollfd *readfds, int &remaining)
 {
   SnmpSynchronize _synchronize(*this); // instead of REENTRANT()
 
-  CSNMPMessageQueueElt *msgEltPtr = m_head.GetNext();
-  if (!msgEltPtr) return true;
-
-  if (remaining <= 0) return false;
-
-  SnmpSocket firstSocket = msgEltPtr->GetMessage()->GetSocket();
-  readfds[0].fd = firstSocket;
-  readfds[0].events = POLLIN;
-  remaining--;
-
-#ifndef SNMP_PP_IPv6
-  // we have at least one message in the queue and Snmp class
-  // can only have one socket, so we are done
-  return true;
-#else
-  // we can have max 2 sockets
-  msgEltPtr = msgEltPtr->GetNext();
-
-  while (msgEltPtr)
+  for (int i = 0; i < m_socketCount; i++)
   {
-    if (msgEltPtr->GetMessage()->GetSocket() != firstSocket)
-    {
-      if (remaining <= 0) return false;
-      readfds[1].fd = msgEltPtr->GetMessage()->GetSocket();
-      readfds[1].events = POLLIN;
-      remaining--;
+    if (remaining <= 0) return false;
 
-      return true;
-    }
-    msgEltPtr = msgEltPtr->GetNext();
+    readfds[i].fd = m_sockets[i].socket;
+    readfds[i].events = POLLIN;
+    remaining--;
   }
   return true;
-#endif
 }
 
 int CSNMPMessageQueue::HandleEvents(const struct pollfd *readfds,
@@ -549,100 +717,7 @@ int CSNMPMessageQueue::HandleEvents(const struct pollfd *readfds,
   for (int i=0; i < fds ; i++)
   {
     if (readfds[i].revents & POLLIN)
-    {
-      UdpAddress fromaddress;
-      Pdu tmppdu;
-      int status;
-      int recv_status;
-      OctetStr engine_id;
-
-      tmppdu.set_request_id(0);
-
-      // get the response and put it into a Pdu
-      recv_status = receive_snmp_response(readfds[i].fd, *m_snmpSession,
-                                          tmppdu, fromaddress, engine_id);
-
-      unsigned long temp_req_id = tmppdu.get_request_id();
-      if (!temp_req_id)
-        continue;
-
-      CSNMPMessage *msg = 0;
-      bool redoGetEntry;
-      do
-      {
-	redoGetEntry = false;
-        lock();
-        // find the corresponding msg in the message queue
-        msg = GetEntry(temp_req_id);
-        if (msg && msg->IsLocked())
-        {
-          unlock();
-          // TODO: Should we sleep here?
-          redoGetEntry = true;
-        }
-      } while (redoGetEntry);
-
-      if (!msg)
-      {
-        unlock();
-        LOG_BEGIN(loggerModuleName, INFO_LOG | 7);
-        LOG("MsgQueue: Ignore received message without outstanding request (req id)");
-        LOG(tmppdu.get_request_id());
-        LOG_END;
-        // the sent message is gone! probably was canceled, ignore it
-        continue;
-      }
-
-      // save pdu back into the message
-      status = msg->SetPdu(recv_status, tmppdu, fromaddress);
-
-      if (status)
-      {
-        // received pdu does not match
-        // @todo if version is SNMPv3 we must return a report
-        //       unknown pdu handler!
-        unlock();
-        continue;
-      }
-
-#ifdef _SNMPv3
-      if (engine_id.len() > 0)
-      {
-        SnmpTarget *target = msg->GetTarget();
-        if ((target->get_type() == SnmpTarget::type_utarget) &&
-            (target->get_version() == version3))
-        {
-          UdpAddress addr = target->get_address();
-
-	    LOG_BEGIN(loggerModuleName, DEBUG_LOG | 14);
-          LOG("MsgQueue: Adding engine id to table (addr) (id)");
-          LOG(addr.get_printable());
-          LOG(engine_id.get_printable());
-          LOG_END;
-
-          v3MP::I->add_to_engine_id_table(engine_id,
-                                          (char*)addr.IpAddress::get_printable(),
-                                          addr.get_port());
-        }
-      }
-#endif
-
-      // Do the callback
-      msg->SetLocked(true);
-      unlock();
-      status = msg->Callback(SNMP_CLASS_ASYNC_RESPONSE);
-      lock();
-      msg->SetLocked(false);
-
-      if (!status)
-      {
-        // this is an asynch response and the callback is done.
-        // no need to keep this message around;
-        // Dequeue the message
-        DeleteEntry(temp_req_id);
-      }
-      unlock();
-    }
+      HandleSocketEvents(readfds[i].fd);
   }
   return SNMP_CLASS_SUCCESS;
 }
@@ -653,15 +728,14 @@ void CSNMPMessageQueue::GetFdSets(int &maxfds, fd_set &readfds,
                                   fd_set &, fd_set &)
 {
   SnmpSynchronize _synchronize(*this); // REENTRANT
-  CSNMPMessageQueueElt *msgEltPtr = m_head.GetNext();
   SnmpSocket sock;
 
-  while (msgEltPtr){
-    sock = msgEltPtr->GetMessage()->GetSocket();
+  for (int i = 0; i < m_socketCount; i++)
+  {
+    sock = m_sockets[i].socket;
     FD_SET(sock, &readfds);
     if (maxfds < SAFE_INT_CAST(sock+1))
       maxfds = SAFE_INT_CAST(sock+1);
-    msgEltPtr = msgEltPtr->GetNext();
   }
 }
 
@@ -683,114 +757,161 @@ int CSNMPMessageQueue::HandleEvents(const int maxfds,
   {
     if ((FD_ISSET(fd, &snmp_readfds)) &&
         (FD_ISSET(fd, (fd_set*)&readfds)))
-    {
-      UdpAddress fromaddress;
-      Pdu tmppdu;
-      int status;
-      int recv_status;
-      OctetStr engine_id;
+      HandleSocketEvents(fd);
+  } // for all sockets
+  return SNMP_CLASS_SUCCESS;
+}
 
-      tmppdu.set_request_id(0);
+#endif // HAVE_POLL_SYSCALL
 
-      // get the response and put it into a Pdu
-      recv_status = receive_snmp_response(fd, *m_snmpSession,
-                                          tmppdu, fromaddress, engine_id);
+int CSNMPMessageQueue::HandleSocketEvents(const SnmpSocket fd)
+{
+  UdpAddress fromaddress;
+  Pdu tmppdu;
+  int recv_status;
+  OctetStr engine_id;
+  SnmpDatagramBatch *batch = m_snmpSession->get_receive_batch();
 
-      unsigned long temp_req_id = tmppdu.get_request_id();
-      if (!temp_req_id)
-        continue;
+  if (batch)
+  {
+    // read all pending responses with as few system calls as possible
+    int count = batch->receive(fd);
 
-      CSNMPMessage *msg = 0;
-      bool redoGetEntry;
-      do
-      {
-        redoGetEntry = false;
-        lock();
-        // find the corresponding msg in the message queue
-        msg = GetEntry(temp_req_id);
-        if (msg && msg->IsLocked())
-        {
-          unlock();
-          // TODO: Should we sleep here?
-          redoGetEntry = true;
-        }
-      } while (redoGetEntry);
-
-      if (!msg)
+    for (int i = 0; i < count; i++)
+    {
+      Pdu batchpdu;
+      OctetStr batch_engine_id;
+
+      if (batch->get_length(i) > batch->get_max_length())
       {
-        unlock();
-        LOG_BEGIN(loggerModuleName, INFO_LOG | 7);
-        LOG("MsgQueue: Ignore received message without outstanding request (req id)");
-        LOG(tmppdu.get_request_id());
+        LOG_BEGIN(loggerModuleName, WARNING_LOG | 1);
+        LOG("MsgQueue: Received message is ignored (packet too long)");
         LOG_END;
-        // the sent message is gone! probably was canceled, ignore it
         continue;
       }
+      if (!batch->get_address(i, fromaddress))
+        continue;
+
+      batchpdu.set_request_id(0);
+      recv_status = process_snmp_response(batch->get_data(i),
+                                          batch->get_length(i),
+                                          *m_snmpSession, batchpdu,
+                                          fromaddress, batch_engine_id);
+      HandleResponse(recv_status, batchpdu, fromaddress, batch_engine_id);
+    }
+    batch->clear();
+    return SNMP_CLASS_SUCCESS;
+  }
 
-      // save pdu back into the message
-      status = msg->SetPdu(recv_status, tmppdu, fromaddress);
+  tmppdu.set_request_id(0);
 
-      if (status)
-      {
-        // received pdu does not match
-        // @todo if version is SNMPv3 we must return a report
-        //       unknown pdu handler!
-        unlock();
-        continue;
-      }
+  // get the response and put it into a Pdu
+  recv_status = receive_snmp_response(fd, *m_snmpSession,
+                                      tmppdu, fromaddress, engine_id);
+
+  return HandleResponse(recv_status, tmppdu, fromaddress, engine_id);
+}
+
+int CSNMPMessageQueue::HandleResponse(const int recv_status, Pdu &tmppdu,
+                                      const UdpAddress &fromaddress,
+                                      const OctetStr &engine_id)
+{
+  int status;
+
+  unsigned long temp_req_id = tmppdu.get_request_id();
+  if (!temp_req_id)
+    return SNMP_CLASS_SUCCESS;
+
+  CSNMPMessage *msg = 0;
+  bool redoGetEntry;
+  do
+  {
+    redoGetEntry = false;
+    lock();
+    // find the corresponding msg in the message queue
+    msg = GetEntry(temp_req_id);
+    if (msg && msg->IsLocked())
+    {
+      unlock();
+      // TODO: Should we sleep here?
+      redoGetEntry = true;
+    }
+  } while (redoGetEntry);
+
+  if (!msg)
+  {
+    unlock();
+    LOG_BEGIN(loggerModuleName, INFO_LOG | 7);
+    LOG("MsgQueue: Ignore received message without outstanding request (req id)");
+    LOG(tmppdu.get_request_id());
+    LOG_END;
+    // the sent message is gone! probably was canceled, ignore it
+    return SNMP_CLASS_SUCCESS;
+  }
+
+  // save pdu back into the message
+  status = msg->SetPdu(recv_status, tmppdu, fromaddress);
+
+  if (status)
+  {
+    // received pdu does not match
+    // @todo if version is SNMPv3 we must return a report
+    //       unknown pdu handler!
+    unlock();
+    return SNMP_CLASS_SUCCESS;
+  }
 
 #ifdef _SNMPv3
-      if (engine_id.len() > 0)
-      {
-        SnmpTarget *target = msg->GetTarget();
-        if ((target->get_type() == SnmpTarget::type_utarget) &&
-            (target->get_version() == version3))
-        {
-          UdpAddress addr = target->get_address();
-
-		   LOG_BEGIN(loggerModuleName, DEBUG_LOG | 14);
-          LOG("MsgQueue: Adding engine id to table (addr) (id)");
-          LOG(addr.get_printable());
-          LOG(engine_id.get_printable());
-          LOG_END;
-
-          v3MP::I->add_to_engine_id_table(engine_id,
-                                          (char*)addr.IpAddress::get_printable(),
-                                          addr.get_port());
-        }
-      }
+  if (engine_id.len() > 0)
+  {
+    SnmpTarget *target = msg->GetTarget();
+    if ((target->get_type() == SnmpTarget::type_utarget) &&
+        (target->get_version() == version3))
+    {
+      UdpAddress addr = target->get_address();
+
+      LOG_BEGIN(loggerModuleName, DEBUG_LOG | 14);
+      LOG("MsgQueue: Adding engine id to table (addr) (id)");
+      LOG(addr.get_printable());
+      LOG(engine_id.get_printable());
+      LOG_END;
+
+      v3MP::I->add_to_engine_id_table(engine_id,
+                                      (char*)addr.IpAddress::get_printable(),
+                                      addr.get_port());
+    }
+  }
 #endif
 
-      // Do the callback
-      msg->SetLocked(true);
-      unlock();
-      status = msg->Callback(SNMP_CLASS_ASYNC_RESPONSE);
-      lock();
-      msg->SetLocked(false);
+  // Do the callback
+  msg->SetLocked(true);
+  unlock();
+  status = msg->Callback(SNMP_CLASS_ASYNC_RESPONSE);
+  lock();
+  msg->SetLocked(false);
 
-      if (!status)
-      {
-        // this is an asynch response and the callback is done.
-        // no need to keep this message around;
-        // Dequeue the message
-        DeleteEntry(temp_req_id);
-      }
-      unlock();
-    } // if socket has data
-  } // for all sockets
+  if (!status)
+  {
+    // this is an asynch response and the callback is done.
+    // no need to keep this message around;
+    // Dequeue the message
+    DeleteEntry(temp_req_id);
+  }
+  unlock();
   return SNMP_CLASS_SUCCESS;
 }
 
-#endif // HAVE_POLL_SYSCALL
-
 int CSNMPMessageQueue::DoRetries(const msec &now)
 {
+  CSNMPMessageQueueElt *msgElt;
   CSNMPMessage *msg;
   msec sendTime(0, 0);
   int status = SNMP_CLASS_SUCCESS;
   lock();
-  while ((msg = GetNextTimeoutEntry()))
+  while (m_heapSize > 0)
   {
+    msgElt = m_heap[0];
+    msg = msgElt->GetMessage();
     msg->GetSendTime(sendTime);
 
     if (sendTime > now)
@@ -808,6 +929,8 @@ int CSNMPMessageQueue::DoRetries(const msec &now)
     status = msg->ResendMessage();
     lock();
     msg->SetLocked(false);
+    // ResendMessage() has set a new send time
+    HeapUpdate(msgElt);
     if (status != 0)
     {
       if (status == SNMP_CLASS_TIMEOUT)
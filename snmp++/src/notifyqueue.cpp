@@ -211,14 +211,14 @@ int CNotifyEvent::notify_filter(const Oid &trapid, SnmpTarget &target) const
 
   // figure out how many trapids, handle empty case as all trapids
   if ((notify_ids) && ((trapid_count = notify_ids->size()))) {
-    Oid tmpoid;
+    Oid *tmpoid = 0;
     has_trapid = true;
     // loop through all trapids in the collection
     for (int y=0; y < trapid_count; y++)       // for all trapids
       {
       if (notify_ids->get_element(tmpoid, y))
         continue;
-      if (trapid == tmpoid) {
+      if (trapid == *tmpoid) {
         trapid_matches = true;
         break;
       }
@@ -554,6 +554,9 @@ int CNotifyEventQueue::AddEntry(Snmp *snmp,
       return SNMP_CLASS_TL_UNSUPPORTED;
 #endif
     } // not is_v4_address
+#ifdef HAVE_EPOLL_SYSCALL
+    my_holder->AddFd(m_notify_fd, this);
+#endif
   }
 
   CNotifyEvent *newEvent = new CNotifyEvent(snmp, trapids, targets);
@@ -611,6 +614,9 @@ void CNotifyEventQueue::DeleteEntry(Snmp *snmp)
     {
       debugprintf(3, "Closing notifications port %s, fd %d.",
                   m_notify_addr.get_printable(), m_notify_fd);
+#ifdef HAVE_EPOLL_SYSCALL
+      my_holder->RemoveFd(m_notify_fd);
+#endif
       close(m_notify_fd);
       m_notify_fd = INVALID_SOCKET;
     }
@@ -755,6 +761,46 @@ int CNotifyEventQueue::HandleEvents(const int /*maxfds*/,
 
 #endif // HAVE_POLL_SYSCALL
 
+#ifdef HAVE_EPOLL_SYSCALL
+
+int CNotifyEventQueue::HandleSocketEvents(const SnmpSocket fd)
+{
+  SnmpSynchronize _synchronize(*this); // REENTRANT
+  int status = SNMP_CLASS_SUCCESS;
+
+  if ((m_notify_fd == INVALID_SOCKET) || (fd != m_notify_fd))
+    return status;
+
+  Pdu pdu;
+  SnmpTarget *target = NULL;
+
+  // pull the notifiaction off the socket
+  status = receive_snmp_notification(m_notify_fd, *m_snmpSession,
+                                     pdu, &target);
+
+  if ((SNMP_CLASS_SUCCESS == status) ||
+      (SNMP_CLASS_TL_FAILED == status))
+  {
+    // On failure target will be NULL
+    if (!target)
+      target = new SnmpTarget();
+
+    CNotifyEventQueueElt *notifyEltPtr = m_head.GetNext();
+    while (notifyEltPtr)
+    {
+      notifyEltPtr->GetNotifyEvent()->Callback(*target, pdu,
+                                               m_notify_fd, status);
+      notifyEltPtr = notifyEltPtr->GetNext();
+    } // for each snmp object
+  }
+  if (target) // receive_snmp_notification calls new
+    delete target;
+
+  return status;
+}
+
+#endif // HAVE_EPOLL_SYSCALL
+
 #ifdef SNMP_PP_NAMESPACE
 } // end of namespace Snmp_pp
 #endif
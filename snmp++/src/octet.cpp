@@ -161,6 +161,23 @@ OctetStr::OctetStr(const OctetStr &octet)
     validity = false;
 }
 
+#ifdef SNMP_PP_RVALUE_REFS
+//============[ constructor taking over another octet object ]========
+OctetStr::OctetStr(OctetStr &&octet)
+  : output_buffer(0), output_buffer_len(0), m_changed(true),
+    validity(octet.validity)
+{
+  smival.syntax = sNMP_SYNTAX_OCTETS;
+  smival.value.string.ptr = octet.smival.value.string.ptr;
+  smival.value.string.len = octet.smival.value.string.len;
+
+  octet.smival.value.string.ptr = 0;
+  octet.smival.value.string.len = 0;
+  octet.m_changed = true;
+  octet.validity = true;
+}
+#endif
+
 //=============[ destructor ]=========================================
 OctetStr::~OctetStr()
 {
@@ -177,6 +194,18 @@ OctetStr::~OctetStr()
 //============[ set the data on an already constructed Octet ]============
 void OctetStr::set_data(const unsigned char *str, unsigned long len)
 {
+  m_changed = true;
+
+  // reuse the current buffer if the new value fits into it,
+  // str may point into this buffer
+  if (str && len && (len <= smival.value.string.len))
+  {
+    memmove(smival.value.string.ptr, str, len);
+    smival.value.string.len = len;
+    validity = true;
+    return;
+  }
+
   // free up already used space
   if (smival.value.string.ptr)
   {
@@ -184,7 +213,6 @@ void OctetStr::set_data(const unsigned char *str, unsigned long len)
     smival.value.string.ptr = 0;
   }
   smival.value.string.len = 0;
-  m_changed = true;
 
   // check for zero len
   if (!str || !len)
@@ -225,6 +253,28 @@ OctetStr& OctetStr::operator=(const OctetStr &octet)
   return *this;		       // return self reference
 }
 
+#ifdef SNMP_PP_RVALUE_REFS
+//=============[ move another octet object ]==========================
+OctetStr& OctetStr::operator=(OctetStr &&octet)
+{
+  if (this == &octet)  return *this; // protect against assignment from self
+
+  if (!octet.validity) return *this; // don't assign from invalid objs
+
+  if (smival.value.string.ptr) delete [] smival.value.string.ptr;
+  smival.value.string.ptr = octet.smival.value.string.ptr;
+  smival.value.string.len = octet.smival.value.string.len;
+  m_changed = true;
+  validity = true;
+
+  octet.smival.value.string.ptr = 0;
+  octet.smival.value.string.len = 0;
+  octet.m_changed = true;
+
+  return *this;		       // return self reference
+}
+#endif
+
 //==============[ equivlence operator overloaded ]====================
 int operator==(const OctetStr &lhs, const OctetStr &rhs)
 {
@@ -310,39 +310,43 @@ bool operator>=(const Oid &x,const char *dotted_oid_string)
 void Oid::set_data(const unsigned long *raw_oid,
                    const unsigned int oid_len)
 {
-  if (smival.value.oid.len < oid_len)
+  if (oid_len == 0)
   {
-    delete_oid_ptr();
+    smival.value.oid.len = 0;
+    m_changed = true;
+    return;
+  }
 
-    smival.value.oid.ptr = (SmiLPUINT32) new unsigned long[oid_len];
-    if (!smival.value.oid.ptr) return;
+  SmiLPUINT32 new_oid = get_oid_buffer(oid_len);
+  if (!new_oid)
+  {
+    delete_oid_ptr();
+    return;
   }
-  memcpy((SmiLPBYTE) smival.value.oid.ptr,
-         (SmiLPBYTE) raw_oid,
-         (size_t) (oid_len*sizeof(SmiUINT32)));
-  smival.value.oid.len = oid_len;
-  m_changed = true;
+  // raw_oid may point into the current buffer
+  memmove((SmiLPBYTE) new_oid,
+          (SmiLPBYTE) raw_oid,
+          (size_t) (oid_len*sizeof(SmiUINT32)));
+  set_oid_ptr(new_oid, oid_len);
 }
 
 // Set the data from raw form.
 void Oid::set_data(const char *str, const unsigned int str_len)
 {
-  if (smival.value.oid.len < str_len)
+  if ((!str) || (str_len == 0))
+    return;
+
+  SmiLPUINT32 new_oid = get_oid_buffer(str_len);
+  if (!new_oid)
   {
     delete_oid_ptr();
-
-    smival.value.oid.ptr = (SmiLPUINT32) new unsigned long[str_len];
-    if (!smival.value.oid.ptr) return;
-  }
-
-  if ((!str) || (str_len == 0))
     return;
+  }
 
   for (unsigned int i=0; i<str_len; i++)
-    smival.value.oid.ptr[i] = str[i];
+    new_oid[i] = str[i];
 
-  smival.value.oid.len = str_len;
-  m_changed = true;
+  set_oid_ptr(new_oid, str_len);
 }
 
 #if 0
@@ -560,8 +564,12 @@ int Oid::StrToOid(const char *str, SmiLPOID dstOid) const
     }
   }
 
-  // get some space for the real oid
-  dstOid->ptr = (SmiLPUINT32) new unsigned long[index];
+  // get some space for the real oid, short oids of this object are
+  // stored in its inline buffer
+  if (dstOid == &smival.value.oid)
+    dstOid->ptr = PP_CONST_CAST(Oid*, this)->get_oid_buffer(index);
+  else
+    dstOid->ptr = (SmiLPUINT32) new unsigned long[index];
   // return if can't get the mem needed
   if(dstOid->ptr == 0)
   {
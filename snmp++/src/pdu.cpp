@@ -69,8 +69,9 @@ namespace Snmp_pp {
 
 //=====================[ constructor no args ]=========================
 Pdu::Pdu()
-  : vbs(0), vbs_size(0), vb_count(0), error_status(0), error_index(0),
-    validity(true), request_id(0), pdu_type(0), notify_timestamp(0),
+  : vbs(0), vbs_size(0), vb_count(0),
+    vb_arena(0), vb_arena_size(0), vb_arena_used(0),
+    error_status(0), error_index(0), validity(true), request_id(0), pdu_type(0), notify_timestamp(0),
     v1_trap_address_set(false)
 #ifdef _SNMPv3
     , security_level(SNMP_SECURITY_LEVEL_NOAUTH_NOPRIV),
@@ -81,8 +82,9 @@ Pdu::Pdu()
 
 //=====================[ constructor with vbs and count ]==============
 Pdu::Pdu(Vb* pvbs, const int pvb_count)
-  : vbs(0), vbs_size(0), vb_count(0), error_status(0), error_index(0),
-    validity(true), request_id(0), pdu_type(0), notify_timestamp(0),
+  : vbs(0), vbs_size(0), vb_count(0),
+    vb_arena(0), vb_arena_size(0), vb_arena_used(0),
+    error_status(0), error_index(0), validity(true), request_id(0), pdu_type(0), notify_timestamp(0),
     v1_trap_address_set(false)
 #ifdef _SNMPv3
     , security_level(SNMP_SECURITY_LEVEL_NOAUTH_NOPRIV),
@@ -91,12 +93,8 @@ Pdu::Pdu(Vb* pvbs, const int pvb_count)
 {
   if (pvb_count == 0) return;    // zero is ok
 
-  vbs = new Vb*[pvb_count];
-  if (vbs)
-    vbs_size = pvb_count;
-  else
+  if (!reserve(pvb_count))
   {
-    vbs_size = 0;
     validity = false;
     return;
   }
@@ -105,19 +103,20 @@ Pdu::Pdu(Vb* pvbs, const int pvb_count)
   for (int z = 0; z < pvb_count; ++z)
   {
     if (pvbs[z].valid())
-      vbs[z] = new Vb(pvbs[z]);
+      vbs[z] = alloc_vb(pvbs[z]);
     else
       vbs[z] = 0;
 
     if ((vbs[z]) && !vbs[z]->valid())
     {
-      delete vbs[z];
+      release_vb(vbs[z]);
       vbs[z] = 0;
     }
 
     if (vbs[z] == 0)     // check for new fail
     {
-      for (int y = 0; y < z; ++y) delete vbs[y]; // free vbs
+      vb_count = z;
+      free_vbs();
       validity = false;
       return;
     }
@@ -129,11 +128,7 @@ Pdu::Pdu(Vb* pvbs, const int pvb_count)
 //=====================[ destructor ]====================================
 Pdu::~Pdu()
 {
-  for (int z = 0; z < vb_count; ++z)
-  {
-    delete vbs[z];
-    vbs[z] = 0;
-  }
+  free_vbs();
 
   if (vbs)
   {
@@ -141,8 +136,49 @@ Pdu::~Pdu()
     vbs = 0;
     vbs_size = 0;
   }
+
+  // all vbs within the arena are freed in one go
+  if (vb_arena)
+  {
+    delete [] vb_arena;
+    vb_arena = 0;
+    vb_arena_size = 0;
+  }
 }
 
+#ifdef SNMP_PP_RVALUE_REFS
+//=====================[ constructor taking over another Pdu ]===========
+Pdu::Pdu(Pdu &&pdu)
+  : vbs(pdu.vbs), vbs_size(pdu.vbs_size), vb_count(pdu.vb_count),
+    vb_arena(pdu.vb_arena), vb_arena_size(pdu.vb_arena_size),
+    vb_arena_used(pdu.vb_arena_used),
+    error_status(pdu.error_status), error_index(pdu.error_index),
+    validity(true), request_id(pdu.request_id), pdu_type(pdu.pdu_type),
+    notify_timestamp(pdu.notify_timestamp),
+    notify_id(std::move(pdu.notify_id)),
+    notify_enterprise(std::move(pdu.notify_enterprise)),
+    v1_trap_address_set(pdu.v1_trap_address_set)
+#ifdef _SNMPv3
+    , security_level(pdu.security_level),
+    message_id(pdu.message_id), maxsize_scopedpdu(pdu.maxsize_scopedpdu),
+    context_name(std::move(pdu.context_name)),
+    context_engine_id(std::move(pdu.context_engine_id))
+#endif
+{
+  if (v1_trap_address_set)
+    v1_trap_address = pdu.v1_trap_address;
+
+  // the vbs now belong to this pdu
+  pdu.vbs = 0;
+  pdu.vbs_size = 0;
+  pdu.vb_count = 0;
+  pdu.vb_arena = 0;
+  pdu.vb_arena_size = 0;
+  pdu.vb_arena_used = 0;
+  pdu.clear();
+}
+#endif
+
 //=====================[ assignment to another Pdu object overloaded ]===
 Pdu& Pdu::operator=(const Pdu &pdu)
 {
@@ -173,28 +209,26 @@ Pdu& Pdu::operator=(const Pdu &pdu)
 
   validity = true;
 
-  // free up old vbs
-  for (int z = 0; z < vb_count; ++z)
+  // free up old vbs that are not needed any more, the others are
+  // reused to avoid allocating new Vb objects
+  int reuse_count = (vb_count < pdu.vb_count) ? vb_count : pdu.vb_count;
+  for (int z = vb_count - 1; z >= reuse_count; --z)
   {
-    delete vbs[z];
+    release_vb(vbs[z]);
     vbs[z] = 0;
   }
-  vb_count = 0;
+  vb_count = reuse_count;
 
   // check for zero case
   if (pdu.vb_count == 0)
     return *this;
 
-  // allocate array
+  // allocate array and block for all vbs
   if (vbs_size < pdu.vb_count)
   {
-    delete [] vbs;
-    vbs = new Vb*[pdu.vb_count];
-    if (vbs)
-      vbs_size = pdu.vb_count;
-    else
+    if (!reserve(pdu.vb_count))
     {
-      vbs_size = 0;
+      free_vbs();
       validity = false;
       return *this;
     }
@@ -203,21 +237,17 @@ Pdu& Pdu::operator=(const Pdu &pdu)
   // loop through and fill em up
   for (int y = 0; y < pdu.vb_count; ++y)
   {
-    vbs[y] = new Vb(*(pdu.vbs[y]));
-
-    if ((vbs[y]) && !vbs[y]->valid())
+    if (y < reuse_count)
+      *vbs[y] = *(pdu.vbs[y]);
+    else
     {
-      delete vbs[y];
-      vbs[y] = 0;
+      vbs[y] = alloc_vb(*(pdu.vbs[y]));
+      if (vbs[y]) vb_count = y + 1;
     }
 
-    if (!vbs[y])
+    if (!vbs[y] || !vbs[y]->valid())
     {
-      for (int x = 0; x < y; ++x)
-      {
-        delete vbs[x]; // free vbs
-        vbs[x] = 0;
-      }
+      free_vbs();
       validity = false;
       return *this;
     }
@@ -227,6 +257,62 @@ Pdu& Pdu::operator=(const Pdu &pdu)
   return *this;
 }
 
+#ifdef SNMP_PP_RVALUE_REFS
+//=====================[ move another Pdu object ]=======================
+Pdu& Pdu::operator=(Pdu &&pdu)
+{
+  if (this == &pdu) return *this; // check for self assignment
+
+  error_status      = pdu.error_status;
+  error_index       = pdu.error_index;
+  request_id        = pdu.request_id;
+  pdu_type          = pdu.pdu_type;
+  notify_id         = std::move(pdu.notify_id);
+  notify_timestamp  = pdu.notify_timestamp;
+  notify_enterprise = std::move(pdu.notify_enterprise);
+#ifdef _SNMPv3
+  security_level    = pdu.security_level;
+  message_id        = pdu.message_id;
+  context_name      = std::move(pdu.context_name);
+  context_engine_id = std::move(pdu.context_engine_id);
+  maxsize_scopedpdu = pdu.maxsize_scopedpdu;
+#endif
+  if (pdu.v1_trap_address_set)
+  {
+    v1_trap_address = pdu.v1_trap_address;
+    v1_trap_address_set = true;
+  }
+  else
+    v1_trap_address_set = false;
+
+  validity = true;
+
+  // free up old vbs and take over the ones of pdu
+  free_vbs();
+  if (vbs)
+    delete [] vbs;
+  if (vb_arena)
+    delete [] vb_arena;
+
+  vbs           = pdu.vbs;
+  vbs_size      = pdu.vbs_size;
+  vb_count      = pdu.vb_count;
+  vb_arena      = pdu.vb_arena;
+  vb_arena_size = pdu.vb_arena_size;
+  vb_arena_used = pdu.vb_arena_used;
+
+  pdu.vbs = 0;
+  pdu.vbs_size = 0;
+  pdu.vb_count = 0;
+  pdu.vb_arena = 0;
+  pdu.vb_arena_size = 0;
+  pdu.vb_arena_used = 0;
+  pdu.clear();
+
+  return *this;
+}
+#endif
+
 // append operator, appends a variable binding
 Pdu& Pdu::operator+=(const Vb &vb)
 {
@@ -237,7 +323,7 @@ Pdu& Pdu::operator+=(const Vb &vb)
     if (!extend_vbs()) return *this;
   }
 
-  vbs[vb_count] = new Vb(vb);  // add the new one
+  vbs[vb_count] = alloc_vb(vb);  // add the new one
 
   if (vbs[vb_count])   // up the vb count on success
   {
@@ -248,7 +334,7 @@ Pdu& Pdu::operator+=(const Vb &vb)
     }
     else
     {
-      delete vbs[vb_count];
+      release_vb(vbs[vb_count]);
       vbs[vb_count] = 0;
     }
   }
@@ -256,6 +342,29 @@ Pdu& Pdu::operator+=(const Vb &vb)
   return *this;        // return self reference
 }
 
+#ifdef SNMP_PP_RVALUE_REFS
+// append operator, appends a variable binding taking over its value
+Pdu& Pdu::operator+=(Vb &&vb)
+{
+  if (!vb.valid())                return *this; // dont add invalid Vbs
+
+  if (vb_count + 1 > vbs_size)
+  {
+    if (!extend_vbs()) return *this;
+  }
+
+  vbs[vb_count] = alloc_vb(std::move(vb));  // add the new one
+
+  if (vbs[vb_count])   // up the vb count on success
+  {
+    ++vb_count;
+    validity = true;   // set up validity
+  }
+
+  return *this;        // return self reference
+}
+#endif
+
 //=====================[ extract Vbs from Pdu ]==========================
 int Pdu::get_vblist(Vb* pvbs, const int pvb_count) const
 {
@@ -282,8 +391,7 @@ int Pdu::set_vblist(Vb const * pvbs, const int pvb_count)
     return false;
 
   // free up current vbs
-  for (int z = 0; z < vb_count; ++z)  delete vbs[z];
-  vb_count = 0;
+  free_vbs();
 
   // check for zero case
   if (pvb_count == 0)
@@ -295,16 +403,11 @@ int Pdu::set_vblist(Vb const * pvbs, const int pvb_count)
     return false;
   }
 
-  // allocate array
+  // allocate array and block for all vbs
   if (vbs_size < pvb_count)
   {
-    delete [] vbs;
-    vbs = new Vb*[pvb_count];
-    if (vbs)
-      vbs_size = pvb_count;
-    else
+    if (!reserve(pvb_count))
     {
-      vbs_size = 0;
       validity = false;
       return false;
     }
@@ -315,10 +418,10 @@ int Pdu::set_vblist(Vb const * pvbs, const int pvb_count)
   {
     if (pvbs[y].valid())
     {
-      vbs[y] = new Vb(pvbs[y]);
+      vbs[y] = alloc_vb(pvbs[y]);
       if ((vbs[y]) && !vbs[y]->valid())
       {
-	delete vbs[y];
+	release_vb(vbs[y]);
 	vbs[y] = 0;
       }
     }
@@ -328,7 +431,8 @@ int Pdu::set_vblist(Vb const * pvbs, const int pvb_count)
     // check for errors
     if (!vbs[y])
     {
-      for (int x = 0; x < y; ++x) delete vbs[x]; // free vbs
+      vb_count = y;
+      free_vbs();
       validity = false;
       return false;
     }
@@ -366,16 +470,16 @@ int Pdu::set_vb(Vb const &vb, const int index)
   if (!vb.valid())       return false; // don't set invalid vbs
 
   Vb *victim = vbs[index]; // save in case new fails
-  vbs[index] = new Vb(vb);
+  vbs[index] = alloc_vb(vb);
   if (vbs[index])
   {
     if (vbs[index]->valid())
     {
-      delete victim;
+      release_vb(victim);
     }
     else
     {
-      delete vbs[index];
+      release_vb(vbs[index]);
       vbs[index] = victim;
       return false;
     }
@@ -388,6 +492,19 @@ int Pdu::set_vb(Vb const &vb, const int index)
   return true;
 }
 
+#ifdef SNMP_PP_RVALUE_REFS
+//===================[ set a particular vb taking over its value ]=======
+int Pdu::set_vb(Vb &&vb, const int index)
+{
+  if (index < 0)         return false; // can't have an index less than 0
+  if (index >= vb_count) return false; // can't ask for something not there
+  if (!vb.valid())       return false; // don't set invalid vbs
+
+  *vbs[index] = std::move(vb);
+  return true;
+}
+#endif
+
 // trim off the last vb
 int Pdu::trim(const int count)
 {
@@ -400,7 +517,7 @@ int Pdu::trim(const int count)
   {
     if (vb_count > 0)
     {
-      delete vbs[vb_count-1];
+      release_vb(vbs[vb_count-1]);
       vbs[vb_count-1] = 0;
       vb_count--;
     }
@@ -415,7 +532,7 @@ int Pdu::delete_vb(const int p)
   // position has to be in range
   if ((p<0) || (p > vb_count - 1)) return false;
 
-  delete vbs[p];   // safe to remove it
+  release_vb(vbs[p]);   // safe to remove it
 
   for (int z = p; z < vb_count - 1; ++z)
     vbs[z] = vbs[z+1];
@@ -523,6 +640,127 @@ bool Pdu::extend_vbs()
   return true;
 }
 
+// reserve room for count vbs
+bool Pdu::reserve(const int count)
+{
+  if ((count <= vb_arena_size) && (count <= vbs_size))
+    return true;
+
+  return resize_vb_arena(count);
+}
+
+// release unused memory
+bool Pdu::shrink()
+{
+  if ((vb_count == vb_arena_size) && (vb_count == vbs_size))
+    return true;
+
+  return resize_vb_arena(vb_count);
+}
+
+// get a vb object from the block or from the heap
+Vb *Pdu::alloc_vb(const Vb &vb)
+{
+  if (vb_arena_used < vb_arena_size)
+  {
+    Vb *v = &vb_arena[vb_arena_used++];
+    *v = vb;
+    return v;
+  }
+  return new Vb(vb);
+}
+
+#ifdef SNMP_PP_RVALUE_REFS
+// get a vb object from the block or from the heap, taking over vb
+Vb *Pdu::alloc_vb(Vb &&vb)
+{
+  if (vb_arena_used < vb_arena_size)
+  {
+    Vb *v = &vb_arena[vb_arena_used++];
+    *v = std::move(vb);
+    return v;
+  }
+  return new Vb(std::move(vb));
+}
+#endif
+
+// free a vb object returned by alloc_vb()
+void Pdu::release_vb(Vb *vb)
+{
+  if (!vb) return;
+
+  if ((vb >= vb_arena) && (vb < vb_arena + vb_arena_size))
+  {
+    // The object stays in the block until the pdu is cleared, only
+    // its value is freed. The last object handed out can be reused.
+    vb->clear();
+    if (vb == &vb_arena[vb_arena_used - 1])
+      --vb_arena_used;
+  }
+  else
+    delete vb;
+}
+
+// free all vbs
+void Pdu::free_vbs()
+{
+  for (int z = vb_count - 1; z >= 0; --z)
+  {
+    release_vb(vbs[z]);
+    vbs[z] = 0;
+  }
+  vb_count = 0;
+  vb_arena_used = 0;
+}
+
+// move all vbs into a new block
+bool Pdu::resize_vb_arena(const int count)
+{
+  if (count < vb_count) return false;
+
+  Vb **new_vbs = 0;
+  Vb *new_arena = 0;
+
+  if (count > 0)
+  {
+    new_vbs = new Vb*[count];
+    if (!new_vbs) return false;
+
+    new_arena = new Vb[count];
+    if (!new_arena)
+    {
+      delete [] new_vbs;
+      return false;
+    }
+  }
+
+  for (int z = 0; z < vb_count; ++z)
+  {
+#ifdef SNMP_PP_RVALUE_REFS
+    new_arena[z] = std::move(*vbs[z]);
+#else
+    new_arena[z] = *vbs[z];
+#endif
+    new_vbs[z] = &new_arena[z];
+
+    if ((vbs[z] < vb_arena) || (vbs[z] >= vb_arena + vb_arena_size))
+      delete vbs[z];
+  }
+
+  if (vbs)
+    delete [] vbs;
+  if (vb_arena)
+    delete [] vb_arena;
+
+  vbs           = new_vbs;
+  vbs_size      = count;
+  vb_arena      = new_arena;
+  vb_arena_size = count;
+  vb_arena_used = vb_count;
+
+  return true;
+}
+
 // Clear all members of the object
 void Pdu::clear()
 {
@@ -536,8 +774,7 @@ void Pdu::clear()
   v1_trap_address_set = false;
   validity            = true;
 
-  for (int z = 0; z < vb_count; ++z)  delete vbs[z];
-  vb_count = 0;
+  free_vbs();
 
 #ifdef _SNMPv3
   security_level    = SNMP_SECURITY_LEVEL_NOAUTH_NOPRIV;
@@ -0,0 +1,642 @@
+/*_############################################################################
+  _##
+  _##  pduview.cpp
+  _##
+  _##  SNMP++ v3.3
+  _##  -----------------------------------------------
+  _##  Copyright (c) 2001-2013 Jochen Katz, Frank Fock
+  _##
+  _##  This software is based on SNMP++2.6 from Hewlett Packard:
+  _##
+  _##    Copyright (c) 1996
+  _##    Hewlett-Packard Company
+  _##
+  _##  ATTENTION: USE OF THIS SOFTWARE IS SUBJECT TO THE FOLLOWING TERMS.
+  _##  Permission to use, copy, modify, distribute and/or sell this software
+  _##  and/or its documentation is hereby granted without fee. User agrees
+  _##  to display the above copyright notice and this license notice in all
+  _##  copies of the software and any documentation of the software. User
+  _##  agrees to assume all liability for the use of the software;
+  _##  Hewlett-Packard and Jochen Katz make no representations about the
+  _##  suitability of this software for any purpose. It is provided
+  _##  "AS-IS" without warranty of any kind, either express or implied. User
+  _##  hereby grants a royalty-free license to any and all derivatives based
+  _##  upon this software code base.
+  _##
+  _##########################################################################*/
+
+char pduview_cpp_version[]="@(#) SNMP++ $Id$";
+
+#include <libsnmp.h>
+
+#include "snmp_pp/pduview.h"
+#include "snmp_pp/snmpmsg.h"
+#include "snmp_pp/asn1.h"
+#include "snmp_pp/oid_def.h"
+#include "snmp_pp/address.h"
+#include "snmp_pp/integer.h"
+#include "snmp_pp/counter.h"
+#include "snmp_pp/gauge.h"
+#include "snmp_pp/timetick.h"
+#include "snmp_pp/ctr64.h"
+#include "snmp_pp/octet.h"
+#include "snmp_pp/log.h"
+
+#ifdef SNMP_PP_NAMESPACE
+namespace Snmp_pp {
+#endif
+
+static const char *loggerModuleName = "snmp++.pduview";
+
+// sysUpTime.0 and snmpTrapOID.0 of notifications
+static SNMP_PP_OID_LITERAL(sysUpTimeLiteral, SNMP_MSG_OID_SYSUPTIME);
+static SNMP_PP_OID_LITERAL(trapIdLiteral, SNMP_MSG_OID_TRAPID);
+
+//----[ helpers ]------------------------------------------------------
+
+// Parse type and length of an object. On return, length is the length
+// of the contents, which have been checked to fit into the input length.
+static inline const unsigned char *parse_header(const unsigned char *data,
+                                                int *length,
+                                                unsigned char *type)
+{
+  if (*length < 2)
+    return NULL;
+  return asn_parse_header((unsigned char *)data, length, type);
+}
+
+// Check the contents of an encoded oid. Each subidentifier must fit
+// into an oid element and the decoded oid must not have more than
+// max_len subidentifiers.
+static bool check_objid(const unsigned char *data, const int length,
+                        const int max_len)
+{
+  if (length == 0)
+    return true; // decoded as 0.0, like asn_parse_objid() does
+  if (data[length - 1] & ASN_BIT8)
+    return false;
+
+  int count = 1; // the first subidentifier is expanded into two
+  unsigned long subid = 0;
+  for (int i = 0; i < length; ++i)
+  {
+    if (subid > ((unsigned long)MAX_SUBID >> 7))
+      return false;
+    subid = (subid << 7) | (data[i] & ~ASN_BIT8);
+    if (!(data[i] & ASN_BIT8))
+    {
+      ++count;
+      subid = 0;
+    }
+  }
+  return (count <= max_len);
+}
+
+// Check the contents of a value with the given type. The limits are the
+// ones of the asn_parse_xxx() functions that decode the value later.
+static bool check_value(const unsigned char type,
+                        const unsigned char *data, const int length)
+{
+  switch (type)
+  {
+    case ASN_INTEGER:
+      return (length <= (int)sizeof(long));
+
+    case SMI_COUNTER:
+    case SMI_GAUGE:
+    case SMI_TIMETICKS:
+    case SMI_UINTEGER:
+      return (length < 5) || ((length == 5) && (data[0] == 0x00));
+
+    case SMI_COUNTER64:
+      return (length < 9) || ((length == 9) && (data[0] == 0x00));
+
+    case ASN_OBJECT_ID:
+      // get_vb() decodes the value into ASN_MAX_NAME_LEN elements
+      return check_objid(data, length, ASN_MAX_NAME_LEN);
+
+    case ASN_OCTET_STR:
+    case SMI_IPADDRESS:
+    case SMI_OPAQUE:
+    case SMI_NSAP:
+    case SNMP_NOSUCHOBJECT:
+    case SNMP_NOSUCHINSTANCE:
+    case SNMP_ENDOFMIBVIEW:
+    case ASN_NULL:
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+// Decode an encoded oid (type, length and contents) into arcs, which
+// must have room for ASN_MAX_NAME_LEN elements.
+static int decode_objid(const unsigned char *tlv, int tlv_length, oid *arcs)
+{
+  unsigned char type;
+  int len = ASN_MAX_NAME_LEN;
+
+  if (!asn_parse_objid((unsigned char *)tlv, &tlv_length, &type, arcs, &len))
+    return 0;
+  return len;
+}
+
+//----[ VbView ]-------------------------------------------------------
+
+const unsigned char *VbView::parse(const unsigned char *data, int *length)
+{
+  unsigned char type;
+  int seq_length = *length;
+
+  const unsigned char *seq = parse_header(data, &seq_length, &type);
+  if ((seq == NULL) || (type != ASN_SEQ_CON))
+    return NULL;
+  const unsigned char *end = seq + seq_length;
+
+  // the oid
+  int len = seq_length;
+  const unsigned char *cp = parse_header(seq, &len, &type);
+  if ((cp == NULL) || (type != (ASN_UNI_PRIM | ASN_OBJECT_ID)) ||
+      !check_objid(cp, len, ASN_MAX_NAME_LEN))
+  {
+    ASNERROR("VbView: bad oid");
+    return NULL;
+  }
+  const unsigned char *oid_end = cp + len;
+
+  // the value, which has to fill the rest of the sequence
+  len = SAFE_INT_CAST(end - oid_end);
+  cp = parse_header(oid_end, &len, &type);
+  if ((cp == NULL) || (cp + len != end) || !check_value(type, cp, len))
+  {
+    ASNERROR("VbView: bad value");
+    return NULL;
+  }
+
+  oid_tlv = seq;
+  oid_tlv_length = SAFE_INT_CAST(oid_end - seq);
+  value_tlv = oid_end;
+  value_tlv_length = SAFE_INT_CAST(cp + len - oid_end);
+  value_data = cp;
+  value_length = len;
+  value_type = type;
+
+  *length -= SAFE_INT_CAST(end - data);
+  return end;
+}
+
+void VbView::get_oid(Oid &result) const
+{
+  oid arcs[ASN_MAX_NAME_LEN];
+  int len = decode_objid(oid_tlv, oid_tlv_length, arcs);
+
+  result.set_data((unsigned long *)arcs, len);
+}
+
+bool VbView::oid_equals(const Oid &o) const
+{
+  oid arcs[ASN_MAX_NAME_LEN];
+  int len = decode_objid(oid_tlv, oid_tlv_length, arcs);
+
+  if ((unsigned long)len != o.len())
+    return false;
+  for (int i = len - 1; i >= 0; --i) // oids mostly differ at the end
+    if (arcs[i] != o[i])
+      return false;
+  return true;
+}
+
+bool VbView::oid_starts_with(const Oid &prefix) const
+{
+  oid arcs[ASN_MAX_NAME_LEN];
+  int len = decode_objid(oid_tlv, oid_tlv_length, arcs);
+
+  if ((unsigned long)len < prefix.len())
+    return false;
+  for (int i = prefix.len() - 1; i >= 0; --i)
+    if (arcs[i] != prefix[i])
+      return false;
+  return true;
+}
+
+int VbView::get_value(long &value) const
+{
+  if (value_type != sNMP_SYNTAX_INT)
+    return SNMP_CLASS_INVALID;
+
+  unsigned char type;
+  int len = value_tlv_length;
+  value = 0;
+  asn_parse_int((unsigned char *)value_tlv, &len, &type, &value);
+  return SNMP_CLASS_SUCCESS;
+}
+
+int VbView::get_value(unsigned long &value) const
+{
+  if ((value_type != sNMP_SYNTAX_CNTR32) &&
+      (value_type != sNMP_SYNTAX_GAUGE32) &&
+      (value_type != sNMP_SYNTAX_TIMETICKS) &&
+      (value_type != SMI_UINTEGER))
+    return SNMP_CLASS_INVALID;
+
+  unsigned char type;
+  int len = value_tlv_length;
+  value = 0;
+  asn_parse_unsigned_int((unsigned char *)value_tlv, &len, &type, &value);
+  return SNMP_CLASS_SUCCESS;
+}
+
+void VbView::get_vb(Vb &vb) const
+{
+  Oid tmpoid;
+  get_oid(tmpoid);
+  vb.set_oid(tmpoid);
+
+  // keep in sync with the conversion of SNMPv3 PDUs in SnmpMessage::unload()
+  switch (value_type)
+  {
+    case sNMP_SYNTAX_OCTETS:
+      vb.set_value(value_data, value_length);
+      break;
+
+    case sNMP_SYNTAX_OPAQUE:
+      vb.set_value(OpaqueStr(value_data, value_length));
+      break;
+
+    case sNMP_SYNTAX_OID:
+    {
+      oid arcs[ASN_MAX_NAME_LEN];
+      int len = decode_objid(value_tlv, value_tlv_length, arcs);
+
+      tmpoid.set_data((unsigned long *)arcs, len);
+      vb.set_value(tmpoid);
+      break;
+    }
+    case sNMP_SYNTAX_TIMETICKS:
+    {
+      unsigned long value;
+      get_value(value);
+      vb.set_value(TimeTicks(value));
+      break;
+    }
+    case sNMP_SYNTAX_CNTR32:
+    {
+      unsigned long value;
+      get_value(value);
+      vb.set_value(Counter32(value));
+      break;
+    }
+    case sNMP_SYNTAX_GAUGE32:
+    {
+      unsigned long value;
+      get_value(value);
+      vb.set_value(Gauge32(value));
+      break;
+    }
+    case sNMP_SYNTAX_IPADDR:
+    {
+      char buffer[42];
+      buffer[0] = 0; // in case we receive an invalid length IP
+
+      if (value_length == 16)
+        sprintf(buffer, "%02x%02x:%02x%02x:%02x%02x:%02x%02x:"
+                "%02x%02x:%02x%02x:%02x%02x:%02x%02x",
+                value_data[ 0], value_data[ 1], value_data[ 2],
+                value_data[ 3], value_data[ 4], value_data[ 5],
+                value_data[ 6], value_data[ 7], value_data[ 8],
+                value_data[ 9], value_data[10], value_data[11],
+                value_data[12], value_data[13], value_data[14],
+                value_data[15]);
+      else if (value_length == 4)
+        sprintf(buffer, "%d.%d.%d.%d",
+                value_data[0], value_data[1], value_data[2], value_data[3]);
+      vb.set_value(IpAddress(buffer));
+      break;
+    }
+    case sNMP_SYNTAX_INT:
+    {
+      long value;
+      get_value(value);
+      vb.set_value(SnmpInt32(value));
+      break;
+    }
+    case sNMP_SYNTAX_CNTR64:
+    {
+      struct counter64 value;
+      unsigned char type;
+      int len = value_tlv_length;
+      value.high = value.low = 0;
+      asn_parse_unsigned_int64((unsigned char *)value_tlv, &len, &type,
+                               &value);
+      vb.set_value(Counter64(value.high, value.low));
+      break;
+    }
+    case sNMP_SYNTAX_NOSUCHOBJECT:
+    case sNMP_SYNTAX_NOSUCHINSTANCE:
+    case sNMP_SYNTAX_ENDOFMIBVIEW:
+      vb.set_exception_status(value_type);
+      break;
+
+    case sNMP_SYNTAX_NULL:
+    default:
+      vb.set_null();
+      break;
+  }
+}
+
+//----[ PduView ]------------------------------------------------------
+
+void PduView::clear()
+{
+  version = version1;
+  community_data = 0;
+  community_length = 0;
+  type = 0;
+  request_id = 0;
+  error_status = 0;
+  error_index = 0;
+  enterprise_tlv = 0;
+  enterprise_tlv_length = 0;
+  memset(agent_addr, 0, sizeof(agent_addr));
+  generic_trap = 0;
+  specific_trap = 0;
+  timestamp = 0;
+  vbs_data = 0;
+  vbs_length = 0;
+  vb_count = 0;
+  cursor_index = 0;
+  cursor_data = 0;
+  cursor_length = 0;
+}
+
+int PduView::parse(const unsigned char *data, const int length)
+{
+  unsigned char t;
+  int len = length;
+  long value = -1;
+
+  clear();
+
+  // message header: sequence, version and community
+  const unsigned char *cp = parse_header(data, &len, &t);
+  if ((cp == NULL) || (t != ASN_SEQ_CON))
+  {
+    ASNERROR("PduView: bad message header");
+    return SNMP_CLASS_ASN1ERROR;
+  }
+  if (len < 2)
+    return SNMP_CLASS_ASN1ERROR;
+  cp = asn_parse_int((unsigned char *)cp, &len, &t, &value);
+  if (cp == NULL)
+  {
+    ASNERROR("PduView: bad parse of version");
+    return SNMP_CLASS_ASN1ERROR;
+  }
+
+  int community_len = len;
+  const unsigned char *community = parse_header(cp, &community_len, &t);
+  if ((community == NULL) ||
+      ((t != ASN_OCTET_STR) && (t != (ASN_OCTET_STR | ASN_CONSTRUCTOR)) &&
+       (t != SMI_IPADDRESS) && (t != SMI_OPAQUE) && (t != SMI_NSAP)))
+  {
+    ASNERROR("PduView: bad parse of community");
+    return SNMP_CLASS_ASN1ERROR;
+  }
+  len -= SAFE_INT_CAST(community + community_len - cp);
+  cp = community + community_len;
+
+  if ((value != SNMP_VERSION_1) && (value != SNMP_VERSION_2C))
+  {
+    ASNERROR("PduView: wrong version");
+    return SNMP_CLASS_BADVERSION;
+  }
+
+  // PDU header
+  cp = parse_header(cp, &len, &t);
+  if (cp == NULL)
+    return SNMP_CLASS_ASN1ERROR;
+  unsigned short pdu_type = t;
+
+  long reqid = 0, errstat = 0, errindex = 0;
+  long generic = 0, specific = 0;
+  unsigned long ticks = 0;
+  const unsigned char *enterprise = 0;
+  int enterprise_len = 0;
+  unsigned char addr[4];
+  memset(addr, 0, sizeof(addr));
+
+  if (pdu_type != TRP_REQ_MSG)
+  {
+    if (len >= 2)
+      cp = asn_parse_int((unsigned char *)cp, &len, &t, &reqid);
+    if ((cp != NULL) && (len >= 2))
+      cp = asn_parse_int((unsigned char *)cp, &len, &t, &errstat);
+    if ((cp != NULL) && (len >= 2))
+      cp = asn_parse_int((unsigned char *)cp, &len, &t, &errindex);
+    if ((cp == NULL) || (len < 2))
+      return SNMP_CLASS_ASN1ERROR;
+  }
+  else
+  {
+    // enterprise
+    int oid_len = len;
+    const unsigned char *oid_data = parse_header(cp, &oid_len, &t);
+    if ((oid_data == NULL) || (t != (ASN_UNI_PRIM | ASN_OBJECT_ID)) ||
+        !check_objid(oid_data, oid_len, ASN_MAX_NAME_LEN))
+      return SNMP_CLASS_ASN1ERROR;
+    enterprise = cp;
+    enterprise_len = SAFE_INT_CAST(oid_data + oid_len - cp);
+    len -= enterprise_len;
+    cp += enterprise_len;
+
+    // agent address
+    int addr_len = len;
+    const unsigned char *addr_data = parse_header(cp, &addr_len, &t);
+    if ((addr_data == NULL) || (addr_len > 4) ||
+        ((t != ASN_OCTET_STR) && (t != (ASN_OCTET_STR | ASN_CONSTRUCTOR)) &&
+         (t != SMI_IPADDRESS) && (t != SMI_OPAQUE) && (t != SMI_NSAP)))
+      return SNMP_CLASS_ASN1ERROR;
+    memcpy(addr, addr_data, addr_len);
+    len -= SAFE_INT_CAST(addr_data + addr_len - cp);
+    cp = addr_data + addr_len;
+
+    // generic and specific trap type, timestamp
+    if (len >= 2)
+      cp = asn_parse_int((unsigned char *)cp, &len, &t, &generic);
+    if ((cp != NULL) && (len >= 2))
+      cp = asn_parse_int((unsigned char *)cp, &len, &t, &specific);
+    if ((cp != NULL) && (len >= 2))
+      cp = asn_parse_unsigned_int((unsigned char *)cp, &len, &t, &ticks);
+    if ((cp == NULL) || (len < 2))
+      return SNMP_CLASS_ASN1ERROR;
+  }
+
+  // variable bindings: check all of them once
+  cp = parse_header(cp, &len, &t);
+  if ((cp == NULL) || (t != ASN_SEQ_CON))
+    return SNMP_CLASS_ASN1ERROR;
+
+  int count = 0;
+  int rest = len;
+  const unsigned char *vb_data = cp;
+  VbView vb;
+  while (rest > 0)
+  {
+    vb_data = vb.parse(vb_data, &rest);
+    if (vb_data == NULL)
+      return SNMP_CLASS_ASN1ERROR;
+    ++count;
+  }
+
+  version = (snmp_version)value;
+  community_data = community;
+  community_length = community_len;
+  type = pdu_type;
+  request_id = reqid;
+  error_status = errstat;
+  error_index = errindex;
+  enterprise_tlv = enterprise;
+  enterprise_tlv_length = enterprise_len;
+  memcpy(agent_addr, addr, sizeof(agent_addr));
+  generic_trap = generic;
+  specific_trap = specific;
+  timestamp = ticks;
+  vbs_data = cp;
+  vbs_length = len;
+  vb_count = count;
+  cursor_data = vbs_data;
+  cursor_length = vbs_length;
+
+  return SNMP_CLASS_SUCCESS;
+}
+
+int PduView::get_vb(const int index, VbView &vb)
+{
+  if (!valid() || (index < 0) || (index >= vb_count))
+    return SNMP_CLASS_INVALID;
+
+  if (index < cursor_index)
+  {
+    cursor_index = 0;
+    cursor_data = vbs_data;
+    cursor_length = vbs_length;
+  }
+  // all vbs have been checked by parse(), so this cannot fail
+  while (cursor_index < index)
+  {
+    cursor_data = vb.parse(cursor_data, &cursor_length);
+    ++cursor_index;
+  }
+  int len = cursor_length;
+  vb.parse(cursor_data, &len);
+
+  return SNMP_CLASS_SUCCESS;
+}
+
+int PduView::get_pdu(Pdu &pdu) const
+{
+  pdu.clear();
+
+  if (!valid())
+    return SNMP_CLASS_INVALID;
+
+  pdu.set_request_id(request_id);
+  pdu.set_error_status((int)error_status);
+  pdu.set_error_index((int)error_index);
+  pdu.set_type(type);
+
+  // deal with traps a little different
+  if (type == sNMP_PDU_V1TRAP)
+  {
+    pdu.set_notify_timestamp(TimeTicks(timestamp));
+
+    // set the agent address
+    if (agent_addr[0] || agent_addr[1] || agent_addr[2] || agent_addr[3])
+    {
+      char buffer[16];
+      sprintf(buffer, "%d.%d.%d.%d",
+              agent_addr[0], agent_addr[1], agent_addr[2], agent_addr[3]);
+      IpAddress address(buffer);
+      pdu.set_v1_trap_address(address);
+
+      LOG_BEGIN(loggerModuleName, DEBUG_LOG | 4);
+      LOG("PduView: Trap address of received v1 trap");
+      LOG(address.get_printable());
+      LOG_END;
+    }
+
+    // set enterprise, notifyid
+    Oid enterprise;
+    oid arcs[ASN_MAX_NAME_LEN];
+    int len = decode_objid(enterprise_tlv, enterprise_tlv_length, arcs);
+    if (len > 0)
+    {
+      enterprise.set_data((unsigned long *)arcs, len);
+      pdu.set_notify_enterprise(enterprise);
+    }
+    switch (generic_trap)
+    {
+      case 0: pdu.set_notify_id(coldStartOid());             break;
+      case 1: pdu.set_notify_id(warmStartOid());             break;
+      case 2: pdu.set_notify_id(linkDownOid());              break;
+      case 3: pdu.set_notify_id(linkUpOid());                break;
+      case 4: pdu.set_notify_id(authenticationFailureOid()); break;
+      case 5: pdu.set_notify_id(egpNeighborLossOid());       break;
+      case 6:
+      { // enterprise specific: base id + specific #
+        Oid id = enterprise;
+        id += 0ul;
+        id += specific_trap;
+        pdu.set_notify_id(id);
+        break;
+      }
+      default:
+        LOG_BEGIN(loggerModuleName, WARNING_LOG | 3);
+        LOG("PduView: Received trap with illegal trap type");
+        LOG(generic_trap);
+        LOG_END;
+    }
+  }
+
+  bool notification = ((type == sNMP_PDU_TRAP) || (type == sNMP_PDU_INFORM));
+  const unsigned char *cp = vbs_data;
+  int rest = vbs_length;
+  VbView view;
+  Vb vb;
+
+  for (int vb_nr = 1; vb_nr <= vb_count; ++vb_nr)
+  {
+    cp = view.parse(cp, &rest);
+
+    // sysUpTime.0 and snmpTrapOID.0 of notifications are not added
+    if (notification && (vb_nr == 1) &&
+        (view.get_syntax() == sNMP_SYNTAX_TIMETICKS) &&
+        view.oid_equals(sysUpTimeLiteral))
+    {
+      unsigned long ticks = 0;
+      view.get_value(ticks);
+      pdu.set_notify_timestamp(TimeTicks(ticks));
+      continue;
+    }
+    if (notification && (vb_nr == 2) &&
+        (view.get_syntax() == sNMP_SYNTAX_OID) &&
+        view.oid_equals(trapIdLiteral))
+    {
+      Oid id;
+      view.get_vb(vb);
+      vb.get_value(id);
+      pdu.set_notify_id(id);
+      continue;
+    }
+
+    view.get_vb(vb);
+    pdu += vb;
+  }
+
+  return SNMP_CLASS_SUCCESS;
+}
+
+#ifdef SNMP_PP_NAMESPACE
+} // end of namespace Snmp_pp
+#endif
@@ -87,6 +87,102 @@ void SnmpSynchronized::unlock()
 #endif
 }	
 
+#if defined(_THREADS) && !defined(WIN32) && !(defined (CPU) && CPU == PPC603)
+#define SNMP_PP_PTHREAD_RWLOCK
+#endif
+
+SnmpReadWriteLock::SnmpReadWriteLock()
+{
+#ifdef SNMP_PP_PTHREAD_RWLOCK
+	pthread_rwlock_init(&_rwlock, 0);
+#endif
+}
+
+SnmpReadWriteLock::~SnmpReadWriteLock()
+{
+#ifdef SNMP_PP_PTHREAD_RWLOCK
+	pthread_rwlock_destroy(&_rwlock);
+#endif
+}
+
+void SnmpReadWriteLock::read_lock()
+{
+#ifdef SNMP_PP_PTHREAD_RWLOCK
+	pthread_rwlock_rdlock(&_rwlock);
+#else
+	_lock.lock();
+#endif
+}
+
+void SnmpReadWriteLock::write_lock()
+{
+#ifdef SNMP_PP_PTHREAD_RWLOCK
+	pthread_rwlock_wrlock(&_rwlock);
+#else
+	_lock.lock();
+#endif
+}
+
+void SnmpReadWriteLock::unlock()
+{
+#ifdef SNMP_PP_PTHREAD_RWLOCK
+	pthread_rwlock_unlock(&_rwlock);
+#else
+	_lock.unlock();
+#endif
+}
+
+
+unsigned long SnmpAtomicCounter::increment()
+{
+#ifdef _THREADS
+#if defined(__GNUC__)
+	return __sync_add_and_fetch(&m_value, 1);
+#elif defined(_MSC_VER)
+	return (unsigned long)InterlockedIncrement(&m_value);
+#else
+	SnmpSynchronize _synchronize(m_lock);
+	return ++m_value;
+#endif
+#else
+	return ++m_value;
+#endif
+}
+
+unsigned long SnmpAtomicCounter::get()
+{
+#if defined(_THREADS) && defined(__GNUC__) && defined(__ATOMIC_ACQUIRE)
+	// a plain load, so readers on many threads do not write the value
+	return __atomic_load_n(&m_value, __ATOMIC_ACQUIRE);
+#elif defined(_THREADS) && defined(__GNUC__)
+	return __sync_add_and_fetch(&m_value, 0);
+#elif defined(_THREADS) && defined(_MSC_VER)
+	return (unsigned long)InterlockedExchangeAdd(&m_value, 0);
+#elif defined(_THREADS)
+	SnmpSynchronize _synchronize(m_lock);
+	return m_value;
+#else
+	return m_value;
+#endif
+}
+
+void SnmpAtomicCounter::set(const unsigned long value)
+{
+#if defined(_THREADS) && defined(__GNUC__)
+	unsigned long old_value;
+	do {
+		old_value = m_value;
+	} while (!__sync_bool_compare_and_swap(&m_value, old_value, value));
+#elif defined(_THREADS) && defined(_MSC_VER)
+	InterlockedExchange(&m_value, (LONG)value);
+#elif defined(_THREADS)
+	SnmpSynchronize _synchronize(m_lock);
+	m_value = value;
+#else
+	m_value = value;
+#endif
+}
+
 #ifdef SNMP_PP_NAMESPACE
 } // end of namespace Snmp_pp
 #endif 
@@ -65,6 +65,10 @@ namespace Snmp_pp {
 
 static const char *loggerModuleName = "snmp++.snmpmsg";
 
+// sysUpTime.0 and snmpTrapOID.0 of notifications
+static SNMP_PP_OID_LITERAL(sysUpTimeLiteral, SNMP_MSG_OID_SYSUPTIME);
+static SNMP_PP_OID_LITERAL(trapIdLiteral, SNMP_MSG_OID_TRAPID);
+
 #define MAX_LEN_COMMUNITY 254
 
 const coldStartOid coldStart;
@@ -218,6 +222,120 @@ int SnmpMessage::load(const Pdu &cpdu,
   if (!pdu->valid())
     return SNMP_CLASS_INVALID_PDU;
 
+  if (pdu->get_type() == sNMP_PDU_V1TRAP)
+    return load_v1_trap(cpdu, community, version,
+                        engine_id, security_name, security_model);
+
+  // if its a v2 trap then we need to make a few adjustments
+  // vb #1 is the timestamp
+  // vb #2 is the id, represented as an Oid
+  if ((pdu->get_type() == sNMP_PDU_TRAP) ||
+      (pdu->get_type() == sNMP_PDU_INFORM))
+  {
+    Vb tempvb;
+
+    temppdu = *pdu;
+    temppdu.trim(temppdu.get_vb_count());
+
+    // vb #1 is the timestamp
+    TimeTicks timestamp;
+    tempvb.set_oid(sysUpTimeLiteral);   // sysuptime
+    pdu->get_notify_timestamp( timestamp);
+    tempvb.set_value ( timestamp);
+    temppdu += tempvb;
+
+    // vb #2 is the id
+    Oid trapid;
+    tempvb.set_oid(trapIdLiteral);
+    pdu->get_notify_id( trapid);
+    tempvb.set_value( trapid);
+    temppdu += tempvb;
+
+    // append the remaining vbs
+    for (int z=0; z<pdu->get_vb_count(); z++) {
+      pdu->get_vb( tempvb,z);
+      temppdu += tempvb;
+    }
+
+    pdu = &temppdu;          // reassign the pdu to the temp one
+  }
+
+  // ASN1 encode the pdu directly into the message buffer
+  valid_flag = false;
+  bufflen = buffer.size();
+#ifdef _SNMPv3
+  if (version == version3)
+  {
+    if ((!engine_id) || (!security_name))
+    {
+      LOG_BEGIN(loggerModuleName, ERROR_LOG | 4);
+      LOG("SNMPMessage: Need security name and engine id for v3 message");
+      LOG_END;
+
+      return SNMP_CLASS_INVALID_TARGET;
+    }
+
+    status = v3MP::I->snmp_build(*pdu, databuff, (int *)&bufflen,
+                                 *engine_id, *security_name, security_model,
+                                 pdu->get_security_level(),
+                                 pdu->get_context_engine_id(),
+                                 pdu->get_context_name());
+    if (status == SNMPv3_MP_OK) {
+      if ((pdu->get_type() == sNMP_PDU_RESPONSE) &&
+          ((int)pdu->get_maxsize_scopedpdu() < pdu->get_asn1_length())) {
+
+	LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
+        LOG("SNMPMessage: *BUG*: Serialized response pdu is too big (len) (max)");
+        LOG(pdu->get_asn1_length());
+        LOG(pdu->get_maxsize_scopedpdu());
+        LOG_END;
+
+        return SNMP_ERROR_TOO_BIG;
+      }
+    }
+  }
+  else
+#endif
+  status = snmp_build(*pdu, databuff, (int *) &bufflen, version,
+                      community.data(), (int) community.len());
+
+  LOG_BEGIN(loggerModuleName, DEBUG_LOG | 4);
+  LOG("SNMPMessage: return value for build message");
+  LOG(status);
+  LOG_END;
+
+  if ((status != 0)
+#ifdef _SNMPv3
+      && ((version != version3) || (status != SNMPv3_MP_OK))
+#endif
+      ) {
+#ifdef _SNMPv3
+    if (version == version3)
+      return status;
+    else
+#endif
+      // NOTE: This is an assumption - in most cases during normal
+      // operation the reason is a tooBig - another could be a
+      // damaged variable binding.
+      return SNMP_ERROR_TOO_BIG;
+  }
+  valid_flag = true;
+
+  return SNMP_CLASS_SUCCESS;
+}
+
+// Encode a SNMPv1 trap through struct snmp_pdu, which takes the
+// enterprise, agent address and trap types of the trap header
+int SnmpMessage::load_v1_trap(const Pdu &cpdu,
+                              const OctetStr &community,
+                              const snmp_version version,
+                              const OctetStr* engine_id,
+                              const OctetStr* security_name,
+                              const int security_model)
+{
+  int status;
+  const Pdu *pdu = &cpdu;
+
   // create a raw pdu
   snmp_pdu *raw_pdu;
   raw_pdu = snmp_pdu_create( (int) pdu->get_type());
@@ -354,39 +472,6 @@ int SnmpMessage::load(const Pdu &cpdu,
     raw_pdu->time = (unsigned long) timestamp;
   }
 
-  // if its a v2 trap then we need to make a few adjustments
-  // vb #1 is the timestamp
-  // vb #2 is the id, represented as an Oid
-  if ((raw_pdu->command == sNMP_PDU_TRAP) ||
-      (raw_pdu->command == sNMP_PDU_INFORM))
-  {
-    Vb tempvb;
-
-    temppdu = *pdu;
-    temppdu.trim(temppdu.get_vb_count());
-
-    // vb #1 is the timestamp
-    TimeTicks timestamp;
-    tempvb.set_oid(SNMP_MSG_OID_SYSUPTIME);   // sysuptime
-    pdu->get_notify_timestamp( timestamp);
-    tempvb.set_value ( timestamp);
-    temppdu += tempvb;
-
-    // vb #2 is the id
-    Oid trapid;
-    tempvb.set_oid(SNMP_MSG_OID_TRAPID);
-    pdu->get_notify_id( trapid);
-    tempvb.set_value( trapid);
-    temppdu += tempvb;
-
-    // append the remaining vbs
-    for (int z=0; z<pdu->get_vb_count(); z++) {
-      pdu->get_vb( tempvb,z);
-      temppdu += tempvb;
-    }
-
-    pdu = &temppdu;          // reassign the pdu to the temp one
-  }
   // load up the payload
   // for all Vbs in list, add them to the pdu
   int vb_count;
@@ -511,10 +596,10 @@ int SnmpMessage::load(const Pdu &cpdu,
 int SnmpMessage::load( unsigned char *data,
                        unsigned long len)
 {
-  bufflen = MAX_SNMP_PACKET;
+  bufflen = buffer.size();
   valid_flag = false;
 
-  if (len <= MAX_SNMP_PACKET)
+  if (len <= buffer.size())
   {
     memcpy( (unsigned char *) databuff, (unsigned char *) data,
             (unsigned int) len);
@@ -542,49 +627,48 @@ int SnmpMessage::unload(Pdu &pdu,                 // Pdu object
   if (!valid_flag)
     return SNMP_CLASS_INVALID;
 
-  snmp_pdu *raw_pdu;
-  raw_pdu = snmp_pdu_create(0); // do a "snmp_free_pdu( raw_pdu)" before return
+#ifdef _SNMPv3
+  if (!security_model || !security_name || !engine_id || !snmp_session)
+#endif
+  {
+    // SNMPv1/v2c: decode directly from the buffer
+    PduView view;
+    int status = view.parse(databuff, (int)bufflen);
+    if (status != SNMP_CLASS_SUCCESS)
+      return status;
+    if (view.get_community_length() > MAX_LEN_COMMUNITY + 1)
+      return SNMP_CLASS_ASN1ERROR;
 
-  int status;
+    version = view.get_version();
+    community.set_data(view.get_community_data(),
+                       view.get_community_length());
+    return view.get_pdu(pdu);
+  }
 
 #ifdef _SNMPv3
+  snmp_pdu *raw_pdu;
+  raw_pdu = snmp_pdu_create(0); // do a "snmp_free_pdu( raw_pdu)" before return
+
   OctetStr context_engine_id;
   OctetStr context_name;
   long int security_level = SNMP_SECURITY_LEVEL_NOAUTH_NOPRIV;
 
-  if ((security_model) && (security_name) && (engine_id) && (snmp_session)) {
-    status = v3MP::I->snmp_parse(snmp_session, raw_pdu,
-                         databuff, (int)bufflen, *engine_id,
-                         *security_name, context_engine_id, context_name,
-                         security_level, *security_model, version, *from_addr);
-    if (status != SNMPv3_MP_OK) {
-      pdu.set_request_id( raw_pdu->reqid);
-      pdu.set_type( raw_pdu->command);
-      snmp_free_pdu( raw_pdu);
-      return status;
-    }
-    pdu.set_context_engine_id(context_engine_id);
-    pdu.set_context_name(context_name);
-    pdu.set_security_level(security_level);
-    pdu.set_message_id(raw_pdu->msgid);
-    pdu.set_maxsize_scopedpdu(raw_pdu->maxsize_scopedpdu);
+  int status = v3MP::I->snmp_parse(snmp_session, raw_pdu,
+                       databuff, (int)bufflen, *engine_id,
+                       *security_name, context_engine_id, context_name,
+                       security_level, *security_model, version, *from_addr);
+  if (status != SNMPv3_MP_OK) {
+    pdu.set_request_id( raw_pdu->reqid);
+    pdu.set_type( raw_pdu->command);
+    snmp_free_pdu( raw_pdu);
+    return status;
   }
-  else {
-#endif
-    unsigned char community_name[MAX_LEN_COMMUNITY + 1];
-    int           community_len = MAX_LEN_COMMUNITY + 1;
+  pdu.set_context_engine_id(context_engine_id);
+  pdu.set_context_name(context_name);
+  pdu.set_security_level(security_level);
+  pdu.set_message_id(raw_pdu->msgid);
+  pdu.set_maxsize_scopedpdu(raw_pdu->maxsize_scopedpdu);
 
-    status = snmp_parse(raw_pdu, databuff, (int) bufflen,
-                        community_name, community_len, version);
-    if (status != SNMP_CLASS_SUCCESS) {
-      snmp_free_pdu(raw_pdu);
-      return status;
-    }
-    community.set_data( community_name, community_len);
-
-#ifdef _SNMPv3
-  }
-#endif
   // load up the SNMP++ variables
   pdu.set_request_id(raw_pdu->reqid);
   pdu.set_error_status((int) raw_pdu->errstat);
@@ -703,7 +787,7 @@ int SnmpMessage::unload(Pdu &pdu,                 // Pdu object
         if ((vb_nr == 2) &&
             ((raw_pdu->command == sNMP_PDU_TRAP) ||
              (raw_pdu->command == sNMP_PDU_INFORM)) &&
-            (tempoid == SNMP_MSG_OID_TRAPID))
+            (tempoid == trapIdLiteral))
         {
           // set notify_id
           pdu.set_notify_id(oid);
@@ -720,7 +804,7 @@ int SnmpMessage::unload(Pdu &pdu,                 // Pdu object
         if ((vb_nr == 1) &&
             ((raw_pdu->command == sNMP_PDU_TRAP) ||
              (raw_pdu->command == sNMP_PDU_INFORM)) &&
-            (tempoid == SNMP_MSG_OID_SYSUPTIME))
+            (tempoid == sysUpTimeLiteral))
         {
           // set notify_timestamp
           pdu.set_notify_timestamp( timeticks);
@@ -817,6 +901,17 @@ int SnmpMessage::unload(Pdu &pdu,                 // Pdu object
   snmp_free_pdu( raw_pdu);
 
   return SNMP_CLASS_SUCCESS;
+#endif
+}
+
+int SnmpMessage::get_view(PduView &view) const
+{
+  view.clear();
+
+  if (!valid_flag)
+    return SNMP_CLASS_INVALID;
+
+  return view.parse(databuff, (int)bufflen);
 }
 
 #ifdef SNMP_PP_NAMESPACE
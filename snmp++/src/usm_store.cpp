@@ -0,0 +1,659 @@
+/*_############################################################################
+  _##
+  _##  usm_store.cpp
+  _##
+  _##  SNMP++ v3.3
+  _##  -----------------------------------------------
+  _##  Copyright (c) 2001-2013 Jochen Katz, Frank Fock
+  _##
+  _##  This software is based on SNMP++2.6 from Hewlett Packard:
+  _##
+  _##    Copyright (c) 1996
+  _##    Hewlett-Packard Company
+  _##
+  _##  ATTENTION: USE OF THIS SOFTWARE IS SUBJECT TO THE FOLLOWING TERMS.
+  _##  Permission to use, copy, modify, distribute and/or sell this software
+  _##  and/or its documentation is hereby granted without fee. User agrees
+  _##  to display the above copyright notice and this license notice in all
+  _##  copies of the software and any documentation of the software. User
+  _##  agrees to assume all liability for the use of the software;
+  _##  Hewlett-Packard and Jochen Katz make no representations about the
+  _##  suitability of this software for any purpose. It is provided
+  _##  "AS-IS" without warranty of any kind, either express or implied. User
+  _##  hereby grants a royalty-free license to any and all derivatives based
+  _##  upon this software code base.
+  _##
+  _##########################################################################*/
+
+
+char usm_store_cpp_version[]="@(#) SNMP++ $Id$";
+
+#include <libsnmp.h>
+
+#include "snmp_pp/config_snmp_pp.h"
+
+#ifdef _SNMPv3
+
+#include "snmp_pp/usm_store.h"
+#include "snmp_pp/hash_index.h"
+#include "snmp_pp/v3.h"
+#include "snmp_pp/log.h"
+
+#if !defined(SNMP_PP_NO_MMAP) && !defined(WIN32) && defined(HAVE_UNISTD_H)
+#define USM_STORE_MMAP
+#include <sys/mman.h>
+#include <fcntl.h>
+#ifdef MAP_POPULATE
+// all pages are read at open, read them at once
+#define USM_STORE_MAP_FLAGS (MAP_PRIVATE | MAP_POPULATE)
+#else
+#define USM_STORE_MAP_FLAGS MAP_PRIVATE
+#endif
+#endif
+
+#ifdef SNMP_PP_NAMESPACE
+namespace Snmp_pp {
+#endif
+
+static const char *loggerModuleName = "snmp++.usm_store";
+
+#define USM_STORE_MAGIC      "SNMPUSM"
+#define USM_STORE_BYTE_ORDER 0x01020304u
+#define USM_STORE_ALIGN      8
+#define USM_STORE_BUF_LEN    512   // enough for users with usual lengths
+
+struct UsmStoreHeader
+{
+  char         magic[8];        // USM_STORE_MAGIC
+  unsigned int version;         // SNMPv3_USM_STORE_VERSION
+  unsigned int byte_order;      // USM_STORE_BYTE_ORDER of the writer
+  unsigned int count;           // records in the snapshot
+  unsigned int snapshot_size;   // bytes of the snapshot records
+  unsigned int index_size;      // bytes of the index behind the records
+  unsigned int check;           // hash of the records and the index
+};
+
+// Hash of a record with the check field set to 0
+static unsigned int record_check(const UsmStoreRecord *record)
+{
+  static const unsigned char zero[sizeof(record->check)] = { 0 };
+  const unsigned char *p = (const unsigned char *)record;
+
+  unsigned int hash = SnmpHashIndex::hash(p, sizeof(record->size));
+  hash = SnmpHashIndex::hash(zero, sizeof(zero), hash);
+  return SnmpHashIndex::hash(p + sizeof(record->size) + sizeof(zero),
+                             record->size - sizeof(record->size)
+                                          - sizeof(zero), hash);
+}
+
+// Hash of the snapshot records and the index. It is computed word by
+// word, as the snapshot may have megabytes; the records and the index
+// are multiples of USM_STORE_ALIGN, so they can be hashed one by one.
+static unsigned int snapshot_check(const unsigned char *p,
+                                   const unsigned long  len,
+                                   unsigned int         hash = 2166136261u)
+{
+  unsigned long i = 0;
+  for (; i + sizeof(unsigned int) <= len; i += sizeof(unsigned int))
+  {
+    unsigned int word;
+    memcpy(&word, p + i, sizeof(word));
+    hash ^= word;
+    hash *= 16777619u;
+  }
+  return SnmpHashIndex::hash(p + i, len - i, hash);
+}
+
+UsmUserStore::UsmUserStore()
+  : file_name(0), data(0), data_len(0), header_len(sizeof(UsmStoreHeader)),
+    snapshot_end(0), journal_end(0), file_end(0), index_len(0),
+    snapshot_count(0), index_valid(false),
+    journal(0), mapped(false)
+{
+}
+
+UsmUserStore::~UsmUserStore()
+{
+  close();
+}
+
+int UsmUserStore::open(const char *name)
+{
+  close();
+
+  if (!name)
+    return SNMPv3_USM_FILEOPEN_ERROR;
+
+  FILE *file = fopen(name, "rb");
+  if (file)
+    fclose(file);
+  else
+  {
+    LOG_BEGIN(loggerModuleName, INFO_LOG | 4);
+    LOG("UsmUserStore: Creating empty user store");
+    LOG(name);
+    LOG_END;
+
+    int result = write(name, 0, 0, 0, 0);
+    if (result != SNMPv3_USM_OK)
+      return result;
+  }
+
+  int result = map(name);
+  if (result != SNMPv3_USM_OK)
+    return result;
+
+  const UsmStoreHeader *header = (const UsmStoreHeader *)data;
+  if ((data_len < header_len) ||
+      memcmp(header->magic, USM_STORE_MAGIC, sizeof(USM_STORE_MAGIC)) ||
+      (header->version != SNMPv3_USM_STORE_VERSION) ||
+      (header->byte_order != USM_STORE_BYTE_ORDER) ||
+      (header->snapshot_size > data_len - header_len) ||
+      (header->index_size > data_len - header_len - header->snapshot_size) ||
+      (header->index_size % USM_STORE_ALIGN))
+  {
+    LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
+    LOG("UsmUserStore: File is no user store of this version and byte order");
+    LOG(name);
+    LOG_END;
+
+    close();
+    return SNMPv3_USM_FILEREAD_ERROR;
+  }
+
+  // check the structure of the snapshot records
+  snapshot_end = header_len + header->snapshot_size;
+  unsigned long pos = header_len;
+  unsigned int count = 0;
+  index_len = header->index_size;
+  while (pos < snapshot_end)
+  {
+    const UsmStoreRecord *record = (const UsmStoreRecord *)(data + pos);
+    if (!valid(record, snapshot_end) || (record->type != ADD_USER))
+      break;
+    pos += record->size;
+    ++count;
+  }
+  if ((pos != snapshot_end) || (count != header->count))
+  {
+    LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
+    LOG("UsmUserStore: Damaged snapshot in file (records) (valid)");
+    LOG(name);
+    LOG(header->count);
+    LOG(count);
+    LOG_END;
+
+    close();
+    return SNMPv3_USM_FILEREAD_ERROR;
+  }
+  snapshot_count = count;
+  snapshot_end += index_len;
+  pos = snapshot_end;
+
+  // the records are still usable if only the hash does not match,
+  // but the saved index is not trusted then
+  index_valid = (snapshot_check(data + header_len,
+                                snapshot_end - header_len) == header->check);
+  if (!index_valid)
+  {
+    LOG_BEGIN(loggerModuleName, WARNING_LOG | 2);
+    LOG("UsmUserStore: Snapshot does not match its hash, ignoring index");
+    LOG(name);
+    LOG_END;
+  }
+
+  // the journal ends at the first incomplete record
+  while (pos < data_len)
+  {
+    const UsmStoreRecord *record = (const UsmStoreRecord *)(data + pos);
+    if (!valid(record, data_len) || (record->check != record_check(record)))
+      break;
+    pos += record->size;
+  }
+  journal_end = file_end = pos;
+  if (pos != data_len)
+  {
+    LOG_BEGIN(loggerModuleName, WARNING_LOG | 2);
+    LOG("UsmUserStore: Ignoring incomplete journal record at (offset)");
+    LOG(pos);
+    LOG_END;
+  }
+
+  LOG_BEGIN(loggerModuleName, INFO_LOG | 4);
+  LOG("UsmUserStore: Opened (file) (snapshot records) (journal bytes)");
+  LOG(name);
+  LOG(snapshot_count);
+  LOG(journal_end - snapshot_end);
+  LOG_END;
+
+  return SNMPv3_USM_OK;
+}
+
+int UsmUserStore::map(const char *name)
+{
+  file_name = new char[strlen(name) + 1];
+  strcpy(file_name, name);
+
+#ifdef USM_STORE_MMAP
+  int fd = ::open(name, O_RDONLY);
+  if (fd < 0)
+  {
+    LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
+    LOG("UsmUserStore: could not open file");
+    LOG(name);
+    LOG_END;
+
+    return SNMPv3_USM_FILEOPEN_ERROR;
+  }
+
+  struct stat st;
+  void *ptr = MAP_FAILED;
+  if ((fstat(fd, &st) == 0) && (st.st_size > 0))
+    ptr = mmap(0, st.st_size, PROT_READ, USM_STORE_MAP_FLAGS, fd, 0);
+  ::close(fd);
+  if (ptr == MAP_FAILED)
+  {
+    LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
+    LOG("UsmUserStore: could not map file");
+    LOG(name);
+    LOG_END;
+
+    return SNMPv3_USM_FILEREAD_ERROR;
+  }
+  data = (const unsigned char *)ptr;
+  data_len = st.st_size;
+  mapped = true;
+#else
+  FILE *file = fopen(name, "rb");
+  if (!file)
+  {
+    LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
+    LOG("UsmUserStore: could not open file");
+    LOG(name);
+    LOG_END;
+
+    return SNMPv3_USM_FILEOPEN_ERROR;
+  }
+
+  long len = -1;
+  if (fseek(file, 0, SEEK_END) == 0)
+    len = ftell(file);
+  unsigned char *buf = 0;
+  if ((len > 0) && (fseek(file, 0, SEEK_SET) == 0))
+  {
+    buf = new unsigned char[len];
+    if (buf && (fread(buf, len, 1, file) != 1))
+    {
+      delete [] buf;
+      buf = 0;
+    }
+  }
+  fclose(file);
+  if (!buf)
+  {
+    LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
+    LOG("UsmUserStore: could not read file");
+    LOG(name);
+    LOG_END;
+
+    return SNMPv3_USM_FILEREAD_ERROR;
+  }
+  data = buf;
+  data_len = len;
+  mapped = false;
+#endif
+  return SNMPv3_USM_OK;
+}
+
+void UsmUserStore::close()
+{
+  close_journal();
+  if (data)
+  {
+#ifdef USM_STORE_MMAP
+    if (mapped)
+      munmap((void *)data, data_len);
+    else
+#endif
+      delete [] data;
+  }
+  data = 0;
+  data_len = 0;
+  snapshot_end = journal_end = file_end = 0;
+  index_len = 0;
+  snapshot_count = 0;
+  index_valid = false;
+  mapped = false;
+  if (file_name)
+    delete [] file_name;
+  file_name = 0;
+}
+
+void UsmUserStore::close_journal()
+{
+  if (journal)
+    fclose(journal);
+  journal = 0;
+}
+
+bool UsmUserStore::valid(const UsmStoreRecord *record,
+                         const unsigned long end) const
+{
+  unsigned long pos = (const unsigned char *)record - data;
+
+  if ((end - pos < sizeof(UsmStoreRecord)) ||
+      (record->size > end - pos) || (record->size % USM_STORE_ALIGN))
+    return false;
+
+  // the data is followed by at least one zero byte
+  unsigned long len = sizeof(UsmStoreRecord) + record->engine_id_len +
+                      record->user_name_len + record->sec_name_len +
+                      record->auth_key_len + record->priv_key_len;
+  return (len < record->size) &&
+         ((record->type == ADD_USER) || (record->type == DELETE_USER));
+}
+
+const UsmStoreRecord *UsmUserStore::first() const
+{
+  unsigned long pos = header_len;
+  if (snapshot_count == 0)
+    pos = snapshot_end;
+  if (!data || (pos >= journal_end))
+    return 0;
+  return (const UsmStoreRecord *)(data + pos);
+}
+
+const UsmStoreRecord *UsmUserStore::next(const UsmStoreRecord *record) const
+{
+  unsigned long pos = (const unsigned char *)record - data + record->size;
+  if (pos == snapshot_end - index_len)
+    pos = snapshot_end;    // skip the index
+  if (pos >= journal_end)
+    return 0;
+  return (const UsmStoreRecord *)(data + pos);
+}
+
+const UsmStoreRecord *UsmUserStore::first_journal_record() const
+{
+  if (!data || (snapshot_end >= journal_end))
+    return 0;
+  return (const UsmStoreRecord *)(data + snapshot_end);
+}
+
+void UsmUserStore::get_entry(const UsmStoreRecord *record,
+                             struct UsmUserTableEntry &entry)
+{
+  unsigned char *p = (unsigned char *)(record + 1);
+
+  entry.usmUserEngineID           = p;
+  entry.usmUserEngineIDLength     = record->engine_id_len;
+  p += record->engine_id_len;
+  entry.usmUserName               = p;
+  entry.usmUserNameLength         = record->user_name_len;
+  p += record->user_name_len;
+  entry.usmUserSecurityName       = p;
+  entry.usmUserSecurityNameLength = record->sec_name_len;
+  p += record->sec_name_len;
+  entry.usmUserAuthProtocol       = record->auth_protocol;
+  entry.usmUserAuthKey            = p;
+  entry.usmUserAuthKeyLength      = record->auth_key_len;
+  p += record->auth_key_len;
+  entry.usmUserPrivProtocol       = record->priv_protocol;
+  entry.usmUserPrivKey            = p;
+  entry.usmUserPrivKeyLength      = record->priv_key_len;
+  entry.usmUserAuthPreparedKey       = 0;
+  entry.usmUserAuthPreparedKeyLength = 0;
+  entry.usmUserPrivPreparedKey       = 0;
+  entry.usmUserPrivPreparedKeyLength = 0;
+}
+
+unsigned long UsmUserStore::record_size(const RecordType type,
+                                        const struct UsmUserTableEntry &entry)
+{
+  long lens[5] = { entry.usmUserEngineIDLength, entry.usmUserNameLength,
+                   entry.usmUserSecurityNameLength,
+                   entry.usmUserAuthKeyLength, entry.usmUserPrivKeyLength };
+  int fields = (type == DELETE_USER) ? 2 : 5;
+  unsigned long size = sizeof(UsmStoreRecord) + 1;
+
+  for (int i = 0; i < fields; ++i)
+  {
+    if ((lens[i] < 0) || (lens[i] > 0xFFFF))
+      return 0;
+    size += lens[i];
+  }
+  return (size + USM_STORE_ALIGN - 1) & ~(unsigned long)(USM_STORE_ALIGN - 1);
+}
+
+void UsmUserStore::fill_record(const RecordType type,
+                               const struct UsmUserTableEntry &entry,
+                               unsigned char *buf, const unsigned long size)
+{
+  UsmStoreRecord *record = (UsmStoreRecord *)buf;
+  unsigned char *p = (unsigned char *)(record + 1);
+
+  memset(buf, 0, size);
+  record->size = (unsigned int)size;
+  record->type = (unsigned short)type;
+
+  record->engine_id_len = (unsigned short)entry.usmUserEngineIDLength;
+  if (record->engine_id_len)
+    memcpy(p, entry.usmUserEngineID, record->engine_id_len);
+  p += record->engine_id_len;
+  record->user_name_len = (unsigned short)entry.usmUserNameLength;
+  if (record->user_name_len)
+    memcpy(p, entry.usmUserName, record->user_name_len);
+  p += record->user_name_len;
+  if (type == DELETE_USER)
+    return;
+
+  record->sec_name_len = (unsigned short)entry.usmUserSecurityNameLength;
+  if (record->sec_name_len)
+    memcpy(p, entry.usmUserSecurityName, record->sec_name_len);
+  p += record->sec_name_len;
+  record->auth_protocol = (int)entry.usmUserAuthProtocol;
+  record->auth_key_len = (unsigned short)entry.usmUserAuthKeyLength;
+  if (record->auth_key_len)
+    memcpy(p, entry.usmUserAuthKey, record->auth_key_len);
+  p += record->auth_key_len;
+  record->priv_protocol = (int)entry.usmUserPrivProtocol;
+  record->priv_key_len = (unsigned short)entry.usmUserPrivKeyLength;
+  if (record->priv_key_len)
+    memcpy(p, entry.usmUserPrivKey, record->priv_key_len);
+}
+
+int UsmUserStore::write(const char *name,
+                        const struct UsmUserTableEntry *entries,
+                        const int count,
+                        const unsigned char *index,
+                        const unsigned long index_size)
+{
+  char tmp_file_name[MAXLENGTH_FILENAME];
+  unsigned char buf[USM_STORE_BUF_LEN];
+  UsmStoreHeader header;
+  unsigned long snapshot_size = 0;
+  int i;
+
+  if (!name || (strlen(name) + 5 > MAXLENGTH_FILENAME))
+    return SNMPv3_USM_FILECREATE_ERROR;
+
+  for (i = 0; i < count; ++i)
+  {
+    unsigned long size = record_size(ADD_USER, entries[i]);
+    if (size == 0)
+    {
+      LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
+      LOG("UsmUserStore: User too long for the store (user name)");
+      LOG(OctetStr(entries[i].usmUserName,
+                   entries[i].usmUserNameLength).get_printable());
+      LOG_END;
+
+      return SNMPv3_USM_FILEWRITE_ERROR;
+    }
+    snapshot_size += size;
+  }
+
+  sprintf(tmp_file_name, "%s.tmp", name);
+  FILE *file_out = fopen(tmp_file_name, "wb");
+  if (!file_out)
+  {
+    LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
+    LOG("UsmUserStore: could not create tmpfile");
+    LOG(tmp_file_name);
+    LOG_END;
+
+    return SNMPv3_USM_FILECREATE_ERROR;
+  }
+
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, USM_STORE_MAGIC, sizeof(USM_STORE_MAGIC));
+  header.version       = SNMPv3_USM_STORE_VERSION;
+  header.byte_order    = USM_STORE_BYTE_ORDER;
+  header.count         = count;
+  header.snapshot_size = (unsigned int)snapshot_size;
+  header.index_size    = (unsigned int)index_size;
+
+  // the header is written again when the hash of the records and
+  // the index is known, snapshot_check(0, 0) is the start value
+  unsigned int check = snapshot_check(0, 0);
+  bool failed = ((index_size % USM_STORE_ALIGN) ||
+                 (fwrite(&header, sizeof(header), 1, file_out) != 1));
+  for (i = 0; (i < count) && !failed; ++i)
+  {
+    unsigned long size = record_size(ADD_USER, entries[i]);
+    unsigned char *record = buf;
+    if (size > sizeof(buf))
+      record = new unsigned char[size];
+
+    fill_record(ADD_USER, entries[i], record, size);
+    check = snapshot_check(record, size, check);
+    failed = (fwrite(record, size, 1, file_out) != 1);
+
+    memset(record, 0, size);
+    if (record != buf)
+      delete [] record;
+  }
+  if (!failed && index_size)
+  {
+    check = snapshot_check(index, index_size, check);
+    failed = (fwrite(index, index_size, 1, file_out) != 1);
+  }
+  if (!failed)
+  {
+    header.check = check;
+    failed = ((fseek(file_out, 0, SEEK_SET) != 0) ||
+              (fwrite(&header, sizeof(header), 1, file_out) != 1));
+  }
+  if (fclose(file_out) != 0)
+    failed = true;
+
+  if (failed)
+  {
+    LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
+    LOG("UsmUserStore: Failed to write snapshot.");
+    LOG_END;
+
+#ifdef WIN32
+    _unlink(tmp_file_name);
+#else
+    unlink(tmp_file_name);
+#endif
+    return SNMPv3_USM_FILEWRITE_ERROR;
+  }
+#ifdef WIN32
+  _unlink(name);
+#endif
+  if (rename(tmp_file_name, name))
+  {
+    LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
+    LOG("UsmUserStore: Could not rename file (from) (to)");
+    LOG(tmp_file_name);
+    LOG(name);
+    LOG_END;
+
+    return SNMPv3_USM_FILERENAME_ERROR;
+  }
+
+  LOG_BEGIN(loggerModuleName, INFO_LOG | 4);
+  LOG("UsmUserStore: Wrote snapshot (file) (users)");
+  LOG(name);
+  LOG(count);
+  LOG_END;
+
+  return SNMPv3_USM_OK;
+}
+
+int UsmUserStore::append(const RecordType type,
+                         const struct UsmUserTableEntry &entry)
+{
+  unsigned char buf[USM_STORE_BUF_LEN];
+
+  if (!file_name)
+    return SNMPv3_USM_FILEOPEN_ERROR;
+
+  unsigned long size = record_size(type, entry);
+  if (size == 0)
+    return SNMPv3_USM_FILEWRITE_ERROR;
+
+  if (!journal)
+  {
+    journal = fopen(file_name, "r+b");
+    if (!journal)
+    {
+      LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
+      LOG("UsmUserStore: could not open file for the journal");
+      LOG(file_name);
+      LOG_END;
+
+      return SNMPv3_USM_FILEOPEN_ERROR;
+    }
+    // drop an incomplete record behind the journal
+    if ((fseek(journal, 0, SEEK_END) == 0) &&
+        ((unsigned long)ftell(journal) > file_end))
+    {
+#ifdef WIN32
+      _chsize(_fileno(journal), file_end);
+#else
+      if (ftruncate(fileno(journal), file_end)) {}
+#endif
+    }
+    if (fseek(journal, file_end, SEEK_SET) != 0)
+    {
+      close_journal();
+      return SNMPv3_USM_FILEWRITE_ERROR;
+    }
+  }
+
+  unsigned char *record = buf;
+  if (size > sizeof(buf))
+    record = new unsigned char[size];
+
+  fill_record(type, entry, record, size);
+  ((UsmStoreRecord *)record)->check = record_check((UsmStoreRecord *)record);
+  bool failed = ((fwrite(record, size, 1, journal) != 1) ||
+                 (fflush(journal) != 0));
+
+  memset(record, 0, size);
+  if (record != buf)
+    delete [] record;
+
+  if (failed)
+  {
+    LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
+    LOG("UsmUserStore: Failed to append journal record to file");
+    LOG(file_name);
+    LOG_END;
+
+    // the next append() truncates the file to the last record
+    close_journal();
+    return SNMPv3_USM_FILEWRITE_ERROR;
+  }
+  file_end += size;
+  return SNMPv3_USM_OK;
+}
+
+#ifdef SNMP_PP_NAMESPACE
+} // end of namespace Snmp_pp
+#endif
+
+#endif // _SNMPv3
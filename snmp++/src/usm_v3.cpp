@@ -36,6 +36,8 @@ char usm_v3_cpp_version[]="@(#) SNMP++ $Id: usm_v3.cpp 2361 2013-05-09 22:15:06Z
 #include "snmp_pp/usm_v3.h"
 #include "snmp_pp/auth_priv.h"
 #include "snmp_pp/reentrant.h"
+#include "snmp_pp/hash_index.h"
+#include "snmp_pp/usm_store.h"
 #include "snmp_pp/mp_v3.h"
 #include "snmp_pp/asn1.h"
 #include "snmp_pp/vb.h"
@@ -54,12 +56,26 @@ static const char *loggerModuleName = "snmp++.usm_v3";
 #define BEGIN_REENTRANT_CODE_BLOCK_CONST  \
           SnmpSynchronize auto_lock(*(PP_CONST_CAST(SnmpSynchronized*, this)))
 #define BEGIN_AUTO_LOCK(obj) SnmpSynchronize auto_lock(*obj)
+// The user tables are read on every message: Lookups only take the
+// read lock, changes take the table lock and the write lock.
+#define BEGIN_READ_CODE_BLOCK SnmpReadLock auto_read_lock(rw_lock)
+#define BEGIN_WRITE_CODE_BLOCK SnmpSynchronize auto_lock(*this); \
+                               SnmpWriteLock auto_write_lock(rw_lock)
+// The time values of the usmTimeTable entries are changed by lookups,
+// they are protected by one of several locks chosen by the engineID.
+#define BEGIN_STRIPE_CODE_BLOCK(hash) \
+          SnmpSynchronize stripe_lock(stripes[(hash) % USM_TIME_TABLE_STRIPES])
 #else
 #define BEGIN_REENTRANT_CODE_BLOCK
 #define BEGIN_REENTRANT_CODE_BLOCK_CONST
 #define BEGIN_AUTO_LOCK(obj)
+#define BEGIN_READ_CODE_BLOCK
+#define BEGIN_WRITE_CODE_BLOCK
+#define BEGIN_STRIPE_CODE_BLOCK(hash)
 #endif
 
+#define USM_TIME_TABLE_STRIPES 16
+
 #ifndef min
 #define min(a,b) ( (a) < (b) ? (a) : (b) )
 #endif
@@ -104,8 +120,8 @@ public:
   ~USMTimeTable();
 
   /**
-   * Add a new entry to the usmTimeTable. The caller is responsible for
-   * not adding an engineID twice.
+   * Add a new entry to the usmTimeTable. If the engineID is already
+   * in the table, the entry is not changed.
    *
    * @param engine_id    - The engineID of the SNMP entity
    * @param engine_boots - The engine boot counter
@@ -204,10 +220,24 @@ private:
     long int latest_received_time;
   };
 
+  /**
+   * Get the position of the entry for an engineID.
+   *
+   * @param hash - SnmpHashIndex::hash() of the engineID
+   *
+   * @return The position or -1 if the engineID is not in the table
+   */
+  int find_entry(const unsigned char *engine_id, const long engine_id_len,
+                 const unsigned int hash) const;
+
   struct Entry_T *table; ///< Array of entries
   const USM *usm;  ///< Pointer to the USM, this table belongs to
   int max_entries; ///< the maximum number of entries
   int entries;     ///< the current amount of entries
+
+  SnmpHashIndex index;        ///< positions of the entries by engineID
+  SnmpReadWriteLock rw_lock;  ///< lookups read, changes of the table write
+  SnmpSynchronized stripes[USM_TIME_TABLE_STRIPES]; ///< for the time values
 };
 
 
@@ -342,10 +372,19 @@ public:
   const UsmUserNameTableEntry *peek_next(const UsmUserNameTableEntry *e) const;
 
 private:
+  int find_user_name(const unsigned char *user_name,
+                     const long int user_name_len) const;
+  int find_security_name(const unsigned char *security_name,
+                         const long int security_name_len) const;
+
   struct UsmUserNameTableEntry *table;
 
   int max_entries; ///< the maximum number of entries
   int entries;     ///< the current amount of entries
+
+  SnmpHashIndex user_name_index;     ///< positions by userName
+  SnmpHashIndex security_name_index; ///< positions by securityName
+  SnmpReadWriteLock rw_lock;         ///< lookups vs. changes
 };
 
 
@@ -357,7 +396,13 @@ private:
 class USMUserTable : public SnmpSynchronized
 {
 public:
-  USMUserTable(int &result);
+  /**
+   * Create the table.
+   *
+   * @param ap     - Used to prepare the authentication keys of the users
+   * @param result - SNMPv3_USM_OK or SNMPv3_USM_ERROR (no memory)
+   */
+  USMUserTable(AuthPriv *ap, int &result);
 
   ~USMUserTable();
 
@@ -551,6 +596,24 @@ public:
    */
   int load_from_file(const char *name, AuthPriv *ap);
 
+  /**
+   * Load the users of a user store file and append all further
+   * changes of the table to its journal.
+   *
+   * @see USM::open_localized_user_store()
+   */
+  int open_store(const char *name);
+
+  /**
+   * Write a new snapshot of the table to the user store file.
+   */
+  int compact_store();
+
+  /**
+   * Stop appending changes to the user store file.
+   */
+  void close_store();
+
   const UsmUserTableEntry *peek_first() const
     { if (entries > 0) return table; return 0; };
 
@@ -559,10 +622,102 @@ public:
 private:
   void delete_entry(const int nr);
 
+  /**
+   * Make room for count entries in the table and in the indexes.
+   * The table has to be locked by the caller.
+   */
+  bool reserve(const int count);
+
+  /**
+   * Delete a field of an entry, unless it points into the store.
+   */
+  void free_field(unsigned char *field, const long len) const;
+
+  /**
+   * Delete the fields and prepared keys of an entry.
+   */
+  void free_entry(struct UsmUserTableEntry &e) const;
+
+  /**
+   * Add or delete the user of a store record, the fields of the entry
+   * point into the store. The table has to be locked by the caller.
+   */
+  int add_store_record(const UsmStoreRecord *record);
+
+  /**
+   * Add the users of the snapshot to the empty table and load or
+   * compute the indexes. The table has to be locked by the caller.
+   *
+   * @return false if a user has an unknown protocol, the users
+   *         before it are in the table
+   */
+  bool load_snapshot();
+
+  /**
+   * Check that the protocols of the entry are known.
+   */
+  bool check_protocols(const int nr) const;
+
+  /**
+   * Replace the indexes by the ones saved in the store, they have to
+   * match the entries of the table. The table has to be locked by the
+   * caller.
+   */
+  bool load_index();
+
+  /**
+   * Compute the indexes for all entries of the table. The table has
+   * to be locked by the caller.
+   */
+  void rebuild_index();
+
+  /**
+   * Append a record for the entry at position nr to the journal of
+   * the store. The table has to be locked by the caller.
+   */
+  void journal(const UsmUserStore::RecordType type, const int nr);
+
+  int compact_store_locked();
+  void close_store_locked();
+
+  /**
+   * Replace the prepared authentication key of the entry at
+   * position nr, it is left empty if the auth protocol does not
+   * support prepared keys. The table has to be locked by the caller.
+   */
+  void prepare_auth_key(const int nr);
+
+  /**
+   * Replace the prepared privacy key of the entry at position nr,
+   * it is left empty if the priv protocol does not support prepared
+   * keys. The table has to be locked by the caller.
+   */
+  void prepare_priv_key(const int nr);
+
+  void add_to_index(const int nr);
+  void remove_from_index(const int nr);
+  int find_entry(const unsigned char *engine_id, const long engine_id_len,
+                 const unsigned char *sec_name, const long sec_name_len) const;
+  int find_user(const unsigned char *engine_id, const long engine_id_len,
+                const unsigned char *user_name, const long user_name_len) const;
+  int find_user_name(const unsigned char *user_name,
+                     const long user_name_len) const;
+  int find_security_name(const unsigned char *sec_name,
+                         const long sec_name_len) const;
+
   struct UsmUserTableEntry *table;
 
   int max_entries; ///< the maximum number of entries
   int entries;     ///< the current amount of entries
+
+  SnmpHashIndex engine_sec_index;    ///< positions by engineID and secName
+  SnmpHashIndex engine_user_index;   ///< positions by engineID and userName
+  SnmpHashIndex user_name_index;     ///< positions by userName
+  SnmpHashIndex security_name_index; ///< positions by securityName
+  SnmpReadWriteLock rw_lock;         ///< lookups vs. changes
+
+  AuthPriv *auth_priv;               ///< to prepare the auth and priv keys
+  UsmUserStore *store;               ///< file for the changes or NULL
 };
 
 
@@ -593,11 +748,29 @@ struct SecurityStateReference
   int privProtocol;
   unsigned char* privKey;                         int privKeyLength;
   int securityLevel;
+  unsigned char* authPreparedKey;                 int authPreparedKeyLength;
+  unsigned char* privPreparedKey;                 int privPreparedKeyLength;
 };
 
 
 
 
+// Release a prepared privacy key, which may hold resources of the
+// privacy protocol (the EVP context of AES with OpenSSL)
+static void free_priv_prepared_key(AuthPriv       *auth_priv,
+                                   const int       priv_prot,
+                                   unsigned char *&prepared_key,
+                                   const int       prepared_key_len)
+{
+  if (!prepared_key)
+    return;
+  if (auth_priv)
+    auth_priv->clear_prepared_priv_key(priv_prot, prepared_key);
+  memset(prepared_key, 0, prepared_key_len);
+  delete [] prepared_key;
+  prepared_key = 0;
+}
+
 void USM::inc_stats_unsupported_sec_levels()
 {
   if (usmStatsUnsupportedSecLevels == MAXUINT32)
@@ -664,6 +837,13 @@ void USM::delete_sec_state_reference(struct SecurityStateReference *ssr)
       memset(ssr->privKey, 0, ssr->privKeyLength);
       delete [] ssr->privKey;
     }
+    if (ssr->authPreparedKey)
+    {
+      memset(ssr->authPreparedKey, 0, ssr->authPreparedKeyLength);
+      delete [] ssr->authPreparedKey;
+    }
+    free_priv_prepared_key(auth_priv, ssr->privProtocol,
+                           ssr->privPreparedKey, ssr->privPreparedKeyLength);
   }
   delete ssr;
 }
@@ -706,7 +886,7 @@ USM::USM(unsigned int engine_boots, const OctetStr &engine_id,
   if (result != SNMPv3_USM_OK)
     return;
 
-  usm_user_table = new USMUserTable(result);
+  usm_user_table = new USMUserTable(auth_priv, result);
   if (result != SNMPv3_USM_OK)
     return;
 
@@ -1034,7 +1214,7 @@ int USM::remove_all_users() {
   if (result != SNMPv3_USM_OK)
     return result;
 
-  usm_user_table = new USMUserTable(result);
+  usm_user_table = new USMUserTable(auth_priv, result);
   return result;  
 }
 
@@ -1156,6 +1336,227 @@ int USM::add_usm_user(const OctetStr& user_name,
   return res;
 }
 
+/*
+ * The distinct passwords of USM::add_usm_users() and their keys Ku.
+ */
+struct UsmKuBatch
+{
+  int                   count;     // number of distinct passwords
+  long int             *auth_prot; // protocol that generates the key
+  const unsigned char **password;
+  unsigned int         *password_len;
+  unsigned char        *ku;        // SNMPv3_USM_MAX_KEY_LEN per password
+  unsigned int         *ku_len;    // 0 if the key could not be computed
+  SnmpHashIndex         index;
+};
+
+// Get the position of the password in the batch, add it if it is new
+static int usm_ku_batch_add(UsmKuBatch &batch, const long int auth_prot,
+                            const OctetStr &password)
+{
+  unsigned int hash = SnmpHashIndex::hash(password.data(), password.len(),
+                        SnmpHashIndex::hash((const unsigned char *)&auth_prot,
+                                            sizeof(auth_prot)));
+  unsigned long cursor;
+
+  for (int pos = batch.index.first(hash, cursor); pos >= 0;
+       pos = batch.index.next(hash, cursor))
+    if ((batch.auth_prot[pos] == auth_prot) &&
+        (batch.password_len[pos] == password.len()) &&
+        (memcmp(batch.password[pos], password.data(), password.len()) == 0))
+      return pos;
+
+  int pos = batch.count++;
+  batch.auth_prot[pos] = auth_prot;
+  batch.password[pos] = password.data();
+  batch.password_len[pos] = password.len();
+  batch.ku_len[pos] = 0;
+  batch.index.add(hash, pos);
+  return pos;
+}
+
+int USM::add_usm_users(const struct UsmUserBatchEntry *users,
+                       const int count,
+                       const int threads)
+{
+  if (count <= 0)
+    return SNMPv3_USM_OK;
+
+  UsmKuBatch batch;
+  batch.count = 0;
+  batch.auth_prot = new long int[2 * count];
+  batch.password = new const unsigned char*[2 * count];
+  batch.password_len = new unsigned int[2 * count];
+  batch.ku = new unsigned char[2 * count * SNMPv3_USM_MAX_KEY_LEN];
+  batch.ku_len = new unsigned int[2 * count];
+  int *auth_ku = new int[count];
+  int *priv_ku = new int[count];
+  int i;
+
+  if (!batch.auth_prot || !batch.password || !batch.password_len ||
+      !batch.ku || !batch.ku_len || !auth_ku || !priv_ku ||
+      !batch.index.reserve(2 * count))
+  {
+    delete [] batch.auth_prot;
+    delete [] batch.password;
+    delete [] batch.password_len;
+    delete [] batch.ku;
+    delete [] batch.ku_len;
+    delete [] auth_ku;
+    delete [] priv_ku;
+    return SNMPv3_USM_ERROR;
+  }
+
+  /* the privacy password is expanded by the auth protocol, too */
+  for (i = 0; i < count; ++i)
+  {
+    const UsmUserBatchEntry &user = users[i];
+
+    auth_ku[i] = priv_ku[i] = -1;
+    if ((user.authProtocol != SNMP_AUTHPROTOCOL_NONE) &&
+        (user.authPassword.len() > 0))
+      auth_ku[i] = usm_ku_batch_add(batch, user.authProtocol,
+                                    user.authPassword);
+    if ((user.privProtocol != SNMP_PRIVPROTOCOL_NONE) &&
+        (user.privPassword.len() > 0))
+      priv_ku[i] = usm_ku_batch_add(batch, user.authProtocol,
+                                    user.privPassword);
+  }
+
+  /* compute the keys Ku, all passwords of one protocol at once */
+  const unsigned char **passwords = new const unsigned char*[batch.count];
+  unsigned int *password_lens = new unsigned int[batch.count];
+  int *positions = new int[batch.count];
+  bool *done = new bool[batch.count];
+  unsigned char *kus = new unsigned char[batch.count * SNMPv3_USM_MAX_KEY_LEN];
+
+  if (passwords && password_lens && positions && done && kus)
+  {
+    for (i = 0; i < batch.count; ++i)
+      done[i] = false;
+
+    for (i = 0; i < batch.count; ++i)
+    {
+      if (done[i])
+        continue;
+
+      int n = 0;
+      for (int j = i; j < batch.count; ++j)
+        if (!done[j] && (batch.auth_prot[j] == batch.auth_prot[i]))
+        {
+          passwords[n] = batch.password[j];
+          password_lens[n] = batch.password_len[j];
+          positions[n++] = j;
+          done[j] = true;
+        }
+
+      unsigned int ku_len;
+      if (auth_priv->passwords_to_ku(batch.auth_prot[i], n,
+                                     passwords, password_lens,
+                                     kus, &ku_len,
+                                     threads) != SNMPv3_USM_OK)
+        continue; // add_usm_user() will report the error
+
+      for (int k = 0; k < n; ++k)
+      {
+        memcpy(batch.ku + positions[k] * SNMPv3_USM_MAX_KEY_LEN,
+               kus + k * SNMPv3_USM_MAX_KEY_LEN, ku_len);
+        batch.ku_len[positions[k]] = ku_len;
+      }
+    }
+    memset(kus, 0, batch.count * SNMPv3_USM_MAX_KEY_LEN);
+  }
+  delete [] passwords;
+  delete [] password_lens;
+  delete [] positions;
+  delete [] done;
+  delete [] kus;
+
+  /* localize the keys and add the users */
+  OctetStr auth_key;
+  OctetStr priv_key;
+  int result = SNMPv3_USM_OK;
+
+  for (i = 0; i < count; ++i)
+  {
+    const UsmUserBatchEntry &user = users[i];
+    int a = auth_ku[i];
+    int p = priv_ku[i];
+    int res;
+
+    if ((user.authProtocol != SNMP_AUTHPROTOCOL_NONE) &&
+        ((a < 0) || (batch.ku_len[a] == 0)))
+      a = -2;
+    if ((user.privProtocol != SNMP_PRIVPROTOCOL_NONE) &&
+        ((p < 0) || (batch.ku_len[p] == 0)))
+      p = -2;
+
+    if ((a == -2) || (p == -2))
+    {
+      /* no key Ku: let add_usm_user() handle (and log) the error */
+      res = add_usm_user(user.usmUserName, user.securityName,
+                         user.authProtocol, user.privProtocol,
+                         user.authPassword, user.privPassword,
+                         user.engineID);
+    }
+    else
+    {
+      auth_key.set_len(SNMPv3_USM_MAX_KEY_LEN);
+      priv_key.set_len(SNMPv3_USM_MAX_KEY_LEN);
+
+      unsigned int auth_key_len = auth_key.len();
+      unsigned int priv_key_len = priv_key.len();
+
+      res = auth_priv->localize_key_auth(user.authProtocol,
+                         (a < 0) ? 0 : batch.ku + a * SNMPv3_USM_MAX_KEY_LEN,
+                         (a < 0) ? 0 : batch.ku_len[a],
+                         user.engineID.data(), user.engineID.len(),
+                         auth_key.data(), &auth_key_len);
+      if (res == SNMPv3_USM_OK)
+        res = auth_priv->localize_key_priv(user.authProtocol,
+                         user.privProtocol,
+                         (p < 0) ? 0 : batch.ku + p * SNMPv3_USM_MAX_KEY_LEN,
+                         (p < 0) ? 0 : batch.ku_len[p],
+                         user.privPassword.data(), user.privPassword.len(),
+                         user.engineID.data(), user.engineID.len(),
+                         priv_key.data(), &priv_key_len);
+      if (res == SNMPv3_USM_OK)
+      {
+        auth_key.set_len(auth_key_len);
+        priv_key.set_len(priv_key_len);
+
+        res = usm_user_table->add_entry(user.engineID, user.usmUserName,
+                                        user.securityName,
+                                        user.authProtocol, auth_key,
+                                        user.privProtocol, priv_key);
+      }
+      else
+      {
+        LOG_BEGIN(loggerModuleName, ERROR_LOG | 4);
+        LOG("Could not localize keys, error code");
+        LOG(res);
+        LOG_END;
+      }
+      auth_key.clear();
+      priv_key.clear();
+    }
+
+    if ((res != SNMPv3_USM_OK) && (result == SNMPv3_USM_OK))
+      result = res;
+  }
+
+  memset(batch.ku, 0, 2 * count * SNMPv3_USM_MAX_KEY_LEN);
+  delete [] batch.auth_prot;
+  delete [] batch.password;
+  delete [] batch.password_len;
+  delete [] batch.ku;
+  delete [] batch.ku_len;
+  delete [] auth_ku;
+  delete [] priv_ku;
+
+  return result;
+}
+
 int USM::add_usm_user(const OctetStr& security_name,
 		      const long int  auth_protocol,
 		      const long int  priv_protocol,
@@ -1287,6 +1688,8 @@ struct UsmUser *USM::get_user(const OctetStr &engine_id,
         res->authKey = 0;        res->authKeyLength = 0;
         res->privProtocol = SNMP_PRIVPROTOCOL_NONE;
         res->privKey = 0;        res->privKeyLength = 0;
+        res->authPreparedKey = 0; res->authPreparedKeyLength = 0;
+        res->privPreparedKey = 0; res->privPreparedKeyLength = 0;
 
 	if ((res->usmUserNameLength  && !res->usmUserName) ||
 	    (res->securityNameLength && !res->securityName))
@@ -1326,6 +1729,10 @@ struct UsmUser *USM::get_user(const OctetStr &engine_id,
       res->privProtocol       = SNMP_PRIVPROTOCOL_NONE;
       res->privKey            = 0;
       res->privKeyLength      = 0;
+      res->authPreparedKey    = 0;
+      res->authPreparedKeyLength = 0;
+      res->privPreparedKey    = 0;
+      res->privPreparedKeyLength = 0;
 
       if ((res->usmUserNameLength  && !res->usmUserName) ||
 	  (res->securityNameLength && !res->securityName))
@@ -1419,12 +1826,18 @@ struct UsmUser *USM::get_user(const OctetStr &engine_id,
   res->privProtocol       = user_table_entry->usmUserPrivProtocol;
   res->privKey            = user_table_entry->usmUserPrivKey;
   res->privKeyLength      = user_table_entry->usmUserPrivKeyLength;
+  res->authPreparedKey    = user_table_entry->usmUserAuthPreparedKey;
+  res->authPreparedKeyLength = user_table_entry->usmUserAuthPreparedKeyLength;
+  res->privPreparedKey    = user_table_entry->usmUserPrivPreparedKey;
+  res->privPreparedKeyLength = user_table_entry->usmUserPrivPreparedKeyLength;
 
   user_table_entry->usmUserEngineID = 0;
   user_table_entry->usmUserName = 0;
   user_table_entry->usmUserSecurityName = 0;
   user_table_entry->usmUserAuthKey = 0;
   user_table_entry->usmUserPrivKey = 0;
+  user_table_entry->usmUserAuthPreparedKey = 0;
+  user_table_entry->usmUserPrivPreparedKey = 0;
 
   usm_user_table->delete_cloned_entry(user_table_entry);
 
@@ -1452,6 +1865,15 @@ void USM::free_user(struct UsmUser *&user)
     delete [] user->privKey;
   }
 
+  if (user->authPreparedKey)
+  {
+    memset(user->authPreparedKey, 0, user->authPreparedKeyLength);
+    delete [] user->authPreparedKey;
+  }
+
+  free_priv_prepared_key(auth_priv, user->privProtocol,
+                         user->privPreparedKey, user->privPreparedKeyLength);
+
   delete user;
 
   user = 0;
@@ -1866,8 +2288,8 @@ int USM::generate_msg(
              unsigned char *wholeMsg,         // OUT complete generated message
              int *wholeMsgLength)             // OUT length of generated message
 {
-  Buffer<unsigned char> buffer(MAX_SNMP_PACKET);
-  Buffer<unsigned char> buffer2(MAX_SNMP_PACKET);
+  MessageBuffer buffer;
+  MessageBuffer buffer2;
   unsigned char *bufPtr = buffer.get_ptr();
   unsigned char *buf2Ptr = buffer2.get_ptr();
 
@@ -1935,6 +2357,10 @@ int USM::generate_msg(
     user->privProtocol       = securityStateReference->privProtocol;
     user->privKeyLength      = securityStateReference->privKeyLength;
     user->privKey            = securityStateReference->privKey;
+    user->authPreparedKey    = securityStateReference->authPreparedKey;
+    user->authPreparedKeyLength = securityStateReference->authPreparedKeyLength;
+    user->privPreparedKey    = securityStateReference->privPreparedKey;
+    user->privPreparedKeyLength = securityStateReference->privPreparedKeyLength;
 
     debugprintf(20, "securityStateReference: secName %d, authProt %d, akey %d",
 		securityStateReference->securityNameLength,
@@ -2030,7 +2456,8 @@ int USM::generate_msg(
                                usmSecurityParams.msgPrivacyParameters,
                                &usmSecurityParams.msgPrivacyParametersLength,
                                usmSecurityParams.msgAuthoritativeEngineBoots,
-			       usmSecurityParams.msgAuthoritativeEngineTime);
+			       usmSecurityParams.msgAuthoritativeEngineTime,
+                               user->privPreparedKey);
     if (enc_result != SNMPv3_USM_OK)
     {
       int return_value;
@@ -2113,7 +2540,8 @@ int USM::generate_msg(
     rc = auth_priv->auth_out_msg(user->authProtocol,
                                  user->authKey,
                                  wholeMsg, *wholeMsgLength,
-                                 wholeMsg + startAuthPar);
+                                 wholeMsg + startAuthPar,
+                                 user->authPreparedKey);
 
     if (rc!=SNMPv3_USM_OK)
     {
@@ -2187,8 +2615,9 @@ int USM::process_msg(
   unsigned char privParam[SNMPv3_AP_MAXLENGTH_PRIVPARAM];
   int authParamLength = SNMPv3_AP_MAXLENGTH_AUTHPARAM;
   int privParamLength = SNMPv3_AP_MAXLENGTH_PRIVPARAM;
-  Buffer<unsigned char> encryptedScopedPDU(MAX_SNMP_PACKET);
+  MessageBuffer encryptedScopedPDU;
   int encryptedScopedPDULength = msgDataLength;
+  const int scopedPDUSize = *scopedPDULength; // size of scopedPDU buffer
   struct UsmUser *user = NULL;
   int rc;
   int notInTime = 0;
@@ -2298,6 +2727,8 @@ int USM::process_msg(
   securityStateReference->privProtocol = 1;
   securityStateReference->authKey = NULL;
   securityStateReference->privKey = NULL;
+  securityStateReference->authPreparedKey = NULL;
+  securityStateReference->privPreparedKey = NULL;
 
   // in case we return with error,
   // perhaps v3MP can decode it (requestID!!!)
@@ -2381,7 +2812,8 @@ int USM::process_msg(
                                  user->authKey,
                                  wholeMsg, wholeMsgLength,
                                  wholeMsg + authParametersPosition,
-				 authParamLength);
+				 authParamLength,
+                                 user->authPreparedKey);
     if (rc != SNMPv3_USM_OK)
     {
       switch (rc)
@@ -2414,8 +2846,18 @@ int USM::process_msg(
       securityStateReference->privKeyLength = user->privKeyLength;
       securityStateReference->privKey = user->privKey;
 
+      securityStateReference->authPreparedKeyLength =
+        user->authPreparedKeyLength;
+      securityStateReference->authPreparedKey = user->authPreparedKey;
+
+      securityStateReference->privPreparedKeyLength =
+        user->privPreparedKeyLength;
+      securityStateReference->privPreparedKey = user->privPreparedKey;
+
       user->authKey = 0;
       user->privKey = 0;
+      user->authPreparedKey = 0;
+      user->privPreparedKey = 0;
 
       free_user(user);
       return rc;
@@ -2437,7 +2879,7 @@ int USM::process_msg(
     }
   }
 
-  *scopedPDULength = MAX_SNMP_PACKET;
+  *scopedPDULength = scopedPDUSize;
 
   // decrypt ScopedPDU if message is in time window
   if ((securityLevel == SNMP_SECURITY_LEVEL_AUTH_PRIV)
@@ -2460,7 +2902,8 @@ int USM::process_msg(
 				  encryptedScopedPDULength,
                                   scopedPDU, &tmp_length,
                                   (unsigned char*)&privParam, privParamLength,
-				  engineBoots, engineTime);
+				  engineBoots, engineTime,
+                                  user->privPreparedKey);
     *scopedPDULength = tmp_length;
     if (dec_result != SNMPv3_USM_OK)
     {
@@ -2513,8 +2956,16 @@ int USM::process_msg(
   securityStateReference->privKeyLength = user->privKeyLength;
   securityStateReference->privKey = user->privKey;
 
+  securityStateReference->authPreparedKeyLength = user->authPreparedKeyLength;
+  securityStateReference->authPreparedKey = user->authPreparedKey;
+
+  securityStateReference->privPreparedKeyLength = user->privPreparedKeyLength;
+  securityStateReference->privPreparedKey = user->privPreparedKey;
+
   user->authKey = 0;
   user->privKey = 0;
+  user->authPreparedKey = 0;
+  user->privPreparedKey = 0;
 
   free_user(user);
 
@@ -2528,7 +2979,7 @@ unsigned char *USM::build_sec_params(unsigned char *outBuf, int *maxLength,
 				     struct UsmSecurityParameters sp,
 				     int *position)
 {
-  Buffer<unsigned char> buf(MAX_SNMP_PACKET);
+  MessageBuffer buf;
   unsigned char *bufPtr = buf.get_ptr();
   unsigned char *outBufPtr = outBuf;
   int length = *maxLength;
@@ -2631,9 +3082,9 @@ unsigned char *USM::build_whole_msg(
 			 struct UsmSecurityParameters  securityParameters,
 			 unsigned char *msgData, long int msgDataLength)
 {
-  Buffer<unsigned char> buf(MAX_SNMP_PACKET);
+  MessageBuffer buf;
   unsigned char *bufPtr = buf.get_ptr();
-  Buffer<unsigned char> secPar(MAX_SNMP_PACKET);
+  MessageBuffer secPar;
   unsigned char *secParPtr = secPar.get_ptr();
   unsigned char *outBufPtr = outBuf;
   long int secParLength;
@@ -2743,8 +3194,15 @@ inline void USM::delete_user_ptr(struct UsmUser *user)
   if (user->privKey) {
     memset(user->privKey, 0, user->privKeyLength);
     delete [] user->privKey;
-    user->authKey = NULL;
+    user->privKey = NULL;
+  }
+  if (user->authPreparedKey) {
+    memset(user->authPreparedKey, 0, user->authPreparedKeyLength);
+    delete [] user->authPreparedKey;
+    user->authPreparedKey = NULL;
   }
+  free_priv_prepared_key(auth_priv, user->privProtocol,
+                         user->privPreparedKey, user->privPreparedKeyLength);
 }
 
 // Save all localized users into a file.
@@ -2759,6 +3217,24 @@ int USM::load_localized_users(const char *file)
   return usm_user_table->load_from_file(file, auth_priv);
 }
 
+// Load the localized users from a user store and keep it attached.
+int USM::open_localized_user_store(const char *file)
+{
+  return usm_user_table->open_store(file);
+}
+
+// Write a new snapshot of the attached user store.
+int USM::compact_localized_user_store()
+{
+  return usm_user_table->compact_store();
+}
+
+// Detach the user store.
+void USM::close_localized_user_store()
+{
+  usm_user_table->close_store();
+}
+
 // Safe all users with their passwords into a file.
 int USM::save_users(const char *file)
 {
@@ -2829,7 +3305,7 @@ USMTimeTable::USMTimeTable(const USM *owner,
 
   table = new struct Entry_T[5];
 
-  if (!table)
+  if (!table || !index.reserve(5))
   {
     LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
     LOG("USMTimeTable: error constructing table.");
@@ -2850,6 +3326,8 @@ USMTimeTable::USMTimeTable(const USM *owner,
 			       MAXLENGTH_ENGINEID);
   memcpy(table[0].engine_id, usm->get_local_engine_id().data(),
 	 table[0].engine_id_len);
+  index.add(SnmpHashIndex::hash(table[0].engine_id, table[0].engine_id_len),
+            0);
 
   entries = 1;
   max_entries = 5;
@@ -2868,6 +3346,21 @@ USMTimeTable::~USMTimeTable()
   max_entries = 0;
 }
 
+int USMTimeTable::find_entry(const unsigned char *engine_id,
+                             const long engine_id_len,
+                             const unsigned int hash) const
+{
+  /* Table is locked through caller */
+  unsigned long cursor;
+
+  for (int i = index.first(hash, cursor); i >= 0;
+       i = index.next(hash, cursor))
+    if (unsignedCharCompare(table[i].engine_id, table[i].engine_id_len,
+                            engine_id, engine_id_len))
+      return i;
+  return -1;
+}
+
 int USMTimeTable::add_entry(const OctetStr &engine_id,
                             const long int engine_boots,
                             const long int engine_time)
@@ -2882,7 +3375,14 @@ int USMTimeTable::add_entry(const OctetStr &engine_id,
   LOG(engine_time);
   LOG_END;
 
-  BEGIN_REENTRANT_CODE_BLOCK;
+  int len = min(engine_id.len(), MAXLENGTH_ENGINEID);
+  unsigned int hash = SnmpHashIndex::hash(engine_id.data(), len);
+
+  BEGIN_WRITE_CODE_BLOCK;
+
+  /* another thread may have added the engine id after our lookup */
+  if (find_entry(engine_id.data(), len, hash) >= 0)
+    return SNMPv3_USM_OK;
 
   if (entries == max_entries)
   {
@@ -2901,17 +3401,18 @@ int USMTimeTable::add_entry(const OctetStr &engine_id,
     max_entries *= 4;
   }
 
+  if (!index.reserve(entries + 1))
+    return SNMPv3_USM_ERROR;
+
   time_t now;
   time(&now);
 
   table[entries].engine_boots = engine_boots;
   table[entries].latest_received_time = engine_time;
   table[entries].time_diff = engine_time - SAFE_ULONG_CAST(now);
-  table[entries].engine_id_len = engine_id.len();
-  table[entries].engine_id_len = min(table[entries].engine_id_len,
-                                     MAXLENGTH_ENGINEID);
-  memcpy(table[entries].engine_id,
-	 engine_id.data(), table[entries].engine_id_len);
+  table[entries].engine_id_len = len;
+  memcpy(table[entries].engine_id, engine_id.data(), len);
+  index.add(hash, entries);
 
   entries++;
 
@@ -2929,19 +3430,24 @@ int USMTimeTable::delete_entry(const OctetStr &engine_id)
   LOG(engine_id.get_printable());
   LOG_END;
 
-  BEGIN_REENTRANT_CODE_BLOCK;
+  unsigned int hash = SnmpHashIndex::hash(engine_id.data(), engine_id.len());
 
-  for (int i=1; i < entries; i++) /* start from 1 */
-    if (unsignedCharCompare(table[i].engine_id, table[i].engine_id_len,
-                            engine_id.data(), engine_id.len()))
-    {
-      if (i != entries - 1)
-	table[i] = table[entries - 1];
+  BEGIN_WRITE_CODE_BLOCK;
 
-      entries--;
+  int i = find_entry(engine_id.data(), engine_id.len(), hash);
+  if (i < 1) /* the local engine id is never deleted */
+    return SNMPv3_USM_OK;
 
-      return SNMPv3_USM_OK;
-    }
+  index.remove(hash, i);
+  if (i != entries - 1)
+  {
+    index.move(SnmpHashIndex::hash(table[entries - 1].engine_id,
+                                   table[entries - 1].engine_id_len),
+               entries - 1, i);
+    table[i] = table[entries - 1];
+  }
+
+  entries--;
 
   return SNMPv3_USM_OK;
 }
@@ -2951,7 +3457,7 @@ unsigned long USMTimeTable::get_local_time()
   if (!table)
     return 0;
 
-  BEGIN_REENTRANT_CODE_BLOCK;
+  BEGIN_READ_CODE_BLOCK;
 
   time_t now;
   time(&now);
@@ -2965,13 +3471,15 @@ int USMTimeTable::get_local_time(long int &engine_boots,
   if (!table)
     return SNMPv3_USM_ERROR;
 
-  BEGIN_REENTRANT_CODE_BLOCK;
+  {
+    BEGIN_READ_CODE_BLOCK;
 
-  time_t now;
-  time(&now);
+    time_t now;
+    time(&now);
 
-  engine_boots = table[0].engine_boots;
-  engine_time  = table[0].time_diff + SAFE_ULONG_CAST(now);
+    engine_boots = table[0].engine_boots;
+    engine_time  = table[0].time_diff + SAFE_ULONG_CAST(now);
+  }
 
   LOG_BEGIN(loggerModuleName, DEBUG_LOG | 11);
   LOG("USMTimeTable: returning local time (boots) (time)");
@@ -2988,28 +3496,37 @@ int USMTimeTable::get_time(const OctetStr &engine_id,
   if (!table)
     return SNMPv3_USM_ERROR;
 
-  BEGIN_REENTRANT_CODE_BLOCK;
+  unsigned int hash = SnmpHashIndex::hash(engine_id.data(), engine_id.len());
+  int i;
+
+  {
+    BEGIN_READ_CODE_BLOCK;
 
-  for (int i=0; i < entries; i++)
-    if (unsignedCharCompare(table[i].engine_id, table[i].engine_id_len,
-                            engine_id.data(), engine_id.len()))
+    i = find_entry(engine_id.data(), engine_id.len(), hash);
+    if (i >= 0)
     {
       /* Entry found */
+      BEGIN_STRIPE_CODE_BLOCK(hash);
+
       time_t now;
       time(&now);
 
       engine_boots = table[i].engine_boots;
       engine_time  = table[i].time_diff + SAFE_ULONG_CAST(now);
+    }
+  }
 
-      LOG_BEGIN(loggerModuleName, INFO_LOG | 4);
-      LOG("USMTimeTable: Returning time (engine id) (boot) (time)");
-      LOG(engine_id.get_printable());
-      LOG(engine_boots);
-      LOG(engine_time);
-      LOG_END;
+  if (i >= 0)
+  {
+    LOG_BEGIN(loggerModuleName, INFO_LOG | 4);
+    LOG("USMTimeTable: Returning time (engine id) (boot) (time)");
+    LOG(engine_id.get_printable());
+    LOG(engine_boots);
+    LOG(engine_time);
+    LOG_END;
 
-      return SNMPv3_USM_OK;
-    }
+    return SNMPv3_USM_OK;
+  }
 
   /* no entry */
   engine_boots = 0;
@@ -3031,15 +3548,16 @@ int USMTimeTable::check_time(const OctetStr &engine_id,
   if (!table)
     return SNMPv3_USM_ERROR;
 
-  BEGIN_REENTRANT_CODE_BLOCK;
+  BEGIN_READ_CODE_BLOCK;
 
   time_t now;
-  time(&now);
 
   /* table[0] contains the local engine_id and time */
   if (unsignedCharCompare(table[0].engine_id, table[0].engine_id_len,
                           engine_id.data(), engine_id.len()))
   {
+    time(&now);
+
     /* Entry found, we are authoritative */
     if ((table[0].engine_boots == 2147483647) ||
         (table[0].engine_boots != engine_boots) ||
@@ -3065,43 +3583,48 @@ int USMTimeTable::check_time(const OctetStr &engine_id,
     }
   }
 
-  for (int i=1; i < entries; i++)
-    if (unsignedCharCompare(table[i].engine_id, table[i].engine_id_len,
-                            engine_id.data(), engine_id.len()))
+  unsigned int hash = SnmpHashIndex::hash(engine_id.data(), engine_id.len());
+  int i = find_entry(engine_id.data(), engine_id.len(), hash);
+
+  if (i > 0)
+  {
+    /* Entry found we are not authoritative */
+    BEGIN_STRIPE_CODE_BLOCK(hash);
+
+    time(&now);
+
+    if ((engine_boots < table[i].engine_boots) ||
+        ((engine_boots == table[i].engine_boots) &&
+         (table[i].time_diff + now > engine_time + 150)) ||
+        (table[i].engine_boots == 2147483647))
+    {
+      LOG_BEGIN(loggerModuleName, DEBUG_LOG | 9);
+      LOG("USMTimeTable: Check time failed, not authoritative (id)");
+      LOG(engine_id.get_printable());
+      LOG_END;
+
+      return SNMPv3_USM_NOT_IN_TIME_WINDOW;
+    }
+    else
     {
-      /* Entry found we are not authoritative */
-      if ((engine_boots < table[i].engine_boots) ||
+      if ((engine_boots > table[i].engine_boots) ||
           ((engine_boots == table[i].engine_boots) &&
-           (table[i].time_diff + now > engine_time + 150)) ||
-          (table[i].engine_boots == 2147483647))
+           (engine_time > table[i].latest_received_time)))
       {
-	LOG_BEGIN(loggerModuleName, DEBUG_LOG | 9);
-	LOG("USMTimeTable: Check time failed, not authoritative (id)");
-	LOG(engine_id.get_printable());
-	LOG_END;
-
-        return SNMPv3_USM_NOT_IN_TIME_WINDOW;
+        /* time ok, update values */
+        table[i].engine_boots = engine_boots;
+        table[i].latest_received_time  = engine_time;
+        table[i].time_diff = engine_time - SAFE_ULONG_CAST(now);
       }
-      else
-      {
-        if ((engine_boots > table[i].engine_boots) ||
-            ((engine_boots == table[i].engine_boots) &&
-             (engine_time > table[i].latest_received_time)))
-        {
-          /* time ok, update values */
-          table[i].engine_boots = engine_boots;
-          table[i].latest_received_time  = engine_time;
-          table[i].time_diff = engine_time - SAFE_ULONG_CAST(now);
-        }
 
-	LOG_BEGIN(loggerModuleName, DEBUG_LOG | 9);
-	LOG("USMTimeTable: Check time ok, not authoritative, updated (id)");
-	LOG(engine_id.get_printable());
-	LOG_END;
+      LOG_BEGIN(loggerModuleName, DEBUG_LOG | 9);
+      LOG("USMTimeTable: Check time ok, not authoritative, updated (id)");
+      LOG(engine_id.get_printable());
+      LOG_END;
 
-        return SNMPv3_USM_OK;
-      }
+      return SNMPv3_USM_OK;
     }
+  }
 
   LOG_BEGIN(loggerModuleName, DEBUG_LOG | 9);
   LOG("USMTimeTable: Check time, engine id not found");
@@ -3119,12 +3642,12 @@ int USMTimeTable::check_engine_id(const OctetStr &engine_id)
 
   {
     // Begin reentrant code block
-    BEGIN_REENTRANT_CODE_BLOCK;
+    BEGIN_READ_CODE_BLOCK;
 
-    for (int i=0; i < entries; i++)
-      if (unsignedCharCompare(table[i].engine_id, table[i].engine_id_len,
-			      engine_id.data(), engine_id.len()))
-	return SNMPv3_USM_OK;
+    if (find_entry(engine_id.data(), engine_id.len(),
+                   SnmpHashIndex::hash(engine_id.data(),
+                                       engine_id.len())) >= 0)
+      return SNMPv3_USM_OK;
   }
 
   /* if in discovery mode:  accept all EngineID's (rfc2264 page 26) */
@@ -3192,21 +3715,23 @@ int USMUserNameTable::add_entry(const OctetStr& user_name,
   if (!table)
     return SNMPv3_USM_ERROR;
 
-  BEGIN_REENTRANT_CODE_BLOCK;
+  BEGIN_WRITE_CODE_BLOCK;
 
-  int found=0;
-  int i;
-  for (i = 0; i < entries; i++)
-    if (table[i].usmUserName == user_name)
-    {
-      found=1;
-      break;
-    }
+  int i = find_user_name(user_name.data(), user_name.len());
 
-  if (found)
+  if (i >= 0)
   {
     /* replace user */
+    security_name_index.remove(
+        SnmpHashIndex::hash(table[i].usmUserSecurityName.data(),
+                            table[i].usmUserSecurityName.len()), i);
     table[i].usmUserSecurityName = security_name;
+    int same = find_security_name(security_name.data(), security_name.len());
+    if (same >= 0)
+      security_name_index.add_same(same, i);
+    else
+      security_name_index.add(SnmpHashIndex::hash(security_name.data(),
+                                                  security_name.len()), i);
     table[i].usmUserAuthProtocol = auth_proto;
     table[i].usmUserPrivProtocol = priv_proto;
 
@@ -3228,6 +3753,10 @@ int USMUserNameTable::add_entry(const OctetStr& user_name,
   }
   else
   {
+    if (!user_name_index.reserve(entries + 1) ||
+        !security_name_index.reserve(entries + 1))
+      return SNMPv3_USM_ERROR;
+
     if (entries == max_entries)
     {
       /* resize Table */
@@ -3260,6 +3789,15 @@ int USMUserNameTable::add_entry(const OctetStr& user_name,
     if (!table[entries].privPassword)
       return SNMPv3_USM_ERROR;
 
+    user_name_index.add(SnmpHashIndex::hash(user_name.data(),
+                                            user_name.len()), entries);
+    int same = find_security_name(security_name.data(), security_name.len());
+    if (same >= 0)
+      security_name_index.add_same(same, entries);
+    else
+      security_name_index.add(SnmpHashIndex::hash(security_name.data(),
+                                                  security_name.len()),
+                              entries);
     entries++;
   }
 
@@ -3271,38 +3809,79 @@ int USMUserNameTable::delete_security_name(const OctetStr& security_name)
   if (!table)
     return SNMPv3_USM_ERROR;
 
-  BEGIN_REENTRANT_CODE_BLOCK;
+  BEGIN_WRITE_CODE_BLOCK;
 
-  for (int i = 0; i < entries; i++)
-    if (table[i].usmUserSecurityName == security_name)
+  int i = find_security_name(security_name.data(), security_name.len());
+  if (i >= 0)
+  {
+    user_name_index.remove(SnmpHashIndex::hash(table[i].usmUserName.data(),
+                                               table[i].usmUserName.len()), i);
+    security_name_index.remove(SnmpHashIndex::hash(security_name.data(),
+                                                   security_name.len()), i);
+    memset(table[i].authPassword, 0, table[i].authPasswordLength);
+    delete [] table[i].authPassword;
+    memset(table[i].privPassword, 0, table[i].privPasswordLength);
+    delete [] table[i].privPassword;
+    entries--;
+    if (entries > i)
     {
-      memset(table[i].authPassword, 0, table[i].authPasswordLength);
-      delete [] table[i].authPassword;
-      memset(table[i].privPassword, 0, table[i].privPasswordLength);
-      delete [] table[i].privPassword;
-      entries--;
-      if (entries > i)
-        table[i] = table[entries];
-      break;
+      table[i] = table[entries];
+      user_name_index.move(
+          SnmpHashIndex::hash(table[i].usmUserName.data(),
+                              table[i].usmUserName.len()), entries, i);
+      security_name_index.move(
+          SnmpHashIndex::hash(table[i].usmUserSecurityName.data(),
+                              table[i].usmUserSecurityName.len()), entries, i);
     }
+  }
   return SNMPv3_USM_OK;
 }
 
+int USMUserNameTable::find_user_name(const unsigned char *user_name,
+                                     const long int user_name_len) const
+{
+  unsigned int hash = SnmpHashIndex::hash(user_name, user_name_len);
+  unsigned long cursor;
+
+  for (int i = user_name_index.first(hash, cursor); i >= 0;
+       i = user_name_index.next(hash, cursor))
+    if (unsignedCharCompare(table[i].usmUserName.data(),
+                            table[i].usmUserName.len(),
+                            user_name, user_name_len))
+      return i;
+  return -1;
+}
+
+int USMUserNameTable::find_security_name(const unsigned char *security_name,
+                                         const long int security_name_len) const
+{
+  unsigned int hash = SnmpHashIndex::hash(security_name, security_name_len);
+  unsigned long cursor;
+
+  for (int i = security_name_index.first(hash, cursor); i >= 0;
+       i = security_name_index.next(hash, cursor))
+    if (unsignedCharCompare(table[i].usmUserSecurityName.data(),
+                            table[i].usmUserSecurityName.len(),
+                            security_name, security_name_len))
+      return i;
+  return -1;
+}
+
 const struct UsmUserNameTableEntry* USMUserNameTable::get_entry(
                                           const OctetStr &security_name)
 {
   if (!table)
     return NULL;
 
-  for (int i = 0; i < entries; i++)
-    if (table[i].usmUserSecurityName == security_name)
-      return &table[i];
-  return NULL;
+  int i = find_security_name(security_name.data(), security_name.len());
+  if (i < 0)
+    return NULL;
+  return &table[i];
 }
 
 struct UsmUserNameTableEntry* USMUserNameTable::get_cloned_entry(const OctetStr &security_name)
 {
-  lock();
+  BEGIN_READ_CODE_BLOCK;
   const struct UsmUserNameTableEntry *e = get_entry(security_name);
   struct UsmUserNameTableEntry *res = 0;
 
@@ -3329,7 +3908,6 @@ struct UsmUserNameTableEntry* USMUserNameTable::get_cloned_entry(const OctetStr
     }
   }
 
-  unlock();
   return res;
 }
 
@@ -3362,23 +3940,21 @@ int USMUserNameTable::get_security_name(const unsigned char *user_name,
   if (!table)
     return SNMPv3_USM_ERROR;
 
-  BEGIN_REENTRANT_CODE_BLOCK;
+  BEGIN_READ_CODE_BLOCK;
 
-  for (int i = 0; i < entries; i++)
-    if (unsignedCharCompare(table[i].usmUserName.data(),
-			    table[i].usmUserName.len(),
-                            user_name, user_name_len))
-    {
-      security_name = table[i].usmUserSecurityName;
+  int i = find_user_name(user_name, user_name_len);
+  if (i >= 0)
+  {
+    security_name = table[i].usmUserSecurityName;
 
-      LOG_BEGIN(loggerModuleName, INFO_LOG | 9);
-      LOG("USMUserNameTable: Translated (user name) to (security name)");
-      LOG(table[i].usmUserName.get_printable());
-      LOG(security_name.get_printable());
-      LOG_END;
+    LOG_BEGIN(loggerModuleName, INFO_LOG | 9);
+    LOG("USMUserNameTable: Translated (user name) to (security name)");
+    LOG(table[i].usmUserName.get_printable());
+    LOG(security_name.get_printable());
+    LOG_END;
 
-      return SNMPv3_USM_OK;
-    }
+    return SNMPv3_USM_OK;
+  }
 
   if (user_name_len != 0)
   {
@@ -3401,35 +3977,33 @@ int USMUserNameTable::get_user_name(unsigned char *user_name,
   if (!table)
     return SNMPv3_USM_ERROR;
 
-  BEGIN_REENTRANT_CODE_BLOCK;
+  BEGIN_READ_CODE_BLOCK;
 
-  for (int i = 0; i < entries; i++)
-    if (unsignedCharCompare(table[i].usmUserSecurityName.data(),
-                            table[i].usmUserSecurityName.len(),
-                            security_name, security_name_len))
+  int i = find_security_name(security_name, security_name_len);
+  if (i >= 0)
+  {
+    if (buf_len < table[i].usmUserName.len())
     {
-      if (buf_len < table[i].usmUserName.len())
-      {
-          LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
-          LOG("USMUserNameTable: Buffer for user name too small (is) (should)");
-          LOG(buf_len);
-          LOG(table[i].usmUserName.len());
-          LOG_END;
-
-        return SNMPv3_USM_ERROR;
-      }
-      *user_name_len = table[i].usmUserName.len();
-      memcpy(user_name, table[i].usmUserName.data(),
-	     table[i].usmUserName.len());
-
-      LOG_BEGIN(loggerModuleName, INFO_LOG | 9);
-      LOG("USMUserNameTable: Translated (security name) to (user name)");
-      LOG(table[i].usmUserSecurityName.get_printable());
-      LOG(table[i].usmUserName.get_printable());
-      LOG_END;
+	LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
+	LOG("USMUserNameTable: Buffer for user name too small (is) (should)");
+	LOG(buf_len);
+	LOG(table[i].usmUserName.len());
+	LOG_END;
 
-      return SNMPv3_USM_OK;
+      return SNMPv3_USM_ERROR;
     }
+    *user_name_len = table[i].usmUserName.len();
+    memcpy(user_name, table[i].usmUserName.data(),
+	   table[i].usmUserName.len());
+
+    LOG_BEGIN(loggerModuleName, INFO_LOG | 9);
+    LOG("USMUserNameTable: Translated (security name) to (user name)");
+    LOG(table[i].usmUserSecurityName.get_printable());
+    LOG(table[i].usmUserName.get_printable());
+    LOG_END;
+
+    return SNMPv3_USM_OK;
+  }
 
   if (security_name_len != 0)
   {
@@ -3730,7 +4304,11 @@ const UsmUserNameTableEntry *USMUserNameTable::peek_next(
 
 /* ---------------------------- USMUserTable ------------------- */
 
-USMUserTable::USMUserTable(int &result)
+// The journal of a user store is not compacted below this size
+#define USM_STORE_MIN_COMPACT_SIZE 65536
+
+USMUserTable::USMUserTable(AuthPriv *ap, int &result)
+  : auth_priv(ap), store(0)
 {
   entries = 0;
 
@@ -3748,29 +4326,15 @@ USMUserTable::~USMUserTable()
   if (table)
   {
     for (int i = 0; i < entries; i++)
-    {
-      if (table[i].usmUserEngineID)
-	delete [] table[i].usmUserEngineID;
-      if (table[i].usmUserName)
-	delete [] table[i].usmUserName;
-      if (table[i].usmUserSecurityName)
-	delete [] table[i].usmUserSecurityName;
-      if (table[i].usmUserAuthKey)
-      {
-	memset(table[i].usmUserAuthKey, 0, table[i].usmUserAuthKeyLength);
-	delete [] table[i].usmUserAuthKey;
-      }
-      if (table[i].usmUserPrivKey)
-      {
-	memset(table[i].usmUserPrivKey, 0, table[i].usmUserPrivKeyLength);
-	delete [] table[i].usmUserPrivKey;
-      }
-    }
+      free_entry(table[i]);
     delete [] table;
     table = NULL;
     max_entries = 0;
     entries = 0;
   }
+  if (store)
+    delete store;
+  store = 0;
 }
 
 int USMUserTable::get_user_name(unsigned char       *user_name,
@@ -3785,34 +4349,32 @@ int USMUserTable::get_user_name(unsigned char       *user_name,
   if (!table)
     return SNMPv3_USM_ERROR;
 
-  BEGIN_REENTRANT_CODE_BLOCK;
+  BEGIN_READ_CODE_BLOCK;
 
-  for (int i=0; i < entries; i++)
-    if (unsignedCharCompare(table[i].usmUserSecurityName,
-			    table[i].usmUserSecurityNameLength,
-			    sec_name, sec_name_len))
+  int i = find_security_name(sec_name, sec_name_len);
+  if (i >= 0)
+  {
+    if (buf_len < table[i].usmUserNameLength)
     {
-      if (buf_len < table[i].usmUserNameLength)
-      {
-	LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
-	LOG("USMUserTable: Buffer for user name too small (is) (should)");
-	LOG(buf_len);
-	LOG(table[i].usmUserNameLength);
-	LOG_END;
-
-	return SNMPv3_USM_ERROR;
-      }
-      *user_name_len = table[i].usmUserNameLength;
-      memcpy(user_name, table[i].usmUserName, table[i].usmUserNameLength);
-
-      LOG_BEGIN(loggerModuleName, INFO_LOG | 9);
-      LOG("USMUserTable: Translated (security name) to (user name)");
-      LOG(OctetStr(sec_name, sec_name_len).get_printable());
-      LOG(OctetStr(table[i].usmUserName, table[i].usmUserNameLength).get_printable());
+      LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
+      LOG("USMUserTable: Buffer for user name too small (is) (should)");
+      LOG(buf_len);
+      LOG(table[i].usmUserNameLength);
       LOG_END;
 
-      return SNMPv3_USM_OK;
+      return SNMPv3_USM_ERROR;
     }
+    *user_name_len = table[i].usmUserNameLength;
+    memcpy(user_name, table[i].usmUserName, table[i].usmUserNameLength);
+
+    LOG_BEGIN(loggerModuleName, INFO_LOG | 9);
+    LOG("USMUserTable: Translated (security name) to (user name)");
+    LOG(OctetStr(sec_name, sec_name_len).get_printable());
+    LOG(OctetStr(table[i].usmUserName, table[i].usmUserNameLength).get_printable());
+    LOG_END;
+
+    return SNMPv3_USM_OK;
+  }
 
   if (sec_name_len != 0)
   {
@@ -3831,22 +4393,21 @@ int USMUserTable::get_security_name(const unsigned char *user_name,
   if (!table)
     return SNMPv3_USM_ERROR;
 
-  BEGIN_REENTRANT_CODE_BLOCK;
+  BEGIN_READ_CODE_BLOCK;
 
-  for (int i=0; i < entries; i++)
-    if (unsignedCharCompare(table[i].usmUserName, table[i].usmUserNameLength,
-			    user_name, user_name_len))
-    {
-      sec_name.set_data(table[i].usmUserSecurityName,
-			table[i].usmUserSecurityNameLength);
-      LOG_BEGIN(loggerModuleName, INFO_LOG | 9);
-      LOG("USMUserTable: Translated (user name) to (security name)");
-      LOG(OctetStr(table[i].usmUserName, table[i].usmUserNameLength).get_printable());
-      LOG(sec_name.get_printable());
-      LOG_END;
+  int i = find_user_name(user_name, user_name_len);
+  if (i >= 0)
+  {
+    sec_name.set_data(table[i].usmUserSecurityName,
+		      table[i].usmUserSecurityNameLength);
+    LOG_BEGIN(loggerModuleName, INFO_LOG | 9);
+    LOG("USMUserTable: Translated (user name) to (security name)");
+    LOG(OctetStr(table[i].usmUserName, table[i].usmUserNameLength).get_printable());
+    LOG(sec_name.get_printable());
+    LOG_END;
 
-      return SNMPv3_USM_OK;
-    }
+    return SNMPv3_USM_OK;
+  }
 
   int logclass = WARNING_LOG;
   if (user_name_len == 0) logclass = INFO_LOG;
@@ -3863,16 +4424,14 @@ int USMUserTable::delete_entries(const OctetStr& user_name)
   if (!table)
     return SNMPv3_USM_ERROR;
 
-  BEGIN_REENTRANT_CODE_BLOCK;
+  BEGIN_WRITE_CODE_BLOCK;
 
-  for (int i = 0; i < entries; i++)
-    if (unsignedCharCompare(table[i].usmUserName, table[i].usmUserNameLength,
-			    user_name.data(), user_name.len()))
-    {
-      /* delete this entry and recheck this position */
-      delete_entry(i);
-      i--;
-    }
+  int i;
+  while ((i = find_user_name(user_name.data(), user_name.len())) >= 0)
+  {
+    journal(UsmUserStore::DELETE_USER, i);
+    delete_entry(i);
+  }
   return SNMPv3_USM_OK;
 }
 
@@ -3882,7 +4441,7 @@ int USMUserTable::delete_engine_id(const OctetStr& engine_id)
   if (!table)
     return SNMPv3_USM_ERROR;
 
-  BEGIN_REENTRANT_CODE_BLOCK;
+  BEGIN_WRITE_CODE_BLOCK;
 
   for (int i = 0; i < entries; i++)
     if (unsignedCharCompare(table[i].usmUserEngineID,
@@ -3890,6 +4449,7 @@ int USMUserTable::delete_engine_id(const OctetStr& engine_id)
 			    engine_id.data(), engine_id.len()))
     {
       /* delete this entry and recheck this position*/
+      journal(UsmUserStore::DELETE_USER, i);
       delete_entry(i);
       i--;
     }
@@ -3902,19 +4462,15 @@ int USMUserTable::delete_entry(const OctetStr& engine_id,
   if (!table)
     return SNMPv3_USM_ERROR;
 
-  BEGIN_REENTRANT_CODE_BLOCK;
+  BEGIN_WRITE_CODE_BLOCK;
 
-  for (int i = 0; i < entries; i++)
-    if (unsignedCharCompare(table[i].usmUserName, table[i].usmUserNameLength,
-			    user_name.data(), user_name.len()))
-      if (unsignedCharCompare(table[i].usmUserEngineID,
-			      table[i].usmUserEngineIDLength,
-			      engine_id.data(), engine_id.len()))
-      {
-	/* delete this entry and recheck this position*/
-	delete_entry(i);
-	i--;
-      }
+  int i;
+  while ((i = find_user(engine_id.data(), engine_id.len(),
+                        user_name.data(), user_name.len())) >= 0)
+  {
+    journal(UsmUserStore::DELETE_USER, i);
+    delete_entry(i);
+  }
   return SNMPv3_USM_OK;
 }
 
@@ -3932,22 +4488,18 @@ const struct UsmUserTableEntry *USMUserTable::get_entry(const OctetStr &engine_i
   if (!table)
     return NULL;
 
-  for (int i = 0; i < entries; i++)
-    if (unsignedCharCompare(table[i].usmUserSecurityName,
-			    table[i].usmUserSecurityNameLength,
-			    sec_name.data(), sec_name.len()))
-      if (unsignedCharCompare(table[i].usmUserEngineID,
-			      table[i].usmUserEngineIDLength,
-			      engine_id.data(), engine_id.len()))
-	return &table[i];
-  return NULL;
+  int i = find_entry(engine_id.data(), engine_id.len(),
+                     sec_name.data(), sec_name.len());
+  if (i < 0)
+    return NULL;
+  return &table[i];
 }
 
 struct UsmUserTableEntry *USMUserTable::get_cloned_entry(
                                  const OctetStr &engine_id,
 				 const OctetStr &sec_name)
 {
-  lock();
+  BEGIN_READ_CODE_BLOCK;
   const struct UsmUserTableEntry *e = get_entry(engine_id, sec_name);
   struct UsmUserTableEntry *res = 0;
 
@@ -3975,18 +4527,43 @@ struct UsmUserTableEntry *USMUserTable::get_cloned_entry(
     res->usmUserPrivKey        = v3strcpy(e->usmUserPrivKey,
 					  e->usmUserPrivKeyLength);
     res->usmUserPrivKeyLength  = e->usmUserPrivKeyLength;
+    // a missing prepared key must stay NULL, the key is used then
+    res->usmUserAuthPreparedKey = e->usmUserAuthPreparedKey ?
+                  v3strcpy(e->usmUserAuthPreparedKey,
+                           e->usmUserAuthPreparedKeyLength) : 0;
+    res->usmUserAuthPreparedKeyLength = e->usmUserAuthPreparedKeyLength;
+    // the clone gets its own copy of the cipher context of the entry
+    res->usmUserPrivPreparedKey = 0;
+    res->usmUserPrivPreparedKeyLength = 0;
+    if (e->usmUserPrivPreparedKey && auth_priv)
+    {
+      res->usmUserPrivPreparedKey =
+        new unsigned char[e->usmUserPrivPreparedKeyLength];
+      if (auth_priv->copy_prepared_priv_key(e->usmUserPrivProtocol,
+                                            e->usmUserPrivPreparedKey,
+                                            res->usmUserPrivPreparedKey)
+          == SNMPv3_USM_OK)
+        res->usmUserPrivPreparedKeyLength = e->usmUserPrivPreparedKeyLength;
+      else
+      {
+        /* messages of this user are encrypted with the key */
+        delete [] res->usmUserPrivPreparedKey;
+        res->usmUserPrivPreparedKey = 0;
+      }
+    }
 
     if ((res->usmUserEngineIDLength && !res->usmUserEngineID) ||
 	(res->usmUserNameLength && !res->usmUserName) ||
 	(res->usmUserSecurityNameLength && !res->usmUserSecurityName) ||
 	(res->usmUserAuthKeyLength && !res->usmUserAuthKey) ||
-	(res->usmUserPrivKeyLength && !res->usmUserPrivKey))
+	(res->usmUserPrivKeyLength && !res->usmUserPrivKey) ||
+	(res->usmUserAuthPreparedKeyLength && !res->usmUserAuthPreparedKey) ||
+	(res->usmUserPrivPreparedKeyLength && !res->usmUserPrivPreparedKey))
     {
       delete_cloned_entry(res);
     }
   }
 
-  unlock();
   return res;
 }
 
@@ -4010,6 +4587,17 @@ void USMUserTable::delete_cloned_entry(struct UsmUserTableEntry* &entry)
     delete [] entry->usmUserPrivKey;
   }
 
+  if (entry->usmUserAuthPreparedKey)
+  {
+    memset(entry->usmUserAuthPreparedKey, 0,
+           entry->usmUserAuthPreparedKeyLength);
+    delete [] entry->usmUserAuthPreparedKey;
+  }
+
+  free_priv_prepared_key(auth_priv, entry->usmUserPrivProtocol,
+                         entry->usmUserPrivPreparedKey,
+                         entry->usmUserPrivPreparedKeyLength);
+
   delete entry;
 
   entry = 0;
@@ -4021,12 +4609,10 @@ const struct UsmUserTableEntry *USMUserTable::get_entry(const OctetStr &sec_name
   if (!table)
     return NULL;
 
-  for (int i = 0; i < entries; i++)
-    if (unsignedCharCompare(table[i].usmUserSecurityName,
-			    table[i].usmUserSecurityNameLength,
-			    sec_name.data(), sec_name.len()))
-      return &table[i];
-  return NULL;
+  int i = find_security_name(sec_name.data(), sec_name.len());
+  if (i < 0)
+    return NULL;
+  return &table[i];
 }
 
 int USMUserTable::add_entry(
@@ -4046,33 +4632,19 @@ int USMUserTable::add_entry(
   if (!table)
     return SNMPv3_USM_ERROR;
 
-  BEGIN_REENTRANT_CODE_BLOCK;
+  BEGIN_WRITE_CODE_BLOCK;
 
-  if (entries == max_entries)
+  if (!reserve(entries + 1))
+    return SNMPv3_USM_ERROR;
+
+  int i = find_user(engine_id.data(), engine_id.len(),
+                    user_name.data(), user_name.len());
+  if (i >= 0)
   {
-    /* resize Table */
-    struct UsmUserTableEntry *tmp;
-    tmp = new struct UsmUserTableEntry[4 * max_entries];
-    if (!tmp) return SNMPv3_USM_ERROR;
-    for (int i = 0; i < entries; i++)
-      tmp[i] = table[i];
-    delete [] table;
-    table = tmp;
-    max_entries *= 4;
+    /* delete this entry */
+    delete_entry(i);
   }
 
-  for (int i = 0; i < entries; i++)
-    if (unsignedCharCompare(table[i].usmUserName, table[i].usmUserNameLength,
-			    user_name.data(), user_name.len()))
-      if (unsignedCharCompare(table[i].usmUserEngineID,
-			      table[i].usmUserEngineIDLength,
-			      engine_id.data(), engine_id.len()))
-      {
-	/* delete this entry */
-	delete_entry(i);
-	break;
-      }
-
   /* add user at the last position */
   table[entries].usmUserEngineIDLength = engine_id.len();
   table[entries].usmUserEngineID       = v3strcpy(engine_id.data(),
@@ -4091,10 +4663,42 @@ int USMUserTable::add_entry(
   table[entries].usmUserPrivKeyLength  = priv_key.len();
   table[entries].usmUserPrivKey        = v3strcpy(priv_key.data(),
 						  priv_key.len());
+  table[entries].usmUserAuthPreparedKey = 0;
+  table[entries].usmUserPrivPreparedKey = 0;
+  prepare_auth_key(entries);
+  prepare_priv_key(entries);
+  add_to_index(entries);
   entries++;
+  journal(UsmUserStore::ADD_USER, entries - 1);
   return SNMPv3_USM_OK;
 }
 
+bool USMUserTable::reserve(const int count)
+{
+  /* Table is locked through caller */
+  if (count > max_entries)
+  {
+    /* resize Table */
+    int new_max = 4 * max_entries;
+    if (new_max < count)
+      new_max = count;
+
+    struct UsmUserTableEntry *tmp;
+    tmp = new struct UsmUserTableEntry[new_max];
+    if (!tmp) return false;
+    for (int i = 0; i < entries; i++)
+      tmp[i] = table[i];
+    delete [] table;
+    table = tmp;
+    max_entries = new_max;
+  }
+
+  return (engine_sec_index.reserve(count) &&
+          engine_user_index.reserve(count) &&
+          user_name_index.reserve(count) &&
+          security_name_index.reserve(count));
+}
+
 int USMUserTable::update_key(const OctetStr &user_name,
 			     const OctetStr &engine_id,
 			     const OctetStr &new_key,
@@ -4110,59 +4714,50 @@ int USMUserTable::update_key(const OctetStr &user_name,
   if (!table)
     return SNMPv3_USM_ERROR;
 
-  BEGIN_REENTRANT_CODE_BLOCK;
+  BEGIN_WRITE_CODE_BLOCK;
 
-  for (int i = 0; i < entries; i++)
-    if (unsignedCharCompare(table[i].usmUserName, table[i].usmUserNameLength,
-			    user_name.data(), user_name.len()))
-      if (unsignedCharCompare(table[i].usmUserEngineID,
-			      table[i].usmUserEngineIDLength,
-			      engine_id.data(), engine_id.len()))
+  int i = find_user(engine_id.data(), engine_id.len(),
+                    user_name.data(), user_name.len());
+  if (i >= 0)
+  {
+    LOG_BEGIN(loggerModuleName, DEBUG_LOG | 15);
+    LOG("USMUserTable: New key");
+    LOG(new_key.get_printable());
+    LOG_END;
+
+    /* update key: */
+    switch (key_type)
+    {
+      case AUTHKEY:
+      case OWNAUTHKEY:
+      {
+	free_field(table[i].usmUserAuthKey, table[i].usmUserAuthKeyLength);
+	table[i].usmUserAuthKeyLength = new_key.len();
+	table[i].usmUserAuthKey = v3strcpy(new_key.data(), new_key.len());
+	prepare_auth_key(i);
+	journal(UsmUserStore::ADD_USER, i);
+	return SNMPv3_USM_OK;
+      }
+      case PRIVKEY:
+      case OWNPRIVKEY:
       {
-	LOG_BEGIN(loggerModuleName, DEBUG_LOG | 15);
-	LOG("USMUserTable: New key");
-	LOG(new_key.get_printable());
+	free_field(table[i].usmUserPrivKey, table[i].usmUserPrivKeyLength);
+	table[i].usmUserPrivKeyLength = new_key.len();
+	table[i].usmUserPrivKey = v3strcpy(new_key.data(), new_key.len());
+	prepare_priv_key(i);
+	journal(UsmUserStore::ADD_USER, i);
+	return SNMPv3_USM_OK;
+      }
+      default:
+      {
+	LOG_BEGIN(loggerModuleName, WARNING_LOG | 3);
+	LOG("USMUserTable: setting new key failed (wrong type).");
 	LOG_END;
 
-	/* update key: */
-	switch (key_type)
-	{
-	  case AUTHKEY:
-	  case OWNAUTHKEY:
-	  {
-	    if (table[i].usmUserAuthKey)
-	    {
-	      memset(table[i].usmUserAuthKey, 0,
-		     table[i].usmUserAuthKeyLength);
-	      delete [] table[i].usmUserAuthKey;
-	    }
-	    table[i].usmUserAuthKeyLength = new_key.len();
-	    table[i].usmUserAuthKey = v3strcpy(new_key.data(), new_key.len());
-	    return SNMPv3_USM_OK;
-	  }
-	  case PRIVKEY:
-	  case OWNPRIVKEY:
-	  {
-	    if (table[i].usmUserPrivKey)
-	    {
-	      memset(table[i].usmUserPrivKey, 0,
-		     table[i].usmUserPrivKeyLength);
-	      delete [] table[i].usmUserPrivKey;
-	    }
-	    table[i].usmUserPrivKeyLength = new_key.len();
-	    table[i].usmUserPrivKey = v3strcpy(new_key.data(), new_key.len());
-	    return SNMPv3_USM_OK;
-	  }
-	  default:
-	  {
-	    LOG_BEGIN(loggerModuleName, WARNING_LOG | 3);
-	    LOG("USMUserTable: setting new key failed (wrong type).");
-	    LOG_END;
-
-	    return SNMPv3_USM_ERROR;
-	  }
-	}
+	return SNMPv3_USM_ERROR;
       }
+    }
+  }
 
   LOG_BEGIN(loggerModuleName, INFO_LOG | 7);
   LOG("USMUserTable: setting new key failed (user) not found");
@@ -4178,19 +4773,9 @@ void USMUserTable::delete_entry(const int nr)
    * All checks have been made, so dont check again!
    */
 
-  if (table[nr].usmUserEngineID)     delete [] table[nr].usmUserEngineID;
-  if (table[nr].usmUserName)         delete [] table[nr].usmUserName;
-  if (table[nr].usmUserSecurityName) delete [] table[nr].usmUserSecurityName;
-  if (table[nr].usmUserAuthKey)
-  {
-    memset(table[nr].usmUserAuthKey, 0, table[nr].usmUserAuthKeyLength);
-    delete [] table[nr].usmUserAuthKey;
-  }
-  if (table[nr].usmUserPrivKey)
-  {
-    memset(table[nr].usmUserPrivKey, 0, table[nr].usmUserPrivKeyLength);
-    delete [] table[nr].usmUserPrivKey;
-  }
+  remove_from_index(nr);
+
+  free_entry(table[nr]);
 
   /* We have now one entry less */
   entries--;
@@ -4198,8 +4783,215 @@ void USMUserTable::delete_entry(const int nr)
   if (entries > nr)
   {
     /* move the last entry to the deleted position */
+    remove_from_index(entries);
     table[nr] = table[entries];
+    add_to_index(nr);
+  }
+}
+
+void USMUserTable::prepare_auth_key(const int nr)
+{
+  /* Table is locked through caller */
+  struct UsmUserTableEntry &e = table[nr];
+
+  if (e.usmUserAuthPreparedKey)
+  {
+    memset(e.usmUserAuthPreparedKey, 0, e.usmUserAuthPreparedKeyLength);
+    delete [] e.usmUserAuthPreparedKey;
+  }
+  e.usmUserAuthPreparedKey = 0;
+  e.usmUserAuthPreparedKeyLength = 0;
+
+  if (!auth_priv || !e.usmUserAuthKey)
+    return;
+
+  int len = auth_priv->get_prepared_key_len(e.usmUserAuthProtocol);
+  if (len <= 0)
+    return;
+
+  unsigned char *prepared_key = new unsigned char[len];
+  if (!prepared_key)
+    return;
+
+  if (auth_priv->prepare_key(e.usmUserAuthProtocol,
+                             e.usmUserAuthKey, e.usmUserAuthKeyLength,
+                             prepared_key) != SNMPv3_USM_OK)
+  {
+    /* messages of this user are authenticated with the key */
+    delete [] prepared_key;
+    return;
   }
+  e.usmUserAuthPreparedKey = prepared_key;
+  e.usmUserAuthPreparedKeyLength = len;
+}
+
+void USMUserTable::prepare_priv_key(const int nr)
+{
+  /* Table is locked through caller */
+  struct UsmUserTableEntry &e = table[nr];
+
+  free_priv_prepared_key(auth_priv, e.usmUserPrivProtocol,
+                         e.usmUserPrivPreparedKey,
+                         e.usmUserPrivPreparedKeyLength);
+  e.usmUserPrivPreparedKeyLength = 0;
+
+  if (!auth_priv || !e.usmUserPrivKey)
+    return;
+
+  int len = auth_priv->get_prepared_priv_key_len(e.usmUserPrivProtocol);
+  if (len <= 0)
+    return;
+
+  unsigned char *prepared_key = new unsigned char[len];
+  if (!prepared_key)
+    return;
+
+  if (auth_priv->prepare_priv_key(e.usmUserPrivProtocol,
+                                  e.usmUserPrivKey, e.usmUserPrivKeyLength,
+                                  prepared_key) != SNMPv3_USM_OK)
+  {
+    /* messages of this user are encrypted with the key */
+    delete [] prepared_key;
+    return;
+  }
+  e.usmUserPrivPreparedKey = prepared_key;
+  e.usmUserPrivPreparedKeyLength = len;
+}
+
+void USMUserTable::add_to_index(const int nr)
+{
+  /* Table is locked through caller, the indexes have been reserved */
+  const struct UsmUserTableEntry &e = table[nr];
+  int same;
+
+  same = find_entry(e.usmUserEngineID, e.usmUserEngineIDLength,
+                    e.usmUserSecurityName, e.usmUserSecurityNameLength);
+  if (same >= 0)
+    engine_sec_index.add_same(same, nr);
+  else
+    engine_sec_index.add(
+        SnmpHashIndex::hash(e.usmUserSecurityName,
+                            e.usmUserSecurityNameLength,
+                            SnmpHashIndex::hash(e.usmUserEngineID,
+                                                e.usmUserEngineIDLength)),
+        nr);
+
+  same = find_user(e.usmUserEngineID, e.usmUserEngineIDLength,
+                   e.usmUserName, e.usmUserNameLength);
+  if (same >= 0)
+    engine_user_index.add_same(same, nr);
+  else
+    engine_user_index.add(
+        SnmpHashIndex::hash(e.usmUserName, e.usmUserNameLength,
+                            SnmpHashIndex::hash(e.usmUserEngineID,
+                                                e.usmUserEngineIDLength)),
+        nr);
+
+  same = find_user_name(e.usmUserName, e.usmUserNameLength);
+  if (same >= 0)
+    user_name_index.add_same(same, nr);
+  else
+    user_name_index.add(SnmpHashIndex::hash(e.usmUserName,
+                                            e.usmUserNameLength), nr);
+
+  same = find_security_name(e.usmUserSecurityName,
+                            e.usmUserSecurityNameLength);
+  if (same >= 0)
+    security_name_index.add_same(same, nr);
+  else
+    security_name_index.add(SnmpHashIndex::hash(e.usmUserSecurityName,
+                                                e.usmUserSecurityNameLength),
+                            nr);
+}
+
+void USMUserTable::remove_from_index(const int nr)
+{
+  /* Table is locked through caller */
+  const struct UsmUserTableEntry &e = table[nr];
+  unsigned int engine_hash = SnmpHashIndex::hash(e.usmUserEngineID,
+                                                 e.usmUserEngineIDLength);
+
+  engine_sec_index.remove(SnmpHashIndex::hash(e.usmUserSecurityName,
+                                              e.usmUserSecurityNameLength,
+                                              engine_hash), nr);
+  engine_user_index.remove(SnmpHashIndex::hash(e.usmUserName,
+                                               e.usmUserNameLength,
+                                               engine_hash), nr);
+  user_name_index.remove(SnmpHashIndex::hash(e.usmUserName,
+                                             e.usmUserNameLength), nr);
+  security_name_index.remove(SnmpHashIndex::hash(e.usmUserSecurityName,
+                                                 e.usmUserSecurityNameLength),
+                             nr);
+}
+
+int USMUserTable::find_entry(const unsigned char *engine_id,
+                             const long engine_id_len,
+                             const unsigned char *sec_name,
+                             const long sec_name_len) const
+{
+  unsigned int hash = SnmpHashIndex::hash(sec_name, sec_name_len,
+                          SnmpHashIndex::hash(engine_id, engine_id_len));
+  unsigned long cursor;
+
+  for (int i = engine_sec_index.first(hash, cursor); i >= 0;
+       i = engine_sec_index.next(hash, cursor))
+    if (unsignedCharCompare(table[i].usmUserSecurityName,
+			    table[i].usmUserSecurityNameLength,
+			    sec_name, sec_name_len) &&
+        unsignedCharCompare(table[i].usmUserEngineID,
+			    table[i].usmUserEngineIDLength,
+			    engine_id, engine_id_len))
+      return i;
+  return -1;
+}
+
+int USMUserTable::find_user(const unsigned char *engine_id,
+                            const long engine_id_len,
+                            const unsigned char *user_name,
+                            const long user_name_len) const
+{
+  unsigned int hash = SnmpHashIndex::hash(user_name, user_name_len,
+                          SnmpHashIndex::hash(engine_id, engine_id_len));
+  unsigned long cursor;
+
+  for (int i = engine_user_index.first(hash, cursor); i >= 0;
+       i = engine_user_index.next(hash, cursor))
+    if (unsignedCharCompare(table[i].usmUserName, table[i].usmUserNameLength,
+			    user_name, user_name_len) &&
+        unsignedCharCompare(table[i].usmUserEngineID,
+			    table[i].usmUserEngineIDLength,
+			    engine_id, engine_id_len))
+      return i;
+  return -1;
+}
+
+int USMUserTable::find_user_name(const unsigned char *user_name,
+                                 const long user_name_len) const
+{
+  unsigned int hash = SnmpHashIndex::hash(user_name, user_name_len);
+  unsigned long cursor;
+
+  for (int i = user_name_index.first(hash, cursor); i >= 0;
+       i = user_name_index.next(hash, cursor))
+    if (unsignedCharCompare(table[i].usmUserName, table[i].usmUserNameLength,
+			    user_name, user_name_len))
+      return i;
+  return -1;
+}
+
+int USMUserTable::find_security_name(const unsigned char *sec_name,
+                                     const long sec_name_len) const
+{
+  unsigned int hash = SnmpHashIndex::hash(sec_name, sec_name_len);
+  unsigned long cursor;
+
+  for (int i = security_name_index.first(hash, cursor); i >= 0;
+       i = security_name_index.next(hash, cursor))
+    if (unsignedCharCompare(table[i].usmUserSecurityName,
+			    table[i].usmUserSecurityNameLength,
+			    sec_name, sec_name_len))
+      return i;
+  return -1;
 }
 
 // Save all entries into a file.
@@ -4495,6 +5287,398 @@ int USMUserTable::load_from_file(const char *name, AuthPriv *ap)
   return SNMPv3_USM_OK;
 }
 
+// Load the users of a user store and attach the store to the table.
+int USMUserTable::open_store(const char *name)
+{
+  if (!table || !name)
+    return SNMPv3_USM_ERROR;
+
+  LOG_BEGIN(loggerModuleName, INFO_LOG | 4);
+  LOG("USMUserTable: Opening user store");
+  LOG(name);
+  LOG_END;
+
+  BEGIN_WRITE_CODE_BLOCK;
+
+  if (store)
+    close_store_locked();
+
+  UsmUserStore *s = new UsmUserStore;
+  if (!s)
+    return SNMPv3_USM_ERROR;
+  int result = s->open(name);
+  if (result != SNMPv3_USM_OK)
+  {
+    delete s;
+    return result;
+  }
+
+  int old_entries = entries;
+  struct UsmUserTableEntry *old_table = 0;
+  store = s;
+  if (!reserve(entries + store->get_snapshot_count()) ||
+      (entries && !(old_table = new struct UsmUserTableEntry[entries])))
+  {
+    close_store_locked();
+    return SNMPv3_USM_ERROR;
+  }
+
+  // Load the snapshot into the empty table, then add the users that
+  // were in the table before, unless the file has the same user.
+  int i;
+  for (i = 0; i < old_entries; ++i)
+    old_table[i] = table[i];
+  entries = 0;
+  bool ok = load_snapshot();
+  for (i = 0; i < old_entries; ++i)
+  {
+    struct UsmUserTableEntry &e = old_table[i];
+    if (find_user(e.usmUserEngineID, e.usmUserEngineIDLength,
+                  e.usmUserName, e.usmUserNameLength) >= 0)
+      free_entry(e);
+    else
+    {
+      table[entries] = e;
+      add_to_index(entries);
+      entries++;
+    }
+  }
+  if (old_table)
+    delete [] old_table;
+
+  const UsmStoreRecord *r = store->first_journal_record();
+  for (; ok && r; r = store->next(r))
+    ok = (add_store_record(r) == SNMPv3_USM_OK);
+
+  if (!ok)
+  {
+    LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
+    LOG("USMUserTable: Failed to load users from store");
+    LOG(name);
+    LOG_END;
+
+    close_store_locked();
+    return SNMPv3_USM_FILEREAD_ERROR;
+  }
+
+  // add the users that were in the table before to the store
+  for (i = 0; i < entries; ++i)
+    if (!store->contains(table[i].usmUserEngineID))
+      journal(UsmUserStore::ADD_USER, i);
+
+  LOG_BEGIN(loggerModuleName, INFO_LOG | 4);
+  LOG("USMUserTable: Opened user store (users before) (users now)");
+  LOG(old_entries);
+  LOG(entries);
+  LOG_END;
+
+  return SNMPv3_USM_OK;
+}
+
+int USMUserTable::add_store_record(const UsmStoreRecord *record)
+{
+  /* Table is locked through caller */
+  struct UsmUserTableEntry e;
+  UsmUserStore::get_entry(record, e);
+
+  int i;
+  while ((i = find_user(e.usmUserEngineID, e.usmUserEngineIDLength,
+                        e.usmUserName, e.usmUserNameLength)) >= 0)
+    delete_entry(i);
+
+  if (record->type == UsmUserStore::DELETE_USER)
+    return SNMPv3_USM_OK;
+
+  if (!reserve(entries + 1))
+    return SNMPv3_USM_ERROR;
+
+  table[entries] = e;
+  if (!check_protocols(entries))
+    return SNMPv3_USM_ERROR;
+  prepare_auth_key(entries);
+  prepare_priv_key(entries);
+  add_to_index(entries);
+  entries++;
+  return SNMPv3_USM_OK;
+}
+
+bool USMUserTable::load_snapshot()
+{
+  /* Table is locked through caller, it is empty and has room */
+  bool ok = true;
+  const UsmStoreRecord *r = store->first();
+
+  // The snapshot has no duplicates: take the records in their order
+  // and the saved indexes, which are valid for this order.
+  for (int i = 0; i < store->get_snapshot_count(); ++i, r = store->next(r))
+  {
+    UsmUserStore::get_entry(r, table[i]);
+    if (!check_protocols(i))
+    {
+      ok = false;
+      break;
+    }
+    prepare_auth_key(i);
+    prepare_priv_key(i);
+    entries = i + 1;
+  }
+  // an empty snapshot needs no saved index
+  if (ok && (entries > 0))
+  {
+    if (load_index())
+      return true;
+
+    LOG_BEGIN(loggerModuleName, WARNING_LOG | 3);
+    LOG("USMUserTable: Rebuilding index of user store");
+    LOG(store->get_name());
+    LOG_END;
+  }
+
+  rebuild_index();
+  return ok;
+}
+
+bool USMUserTable::check_protocols(const int nr) const
+{
+  const struct UsmUserTableEntry &e = table[nr];
+
+  if (((e.usmUserAuthProtocol == SNMP_AUTHPROTOCOL_NONE) ||
+       auth_priv->get_auth(e.usmUserAuthProtocol)) &&
+      ((e.usmUserPrivProtocol == SNMP_PRIVPROTOCOL_NONE) ||
+       auth_priv->get_priv(e.usmUserPrivProtocol)))
+    return true;
+
+  LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
+  LOG("USMUserTable: Unknown protocol of (user name) (auth) (priv)");
+  LOG(OctetStr(e.usmUserName, e.usmUserNameLength).get_printable());
+  LOG(e.usmUserAuthProtocol);
+  LOG(e.usmUserPrivProtocol);
+  LOG_END;
+
+  return false;
+}
+
+// Length of a saved index in a user store: size, padding and data
+#define USM_STORE_INDEX_LEN(len) (8 + (((len) + 7) & ~7UL))
+
+bool USMUserTable::load_index()
+{
+  /* Table is locked through caller */
+  SnmpHashIndex *indexes[4] = { &engine_sec_index, &engine_user_index,
+                                &user_name_index, &security_name_index };
+  unsigned long len;
+  const unsigned char *p = store->get_index(len);
+
+  for (int i = 0; i < 4; ++i)
+  {
+    unsigned int index_len;
+    if (!p || (len < 8))
+      return false;
+    memcpy(&index_len, p, sizeof(index_len));
+    if (USM_STORE_INDEX_LEN(index_len) > len)
+      return false;
+    if (!indexes[i]->load(p + 8, index_len, entries))
+      return false;
+    p += USM_STORE_INDEX_LEN(index_len);
+    len -= USM_STORE_INDEX_LEN(index_len);
+  }
+  return reserve(max_entries);
+}
+
+void USMUserTable::rebuild_index()
+{
+  /* Table is locked through caller */
+  engine_sec_index.clear();
+  engine_user_index.clear();
+  user_name_index.clear();
+  security_name_index.clear();
+  if (!reserve(max_entries))
+  {
+    /* remove the entries that cannot be indexed */
+    while (entries > 0)
+      delete_entry(entries - 1);
+    return;
+  }
+  for (int i = 0; i < entries; ++i)
+    add_to_index(i);
+}
+
+void USMUserTable::journal(const UsmUserStore::RecordType type, const int nr)
+{
+  /* Table is locked through caller */
+  if (!store)
+    return;
+
+  // Write a new snapshot if the journal got larger than the snapshot,
+  // the record for the change is appended to the new file.
+  if ((store->get_journal_size() > USM_STORE_MIN_COMPACT_SIZE) &&
+      (store->get_journal_size() > store->get_snapshot_size()))
+    compact_store_locked();
+
+  if (store->append(type, table[nr]) != SNMPv3_USM_OK)
+  {
+    LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
+    LOG("USMUserTable: Could not add change to user store (user name)");
+    LOG(OctetStr(table[nr].usmUserName,
+                 table[nr].usmUserNameLength).get_printable());
+    LOG_END;
+  }
+}
+
+int USMUserTable::compact_store()
+{
+  BEGIN_WRITE_CODE_BLOCK;
+
+  if (!store)
+    return SNMPv3_USM_ERROR;
+  return compact_store_locked();
+}
+
+int USMUserTable::compact_store_locked()
+{
+  /* Table is locked through caller */
+  UsmUserStore *s = new UsmUserStore;
+  if (!s)
+    return SNMPv3_USM_ERROR;
+
+  // save the indexes with the snapshot
+  SnmpHashIndex *indexes[4] = { &engine_sec_index, &engine_user_index,
+                                &user_name_index, &security_name_index };
+  unsigned long index_size = 0;
+  int i;
+  for (i = 0; i < 4; ++i)
+    index_size += USM_STORE_INDEX_LEN(indexes[i]->saved_size(entries));
+  unsigned char *index = new unsigned char[index_size];
+  if (!index)
+  {
+    delete s;
+    return SNMPv3_USM_ERROR;
+  }
+  memset(index, 0, index_size);
+  unsigned char *p = index;
+  for (i = 0; i < 4; ++i)
+  {
+    unsigned int len = (unsigned int)indexes[i]->saved_size(entries);
+    memcpy(p, &len, sizeof(len));
+    indexes[i]->save(p + 8, entries);
+    p += USM_STORE_INDEX_LEN(len);
+  }
+
+  store->close_journal();
+  int result = s->write(store->get_name(), table, entries, index, index_size);
+  delete [] index;
+  if (result == SNMPv3_USM_OK)
+    result = s->open(store->get_name());
+  if ((result == SNMPv3_USM_OK) && (s->get_snapshot_count() != entries))
+    result = SNMPv3_USM_FILEREAD_ERROR;
+  if (result != SNMPv3_USM_OK)
+  {
+    LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
+    LOG("USMUserTable: Could not write snapshot of user store (result)");
+    LOG(result);
+    LOG_END;
+
+    delete s;
+    if ((result != SNMPv3_USM_FILECREATE_ERROR) &&
+        (result != SNMPv3_USM_FILEWRITE_ERROR))
+    {
+      // the old file may be gone, do not append to it
+      close_store_locked();
+    }
+    return result;
+  }
+
+  // The snapshot has the entries in the order of the table: point
+  // the entries into the new file and release the old one.
+  const UsmStoreRecord *r = s->first();
+  for (i = 0; i < entries; ++i, r = s->next(r))
+  {
+    struct UsmUserTableEntry e;
+    UsmUserStore::get_entry(r, e);
+
+    free_field(table[i].usmUserEngineID, table[i].usmUserEngineIDLength);
+    free_field(table[i].usmUserName, table[i].usmUserNameLength);
+    free_field(table[i].usmUserSecurityName,
+               table[i].usmUserSecurityNameLength);
+    free_field(table[i].usmUserAuthKey, table[i].usmUserAuthKeyLength);
+    free_field(table[i].usmUserPrivKey, table[i].usmUserPrivKeyLength);
+    table[i].usmUserEngineID     = e.usmUserEngineID;
+    table[i].usmUserName         = e.usmUserName;
+    table[i].usmUserSecurityName = e.usmUserSecurityName;
+    table[i].usmUserAuthKey      = e.usmUserAuthKey;
+    table[i].usmUserPrivKey      = e.usmUserPrivKey;
+  }
+  delete store;
+  store = s;
+
+  LOG_BEGIN(loggerModuleName, INFO_LOG | 4);
+  LOG("USMUserTable: Wrote snapshot of user store (users)");
+  LOG(entries);
+  LOG_END;
+
+  return SNMPv3_USM_OK;
+}
+
+void USMUserTable::close_store()
+{
+  BEGIN_WRITE_CODE_BLOCK;
+
+  close_store_locked();
+}
+
+void USMUserTable::close_store_locked()
+{
+  /* Table is locked through caller */
+  if (!store)
+    return;
+
+  // copy the fields that point into the file
+  for (int i = 0; i < entries; ++i)
+  {
+    struct UsmUserTableEntry &e = table[i];
+
+    if (store->contains(e.usmUserEngineID))
+      e.usmUserEngineID = v3strcpy(e.usmUserEngineID,
+                                   e.usmUserEngineIDLength);
+    if (store->contains(e.usmUserName))
+      e.usmUserName = v3strcpy(e.usmUserName, e.usmUserNameLength);
+    if (store->contains(e.usmUserSecurityName))
+      e.usmUserSecurityName = v3strcpy(e.usmUserSecurityName,
+                                       e.usmUserSecurityNameLength);
+    if (store->contains(e.usmUserAuthKey))
+      e.usmUserAuthKey = v3strcpy(e.usmUserAuthKey, e.usmUserAuthKeyLength);
+    if (store->contains(e.usmUserPrivKey))
+      e.usmUserPrivKey = v3strcpy(e.usmUserPrivKey, e.usmUserPrivKeyLength);
+  }
+  delete store;
+  store = 0;
+}
+
+void USMUserTable::free_field(unsigned char *field, const long len) const
+{
+  if (!field || (store && store->contains(field)))
+    return;
+  memset(field, 0, len);
+  delete [] field;
+}
+
+void USMUserTable::free_entry(struct UsmUserTableEntry &e) const
+{
+  free_field(e.usmUserEngineID, e.usmUserEngineIDLength);
+  free_field(e.usmUserName, e.usmUserNameLength);
+  free_field(e.usmUserSecurityName, e.usmUserSecurityNameLength);
+  free_field(e.usmUserAuthKey, e.usmUserAuthKeyLength);
+  free_field(e.usmUserPrivKey, e.usmUserPrivKeyLength);
+  if (e.usmUserAuthPreparedKey)
+  {
+    memset(e.usmUserAuthPreparedKey, 0, e.usmUserAuthPreparedKeyLength);
+    delete [] e.usmUserAuthPreparedKey;
+  }
+  free_priv_prepared_key(auth_priv, e.usmUserPrivProtocol,
+                         e.usmUserPrivPreparedKey,
+                         e.usmUserPrivPreparedKeyLength);
+}
+
 const UsmUserTableEntry *USMUserTable::peek_next(
                    const UsmUserTableEntry *e) const
 {
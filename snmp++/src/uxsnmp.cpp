@@ -173,66 +173,60 @@ void v3CallBack(int reason, Snmp *snmp, Pdu &pdu, SnmpTarget &target, void *v3cd
 // return a unique rid, clock can be too slow , so use current_rid
 long Snmp::MyMakeReqId()
 {
+  const unsigned long range
+    = (wide_rids ? PDU_MAX_WIDE_RID : PDU_MAX_RID) - PDU_MIN_RID + 1;
   long rid;
-  eventListHolder->snmpEventList()->lock();
+  bool outstanding;
+
   do {
-    rid = ++current_rid;
+    // every caller gets its own counter value, no lock needed
+    unsigned long count = current_rid.increment();
+    rid = PDU_MIN_RID + (long)(count % range);
 
 #ifdef INVALID_REQID
     debugprintf(-10, "\nWARNING: Using constand RequestID!\n");
     rid = 0xc0de;
 #endif
 
-    if ( current_rid > PDU_MAX_RID)
+    if (!rid_wrapped.get())
     {
-      current_rid = rid = PDU_MIN_RID;
-      // let other tasks proceed
-      eventListHolder->snmpEventList()->unlock();
-      struct timeval tv;
-      tv.tv_sec = 0;
-      tv.tv_usec = 100;
-      select(0, 0, 0, 0, &tv);
-      eventListHolder->snmpEventList()->lock();
+      // no id was used twice yet, so rid cannot be outstanding
+      if (count - first_rid < range)
+        return rid;
+      rid_wrapped.set(1);
     }
-  } while (eventListHolder->snmpEventList()->GetEntry(rid));
-  eventListHolder->snmpEventList()->unlock();
+
+    eventListHolder->snmpEventList()->lock();
+    outstanding = (eventListHolder->snmpEventList()->GetEntry(rid) != 0);
+    eventListHolder->snmpEventList()->unlock();
+  } while (outstanding);
 
   return rid;
 }
 
-//---------[ Send SNMP Request ]---------------------------------------
-// Send out a snmp request
-DLLOPT int send_snmp_request(SnmpSocket sock, unsigned char *send_buf,
-                             size_t send_len, const Address & address)
+//---------[ convert addresses ]---------------------------------------
+// Fill the socket address structure for the given UDP address.
+// Returns false if the address can not be used.
+static bool udp_address_to_sockaddr(const Address &address,
+                                    SocketAddrType &sock_addr,
+                                    SocketLengthType &sock_addr_len)
 {
-  // UX only supports UDP type addresses (addr and port) right now
-  if (address.get_type() != Address::type_udp)
-    return -1;// unsupported address type
-
-  debugprintf(1, "++ SNMP++: sending to %s:",
-              ((UdpAddress &)address).UdpAddress::get_printable());
-  debughexprintf(5, send_buf, SAFE_UINT_CAST(send_len));
-
-  int send_result;
+  memset(&sock_addr, 0, sizeof(sock_addr));
 
   if (((UdpAddress &)address).get_ip_version() == Address::version_ipv4)
   {
     // prepare the destination address
-    struct sockaddr_in agent_addr;  // send socket struct
-    memset(&agent_addr, 0, sizeof(agent_addr));
+    struct sockaddr_in &agent_addr = (struct sockaddr_in &)sock_addr;
     agent_addr.sin_family = AF_INET;
     agent_addr.sin_addr.s_addr
               = inet_addr(((IpAddress &)address).IpAddress::get_printable());
     agent_addr.sin_port = htons(((UdpAddress &)address).get_port());
-
-    send_result = sendto(sock, (char*) send_buf, SAFE_INT_CAST(send_len), 0,
-                         (struct sockaddr*) &agent_addr, sizeof(agent_addr));
+    sock_addr_len = sizeof(agent_addr);
   }
   else
   {
 #ifdef SNMP_PP_IPv6
-    struct sockaddr_in6 agent_addr;
-    memset(&agent_addr, 0, sizeof(agent_addr));
+    struct sockaddr_in6 &agent_addr = (struct sockaddr_in6 &)sock_addr;
     unsigned int scope = 0;
     
     OctetStr addrstr = ((IpAddress &)address).IpAddress::get_printable();
@@ -259,18 +253,76 @@ DLLOPT int send_snmp_request(SnmpSocket sock, unsigned char *send_buf,
 	LOG(errno);
 	LOG(strerror(errno));
 	LOG_END;
-	return -1;
+	return false;
     }
     agent_addr.sin6_family = AF_INET6;
     agent_addr.sin6_port = htons(((UdpAddress &)address).get_port());
     agent_addr.sin6_scope_id = scope;
-    send_result = sendto( sock, (char*) send_buf, send_len, 0,
-                          (struct sockaddr*) &agent_addr, sizeof(agent_addr));
+    sock_addr_len = sizeof(agent_addr);
 #else
     debugprintf(0, "User error: Enable IPv6 and recompile snmp++.");
-    return -1;
+    return false;
 #endif
   }
+  return true;
+}
+
+// Get the UDP address from the socket address structure.
+// Returns false if the address family is not supported.
+static bool sockaddr_to_udp_address(const SocketAddrType &from_addr,
+                                    UdpAddress &fromaddress)
+{
+  if (((const sockaddr_in&)from_addr).sin_family == AF_INET)
+  {
+    // IPv4
+    fromaddress = inet_ntoa(((const sockaddr_in&)from_addr).sin_addr);
+    fromaddress.set_port(ntohs(((const sockaddr_in&)from_addr).sin_port));
+  }
+#ifdef SNMP_PP_IPv6
+  else if (from_addr.ss_family == AF_INET6)
+  {
+    // IPv6
+    char tmp_buffer[INET6_ADDRSTRLEN+1];
+
+    inet_ntop(AF_INET6, &(((const sockaddr_in6&)from_addr).sin6_addr),
+              tmp_buffer, INET6_ADDRSTRLEN);
+
+    fromaddress = tmp_buffer;
+    fromaddress.set_port(ntohs(((const sockaddr_in6&)from_addr).sin6_port));
+    if (((const sockaddr_in6&)from_addr).sin6_scope_id != 0)
+	fromaddress.set_scope(((const sockaddr_in6&)from_addr).sin6_scope_id);
+  }
+#endif // SNMP_PP_IPv6
+  else
+  {
+    debugprintf(0, "Unknown socket address family (%i).",
+                ((const sockaddr_in&)from_addr).sin_family);
+    return false;
+  }
+  return true;
+}
+
+//---------[ Send SNMP Request ]---------------------------------------
+// Send out a snmp request
+DLLOPT int send_snmp_request(SnmpSocket sock, unsigned char *send_buf,
+                             size_t send_len, const Address & address)
+{
+  // UX only supports UDP type addresses (addr and port) right now
+  if (address.get_type() != Address::type_udp)
+    return -1;// unsupported address type
+
+  debugprintf(1, "++ SNMP++: sending to %s:",
+              ((UdpAddress &)address).UdpAddress::get_printable());
+  debughexprintf(5, send_buf, SAFE_UINT_CAST(send_len));
+
+  SocketAddrType agent_addr;
+  SocketLengthType agent_addr_len;
+
+  if (!udp_address_to_sockaddr(address, agent_addr, agent_addr_len))
+    return -1;
+
+  int send_result = sendto(sock, (char*) send_buf, SAFE_INT_CAST(send_len), 0,
+                           (struct sockaddr*) &agent_addr, agent_addr_len);
 
   if (send_result < 0)
   {
@@ -291,11 +343,17 @@ DLLOPT int send_snmp_request(SnmpSocket sock, unsigned char *send_buf,
 // when we are successful in receiving a pdu.  Otherwise it
 // is an error status.
 
+int process_snmp_response(unsigned char *receive_buffer,
+                          long receive_buffer_len, Snmp &snmp_session,
+                          Pdu &pdu, UdpAddress &fromaddress,
+                          OctetStr &engine_id);
+
 int receive_snmp_response(SnmpSocket sock, Snmp &snmp_session,
                           Pdu &pdu, UdpAddress &fromaddress,
 			  OctetStr &engine_id, bool process_msg = true)
 {
-  unsigned char receive_buffer[MAX_SNMP_PACKET + 1];
+  MessageBuffer buffer;  // has room for size() + 1 bytes
+  unsigned char *receive_buffer = buffer.get_ptr();
   long receive_buffer_len; // len of received data
   SocketAddrType from_addr;
   SocketLengthType fromlen = sizeof(from_addr);
@@ -304,7 +362,7 @@ int receive_snmp_response(SnmpSocket sock, Snmp &snmp_session,
   // do the read
   do {
     receive_buffer_len = (long) recvfrom(sock, (char *) receive_buffer,
-                                         MAX_SNMP_PACKET + 1, 0,
+                                         buffer.size() + 1, 0,
                                          (struct sockaddr*)&from_addr,
                                          &fromlen);
     debugprintf(2, "++ SNMP++: something received...");
@@ -315,7 +373,7 @@ int receive_snmp_response(SnmpSocket sock, Snmp &snmp_session,
   debugprintf(6, "Length received %i from socket %i; fromlen %i",
               receive_buffer_len, sock, fromlen);
 
-  if (receive_buffer_len == MAX_SNMP_PACKET + 1)
+  if (receive_buffer_len == (long)buffer.size() + 1)
   {
     LOG_BEGIN(loggerModuleName, WARNING_LOG | 1);
     LOG("Snmp: Received message is ignored (packet too long)");
@@ -324,33 +382,8 @@ int receive_snmp_response(SnmpSocket sock, Snmp &snmp_session,
     return SNMP_CLASS_ERROR;
   }
 
-  if (((sockaddr_in&)from_addr).sin_family == AF_INET)
-  {
-    // IPv4
-    fromaddress = inet_ntoa(((sockaddr_in&)from_addr).sin_addr);
-    fromaddress.set_port(ntohs(((sockaddr_in&)from_addr).sin_port));
-  }
-#ifdef SNMP_PP_IPv6
-  else if (from_addr.ss_family == AF_INET6)
-  {
-    // IPv6
-    char tmp_buffer[INET6_ADDRSTRLEN+1];
-
-    inet_ntop(AF_INET6, &(((sockaddr_in6&)from_addr).sin6_addr),
-              tmp_buffer, INET6_ADDRSTRLEN);
-
-    fromaddress = tmp_buffer;
-    fromaddress.set_port(ntohs(((sockaddr_in6&)from_addr).sin6_port));
-    if (((sockaddr_in6&)from_addr).sin6_scope_id != 0)
-	fromaddress.set_scope(((sockaddr_in6&)from_addr).sin6_scope_id);
-  }
-#endif // SNMP_PP_IPv6
-  else
-  {
-    debugprintf(0, "Unknown socket address family (%i).",
-                ((sockaddr_in&)from_addr).sin_family);
+  if (!sockaddr_to_udp_address(from_addr, fromaddress))
     return SNMP_CLASS_ERROR;
-  }
 
   debugprintf(1, "++ SNMP++: data received from %s.",
               fromaddress.get_printable());
@@ -359,6 +392,19 @@ int receive_snmp_response(SnmpSocket sock, Snmp &snmp_session,
   if (process_msg == false)
     return SNMP_CLASS_SUCCESS;   // return success
 
+  return process_snmp_response(receive_buffer, receive_buffer_len,
+                               snmp_session, pdu, fromaddress, engine_id);
+}
+
+//---------[ process a snmp response ]---------------------------------
+// Decode a response that has already been read from the socket,
+// for example as part of a SnmpDatagramBatch. Same return values
+// as receive_snmp_response().
+int process_snmp_response(unsigned char *receive_buffer,
+                          long receive_buffer_len, Snmp &snmp_session,
+                          Pdu &pdu, UdpAddress &fromaddress,
+                          OctetStr &engine_id)
+{
   SnmpMessage snmpmsg;
   if ( snmpmsg.load( receive_buffer, receive_buffer_len) != SNMP_CLASS_SUCCESS)
     return SNMP_CLASS_ERROR;
@@ -408,6 +454,163 @@ int receive_snmp_response(SnmpSocket sock, Snmp &snmp_session,
   return SNMP_CLASS_SUCCESS;   // Success! return
 }
 
+//---------[ batch of datagrams ]--------------------------------------
+SnmpDatagramBatch::SnmpDatagramBatch(const int max_count)
+  : m_maxCount(max_count < 1 ? 1 : max_count), m_count(0),
+    m_maxLength(MessageBuffer::get_max_message_size())
+{
+  m_buffers = new unsigned char[m_maxCount * (m_maxLength + 1)];
+  m_lengths = new long[m_maxCount];
+  m_results = new int[m_maxCount];
+  m_addresses = new SocketAddrType[m_maxCount];
+  m_addressLengths = new SocketLengthType[m_maxCount];
+
+#ifdef HAVE_RECVMMSG_SYSCALL
+  m_msgs = new struct mmsghdr[m_maxCount];
+  m_iovecs = new struct iovec[m_maxCount];
+  memset(m_msgs, 0, m_maxCount * sizeof(struct mmsghdr));
+
+  for (int i = 0; i < m_maxCount; i++)
+  {
+    m_iovecs[i].iov_base = get_data(i);
+    m_msgs[i].msg_hdr.msg_iov = &m_iovecs[i];
+    m_msgs[i].msg_hdr.msg_iovlen = 1;
+    m_msgs[i].msg_hdr.msg_name = &m_addresses[i];
+  }
+#endif
+}
+
+SnmpDatagramBatch::~SnmpDatagramBatch()
+{
+#ifdef HAVE_RECVMMSG_SYSCALL
+  delete [] m_iovecs;
+  delete [] m_msgs;
+#endif
+  delete [] m_addressLengths;
+  delete [] m_addresses;
+  delete [] m_results;
+  delete [] m_lengths;
+  delete [] m_buffers;
+}
+
+int SnmpDatagramBatch::receive(const SnmpSocket sock)
+{
+  m_count = 0;
+
+#ifdef HAVE_RECVMMSG_SYSCALL
+  for (int i = 0; i < m_maxCount; i++)
+  {
+    m_iovecs[i].iov_len = m_maxLength + 1;
+    m_msgs[i].msg_hdr.msg_namelen = sizeof(SocketAddrType);
+  }
+
+  int received;
+  do {
+    received = recvmmsg(sock, m_msgs, m_maxCount, MSG_DONTWAIT, 0);
+  } while ((received < 0) && (EINTR == errno));
+
+  if (received < 0)                       // error or no data pending
+    return -1;
+
+  for (int j = 0; j < received; j++)
+  {
+    m_lengths[j] = (long) m_msgs[j].msg_len;
+    m_addressLengths[j] = m_msgs[j].msg_hdr.msg_namelen;
+  }
+  m_count = received;
+#else
+  long len;
+  m_addressLengths[0] = sizeof(SocketAddrType);
+  do {
+    len = (long) recvfrom(sock, (char *) get_data(0), m_maxLength + 1, 0,
+                          (struct sockaddr*)&m_addresses[0],
+                          &m_addressLengths[0]);
+  } while ((len < 0) && (EINTR == errno));
+
+  if (len < 0)                            // error or no data pending
+    return -1;
+
+  m_lengths[0] = len;
+  m_count = 1;
+#endif
+
+  debugprintf(4, "++ SNMP++: received %i datagram(s) from socket %i",
+              m_count, sock);
+  return m_count;
+}
+
+bool SnmpDatagramBatch::add(const unsigned char *data, const size_t len,
+                            const UdpAddress &address)
+{
+  if ((m_count >= m_maxCount) || (len > (size_t) m_maxLength))
+    return false;
+
+  if (!udp_address_to_sockaddr(address, m_addresses[m_count],
+                               m_addressLengths[m_count]))
+    return false;
+
+  memcpy(get_data(m_count), data, len);
+  m_lengths[m_count] = (long) len;
+  m_count++;
+  return true;
+}
+
+int SnmpDatagramBatch::send(const SnmpSocket sock)
+{
+  int sent = 0;
+  int done = 0;
+
+#ifdef HAVE_RECVMMSG_SYSCALL
+  for (int i = 0; i < m_count; i++)
+  {
+    m_iovecs[i].iov_len = m_lengths[i];
+    m_msgs[i].msg_hdr.msg_namelen = m_addressLengths[i];
+  }
+
+  while (done < m_count)
+  {
+    int result = sendmmsg(sock, m_msgs + done, m_count - done, 0);
+    if (result < 0)
+    {
+      if (EINTR == errno)
+        continue;
+      // skip the datagram that could not be sent
+      debugprintf(0, "Error sending packet: %s", strerror(errno));
+      m_results[done++] = -1;
+      continue;
+    }
+    for (int i = 0; i < result; i++)
+      m_results[done++] = 0;
+    sent += result;
+  }
+#else
+  for (; done < m_count; done++)
+  {
+    if (sendto(sock, (char*) get_data(done), m_lengths[done], 0,
+               (struct sockaddr*) &m_addresses[done],
+               m_addressLengths[done]) < 0)
+    {
+      debugprintf(0, "Error sending packet: %s", strerror(errno));
+      m_results[done] = -1;
+      continue;
+    }
+    m_results[done] = 0;
+    sent++;
+  }
+#endif
+
+  debugprintf(4, "++ SNMP++: sent %i of %i datagram(s) on socket %i",
+              sent, m_count, sock);
+  m_count = 0;
+  return sent;
+}
+
+bool SnmpDatagramBatch::get_address(const int index,
+                                    UdpAddress &address) const
+{
+  return sockaddr_to_udp_address(m_addresses[index], address);
+}
+
 
 //---------[ receive a snmp trap ]---------------------------------
 // Receive a trap from the specified socket
@@ -415,7 +618,8 @@ int receive_snmp_response(SnmpSocket sock, Snmp &snmp_session,
 int receive_snmp_notification(SnmpSocket sock, Snmp &snmp_session,
                               Pdu &pdu, SnmpTarget **target)
 {
-  unsigned char receive_buffer[MAX_SNMP_PACKET + 1];
+  MessageBuffer buffer;  // has room for size() + 1 bytes
+  unsigned char *receive_buffer = buffer.get_ptr();
   long receive_buffer_len; // len of received data
   SocketAddrType from_addr;
   SocketLengthType fromlen = sizeof(from_addr);
@@ -424,7 +628,7 @@ int receive_snmp_notification(SnmpSocket sock, Snmp &snmp_session,
   // do the read
   do {
     receive_buffer_len = (long) recvfrom(sock, (char *) receive_buffer,
-                                         MAX_SNMP_PACKET + 1, 0,
+                                         buffer.size() + 1, 0,
                                          (struct sockaddr*)&from_addr,
                                          &fromlen);
   } while (receive_buffer_len < 0 && EINTR == errno);
@@ -432,7 +636,7 @@ int receive_snmp_notification(SnmpSocket sock, Snmp &snmp_session,
   if (receive_buffer_len < 0 )                // error or no data pending
     return SNMP_CLASS_TL_FAILED;
 
-  if (receive_buffer_len == MAX_SNMP_PACKET + 1)
+  if (receive_buffer_len == (long)buffer.size() + 1)
   {
     // Message is too long...
     debugprintf(1, "Received message is ignored (packet too long)");
@@ -584,7 +788,8 @@ void Snmp::map_action( unsigned short action, unsigned short & pdu_action)
 
 Snmp::Snmp(int &status, const unsigned short port, const bool bind_ipv6)
     : SnmpSynchronized(),
-      m_bThreadRunning(false), m_iPollTimeOut(DEFAULT_TIMEOUT)
+      m_bThreadRunning(false), m_iPollTimeOut(DEFAULT_TIMEOUT),
+      reuse_port(false)
 {
   IpAddress *addresses[2];
 
@@ -609,9 +814,10 @@ Snmp::Snmp(int &status, const unsigned short port, const bool bind_ipv6)
 
 }
 
-Snmp::Snmp( int &status, const UdpAddress& addr)
+Snmp::Snmp( int &status, const UdpAddress& addr, const bool reuse)
     : SnmpSynchronized(),
-      m_bThreadRunning(false), m_iPollTimeOut(DEFAULT_TIMEOUT)
+      m_bThreadRunning(false), m_iPollTimeOut(DEFAULT_TIMEOUT),
+      reuse_port(reuse)
 {
   IpAddress *addresses[2];
 
@@ -634,7 +840,8 @@ Snmp::Snmp( int &status, const UdpAddress& addr)
 Snmp::Snmp( int &status,  const UdpAddress& addr_v4,
             const UdpAddress& addr_v6)
     : SnmpSynchronized(),
-      m_bThreadRunning(false), m_iPollTimeOut(DEFAULT_TIMEOUT)
+      m_bThreadRunning(false), m_iPollTimeOut(DEFAULT_TIMEOUT),
+      reuse_port(false)
 {
   IpAddress *addresses[2];
 
@@ -646,6 +853,37 @@ Snmp::Snmp( int &status,  const UdpAddress& addr_v4,
   init(status, addresses, addr_v4.get_port(), addr_v6.get_port());
 }
 
+// Allow several sockets to be bound to the same address. Incoming
+// datagrams are distributed among them by the kernel.
+static void set_reuse_port(SnmpSocket sock)
+{
+#ifdef SO_REUSEPORT
+  int enable = 1;
+  if (setsockopt(sock, SOL_SOCKET, SO_REUSEPORT,
+                 (char*)&enable, sizeof(enable)) < 0)
+  {
+    LOG_BEGIN(loggerModuleName, WARNING_LOG | 1);
+    LOG("Snmp transport: could not set SO_REUSEPORT (errno)");
+    LOG(errno);
+    LOG_END;
+  }
+#else
+  (void)sock;
+  LOG_BEGIN(loggerModuleName, WARNING_LOG | 1);
+  LOG("Snmp transport: SO_REUSEPORT is not supported");
+  LOG_END;
+#endif
+}
+
+void Snmp::set_receive_batch_size(const int count)
+{
+  delete m_receiveBatch;
+  m_receiveBatch = 0;
+
+  if (count > 1)
+    m_receiveBatch = new SnmpDatagramBatch(count);
+}
+
 void Snmp::socket_startup()
 {
 #ifdef WIN32
@@ -673,13 +911,15 @@ void Snmp::init(int& status, IpAddress *addresses[2],
 #endif
 #endif
 
+  m_receiveBatch = 0;
   eventListHolder = new EventListHolder(this);
   // initialize the request_id
-  eventListHolder->snmpEventList()->lock();
 //  srand(time(0)); // better than nothing
-  current_rid = (rand() % (PDU_MAX_RID - PDU_MIN_RID +1)) + PDU_MIN_RID;
-  debugprintf(4, "Initialized request_id to %i.", current_rid);
-  eventListHolder->snmpEventList()->unlock();
+  first_rid = rand() % (PDU_MAX_RID - PDU_MIN_RID + 1);
+  current_rid.set(first_rid);
+  rid_wrapped.set(0);
+  wide_rids = false;
+  debugprintf(4, "Initialized request_id to %i.", (int)(first_rid + PDU_MIN_RID));
 
   // initialize all the trap receiving member variables
   notifycallback = 0;
@@ -731,6 +971,9 @@ void Snmp::init(int& status, IpAddress *addresses[2],
       mgr_addr.sin_len = sizeof(mgr_addr);
 #endif
 
+      if (reuse_port)
+        set_reuse_port(iv_snmp_session);
+
       // bind the socket
       if (bind(iv_snmp_session, (struct sockaddr*)&mgr_addr,
                sizeof(mgr_addr)) < 0)
@@ -847,6 +1090,9 @@ void Snmp::init(int& status, IpAddress *addresses[2],
       mgr_addr.sin6_family = AF_INET6;
       mgr_addr.sin6_port = htons( port_v6);
       mgr_addr.sin6_scope_id = scope;
+      if (reuse_port)
+        set_reuse_port(iv_snmp_session_ipv6);
+
       // bind the socket
       if (bind(iv_snmp_session_ipv6, (struct sockaddr*) &mgr_addr,
                sizeof(mgr_addr)) < 0)
@@ -939,6 +1185,7 @@ Snmp::~Snmp()
   notify_unregister();
 
   delete eventListHolder;
+  delete m_receiveBatch;
 }
 
 // Get the version of the snmp++ library at runtime
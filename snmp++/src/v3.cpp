@@ -32,6 +32,7 @@ char v3_cpp_version[]="#(@) SNMP++ $Id: v3.cpp 2502 2013-12-18 21:01:54Z katz $"
 #include "snmp_pp/log.h"
 #include "snmp_pp/v3.h"
 #include "snmp_pp/octet.h"
+#include "snmp_pp/reentrant.h"
 
 #ifdef SNMP_PP_NAMESPACE
 namespace Snmp_pp {
@@ -143,6 +144,150 @@ void debugprintf(int, const char*, ...)
 
 #endif
 
+//-----[ MessageBuffer ]-----------------------------------------------
+
+// maximum number of unused buffers kept for each thread
+#define MESSAGE_BUFFER_CACHE_SIZE 8
+
+// Written by set_max_message_size() while sessions may build messages
+static SnmpAtomicCounter max_message_size(MAX_SNMP_PACKET);
+
+// Unused buffers of one thread. Each thread has its own cache, so
+// threads that build and parse messages in parallel (like the
+// listeners of a multi listener agent) do not share a lock.
+struct MessageBufferCache
+{
+  unsigned char *buffer[MESSAGE_BUFFER_CACHE_SIZE];
+  unsigned int   size[MESSAGE_BUFFER_CACHE_SIZE];
+  int            count;
+};
+
+#if defined(_THREADS) && !defined(WIN32) && !(defined (CPU) && CPU == PPC603)
+
+static pthread_key_t  buffer_cache_key;
+static pthread_once_t buffer_cache_once = PTHREAD_ONCE_INIT;
+
+// free the cached buffers when the thread exits
+static void delete_buffer_cache(void *ptr)
+{
+  MessageBufferCache *cache = (MessageBufferCache *)ptr;
+  while (cache->count > 0)
+    delete [] cache->buffer[--cache->count];
+  delete cache;
+}
+
+static void create_buffer_cache_key()
+{
+  pthread_key_create(&buffer_cache_key, delete_buffer_cache);
+}
+
+// Get the cache of the calling thread, 0 if it cannot be created
+static MessageBufferCache *get_buffer_cache()
+{
+  pthread_once(&buffer_cache_once, create_buffer_cache_key);
+  MessageBufferCache *cache =
+    (MessageBufferCache *)pthread_getspecific(buffer_cache_key);
+  if (!cache)
+  {
+    cache = new MessageBufferCache;
+    cache->count = 0;
+    if (pthread_setspecific(buffer_cache_key, cache) != 0)
+    {
+      delete cache;
+      return 0;
+    }
+  }
+  return cache;
+}
+
+#define BUFFER_CACHE_LOCK
+
+#else
+
+// Without threads one cache is used. Thread local storage is only
+// implemented for pthreads, on other systems the cache is shared by
+// all threads and locked.
+static MessageBufferCache buffer_cache = { { 0 }, { 0 }, 0 };
+
+static MessageBufferCache *get_buffer_cache() { return &buffer_cache; }
+
+#ifdef _THREADS
+static SnmpSynchronized buffer_cache_lock;
+#define BUFFER_CACHE_LOCK SnmpSynchronize _synchronize(buffer_cache_lock)
+#else
+#define BUFFER_CACHE_LOCK
+#endif
+
+#endif
+
+MessageBuffer::MessageBuffer()
+  : ptr(0), len((unsigned int)max_message_size.get())
+{
+  MessageBufferCache *cache = get_buffer_cache();
+  if (cache)
+  {
+    BUFFER_CACHE_LOCK;
+    while (cache->count > 0)
+    {
+      --cache->count;
+      if (cache->size[cache->count] == len)
+      {
+        ptr = cache->buffer[cache->count];
+        break;
+      }
+      // size has been changed: drop old buffer
+      delete [] cache->buffer[cache->count];
+    }
+  }
+  if (!ptr)
+    ptr = new unsigned char[len + 1];
+}
+
+MessageBuffer::~MessageBuffer()
+{
+  if (len == max_message_size.get())
+  {
+    MessageBufferCache *cache = get_buffer_cache();
+    if (cache)
+    {
+      BUFFER_CACHE_LOCK;
+      if (cache->count < MESSAGE_BUFFER_CACHE_SIZE)
+      {
+        cache->buffer[cache->count] = ptr;
+        cache->size[cache->count] = len;
+        cache->count++;
+        return;
+      }
+    }
+  }
+  delete [] ptr;
+}
+
+unsigned int MessageBuffer::get_max_message_size()
+{
+  return (unsigned int)max_message_size.get();
+}
+
+bool MessageBuffer::set_max_message_size(const unsigned int size)
+{
+  // 484 octets must be supported by every SNMP entity (RFC 3417)
+  if ((size < 484) || (size > MAX_SNMP_PACKET_LIMIT))
+  {
+    LOG_BEGIN(loggerModuleName, WARNING_LOG | 1);
+    LOG("MessageBuffer: Ignoring invalid max message size (size)");
+    LOG(size);
+    LOG_END;
+    return false;
+  }
+  max_message_size.set(size);
+
+  LOG_BEGIN(loggerModuleName, INFO_LOG | 3);
+  LOG("MessageBuffer: Max message size set to (size)");
+  LOG(size);
+  LOG_END;
+  return true;
+}
+
 #ifdef _SNMPv3
 
 unsigned char *v3strcpy(const unsigned char *src, const int srclen)
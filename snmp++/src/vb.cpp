@@ -91,7 +91,7 @@ Vb& Vb::operator=(const Vb &vb)
 
   //-----[ next set the vb value portion ]
   if (vb.iv_vb_value)
-    iv_vb_value = vb.iv_vb_value->clone();
+    copy_value(*vb.iv_vb_value);
 
   exception_status = vb.exception_status;
 
@@ -107,12 +107,62 @@ void Vb::free_vb()
 {
   if (iv_vb_value)
   {
-    delete iv_vb_value;
+    if (value_is_inline())
+      iv_vb_value->~SnmpSyntax();
+    else
+      delete iv_vb_value;
     iv_vb_value = NULL;
   }
   exception_status = SNMP_CLASS_SUCCESS;
 }
 
+//----------------[ void Vb::copy_value() ]-----------------------------
+// copy a value, small values are stored within the vb
+void Vb::copy_value(const SnmpSyntax &val)
+{
+  iv_vb_value = val.clone_into(&iv_vb_storage, sizeof(iv_vb_storage));
+  if (!iv_vb_value)
+    iv_vb_value = val.clone();
+}
+
+#ifdef SNMP_PP_RVALUE_REFS
+//----------------[ void Vb::take_value() ]-----------------------------
+// move the value of another vb to this one
+void Vb::take_value(Vb &vb)
+{
+  if (!vb.iv_vb_value)
+    return;
+
+  if (!vb.value_is_inline())
+  {
+    iv_vb_value = vb.iv_vb_value;
+    vb.iv_vb_value = NULL;
+  }
+  else
+  {
+    // only the classes listed in iv_vb_storage are stored inline,
+    // so the class of a string value is known
+    switch (vb.iv_vb_value->get_syntax())
+    {
+      case sNMP_SYNTAX_OCTETS:
+        iv_vb_value = new (&iv_vb_storage)
+          OctetStr(std::move(*(OctetStr *)vb.iv_vb_value));
+        break;
+      case sNMP_SYNTAX_OPAQUE:
+        iv_vb_value = new (&iv_vb_storage)
+          OpaqueStr(std::move(*(OpaqueStr *)vb.iv_vb_value));
+        break;
+      default:
+        copy_value(*vb.iv_vb_value);
+        break;
+    }
+    vb.iv_vb_value->~SnmpSyntax();
+    vb.iv_vb_value = NULL;
+  }
+  vb.exception_status = SNMP_CLASS_SUCCESS;
+}
+#endif
+
 //---------------------[ Vb::get_value(int &i) ]----------------------
 // get value int
 // returns 0 on success and value
@@ -315,16 +365,16 @@ void Vb::set_syntax(const SmiUINT32 syntax)
 
 	switch (syntax) {
 	case sNMP_SYNTAX_INT32:
-	  	iv_vb_value = new SnmpInt32();
+	  	iv_vb_value = new (&iv_vb_storage) SnmpInt32();
 		break;
 	case sNMP_SYNTAX_TIMETICKS:
-		iv_vb_value = new TimeTicks();
+		iv_vb_value = new (&iv_vb_storage) TimeTicks();
 		break;
 	case sNMP_SYNTAX_CNTR32:
-		iv_vb_value = new Counter32();
+		iv_vb_value = new (&iv_vb_storage) Counter32();
 		break;
 	case sNMP_SYNTAX_GAUGE32:
-		iv_vb_value = new Gauge32();
+		iv_vb_value = new (&iv_vb_storage) Gauge32();
 		break;
 /* Not distinguishable from Gauge32
 	case sNMP_SYNTAX_UINT32:
@@ -332,14 +382,14 @@ void Vb::set_syntax(const SmiUINT32 syntax)
 		break;
 */
 	case sNMP_SYNTAX_CNTR64:
-	  	iv_vb_value = new Counter64();
+	  	iv_vb_value = new (&iv_vb_storage) Counter64();
 		break;
 	case sNMP_SYNTAX_BITS:
 	case sNMP_SYNTAX_OCTETS:
-	  	iv_vb_value = new OctetStr();
+	  	iv_vb_value = new (&iv_vb_storage) OctetStr();
 		break;
 	case sNMP_SYNTAX_OPAQUE:
-	  	iv_vb_value = new OpaqueStr();
+	  	iv_vb_value = new (&iv_vb_storage) OpaqueStr();
 		break;
 	case sNMP_SYNTAX_IPADDR:
 	  	iv_vb_value = new IpAddress();
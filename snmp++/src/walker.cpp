@@ -0,0 +1,919 @@
+/*_############################################################################
+  _##
+  _##  walker.cpp
+  _##
+  _##  SNMP++ v3.3
+  _##  -----------------------------------------------
+  _##  Copyright (c) 2001-2013 Jochen Katz, Frank Fock
+  _##
+  _##  This software is based on SNMP++2.6 from Hewlett Packard:
+  _##
+  _##    Copyright (c) 1996
+  _##    Hewlett-Packard Company
+  _##
+  _##  ATTENTION: USE OF THIS SOFTWARE IS SUBJECT TO THE FOLLOWING TERMS.
+  _##  Permission to use, copy, modify, distribute and/or sell this software
+  _##  and/or its documentation is hereby granted without fee. User agrees
+  _##  to display the above copyright notice and this license notice in all
+  _##  copies of the software and any documentation of the software. User
+  _##  agrees to assume all liability for the use of the software;
+  _##  Hewlett-Packard and Jochen Katz make no representations about the
+  _##  suitability of this software for any purpose. It is provided
+  _##  "AS-IS" without warranty of any kind, either express or implied. User
+  _##  hereby grants a royalty-free license to any and all derivatives based
+  _##  upon this software code base.
+  _##
+  _##########################################################################*/
+
+char walker_cpp_version[]="@(#) SNMP++ $Id$";
+
+#include <libsnmp.h>
+
+#include "snmp_pp/walker.h"
+#include "snmp_pp/uxsnmp.h"
+#include "snmp_pp/pdu.h"
+#include "snmp_pp/octet.h"
+#include "snmp_pp/msec.h"
+#include "snmp_pp/v3.h"
+#include "snmp_pp/log.h"
+
+#ifdef SNMP_PP_NAMESPACE
+namespace Snmp_pp {
+#endif
+
+static const char *loggerModuleName = "snmp++.walker";
+
+#define WALKER_INITIAL_HASH_SIZE 64
+
+//----[ internal structures ]------------------------------------------
+
+// State of one target address: requests in flight and waiting ranges
+struct TableWalker::WalkTarget
+{
+  OctetStr key;
+  unsigned long hash;
+  int walks;                 // walks using this entry
+  int in_flight;
+  WalkRange *ready_head;     // ranges waiting for a free slot
+  WalkRange *ready_tail;
+  bool runnable;             // in the runnable list of the walker
+  WalkTarget *run_next;
+  WalkTarget *hash_next;
+};
+
+// One walk started through TableWalker::walk()
+struct TableWalker::Walk
+{
+  SnmpTarget *target;
+  WalkTarget *entry;
+  walk_callback callback;
+  void *callback_data;
+  int status;                // first error or SNMP_CLASS_SUCCESS
+  int active_ranges;         // ranges that have not ended
+  WalkRange *ranges;         // all ranges of this walk
+  Walk *next;
+  Walk *previous;
+};
+
+// A part of a walk that is retrieved by consecutive requests
+struct TableWalker::WalkRange
+{
+  TableWalker *walker;
+  Walk *walk;
+  Oid last;                  // the next request starts here
+  Oid bound;                 // range ends at the first oid not below
+  bool split;                // may be split at the next column
+  int max_reps;
+  unsigned long req_id;      // request in flight or 0
+  msec sent;                 // send time of the request
+  WalkRange *ready_next;
+  WalkRange *walk_next;      // next range of the walk
+};
+
+static unsigned long hash_key(const OctetStr &key)
+{
+  unsigned long h = 2166136261UL;
+  for (unsigned long i = 0; i < key.len(); i++)
+  {
+    h ^= key[i];
+    h *= 16777619UL;
+  }
+  return h;
+}
+
+
+//----[ BulkController class ]-----------------------------------------
+
+#define BULK_INITIAL_HASH_SIZE  64
+#define BULK_MESSAGE_OVERHEAD   150   // message header incl. SNMPv3 fields
+#define BULK_MAX_LINE_LEN       256
+
+// Learned values of one target address
+struct BulkController::Entry
+{
+  OctetStr key;
+  unsigned long hash;
+  int reps;                  // current recommendation
+  int ceiling;               // largest value without problems
+  int max_size;              // maximum message size of the target
+  int vb_size;               // average encoded size of one Vb
+  unsigned long latency;     // latency of a complete response ...
+  int latency_reps;          // ... with this max-repetitions value
+  Entry *next;
+};
+
+BulkController::BulkController(const int initial_reps, const int max_reps)
+  : initial_repetitions(initial_reps < 1 ? 1 : initial_reps),
+    max_repetitions(max_reps < 1 ? 1 : max_reps),
+    table(0), table_size(BULK_INITIAL_HASH_SIZE), count(0)
+{
+  table = new Entry*[table_size];
+  memset(table, 0, table_size * sizeof(Entry*));
+}
+
+BulkController::~BulkController()
+{
+  for (int i = 0; i < table_size; i++)
+    while (table[i])
+    {
+      Entry *e = table[i];
+      table[i] = e->next;
+      delete e;
+    }
+  delete [] table;
+}
+
+BulkController::Entry *BulkController::find(const OctetStr &key,
+                                            const bool create)
+{
+  unsigned long h = hash_key(key);
+  Entry *e;
+
+  for (e = table[h % table_size]; e; e = e->next)
+    if ((e->hash == h) && (e->key == key))
+      return e;
+
+  if (!create)
+    return 0;
+
+  if (count >= 2 * table_size)
+  {
+    // grow the hash table
+    int size = 2 * table_size;
+    Entry **t = new Entry*[size];
+    memset(t, 0, size * sizeof(Entry*));
+    for (int i = 0; i < table_size; i++)
+      while (table[i])
+      {
+        Entry *m = table[i];
+        table[i] = m->next;
+        m->next = t[m->hash % size];
+        t[m->hash % size] = m;
+      }
+    delete [] table;
+    table = t;
+    table_size = size;
+  }
+
+  e = new Entry;
+  e->key = key;
+  e->hash = h;
+  e->reps = initial_repetitions;
+  e->ceiling = max_repetitions;
+  e->max_size = MessageBuffer::get_max_message_size();
+  e->vb_size = 0;
+  e->latency = 0;
+  e->latency_reps = 0;
+  e->next = table[h % table_size];
+  table[h % table_size] = e;
+  count++;
+  return e;
+}
+
+int BulkController::get_limit(const Entry *entry, const int columns) const
+{
+  int limit = entry->ceiling;
+  if (limit > max_repetitions)
+    limit = max_repetitions;
+
+  // the response must fit into the messages of both sides
+  int size = entry->max_size;
+  if (size > (int)MessageBuffer::get_max_message_size())
+    size = MessageBuffer::get_max_message_size();
+  if (entry->vb_size > 0)
+  {
+    int fit = (size - BULK_MESSAGE_OVERHEAD) /
+              (entry->vb_size * (columns < 1 ? 1 : columns));
+    if (fit < limit)
+      limit = fit;
+  }
+  return (limit < 1) ? 1 : limit;
+}
+
+int BulkController::get_max_repetitions(const SnmpTarget &target,
+                                        const int columns)
+{
+  GenAddress address;
+  target.get_address(address);
+  OctetStr key(address.get_printable());
+
+  SnmpSynchronize _synchronize(*this);
+  Entry *e = find(key, false);
+  if (!e)
+    return initial_repetitions;
+
+  int limit = get_limit(e, columns);
+  return (e->reps < limit) ? e->reps : limit;
+}
+
+void BulkController::update(const SnmpTarget &target, const int status,
+                            const Pdu &response, const int max_reps,
+                            const int columns, const unsigned long latency,
+                            const bool end_of_data)
+{
+  GenAddress address;
+  target.get_address(address);
+  OctetStr key(address.get_printable());
+  int cols = (columns < 1) ? 1 : columns;
+  int error = status;
+
+  if ((status == SNMP_CLASS_SUCCESS) ||
+      (status == SNMP_CLASS_ASYNC_RESPONSE))
+    error = response.get_error_status();
+
+  SnmpSynchronize _synchronize(*this);
+  Entry *e = find(key, true);
+
+  if (error == SNMP_ERROR_TOO_BIG)
+  {
+    // the agent could not send max_reps rows
+    if (max_reps - 1 < e->ceiling)
+      e->ceiling = (max_reps > 1) ? max_reps - 1 : 1;
+    if (e->vb_size > 0)
+    {
+      int size = max_reps * cols * e->vb_size + BULK_MESSAGE_OVERHEAD;
+      if (size < e->max_size)
+        e->max_size = size;
+    }
+    e->reps = (max_reps > 1) ? max_reps / 2 : 1;
+  }
+  else if (error == SNMP_CLASS_TIMEOUT)
+  {
+    // large responses may be lost, try smaller ones
+    e->reps = (max_reps > 1) ? max_reps / 2 : 1;
+  }
+  else if ((error == SNMP_ERROR_SUCCESS) && (response.get_vb_count() > 0))
+  {
+    int vbs = response.get_vb_count();
+    int length = response.get_asn1_length();
+    int size = (length + vbs - 1) / vbs;
+
+    e->vb_size = (e->vb_size > 0) ? (3 * e->vb_size + size) / 4 : size;
+
+    if (!end_of_data && (vbs < max_reps * cols))
+    {
+      // truncated by the agent: nothing more fits into its messages
+      if (length + BULK_MESSAGE_OVERHEAD + size < e->max_size)
+        e->max_size = length + BULK_MESSAGE_OVERHEAD + size;
+      e->reps = (vbs / cols > 0) ? vbs / cols : 1;
+    }
+    else if (!end_of_data && (max_reps >= e->reps))
+    {
+      // complete response for the current value
+      if ((e->latency_reps > 0) && (max_reps > e->latency_reps) &&
+          (latency > e->latency + 10) &&
+          (2 * latency * e->latency_reps > 3 * e->latency * max_reps))
+      {
+        // the time per row has grown by more than 50%: step back
+        e->ceiling = e->latency_reps;
+        e->reps = e->latency_reps;
+
+        LOG_BEGIN(loggerModuleName, INFO_LOG | 5);
+        LOG("BulkController: Latency limits repetitions (target) (reps)");
+        LOG(key.get_printable());
+        LOG(e->reps);
+        LOG_END;
+      }
+      else
+      {
+        e->latency = latency;
+        e->latency_reps = max_reps;
+        e->reps = 2 * max_reps;
+      }
+    }
+  }
+
+  int limit = get_limit(e, cols);
+  if (e->reps > limit)
+    e->reps = limit;
+  if (e->reps < 1)
+    e->reps = 1;
+
+  LOG_BEGIN(loggerModuleName, DEBUG_LOG | 10);
+  LOG("BulkController: Updated (target) (status) (reps) (vb size) (max size)");
+  LOG(key.get_printable());
+  LOG(error);
+  LOG(e->reps);
+  LOG(e->vb_size);
+  LOG(e->max_size);
+  LOG_END;
+}
+
+int BulkController::save(const char *filename)
+{
+  FILE *file = fopen(filename, "w");
+  if (!file)
+  {
+    LOG_BEGIN(loggerModuleName, ERROR_LOG | 1);
+    LOG("BulkController: Could not open (file)");
+    LOG(filename);
+    LOG_END;
+
+    return SNMP_CLASS_ERROR;
+  }
+
+  SnmpSynchronize _synchronize(*this);
+  fprintf(file, "# address max-repetitions ceiling max-size vb-size\n");
+  for (int i = 0; i < table_size; i++)
+    for (Entry *e = table[i]; e; e = e->next)
+      fprintf(file, "%s %d %d %d %d\n", e->key.get_printable(),
+              e->reps, e->ceiling, e->max_size, e->vb_size);
+
+  if (fclose(file))
+    return SNMP_CLASS_ERROR;
+  return SNMP_CLASS_SUCCESS;
+}
+
+int BulkController::load(const char *filename)
+{
+  char line[BULK_MAX_LINE_LEN];
+  char address[BULK_MAX_LINE_LEN];
+  int reps, ceiling, max_size, vb_size;
+
+  FILE *file = fopen(filename, "r");
+  if (!file)
+  {
+    LOG_BEGIN(loggerModuleName, WARNING_LOG | 3);
+    LOG("BulkController: Could not open (file)");
+    LOG(filename);
+    LOG_END;
+
+    return SNMP_CLASS_ERROR;
+  }
+
+  SnmpSynchronize _synchronize(*this);
+  while (fgets(line, BULK_MAX_LINE_LEN, file))
+  {
+    line[BULK_MAX_LINE_LEN - 1] = 0;
+    /* ignore comments */
+    if (line[0] == '#')
+      continue;
+
+    if ((sscanf(line, "%255s %d %d %d %d", address,
+                &reps, &ceiling, &max_size, &vb_size) != 5) ||
+        (reps < 1) || (ceiling < 1) || (max_size < 484) || (vb_size < 0))
+    {
+      LOG_BEGIN(loggerModuleName, WARNING_LOG | 3);
+      LOG("BulkController: Ignoring illegal line (file) (line)");
+      LOG(filename);
+      LOG(line);
+      LOG_END;
+      continue;
+    }
+
+    Entry *e = find(OctetStr(address), true);
+    e->reps = reps;
+    e->ceiling = ceiling;
+    e->max_size = max_size;
+    e->vb_size = vb_size;
+    e->latency = 0;
+    e->latency_reps = 0;
+  }
+  fclose(file);
+
+  LOG_BEGIN(loggerModuleName, INFO_LOG | 3);
+  LOG("BulkController: Loaded (file) (targets)");
+  LOG(filename);
+  LOG(count);
+  LOG_END;
+
+  return SNMP_CLASS_SUCCESS;
+}
+
+
+//----[ TableWalker class ]--------------------------------------------
+
+TableWalker::TableWalker(Snmp &snmp_session)
+  : snmp(snmp_session),
+    max_in_flight(WALKER_DEFAULT_MAX_IN_FLIGHT),
+    max_in_flight_per_target(WALKER_DEFAULT_MAX_IN_FLIGHT_PER_TARGET),
+    max_repetitions(WALKER_DEFAULT_MAX_REPETITIONS),
+    column_split(true), bulk_controller(0), in_flight(0), walk_count(0), walks(0), finished(0),
+    runnable_head(0), runnable_tail(0), target_hash(0),
+    target_hash_size(WALKER_INITIAL_HASH_SIZE), target_count(0)
+{
+  target_hash = new WalkTarget*[target_hash_size];
+  memset(target_hash, 0, target_hash_size * sizeof(WalkTarget*));
+}
+
+TableWalker::~TableWalker()
+{
+  // no new requests and no callbacks from now on (max_in_flight is
+  // never 0 otherwise)
+  lock();
+  max_in_flight = 0;
+  int count = 0;
+  unsigned long *ids = new unsigned long[in_flight + 1];
+  for (Walk *w = walks; w; w = w->next)
+    for (WalkRange *r = w->ranges; r; r = r->walk_next)
+      if (r->req_id && (count < in_flight))
+        ids[count++] = r->req_id;
+  unlock();
+
+  // do not hold the lock: cancel() waits for running callbacks, so
+  // afterwards no other thread uses the walks
+  for (int i = 0; i < count; i++)
+    snmp.cancel(ids[i]);
+  delete [] ids;
+
+  while (walks)
+  {
+    Walk *w = walks;
+    walks = w->next;
+    w->next = finished;
+    finished = w;
+  }
+  while (finished)
+  {
+    Walk *w = finished;
+    finished = w->next;
+    while (w->ranges)
+    {
+      WalkRange *r = w->ranges;
+      w->ranges = r->walk_next;
+      delete r;
+    }
+    delete w->target;
+    delete w;
+  }
+  for (int i = 0; i < target_hash_size; i++)
+    while (target_hash[i])
+    {
+      WalkTarget *t = target_hash[i];
+      target_hash[i] = t->hash_next;
+      delete t;
+    }
+  delete [] target_hash;
+}
+
+void TableWalker::set_max_in_flight(const int count)
+{
+  lock();
+  max_in_flight = (count < 1) ? 1 : count;
+  dispatch();
+  unlock();
+  finish_walks();
+}
+
+void TableWalker::set_max_in_flight_per_target(const int count)
+{
+  lock();
+  max_in_flight_per_target = (count < 1) ? 1 : count;
+
+  // targets may have become runnable
+  for (int i = 0; i < target_hash_size; i++)
+    for (WalkTarget *t = target_hash[i]; t; t = t->hash_next)
+      if (t->ready_head && !t->runnable &&
+          (t->in_flight < max_in_flight_per_target))
+      {
+        t->runnable = true;
+        t->run_next = 0;
+        if (runnable_tail)
+          runnable_tail->run_next = t;
+        else
+          runnable_head = t;
+        runnable_tail = t;
+      }
+  dispatch();
+  unlock();
+  finish_walks();
+}
+
+int TableWalker::walk(const SnmpTarget &target, const Oid &subtree,
+                      const walk_callback callback, const void *data)
+{
+  return start_walk(target, &subtree, 1, column_split, callback, data);
+}
+
+int TableWalker::walk(const SnmpTarget &target,
+                      const Oid *columns, const int count,
+                      const walk_callback callback, const void *data)
+{
+  return start_walk(target, columns, count, false, callback, data);
+}
+
+int TableWalker::start_walk(const SnmpTarget &target,
+                            const Oid *oids, const int count,
+                            const bool split, const walk_callback callback,
+                            const void *data)
+{
+  if (!callback)
+    return SNMP_CLASS_INVALID_CALLBACK;
+  if (!target.valid())
+    return SNMP_CLASS_INVALID_TARGET;
+  if (!oids || (count < 1))
+    return SNMP_CLASS_INVALID_OID;
+  for (int i = 0; i < count; i++)
+    if (!oids[i].valid())
+      return SNMP_CLASS_INVALID_OID;
+
+  Walk *w = new Walk;
+  w->target = target.clone();
+  w->entry = 0;
+  w->callback = callback;
+  w->callback_data = (void *)data;
+  w->status = SNMP_CLASS_SUCCESS;
+  w->active_ranges = 0;
+  w->ranges = 0;
+  w->previous = 0;
+
+  lock();
+  w->entry = get_target(target);
+  w->next = walks;
+  if (walks)
+    walks->previous = w;
+  walks = w;
+  walk_count++;
+
+  for (int j = 0; j < count; j++)
+    enqueue(add_range(w, oids[j], oids[j], split));
+
+  LOG_BEGIN(loggerModuleName, DEBUG_LOG | 5);
+  LOG("TableWalker: Started walk (target) (ranges)");
+  LOG(w->entry->key.get_printable());
+  LOG(count);
+  LOG_END;
+
+  dispatch();
+  unlock();
+  finish_walks();
+  return SNMP_CLASS_SUCCESS;
+}
+
+//----[ internal functions, lock must be held ]------------------------
+
+TableWalker::WalkRange *TableWalker::add_range(Walk *walk, const Oid &start,
+                                               const Oid &bound,
+                                               const bool split)
+{
+  WalkRange *r = new WalkRange;
+  r->walker = this;
+  r->walk = walk;
+  r->last = start;
+  r->bound = bound;
+  r->split = split;
+  r->max_reps = max_repetitions;
+  r->req_id = 0;
+  r->ready_next = 0;
+  r->walk_next = walk->ranges;
+  walk->ranges = r;
+  walk->active_ranges++;
+  return r;
+}
+
+void TableWalker::enqueue(WalkRange *range)
+{
+  WalkTarget *t = range->walk->entry;
+
+  range->ready_next = 0;
+  if (t->ready_tail)
+    t->ready_tail->ready_next = range;
+  else
+    t->ready_head = range;
+  t->ready_tail = range;
+
+  if (!t->runnable && (t->in_flight < max_in_flight_per_target))
+  {
+    t->runnable = true;
+    t->run_next = 0;
+    if (runnable_tail)
+      runnable_tail->run_next = t;
+    else
+      runnable_head = t;
+    runnable_tail = t;
+  }
+}
+
+void TableWalker::dispatch()
+{
+  while (runnable_head && (in_flight < max_in_flight))
+  {
+    // take the first range of the first runnable target
+    WalkTarget *t = runnable_head;
+    runnable_head = t->run_next;
+    if (!runnable_head)
+      runnable_tail = 0;
+    t->runnable = false;
+
+    WalkRange *r = t->ready_head;
+    t->ready_head = r->ready_next;
+    if (!t->ready_head)
+      t->ready_tail = 0;
+
+    if (r->walk->status != SNMP_CLASS_SUCCESS)
+      end_range(r, SNMP_CLASS_SUCCESS); // walk has been aborted
+    else
+    {
+      Pdu pdu;
+      Vb vb(r->last);
+      pdu += vb;
+
+      if (bulk_controller)
+        r->max_reps = bulk_controller->get_max_repetitions(*r->walk->target);
+      r->sent.refresh();
+
+      int status = snmp.get_bulk(pdu, *r->walk->target, 0, r->max_reps,
+                                 response_callback, r);
+      if (status == SNMP_CLASS_SUCCESS)
+      {
+        r->req_id = pdu.get_request_id();
+        t->in_flight++;
+        in_flight++;
+      }
+      else
+      {
+        LOG_BEGIN(loggerModuleName, WARNING_LOG | 3);
+        LOG("TableWalker: Could not send request (target) (status)");
+        LOG(t->key.get_printable());
+        LOG(status);
+        LOG_END;
+
+        end_range(r, status);
+      }
+    }
+
+    // round robin: the target goes to the end of the list
+    if (t->ready_head && (t->in_flight < max_in_flight_per_target))
+    {
+      t->runnable = true;
+      t->run_next = 0;
+      if (runnable_tail)
+        runnable_tail->run_next = t;
+      else
+        runnable_head = t;
+      runnable_tail = t;
+    }
+  }
+}
+
+void TableWalker::end_range(WalkRange *range, const int status)
+{
+  Walk *w = range->walk;
+
+  if ((status != SNMP_CLASS_SUCCESS) && (w->status == SNMP_CLASS_SUCCESS))
+    w->status = status;
+
+  if (--w->active_ranges > 0)
+    return;
+
+  // the walk has ended, report it through finish_walks()
+  if (w->previous)
+    w->previous->next = w->next;
+  else
+    walks = w->next;
+  if (w->next)
+    w->next->previous = w->previous;
+
+  release_target(w->entry);
+  w->entry = 0;
+  w->next = finished;
+  finished = w;
+  walk_count--;
+}
+
+TableWalker::WalkTarget *TableWalker::get_target(const SnmpTarget &target)
+{
+  GenAddress address;
+  target.get_address(address);
+  OctetStr key(address.get_printable());
+  unsigned long h = hash_key(key);
+
+  WalkTarget *t;
+  for (t = target_hash[h % target_hash_size]; t; t = t->hash_next)
+    if ((t->hash == h) && (t->key == key))
+    {
+      t->walks++;
+      return t;
+    }
+
+  if (target_count >= 2 * target_hash_size)
+  {
+    // grow the hash table
+    int size = 2 * target_hash_size;
+    WalkTarget **table = new WalkTarget*[size];
+    memset(table, 0, size * sizeof(WalkTarget*));
+    for (int i = 0; i < target_hash_size; i++)
+      while (target_hash[i])
+      {
+        WalkTarget *e = target_hash[i];
+        target_hash[i] = e->hash_next;
+        e->hash_next = table[e->hash % size];
+        table[e->hash % size] = e;
+      }
+    delete [] target_hash;
+    target_hash = table;
+    target_hash_size = size;
+  }
+
+  t = new WalkTarget;
+  t->key = key;
+  t->hash = h;
+  t->walks = 1;
+  t->in_flight = 0;
+  t->ready_head = 0;
+  t->ready_tail = 0;
+  t->runnable = false;
+  t->run_next = 0;
+  t->hash_next = target_hash[h % target_hash_size];
+  target_hash[h % target_hash_size] = t;
+  target_count++;
+  return t;
+}
+
+void TableWalker::release_target(WalkTarget *entry)
+{
+  if (--entry->walks > 0)
+    return;
+
+  // unused entries have no ranges and are not runnable
+  WalkTarget **p = &target_hash[entry->hash % target_hash_size];
+  while (*p != entry)
+    p = &(*p)->hash_next;
+  *p = entry->hash_next;
+  target_count--;
+  delete entry;
+}
+
+//----[ callbacks ]----------------------------------------------------
+
+void TableWalker::finish_walks()
+{
+  lock();
+  Walk *list = finished;
+  finished = 0;
+  bool report = (max_in_flight > 0);
+  unlock();
+
+  while (list)
+  {
+    Walk *w = list;
+    list = w->next;
+
+    LOG_BEGIN(loggerModuleName, DEBUG_LOG | 5);
+    LOG("TableWalker: Walk ended (status)");
+    LOG(w->status);
+    LOG_END;
+
+    if (report)
+      w->callback(w->status, this, *w->target, 0, w->callback_data);
+
+    while (w->ranges)
+    {
+      WalkRange *r = w->ranges;
+      w->ranges = r->walk_next;
+      delete r;
+    }
+    delete w->target;
+    delete w;
+  }
+}
+
+void TableWalker::response_callback(int reason, Snmp *, Pdu &pdu,
+                                    SnmpTarget &, void *data)
+{
+  WalkRange *range = (WalkRange *)data;
+  range->walker->process_response(reason, pdu, range);
+}
+
+void TableWalker::process_response(int reason, Pdu &pdu, WalkRange *range)
+{
+  // Only the thread that received the response for this range accesses
+  // the range, so the variable bindings are processed without lock.
+  // The state of the walk and the walker is copied while it is held.
+  Walk *w = range->walk;
+  bool split = false;
+  Oid split_start;
+  Oid split_bound;
+  int status = SNMP_CLASS_SUCCESS;
+  bool more = false;
+  lock();
+  bool report = (max_in_flight > 0) && (w->status == SNMP_CLASS_SUCCESS);
+  unlock();
+  msec now;
+  unsigned long latency = (unsigned long)now - (unsigned long)range->sent;
+
+  if (reason != SNMP_CLASS_ASYNC_RESPONSE)
+    status = reason;
+  else if (pdu.get_error_status() == SNMP_ERROR_TOO_BIG)
+  {
+    if (range->max_reps > 1)
+    {
+      // the controller provides the value for the retry
+      if (!bulk_controller)
+        range->max_reps /= 2;
+      more = true;
+    }
+    else
+      status = SNMP_ERROR_TOO_BIG;
+  }
+  else if (pdu.get_error_status() == SNMP_ERROR_NO_SUCH_NAME)
+  {
+    // end of the MIB view of a SNMPv1 agent
+  }
+  else if (pdu.get_error_status() != SNMP_ERROR_SUCCESS)
+    status = pdu.get_error_status();
+  else
+  {
+    int count = pdu.get_vb_count();
+    more = (count > 0);
+    for (int i = 0; i < count; i++)
+    {
+      const Vb &vb = pdu.get_vb(i);
+      const Oid &oid = vb.get_oid();
+
+      if ((vb.get_syntax() == sNMP_SYNTAX_ENDOFMIBVIEW) ||
+          (vb.get_syntax() == sNMP_SYNTAX_NOSUCHOBJECT) ||
+          (vb.get_syntax() == sNMP_SYNTAX_NOSUCHINSTANCE) ||
+          (oid.len() <= range->bound.len()) ||
+          (range->bound.nCompare(range->bound.len(), oid) != 0))
+      {
+        more = false;        // left the range
+        break;
+      }
+      if (oid <= range->last)
+      {
+        LOG_BEGIN(loggerModuleName, WARNING_LOG | 2);
+        LOG("TableWalker: Oid not increasing (oid) (previous)");
+        LOG(oid.get_printable());
+        LOG(range->last.get_printable());
+        LOG_END;
+
+        status = SNMP_CLASS_ERROR;
+        more = false;
+        break;
+      }
+      if (range->split && (oid.len() >= range->bound.len() + 2) &&
+          (oid[range->bound.len()] < 0xffffffffUL))
+      {
+        // a table entry: walk this column, start the next one in parallel
+        split = true;
+        split_bound = range->bound;
+        split_start = range->bound;
+        split_start += oid[range->bound.len()] + 1;
+        range->bound += oid[range->bound.len()];
+      }
+      range->split = false;
+      range->last = oid;
+
+      if (report)
+        w->callback(SNMP_CLASS_SUCCESS, this, *w->target, &vb,
+                    w->callback_data);
+    }
+  }
+
+  if (bulk_controller)
+    bulk_controller->update(*w->target, reason, pdu, range->max_reps, 1,
+                            latency,
+                            (status == SNMP_CLASS_SUCCESS) && !more);
+
+  lock();
+  range->req_id = 0;
+  in_flight--;
+  w->entry->in_flight--;
+  if (w->entry->ready_head && !w->entry->runnable &&
+      (w->entry->in_flight < max_in_flight_per_target))
+  {
+    // a slot of the target is free again
+    w->entry->runnable = true;
+    w->entry->run_next = 0;
+    if (runnable_tail)
+      runnable_tail->run_next = w->entry;
+    else
+      runnable_head = w->entry;
+    runnable_tail = w->entry;
+  }
+  if (split && (w->status == SNMP_CLASS_SUCCESS))
+    enqueue(add_range(w, split_start, split_bound, true));
+  if (more && (status == SNMP_CLASS_SUCCESS) &&
+      (w->status == SNMP_CLASS_SUCCESS))
+    enqueue(range);
+  else
+    end_range(range, status);
+  dispatch();
+  unlock();
+  finish_walks();
+}
+
+#ifdef SNMP_PP_NAMESPACE
+} // end of namespace Snmp_pp
+#endif
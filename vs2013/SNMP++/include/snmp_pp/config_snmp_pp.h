@@ -35,9 +35,29 @@
 #define SNMP_PP_RELEASE 3
 #define SNMP_PP_PATCHLEVEL 0
 
-//! The maximum size of a message that can be sent or received.
+//! The default maximum size of a message that can be sent or received.
+//! It can be changed at runtime by MessageBuffer::set_max_message_size().
 #define MAX_SNMP_PACKET 4096
 
+//! The upper limit for the runtime maximum message size
+//! (largest UDP payload over IPv4).
+#define MAX_SNMP_PACKET_LIMIT 65507
+
+//! Number of subidentifiers an Oid stores without a heap allocation.
+//! Longer oids are stored on the heap. Set to 0 to always use the heap,
+//! which makes Oid objects smaller.
+#ifndef SNMP_PP_OID_INLINE_LEN
+#define SNMP_PP_OID_INLINE_LEN 16
+#endif
+
+//! Oids are compared with SSE2/AVX2 instructions if the compiler
+//! generates code for them. Define to always use plain C++ loops.
+// #define SNMP_PP_NO_SIMD
+
+//! Oid literals (oid_literal.h) are parsed at compile time if the
+//! compiler supports C++14 constexpr. Define to parse them at runtime.
+// #define SNMP_PP_NO_CONSTEXPR
+
 #ifndef DLLOPT
 #if defined (WIN32) && defined (SNMP_PP_DLL)
 #ifdef SNMP_PP_EXPORTS